@@ -0,0 +1,165 @@
+/*
+  RadioLib AT engine benchmark
+
+  Drives scripted ESP8266 serial streams through ATEngine::feed, the same path ATEngine::poll uses
+  for bytes read from ModuleSerial. Every script is a command response, optionally followed by
+  unsolicited lines and +IPD payloads which contain terminator strings that must not be matched.
+  Each script is fed in chunks of 1, 7 and 64 bytes, as bytes would arrive from UART with different
+  polling intervals, and the benchmark checks the final status, the payload bytes stored
+  in the ring buffer and that the response completes exactly at its terminator.
+
+  Host CPU time spent in the parser is reported per byte. The benchmark exits with non-zero code
+  when any script produces unexpected result.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      ATEngineBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o ATEngineBenchmark
+
+  Usage:
+    ATEngineBenchmark [repetitions]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <RadioLib.h>
+
+struct Script_t {
+  const char* name;
+
+  // custom prefix terminator, e.g. prompt of AT+CIPSEND
+  const char* prompt;
+
+  // serial stream, split right after the terminator, i.e. after the first line feed character that ends its line
+  const char* response;
+  const char* rest;
+
+  // expected status and +IPD payload
+  int16_t status;
+  const char* payload;
+};
+
+static const Script_t scripts[] = {
+  { "AT echo and OK", NULL,
+    "AT\r\r\n\r\nOK\r", "\n",
+    ERR_NONE, "" },
+  { "CIPSEND prompt", "> ",
+    "\n> ", "",
+    ERR_NONE, "" },
+  { "SEND OK and +IPD", NULL,
+    "\r\nRecv 32 bytes\r\n\r\nSEND OK\r", "\n\r\n+IPD,38:HTTP/1.1 200\r\nOK\r\nERROR\r\nSEND FAIL\r\n\r\n",
+    ERR_NONE, "HTTP/1.1 200\r\nOK\r\nERROR\r\nSEND FAIL\r\n\r\n" },
+  { "+IPD before ERROR", NULL,
+    "AT+CIPSTART=\"TCP\",\"example.com\",80\r\r\n+IPD,0,6:OK\r\nOK\r\nALREADY CONNECTED\r\n\r\nERROR\r", "\nWIFI DISCONNECT\r\n",
+    ERR_AT_FAILED, "OK\r\nOK" },
+  { "long unsolicited lines", NULL,
+    "WIFI CONNECTED\r\nWIFI GOT IP\r\n+CWLAP:(3,\"a very long network name that does not fit\",-70,\"00:11:22:33:44:55\",1)\r\n\r\nOK\r", "\n",
+    ERR_NONE, "" },
+};
+
+#define NUM_SCRIPTS (sizeof(scripts) / sizeof(scripts[0]))
+
+static const size_t chunkLens[] = { 1, 7, 64 };
+
+uint64_t hostNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+// feeds the data in chunks, returns the number of bytes fed until the pending command completed
+size_t feedChunks(ATEngine& engine, const uint8_t* data, size_t len, size_t chunkLen) {
+  size_t done = len + 1;
+  for(size_t i = 0; i < len; i += chunkLen) {
+    size_t n = (len - i < chunkLen) ? len - i : chunkLen;
+    if(engine.isPending()) {
+      // while waiting for response, bytes are fed one at a time, the same way ATEngine::poll reads them
+      for(size_t j = 0; j < n; j++) {
+        engine.feed(&data[i + j], 1);
+        if(!engine.isPending() && (done > len)) {
+          done = i + j + 1;
+        }
+      }
+    } else {
+      engine.feed(&data[i], n);
+    }
+  }
+  return(done);
+}
+
+bool runScript(ATEngine& engine, const Script_t& script, size_t chunkLen) {
+  uint8_t stream[512];
+  size_t respLen = strlen(script.response);
+  size_t len = respLen + strlen(script.rest);
+  memcpy(stream, script.response, respLen);
+  memcpy(stream + respLen, script.rest, len - respLen);
+
+  engine.reset();
+  engine.clearTerminators();
+  if(script.prompt != NULL) {
+    engine.addTerminator(script.prompt, ERR_NONE, RADIOLIB_AT_MATCH_PREFIX);
+  }
+  engine.expect();
+  size_t done = feedChunks(engine, stream, len, chunkLen);
+  int16_t state = engine.feed(NULL, 0);
+
+  uint8_t payload[RADIOLIB_AT_BUFFER_SIZE];
+  size_t payloadLen = engine.read(payload, sizeof(payload));
+  if((state != script.status) || (done != respLen) || (payloadLen != strlen(script.payload)) || (memcmp(payload, script.payload, payloadLen) != 0)) {
+    printf("%s, %u byte chunks: status %d (expected %d), response ended at byte %u (expected %u), %u payload bytes (expected %u)\n",
+           script.name, (unsigned)chunkLen, state, script.status, (unsigned)done, (unsigned)respLen,
+           (unsigned)payloadLen, (unsigned)strlen(script.payload));
+    return(false);
+  }
+  return(true);
+}
+
+int main(int argc, char** argv) {
+  uint32_t reps = 10000;
+  if(argc > 1) {
+    reps = atoi(argv[1]);
+  }
+
+  // the engine only parses, nothing is sent to the module
+  Module mod(RADIOLIB_NC, RADIOLIB_NC);
+  ATEngine engine(&mod);
+
+  // check all scripts with all chunk lengths
+  bool ok = true;
+  for(size_t i = 0; i < NUM_SCRIPTS; i++) {
+    for(size_t j = 0; j < sizeof(chunkLens) / sizeof(chunkLens[0]); j++) {
+      ok &= runScript(engine, scripts[i], chunkLens[j]);
+    }
+  }
+  if(!ok) {
+    return(1);
+  }
+
+  // measure parser throughput with the largest chunks
+  printf("%u repetitions of each script\n", (unsigned)reps);
+  for(size_t i = 0; i < NUM_SCRIPTS; i++) {
+    const Script_t& script = scripts[i];
+    size_t respLen = strlen(script.response);
+    size_t restLen = strlen(script.rest);
+    uint8_t payload[RADIOLIB_AT_BUFFER_SIZE];
+    uint64_t start = hostNs();
+    for(uint32_t n = 0; n < reps; n++) {
+      engine.reset();
+      engine.clearTerminators();
+      if(script.prompt != NULL) {
+        engine.addTerminator(script.prompt, ERR_NONE, RADIOLIB_AT_MATCH_PREFIX);
+      }
+      engine.expect();
+      engine.feed((const uint8_t*)script.response, respLen);
+      engine.feed((const uint8_t*)script.rest, restLen);
+      engine.read(payload, sizeof(payload));
+    }
+    uint64_t elapsed = hostNs() - start;
+    printf("%-24s %4u bytes, %6.1f ns/byte host\n", script.name, (unsigned)(respLen + restLen),
+           (double)elapsed / ((double)reps * (respLen + restLen)));
+  }
+  printf("OK\n");
+  return(0);
+}
@@ -0,0 +1,164 @@
+/*
+  RadioLib BUSY timing benchmark
+
+  Runs SX1262 and SX1280 drivers against command-level emulators of both chips and reports
+  for each phase of a typical flow how long BUSY of both chips was held high by the commands the driver sent
+  (CommandChipEmulator::getBusyTime) and how many commands were sent while BUSY was high
+  (CommandChipEmulator::getBusyViolations). Phases are:
+    - begin: initialization of the transmitting and receiving radio
+    - transmit: blocking transmit on the first radio
+    - receive: startReceive, readData on the second radio
+
+  BUSY times are the emulator defaults (approximated from datasheet switching times).
+  Time is virtual, so the share of BUSY time in each phase is the time the driver would wait
+  on BUSY with the same configuration on hardware. The benchmark exits with non-zero code
+  when any driver call fails, any packet is lost or any BUSY violation is detected.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      BusyBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o BusyBenchmark
+
+  Usage:
+    BusyBenchmark [packets]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated radios
+#define BENCHMARK_PIN_CS(n)     (10*(n) + 10)
+#define BENCHMARK_PIN_IRQ(n)    (10*(n) + 11)
+#define BENCHMARK_PIN_RST(n)    (10*(n) + 12)
+#define BENCHMARK_PIN_BUSY(n)   (10*(n) + 13)
+
+// payload length
+#define BENCHMARK_PACKET_LEN    32
+
+static volatile bool received = false;
+
+void setFlag() {
+  received = true;
+}
+
+// BUSY statistics of both chips
+struct Phase_t {
+  uint64_t time;
+  uint64_t busy;
+  uint32_t commands;
+  uint32_t violations;
+};
+
+Phase_t snapshot(CommandChipEmulator** chips) {
+  Phase_t phase;
+  phase.time = EmulatorHal::getTimeNs();
+  phase.busy = chips[0]->getBusyTime() + chips[1]->getBusyTime();
+  phase.commands = chips[0]->getCommands() + chips[1]->getCommands();
+  phase.violations = chips[0]->getBusyViolations() + chips[1]->getBusyViolations();
+  return(phase);
+}
+
+// adds statistics between two snapshots to the phase
+void accumulate(Phase_t& phase, const Phase_t& from, const Phase_t& to) {
+  phase.time += to.time - from.time;
+  phase.busy += to.busy - from.busy;
+  phase.commands += to.commands - from.commands;
+  phase.violations += to.violations - from.violations;
+}
+
+// prints phase statistics, returns number of BUSY violations
+uint32_t report(const char* name, const char* phaseName, const Phase_t& phase, uint32_t reps) {
+  double time = (double)phase.time / reps;
+  double busy = (double)phase.busy / reps;
+  printf("%-7s %-9s %6.1f commands, %10.1f us total, %9.1f us BUSY (%4.1f %%), %lu BUSY violations\n", name, phaseName,
+         (double)phase.commands / reps, time / 1000.0, busy / 1000.0,
+         time > 0 ? 100.0 * busy / time : 0.0, (unsigned long)phase.violations);
+  return(phase.violations);
+}
+
+template<class T>
+bool run(const char* name, uint8_t first, CommandChipEmulator** chips, uint16_t packets) {
+  Phase_t init = { 0, 0, 0, 0 };
+  Phase_t tx = { 0, 0, 0, 0 };
+  Phase_t rx = { 0, 0, 0, 0 };
+
+  Phase_t from = snapshot(chips);
+  T* radios[2];
+  for(uint8_t i = 0; i < 2; i++) {
+    uint8_t n = first + i;
+    radios[i] = new T(new Module(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n), BENCHMARK_PIN_BUSY(n)));
+    int16_t state = radios[i]->begin();
+    if(state != ERR_NONE) {
+      printf("%s %u failed to initialize, code %d\n", name, i, state);
+      return(false);
+    }
+  }
+  Phase_t to = snapshot(chips);
+  accumulate(init, from, to);
+  radios[1]->setDio1Action(setFlag);
+
+  uint8_t data[BENCHMARK_PACKET_LEN];
+  uint8_t buff[BENCHMARK_PACKET_LEN];
+  for(uint16_t seq = 0; seq < packets; seq++) {
+    for(size_t i = 0; i < sizeof(data); i++) {
+      data[i] = (uint8_t)(seq + i);
+    }
+
+    from = snapshot(chips);
+    received = false;
+    int16_t state = radios[1]->startReceive();
+    to = snapshot(chips);
+    accumulate(rx, from, to);
+
+    from = to;
+    state |= radios[0]->transmit(data, sizeof(data));
+    to = snapshot(chips);
+    accumulate(tx, from, to);
+    if((state != ERR_NONE) || !received || (radios[1]->getPacketLength() != sizeof(data))) {
+      printf("%s packet %u was not received, code %d\n", name, seq, state);
+      return(false);
+    }
+
+    from = snapshot(chips);
+    state = radios[1]->readData(buff, sizeof(buff));
+    to = snapshot(chips);
+    accumulate(rx, from, to);
+    if((state != ERR_NONE) || (memcmp(buff, data, sizeof(data)) != 0)) {
+      printf("%s packet %u is corrupted, code %d\n", name, seq, state);
+      return(false);
+    }
+  }
+
+  uint32_t violations = report(name, "begin", init, 2);
+  violations += report(name, "transmit", tx, packets);
+  violations += report(name, "receive", rx, packets);
+  radios[1]->clearDio1Action();
+  return(violations == 0);
+}
+
+int main(int argc, char** argv) {
+  uint16_t packets = 20;
+  if(argc > 1) {
+    packets = atoi(argv[1]);
+  }
+
+  EmulatorHal::begin();
+  CommandChipEmulator* sx126x[2];
+  CommandChipEmulator* sx128x[2];
+  for(uint8_t i = 0; i < 2; i++) {
+    sx126x[i] = new SX126xEmulator(BENCHMARK_PIN_CS(i), BENCHMARK_PIN_BUSY(i), BENCHMARK_PIN_IRQ(i), BENCHMARK_PIN_RST(i));
+    EmulatorHal::attach(sx126x[i]);
+    sx128x[i] = new SX128xEmulator(BENCHMARK_PIN_CS(i + 2), BENCHMARK_PIN_BUSY(i + 2), BENCHMARK_PIN_IRQ(i + 2), BENCHMARK_PIN_RST(i + 2));
+    EmulatorHal::attach(sx128x[i]);
+  }
+
+  printf("%u packets of %u bytes, values per radio (begin) or per packet (transmit, receive)\n", packets, BENCHMARK_PACKET_LEN);
+  bool ok = run<SX1262>("SX1262", 0, sx126x, packets);
+  ok &= run<SX1280>("SX1280", 2, sx128x, packets);
+  if(!ok) {
+    return(1);
+  }
+  printf("OK\n");
+  return(0);
+}
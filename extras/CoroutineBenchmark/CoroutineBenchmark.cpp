@@ -0,0 +1,263 @@
+/*
+  RadioLib coroutine executor benchmark
+
+  Compares the host-side scheduling cost of running many radio sessions as C++20 coroutines
+  on RadioExecutor against sessions running as threads on top of blocking radio calls.
+
+  Both models run the same workload: each session performs a number of transmissions
+  on one of the radios, sessions that share a radio are serialized. Radios are stubs,
+  which complete every transmission as soon as it is started, so neither airtime nor
+  SPI traffic (or its emulation) is part of the result - only the cost of suspending
+  and resuming sessions is measured:
+    - coroutines: single thread, RadioExecutor resumes the session once its operation is finished,
+      resumption cost is reported directly as time per RadioExecutor resumption
+    - threads: one thread per session and one worker thread per radio, which performs the blocking
+      transmit calls of the sessions assigned to it; sessions hand their requests to the worker
+      and sleep on a condition variable until the transmission is finished
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=c++20 -O2 -pthread -DRADIOLIB_EMULATOR -DRADIOLIB_COROUTINES -I<core> -I<RadioLib>/src \
+      CoroutineBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o CoroutineBenchmark
+
+  Usage:
+    CoroutineBenchmark [sessions] [operations per session] [radios]
+*/
+
+// standard headers go first, some Arduino cores define min and max as macros
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <RadioLib.h>
+
+// maximum number of radios
+#define BENCHMARK_MAX_RADIOS    RADIOLIB_EXECUTOR_MAX_RADIOS
+
+/*
+  Radio stub, transmission is finished as soon as it is started. Only the transmit methods are used,
+  blocking transmit does not call the hardware abstraction layer, so it can be called from any thread.
+*/
+class StubRadio: public PhysicalLayer {
+  public:
+    StubRadio() : PhysicalLayer(1.0, 255) {}
+
+    using PhysicalLayer::transmit;
+    using PhysicalLayer::startTransmit;
+    using PhysicalLayer::readData;
+
+    int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0) { (void)addr; send(data, len); return(ERR_NONE); }
+    int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0) { (void)addr; send(data, len); _done = true; return(ERR_NONE); }
+    int16_t finishTransmit() { _done = false; return(ERR_NONE); }
+    uint16_t getEvents() { return(_done ? RADIOLIB_EVENT_TX_DONE : RADIOLIB_EVENT_NONE); }
+
+    int16_t standby() { return(ERR_NONE); }
+    int16_t receive(uint8_t* data, size_t len) { (void)data; (void)len; return(ERR_WRONG_MODEM); }
+    int16_t readData(uint8_t* data, size_t len) { (void)data; (void)len; return(ERR_WRONG_MODEM); }
+    int16_t transmitDirect(uint32_t FRF = 0) { (void)FRF; return(ERR_WRONG_MODEM); }
+    int16_t receiveDirect() { return(ERR_WRONG_MODEM); }
+    int16_t setFrequencyDeviation(float freqDev) { (void)freqDev; return(ERR_WRONG_MODEM); }
+    int16_t setDataShaping(float sh) { (void)sh; return(ERR_WRONG_MODEM); }
+    int16_t setEncoding(uint8_t encoding) { (void)encoding; return(ERR_WRONG_MODEM); }
+    size_t getPacketLength(bool update = true) { (void)update; return(0); }
+
+    uint32_t packets = 0;
+
+  private:
+    bool _done = false;
+
+    void send(uint8_t* data, size_t len) {
+      (void)data;
+      (void)len;
+      packets++;
+    }
+};
+
+static StubRadio* radios[BENCHMARK_MAX_RADIOS];
+static int numRadios = 4;
+static int numSessions = 256;
+static int numOps = 16;
+static std::atomic<int> failed(0);
+
+uint32_t countPackets() {
+  uint32_t num = 0;
+  for(int i = 0; i < numRadios; i++) {
+    num += radios[i]->packets;
+    radios[i]->packets = 0;
+  }
+  return(num);
+}
+
+// coroutine model: one task per session
+RadioTask session(int id) {
+  uint8_t data[16] = { (uint8_t)id };
+  PhysicalLayer* radio = radios[id % numRadios];
+  for(int i = 0; i < numOps; i++) {
+    RadioOperation_t op = co_await RadioExecutor::transmit(radio, data, sizeof(data));
+    if(op.status != ERR_NONE) {
+      failed++;
+    }
+  }
+}
+
+double runCoroutines(uint32_t* resumes) {
+  RadioExecutor executor;
+  auto start = std::chrono::steady_clock::now();
+  for(int i = 0; i < numSessions; i++) {
+    executor.spawn(session(i));
+  }
+  executor.run();
+  auto end = std::chrono::steady_clock::now();
+  *resumes = executor.getResumeCount();
+  return(std::chrono::duration<double, std::micro>(end - start).count());
+}
+
+// thread model: one thread per session, one worker thread per radio
+struct Request {
+  uint8_t* data;
+  size_t len;
+  int16_t status;
+  bool done;
+  std::mutex lock;
+  std::condition_variable cv;
+};
+
+struct Worker {
+  std::mutex lock;
+  std::condition_variable submitted;
+  std::deque<Request*> queue;
+  int sessionsLeft;
+};
+
+static Worker workers[BENCHMARK_MAX_RADIOS];
+
+// sessions wait until all threads are created, so that thread creation is not measured
+static std::mutex gateLock;
+static std::condition_variable gate;
+static bool gateOpen = false;
+
+void sessionThread(int id) {
+  uint8_t data[16] = { (uint8_t)id };
+  Worker& worker = workers[id % numRadios];
+  Request req;
+  req.data = data;
+  req.len = sizeof(data);
+  {
+    std::unique_lock<std::mutex> guard(gateLock);
+    gate.wait(guard, [] { return(gateOpen); });
+  }
+
+  for(int i = 0; i < numOps; i++) {
+    req.done = false;
+    {
+      std::lock_guard<std::mutex> guard(worker.lock);
+      worker.queue.push_back(&req);
+    }
+    worker.submitted.notify_one();
+
+    std::unique_lock<std::mutex> guard(req.lock);
+    req.cv.wait(guard, [&req] { return(req.done); });
+    if(req.status != ERR_NONE) {
+      failed++;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(worker.lock);
+  worker.sessionsLeft--;
+  worker.submitted.notify_one();
+}
+
+void workerThread(int n) {
+  Worker& worker = workers[n];
+  while(true) {
+    Request* req = NULL;
+    {
+      std::unique_lock<std::mutex> guard(worker.lock);
+      worker.submitted.wait(guard, [&worker] { return(!worker.queue.empty() || (worker.sessionsLeft == 0)); });
+      if(worker.queue.empty()) {
+        return;
+      }
+      req = worker.queue.front();
+      worker.queue.pop_front();
+    }
+
+    // blocking call, the radio is only accessed from this thread
+    int16_t state = radios[n]->transmit(req->data, req->len);
+    {
+      std::lock_guard<std::mutex> guard(req->lock);
+      req->status = state;
+      req->done = true;
+    }
+    req->cv.notify_one();
+  }
+}
+
+double runThreads() {
+  for(int i = 0; i < numRadios; i++) {
+    workers[i].sessionsLeft = numSessions / numRadios + ((i < numSessions % numRadios) ? 1 : 0);
+  }
+
+  std::vector<std::thread> threads;
+  for(int i = 0; i < numRadios; i++) {
+    threads.emplace_back(workerThread, i);
+  }
+  for(int i = 0; i < numSessions; i++) {
+    threads.emplace_back(sessionThread, i);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> guard(gateLock);
+    gateOpen = true;
+  }
+  gate.notify_all();
+  for(std::thread& t : threads) {
+    t.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return(std::chrono::duration<double, std::micro>(end - start).count());
+}
+
+int main(int argc, char** argv) {
+  if(argc > 1) {
+    numSessions = atoi(argv[1]);
+  }
+  if(argc > 2) {
+    numOps = atoi(argv[2]);
+  }
+  if(argc > 3) {
+    numRadios = atoi(argv[3]);
+  }
+  if((numRadios < 1) || (numRadios > BENCHMARK_MAX_RADIOS)) {
+    printf("number of radios must be between 1 and %d\n", BENCHMARK_MAX_RADIOS);
+    return(1);
+  }
+
+  // the executor reads time through the hardware abstraction layer
+  EmulatorHal::begin();
+  for(int i = 0; i < numRadios; i++) {
+    radios[i] = new StubRadio();
+  }
+
+  uint32_t total = numSessions * numOps;
+  printf("%d sessions x %d operations on %d stub radios\n", numSessions, numOps, numRadios);
+
+  uint32_t resumes = 0;
+  double co = runCoroutines(&resumes);
+  uint32_t coPackets = countPackets();
+  printf("coroutines: %9.0f us total, %6.3f us/operation, %u resumptions, %6.3f us/resumption\n",
+         co, co / total, (unsigned)resumes, co / resumes);
+
+  double th = runThreads();
+  uint32_t thPackets = countPackets();
+  printf("threads:    %9.0f us total, %6.3f us/operation\n", th, th / total);
+
+  printf("failed operations: %d, packets: %u/%u\n", failed.load(), (unsigned)coPackets, (unsigned)thPackets);
+  return(((failed == 0) && (coPackets == total) && (thPackets == total)) ? 0 : 1);
+}
@@ -0,0 +1,398 @@
+/*
+  RadioLib LinuxHal system call benchmark
+
+  Counts ioctl calls and the time spent in them per SX1278 LoRa transmission made through LinuxHal,
+  using LinuxHal::getIoctlCount and LinuxHal::getIoctlTime. Every transmission is made twice:
+    - blocking SX127x::transmit, which sleeps in poll on DIO0 line events (Module::waitForPin) until the packet is sent
+    - SX127x::startTransmit followed by LinuxHal::handleInterrupts, which sleeps in epoll_wait until DIO0 rises
+
+  By default, spidev and GPIO character device are replaced by fake file descriptors through LinuxHal::setSyscalls,
+  so the benchmark runs on any Linux host. The fake devices forward SPI messages to a minimal SX1278 register file
+  and raise DIO0 once the configured time-on-air has passed. In this case, ioctl time is only the cost of the fake
+  layer, the ioctl counts are the same as on hardware. Other system calls made through the fake layer are counted as well.
+  When paths to real devices are given, the benchmark runs against a real SX1278 connected to spidev and GPIO chip.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_HAL=LinuxHal -DRADIOLIB_HAL_HEADER='"LinuxHal.h"' -I<core> -I<RadioLib>/src \
+      LinuxHalBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o LinuxHalBenchmark
+
+  Usage:
+    LinuxHalBenchmark [transmissions] [fake time-on-air in us]
+    LinuxHalBenchmark [transmissions] [spidev] [gpiochip] [DIO0 line] [RST line]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/spi/spidev.h>
+
+#include <RadioLib.h>
+
+#if !defined(__linux__)
+  #error "LinuxHalBenchmark can only be built on Linux"
+#endif
+
+// GPIO lines of the fake radio
+#define BENCHMARK_LINE_DIO0     17
+#define BENCHMARK_LINE_RST      27
+
+// file descriptors of the fake devices, GPIO lines are at FAKE_FD_LINE + line offset
+#define FAKE_FD_SPI             1000
+#define FAKE_FD_GPIO            1001
+#define FAKE_FD_EPOLL           1002
+#define FAKE_FD_LINE            1100
+#define FAKE_MAX_LINES          64
+
+// minimal SX1278 in LoRa mode: register file, FIFO at FIFO address pointer and DIO0 as TxDone
+static uint8_t fakeRegs[128];
+static uint8_t fakeFifo[256];
+static uint64_t fakeToA = 5000;
+static uint64_t fakeTxEnd = 0;
+static bool fakeDio0 = false;
+static uint8_t fakeDio0Events = 0;
+
+// GPIO lines requested through the fake GPIO chip
+static bool fakeLineRequested[FAKE_MAX_LINES];
+static bool fakeLineEpoll[FAKE_MAX_LINES];
+
+// system calls made through the fake layer
+static uint32_t fakeCalls = 0;
+
+uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+// DIO0 rises when time-on-air has passed since the chip entered Tx mode
+void fakeUpdate() {
+  if((fakeTxEnd != 0) && (nowUs() >= fakeTxEnd)) {
+    fakeTxEnd = 0;
+    fakeRegs[SX127X_REG_IRQ_FLAGS] |= SX127X_CLEAR_IRQ_FLAG_TX_DONE;
+    fakeRegs[SX127X_REG_OP_MODE] = (fakeRegs[SX127X_REG_OP_MODE] & ~0x07) | SX127X_STANDBY;
+  }
+  bool dio0 = fakeRegs[SX127X_REG_IRQ_FLAGS] & SX127X_CLEAR_IRQ_FLAG_TX_DONE;
+  if(dio0 && !fakeDio0) {
+    fakeDio0Events++;
+  }
+  fakeDio0 = dio0;
+}
+
+void fakeRegWrite(uint8_t addr, uint8_t value) {
+  switch(addr) {
+    case SX127X_REG_FIFO:
+      fakeFifo[fakeRegs[SX127X_REG_FIFO_ADDR_PTR]++] = value;
+      return;
+    case SX127X_REG_IRQ_FLAGS:
+      // flags are cleared by writing 1
+      fakeRegs[addr] &= ~value;
+      return;
+    case SX127X_REG_OP_MODE:
+      if((value & 0x07) == SX127X_TX) {
+        fakeTxEnd = nowUs() + fakeToA;
+      }
+      break;
+  }
+  fakeRegs[addr] = value;
+}
+
+uint8_t fakeRegRead(uint8_t addr) {
+  if(addr == SX127X_REG_FIFO) {
+    return(fakeFifo[fakeRegs[SX127X_REG_FIFO_ADDR_PTR]++]);
+  }
+  return(fakeRegs[addr]);
+}
+
+// SPI frame is register address with write flag, followed by data, burst access auto-increments address except for FIFO
+void fakeSpiFrame(uint8_t* buff, size_t len) {
+  fakeUpdate();
+  if(len == 0) {
+    return;
+  }
+  bool write = buff[0] & 0x80;
+  uint8_t addr = buff[0] & 0x7F;
+  buff[0] = 0x00;
+  for(size_t i = 1; i < len; i++) {
+    uint8_t a = (addr == SX127X_REG_FIFO) ? addr : (uint8_t)((addr + i - 1) & 0x7F);
+    if(write) {
+      fakeRegWrite(a, buff[i]);
+      buff[i] = 0x00;
+    } else {
+      buff[i] = fakeRegRead(a);
+    }
+  }
+  fakeUpdate();
+}
+
+int fakeOpen(const char* path, int flags) {
+  (void)flags;
+  fakeCalls++;
+  if(strcmp(path, "fake-spidev") == 0) {
+    return(FAKE_FD_SPI);
+  } else if(strcmp(path, "fake-gpiochip") == 0) {
+    return(FAKE_FD_GPIO);
+  }
+  errno = ENOENT;
+  return(-1);
+}
+
+int fakeClose(int fd) {
+  fakeCalls++;
+  if((fd >= FAKE_FD_LINE) && (fd < FAKE_FD_LINE + FAKE_MAX_LINES)) {
+    fakeLineRequested[fd - FAKE_FD_LINE] = false;
+    fakeLineEpoll[fd - FAKE_FD_LINE] = false;
+  }
+  return(0);
+}
+
+int fakeIoctl(int fd, unsigned long request, void* arg) {
+  fakeCalls++;
+  if(fd == FAKE_FD_SPI) {
+    if((_IOC_TYPE(request) == SPI_IOC_MAGIC) && (_IOC_NR(request) == 0) && (_IOC_DIR(request) == _IOC_WRITE)) {
+      // all transfers of the message are sent with chip select active, so they make up one frame
+      struct spi_ioc_transfer* tr = (struct spi_ioc_transfer*)arg;
+      size_t num = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+      uint8_t frame[512];
+      size_t len = 0;
+      for(size_t i = 0; i < num; i++) {
+        if(len + tr[i].len > sizeof(frame)) {
+          errno = EMSGSIZE;
+          return(-1);
+        }
+        if(tr[i].tx_buf != 0) {
+          memcpy(frame + len, (const void*)(uintptr_t)tr[i].tx_buf, tr[i].len);
+        } else {
+          memset(frame + len, 0x00, tr[i].len);
+        }
+        len += tr[i].len;
+      }
+      fakeSpiFrame(frame, len);
+      len = 0;
+      for(size_t i = 0; i < num; i++) {
+        if(tr[i].rx_buf != 0) {
+          memcpy((void*)(uintptr_t)tr[i].rx_buf, frame + len, tr[i].len);
+        }
+        len += tr[i].len;
+      }
+      return(0);
+    }
+    // mode, word length and speed
+    return(0);
+
+  } else if(fd == FAKE_FD_GPIO) {
+    if(request == GPIO_GET_LINEHANDLE_IOCTL) {
+      struct gpiohandle_request* req = (struct gpiohandle_request*)arg;
+      req->fd = FAKE_FD_LINE + req->lineoffsets[0];
+      fakeLineRequested[req->lineoffsets[0]] = true;
+      return(0);
+    } else if(request == GPIO_GET_LINEEVENT_IOCTL) {
+      struct gpioevent_request* req = (struct gpioevent_request*)arg;
+      req->fd = FAKE_FD_LINE + req->lineoffset;
+      fakeLineRequested[req->lineoffset] = true;
+      return(0);
+    }
+
+  } else if((fd >= FAKE_FD_LINE) && (fd < FAKE_FD_LINE + FAKE_MAX_LINES)) {
+    struct gpiohandle_data* data = (struct gpiohandle_data*)arg;
+    if(request == GPIOHANDLE_GET_LINE_VALUES_IOCTL) {
+      fakeUpdate();
+      data->values[0] = ((fd - FAKE_FD_LINE) == BENCHMARK_LINE_DIO0) ? fakeDio0 : 0;
+      return(0);
+    } else if(request == GPIOHANDLE_SET_LINE_VALUES_IOCTL) {
+      return(0);
+    }
+  }
+
+  errno = EINVAL;
+  return(-1);
+}
+
+ssize_t fakeRead(int fd, void* buff, size_t len) {
+  fakeCalls++;
+  fakeUpdate();
+  if((fd == FAKE_FD_LINE + BENCHMARK_LINE_DIO0) && (fakeDio0Events > 0) && (len >= sizeof(struct gpioevent_data))) {
+    struct gpioevent_data* event = (struct gpioevent_data*)buff;
+    memset(event, 0, sizeof(struct gpioevent_data));
+    event->id = GPIOEVENT_EVENT_RISING_EDGE;
+    fakeDio0Events--;
+    return(sizeof(struct gpioevent_data));
+  }
+  errno = EAGAIN;
+  return(-1);
+}
+
+int fakeFcntl(int fd, int cmd, int arg) {
+  (void)fd;
+  (void)cmd;
+  (void)arg;
+  fakeCalls++;
+  return(0);
+}
+
+// sleeps until DIO0 event is pending or timeout expires
+bool fakeWaitDio0(int timeout) {
+  uint64_t end = nowUs() + (uint64_t)timeout * 1000ULL;
+  fakeUpdate();
+  while(fakeDio0Events == 0) {
+    uint64_t now = nowUs();
+    if((timeout >= 0) && (now >= end)) {
+      return(false);
+    }
+    uint64_t until = ((fakeTxEnd != 0) && ((timeout < 0) || (fakeTxEnd < end))) ? fakeTxEnd : end;
+    if((fakeTxEnd == 0) && (timeout < 0)) {
+      return(false);
+    }
+    if(until > now) {
+      usleep(until - now);
+    }
+    fakeUpdate();
+  }
+  return(true);
+}
+
+int fakePoll(struct pollfd* fds, nfds_t numFds, int timeout) {
+  fakeCalls++;
+  int ready = 0;
+  for(nfds_t i = 0; i < numFds; i++) {
+    fds[i].revents = 0;
+    if((fds[i].fd == FAKE_FD_LINE + BENCHMARK_LINE_DIO0) && fakeWaitDio0(timeout)) {
+      fds[i].revents = POLLIN;
+      ready++;
+    }
+  }
+  return(ready);
+}
+
+int fakeEpollCreate(int flags) {
+  (void)flags;
+  fakeCalls++;
+  return(FAKE_FD_EPOLL);
+}
+
+int fakeEpollCtl(int epfd, int op, int fd, struct epoll_event* event) {
+  (void)epfd;
+  (void)event;
+  fakeCalls++;
+  if((fd >= FAKE_FD_LINE) && (fd < FAKE_FD_LINE + FAKE_MAX_LINES)) {
+    fakeLineEpoll[fd - FAKE_FD_LINE] = (op != EPOLL_CTL_DEL);
+  }
+  return(0);
+}
+
+int fakeEpollWait(int epfd, struct epoll_event* events, int maxEvents, int timeout) {
+  (void)epfd;
+  fakeCalls++;
+  if((maxEvents < 1) || !fakeLineEpoll[BENCHMARK_LINE_DIO0] || !fakeWaitDio0(timeout)) {
+    return(0);
+  }
+  events[0].events = EPOLLIN;
+  events[0].data.u32 = BENCHMARK_LINE_DIO0;
+  return(1);
+}
+
+static const LinuxHalSyscalls_t fakeSyscalls = {
+  fakeOpen, fakeClose, fakeIoctl, fakeRead, fakeFcntl, fakePoll, fakeEpollCreate, fakeEpollCtl, fakeEpollWait
+};
+
+static volatile bool transmitted = false;
+
+void setFlag() {
+  transmitted = true;
+}
+
+int main(int argc, char** argv) {
+  uint32_t count = 100;
+  const char* spiDevice = "fake-spidev";
+  const char* gpioChip = "fake-gpiochip";
+  RADIOLIB_PIN_TYPE dio0 = BENCHMARK_LINE_DIO0;
+  RADIOLIB_PIN_TYPE rst = BENCHMARK_LINE_RST;
+  if(argc > 1) {
+    count = atoi(argv[1]);
+  }
+  bool fake = (argc <= 3);
+  if(fake) {
+    if(argc > 2) {
+      fakeToA = atoi(argv[2]);
+    }
+    fakeRegs[SX127X_REG_VERSION] = SX1278_CHIP_VERSION;
+    LinuxHal::setSyscalls(&fakeSyscalls);
+  } else {
+    spiDevice = argv[2];
+    gpioChip = argv[3];
+    dio0 = (argc > 4) ? atoi(argv[4]) : dio0;
+    rst = (argc > 5) ? atoi(argv[5]) : rst;
+  }
+
+  // chip select is driven by spidev
+  int16_t state = LinuxHal::begin(spiDevice, gpioChip);
+  if(state != ERR_NONE) {
+    printf("failed to open devices, code %d\n", state);
+    return(1);
+  }
+  SX1278 radio(new Module(RADIOLIB_NC, dio0, rst));
+  state = radio.begin();
+  if(state != ERR_NONE) {
+    printf("SX1278 failed to initialize, code %d\n", state);
+    return(1);
+  }
+
+  uint8_t data[32];
+  for(size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)i;
+  }
+  if(fake) {
+    printf("%u transmissions of %u bytes, fake devices with %u us time-on-air\n", (unsigned)count, (unsigned)sizeof(data), (unsigned)fakeToA);
+  } else {
+    printf("%u transmissions of %u bytes, %s and %s\n", (unsigned)count, (unsigned)sizeof(data), spiDevice, gpioChip);
+  }
+
+  // blocking transmit sleeps in poll until DIO0 rises
+  LinuxHal::resetStatistics();
+  fakeCalls = 0;
+  uint64_t start = nowUs();
+  for(uint32_t i = 0; i < count; i++) {
+    state = radio.transmit(data, sizeof(data));
+    if(state != ERR_NONE) {
+      printf("transmit failed, code %d\n", state);
+      return(1);
+    }
+  }
+  uint64_t elapsed = nowUs() - start;
+  printf("transmit():              %7.1f ioctl/packet, %8.1f us in ioctl/packet, %7.1f syscalls/packet, %8.1f us/packet\n",
+         (double)LinuxHal::getIoctlCount() / count, (double)LinuxHal::getIoctlTime() / count,
+         (double)fakeCalls / count, (double)elapsed / count);
+
+  // interrupt-driven transmit sleeps until DIO0 rises
+  radio.setDio0Action(setFlag);
+  LinuxHal::resetStatistics();
+  fakeCalls = 0;
+  start = nowUs();
+  for(uint32_t i = 0; i < count; i++) {
+    transmitted = false;
+    state = radio.startTransmit(data, sizeof(data));
+    while((state == ERR_NONE) && !transmitted) {
+      if(LinuxHal::handleInterrupts(1000) == 0) {
+        state = ERR_TX_TIMEOUT;
+      }
+    }
+    state |= radio.finishTransmit();
+    if(state != ERR_NONE) {
+      printf("startTransmit failed, code %d\n", state);
+      return(1);
+    }
+  }
+  elapsed = nowUs() - start;
+  printf("startTransmit() + epoll: %7.1f ioctl/packet, %8.1f us in ioctl/packet, %7.1f syscalls/packet, %8.1f us/packet\n",
+         (double)LinuxHal::getIoctlCount() / count, (double)LinuxHal::getIoctlTime() / count,
+         (double)fakeCalls / count, (double)elapsed / count);
+
+  radio.clearDio0Action();
+  LinuxHal::end();
+  return(0);
+}
@@ -0,0 +1,199 @@
+/*
+  RadioLib RadioManager emulator test
+
+  Drives five emulated LoRa radios on two channels from a single RadioManager:
+    - 0: SX1278, RX and TX, 434 MHz
+    - 1: SX1262, RX, 434 MHz
+    - 2: SX1262, TX, 435 MHz
+    - 3: SX1278, CAD, 434 MHz
+    - 4: SX1278, RX, 435 MHz
+
+  Packets with sequence numbers are queued through RadioManager::transmit as fast as the queue accepts them
+  and sent by whichever TX radio is free. Each TX radio has its own channel, so every packet has to be received
+  exactly once by one of the RX-only radios 1 and 4. Radio 3 has to detect some of the transmissions.
+
+  Before the first packet, the SX1262 TX radio is put to sleep with a wake-up time longer than the driver SPI timeout,
+  so its first transmission fails to start. The packet it was given has to stay queued and be sent later.
+
+  The test fails with non-zero exit code when any packet is lost, duplicated or corrupted, or any counter is off.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      RadioManagerTest.cpp $(find <RadioLib>/src -name '*.cpp') -o RadioManagerTest
+
+  Usage:
+    RadioManagerTest [packets]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated radios
+#define TEST_PIN_CS(n)          (10*(n) + 10)
+#define TEST_PIN_IRQ(n)         (10*(n) + 11)
+#define TEST_PIN_RST(n)         (10*(n) + 12)
+#define TEST_PIN_GPIO(n)        (10*(n) + 13)
+
+#define TEST_RADIOS             5
+#define TEST_MAX_PACKETS        256
+
+// channel of each radio in MHz
+static const float freqs[TEST_RADIOS] = { 434.0, 434.0, 435.0, 434.0, 435.0 };
+
+// SX1262 TX radio wakes up only after driver SPI timeout (5 s) has passed
+#define TEST_WAKE_UP_NS         6000000000ULL
+
+// virtual time limit in us
+#define TEST_TIME_LIMIT         600000000UL
+
+static uint16_t rxCount[TEST_RADIOS][TEST_MAX_PACKETS];
+static uint32_t corrupted = 0;
+
+void buildPacket(uint16_t seq, uint8_t* msg, size_t* len) {
+  *len = 8 + seq % 24;
+  msg[0] = (uint8_t)(seq >> 8);
+  msg[1] = (uint8_t)seq;
+  for(size_t i = 2; i < *len; i++) {
+    msg[i] = (uint8_t)(seq * 13 + i);
+  }
+}
+
+void packetReceived(const RadioPacket_t* packet, void* ctx) {
+  (void)ctx;
+  uint8_t msg[32];
+  size_t len = 0;
+  uint16_t seq = (packet->len >= 2) ? ((uint16_t)packet->data[0] << 8) | packet->data[1] : TEST_MAX_PACKETS;
+  if(seq < TEST_MAX_PACKETS) {
+    buildPacket(seq, msg, &len);
+  }
+  if((packet->status != ERR_NONE) || (seq >= TEST_MAX_PACKETS) || (packet->len != len) || (memcmp(packet->data, msg, len) != 0)) {
+    printf("radio %u received corrupted packet\n", packet->radio);
+    corrupted++;
+    return;
+  }
+  rxCount[packet->radio][seq]++;
+}
+
+int main(int argc, char** argv) {
+  uint16_t packets = 40;
+  if(argc > 1) {
+    packets = atoi(argv[1]);
+  }
+  if(packets > TEST_MAX_PACKETS) {
+    packets = TEST_MAX_PACKETS;
+  }
+
+  EmulatorHal::begin();
+  SX126xEmulator* chips[TEST_RADIOS] = { NULL };
+  for(uint8_t i = 0; i < TEST_RADIOS; i++) {
+    if((i == 1) || (i == 2)) {
+      chips[i] = new SX126xEmulator(TEST_PIN_CS(i), TEST_PIN_GPIO(i), TEST_PIN_IRQ(i), TEST_PIN_RST(i));
+      EmulatorHal::attach(chips[i]);
+    } else {
+      EmulatorHal::attach(new SX127xEmulator(TEST_PIN_CS(i), TEST_PIN_IRQ(i), TEST_PIN_RST(i), TEST_PIN_GPIO(i)));
+    }
+  }
+
+  SX1278 sx1278[3] = {
+    SX1278(new Module(TEST_PIN_CS(0), TEST_PIN_IRQ(0), TEST_PIN_RST(0), TEST_PIN_GPIO(0))),
+    SX1278(new Module(TEST_PIN_CS(3), TEST_PIN_IRQ(3), TEST_PIN_RST(3), TEST_PIN_GPIO(3))),
+    SX1278(new Module(TEST_PIN_CS(4), TEST_PIN_IRQ(4), TEST_PIN_RST(4), TEST_PIN_GPIO(4))),
+  };
+  SX1262 sx1262[2] = {
+    SX1262(new Module(TEST_PIN_CS(1), TEST_PIN_IRQ(1), TEST_PIN_RST(1), TEST_PIN_GPIO(1))),
+    SX1262(new Module(TEST_PIN_CS(2), TEST_PIN_IRQ(2), TEST_PIN_RST(2), TEST_PIN_GPIO(2))),
+  };
+  PhysicalLayer* radios[TEST_RADIOS] = { &sx1278[0], &sx1262[0], &sx1262[1], &sx1278[1], &sx1278[2] };
+  const uint8_t roles[TEST_RADIOS] = {
+    RADIOLIB_MANAGER_ROLE_RX | RADIOLIB_MANAGER_ROLE_TX, RADIOLIB_MANAGER_ROLE_RX, RADIOLIB_MANAGER_ROLE_TX,
+    RADIOLIB_MANAGER_ROLE_CAD, RADIOLIB_MANAGER_ROLE_RX,
+  };
+
+  const uint8_t sx1278Index[3] = { 0, 3, 4 };
+  for(uint8_t i = 0; i < 3; i++) {
+    int16_t state = sx1278[i].begin(freqs[sx1278Index[i]]);
+    if(state != ERR_NONE) {
+      printf("SX1278 %u failed to initialize, code %d\n", i, state);
+      return(1);
+    }
+  }
+  for(uint8_t i = 0; i < 2; i++) {
+    int16_t state = sx1262[i].begin(freqs[i + 1]);
+    if(state != ERR_NONE) {
+      printf("SX1262 %u failed to initialize, code %d\n", i, state);
+      return(1);
+    }
+  }
+
+  RadioManager manager;
+  for(uint8_t i = 0; i < TEST_RADIOS; i++) {
+    manager.addRadio(radios[i], roles[i]);
+  }
+  manager.setPacketAction(packetReceived);
+  manager.begin();
+
+  // the first transmission started on the TX radio fails, the chip does not wake up in time
+  chips[2]->setStartupTime(TEST_WAKE_UP_NS);
+  sx1262[1].sleep();
+
+  uint16_t queued = 0;
+  while(Module::millis() < TEST_TIME_LIMIT / 1000) {
+    if(queued < packets) {
+      uint8_t msg[32];
+      size_t len = 0;
+      buildPacket(queued, msg, &len);
+      if(manager.transmit(msg, len) == ERR_NONE) {
+        queued++;
+      }
+    }
+    manager.service(10);
+
+    // done once the RX-only radios got everything
+    bool done = (queued == packets);
+    for(uint16_t seq = 0; done && (seq < packets); seq++) {
+      done = (rxCount[1][seq] + rxCount[4][seq] > 0);
+    }
+    if(done) {
+      break;
+    }
+  }
+
+  // one more round for transmissions that finished with the last reception
+  manager.service();
+
+  bool ok = (corrupted == 0);
+  for(uint16_t seq = 0; seq < packets; seq++) {
+    if(rxCount[1][seq] + rxCount[4][seq] != 1) {
+      printf("packet %u received %u times by radio 1, %u times by radio 4\n", seq, rxCount[1][seq], rxCount[4][seq]);
+      ok = false;
+    }
+  }
+
+  uint32_t txPackets = 0;
+  for(uint8_t i = 0; i < TEST_RADIOS; i++) {
+    RadioManagerStats_t stats = manager.getStats(i);
+    printf("radio %u: %4lu RX, %2lu RX errors, %4lu TX, %2lu TX errors, %4lu CAD (%lu detected), %4lu IRQ, RX duty %5.1f %%\n", i,
+           (unsigned long)stats.rxPackets, (unsigned long)stats.rxErrors, (unsigned long)stats.txPackets, (unsigned long)stats.txErrors,
+           (unsigned long)stats.cadScans, (unsigned long)stats.cadDetected, (unsigned long)stats.irqCount, 100.0 * manager.getRxDuty(i));
+    txPackets += stats.txPackets;
+  }
+  printf("%u packets queued, %lu transmitted, %lu dropped, %lu ms\n", queued, (unsigned long)txPackets,
+         (unsigned long)manager.getDroppedPackets(), (unsigned long)Module::millis());
+
+  uint32_t violations = chips[1]->getBusyViolations() + chips[2]->getBusyViolations();
+  printf("%lu SPI conflicts, %lu BUSY violations\n", (unsigned long)EmulatorHal::getSpiConflicts(), (unsigned long)violations);
+  // the sleeping radio failed to start exactly once and transmitted once it woke up
+  RadioManagerStats_t txStats = manager.getStats(2);
+  RadioManagerStats_t cadStats = manager.getStats(3);
+  if((queued != packets) || (txPackets != packets) || (txStats.txErrors != 1) || (txStats.txPackets == 0) || (cadStats.cadDetected == 0) ||
+     (EmulatorHal::getSpiConflicts() > 0) || (violations > 0)) {
+    ok = false;
+  }
+  if(!ok) {
+    return(1);
+  }
+  printf("OK\n");
+  return(0);
+}
@@ -0,0 +1,177 @@
+/*
+  RadioLib SPI block transfer benchmark
+
+  Moves the same block of data in and out of the buffers of two emulated radios,
+  first one byte per SPI frame (as a driver without block transfers would),
+  then as a single frame:
+    - SX1278 FIFO through Module::SPIwriteRegisterBurst and Module::SPIreadRegisterBurst
+    - SX1262 data buffer through SX126x::writeBuffer and SX126x::readBuffer, block writes check
+      the status clocked out with every data byte without storing it (Module::SPItransferFrameChecked)
+
+  For each method, the number of SPI transactions and bytes is taken from the emulator,
+  throughput on the bus is calculated from the emulator's virtual time and the host CPU
+  time spent in the library is measured with the system clock. The data read back
+  are compared with the written ones, the benchmark exits with non-zero code on any error.
+
+  SX126x buffer access methods are private, so the whole library has to be built with RADIOLIB_GODMODE.
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -DRADIOLIB_GODMODE -I<core> -I<RadioLib>/src \
+      SPIBlockBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o SPIBlockBenchmark
+
+  Usage:
+    SPIBlockBenchmark [repetitions]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <RadioLib.h>
+
+#if !defined(RADIOLIB_GODMODE)
+  #error "SPIBlockBenchmark has to be built with RADIOLIB_GODMODE"
+#endif
+
+// pins of the emulated radios
+#define BENCHMARK_PIN_CS(n)     (10*(n) + 10)
+#define BENCHMARK_PIN_IRQ(n)    (10*(n) + 11)
+#define BENCHMARK_PIN_RST(n)    (10*(n) + 12)
+#define BENCHMARK_PIN_BUSY(n)   (10*(n) + 13)
+
+// block length, longest frame all methods accept
+#define BENCHMARK_BLOCK_LEN     255
+
+enum BenchmarkOp_t {
+  OP_FIFO_WRITE,
+  OP_FIFO_READ,
+  OP_BUFFER_WRITE,
+  OP_BUFFER_READ,
+};
+
+static Module* fifoMod;
+static SX1262* bufferRadio;
+static uint8_t txData[BENCHMARK_BLOCK_LEN];
+static uint8_t rxData[BENCHMARK_BLOCK_LEN];
+
+uint64_t hostNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+void runOp(BenchmarkOp_t op, bool block) {
+  switch(op) {
+    case OP_FIFO_WRITE:
+      // LoRa FIFO is accessed at FIFO address pointer
+      fifoMod->SPIwriteRegister(SX127X_REG_FIFO_ADDR_PTR, 0x00);
+      if(block) {
+        fifoMod->SPIwriteRegisterBurst(SX127X_REG_FIFO, txData, BENCHMARK_BLOCK_LEN);
+      } else {
+        for(size_t i = 0; i < BENCHMARK_BLOCK_LEN; i++) {
+          fifoMod->SPIwriteRegister(SX127X_REG_FIFO, txData[i]);
+        }
+      }
+      break;
+
+    case OP_FIFO_READ:
+      fifoMod->SPIwriteRegister(SX127X_REG_FIFO_ADDR_PTR, 0x00);
+      if(block) {
+        fifoMod->SPIreadRegisterBurst(SX127X_REG_FIFO, BENCHMARK_BLOCK_LEN, rxData);
+      } else {
+        for(size_t i = 0; i < BENCHMARK_BLOCK_LEN; i++) {
+          rxData[i] = fifoMod->SPIreadRegister(SX127X_REG_FIFO);
+        }
+      }
+      break;
+
+    case OP_BUFFER_WRITE:
+      if(block) {
+        bufferRadio->writeBuffer(txData, BENCHMARK_BLOCK_LEN);
+      } else {
+        for(size_t i = 0; i < BENCHMARK_BLOCK_LEN; i++) {
+          bufferRadio->writeBuffer(txData + i, 1, i);
+        }
+      }
+      break;
+
+    case OP_BUFFER_READ:
+      // SX126x buffer is read from Rx buffer offset, which is at the start of the buffer
+      if(block) {
+        bufferRadio->readBuffer(rxData, BENCHMARK_BLOCK_LEN);
+      } else {
+        uint8_t cmd[] = { SX126X_CMD_READ_BUFFER, 0x00 };
+        for(size_t i = 0; i < BENCHMARK_BLOCK_LEN; i++) {
+          cmd[1] = i;
+          bufferRadio->SPIreadCommand(cmd, 2, rxData + i, 1);
+        }
+      }
+      break;
+  }
+}
+
+bool measure(const char* name, BenchmarkOp_t op, bool block, uint32_t reps) {
+  if((op == OP_FIFO_READ) || (op == OP_BUFFER_READ)) {
+    memset(rxData, 0x00, sizeof(rxData));
+  }
+
+  EmulatorHal::resetStatistics();
+  uint64_t virtStart = EmulatorHal::getTimeNs();
+  uint64_t hostStart = hostNs();
+  for(uint32_t i = 0; i < reps; i++) {
+    runOp(op, block);
+  }
+  uint64_t hostElapsed = hostNs() - hostStart;
+  uint64_t virtElapsed = EmulatorHal::getTimeNs() - virtStart;
+
+  if(((op == OP_FIFO_READ) || (op == OP_BUFFER_READ)) && (memcmp(txData, rxData, BENCHMARK_BLOCK_LEN) != 0)) {
+    printf("%s: data read back do not match\n", name);
+    return(false);
+  }
+
+  double bytes = (double)reps * BENCHMARK_BLOCK_LEN;
+  printf("%-30s %6.1f transactions/block, %7.1f SPI bytes/block, %8.0f bytes/s on bus, %7.1f ns/byte host\n", name,
+         (double)EmulatorHal::getSpiTransactions() / reps, (double)EmulatorHal::getSpiBytes() / reps,
+         bytes / (virtElapsed / 1000000000.0), hostElapsed / bytes);
+  return(true);
+}
+
+int main(int argc, char** argv) {
+  uint32_t reps = 1000;
+  if(argc > 1) {
+    reps = atoi(argv[1]);
+  }
+  for(size_t i = 0; i < BENCHMARK_BLOCK_LEN; i++) {
+    txData[i] = (uint8_t)rand();
+  }
+
+  EmulatorHal::begin();
+  EmulatorHal::attach(new SX127xEmulator(BENCHMARK_PIN_CS(0), BENCHMARK_PIN_IRQ(0), BENCHMARK_PIN_RST(0)));
+  fifoMod = new Module(BENCHMARK_PIN_CS(0), BENCHMARK_PIN_IRQ(0), BENCHMARK_PIN_RST(0));
+  SX1278* fifoRadio = new SX1278(fifoMod);
+  int16_t state = fifoRadio->begin();
+  state |= fifoRadio->standby();
+  if(state != ERR_NONE) {
+    printf("SX1278 failed to initialize, code %d\n", state);
+    return(1);
+  }
+
+  EmulatorHal::attach(new SX126xEmulator(BENCHMARK_PIN_CS(1), BENCHMARK_PIN_BUSY(1), BENCHMARK_PIN_IRQ(1), BENCHMARK_PIN_RST(1)));
+  bufferRadio = new SX1262(new Module(BENCHMARK_PIN_CS(1), BENCHMARK_PIN_IRQ(1), BENCHMARK_PIN_RST(1), BENCHMARK_PIN_BUSY(1)));
+  state = bufferRadio->begin();
+  state |= bufferRadio->standby();
+  if(state != ERR_NONE) {
+    printf("SX1262 failed to initialize, code %d\n", state);
+    return(1);
+  }
+
+  printf("%u repetitions of %d byte block\n", (unsigned)reps, BENCHMARK_BLOCK_LEN);
+  bool ok = measure("SX1278 FIFO write, byte-wise", OP_FIFO_WRITE, false, reps);
+  ok &= measure("SX1278 FIFO read, byte-wise", OP_FIFO_READ, false, reps);
+  ok &= measure("SX1278 FIFO write, burst", OP_FIFO_WRITE, true, reps);
+  ok &= measure("SX1278 FIFO read, burst", OP_FIFO_READ, true, reps);
+  ok &= measure("SX1262 buffer write, byte-wise", OP_BUFFER_WRITE, false, reps);
+  ok &= measure("SX1262 buffer read, byte-wise", OP_BUFFER_READ, false, reps);
+  ok &= measure("SX1262 buffer write, block", OP_BUFFER_WRITE, true, reps);
+  ok &= measure("SX1262 buffer read, block", OP_BUFFER_READ, true, reps);
+  return(ok ? 0 : 1);
+}
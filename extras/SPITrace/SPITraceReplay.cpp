@@ -0,0 +1,182 @@
+/*
+  RadioLib SPI trace replayer
+
+  Replays binary SPI trace recorded with RADIOLIB_SPI_TRACE enabled against the chip emulator used by EmulatorHal,
+  so that register reads are checked against the behaviour of the emulated chip (mode changes, FIFO, IRQ flags,
+  BUSY timing), not just against the last written value as spi_trace.py --replay does.
+
+  Every record is sent as one SPI frame at the time it was started (relative to the first record), emulator events
+  scheduled in the meantime (e.g. end of transmission) are processed first. Data read in the trace are compared with
+  data returned by the emulator. The SPI frame is rebuilt the same way the driver builds it:
+    - register-based chips (SX127x, RF69, Si443x, CC1101): address byte followed by data
+    - nRF24: command byte followed by data, status is returned in place of the command
+    - command-based chips (SX126x, SX128x): command bytes, followed by status byte for reads, followed by data
+  GPIO activity (reset, nRF24 CE) is not part of the trace, so the emulated chip starts after power-on reset and CE stays low.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      SPITraceReplay.cpp $(find <RadioLib>/src -name '*.cpp') -o SPITraceReplay
+
+  Usage:
+    SPITraceReplay <SX127x|RF69|Si443x|CC1101|nRF24|SX126x|SX128x> <trace.bin>
+
+  Exits with non-zero code when any read does not match the emulated chip.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated chip
+#define REPLAY_PIN_CS           10
+#define REPLAY_PIN_IRQ          11
+#define REPLAY_PIN_RST          12
+#define REPLAY_PIN_BUSY         13
+
+// record header: sync, flags, timestamp (uint32, little endian), number of command bytes
+#define REPLAY_SYNC             0xA5
+#define REPLAY_HEADER_LEN       7
+
+enum ReplayFrame_t {
+  FRAME_REGISTER,
+  FRAME_NRF24,
+  FRAME_COMMAND,
+};
+
+int main(int argc, char** argv) {
+  if(argc < 3) {
+    printf("usage: %s <chip> <trace.bin>\n", argv[0]);
+    return(2);
+  }
+
+  EmulatorHal::begin();
+  EmulatedChip* chip = NULL;
+  CommandChipEmulator* cmdChip = NULL;
+  ReplayFrame_t kind = FRAME_REGISTER;
+  if(strcmp(argv[1], "SX127x") == 0) {
+    chip = new SX127xEmulator(REPLAY_PIN_CS, REPLAY_PIN_IRQ, REPLAY_PIN_RST);
+  } else if(strcmp(argv[1], "RF69") == 0) {
+    chip = new RF69Emulator(REPLAY_PIN_CS, REPLAY_PIN_IRQ, REPLAY_PIN_RST);
+  } else if(strcmp(argv[1], "Si443x") == 0) {
+    chip = new Si443xEmulator(REPLAY_PIN_CS, REPLAY_PIN_IRQ);
+  } else if(strcmp(argv[1], "CC1101") == 0) {
+    chip = new CC1101Emulator(REPLAY_PIN_CS, REPLAY_PIN_IRQ);
+  } else if(strcmp(argv[1], "nRF24") == 0) {
+    chip = new nRF24Emulator(REPLAY_PIN_CS, REPLAY_PIN_IRQ, REPLAY_PIN_RST);
+    kind = FRAME_NRF24;
+  } else if(strcmp(argv[1], "SX126x") == 0) {
+    cmdChip = new SX126xEmulator(REPLAY_PIN_CS, REPLAY_PIN_BUSY, REPLAY_PIN_IRQ, REPLAY_PIN_RST);
+    chip = cmdChip;
+    kind = FRAME_COMMAND;
+  } else if(strcmp(argv[1], "SX128x") == 0) {
+    cmdChip = new SX128xEmulator(REPLAY_PIN_CS, REPLAY_PIN_BUSY, REPLAY_PIN_IRQ, REPLAY_PIN_RST);
+    chip = cmdChip;
+    kind = FRAME_COMMAND;
+  } else {
+    printf("unknown chip %s\n", argv[1]);
+    return(2);
+  }
+  EmulatorHal::attach(chip);
+  EmulatorHal::digitalWrite(REPLAY_PIN_CS, HIGH);
+  EmulatorHal::digitalWrite(REPLAY_PIN_RST, HIGH);
+
+  FILE* f = fopen(argv[2], "rb");
+  if(f == NULL) {
+    printf("failed to open %s\n", argv[2]);
+    return(2);
+  }
+
+  uint32_t records = 0;
+  uint32_t reads = 0;
+  uint32_t mismatches = 0;
+  uint32_t start = 0;
+  uint8_t header[REPLAY_HEADER_LEN];
+  while(fread(header, 1, 1, f) == 1) {
+    // resynchronize on the next record after garbage
+    if((header[0] != REPLAY_SYNC) || (fread(header + 1, 1, REPLAY_HEADER_LEN - 1, f) != REPLAY_HEADER_LEN - 1)) {
+      continue;
+    }
+    bool write = header[1] & 0x01;
+    uint32_t timestamp = header[2] | ((uint32_t)header[3] << 8) | ((uint32_t)header[4] << 16) | ((uint32_t)header[5] << 24);
+    uint8_t cmdLen = header[6];
+
+    // command bytes, status, number of data bytes and data
+    uint8_t cmd[256];
+    uint8_t tail[2];
+    uint8_t data[256];
+    if((fread(cmd, 1, cmdLen, f) != cmdLen) || (fread(tail, 1, 2, f) != 2) || (fread(data, 1, tail[1], f) != tail[1])) {
+      printf("trace is truncated after %lu records\n", (unsigned long)records);
+      break;
+    }
+    uint8_t status = tail[0];
+    uint8_t dataLen = tail[1];
+
+    // run the emulator until the time the record was made
+    if(records == 0) {
+      start = timestamp;
+    }
+    uint64_t at = (uint64_t)(uint32_t)(timestamp - start) * 1000ULL;
+    if(at > EmulatorHal::getTimeNs()) {
+      EmulatorHal::advance(at - EmulatorHal::getTimeNs());
+    }
+
+    // rebuild the frame
+    uint8_t frame[RADIOLIB_SPI_HEADER_SIZE + 256 + 256];
+    size_t headLen = cmdLen;
+    memcpy(frame, cmd, cmdLen);
+    if((kind == FRAME_COMMAND) && !write) {
+      frame[headLen++] = 0x00;
+    }
+    if(write) {
+      memcpy(frame + headLen, data, dataLen);
+    } else {
+      memset(frame + headLen, 0x00, dataLen);
+    }
+    EmulatorHal::digitalWrite(REPLAY_PIN_CS, LOW);
+    EmulatorHal::spiTransfer(NULL, frame, headLen + dataLen);
+    EmulatorHal::digitalWrite(REPLAY_PIN_CS, HIGH);
+    records++;
+
+    // compare read data and nRF24 status, which reflects FIFO and IRQ state
+    bool match = true;
+    if(!write) {
+      reads++;
+      match = (memcmp(frame + headLen, data, dataLen) == 0);
+    }
+    if((kind == FRAME_NRF24) && (frame[0] != status)) {
+      match = false;
+    }
+    if(!match) {
+      mismatches++;
+      printf("%10lu %s", (unsigned long)(uint32_t)(timestamp - start), write ? "W" : "R");
+      for(uint8_t i = 0; i < cmdLen; i++) {
+        printf(" %02X", cmd[i]);
+      }
+      printf(": trace");
+      if(kind == FRAME_NRF24) {
+        printf(" [%02X]", status);
+      }
+      for(uint8_t i = 0; !write && (i < dataLen); i++) {
+        printf(" %02X", data[i]);
+      }
+      printf(", emulator");
+      if(kind == FRAME_NRF24) {
+        printf(" [%02X]", frame[0]);
+      }
+      for(uint8_t i = 0; !write && (i < dataLen); i++) {
+        printf(" %02X", frame[headLen + i]);
+      }
+      printf("\n");
+    }
+  }
+  fclose(f);
+
+  printf("%lu records, %lu reads, %lu did not match the emulated chip\n", (unsigned long)records, (unsigned long)reads, (unsigned long)mismatches);
+  if(cmdChip != NULL) {
+    printf("%lu BUSY violations\n", (unsigned long)cmdChip->getBusyViolations());
+    mismatches += cmdChip->getBusyViolations();
+  }
+  return(mismatches == 0 ? 0 : 1);
+}
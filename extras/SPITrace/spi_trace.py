@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+Decoder and replayer for binary SPI traces recorded with RADIOLIB_SPI_TRACE enabled.
+
+Record format (see Module::SPItraceRecord):
+  sync (0xA5), flags (bit 0 set for write), timestamp of transaction start (uint32, little endian, microseconds),
+  number of command bytes, command bytes, status, number of data bytes, data bytes
+
+Register and command names are taken directly from the module driver headers,
+so the decoder always matches the library version it is shipped with.
+
+Usage:
+  spi_trace.py <chip> <trace.bin> [--no-time] [--replay]
+
+  --no-time   omit timestamps, so that decoded traces from two library versions can be compared with diff
+  --replay    replay the trace against a plain register file and report reads that do not match previous writes,
+              chip behaviour (mode changes, FIFO, IRQ flags) is not simulated - use SPITraceReplay to replay against chip emulators
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SRC_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'src', 'modules')
+
+# kind: 'reg' for register-based chips (address in the first byte), 'cmd' for command-based chips
+# fifo: FIFO register address, burst access to it does not auto-increment
+# nRF24 multi-byte registers (addresses) are stored as one register, other chips auto-increment address on burst access
+CHIPS = {
+  'SX127x': {'kind': 'reg', 'headers': ['SX127x/SX127x.h', 'SX127x/SX1278.h', 'SX127x/SX1272.h'], 'regs': ['SX127X_REG_', 'SX1278_REG_', 'SX1272_REG_'], 'addrMask': 0x7F, 'fifo': 0x00},
+  'RF69':   {'kind': 'reg', 'headers': ['RF69/RF69.h'], 'regs': ['RF69_REG_'], 'addrMask': 0x7F, 'fifo': 0x00},
+  'Si443x': {'kind': 'reg', 'headers': ['Si443x/Si443x.h'], 'regs': ['SI443X_REG_'], 'addrMask': 0x7F, 'fifo': 0x7F},
+  'CC1101': {'kind': 'reg', 'headers': ['CC1101/CC1101.h'], 'regs': ['CC1101_REG_'], 'cmds': ['CC1101_CMD_'], 'addrMask': 0x3F, 'fifo': 0x3F},
+  'nRF24':  {'kind': 'nrf', 'headers': ['nRF24/nRF24.h'], 'regs': ['NRF24_REG_'], 'cmds': ['NRF24_CMD_']},
+  'SX126x': {'kind': 'cmd', 'headers': ['SX126x/SX126x.h'], 'regs': ['SX126X_REG_'], 'cmds': ['SX126X_CMD_'], 'prefix': 'SX126X'},
+  'SX128x': {'kind': 'cmd', 'headers': ['SX128x/SX128x.h'], 'regs': ['SX128X_REG_'], 'cmds': ['SX128X_CMD_'], 'prefix': 'SX128X'},
+}
+
+DEFINE = re.compile(r'^#define\s+(\w+)\s+(0x[0-9A-Fa-f]+|0b[01]+|\d+)\b', re.M)
+
+
+def load_names(chip, prefixes):
+  names = {}
+  for header in CHIPS[chip]['headers']:
+    with open(os.path.join(SRC_DIR, header)) as f:
+      for name, value in DEFINE.findall(f.read()):
+        if any(name.startswith(p) for p in prefixes):
+          names.setdefault(int(value, 0), []).append(name)
+  return names
+
+
+def name_of(names, value, width=2):
+  if value in names:
+    return '/'.join(names[value][:2])
+  return '0x{:0{}X}'.format(value, width)
+
+
+def parse(data):
+  # scan for sync bytes, so that traces captured from the middle of a stream can still be decoded
+  pos = 0
+  while pos + 9 <= len(data):
+    if data[pos] != 0xA5:
+      pos += 1
+      continue
+    flags, timestamp, cmdLen = struct.unpack_from('<BIB', data, pos + 1)
+    cmdStart = pos + 7
+    if cmdStart + cmdLen + 2 > len(data):
+      break
+    cmd = data[cmdStart:cmdStart + cmdLen]
+    status = data[cmdStart + cmdLen]
+    dataLen = data[cmdStart + cmdLen + 1]
+    payStart = cmdStart + cmdLen + 2
+    if payStart + dataLen > len(data):
+      break
+    yield {'write': bool(flags & 0x01), 'time': timestamp, 'cmd': bytes(cmd), 'status': status, 'data': bytes(data[payStart:payStart + dataLen])}
+    pos = payStart + dataLen
+
+
+def describe(chip, rec, regs, cmds):
+  """Returns text description of the record and (register address, auto-increment) pair for simulated register accesses."""
+  cfg = CHIPS[chip]
+  cmd = rec['cmd']
+  op = 'W' if rec['write'] else 'R'
+
+  if cfg['kind'] == 'reg':
+    # CC1101 command strobes are single bytes without data
+    if (chip == 'CC1101') and (len(rec['data']) == 0):
+      return 'STROBE {}'.format(name_of(cmds, cmd[0])), None
+    addr = cmd[0] & cfg['addrMask']
+    if addr == cfg['fifo']:
+      # FIFO access does not auto-increment and can not be simulated
+      return '{} {}'.format(op, name_of(regs, addr)), None
+    return '{} {}'.format(op, name_of(regs, addr)), (addr, True)
+
+  if cfg['kind'] == 'nrf':
+    if cmd[0] < 0x40:
+      addr = cmd[0] & 0x1F
+      return '{} {}'.format('W' if cmd[0] & 0x20 else 'R', name_of(regs, addr)), (addr, False)
+    return name_of(cmds, cmd[0]), None
+
+  # command-based chips - register access commands carry 16-bit address
+  prefix = cfg['prefix']
+  cmdName = name_of(cmds, cmd[0])
+  if (cmdName in (prefix + '_CMD_WRITE_REGISTER', prefix + '_CMD_READ_REGISTER')) and (len(cmd) >= 3):
+    addr = (cmd[1] << 8) | cmd[2]
+    return '{} {}'.format(op, name_of(regs, addr, 4)), (addr, True)
+  args = ' '.join('{:02X}'.format(b) for b in cmd[1:])
+  return '{} {}'.format(cmdName, args).rstrip(), None
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Decode or replay RadioLib binary SPI trace.')
+  parser.add_argument('chip', choices=sorted(CHIPS.keys()))
+  parser.add_argument('trace')
+  parser.add_argument('--no-time', action='store_true', help='omit timestamps')
+  parser.add_argument('--replay', action='store_true', help='replay against simulated register file')
+  args = parser.parse_args()
+
+  cfg = CHIPS[args.chip]
+  regs = load_names(args.chip, cfg['regs'])
+  cmds = load_names(args.chip, cfg.get('cmds', []))
+
+  with open(args.trace, 'rb') as f:
+    data = f.read()
+
+  # simulated register file - holds the last value written to each register
+  model = {}
+  mismatches = 0
+  start = None
+  for rec in parse(data):
+    text, access = describe(args.chip, rec, regs, cmds)
+    line = ''
+    if not args.no_time:
+      if start is None:
+        start = rec['time']
+      line += '{:>10} '.format((rec['time'] - start) & 0xFFFFFFFF)
+    line += '{:<40} {}'.format(text, ' '.join('{:02X}'.format(b) for b in rec['data']))
+    if rec['status']:
+      line += '  [status 0x{:02X}]'.format(rec['status'])
+
+    if args.replay and (access is not None):
+      addr, consecutive = access
+      for i, b in enumerate(rec['data']):
+        key = addr + i if consecutive else (addr, i)
+        if rec['write']:
+          model[key] = b
+        elif (key in model) and (model[key] != b):
+          line += '  [!] 0x{:02X} expected at +{}'.format(model[key], i)
+          model[key] = b
+          mismatches += 1
+
+    print(line)
+
+  if args.replay:
+    print('{} read(s) did not match the simulated register file'.format(mismatches))
+  return(0)
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,152 @@
+/*
+  RadioLib shared SPI bus emulator test
+
+  Runs two SX1262 and one SX1278 driver against chip emulators that share one SPI bus.
+  Emulators are attached in the reverse order of initialization, so any SPI frame that reaches
+  a chip whose Module was not initialized yet (e.g. because chip select of an idle chip is low)
+  ends up in the wrong chip and makes initialization fail.
+
+  After all radios are initialized, they are added to SPIArbiter and packets are exchanged between
+  the two SX1262 in both directions while SX1278 is receiving on a different frequency. Interrupts
+  of SX1262 post arbiter jobs that read IRQ status, so the job of the receiving radio runs in the middle
+  of the command sequence of the transmitting one. The test fails with non-zero exit code when
+  any driver call fails, any packet is corrupted or lost, any job is not run, more than one chip
+  is selected during SPI transaction or any command is sent to SX1262 while its BUSY is high.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      SharedBusTest.cpp $(find <RadioLib>/src -name '*.cpp') -o SharedBusTest
+
+  Usage:
+    SharedBusTest [packets]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated radios
+#define TEST_PIN_CS(n)          (10*(n) + 10)
+#define TEST_PIN_IRQ(n)         (10*(n) + 11)
+#define TEST_PIN_RST(n)         (10*(n) + 12)
+#define TEST_PIN_BUSY(n)        (10*(n) + 13)
+
+// number of SX1262 radios
+#define TEST_SX1262             2
+
+static SX1262* radios[TEST_SX1262];
+static Module* modules[TEST_SX1262 + 1];
+static SPIArbiter arbiter;
+static volatile bool received[TEST_SX1262] = { false, false };
+
+// arbiter job, reads IRQ status of the radio that raised the interrupt
+void readIrq(void* ctx) {
+  uint8_t i = (uint8_t)(uintptr_t)ctx;
+  if(radios[i]->getIrqStatus() & SX126X_IRQ_RX_DONE) {
+    received[i] = true;
+  }
+}
+
+void rxDone0() {
+  arbiter.post(modules[0], readIrq, (void*)0);
+}
+
+void rxDone1() {
+  arbiter.post(modules[1], readIrq, (void*)1);
+}
+
+// returns true if the packet was received correctly
+bool exchange(uint8_t from, uint8_t to, uint16_t seq) {
+  uint8_t msg[32];
+  size_t len = 8 + seq % (sizeof(msg) - 8);
+  for(size_t i = 0; i < len; i++) {
+    msg[i] = (uint8_t)(seq * 13 + from * 7 + i);
+  }
+
+  received[to] = false;
+  int16_t state = radios[to]->startReceive();
+  state |= radios[from]->transmit(msg, len);
+  if(state != ERR_NONE) {
+    printf("packet %u from radio %u failed, code %d\n", seq, from, state);
+    return(false);
+  }
+
+  // jobs that were not run during transmission yet
+  arbiter.service();
+
+  uint8_t buff[sizeof(msg)];
+  if(!received[to] || (radios[to]->getPacketLength() != len) || (radios[to]->readData(buff, len) != ERR_NONE) || (memcmp(buff, msg, len) != 0)) {
+    printf("packet %u from radio %u was not received by radio %u\n", seq, from, to);
+    return(false);
+  }
+  return(true);
+}
+
+int main(int argc, char** argv) {
+  uint16_t packets = 10;
+  if(argc > 1) {
+    packets = atoi(argv[1]);
+  }
+
+  EmulatorHal::begin();
+
+  // attach in reverse order, so that the chips of radios that are not initialized yet come first
+  SX127xEmulator* sx1278Chip = new SX127xEmulator(TEST_PIN_CS(TEST_SX1262), TEST_PIN_IRQ(TEST_SX1262), TEST_PIN_RST(TEST_SX1262));
+  EmulatorHal::attach(sx1278Chip);
+  SX126xEmulator* chips[TEST_SX1262];
+  for(int i = TEST_SX1262 - 1; i >= 0; i--) {
+    chips[i] = new SX126xEmulator(TEST_PIN_CS(i), TEST_PIN_BUSY(i), TEST_PIN_IRQ(i), TEST_PIN_RST(i));
+    EmulatorHal::attach(chips[i]);
+  }
+
+  for(int i = 0; i < TEST_SX1262; i++) {
+    modules[i] = new Module(TEST_PIN_CS(i), TEST_PIN_IRQ(i), TEST_PIN_RST(i), TEST_PIN_BUSY(i));
+    radios[i] = new SX1262(modules[i]);
+    int16_t state = radios[i]->begin();
+    if(state != ERR_NONE) {
+      printf("SX1262 %d failed to initialize, code %d\n", i, state);
+      return(1);
+    }
+  }
+  radios[0]->setDio1Action(rxDone0);
+  radios[1]->setDio1Action(rxDone1);
+
+  modules[TEST_SX1262] = new Module(TEST_PIN_CS(TEST_SX1262), TEST_PIN_IRQ(TEST_SX1262), TEST_PIN_RST(TEST_SX1262));
+  SX1278 sx1278(modules[TEST_SX1262]);
+  int16_t state = sx1278.begin(470.0);
+  state |= sx1278.startReceive();
+  if(state != ERR_NONE) {
+    printf("SX1278 failed to initialize, code %d\n", state);
+    return(1);
+  }
+
+  for(uint8_t i = 0; i <= TEST_SX1262; i++) {
+    arbiter.addDevice(modules[i]);
+  }
+
+  for(uint16_t seq = 0; seq < packets; seq++) {
+    if(!exchange(0, 1, seq) || !exchange(1, 0, seq)) {
+      return(1);
+    }
+  }
+
+  // every packet posted two jobs (transmission and reception done), the receiving radio preempted the transmitting one
+  uint32_t jobs = 0;
+  uint32_t preempted = 0;
+  for(uint8_t i = 0; i < TEST_SX1262; i++) {
+    SPIArbiterStats_t stats = arbiter.getStats(modules[i]);
+    jobs += stats.jobs;
+    preempted += stats.preempted;
+  }
+
+  uint32_t violations = chips[0]->getBusyViolations() + chips[1]->getBusyViolations();
+  printf("%u packets each way, %lu jobs (%lu preempted), %lu SPI conflicts, %lu BUSY violations, %lu packets received by SX1278\n", packets,
+         (unsigned long)jobs, (unsigned long)preempted, (unsigned long)EmulatorHal::getSpiConflicts(), (unsigned long)violations,
+         (unsigned long)sx1278Chip->getRxPackets());
+  if((EmulatorHal::getSpiConflicts() > 0) || (violations > 0) || (sx1278Chip->getRxPackets() > 0) || (jobs != 4U*packets) || (preempted == 0)) {
+    return(1);
+  }
+  printf("OK\n");
+  return(0);
+}
@@ -0,0 +1,580 @@
+/*
+  RadioLib FIFO streaming benchmark
+
+  Transfers the same block of data between two emulated radios of the selected driver,
+  first split into packets that fit into the FIFO, then as large packets that are streamed
+  through the FIFO by the driver's serviceFifo. Every packet length is transferred three times:
+  with both radios serviced from interrupts, with the transmitter blocked in transmit()
+  and with the receiver blocked in receive(), while the other radio is serviced from interrupts.
+  All transfers run on the emulator's virtual time, so the result is the on-air throughput
+  including preamble, sync word, CRC and the gaps between packets.
+
+  Supported drivers:
+    sx127x - SX1278 in FSK mode, large packets in fixed length mode, DIO1 FIFO level interrupt
+    rf69   - large packets in unlimited length mode, DIO1 FIFO level interrupt
+    cc1101 - large packets in infinite length mode, GDO2 FIFO threshold interrupt
+    si443x - Si4432 at 256 kbps, 64 and 255 byte packets, large packets in unlimited length mode,
+             FIFO almost empty/full nIRQ interrupt
+
+  The received data are compared with the transmitted ones and FIFO underruns and overruns
+  reported by the emulator are checked, the benchmark exits with non-zero code on any error.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      StreamBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o StreamBenchmark
+
+  Usage:
+    StreamBenchmark <driver> [total bytes] [bit rate in kbps] [large packet length]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated radios
+#define BENCHMARK_PIN_CS(n)     (10*(n) + 10)
+#define BENCHMARK_PIN_IRQ(n)    (10*(n) + 11)
+#define BENCHMARK_PIN_GPIO(n)   (10*(n) + 12)
+#define BENCHMARK_PIN_RST(n)    (10*(n) + 13)
+#define BENCHMARK_PIN_TRIGGER   50
+
+// delay between entering receive() and start of transmission in blocking Rx mode
+#define BENCHMARK_TRIGGER_DELAY 1000000
+
+// drives the trigger pin high at the scheduled virtual time, so that transmission can be started
+// from interrupt while the receiver is blocked in receive() - emulated receiver only gets packets
+// that start while it is already receiving
+class TriggerEmulator : public EmulatedChip {
+  public:
+    TriggerEmulator() : EmulatedChip(BENCHMARK_PIN_TRIGGER) {
+      _time = UINT64_MAX;
+      _level = LOW;
+    }
+
+    void schedule(uint64_t time) {
+      _time = time;
+      _level = LOW;
+    }
+
+    void spiTransfer(uint8_t* buff, size_t len) {
+      (void)buff;
+      (void)len;
+    }
+
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+      if(pin != BENCHMARK_PIN_TRIGGER) {
+        return(false);
+      }
+      *value = _level;
+      return(true);
+    }
+
+    void update(uint64_t now) {
+      if(now >= _time) {
+        _level = HIGH;
+        _time = UINT64_MAX;
+      }
+    }
+
+    uint64_t nextEvent() {
+      return(_time);
+    }
+
+  private:
+    uint64_t _time;
+    RADIOLIB_PIN_STATUS _level;
+};
+
+// chip specific part of the benchmark, radio 0 transmits and radio 1 receives
+class StreamDriver {
+  public:
+    StreamDriver(const char* name, float bitRate, size_t total, size_t largeLen, size_t smallLen, size_t smallLen2 = 0) {
+      this->name = name;
+      this->bitRate = bitRate;
+      this->total = total;
+      this->largeLen = largeLen;
+      this->smallLen[0] = smallLen;
+      this->smallLen[1] = smallLen2;
+      radios[0] = NULL;
+      radios[1] = NULL;
+    }
+    virtual ~StreamDriver() {}
+
+    const char* name;
+    float bitRate;
+    size_t total;
+    size_t largeLen;
+    size_t smallLen[2];
+    PhysicalLayer* radios[2];
+
+    // creates emulated chip and radio n
+    virtual int16_t begin(int n, float bitRate) = 0;
+
+    // prints the allowed range of large packet length if the requested one is outside of it
+    virtual bool checkLargeLength(size_t len) = 0;
+
+    // sets packet length of radio n, large packets are streamed through FIFO
+    virtual int16_t setPacketLength(int n, size_t len, bool large) = 0;
+
+    // starts reception of one packet on radio 1
+    virtual int16_t startReceive(uint8_t* data, size_t len, bool large) = 0;
+
+    // whether receiver signals the end of the packet from its FIFO interrupt
+    virtual bool rxStreaming(bool large) {
+      return(large);
+    }
+
+    // whether transmitter has to service its FIFO interrupt before the next packet
+    virtual bool txDoneFromFifo() {
+      return(false);
+    }
+
+    virtual bool serviceFifo(int n) = 0;
+    virtual void setActions(void (*txFifo)(void), void (*rxFifo)(void), void (*rxDone)(void)) = 0;
+    virtual uint32_t getTxUnderruns() = 0;
+    virtual uint32_t getRxOverruns() = 0;
+};
+
+class SX127xDriver : public StreamDriver {
+  public:
+    // longest variable length frame fits into FIFO together with the length byte
+    SX127xDriver() : StreamDriver("sx127x", 48.0, 8 * SX127X_MAX_PACKET_LENGTH_FSK_FIXED, SX127X_MAX_PACKET_LENGTH_FSK_FIXED, SX127X_MAX_PACKET_LENGTH_FSK - 1) {}
+
+    int16_t begin(int n, float bitRate) {
+      _chips[n] = new SX127xEmulator(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n), BENCHMARK_PIN_GPIO(n));
+      EmulatorHal::attach(_chips[n]);
+      _radios[n] = new SX1278(new Module(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n), BENCHMARK_PIN_GPIO(n)));
+      radios[n] = _radios[n];
+      return(_radios[n]->beginFSK(434.0, bitRate));
+    }
+
+    bool checkLargeLength(size_t len) {
+      if((len <= SX127X_MAX_PACKET_LENGTH_FSK) || (len > SX127X_MAX_PACKET_LENGTH_FSK_FIXED)) {
+        printf("large packet length must be between %d and %d\n", SX127X_MAX_PACKET_LENGTH_FSK + 1, SX127X_MAX_PACKET_LENGTH_FSK_FIXED);
+        return(false);
+      }
+      return(true);
+    }
+
+    int16_t setPacketLength(int n, size_t len, bool large) {
+      return(large ? _radios[n]->fixedPacketLengthMode(len) : _radios[n]->variablePacketLengthMode(len));
+    }
+
+    int16_t startReceive(uint8_t* data, size_t len, bool large) {
+      return(large ? _radios[1]->startReceiveStream(data, len) : _radios[1]->startReceive());
+    }
+
+    bool serviceFifo(int n) {
+      return(_radios[n]->serviceFifo());
+    }
+
+    void setActions(void (*txFifo)(void), void (*rxFifo)(void), void (*rxDone)(void)) {
+      _radios[0]->setFifoAction(txFifo);
+      _radios[1]->setFifoAction(rxFifo);
+      _radios[1]->setDio0Action(rxDone);
+    }
+
+    uint32_t getTxUnderruns() {
+      return(_chips[0]->getTxUnderruns());
+    }
+
+    uint32_t getRxOverruns() {
+      return(_chips[1]->getRxOverruns());
+    }
+
+  private:
+    SX127xEmulator* _chips[2];
+    SX1278* _radios[2];
+};
+
+class RF69Driver : public StreamDriver {
+  public:
+    RF69Driver() : StreamDriver("rf69", 250.0, 65536, 8192, RF69_MAX_PACKET_LENGTH) {}
+
+    int16_t begin(int n, float bitRate) {
+      _chips[n] = new RF69Emulator(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n), BENCHMARK_PIN_GPIO(n));
+      EmulatorHal::attach(_chips[n]);
+      _radios[n] = new RF69(new Module(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n), BENCHMARK_PIN_GPIO(n)));
+      radios[n] = _radios[n];
+      int16_t state = _radios[n]->begin(434.0, 4.8, 50.0, 500.0);
+      state |= _radios[n]->setBitRate(bitRate);
+      state |= _radios[n]->setFrequencyDeviation(500.0 - bitRate/2);
+      return(state);
+    }
+
+    bool checkLargeLength(size_t len) {
+      if((len <= RF69_MAX_PACKET_LENGTH) || (len > RF69_MAX_PACKET_LENGTH_UNLIMITED)) {
+        printf("large packet length must be between %d and %d\n", RF69_MAX_PACKET_LENGTH + 1, RF69_MAX_PACKET_LENGTH_UNLIMITED);
+        return(false);
+      }
+      return(true);
+    }
+
+    int16_t setPacketLength(int n, size_t len, bool large) {
+      return(large ? _radios[n]->unlimitedPacketLengthMode() : _radios[n]->variablePacketLengthMode(len));
+    }
+
+    // unlimited length packet has no PayloadReady interrupt, its end is detected while draining the FIFO
+    int16_t startReceive(uint8_t* data, size_t len, bool large) {
+      return(large ? _radios[1]->startReceiveStream(data, len) : _radios[1]->startReceive());
+    }
+
+    bool serviceFifo(int n) {
+      return(_radios[n]->serviceFifo());
+    }
+
+    void setActions(void (*txFifo)(void), void (*rxFifo)(void), void (*rxDone)(void)) {
+      _radios[0]->setFifoAction(txFifo);
+      _radios[1]->setFifoAction(rxFifo);
+      _radios[1]->setDio0Action(rxDone);
+    }
+
+    uint32_t getTxUnderruns() {
+      return(_chips[0]->getTxUnderruns());
+    }
+
+    uint32_t getRxOverruns() {
+      return(_chips[1]->getRxOverruns());
+    }
+
+  private:
+    RF69Emulator* _chips[2];
+    RF69* _radios[2];
+};
+
+class CC1101Driver : public StreamDriver {
+  public:
+    // longest variable length frame fits into FIFO together with length byte, RSSI and LQI
+    CC1101Driver() : StreamDriver("cc1101", 250.0, 65536, 8191, CC1101_FIFO_SIZE - 3) {}
+
+    int16_t begin(int n, float bitRate) {
+      _chips[n] = new CC1101Emulator(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_GPIO(n));
+      EmulatorHal::attach(_chips[n]);
+      _radios[n] = new CC1101(new Module(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), RADIOLIB_NC, BENCHMARK_PIN_GPIO(n)));
+      radios[n] = _radios[n];
+      return(_radios[n]->begin(434.0, bitRate, 127.0, 812.0));
+    }
+
+    bool checkLargeLength(size_t len) {
+      if((len <= CC1101_MAX_PACKET_LENGTH_VARIABLE) || (len > CC1101_MAX_PACKET_LENGTH_FIXED) || ((len % 256) == 0)) {
+        printf("large packet length must be between %d and %ld and not a multiple of 256\n", CC1101_MAX_PACKET_LENGTH_VARIABLE + 1, (long)CC1101_MAX_PACKET_LENGTH_FIXED);
+        return(false);
+      }
+      return(true);
+    }
+
+    // packets above 255 bytes are sent in infinite packet length mode, switching to fixed one for the last 255 bytes
+    int16_t setPacketLength(int n, size_t len, bool large) {
+      return(large ? _radios[n]->fixedPacketLengthMode(len) : _radios[n]->variablePacketLengthMode(len));
+    }
+
+    int16_t startReceive(uint8_t* data, size_t len, bool large) {
+      return(large ? _radios[1]->startReceiveStream(data, len) : _radios[1]->startReceive());
+    }
+
+    // the end of the packet is signalled by GDO0, the rest of it is drained by readData
+    bool rxStreaming(bool large) {
+      (void)large;
+      return(false);
+    }
+
+    bool serviceFifo(int n) {
+      return(_radios[n]->serviceFifo());
+    }
+
+    void setActions(void (*txFifo)(void), void (*rxFifo)(void), void (*rxDone)(void)) {
+      _radios[0]->setFifoAction(txFifo);
+      _radios[1]->setFifoAction(rxFifo);
+      _radios[1]->setGdo0Action(rxDone);
+    }
+
+    uint32_t getTxUnderruns() {
+      return(_chips[0]->getTxUnderflows());
+    }
+
+    uint32_t getRxOverruns() {
+      return(_chips[1]->getRxOverflows());
+    }
+
+  private:
+    CC1101Emulator* _chips[2];
+    CC1101* _radios[2];
+};
+
+class Si443xDriver : public StreamDriver {
+  public:
+    // 64-byte packets fit into FIFO, 255-byte variable length packets are already streamed
+    Si443xDriver() : StreamDriver("si443x", 256.0, 65536, 4096, SI443X_FIFO_SIZE, SI443X_MAX_PACKET_LENGTH_VARIABLE) {}
+
+    int16_t begin(int n, float bitRate) {
+      _chips[n] = new Si443xEmulator(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n));
+      EmulatorHal::attach(_chips[n]);
+      _radios[n] = new Si4432(new Module(BENCHMARK_PIN_CS(n), BENCHMARK_PIN_IRQ(n), BENCHMARK_PIN_RST(n)));
+      radios[n] = _radios[n];
+      return(_radios[n]->begin(434.0, bitRate, 125.0, 577.0));
+    }
+
+    bool checkLargeLength(size_t len) {
+      if((len <= SI443X_MAX_PACKET_LENGTH_VARIABLE) || (len > SI443X_MAX_PACKET_LENGTH_UNLIMITED)) {
+        printf("large packet length must be between %d and %ld\n", SI443X_MAX_PACKET_LENGTH_VARIABLE + 1, (long)SI443X_MAX_PACKET_LENGTH_UNLIMITED);
+        return(false);
+      }
+      return(true);
+    }
+
+    int16_t setPacketLength(int n, size_t len, bool large) {
+      (void)len;
+      return(large ? _radios[n]->unlimitedPacketLengthMode() : _radios[n]->variablePacketLengthMode());
+    }
+
+    int16_t startReceive(uint8_t* data, size_t len, bool large) {
+      (void)large;
+      return(_radios[1]->startReceiveStream(data, len));
+    }
+
+    // all interrupts come through nIRQ, which also signals the end of every packet
+    bool rxStreaming(bool large) {
+      (void)large;
+      return(true);
+    }
+
+    bool txDoneFromFifo() {
+      return(true);
+    }
+
+    bool serviceFifo(int n) {
+      return(_radios[n]->serviceFifo());
+    }
+
+    void setActions(void (*txFifo)(void), void (*rxFifo)(void), void (*rxDone)(void)) {
+      (void)rxDone;
+      _radios[0]->setFifoAction(txFifo);
+      _radios[1]->setFifoAction(rxFifo);
+    }
+
+    uint32_t getTxUnderruns() {
+      return(_chips[0]->getTxUnderflows());
+    }
+
+    uint32_t getRxOverruns() {
+      return(_chips[1]->getRxOverflows());
+    }
+
+  private:
+    Si443xEmulator* _chips[2];
+    Si4432* _radios[2];
+};
+
+// the radio that is blocked in transmit() or receive() services its own FIFO
+enum {
+  BENCHMARK_MODE_INTERRUPT,
+  BENCHMARK_MODE_BLOCKING_TX,
+  BENCHMARK_MODE_BLOCKING_RX,
+  BENCHMARK_MODES
+};
+
+static const char* modeNames[BENCHMARK_MODES] = { "interrupt", "blocking Tx", "blocking Rx" };
+
+static StreamDriver* driver;
+static TriggerEmulator trigger;
+static uint8_t* txData;
+static uint8_t* rxData;
+static float bitRate;
+
+static volatile uint8_t mode = BENCHMARK_MODE_INTERRUPT;
+static volatile bool streaming = false;
+static volatile bool transmitted = false;
+static volatile bool received = false;
+static uint8_t* triggerData;
+static size_t triggerLen;
+static volatile int16_t triggerState = ERR_NONE;
+
+void txFifo() {
+  if((mode != BENCHMARK_MODE_BLOCKING_TX) && driver->serviceFifo(0)) {
+    transmitted = true;
+  }
+}
+
+void rxFifo() {
+  if((mode != BENCHMARK_MODE_BLOCKING_RX) && driver->serviceFifo(1) && streaming) {
+    received = true;
+  }
+}
+
+void rxDone() {
+  received = true;
+}
+
+void txStart() {
+  triggerState = driver->radios[0]->startTransmit(triggerData, triggerLen);
+}
+
+// returns the transfer time in us, or 0 on error
+uint32_t transfer(size_t frameLen, bool large, uint8_t transferMode) {
+  PhysicalLayer* tx = driver->radios[0];
+  PhysicalLayer* rx = driver->radios[1];
+  size_t total = driver->total;
+  size_t configLen = 0;
+  mode = transferMode;
+  streaming = driver->rxStreaming(large);
+
+  memset(rxData, 0, total);
+  uint32_t start = Module::micros();
+  for(size_t pos = 0; pos < total; pos += frameLen) {
+    size_t len = total - pos;
+    if(len > frameLen) {
+      len = frameLen;
+    }
+
+    // fixed packet length has to be changed for the last packet
+    int16_t state = ERR_NONE;
+    if(len != configLen) {
+      state = driver->setPacketLength(0, len, large);
+      state |= driver->setPacketLength(1, len, large);
+      if(state != ERR_NONE) {
+        printf("failed to set packet length %u, code %d\n", (unsigned)len, state);
+        return(0);
+      }
+      configLen = len;
+    }
+
+    transmitted = false;
+    received = false;
+    if(mode == BENCHMARK_MODE_BLOCKING_RX) {
+      triggerData = txData + pos;
+      triggerLen = len;
+      triggerState = ERR_UNKNOWN;
+      trigger.schedule(EmulatorHal::getTimeNs() + BENCHMARK_TRIGGER_DELAY);
+      state = rx->receive(rxData + pos, len);
+      state |= triggerState;
+      received = true;
+    } else {
+      state = driver->startReceive(rxData + pos, len, large);
+      if(mode == BENCHMARK_MODE_BLOCKING_TX) {
+        state |= tx->transmit(txData + pos, len);
+        transmitted = true;
+      } else {
+        state |= tx->startTransmit(txData + pos, len);
+      }
+    }
+    if(state != ERR_NONE) {
+      printf("failed to transfer packet at %u, code %d\n", (unsigned)pos, state);
+      return(0);
+    }
+
+    // the radio that is not blocked is serviced from interrupts, the main loop only waits (up to 500 % of time-on-air)
+    bool waitTx = driver->txDoneFromFifo();
+    uint32_t timeout = 100 + (uint32_t)((len * 8 * 5) / bitRate);
+    uint32_t waitStart = Module::millis();
+    while(!(received && (transmitted || !waitTx)) && (Module::millis() - waitStart < timeout)) {
+      Module::waitForInterrupt(1);
+    }
+    if(!received || (waitTx && !transmitted)) {
+      printf("packet at %u was not %s\n", (unsigned)pos, received ? "transmitted" : "received");
+      return(0);
+    }
+
+    if(mode != BENCHMARK_MODE_BLOCKING_RX) {
+      size_t rxLen = rx->getPacketLength();
+      state = rx->readData(rxData + pos, len);
+      if((state != ERR_NONE) || (rxLen != len)) {
+        printf("packet at %u has wrong length %u, code %d\n", (unsigned)pos, (unsigned)rxLen, state);
+        return(0);
+      }
+    }
+    if(mode != BENCHMARK_MODE_BLOCKING_TX) {
+      tx->finishTransmit();
+    }
+  }
+  uint32_t elapsed = Module::micros() - start;
+
+  if(memcmp(txData, rxData, total) != 0) {
+    printf("received data do not match\n");
+    return(0);
+  }
+  return(elapsed);
+}
+
+// transfers the data in all modes, returns false on error
+bool benchmark(size_t frameLen, bool large) {
+  for(uint8_t i = 0; i < BENCHMARK_MODES; i++) {
+    uint32_t elapsed = transfer(frameLen, large, i);
+    if(elapsed == 0) {
+      printf("%u byte frames failed in %s mode\n", (unsigned)frameLen, modeNames[i]);
+      return(false);
+    }
+    printf("%5u byte frames, %-11s: %8lu us, %6.2f kbps\n", (unsigned)frameLen, modeNames[i], (unsigned long)elapsed, (driver->total * 8.0) / (elapsed / 1000.0));
+  }
+  return(true);
+}
+
+int main(int argc, char** argv) {
+  StreamDriver* drivers[] = { new SX127xDriver(), new RF69Driver(), new CC1101Driver(), new Si443xDriver() };
+  size_t numDrivers = sizeof(drivers)/sizeof(drivers[0]);
+  driver = NULL;
+  for(size_t i = 0; (argc > 1) && (i < numDrivers); i++) {
+    if(strcmp(argv[1], drivers[i]->name) == 0) {
+      driver = drivers[i];
+    }
+  }
+  if(driver == NULL) {
+    printf("usage: %s <driver> [total bytes] [bit rate in kbps] [large packet length]\ndrivers:", argv[0]);
+    for(size_t i = 0; i < numDrivers; i++) {
+      printf(" %s", drivers[i]->name);
+    }
+    printf("\n");
+    return(1);
+  }
+
+  bitRate = driver->bitRate;
+  if(argc > 2) {
+    driver->total = atoi(argv[2]);
+  }
+  if(argc > 3) {
+    bitRate = atof(argv[3]);
+  }
+  if(argc > 4) {
+    driver->largeLen = atoi(argv[4]);
+  }
+  if(!driver->checkLargeLength(driver->largeLen)) {
+    return(1);
+  }
+
+  size_t total = driver->total;
+  txData = new uint8_t[total];
+  rxData = new uint8_t[total];
+  for(size_t i = 0; i < total; i++) {
+    txData[i] = (uint8_t)rand();
+  }
+
+  EmulatorHal::begin();
+  for(int i = 0; i < 2; i++) {
+    int16_t state = driver->begin(i, bitRate);
+    if(state != ERR_NONE) {
+      printf("radio %d failed to initialize, code %d\n", i, state);
+      return(1);
+    }
+  }
+  driver->setActions(txFifo, rxFifo, rxDone);
+  EmulatorHal::attach(&trigger);
+  Module::pinMode(BENCHMARK_PIN_TRIGGER, INPUT);
+  Module::attachInterrupt(BENCHMARK_PIN_TRIGGER, txStart, RISING);
+
+  printf("%s: %u bytes at %.1f kbps\n", driver->name, (unsigned)total, bitRate);
+
+  for(size_t i = 0; (i < 2) && (driver->smallLen[i] != 0); i++) {
+    if(!benchmark(driver->smallLen[i], false)) {
+      return(1);
+    }
+  }
+  if(!benchmark(driver->largeLen, true)) {
+    return(1);
+  }
+
+  uint32_t underruns = driver->getTxUnderruns();
+  uint32_t overruns = driver->getRxOverruns();
+  printf("FIFO underruns: %lu, overruns: %lu\n", (unsigned long)underruns, (unsigned long)overruns);
+  return(((underruns == 0) && (overruns == 0)) ? 0 : 1);
+}
@@ -0,0 +1,217 @@
+/*
+  RadioLib nRF24 burst transmission benchmark
+
+  Transfers the same block of data between two emulated nRF24L01+ radios at 2 Mbps,
+  first packet by packet with nRF24::transmit (stop-and-wait), then as bursts that keep
+  all three Tx FIFO slots full with CE held high, so the next packet goes out as soon as
+  the previous one was acknowledged. Bursts are sent with and without acknowledgement
+  (W_TX_PAYLOAD_NOACK), and once more with acknowledgement over a lossy link, where
+  lost packets and acknowledgements are retransmitted and duplicates are filtered by the receiver.
+  Finally a burst is sent to a receiver that is not listening, all of its packets must
+  be reported as not acknowledged.
+
+  All transfers run on the emulator's virtual time, so the result is the goodput including
+  SPI transfers, 130 us settling time, preamble, address, CRC and acknowledgements.
+  Receiver captures the payloads directly, so that only the transmitter is measured.
+  The received data and per-packet results are checked, the benchmark exits with non-zero code on any error.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      nRF24BurstBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o nRF24BurstBenchmark
+
+  Usage:
+    nRF24BurstBenchmark [total bytes] [packet loss in %]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated radios
+#define BENCHMARK_PIN_CS(n)     (10*(n) + 10)
+#define BENCHMARK_PIN_IRQ(n)    (10*(n) + 11)
+#define BENCHMARK_PIN_CE(n)     (10*(n) + 12)
+
+// number of packets sent to receiver that is not listening
+#define BENCHMARK_LOST_PACKETS  6
+
+static nRF24Emulator* chips[2];
+static nRF24* tx;
+static nRF24* rx;
+static uint8_t* txData;
+static uint8_t* rxData;
+
+static volatile bool sent = false;
+static size_t nextResult = 0;
+static size_t resultErrors = 0;
+static size_t resultFailed = 0;
+
+void txIrq() {
+  if(tx->serviceFifo()) {
+    sent = true;
+  }
+}
+
+void burstResult(size_t packet, int16_t status) {
+  // packets must be reported exactly once and in order
+  if(packet != nextResult) {
+    resultErrors++;
+  }
+  nextResult = packet + 1;
+  if(status != ERR_NONE) {
+    resultFailed++;
+  }
+}
+
+// returns the transfer time in us, or 0 on error
+uint32_t transfer(size_t total, bool burst, bool ack, bool blocking) {
+  memset(rxData, 0, total);
+  chips[1]->setCapture(rxData, total);
+  nextResult = 0;
+  resultErrors = 0;
+  resultFailed = 0;
+
+  uint32_t start = Module::micros();
+  if(!burst) {
+    for(size_t pos = 0; pos < total; pos += NRF24_MAX_PACKET_LENGTH) {
+      size_t len = total - pos;
+      if(len > NRF24_MAX_PACKET_LENGTH) {
+        len = NRF24_MAX_PACKET_LENGTH;
+      }
+      int16_t state = tx->transmit(txData + pos, len, 0);
+      if(state != ERR_NONE) {
+        printf("packet at %u failed, code %d\n", (unsigned)pos, state);
+        return(0);
+      }
+    }
+
+  } else if(blocking) {
+    int16_t state = tx->transmitBurst(txData, total, NRF24_MAX_PACKET_LENGTH, ack);
+    if(state != ERR_NONE) {
+      printf("burst failed, code %d\n", state);
+      return(0);
+    }
+
+  } else {
+    // Tx FIFO is refilled from interrupt, the main loop only waits
+    sent = false;
+    int16_t state = tx->startTransmitBurst(txData, total, NRF24_MAX_PACKET_LENGTH, ack);
+    if(state != ERR_NONE) {
+      printf("failed to start burst, code %d\n", state);
+      return(0);
+    }
+    uint32_t waitStart = Module::millis();
+    while(!sent && (Module::millis() - waitStart < 100 + total)) {
+      Module::waitForInterrupt(1);
+    }
+    if(!sent) {
+      printf("burst was not finished\n");
+      return(0);
+    }
+  }
+  uint32_t elapsed = Module::micros() - start;
+  tx->finishTransmit();
+
+  size_t packets = (total + NRF24_MAX_PACKET_LENGTH - 1) / NRF24_MAX_PACKET_LENGTH;
+  if(burst && ((resultErrors > 0) || (nextResult != packets) || (resultFailed > 0))) {
+    printf("wrong packet results: %u reported, %u out of order, %u failed\n", (unsigned)nextResult, (unsigned)resultErrors, (unsigned)resultFailed);
+    return(0);
+  }
+  if((chips[1]->getCaptured() != total) || (memcmp(txData, rxData, total) != 0)) {
+    printf("received data do not match (%u bytes received)\n", (unsigned)chips[1]->getCaptured());
+    return(0);
+  }
+  return(elapsed);
+}
+
+int main(int argc, char** argv) {
+  size_t total = 65536;
+  uint8_t loss = 10;
+  if(argc > 1) {
+    total = atoi(argv[1]);
+  }
+  if(argc > 2) {
+    loss = atoi(argv[2]);
+  }
+
+  txData = new uint8_t[total];
+  rxData = new uint8_t[total];
+  for(size_t i = 0; i < total; i++) {
+    txData[i] = (uint8_t)rand();
+  }
+
+  EmulatorHal::begin();
+  nRF24* radios[2];
+  for(int i = 0; i < 2; i++) {
+    chips[i] = new nRF24Emulator(BENCHMARK_PIN_CS(i), BENCHMARK_PIN_IRQ(i), BENCHMARK_PIN_CE(i));
+    EmulatorHal::attach(chips[i]);
+    radios[i] = new nRF24(new Module(BENCHMARK_PIN_CS(i), BENCHMARK_PIN_IRQ(i), BENCHMARK_PIN_CE(i)));
+    int16_t state = radios[i]->begin(2400, 2000, 0, 5);
+    if(state != ERR_NONE) {
+      printf("radio %d failed to initialize, code %d\n", i, state);
+      return(1);
+    }
+  }
+  tx = radios[0];
+  rx = radios[1];
+
+  uint8_t addr[] = { 0x01, 0x23, 0x45, 0x67, 0x89 };
+  int16_t state = tx->setTransmitPipe(addr);
+  state |= rx->setReceivePipe(1, addr);
+  state |= rx->startReceive();
+  if(state != ERR_NONE) {
+    printf("failed to configure pipes, code %d\n", state);
+    return(1);
+  }
+  tx->setBurstResultAction(burstResult);
+
+  printf("%u bytes at 2000 kbps in %d byte packets\n", (unsigned)total, NRF24_MAX_PACKET_LENGTH);
+
+  uint32_t elapsed = transfer(total, false, true, true);
+  if(elapsed == 0) {
+    return(1);
+  }
+  printf("stop-and-wait:     %8lu us, %7.2f kbps\n", (unsigned long)elapsed, (total * 8.0) / (elapsed / 1000.0));
+
+  tx->setFifoAction(txIrq);
+  elapsed = transfer(total, true, true, false);
+  if(elapsed == 0) {
+    return(1);
+  }
+  printf("burst with ACK:    %8lu us, %7.2f kbps\n", (unsigned long)elapsed, (total * 8.0) / (elapsed / 1000.0));
+
+  elapsed = transfer(total, true, false, false);
+  if(elapsed == 0) {
+    return(1);
+  }
+  printf("burst without ACK: %8lu us, %7.2f kbps\n", (unsigned long)elapsed, (total * 8.0) / (elapsed / 1000.0));
+
+  // blocking method services the FIFO on its own
+  Module::detachInterrupt(BENCHMARK_PIN_IRQ(0));
+  chips[0]->setLoss(loss);
+  chips[1]->setLoss(loss);
+  uint32_t retransmits = chips[0]->getRetransmits();
+  elapsed = transfer(total, true, true, true);
+  if(elapsed == 0) {
+    return(1);
+  }
+  retransmits = chips[0]->getRetransmits() - retransmits;
+  printf("%2u %% packet loss:  %8lu us, %7.2f kbps, %lu retransmits\n", loss, (unsigned long)elapsed, (total * 8.0) / (elapsed / 1000.0), (unsigned long)retransmits);
+  chips[0]->setLoss(0);
+  chips[1]->setLoss(0);
+
+  // nobody is listening, every packet reaches maximum number of retransmits
+  rx->standby();
+  nextResult = 0;
+  resultErrors = 0;
+  resultFailed = 0;
+  state = tx->transmitBurst(txData, BENCHMARK_LOST_PACKETS * NRF24_MAX_PACKET_LENGTH);
+  if((state != ERR_ACK_NOT_RECEIVED) || (tx->getBurstFailed() != BENCHMARK_LOST_PACKETS) || (resultFailed != BENCHMARK_LOST_PACKETS) ||
+     (nextResult != BENCHMARK_LOST_PACKETS) || (resultErrors > 0)) {
+    printf("lost packets were not reported, code %d, %u failed\n", state, (unsigned)resultFailed);
+    return(1);
+  }
+  printf("not acknowledged:  %u of %u packets reported\n", (unsigned)resultFailed, BENCHMARK_LOST_PACKETS);
+  return(0);
+}
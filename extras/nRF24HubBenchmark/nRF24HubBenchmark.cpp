@@ -0,0 +1,216 @@
+/*
+  RadioLib nRF24 multi-pipe hub benchmark
+
+  Emulates a star network of one nRF24L01+ hub and five sensors, each sensor transmits
+  to its own receive pipe of the hub (pipes 1 - 5). Sensors transmit in turns and the hub
+  only gets to service its IRQ after every third packet, as if its main loop was busy,
+  so all three Rx FIFO entries have to be drained at once by nRF24::readPipes and sorted
+  into per-pipe queues by RX_P_NO. A fourth packet would not be acknowledged.
+
+  At the same time, the hub sends commands back to the sensors in ACK payloads loaded
+  by nRF24::setAckPayload. The payloads share the 3-deep Tx FIFO, so the hub loads
+  the next command for a pipe once the previous one was removed from Tx FIFO, which
+  happens when the next packet arrives on the pipe. Sensors read the commands right after
+  their own transmission, so no separate downlink transmissions are needed.
+
+  All transfers run on the emulator's virtual time. The contents and order of packets in
+  all queues and of the commands received by the sensors are checked, the benchmark exits
+  with non-zero code on any error.
+
+  Build on a Linux host with an Arduino-compatible core (Arduino.h and SPI.h), e.g.:
+    g++ -std=gnu++11 -O2 -DRADIOLIB_EMULATOR -I<core> -I<RadioLib>/src \
+      nRF24HubBenchmark.cpp $(find <RadioLib>/src -name '*.cpp') -o nRF24HubBenchmark
+
+  Usage:
+    nRF24HubBenchmark [packets per sensor]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <RadioLib.h>
+
+// pins of the emulated radios
+#define BENCHMARK_PIN_CS(n)     (10*(n) + 10)
+#define BENCHMARK_PIN_IRQ(n)    (10*(n) + 11)
+#define BENCHMARK_PIN_CE(n)     (10*(n) + 12)
+
+// number of sensors, sensor n transmits to pipe n
+#define BENCHMARK_SENSORS       5
+
+// number of packets the hub receives before it services IRQ
+#define BENCHMARK_SERVICE_EVERY NRF24_FIFO_DEPTH
+
+// number of slots in each pipe queue
+#define BENCHMARK_QUEUE_SLOTS   4
+
+static nRF24* hub;
+static nRF24* sensors[BENCHMARK_SENSORS + 1];
+
+static PacketSlot_t slots[BENCHMARK_SENSORS + 1][BENCHMARK_QUEUE_SLOTS];
+static uint8_t buffers[BENCHMARK_SENSORS + 1][BENCHMARK_QUEUE_SLOTS * NRF24_MAX_PACKET_LENGTH];
+static PacketRing* queues[BENCHMARK_SENSORS + 1];
+
+static volatile uint32_t hubIrqs = 0;
+
+void hubIrq() {
+  hubIrqs++;
+}
+
+// packet of a sensor carries its pipe, sequence number and a pattern of variable length
+size_t buildPacket(uint8_t* buff, uint8_t pipe, uint16_t seq) {
+  size_t len = 4 + (seq + pipe) % (NRF24_MAX_PACKET_LENGTH - 3);
+  buff[0] = pipe;
+  buff[1] = seq & 0xFF;
+  buff[2] = seq >> 8;
+  for(size_t i = 3; i < len; i++) {
+    buff[i] = (uint8_t)(pipe * 31 + seq * 7 + i);
+  }
+  return(len);
+}
+
+int main(int argc, char** argv) {
+  uint16_t packets = 200;
+  if(argc > 1) {
+    packets = atoi(argv[1]);
+  }
+
+  EmulatorHal::begin();
+  nRF24Emulator* chips[BENCHMARK_SENSORS + 1];
+  for(int i = 0; i <= BENCHMARK_SENSORS; i++) {
+    chips[i] = new nRF24Emulator(BENCHMARK_PIN_CS(i), BENCHMARK_PIN_IRQ(i), BENCHMARK_PIN_CE(i));
+    EmulatorHal::attach(chips[i]);
+    nRF24* radio = new nRF24(new Module(BENCHMARK_PIN_CS(i), BENCHMARK_PIN_IRQ(i), BENCHMARK_PIN_CE(i)));
+    int16_t state = radio->begin(2400, 2000, 0, 5);
+    if(state != ERR_NONE) {
+      printf("radio %d failed to initialize, code %d\n", i, state);
+      return(1);
+    }
+    sensors[i] = radio;
+  }
+  hub = sensors[0];
+
+  // pipes 2 - 5 share all address bytes with pipe 1, except for LSB (the first byte)
+  uint8_t addr[] = { 0xC1, 0x23, 0x45, 0x67, 0x89 };
+  int16_t state = hub->setReceivePipe(1, addr);
+  state |= sensors[1]->setTransmitPipe(addr);
+  for(uint8_t pipe = 2; pipe <= BENCHMARK_SENSORS; pipe++) {
+    addr[0] = 0xC0 + pipe;
+    state |= hub->setReceivePipe(pipe, addr[0]);
+    state |= sensors[pipe]->setTransmitPipe(addr);
+  }
+  for(uint8_t pipe = 1; pipe <= BENCHMARK_SENSORS; pipe++) {
+    queues[pipe] = new PacketRing(slots[pipe], buffers[pipe], BENCHMARK_QUEUE_SLOTS, NRF24_MAX_PACKET_LENGTH);
+    state |= hub->setPipeQueue(pipe, queues[pipe]);
+  }
+  hub->setIrqAction(hubIrq);
+  state |= hub->startReceive();
+  if(state != ERR_NONE) {
+    printf("failed to configure pipes, code %d\n", state);
+    return(1);
+  }
+
+  // uplink sequence numbers expected by the hub, downlink commands loaded by the hub and received by the sensors
+  uint16_t rxSeq[BENCHMARK_SENSORS + 1] = { 0 };
+  uint16_t cmdLoaded[BENCHMARK_SENSORS + 1] = { 0 };
+  uint16_t cmdReceived[BENCHMARK_SENSORS + 1] = { 0 };
+  uint8_t sinceLoad[BENCHMARK_SENSORS + 1] = { 0 };
+  bool cmdPending[BENCHMARK_SENSORS + 1] = { false };
+  uint32_t services = 0;
+  uint32_t serviced = 0;
+  size_t bytes = 0;
+  uint8_t buff[NRF24_MAX_PACKET_LENGTH];
+
+  printf("%u packets from each of %d sensors at 2000 kbps, hub services IRQ after every %d packets\n", packets, BENCHMARK_SENSORS, BENCHMARK_SERVICE_EVERY);
+
+  uint32_t start = Module::micros();
+  uint32_t sent = 0;
+  for(uint16_t seq = 0; seq < packets; seq++) {
+    for(uint8_t pipe = 1; pipe <= BENCHMARK_SENSORS; pipe++) {
+      size_t len = buildPacket(buff, pipe, seq);
+      state = sensors[pipe]->transmit(buff, len, 0);
+      if(state != ERR_NONE) {
+        printf("packet %u from sensor %u failed, code %d\n", seq, pipe, state);
+        return(1);
+      }
+      bytes += len;
+      sent++;
+
+      // command from the hub arrives with the acknowledgement, on pipe 0
+      if(sensors[pipe]->getPacketPipe() == 0) {
+        uint8_t cmd[NRF24_MAX_PACKET_LENGTH];
+        sensors[pipe]->readData(cmd, NRF24_MAX_PACKET_LENGTH);
+        uint16_t num = cmd[1] | (cmd[2] << 8);
+        if((cmd[0] != pipe) || (num != cmdReceived[pipe])) {
+          printf("sensor %u received wrong command %u from pipe %u, expected %u\n", pipe, num, cmd[0], cmdReceived[pipe]);
+          return(1);
+        }
+        cmdReceived[pipe]++;
+      }
+
+      // hub main loop is busy until Rx FIFO is full
+      if((sent % BENCHMARK_SERVICE_EVERY != 0) || (hubIrqs == services)) {
+        continue;
+      }
+      services = hubIrqs;
+      serviced++;
+      if(hub->readPipes() != BENCHMARK_SERVICE_EVERY) {
+        printf("Rx FIFO was not drained\n");
+        return(1);
+      }
+
+      for(uint8_t p = 1; p <= BENCHMARK_SENSORS; p++) {
+        for(PacketSlot_t* slot = queues[p]->peek(); slot != NULL; slot = queues[p]->peek()) {
+          uint8_t expected[NRF24_MAX_PACKET_LENGTH];
+          size_t expectedLen = buildPacket(expected, p, rxSeq[p]);
+          if((slot->len != expectedLen) || (memcmp(slot->data, expected, expectedLen) != 0)) {
+            printf("wrong packet in queue of pipe %u, expected %u\n", p, rxSeq[p]);
+            return(1);
+          }
+          rxSeq[p]++;
+          queues[p]->release();
+
+          // the second packet after the command was loaded means it was delivered and removed from Tx FIFO
+          if(cmdPending[p] && (++sinceLoad[p] >= 2)) {
+            cmdPending[p] = false;
+          }
+        }
+
+        // load the next command, unless the previous one is still in Tx FIFO or there is no space left
+        if(!cmdPending[p]) {
+          uint8_t cmd[] = { p, (uint8_t)(cmdLoaded[p] & 0xFF), (uint8_t)(cmdLoaded[p] >> 8), 0xA5 };
+          if(hub->setAckPayload(p, cmd, sizeof(cmd)) == ERR_NONE) {
+            cmdLoaded[p]++;
+            cmdPending[p] = true;
+            sinceLoad[p] = 0;
+          }
+        }
+      }
+    }
+  }
+  uint32_t elapsed = Module::micros() - start;
+
+  // the rest of the packets
+  hub->readPipes();
+  uint32_t commands = 0;
+  for(uint8_t p = 1; p <= BENCHMARK_SENSORS; p++) {
+    for(; queues[p]->peek() != NULL; queues[p]->release()) {
+      rxSeq[p]++;
+    }
+    if((rxSeq[p] != packets) || (queues[p]->getOverflows() > 0)) {
+      printf("pipe %u received %u packets, %lu queue overflows\n", p, rxSeq[p], (unsigned long)queues[p]->getOverflows());
+      return(1);
+    }
+    // at most the last loaded command may still be waiting for the next uplink packet
+    if(cmdLoaded[p] - cmdReceived[p] > 1) {
+      printf("sensor %u received %u of %u commands\n", p, cmdReceived[p], cmdLoaded[p]);
+      return(1);
+    }
+    commands += cmdReceived[p];
+  }
+
+  printf("uplink:   %lu packets in %lu us, %.2f kbps, %lu dropped\n", (unsigned long)sent, (unsigned long)elapsed, (bytes * 8.0) / (elapsed / 1000.0), (unsigned long)hub->getPipeDropped());
+  printf("hub:      %lu IRQs serviced, %.2f packets per IRQ\n", (unsigned long)serviced, (double)(sent - (sent % BENCHMARK_SERVICE_EVERY)) / serviced);
+  printf("downlink: %lu commands in ACK payloads, 0 extra transmissions\n", (unsigned long)commands);
+  return(hub->getPipeDropped() == 0 ? 0 : 1);
+}
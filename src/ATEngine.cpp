@@ -0,0 +1,259 @@
+#include "ATEngine.h"
+
+ATEngine::ATEngine(Module* mod) {
+  _mod = mod;
+}
+
+void ATEngine::reset() {
+  _pending = false;
+  _status = ERR_NONE;
+  _state = RADIOLIB_AT_STATE_LINE;
+  _lineLen = 0;
+  _ipdLen = 0;
+  _buffHead = 0;
+  _buffLen = 0;
+  _overflows = 0;
+}
+
+int16_t ATEngine::addTerminator(const char* pattern, int16_t status, uint8_t mode) {
+  size_t len = strlen(pattern);
+  if((_numTerms >= RADIOLIB_AT_MAX_TERMINATORS) || (len == 0) || (len > RADIOLIB_AT_LINE_SIZE)) {
+    return(ERR_UNKNOWN);
+  }
+
+  _terms[_numTerms].pattern = pattern;
+  _terms[_numTerms].status = status;
+  _terms[_numTerms].len = len;
+  _terms[_numTerms].mode = mode;
+  _numTerms++;
+  return(ERR_NONE);
+}
+
+void ATEngine::clearTerminators() {
+  _numTerms = 0;
+}
+
+void ATEngine::setResponseAction(void (*func)(int16_t, void*), void* ctx) {
+  _responseCb = func;
+  _responseCtx = ctx;
+}
+
+void ATEngine::setDataAction(void (*func)(const uint8_t*, size_t, void*), void* ctx) {
+  _dataCb = func;
+  _dataCtx = ctx;
+}
+
+int16_t ATEngine::sendCommand(const char* cmd, uint32_t timeout) {
+  // process anything received so far, so that unsolicited lines are not mistaken for response (payload data is kept)
+  poll();
+
+  _mod->ModuleSerial->print(cmd);
+  _mod->ModuleSerial->print(_mod->AtLineFeed);
+  start(timeout);
+  return(ERR_NONE);
+}
+
+int16_t ATEngine::sendData(const uint8_t* data, size_t len, uint32_t timeout) {
+  poll();
+
+  for(size_t i = 0; i < len; i++) {
+    _mod->ModuleSerial->write(data[i]);
+  }
+  _mod->ModuleSerial->print(_mod->AtLineFeed);
+  start(timeout);
+  return(ERR_NONE);
+}
+
+void ATEngine::expect(uint32_t timeout) {
+  start(timeout);
+}
+
+int16_t ATEngine::poll() {
+  // while waiting for response, read byte by byte and stop right after the terminator,
+  // anything that follows it (e.g. +IPD payload read by ESP8266::receive) is left in ModuleSerial
+  if(_pending) {
+    while(_pending && (_mod->ModuleSerial->available() > 0)) {
+      uint8_t b = _mod->ModuleSerial->read();
+      feed(&b, 1);
+    }
+    if(_pending && (Module::millis() - _start >= _timeout)) {
+      complete(ERR_AT_FAILED);
+    }
+    return(_pending ? AT_RESPONSE_PENDING : _status);
+  }
+
+  // otherwise read in small chunks, so that payload data can be passed on in one go
+  uint8_t chunk[16];
+  size_t len = 0;
+  while(_mod->ModuleSerial->available() > 0) {
+    chunk[len++] = _mod->ModuleSerial->read();
+    if(len == sizeof(chunk)) {
+      feed(chunk, len);
+      len = 0;
+    }
+  }
+  return(feed(chunk, len));
+}
+
+int16_t ATEngine::feed(const uint8_t* data, size_t len) {
+  size_t i = 0;
+  while(i < len) {
+    // payload bytes are never scanned for terminators
+    if(_state == RADIOLIB_AT_STATE_IPD_DATA) {
+      size_t chunkLen = len - i;
+      if(chunkLen > _ipdLen) {
+        chunkLen = _ipdLen;
+      }
+      storeData(&data[i], chunkLen);
+      i += chunkLen;
+      _ipdLen -= chunkLen;
+      if(_ipdLen == 0) {
+        _state = RADIOLIB_AT_STATE_LINE;
+      }
+      continue;
+    }
+
+    char c = data[i++];
+    RADIOLIB_VERBOSE_PRINT(c);
+
+    // +IPD header, payload length is the last number before colon (link ID precedes it in multiple connection mode)
+    if(_state == RADIOLIB_AT_STATE_IPD_HEADER) {
+      if((c >= '0') && (c <= '9')) {
+        _ipdLen = 10*_ipdLen + (c - '0');
+      } else if(c == ',') {
+        _ipdLen = 0;
+      } else if((c == ':') && (_ipdLen > 0)) {
+        _state = RADIOLIB_AT_STATE_IPD_DATA;
+      } else {
+        // malformed or empty header
+        _state = RADIOLIB_AT_STATE_LINE;
+      }
+      continue;
+    }
+
+    // line feed characters end the current line
+    if((c == '\r') || (c == '\n')) {
+      if(_lineLen > 0) {
+        _line[_lineLen] = '\0';
+        int16_t state = matchLine();
+        _lineLen = 0;
+        if(state != AT_RESPONSE_PENDING) {
+          complete(state);
+        }
+      }
+      continue;
+    }
+
+    // line too long to match anything, skip the rest of it
+    if(_lineLen >= RADIOLIB_AT_LINE_SIZE) {
+      continue;
+    }
+    _line[_lineLen++] = c;
+
+    // check prefixes, as these are not followed by line feed
+    if((_lineLen == 5) && (memcmp(_line, "+IPD,", 5) == 0)) {
+      _state = RADIOLIB_AT_STATE_IPD_HEADER;
+      _ipdLen = 0;
+      _lineLen = 0;
+      continue;
+    }
+
+    for(uint8_t j = 0; j < _numTerms; j++) {
+      if((_terms[j].mode == RADIOLIB_AT_MATCH_PREFIX) && (_terms[j].len == _lineLen) && (memcmp(_line, _terms[j].pattern, _lineLen) == 0)) {
+        _lineLen = 0;
+        complete(_terms[j].status);
+        break;
+      }
+    }
+  }
+
+  return(_pending ? AT_RESPONSE_PENDING : _status);
+}
+
+int16_t ATEngine::waitForResponse() {
+  int16_t state = poll();
+  while(state == AT_RESPONSE_PENDING) {
+    yield();
+    state = poll();
+  }
+  return(state);
+}
+
+bool ATEngine::isPending() {
+  return(_pending);
+}
+
+size_t ATEngine::available() {
+  return(_buffLen);
+}
+
+size_t ATEngine::read(uint8_t* data, size_t len) {
+  size_t i = 0;
+  while((i < len) && (_buffLen > 0)) {
+    data[i++] = _buff[_buffHead];
+    _buffHead = (_buffHead + 1) % RADIOLIB_AT_BUFFER_SIZE;
+    _buffLen--;
+  }
+  return(i);
+}
+
+uint32_t ATEngine::getOverflows() {
+  return(_overflows);
+}
+
+void ATEngine::start(uint32_t timeout) {
+  // drop partial line left over from before the command
+  if(_state == RADIOLIB_AT_STATE_LINE) {
+    _lineLen = 0;
+  }
+  _pending = true;
+  _status = AT_RESPONSE_PENDING;
+  _start = Module::millis();
+  _timeout = timeout;
+}
+
+void ATEngine::complete(int16_t status) {
+  // lines received while no command is pending are unsolicited, e.g. "WIFI CONNECTED"
+  if(!_pending) {
+    return;
+  }
+
+  RADIOLIB_VERBOSE_PRINTLN();
+  _pending = false;
+  _status = status;
+  if(_responseCb != NULL) {
+    _responseCb(status, _responseCtx);
+  }
+}
+
+int16_t ATEngine::matchLine() {
+  for(uint8_t i = 0; i < _numTerms; i++) {
+    if((_terms[i].mode == RADIOLIB_AT_MATCH_LINE) && (_terms[i].len == _lineLen) && (memcmp(_line, _terms[i].pattern, _lineLen) == 0)) {
+      return(_terms[i].status);
+    }
+  }
+
+  if((strcmp(_line, "OK") == 0) || (strcmp(_line, "SEND OK") == 0)) {
+    return(ERR_NONE);
+  } else if((strcmp(_line, "ERROR") == 0) || (strcmp(_line, "FAIL") == 0) || (strcmp(_line, "SEND FAIL") == 0)) {
+    return(ERR_AT_FAILED);
+  }
+
+  return(AT_RESPONSE_PENDING);
+}
+
+void ATEngine::storeData(const uint8_t* data, size_t len) {
+  if(_dataCb != NULL) {
+    _dataCb(data, len, _dataCtx);
+    return;
+  }
+
+  for(size_t i = 0; i < len; i++) {
+    if(_buffLen >= RADIOLIB_AT_BUFFER_SIZE) {
+      _overflows += len - i;
+      return;
+    }
+    _buff[(_buffHead + _buffLen) % RADIOLIB_AT_BUFFER_SIZE] = data[i];
+    _buffLen++;
+  }
+}
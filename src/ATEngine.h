@@ -0,0 +1,216 @@
+#ifndef _RADIOLIB_AT_ENGINE_H
+#define _RADIOLIB_AT_ENGINE_H
+
+#include "TypeDef.h"
+#include "Module.h"
+
+// size of ring buffer for data received outside of command responses (+IPD payloads)
+#define RADIOLIB_AT_BUFFER_SIZE                       128
+
+// maximum length of a single response line, longer lines are truncated (terminators are short, so truncation does not affect matching)
+#define RADIOLIB_AT_LINE_SIZE                         32
+
+// maximum number of custom terminators
+#define RADIOLIB_AT_MAX_TERMINATORS                   4
+
+// default response timeout in ms
+#define RADIOLIB_AT_DEFAULT_TIMEOUT                   15000
+
+// terminator matching modes
+#define RADIOLIB_AT_MATCH_LINE                        0           // complete response line must be equal to the pattern
+#define RADIOLIB_AT_MATCH_PREFIX                      1           // matches as soon as the line starts with the pattern, e.g. prompts without line feed
+
+// parser states
+#define RADIOLIB_AT_STATE_LINE                        0
+#define RADIOLIB_AT_STATE_IPD_HEADER                  1
+#define RADIOLIB_AT_STATE_IPD_DATA                    2
+
+/*!
+  \class ATEngine
+
+  \brief Non-blocking engine for AT command modules. Bytes from ModuleSerial are parsed incrementally as they arrive:
+  response lines are matched against terminators (OK, SEND OK, ERROR, FAIL, SEND FAIL and up to RADIOLIB_AT_MAX_TERMINATORS custom ones),
+  and payloads announced by "+IPD,[id,]<len>:" prefix are passed to data callback or stored in ring buffer without being scanned.
+  Commands are started with sendCommand/sendData and completed by calling poll, either from the main loop or from waitForResponse.
+*/
+class ATEngine {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param mod Instance of Module that will be used to communicate with the module over UART.
+    */
+    ATEngine(Module* mod);
+
+    /*!
+      \brief Resets parser state and drops any pending command and buffered data. Custom terminators and callbacks are kept.
+    */
+    void reset();
+
+    /*!
+      \brief Adds custom terminator. The pattern is not copied, so it must remain valid for as long as the terminator is used.
+
+      \param pattern Terminator string, without line feed characters.
+
+      \param status Status that will be returned when the terminator is matched, e.g. ERR_NONE or ERR_AT_FAILED.
+
+      \param mode Matching mode, one of RADIOLIB_AT_MATCH_* macros.
+
+      \returns \ref status_codes
+    */
+    int16_t addTerminator(const char* pattern, int16_t status, uint8_t mode = RADIOLIB_AT_MATCH_LINE);
+
+    /*!
+      \brief Removes all custom terminators.
+    */
+    void clearTerminators();
+
+    /*!
+      \brief Sets function that will be called when pending command completes or times out.
+
+      \param func Callback function, called with the final status of the command and user context.
+
+      \param ctx User context passed to callback function.
+    */
+    void setResponseAction(void (*func)(int16_t, void*), void* ctx = NULL);
+
+    /*!
+      \brief Sets function that will be called with +IPD payload data as it arrives. When not set, payload is stored in ring buffer.
+
+      \param func Callback function, called with pointer to data, number of bytes and user context. May be called multiple times per payload.
+
+      \param ctx User context passed to callback function.
+    */
+    void setDataAction(void (*func)(const uint8_t*, size_t, void*), void* ctx = NULL);
+
+    /*!
+      \brief Sends AT command and returns immediately. Response has to be processed by calling poll.
+
+      \param cmd AT command to be sent. Line feed characters are added automatically.
+
+      \param timeout Response timeout in ms.
+
+      \returns \ref status_codes
+    */
+    int16_t sendCommand(const char* cmd, uint32_t timeout = RADIOLIB_AT_DEFAULT_TIMEOUT);
+
+    /*!
+      \brief Sends raw data and returns immediately. Response has to be processed by calling poll.
+
+      \param data Data to be sent. Line feed characters are added automatically.
+
+      \param len Number of bytes to send.
+
+      \param timeout Response timeout in ms.
+
+      \returns \ref status_codes
+    */
+    int16_t sendData(const uint8_t* data, size_t len, uint32_t timeout = RADIOLIB_AT_DEFAULT_TIMEOUT);
+
+    /*!
+      \brief Starts waiting for response without sending anything, e.g. after escape sequence written directly to ModuleSerial.
+
+      \param timeout Response timeout in ms.
+    */
+    void expect(uint32_t timeout = RADIOLIB_AT_DEFAULT_TIMEOUT);
+
+    /*!
+      \brief Processes bytes available in ModuleSerial and checks response timeout. Never blocks.
+      While command is pending, reading stops right after its terminator, so that data following the response stay in ModuleSerial.
+      Otherwise, all available bytes are processed.
+
+      \returns AT_RESPONSE_PENDING while waiting for response, final \ref status_codes of the last command otherwise.
+    */
+    int16_t poll();
+
+    /*!
+      \brief Processes bytes from arbitrary source, e.g. scripted serial stream. Called by poll for bytes read from ModuleSerial.
+
+      \param data Received bytes.
+
+      \param len Number of received bytes.
+
+      \returns AT_RESPONSE_PENDING while waiting for response, final \ref status_codes of the last command otherwise.
+    */
+    int16_t feed(const uint8_t* data, size_t len);
+
+    /*!
+      \brief Blocking wrapper, calls poll until pending command completes or times out.
+
+      \returns \ref status_codes
+    */
+    int16_t waitForResponse();
+
+    /*!
+      \brief Checks whether there is command waiting for response.
+
+      \returns True when waiting for response, false otherwise.
+    */
+    bool isPending();
+
+    /*!
+      \brief Gets number of payload bytes stored in ring buffer.
+
+      \returns Number of bytes available for read.
+    */
+    size_t available();
+
+    /*!
+      \brief Reads payload bytes from ring buffer.
+
+      \param data Buffer to copy data to.
+
+      \param len Maximum number of bytes to read.
+
+      \returns Number of bytes actually read.
+    */
+    size_t read(uint8_t* data, size_t len);
+
+    /*!
+      \brief Gets number of payload bytes dropped because ring buffer was full.
+
+      \returns Number of dropped bytes.
+    */
+    uint32_t getOverflows();
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    Module* _mod;
+
+    struct ATTerminator_t {
+      const char* pattern;
+      int16_t status;
+      uint8_t len;
+      uint8_t mode;
+    };
+    ATTerminator_t _terms[RADIOLIB_AT_MAX_TERMINATORS];
+    uint8_t _numTerms = 0;
+
+    void (*_responseCb)(int16_t, void*) = NULL;
+    void* _responseCtx = NULL;
+    void (*_dataCb)(const uint8_t*, size_t, void*) = NULL;
+    void* _dataCtx = NULL;
+
+    bool _pending = false;
+    int16_t _status = ERR_NONE;
+    uint32_t _start = 0;
+    uint32_t _timeout = RADIOLIB_AT_DEFAULT_TIMEOUT;
+
+    uint8_t _state = RADIOLIB_AT_STATE_LINE;
+    char _line[RADIOLIB_AT_LINE_SIZE + 1];
+    uint8_t _lineLen = 0;
+    size_t _ipdLen = 0;
+
+    uint8_t _buff[RADIOLIB_AT_BUFFER_SIZE];
+    size_t _buffHead = 0;
+    size_t _buffLen = 0;
+    uint32_t _overflows = 0;
+
+    void start(uint32_t timeout);
+    void complete(int16_t status);
+    int16_t matchLine();
+    void storeData(const uint8_t* data, size_t len);
+};
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef _RADIOLIB_ARDUINO_HAL_H
+#define _RADIOLIB_ARDUINO_HAL_H
+
+#include "TypeDef.h"
+
+#include <SPI.h>
+
+/*!
+  \class ArduinoHal
+
+  \brief Default hardware abstraction layer, forwards all GPIO, SPI and timing calls to Arduino core.
+  All methods are static and inline, so selecting the HAL costs neither a virtual call nor a function call.
+  Custom HAL classes (see RADIOLIB_HAL in BuildOpt.h) must provide methods with the same signatures.
+*/
+class ArduinoHal {
+  public:
+    // GPIO methods
+
+    /*!
+      \brief Set mode of a GPIO pin.
+
+      \param pin Pin to change the mode of.
+
+      \param mode Which mode to set.
+    */
+    static inline void pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode) { ::pinMode(pin, mode); }
+
+    /*!
+      \brief Set output value of a GPIO pin.
+
+      \param pin Pin to write to.
+
+      \param value Whether to set the pin high or low.
+    */
+    static inline void digitalWrite(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) { ::digitalWrite(pin, value); }
+
+    /*!
+      \brief Read value of a GPIO pin.
+
+      \param pin Pin to read from.
+
+      \returns Pin value.
+    */
+    static inline RADIOLIB_PIN_STATUS digitalRead(RADIOLIB_PIN_TYPE pin) { return(::digitalRead(pin)); }
+
+    /*!
+      \brief Attach interrupt service routine to a GPIO pin.
+
+      \param pin Pin to attach the interrupt to.
+
+      \param func Interrupt service routine.
+
+      \param mode Pin change that triggers the interrupt.
+    */
+    static inline void attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode) { ::attachInterrupt(digitalPinToInterrupt(pin), func, mode); }
+
+    /*!
+      \brief Detach interrupt service routine from a GPIO pin.
+
+      \param pin Pin to detach the interrupt from.
+    */
+    static inline void detachInterrupt(RADIOLIB_PIN_TYPE pin) { ::detachInterrupt(digitalPinToInterrupt(pin)); }
+
+    /*!
+      \brief Wait until a GPIO pin reaches the requested value.
+
+      \param pin Pin to wait for.
+
+      \param value Value to wait for.
+
+      \param timeout Timeout in milliseconds.
+
+      \returns True if the pin reached the requested value, false on timeout.
+    */
+    static inline bool waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout) {
+      uint32_t start = ::millis();
+      while(::digitalRead(pin) != value) {
+        yield();
+        if(::millis() - start >= timeout) {
+          return(false);
+        }
+      }
+      return(true);
+    }
+
+    /*!
+      \brief Wait until either of two GPIO pins reaches its requested value.
+
+      \param pinA First pin to wait for.
+
+      \param valueA Value to wait for on the first pin.
+
+      \param pinB Second pin to wait for.
+
+      \param valueB Value to wait for on the second pin.
+
+      \param timeout Timeout in milliseconds.
+
+      \returns True if at least one of the pins reached its requested value, false on timeout.
+    */
+    static inline bool waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout) {
+      uint32_t start = ::millis();
+      while((::digitalRead(pinA) != valueA) && (::digitalRead(pinB) != valueB)) {
+        yield();
+        if(::millis() - start >= timeout) {
+          return(false);
+        }
+      }
+      return(true);
+    }
+
+    /*!
+      \brief Wait until an attached interrupt service routine has been called. Interrupts on Arduino run asynchronously, so this only yields and returns.
+
+      \param timeout Timeout in milliseconds.
+
+      \returns True if an interrupt service routine was called, always false here.
+    */
+    static inline bool waitForInterrupt(uint32_t timeout) {
+      (void)timeout;
+      yield();
+      return(false);
+    }
+
+    /*!
+      \brief Output square wave on a GPIO pin. Does nothing on platforms that do not support tone.
+
+      \param pin Pin to write to.
+
+      \param value Frequency to output.
+    */
+    static inline void tone(RADIOLIB_PIN_TYPE pin, uint16_t value) {
+      #ifndef RADIOLIB_TONE_UNSUPPORTED
+        ::tone(pin, value);
+      #else
+        (void)pin;
+        (void)value;
+      #endif
+    }
+
+    /*!
+      \brief Stop square wave output on a GPIO pin. Does nothing on platforms that do not support tone.
+
+      \param pin Pin to write to.
+    */
+    static inline void noTone(RADIOLIB_PIN_TYPE pin) {
+      #ifndef RADIOLIB_TONE_UNSUPPORTED
+        ::noTone(pin);
+      #else
+        (void)pin;
+      #endif
+    }
+
+    // SPI methods
+
+    /*!
+      \brief Initialize SPI interface.
+
+      \param spi SPI interface to initialize.
+    */
+    static inline void spiBegin(SPIClass* spi) { spi->begin(); }
+
+    /*!
+      \brief Terminate SPI interface.
+
+      \param spi SPI interface to terminate.
+    */
+    static inline void spiEnd(SPIClass* spi) { spi->end(); }
+
+    /*!
+      \brief Start SPI transaction.
+
+      \param spi SPI interface to use.
+
+      \param settings SPI interface settings.
+    */
+    static inline void spiBeginTransaction(SPIClass* spi, SPISettings settings) { spi->beginTransaction(settings); }
+
+    /*!
+      \brief Transfer a block of bytes, incoming bytes overwrite the buffer contents.
+
+      \param spi SPI interface to use.
+
+      \param buff Buffer to transfer.
+
+      \param len Number of bytes to transfer.
+    */
+    static inline void spiTransfer(SPIClass* spi, uint8_t* buff, size_t len) { spi->transfer(buff, len); }
+
+    /*!
+      \brief Transfer SPI frame made of a header (command and/or address bytes) followed by data. Chip select is not changed.
+      The frame is sent in blocks of up to RADIOLIB_SPI_BUFFER_SIZE bytes through a buffer on stack, incoming data are received in place.
+
+      \param spi SPI interface to use.
+
+      \param head Header bytes, at most RADIOLIB_SPI_HEADER_SIZE. Overwritten by the bytes received in their place (e.g. status).
+
+      \param headLen Number of header bytes.
+
+      \param dataOut Data to send after the header, or NULL to send fill bytes.
+
+      \param dataIn Buffer to save the incoming data to, or NULL to discard them.
+
+      \param len Number of data bytes.
+
+      \param fill Byte to send when dataOut is NULL.
+    */
+    static void spiTransferFrame(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill);
+
+    /*!
+      \brief Transfer SPI frame made of a header followed by outgoing data, incoming data are only passed to a check function. Chip select is not changed.
+      The frame is sent in blocks of up to RADIOLIB_SPI_BUFFER_SIZE bytes through a buffer on stack, each block is checked once it was received.
+
+      \param spi SPI interface to use.
+
+      \param head Header bytes, at most RADIOLIB_SPI_HEADER_SIZE. Overwritten by the bytes received in their place (e.g. status).
+
+      \param headLen Number of header bytes.
+
+      \param dataOut Data to send after the header.
+
+      \param len Number of data bytes.
+
+      \param check Function called with each block of incoming data, returns non-zero on error.
+
+      \returns First non-zero value returned by check, 0 if all blocks passed.
+    */
+    static uint8_t spiTransferFrameChecked(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len));
+
+    /*!
+      \brief End SPI transaction.
+
+      \param spi SPI interface to use.
+    */
+    static inline void spiEndTransaction(SPIClass* spi) { spi->endTransaction(); }
+
+    // timing methods
+
+    /*!
+      \brief Get number of milliseconds since start.
+
+      \returns Milliseconds since start.
+    */
+    static inline uint32_t millis() { return(::millis()); }
+
+    /*!
+      \brief Get number of microseconds since start.
+
+      \returns Microseconds since start.
+    */
+    static inline uint32_t micros() { return(::micros()); }
+
+    /*!
+      \brief Blocking wait.
+
+      \param ms Number of milliseconds to wait.
+    */
+    static inline void delay(uint32_t ms) { ::delay(ms); }
+
+    /*!
+      \brief Blocking wait.
+
+      \param us Number of microseconds to wait.
+    */
+    static inline void delayMicroseconds(uint32_t us) { ::delayMicroseconds(us); }
+
+    // interrupt methods
+
+    /*!
+      \brief Disables interrupts, e.g. to claim a slot shared with interrupt service routines.
+    */
+    static inline void disableInterrupts() { noInterrupts(); }
+
+    /*!
+      \brief Enables interrupts disabled by disableInterrupts.
+    */
+    static inline void enableInterrupts() { interrupts(); }
+};
+
+inline void ArduinoHal::spiTransferFrame(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill) {
+  // the first block carries the header and as much data as fits, so short frames are sent at once
+  uint8_t buff[RADIOLIB_SPI_BUFFER_SIZE];
+  size_t chunk = RADIOLIB_SPI_BUFFER_SIZE - headLen;
+  if(chunk > len) {
+    chunk = len;
+  }
+  memcpy(buff, head, headLen);
+  if(dataOut != NULL) {
+    memcpy(buff + headLen, dataOut, chunk);
+  } else {
+    memset(buff + headLen, fill, chunk);
+  }
+  spi->transfer(buff, headLen + chunk);
+  memcpy(head, buff, headLen);
+  if(dataIn != NULL) {
+    memcpy(dataIn, buff + headLen, chunk);
+  }
+
+  // incoming data are received in place, outgoing data have to be copied, otherwise they would be overwritten
+  size_t pos = chunk;
+  if((dataOut == NULL) && (dataIn != NULL)) {
+    if(pos < len) {
+      memset(dataIn + pos, fill, len - pos);
+      spi->transfer(dataIn + pos, len - pos);
+    }
+    return;
+  }
+  while(pos < len) {
+    chunk = len - pos;
+    if(chunk > RADIOLIB_SPI_BUFFER_SIZE) {
+      chunk = RADIOLIB_SPI_BUFFER_SIZE;
+    }
+    if(dataOut != NULL) {
+      memcpy(buff, dataOut + pos, chunk);
+    } else {
+      memset(buff, fill, chunk);
+    }
+    spi->transfer(buff, chunk);
+    if(dataIn != NULL) {
+      memcpy(dataIn + pos, buff, chunk);
+    }
+    pos += chunk;
+  }
+}
+
+inline uint8_t ArduinoHal::spiTransferFrameChecked(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len)) {
+  // same blocks as spiTransferFrame, incoming data are checked instead of copied out of the block
+  uint8_t buff[RADIOLIB_SPI_BUFFER_SIZE];
+  uint8_t status = 0;
+  size_t chunk = RADIOLIB_SPI_BUFFER_SIZE - headLen;
+  if(chunk > len) {
+    chunk = len;
+  }
+  memcpy(buff, head, headLen);
+  memcpy(buff + headLen, dataOut, chunk);
+  spi->transfer(buff, headLen + chunk);
+  memcpy(head, buff, headLen);
+  if(chunk > 0) {
+    status = check(buff + headLen, chunk);
+  }
+
+  size_t pos = chunk;
+  while(pos < len) {
+    chunk = len - pos;
+    if(chunk > RADIOLIB_SPI_BUFFER_SIZE) {
+      chunk = RADIOLIB_SPI_BUFFER_SIZE;
+    }
+    memcpy(buff, dataOut + pos, chunk);
+    spi->transfer(buff, chunk);
+    if(status == 0) {
+      status = check(buff, chunk);
+    }
+    pos += chunk;
+  }
+  return(status);
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "BufferPool.h"
+
+#if defined(RADIOLIB_BUFFER_POOL)
+const uint8_t BufferPool::_numBlocks[RADIOLIB_BUFFER_POOL_CLASSES] = { RADIOLIB_BUFFER_POOL_BLOCKS_32, RADIOLIB_BUFFER_POOL_BLOCKS_64, RADIOLIB_BUFFER_POOL_BLOCKS_256, RADIOLIB_BUFFER_POOL_BLOCKS_1024 };
+alignas(8) uint8_t BufferPool::_storage[RADIOLIB_BUFFER_POOL_SIZE];
+bool BufferPool::_used[RADIOLIB_BUFFER_POOL_NUM_BLOCKS];
+#else
+const uint8_t BufferPool::_numBlocks[RADIOLIB_BUFFER_POOL_CLASSES] = { 0, 0, 0, 0 };
+#endif
+const size_t BufferPool::_blockSizes[RADIOLIB_BUFFER_POOL_CLASSES] = { 32, 64, 256, 1024 };
+BufferPoolStats_t BufferPool::_stats[RADIOLIB_BUFFER_POOL_CLASSES];
+uint32_t BufferPool::_failures = 0;
+
+void* BufferPool::alloc(size_t len) {
+  #if defined(RADIOLIB_BUFFER_POOL)
+    // take the first free block, from a larger class when all blocks of the smallest matching one are in use
+    size_t index = 0;
+    size_t offset = 0;
+    for(uint8_t sizeClass = 0; sizeClass < RADIOLIB_BUFFER_POOL_CLASSES; sizeClass++) {
+      for(uint8_t i = 0; i < _numBlocks[sizeClass]; i++) {
+        if((len <= _blockSizes[sizeClass]) && !_used[index]) {
+          _used[index] = true;
+          BufferPoolStats_t* stats = &_stats[sizeClass];
+          stats->allocations++;
+          stats->used++;
+          if(stats->used > stats->maxUsed) {
+            stats->maxUsed = stats->used;
+          }
+          return(&_storage[offset]);
+        }
+        index++;
+        offset += _blockSizes[sizeClass];
+      }
+    }
+
+    _failures++;
+    return(NULL);
+
+  #else
+    uint8_t* ptr = new uint8_t[len];
+    if(ptr == NULL) {
+      _failures++;
+      return(NULL);
+    }
+
+    // oversized requests are counted in the largest class
+    uint8_t sizeClass = 0;
+    while((sizeClass < RADIOLIB_BUFFER_POOL_CLASSES - 1) && (len > _blockSizes[sizeClass])) {
+      sizeClass++;
+    }
+    _stats[sizeClass].allocations++;
+    return(ptr);
+
+  #endif
+}
+
+void BufferPool::free(void* ptr) {
+  if(ptr == NULL) {
+    return;
+  }
+
+  #if defined(RADIOLIB_BUFFER_POOL)
+    // find the block from its offset in the pool
+    size_t offset = (uint8_t*)ptr - _storage;
+    size_t index = 0;
+    for(uint8_t sizeClass = 0; sizeClass < RADIOLIB_BUFFER_POOL_CLASSES; sizeClass++) {
+      size_t classSize = _blockSizes[sizeClass] * _numBlocks[sizeClass];
+      if(offset < classSize) {
+        index += offset / _blockSizes[sizeClass];
+        if(_used[index]) {
+          _used[index] = false;
+          _stats[sizeClass].used--;
+        }
+        return;
+      }
+      offset -= classSize;
+      index += _numBlocks[sizeClass];
+    }
+
+  #else
+    delete[] (uint8_t*)ptr;
+
+  #endif
+}
+
+BufferPoolStats_t BufferPool::getStats(uint8_t sizeClass) {
+  BufferPoolStats_t stats;
+  memset(&stats, 0, sizeof(BufferPoolStats_t));
+  if(sizeClass >= RADIOLIB_BUFFER_POOL_CLASSES) {
+    return(stats);
+  }
+
+  stats = _stats[sizeClass];
+  stats.blockSize = _blockSizes[sizeClass];
+  stats.numBlocks = _numBlocks[sizeClass];
+  return(stats);
+}
+
+uint32_t BufferPool::getFailures() {
+  return(_failures);
+}
+
+void BufferPool::resetStats() {
+  for(uint8_t sizeClass = 0; sizeClass < RADIOLIB_BUFFER_POOL_CLASSES; sizeClass++) {
+    _stats[sizeClass].allocations = 0;
+    _stats[sizeClass].maxUsed = _stats[sizeClass].used;
+  }
+  _failures = 0;
+}
@@ -0,0 +1,120 @@
+#ifndef _RADIOLIB_BUFFER_POOL_H
+#define _RADIOLIB_BUFFER_POOL_H
+
+#include "TypeDef.h"
+
+// number of size classes
+#define RADIOLIB_BUFFER_POOL_CLASSES                  4
+
+// size classes, see BufferPool::getStats
+#define RADIOLIB_BUFFER_POOL_CLASS_32                 0
+#define RADIOLIB_BUFFER_POOL_CLASS_64                 1
+#define RADIOLIB_BUFFER_POOL_CLASS_256                2
+#define RADIOLIB_BUFFER_POOL_CLASS_1024               3
+
+#if defined(RADIOLIB_BUFFER_POOL)
+  #define RADIOLIB_BUFFER_POOL_NUM_BLOCKS             (RADIOLIB_BUFFER_POOL_BLOCKS_32 + RADIOLIB_BUFFER_POOL_BLOCKS_64 + RADIOLIB_BUFFER_POOL_BLOCKS_256 + RADIOLIB_BUFFER_POOL_BLOCKS_1024)
+  #define RADIOLIB_BUFFER_POOL_SIZE                   (32*RADIOLIB_BUFFER_POOL_BLOCKS_32 + 64*RADIOLIB_BUFFER_POOL_BLOCKS_64 + 256*RADIOLIB_BUFFER_POOL_BLOCKS_256 + 1024*RADIOLIB_BUFFER_POOL_BLOCKS_1024)
+#endif
+
+/*!
+  \struct BufferPoolStats_t
+
+  \brief Usage of a single size class of the buffer pool, see BufferPool::getStats.
+*/
+struct BufferPoolStats_t {
+
+  /*!
+    \brief Block size of the class in bytes.
+  */
+  size_t blockSize;
+
+  /*!
+    \brief Number of blocks in the class, 0 when the pool is disabled.
+  */
+  uint8_t numBlocks;
+
+  /*!
+    \brief Number of blocks currently in use. Only tracked when the pool is enabled.
+  */
+  uint8_t used;
+
+  /*!
+    \brief Highest number of blocks that were in use at the same time (high-water mark). Only tracked when the pool is enabled.
+  */
+  uint8_t maxUsed;
+
+  /*!
+    \brief Number of allocations served by this class. When the pool is disabled, heap allocations are counted in the class they would fit.
+  */
+  uint32_t allocations;
+};
+
+/*!
+  \class BufferPool
+
+  \brief Allocator for temporary buffers used by protocol and module methods (e.g. frames being built or responses being parsed).
+
+  When RADIOLIB_BUFFER_POOL is defined, buffers are taken from fixed-size blocks of a statically allocated pool, with size classes
+  tuned to radio packets (32, 64, 256 and 1024 bytes, number of blocks in each class is set in BuildOpt.h).
+  Each request takes the first free block of the smallest class it fits, or of a larger class when that one is exhausted.
+  Memory use is therefore known at compile time and the heap does not fragment on long-running nodes.
+  Otherwise, buffers are allocated on the heap.
+
+  The pool is not interrupt-safe, it must only be used from the main loop.
+*/
+class BufferPool {
+  public:
+    /*!
+      \brief Allocates buffer.
+
+      \param len Required buffer size in bytes.
+
+      \returns Pointer to the buffer, or NULL when there is no free block large enough.
+    */
+    static void* alloc(size_t len);
+
+    /*!
+      \brief Releases buffer allocated by BufferPool::alloc.
+
+      \param ptr Pointer to the buffer. Does nothing for NULL.
+    */
+    static void free(void* ptr);
+
+    /*!
+      \brief Gets usage of a size class.
+
+      \param sizeClass Size class, one of RADIOLIB_BUFFER_POOL_CLASS_* macros.
+
+      \returns Size class usage.
+    */
+    static BufferPoolStats_t getStats(uint8_t sizeClass);
+
+    /*!
+      \brief Gets the number of allocations that failed.
+
+      \returns Number of failed allocations.
+    */
+    static uint32_t getFailures();
+
+    /*!
+      \brief Resets allocation and failure counters. High-water marks are reset to the current usage.
+    */
+    static void resetStats();
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    static const size_t _blockSizes[RADIOLIB_BUFFER_POOL_CLASSES];
+    static const uint8_t _numBlocks[RADIOLIB_BUFFER_POOL_CLASSES];
+    static BufferPoolStats_t _stats[RADIOLIB_BUFFER_POOL_CLASSES];
+    static uint32_t _failures;
+
+    #if defined(RADIOLIB_BUFFER_POOL)
+      // blocks also hold arrays of pointers, so the pool has to be aligned for them
+      alignas(8) static uint8_t _storage[RADIOLIB_BUFFER_POOL_SIZE];
+      static bool _used[RADIOLIB_BUFFER_POOL_NUM_BLOCKS];
+    #endif
+};
+
+#endif
@@ -224,9 +224,77 @@
 
 //#define RADIOLIB_STATIC_ONLY
 
+/*
+ * Uncomment to enable buffer pool: temporary buffers of protocol and module methods are taken from fixed-size blocks
+ * in a statically allocated pool instead of the heap, so memory use is deterministic and the heap does not fragment on long-running nodes.
+ * Requests that do not fit any free block fail with ERR_MEMORY_ALLOCATION_FAILED. Usage can be checked by BufferPool::getStats.
+ */
+
+//#define RADIOLIB_BUFFER_POOL
+
+// set the number of blocks in each buffer pool size class (32, 64, 256 and 1024 bytes)
+#define RADIOLIB_BUFFER_POOL_BLOCKS_32      4
+#define RADIOLIB_BUFFER_POOL_BLOCKS_64      4
+#define RADIOLIB_BUFFER_POOL_BLOCKS_256     2
+#define RADIOLIB_BUFFER_POOL_BLOCKS_1024    1
+
+/*
+ * Hardware abstraction layer used for all GPIO, SPI and timing access. Defaults to ArduinoHal, which calls Arduino core directly.
+ * To use a different backend, define RADIOLIB_HAL as the name of the HAL class and RADIOLIB_HAL_HEADER as the header that declares it (e.g. via build flags).
+ * The class has to provide the same static methods as ArduinoHal.
+ * On Linux, LinuxHal can be used to access the module through spidev and GPIO character device instead of Arduino core.
+ */
+
+//#define RADIOLIB_HAL                ArduinoHal
+//#define RADIOLIB_HAL_HEADER         "ArduinoHal.h"
+
+/*
+ * Uncomment to run drivers against emulated chips instead of real hardware (e.g. for host-side testing and benchmarking).
+ * This selects EmulatorHal as the hardware abstraction layer, which runs on virtual time and forwards SPI transactions to chip emulators attached by EmulatorHal::attach.
+ */
+
+//#define RADIOLIB_EMULATOR
+
+#if defined(RADIOLIB_EMULATOR)
+  #define RADIOLIB_HAL                EmulatorHal
+  #define RADIOLIB_HAL_HEADER         "EmulatorHal.h"
+#endif
+
+/*
+ * Uncomment to enable SPI trace: every SPI transaction is logged as a compact binary record into a ring buffer in Module, which can be read by Module::SPItraceRead.
+ * Unlike verbose output, recording does not affect SPI timing. Use extras/SPITrace/spi_trace.py to decode the trace and extras/SPITrace/SPITraceReplay.cpp to replay it against chip emulators.
+ */
+
+//#define RADIOLIB_SPI_TRACE
+
+// set the size of SPI trace ring buffer in bytes
+#define RADIOLIB_SPI_TRACE_SIZE      1024
+
+/*
+ * Uncomment to enable instrumentation: each Module counts SPI transactions and bytes, time spent waiting for BUSY,
+ * time spent verifying register writes and interrupt to readData latency, attributed to the public API method that caused them.
+ * Results can be read by Module::getStats. Adds some overhead to every SPI transaction.
+ */
+
+//#define RADIOLIB_STATS
+
+/*
+ * Uncomment to enable coroutine layer: radio operations can be awaited with co_await from C++20 coroutines run by RadioExecutor,
+ * so that many sessions can share a few radios and a single thread. Requires compiler with C++20 coroutine support (e.g. -std=c++20).
+ */
+
+//#define RADIOLIB_COROUTINES
+
 // set the size of static arrays to use
 #define RADIOLIB_STATIC_ARRAY_SIZE   256
 
+// set the size of the stack buffer used for SPI block transfers
+// longer frames are split into multiple block transfers, it has to fit at least the longest frame header (RADIOLIB_SPI_HEADER_SIZE)
+#define RADIOLIB_SPI_BUFFER_SIZE     32
+
+// maximum length of SPI frame header: up to 4 command bytes followed by 1 status byte
+#define RADIOLIB_SPI_HEADER_SIZE     5
+
 /*!
   \brief A simple assert macro, will return on error.
 */
@@ -0,0 +1,710 @@
+#include "EmulatorHal.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+uint64_t EmulatorHal::_time = 0;
+uint32_t EmulatorHal::_spiSpeed = 2000000;
+uint32_t EmulatorHal::_callTime = 1000;
+
+EmulatedChip* EmulatorHal::_chips[RADIOLIB_EMULATOR_MAX_CHIPS];
+uint8_t EmulatorHal::_numChips = 0;
+
+RADIOLIB_PIN_STATUS EmulatorHal::_pinOut[RADIOLIB_EMULATOR_MAX_PINS];
+RADIOLIB_PIN_STATUS EmulatorHal::_pinLast[RADIOLIB_EMULATOR_MAX_PINS];
+void (*EmulatorHal::_pinFunc[RADIOLIB_EMULATOR_MAX_PINS])(void);
+RADIOLIB_INTERRUPT_STATUS EmulatorHal::_pinMode[RADIOLIB_EMULATOR_MAX_PINS];
+bool EmulatorHal::_pinPending[RADIOLIB_EMULATOR_MAX_PINS];
+bool EmulatorHal::_inIsr = false;
+bool EmulatorHal::_irqDisabled = false;
+bool EmulatorHal::_spiActive = false;
+uint32_t EmulatorHal::_isrCalls = 0;
+
+uint32_t EmulatorHal::_spiTransactions = 0;
+uint32_t EmulatorHal::_spiBytes = 0;
+uint32_t EmulatorHal::_spiConflicts = 0;
+
+void EmulatorHal::begin(uint32_t spiSpeed, uint32_t callTime) {
+  _time = 0;
+  _spiSpeed = spiSpeed;
+  _callTime = callTime;
+  _numChips = 0;
+  _inIsr = false;
+  _irqDisabled = false;
+  _spiActive = false;
+  _isrCalls = 0;
+  for(uint8_t i = 0; i < RADIOLIB_EMULATOR_MAX_PINS; i++) {
+    _pinOut[i] = LOW;
+    _pinLast[i] = LOW;
+    _pinFunc[i] = NULL;
+    _pinPending[i] = false;
+  }
+  resetStatistics();
+}
+
+bool EmulatorHal::attach(EmulatedChip* chip) {
+  if(_numChips >= RADIOLIB_EMULATOR_MAX_CHIPS) {
+    return(false);
+  }
+  _chips[_numChips++] = chip;
+
+  // chip select is idle until the driver takes over the pin, otherwise the chip would be selected before its Module was initialized
+  RADIOLIB_PIN_TYPE cs = chip->getCs();
+  if(cs < RADIOLIB_EMULATOR_MAX_PINS) {
+    _pinOut[cs] = HIGH;
+    _pinLast[cs] = HIGH;
+  }
+  return(true);
+}
+
+void EmulatorHal::advance(uint64_t ns) {
+  uint64_t target = _time + ns;
+  do {
+    // stop at every chip event, so that chips exchanging data over the air stay in sync
+    uint64_t next = nextEvent(target);
+    if(next > _time) {
+      _time = next;
+    }
+    for(uint8_t i = 0; i < _numChips; i++) {
+      _chips[i]->update(_time);
+    }
+    checkInterrupts();
+  } while(_time < target);
+}
+
+void EmulatorHal::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  for(uint8_t i = 0; i < _numChips; i++) {
+    if(_chips[i] != src) {
+      _chips[i]->airStart(src, air);
+    }
+  }
+}
+
+void EmulatorHal::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  for(uint8_t i = 0; i < _numChips; i++) {
+    if(_chips[i] != src) {
+      _chips[i]->airData(src, data, len);
+    }
+  }
+}
+
+void EmulatorHal::airEnd(EmulatedChip* src, bool crcOk) {
+  for(uint8_t i = 0; i < _numChips; i++) {
+    if(_chips[i] != src) {
+      _chips[i]->airEnd(src, crcOk);
+    }
+  }
+}
+
+bool EmulatorHal::airMatch(const EmulatorAir_t& tx, const EmulatorAir_t& rx) {
+  if((tx.modem != rx.modem) || (tx.sf != rx.sf)) {
+    return(false);
+  }
+
+  // allow for rounding of frequency and rate register values
+  uint32_t freqDiff = (tx.freq > rx.freq) ? (tx.freq - rx.freq) : (rx.freq - tx.freq);
+  uint32_t rateDiff = (tx.rate > rx.rate) ? (tx.rate - rx.rate) : (rx.rate - tx.rate);
+  return((freqDiff <= 10000) && (rateDiff <= tx.rate / 50));
+}
+
+void EmulatorHal::pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode) {
+  (void)pin;
+  (void)mode;
+  advance(_callTime);
+}
+
+void EmulatorHal::digitalWrite(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  if(pin < RADIOLIB_EMULATOR_MAX_PINS) {
+    _pinOut[pin] = value;
+    for(uint8_t i = 0; i < _numChips; i++) {
+      _chips[i]->writePin(pin, value);
+    }
+  }
+  advance(_callTime);
+}
+
+RADIOLIB_PIN_STATUS EmulatorHal::digitalRead(RADIOLIB_PIN_TYPE pin) {
+  advance(_callTime);
+  return(pinLevel(pin));
+}
+
+void EmulatorHal::attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode) {
+  if(pin >= RADIOLIB_EMULATOR_MAX_PINS) {
+    return;
+  }
+  _pinLast[pin] = pinLevel(pin);
+  _pinMode[pin] = mode;
+  _pinFunc[pin] = func;
+  _pinPending[pin] = false;
+}
+
+void EmulatorHal::detachInterrupt(RADIOLIB_PIN_TYPE pin) {
+  if(pin >= RADIOLIB_EMULATOR_MAX_PINS) {
+    return;
+  }
+  _pinFunc[pin] = NULL;
+  _pinPending[pin] = false;
+}
+
+bool EmulatorHal::waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout) {
+  uint64_t end = _time + (uint64_t)timeout * 1000000ULL;
+  advance(_callTime);
+  while(pinLevel(pin) != value) {
+    if(_time >= end) {
+      return(false);
+    }
+
+    // pins only change on chip events, skip straight to the next one
+    uint64_t next = nextEvent(end);
+    advance((next > _time) ? (next - _time) : _callTime);
+  }
+  return(true);
+}
+
+bool EmulatorHal::waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout) {
+  uint64_t end = _time + (uint64_t)timeout * 1000000ULL;
+  advance(_callTime);
+  while((pinLevel(pinA) != valueA) && (pinLevel(pinB) != valueB)) {
+    if(_time >= end) {
+      return(false);
+    }
+
+    // pins only change on chip events, skip straight to the next one
+    uint64_t next = nextEvent(end);
+    advance((next > _time) ? (next - _time) : _callTime);
+  }
+  return(true);
+}
+
+bool EmulatorHal::waitForInterrupt(uint32_t timeout) {
+  uint64_t end = _time + (uint64_t)timeout * 1000000ULL;
+  uint32_t calls = _isrCalls;
+  advance(_callTime);
+  while((_isrCalls == calls) && (_time < end)) {
+    // interrupts only happen on chip events, skip straight to the next one
+    uint64_t next = nextEvent(end);
+    advance((next > _time) ? (next - _time) : _callTime);
+  }
+  return(_isrCalls != calls);
+}
+
+void EmulatorHal::spiTransfer(SPIClass* spi, uint8_t* buff, size_t len) {
+  (void)spi;
+
+  // find the selected chip, more than one selected chip is a conflict on the bus - only the first one gets the frame
+  EmulatedChip* selected = NULL;
+  for(uint8_t i = 0; i < _numChips; i++) {
+    RADIOLIB_PIN_TYPE cs = _chips[i]->getCs();
+    if(((cs == RADIOLIB_NC) && (_numChips == 1)) || ((cs < RADIOLIB_EMULATOR_MAX_PINS) && (_pinOut[cs] == LOW))) {
+      if(selected != NULL) {
+        _spiConflicts++;
+        break;
+      }
+      selected = _chips[i];
+    }
+  }
+  if(selected != NULL) {
+    selected->spiTransfer(buff, len);
+  }
+
+  _spiTransactions++;
+  _spiBytes += len;
+  advance(((uint64_t)len * 8ULL * 1000000000ULL) / _spiSpeed);
+}
+
+void EmulatorHal::spiTransferFrame(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill) {
+  // chip emulators process whole frames, so the frame is assembled before it is handed over
+  uint8_t buff[RADIOLIB_SPI_HEADER_SIZE + 2*RADIOLIB_EMULATOR_BUFFER_SIZE];
+  if(len > sizeof(buff) - headLen) {
+    len = sizeof(buff) - headLen;
+  }
+  memcpy(buff, head, headLen);
+  if(dataOut != NULL) {
+    memcpy(buff + headLen, dataOut, len);
+  } else {
+    memset(buff + headLen, fill, len);
+  }
+  spiTransfer(spi, buff, headLen + len);
+  memcpy(head, buff, headLen);
+  if(dataIn != NULL) {
+    memcpy(dataIn, buff + headLen, len);
+  }
+}
+
+uint8_t EmulatorHal::spiTransferFrameChecked(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len)) {
+  uint8_t buff[RADIOLIB_SPI_HEADER_SIZE + 2*RADIOLIB_EMULATOR_BUFFER_SIZE];
+  if(len > sizeof(buff) - headLen) {
+    len = sizeof(buff) - headLen;
+  }
+  memcpy(buff, head, headLen);
+  memcpy(buff + headLen, dataOut, len);
+  spiTransfer(spi, buff, headLen + len);
+  memcpy(head, buff, headLen);
+
+  // incoming data are checked in blocks, as with the other HALs
+  uint8_t status = 0;
+  for(size_t pos = 0; (pos < len) && (status == 0); pos += RADIOLIB_SPI_BUFFER_SIZE) {
+    status = check(buff + headLen + pos, (len - pos < RADIOLIB_SPI_BUFFER_SIZE) ? len - pos : RADIOLIB_SPI_BUFFER_SIZE);
+  }
+  return(status);
+}
+
+uint32_t EmulatorHal::millis() {
+  advance(_callTime);
+  return((uint32_t)(_time / 1000000ULL));
+}
+
+uint32_t EmulatorHal::micros() {
+  advance(_callTime);
+  return((uint32_t)(_time / 1000ULL));
+}
+
+void EmulatorHal::delay(uint32_t ms) {
+  advance((uint64_t)ms * 1000000ULL);
+}
+
+void EmulatorHal::delayMicroseconds(uint32_t us) {
+  advance((uint64_t)us * 1000ULL);
+}
+
+RADIOLIB_PIN_STATUS EmulatorHal::pinLevel(RADIOLIB_PIN_TYPE pin) {
+  if(pin >= RADIOLIB_EMULATOR_MAX_PINS) {
+    return(LOW);
+  }
+
+  // pins driven by a chip take precedence over values written by the host
+  RADIOLIB_PIN_STATUS value;
+  for(uint8_t i = 0; i < _numChips; i++) {
+    if(_chips[i]->readPin(pin, &value)) {
+      return(value);
+    }
+  }
+  return(_pinOut[pin]);
+}
+
+uint64_t EmulatorHal::nextEvent(uint64_t limit) {
+  uint64_t next = limit;
+  for(uint8_t i = 0; i < _numChips; i++) {
+    uint64_t event = _chips[i]->nextEvent();
+    if(event < next) {
+      next = event;
+    }
+  }
+  return(next);
+}
+
+void EmulatorHal::checkInterrupts() {
+  // edges are latched even while interrupt service routine is running, same as interrupt flags of a real MCU
+  for(uint8_t pin = 0; pin < RADIOLIB_EMULATOR_MAX_PINS; pin++) {
+    if(_pinFunc[pin] == NULL) {
+      continue;
+    }
+
+    RADIOLIB_PIN_STATUS value = pinLevel(pin);
+    if(value == _pinLast[pin]) {
+      continue;
+    }
+    _pinLast[pin] = value;
+
+    if((_pinMode[pin] == CHANGE) || ((_pinMode[pin] == RISING) && (value == HIGH)) || ((_pinMode[pin] == FALLING) && (value == LOW))) {
+      _pinPending[pin] = true;
+    }
+  }
+
+  // interrupt service routines can call HAL methods, but are not interrupted themselves
+  if(_inIsr || _irqDisabled || _spiActive) {
+    return;
+  }
+  _inIsr = true;
+
+  for(uint8_t pin = 0; pin < RADIOLIB_EMULATOR_MAX_PINS; pin++) {
+    if(_pinPending[pin] && (_pinFunc[pin] != NULL)) {
+      _pinPending[pin] = false;
+      _pinFunc[pin]();
+      _isrCalls++;
+    }
+  }
+
+  _inIsr = false;
+}
+
+CommandChipEmulator::CommandChipEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE busy, RADIOLIB_PIN_TYPE dio1, RADIOLIB_PIN_TYPE rst) : EmulatedChip(cs) {
+  _busy = busy;
+  _dio1 = dio1;
+  _rst = rst;
+  for(uint16_t i = 0; i < 256; i++) {
+    _busyTime[i] = 0;
+  }
+  _startupTime = 0;
+  _txActive = false;
+  _rssi = -60;
+  _snr = 10;
+}
+
+void CommandChipEmulator::reset() {
+  init();
+  resetConfig();
+  _inReset = false;
+  _busyUntil = 0;
+  _busyPending = 0;
+  _busyTotal = 0;
+  _commands = 0;
+  _busyViolations = 0;
+  _txPackets = 0;
+  _rxPackets = 0;
+}
+
+void CommandChipEmulator::setBusyTime(uint8_t opcode, uint32_t ns) {
+  _busyTime[opcode] = ns;
+}
+
+void CommandChipEmulator::setStartupTime(uint64_t ns) {
+  _startupTime = ns;
+}
+
+bool CommandChipEmulator::injectPacket(const uint8_t* data, size_t len, bool crcError) {
+  if(_inReset || (_state != RADIOLIB_EMULATOR_STATE_RX) || (len > RADIOLIB_EMULATOR_BUFFER_SIZE - 1)) {
+    return(false);
+  }
+
+  _airLen = 0;
+  if(isVariableLength()) {
+    _airBuff[_airLen++] = (uint8_t)len;
+  }
+  memcpy(&_airBuff[_airLen], data, len);
+  _airLen += len;
+  receive(!crcError);
+  return(true);
+}
+
+void CommandChipEmulator::setSignal(int16_t rssi, int8_t snr) {
+  _rssi = rssi;
+  _snr = snr;
+}
+
+void CommandChipEmulator::spiTransfer(uint8_t* buff, size_t len) {
+  uint64_t now = EmulatorHal::getTimeNs();
+  _commands++;
+
+  // chip does not accept commands while BUSY is high
+  if(_inReset || (_state == RADIOLIB_EMULATOR_STATE_SLEEP) || (now < _busyUntil) || (len == 0)) {
+    _busyViolations++;
+    memset(buff, 0xFF, len);
+    return;
+  }
+
+  uint8_t in[2*RADIOLIB_EMULATOR_BUFFER_SIZE];
+  len = min(len, sizeof(in));
+  memcpy(in, buff, len);
+  memset(&in[len], 0x00, sizeof(in) - len);
+  _inCommand = true;
+  command(in, buff, len);
+  _inCommand = false;
+
+  // BUSY goes high once chip select is released
+  _busyPending += _busyTime[in[0]];
+  if(_cs == RADIOLIB_NC) {
+    commitBusy(now);
+  }
+}
+
+bool CommandChipEmulator::readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+  if(pin == RADIOLIB_NC) {
+    return(false);
+  }
+
+  if(pin == _busy) {
+    bool busy = _inReset || (_state == RADIOLIB_EMULATOR_STATE_SLEEP) || (EmulatorHal::getTimeNs() < _busyUntil);
+    *value = busy ? HIGH : LOW;
+    return(true);
+  } else if(pin == _dio1) {
+    *value = (_irq & _dio1Mask) ? HIGH : LOW;
+    return(true);
+  }
+  return(false);
+}
+
+void CommandChipEmulator::writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  if(pin == RADIOLIB_NC) {
+    return;
+  }
+  uint64_t now = EmulatorHal::getTimeNs();
+
+  if(pin == _rst) {
+    if(value == LOW) {
+      // everything is reset while reset pin is low
+      init();
+      resetConfig();
+      _inReset = true;
+    } else if(_inReset) {
+      _inReset = false;
+      _busyUntil = now + _startupTime;
+    }
+
+  } else if(pin == _cs) {
+    if(value == HIGH) {
+      commitBusy(now);
+    } else if(!_inReset && (_state == RADIOLIB_EMULATOR_STATE_SLEEP)) {
+      // falling edge of chip select wakes the chip up, configuration is lost in cold sleep
+      if(_coldSleep) {
+        init();
+        resetConfig();
+      }
+      _state = RADIOLIB_EMULATOR_STATE_STANDBY;
+      _busyUntil = now + _startupTime;
+    }
+  }
+}
+
+void CommandChipEmulator::update(uint64_t now) {
+  while(_eventTime <= now) {
+    uint64_t eventTime = _eventTime;
+    uint8_t eventType = _eventType;
+    _eventTime = UINT64_MAX;
+    _eventType = RADIOLIB_EMULATOR_EVENT_NONE;
+
+    switch(eventType) {
+      case RADIOLIB_EMULATOR_EVENT_TX_START:
+        // BUSY went low, PA is ramped up and transmission starts
+        _txActive = true;
+        EmulatorHal::airStart(this, getAir());
+        if((_txTimeout != 0) && (_txTimeout < _txDuration)) {
+          _eventType = RADIOLIB_EMULATOR_EVENT_TIMEOUT;
+          _eventTime = eventTime + _txTimeout;
+        } else {
+          _eventType = RADIOLIB_EMULATOR_EVENT_TX_DONE;
+          _eventTime = eventTime + _txDuration;
+        }
+        break;
+
+      case RADIOLIB_EMULATOR_EVENT_TX_DONE:
+        _txActive = false;
+        _txPackets++;
+        _state = RADIOLIB_EMULATOR_STATE_STANDBY;
+        EmulatorHal::airData(this, _airBuff, _airLen);
+        EmulatorHal::airEnd(this, true);
+        event(RADIOLIB_EMULATOR_EVENT_TX_DONE);
+        break;
+
+      case RADIOLIB_EMULATOR_EVENT_TIMEOUT:
+        abortTx();
+        _state = RADIOLIB_EMULATOR_STATE_STANDBY;
+        event(RADIOLIB_EMULATOR_EVENT_TIMEOUT);
+        break;
+
+      case RADIOLIB_EMULATOR_EVENT_CAD_DONE:
+        _state = RADIOLIB_EMULATOR_STATE_STANDBY;
+        event(_cadDetected ? RADIOLIB_EMULATOR_EVENT_CAD_DETECTED : RADIOLIB_EMULATOR_EVENT_CAD_DONE);
+        break;
+    }
+  }
+}
+
+uint64_t CommandChipEmulator::nextEvent() {
+  // end of BUSY is an event as well, so that waiting for BUSY skips straight to it
+  uint64_t next = _eventTime;
+  if((_busyUntil > EmulatorHal::getTimeNs()) && (_busyUntil < next)) {
+    next = _busyUntil;
+  }
+  return(next);
+}
+
+void CommandChipEmulator::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  if(_inReset || _txActive || (_airSrc != NULL) || (_state == RADIOLIB_EMULATOR_STATE_SLEEP) || !EmulatorHal::airMatch(air, getAir())) {
+    return;
+  }
+
+  // packet can only be received if the chip was already listening when it started
+  _airSrc = src;
+  _airLen = 0;
+  _airRx = (_state == RADIOLIB_EMULATOR_STATE_RX);
+  if(_state == RADIOLIB_EMULATOR_STATE_CAD) {
+    _cadDetected = true;
+  }
+
+  if(_airRx) {
+    // detected packet stops RX timeout
+    if(_eventType == RADIOLIB_EMULATOR_EVENT_TIMEOUT) {
+      _eventType = RADIOLIB_EMULATOR_EVENT_NONE;
+      _eventTime = UINT64_MAX;
+      _eventDeferred = false;
+    }
+    event(RADIOLIB_EMULATOR_EVENT_RX_START);
+  }
+}
+
+void CommandChipEmulator::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  if((src != _airSrc) || !_airRx) {
+    return;
+  }
+
+  len = min(len, sizeof(_airBuff) - _airLen);
+  memcpy(&_airBuff[_airLen], data, len);
+  _airLen += len;
+}
+
+void CommandChipEmulator::airEnd(EmulatedChip* src, bool crcOk) {
+  if(src != _airSrc) {
+    return;
+  }
+  _airSrc = NULL;
+
+  if(_airRx && (_state == RADIOLIB_EMULATOR_STATE_RX)) {
+    receive(crcOk);
+  }
+  _airRx = false;
+}
+
+void CommandChipEmulator::schedule(uint8_t event, uint64_t delay) {
+  _eventType = event;
+  _eventDelay = delay;
+  _eventTime = UINT64_MAX;
+  _eventDeferred = false;
+  if(event == RADIOLIB_EMULATOR_EVENT_NONE) {
+    return;
+  }
+
+  // events scheduled by a command are relative to the end of BUSY, which is not known until chip select is released
+  if(_inCommand) {
+    _eventDeferred = true;
+    return;
+  }
+  uint64_t now = EmulatorHal::getTimeNs();
+  _eventTime = max(now, _busyUntil) + delay;
+}
+
+void CommandChipEmulator::enterStandby(uint8_t state) {
+  abortTx();
+  schedule(RADIOLIB_EMULATOR_EVENT_NONE, 0);
+  _state = state;
+}
+
+void CommandChipEmulator::enterSleep(bool cold) {
+  enterStandby(RADIOLIB_EMULATOR_STATE_SLEEP);
+  _coldSleep = cold;
+}
+
+void CommandChipEmulator::startTx(size_t len, uint64_t timeout) {
+  enterStandby(RADIOLIB_EMULATOR_STATE_TX);
+
+  // packet is taken from the buffer at TX base address
+  _airLen = 0;
+  if(isVariableLength()) {
+    _airBuff[_airLen++] = (uint8_t)len;
+  }
+  for(size_t i = 0; i < len; i++) {
+    _airBuff[_airLen++] = _buff[(uint8_t)(_txBase + i)];
+  }
+  _txDuration = getTimeOnAir(len);
+  _txTimeout = timeout;
+  schedule(RADIOLIB_EMULATOR_EVENT_TX_START, 0);
+}
+
+void CommandChipEmulator::startRx(uint64_t timeout, bool continuous) {
+  enterStandby(RADIOLIB_EMULATOR_STATE_RX);
+  _rxContinuous = continuous;
+  if(!continuous && (timeout != 0)) {
+    schedule(RADIOLIB_EMULATOR_EVENT_TIMEOUT, timeout);
+  }
+}
+
+void CommandChipEmulator::startCad(uint64_t duration) {
+  enterStandby(RADIOLIB_EMULATOR_STATE_CAD);
+  _cadDetected = (_airSrc != NULL);
+  schedule(RADIOLIB_EMULATOR_EVENT_CAD_DONE, duration);
+}
+
+uint64_t CommandChipEmulator::getLoRaTimeOnAir(uint8_t sf, uint32_t bw, uint8_t cr, uint32_t preamble, size_t len, bool crc, bool implicitHeader, bool ldro) {
+  // number of symbols multiplied by 4 to keep everything in integers
+  int32_t bits = 8*(int32_t)len + (crc ? 16 : 0) - 4*sf + (implicitHeader ? 0 : 20);
+  int32_t bitsPerSymbol = 4*sf;
+  uint32_t symbols_x4 = 4*preamble + 4*8;
+  if(sf < 7) {
+    symbols_x4 += 25;
+  } else {
+    symbols_x4 += 17;
+    bits += 8;
+    if(ldro) {
+      bitsPerSymbol = 4*(sf - 2);
+    }
+  }
+  if(bits > 0) {
+    symbols_x4 += 4*((bits + bitsPerSymbol - 1) / bitsPerSymbol)*(cr + 4);
+  }
+
+  uint64_t symbolTime = ((uint64_t)1000000000 << sf) / bw;
+  return((symbols_x4 * symbolTime) / 4);
+}
+
+void CommandChipEmulator::init() {
+  abortTx();
+  _state = RADIOLIB_EMULATOR_STATE_STANDBY;
+  _rxContinuous = false;
+  _eventType = RADIOLIB_EMULATOR_EVENT_NONE;
+  _eventTime = UINT64_MAX;
+  _eventDelay = 0;
+  _eventDeferred = false;
+  _inCommand = false;
+  _coldSleep = false;
+  memset(_buff, 0x00, sizeof(_buff));
+  _txBase = 0;
+  _rxBase = 0;
+  _rxStart = 0;
+  _rxLen = 0;
+  _irq = 0;
+  _irqMask = 0;
+  _dio1Mask = 0;
+  _airLen = 0;
+  _airSrc = NULL;
+  _airRx = false;
+  _cadDetected = false;
+  _txDuration = 0;
+  _txTimeout = 0;
+}
+
+void CommandChipEmulator::commitBusy(uint64_t now) {
+  if((_busyPending == 0) && !_eventDeferred) {
+    return;
+  }
+
+  _busyUntil = now + _busyPending;
+  _busyTotal += _busyPending;
+  _busyPending = 0;
+  if(_eventDeferred) {
+    _eventTime = _busyUntil + _eventDelay;
+    _eventDeferred = false;
+  }
+}
+
+void CommandChipEmulator::receive(bool crcOk) {
+  // strip length byte and save the packet to buffer at RX base address
+  const uint8_t* data = _airBuff;
+  size_t len = _airLen;
+  if(isVariableLength() && (len > 0)) {
+    len = min((size_t)_airBuff[0], len - 1);
+    data++;
+  }
+  for(size_t i = 0; i < len; i++) {
+    _buff[(uint8_t)(_rxBase + i)] = data[i];
+  }
+  _rxStart = _rxBase;
+  _rxLen = (uint8_t)len;
+  _rxPackets++;
+
+  // single reception ends with the first packet
+  if(!_rxContinuous) {
+    enterStandby();
+  }
+  event(crcOk ? RADIOLIB_EMULATOR_EVENT_RX_DONE : RADIOLIB_EMULATOR_EVENT_RX_CRC_ERROR);
+}
+
+void CommandChipEmulator::abortTx() {
+  if(!_txActive) {
+    return;
+  }
+
+  // receivers only get incomplete packet
+  _txActive = false;
+  EmulatorHal::airEnd(this, false);
+}
+
+#endif
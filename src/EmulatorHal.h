@@ -0,0 +1,546 @@
+#ifndef _RADIOLIB_EMULATOR_HAL_H
+#define _RADIOLIB_EMULATOR_HAL_H
+
+#include "TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include <SPI.h>
+
+// maximum number of emulated chips that can be attached at the same time
+#define RADIOLIB_EMULATOR_MAX_CHIPS                   8
+
+// maximum number of GPIO pins that can be used
+#define RADIOLIB_EMULATOR_MAX_PINS                    64
+
+// modems that can exchange packets over the emulated air
+#define RADIOLIB_EMULATOR_MODEM_FSK                   0x00
+#define RADIOLIB_EMULATOR_MODEM_LORA                  0x01
+#define RADIOLIB_EMULATOR_MODEM_GFSK_24               0x02
+#define RADIOLIB_EMULATOR_MODEM_FLRC                  0x03
+#define RADIOLIB_EMULATOR_MODEM_SHOCKBURST            0x04
+
+// size of data buffer of command-based chips
+#define RADIOLIB_EMULATOR_BUFFER_SIZE                 256
+
+// operating states of command-based chips
+#define RADIOLIB_EMULATOR_STATE_STANDBY               0x00
+#define RADIOLIB_EMULATOR_STATE_SLEEP                 0x01
+#define RADIOLIB_EMULATOR_STATE_FS                    0x02
+#define RADIOLIB_EMULATOR_STATE_TX                    0x03
+#define RADIOLIB_EMULATOR_STATE_RX                    0x04
+#define RADIOLIB_EMULATOR_STATE_CAD                   0x05
+
+// events of command-based chips
+#define RADIOLIB_EMULATOR_EVENT_NONE                  0x00
+#define RADIOLIB_EMULATOR_EVENT_TX_START              0x01
+#define RADIOLIB_EMULATOR_EVENT_TX_DONE               0x02
+#define RADIOLIB_EMULATOR_EVENT_TIMEOUT               0x03
+#define RADIOLIB_EMULATOR_EVENT_CAD_DONE              0x04
+#define RADIOLIB_EMULATOR_EVENT_CAD_DETECTED          0x05
+#define RADIOLIB_EMULATOR_EVENT_RX_START              0x06
+#define RADIOLIB_EMULATOR_EVENT_RX_DONE               0x07
+#define RADIOLIB_EMULATOR_EVENT_RX_CRC_ERROR          0x08
+
+/*!
+  \struct EmulatorAir_t
+
+  \brief Parameters of a transmission over the emulated air. Receiver only gets the packet when the parameters match its own configuration.
+*/
+struct EmulatorAir_t {
+
+  /*!
+    \brief Modem, one of RADIOLIB_EMULATOR_MODEM_* macros.
+  */
+  uint8_t modem;
+
+  /*!
+    \brief Carrier frequency in Hz.
+  */
+  uint32_t freq;
+
+  /*!
+    \brief Bit rate in bps (FSK) or bandwidth in Hz (LoRa).
+  */
+  uint32_t rate;
+
+  /*!
+    \brief Spreading factor (LoRa only).
+  */
+  uint8_t sf;
+};
+
+/*!
+  \class EmulatedChip
+
+  \brief Base class of chip emulators. Chip emulators are attached to EmulatorHal, which forwards SPI transactions and GPIO access to them.
+*/
+class EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin, SPI transactions are only forwarded to the chip while this pin is low. Can be set to RADIOLIB_NC if only one chip is attached.
+    */
+    EmulatedChip(RADIOLIB_PIN_TYPE cs) { _cs = cs; }
+
+    virtual ~EmulatedChip() {}
+
+    /*!
+      \brief Processes single SPI transaction, incoming bytes overwrite the buffer contents.
+
+      \param buff Buffer to transfer.
+
+      \param len Number of bytes to transfer.
+    */
+    virtual void spiTransfer(uint8_t* buff, size_t len) = 0;
+
+    /*!
+      \brief Reads output pin of the chip.
+
+      \param pin Pin to read.
+
+      \param value Pointer to variable to save the pin value to.
+
+      \returns True if the pin is driven by this chip, false otherwise.
+    */
+    virtual bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) = 0;
+
+    /*!
+      \brief Notifies the chip about change of a GPIO pin driven by the host (e.g. reset).
+
+      \param pin Pin that was changed.
+
+      \param value New pin value.
+    */
+    virtual void writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) { (void)pin; (void)value; }
+
+    /*!
+      \brief Processes all events scheduled up to the provided virtual time.
+
+      \param now Current virtual time in ns.
+    */
+    virtual void update(uint64_t now) = 0;
+
+    /*!
+      \brief Gets virtual time of the next scheduled event.
+
+      \returns Time of the next event in ns, UINT64_MAX if there is none.
+    */
+    virtual uint64_t nextEvent() = 0;
+
+    /*!
+      \brief Called when another chip starts transmitting.
+
+      \param src Transmitting chip.
+
+      \param air Transmission parameters.
+    */
+    virtual void airStart(EmulatedChip* src, const EmulatorAir_t& air) { (void)src; (void)air; }
+
+    /*!
+      \brief Called when another chip transmits packet data.
+
+      \param src Transmitting chip.
+
+      \param data Transmitted bytes.
+
+      \param len Number of transmitted bytes.
+    */
+    virtual void airData(EmulatedChip* src, const uint8_t* data, size_t len) { (void)src; (void)data; (void)len; }
+
+    /*!
+      \brief Called when another chip finishes or aborts transmission.
+
+      \param src Transmitting chip.
+
+      \param crcOk Whether the packet was transmitted completely and should pass CRC check.
+    */
+    virtual void airEnd(EmulatedChip* src, bool crcOk) { (void)src; (void)crcOk; }
+
+    /*!
+      \brief Access method to get the chip select pin.
+
+      \returns Chip select pin configured in the constructor.
+    */
+    RADIOLIB_PIN_TYPE getCs() const { return(_cs); }
+
+#ifndef RADIOLIB_GODMODE
+  protected:
+#endif
+    RADIOLIB_PIN_TYPE _cs;
+};
+
+/*!
+  \class CommandChipEmulator
+
+  \brief Base class of emulators of command-based chips with BUSY line (SX126x, SX128x). Handles BUSY timing, reset and sleep,
+  256 byte data buffer, IRQ status with DIO1 mapping, and transmission, reception and CAD in virtual time.
+  Derived classes decode the chip-specific command set.
+
+  BUSY goes high on the rising edge of chip select for the time configured for the executed command.
+  Commands sent while BUSY is high are ignored by the chip (all bytes read back as 0xFF) and counted as BUSY violations.
+*/
+class CommandChipEmulator: public EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param busy BUSY pin.
+
+      \param dio1 DIO1 pin.
+
+      \param rst Reset pin.
+    */
+    CommandChipEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE busy, RADIOLIB_PIN_TYPE dio1, RADIOLIB_PIN_TYPE rst);
+
+    /*!
+      \brief Resets the chip and all statistics, same as pulling the reset pin low. BUSY timing configuration is kept.
+    */
+    void reset();
+
+    /*!
+      \brief Sets time for which BUSY stays high after a command.
+
+      \param opcode Command opcode.
+
+      \param ns BUSY time in ns.
+    */
+    void setBusyTime(uint8_t opcode, uint32_t ns);
+
+    /*!
+      \brief Sets time for which BUSY stays high after reset or wake up from sleep.
+
+      \param ns Startup time in ns.
+    */
+    void setStartupTime(uint64_t ns);
+
+    /*!
+      \brief Emulates reception of a packet. Only accepted when the chip is in receive mode.
+
+      \param data Packet payload. In variable length (G)FSK modes, length byte is added automatically.
+
+      \param len Payload length in bytes.
+
+      \param crcError Whether the packet should fail CRC check.
+
+      \returns True if the packet was accepted, false otherwise.
+    */
+    bool injectPacket(const uint8_t* data, size_t len, bool crcError = false);
+
+    /*!
+      \brief Sets signal parameters reported for received packets.
+
+      \param rssi RSSI in dBm.
+
+      \param snr SNR in dB (LoRa only).
+    */
+    void setSignal(int16_t rssi, int8_t snr);
+
+    /*!
+      \brief Calculates time-on-air of a packet with the current configuration.
+
+      \param len Payload length in bytes.
+
+      \returns Time-on-air in ns.
+    */
+    virtual uint64_t getTimeOnAir(size_t len) = 0;
+
+    /*!
+      \brief Gets the total time BUSY was held high by executed commands since reset.
+
+      \returns BUSY time in ns.
+    */
+    uint64_t getBusyTime() const { return(_busyTotal); }
+
+    /*!
+      \brief Gets the number of SPI transactions received since reset.
+
+      \returns Number of commands.
+    */
+    uint32_t getCommands() const { return(_commands); }
+
+    /*!
+      \brief Gets the number of commands that were ignored because they were sent while BUSY was high.
+
+      \returns Number of BUSY violations.
+    */
+    uint32_t getBusyViolations() const { return(_busyViolations); }
+
+    /*!
+      \brief Gets the number of transmitted packets since reset.
+
+      \returns Number of transmitted packets.
+    */
+    uint32_t getTxPackets() const { return(_txPackets); }
+
+    /*!
+      \brief Gets the number of received packets since reset.
+
+      \returns Number of received packets.
+    */
+    uint32_t getRxPackets() const { return(_rxPackets); }
+
+    // EmulatedChip methods
+
+    void spiTransfer(uint8_t* buff, size_t len);
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value);
+    void writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    void update(uint64_t now);
+    uint64_t nextEvent();
+    void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    void airEnd(EmulatedChip* src, bool crcOk);
+
+#ifndef RADIOLIB_GODMODE
+  protected:
+#endif
+    RADIOLIB_PIN_TYPE _busy, _dio1, _rst;
+
+    // BUSY timing
+    uint32_t _busyTime[256];
+    uint64_t _startupTime;
+    uint64_t _busyUntil, _busyPending, _busyTotal;
+    bool _inReset, _inCommand, _coldSleep;
+
+    // current state and the next scheduled event
+    uint8_t _state;
+    bool _rxContinuous;
+    uint8_t _eventType;
+    uint64_t _eventTime, _eventDelay;
+    bool _eventDeferred;
+
+    // data buffer
+    uint8_t _buff[RADIOLIB_EMULATOR_BUFFER_SIZE];
+    uint8_t _txBase, _rxBase, _rxStart, _rxLen;
+
+    // IRQ status
+    uint16_t _irq, _irqMask, _dio1Mask;
+
+    // packet on the air, either transmitted or received by this chip
+    uint8_t _airBuff[RADIOLIB_EMULATOR_BUFFER_SIZE + 1];
+    size_t _airLen;
+    EmulatedChip* _airSrc;
+    bool _airRx, _txActive, _cadDetected;
+    uint64_t _txDuration, _txTimeout;
+
+    int16_t _rssi;
+    int8_t _snr;
+
+    uint32_t _commands, _busyViolations, _txPackets, _rxPackets;
+
+    // chip-specific methods
+
+    /*!
+      \brief Executes single command. Response has to be written to out buffer.
+
+      \param in Bytes received from the host.
+
+      \param out Bytes sent back to the host.
+
+      \param len Transaction length in bytes.
+    */
+    virtual void command(const uint8_t* in, uint8_t* out, size_t len) = 0;
+
+    /*!
+      \brief Resets chip configuration to power-on defaults.
+    */
+    virtual void resetConfig() = 0;
+
+    /*!
+      \brief Gets transmission parameters of the current configuration.
+
+      \returns Emulated air parameters.
+    */
+    virtual EmulatorAir_t getAir() = 0;
+
+    /*!
+      \brief Checks whether packets in the current configuration start with length byte.
+
+      \returns True when length byte is transmitted as the first byte of packet.
+    */
+    virtual bool isVariableLength() = 0;
+
+    /*!
+      \brief Processes TX/RX/CAD event, e.g. by raising the corresponding IRQ flags.
+
+      \param event One of RADIOLIB_EMULATOR_EVENT_* macros.
+    */
+    virtual void event(uint8_t event) = 0;
+
+    // helper methods for derived classes
+
+    void schedule(uint8_t event, uint64_t delay);
+    void setIrq(uint16_t flags) { _irq |= (flags & _irqMask); }
+    void enterStandby(uint8_t state = RADIOLIB_EMULATOR_STATE_STANDBY);
+    void enterSleep(bool cold);
+    void startTx(size_t len, uint64_t timeout);
+    void startRx(uint64_t timeout, bool continuous);
+    void startCad(uint64_t duration);
+    static uint64_t getLoRaTimeOnAir(uint8_t sf, uint32_t bw, uint8_t cr, uint32_t preamble, size_t len, bool crc, bool implicitHeader, bool ldro);
+
+    void init();
+    void commitBusy(uint64_t now);
+    void receive(bool crcOk);
+    void abortTx();
+};
+
+/*!
+  \class EmulatorHal
+
+  \brief Hardware abstraction layer for running drivers against emulated chips. Time is virtual: it starts at 0 and only advances
+  when the driver spends time - every SPI transaction takes as long as it would on a real SPI bus, every GPIO and timing call costs a fixed amount of time,
+  and delays or waiting for a pin skip straight to the next event of the attached chips. Results are therefore deterministic and independent of host speed.
+  Interrupt service routines are called from within the HAL call during which the pin changed.
+
+  To use it, define RADIOLIB_EMULATOR, call EmulatorHal::begin and attach chip emulators (e.g. SX127xEmulator) before initializing the module.
+*/
+class EmulatorHal {
+  public:
+    /*!
+      \brief Resets virtual time, GPIO state and statistics and detaches all chips.
+
+      \param spiSpeed Emulated SPI clock frequency in Hz, used to calculate duration of SPI transactions. Defaults to 2 MHz.
+
+      \param callTime Virtual time spent in each GPIO and timing call in ns. Defaults to 1 us.
+    */
+    static void begin(uint32_t spiSpeed = 2000000, uint32_t callTime = 1000);
+
+    /*!
+      \brief Attaches chip emulator. Chip select pin of the chip is set high (idle).
+
+      \param chip Chip to attach.
+
+      \returns True if the chip was attached, false if there is no space left.
+    */
+    static bool attach(EmulatedChip* chip);
+
+    /*!
+      \brief Advances virtual time and processes all chip events that happen in the meantime.
+
+      \param ns Time to advance by in ns.
+    */
+    static void advance(uint64_t ns);
+
+    /*!
+      \brief Gets current virtual time.
+
+      \returns Virtual time since begin in ns.
+    */
+    static uint64_t getTimeNs() { return(_time); }
+
+    /*!
+      \brief Gets the number of SPI transactions since begin or the last call to resetStatistics.
+
+      \returns Number of SPI transactions.
+    */
+    static uint32_t getSpiTransactions() { return(_spiTransactions); }
+
+    /*!
+      \brief Gets the number of bytes transferred over SPI since begin or the last call to resetStatistics.
+
+      \returns Number of transferred bytes.
+    */
+    static uint32_t getSpiBytes() { return(_spiBytes); }
+
+    /*!
+      \brief Gets the number of SPI transactions made while chip select of more than one chip was low, since begin or the last call to resetStatistics.
+      Such transactions are only forwarded to the first selected chip.
+
+      \returns Number of SPI transactions with more than one chip selected.
+    */
+    static uint32_t getSpiConflicts() { return(_spiConflicts); }
+
+    /*!
+      \brief Resets SPI statistics.
+    */
+    static void resetStatistics() { _spiTransactions = 0; _spiBytes = 0; _spiConflicts = 0; }
+
+    // emulated air methods, called by the transmitting chip and forwarded to all other chips
+
+    static void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    static void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    static void airEnd(EmulatedChip* src, bool crcOk);
+
+    /*!
+      \brief Checks whether transmission can be received with the provided configuration.
+
+      \param tx Transmission parameters.
+
+      \param rx Receiver configuration.
+
+      \returns True if modem and spreading factor are the same and frequency and rate are close enough.
+    */
+    static bool airMatch(const EmulatorAir_t& tx, const EmulatorAir_t& rx);
+
+    // GPIO methods, see ArduinoHal for description
+
+    static void pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode);
+    static void digitalWrite(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    static RADIOLIB_PIN_STATUS digitalRead(RADIOLIB_PIN_TYPE pin);
+    static void attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode);
+    static void detachInterrupt(RADIOLIB_PIN_TYPE pin);
+    static bool waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout);
+    static bool waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout);
+    static bool waitForInterrupt(uint32_t timeout);
+    static inline void tone(RADIOLIB_PIN_TYPE pin, uint16_t value) { (void)pin; (void)value; }
+    static inline void noTone(RADIOLIB_PIN_TYPE pin) { (void)pin; }
+
+    // SPI methods, SPI interface passed by Module is not used - interrupts are deferred while SPI transaction is open,
+    // same as interrupts registered by SPI.usingInterrupt, so that interrupt service routines can use the shared bus
+
+    static inline void spiBegin(SPIClass* spi) { (void)spi; }
+    static inline void spiEnd(SPIClass* spi) { (void)spi; }
+    static inline void spiBeginTransaction(SPIClass* spi, SPISettings settings) { (void)spi; (void)settings; _spiActive = true; }
+    static void spiTransfer(SPIClass* spi, uint8_t* buff, size_t len);
+    static void spiTransferFrame(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill);
+    static uint8_t spiTransferFrameChecked(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len));
+    static inline void spiEndTransaction(SPIClass* spi) { (void)spi; _spiActive = false; checkInterrupts(); }
+
+    // timing methods, see ArduinoHal for description
+
+    static uint32_t millis();
+    static uint32_t micros();
+    static void delay(uint32_t ms);
+    static void delayMicroseconds(uint32_t us);
+
+    // interrupt methods, see ArduinoHal for description - pin edges are latched while interrupts are disabled,
+    // their interrupt service routines are called once interrupts are enabled again
+
+    static inline void disableInterrupts() { _irqDisabled = true; }
+    static inline void enableInterrupts() { _irqDisabled = false; checkInterrupts(); }
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    static uint64_t _time;
+    static uint32_t _spiSpeed;
+    static uint32_t _callTime;
+
+    static EmulatedChip* _chips[RADIOLIB_EMULATOR_MAX_CHIPS];
+    static uint8_t _numChips;
+
+    static RADIOLIB_PIN_STATUS _pinOut[RADIOLIB_EMULATOR_MAX_PINS];
+    static RADIOLIB_PIN_STATUS _pinLast[RADIOLIB_EMULATOR_MAX_PINS];
+    static void (*_pinFunc[RADIOLIB_EMULATOR_MAX_PINS])(void);
+    static RADIOLIB_INTERRUPT_STATUS _pinMode[RADIOLIB_EMULATOR_MAX_PINS];
+    static bool _pinPending[RADIOLIB_EMULATOR_MAX_PINS];
+    static bool _inIsr;
+    static bool _irqDisabled;
+    static bool _spiActive;
+    static uint32_t _isrCalls;
+
+    static uint32_t _spiTransactions;
+    static uint32_t _spiBytes;
+    static uint32_t _spiConflicts;
+
+    static RADIOLIB_PIN_STATUS pinLevel(RADIOLIB_PIN_TYPE pin);
+    static uint64_t nextEvent(uint64_t limit);
+    static void checkInterrupts();
+};
+
+#endif
+
+#endif
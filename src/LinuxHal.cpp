@@ -0,0 +1,455 @@
+#include "LinuxHal.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/spi/spidev.h>
+
+int LinuxHal::_spiFd = -1;
+int LinuxHal::_gpioFd = -1;
+int LinuxHal::_epollFd = -1;
+uint32_t LinuxHal::_spiSpeed = 0;
+
+int LinuxHal::_lineFd[RADIOLIB_LINUX_HAL_MAX_PINS];
+bool LinuxHal::_lineOutput[RADIOLIB_LINUX_HAL_MAX_PINS];
+void (*LinuxHal::_lineFunc[RADIOLIB_LINUX_HAL_MAX_PINS])(void);
+RADIOLIB_INTERRUPT_STATUS LinuxHal::_lineMode[RADIOLIB_LINUX_HAL_MAX_PINS];
+
+uint32_t LinuxHal::_ioctlCount = 0;
+uint32_t LinuxHal::_ioctlTime = 0;
+
+// open, fcntl and ioctl are variadic, so they have to be wrapped
+static int linuxHalOpen(const char* path, int flags) { return(open(path, flags)); }
+static int linuxHalFcntl(int fd, int cmd, int arg) { return(fcntl(fd, cmd, arg)); }
+static int linuxHalIoctl(int fd, unsigned long request, void* arg) { return(ioctl(fd, request, arg)); }
+
+static const LinuxHalSyscalls_t linuxHalSyscalls = {
+  linuxHalOpen, close, linuxHalIoctl, read, linuxHalFcntl, poll, epoll_create1, epoll_ctl, epoll_wait
+};
+
+const LinuxHalSyscalls_t* LinuxHal::_sys = &linuxHalSyscalls;
+
+void LinuxHal::setSyscalls(const LinuxHalSyscalls_t* syscalls) {
+  _sys = (syscalls != NULL) ? syscalls : &linuxHalSyscalls;
+}
+
+int16_t LinuxHal::begin(const char* spiDevice, const char* gpioChip, uint32_t spiSpeed, uint8_t spiMode) {
+  for(uint8_t i = 0; i < RADIOLIB_LINUX_HAL_MAX_PINS; i++) {
+    _lineFd[i] = -1;
+    _lineOutput[i] = false;
+    _lineFunc[i] = NULL;
+  }
+
+  // open devices
+  _spiFd = _sys->open(spiDevice, O_RDWR);
+  _gpioFd = _sys->open(gpioChip, O_RDWR);
+  _epollFd = _sys->epollCreate(0);
+  if((_spiFd < 0) || (_gpioFd < 0) || (_epollFd < 0)) {
+    RADIOLIB_DEBUG_PRINTLN(F("Failed to open SPI or GPIO device!"));
+    end();
+    return(ERR_INTERFACE_INIT_FAILED);
+  }
+
+  // configure SPI
+  uint8_t bits = 8;
+  _spiSpeed = spiSpeed;
+  if((ioctlTimed(_spiFd, SPI_IOC_WR_MODE, &spiMode) < 0) ||
+     (ioctlTimed(_spiFd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+     (ioctlTimed(_spiFd, SPI_IOC_WR_MAX_SPEED_HZ, &_spiSpeed) < 0)) {
+    RADIOLIB_DEBUG_PRINTLN(F("Failed to configure SPI device!"));
+    end();
+    return(ERR_INTERFACE_INIT_FAILED);
+  }
+
+  resetStatistics();
+  return(ERR_NONE);
+}
+
+void LinuxHal::end() {
+  for(uint8_t i = 0; (_gpioFd >= 0) && (i < RADIOLIB_LINUX_HAL_MAX_PINS); i++) {
+    releaseLine(i);
+  }
+
+  if(_spiFd >= 0) {
+    _sys->close(_spiFd);
+    _spiFd = -1;
+  }
+
+  if(_gpioFd >= 0) {
+    _sys->close(_gpioFd);
+    _gpioFd = -1;
+  }
+
+  if(_epollFd >= 0) {
+    _sys->close(_epollFd);
+    _epollFd = -1;
+  }
+}
+
+uint8_t LinuxHal::handleInterrupts(uint32_t timeout) {
+  // only lines with attached callbacks are registered in epoll
+  struct epoll_event events[RADIOLIB_LINUX_HAL_MAX_PINS];
+  if(_epollFd < 0) {
+    return(0);
+  }
+  int numEvents = _sys->epollWait(_epollFd, events, RADIOLIB_LINUX_HAL_MAX_PINS, timeout);
+  if(numEvents <= 0) {
+    return(0);
+  }
+
+  // call callbacks for all queued edges that match the requested one
+  uint8_t numCalled = 0;
+  for(int i = 0; i < numEvents; i++) {
+    RADIOLIB_PIN_TYPE pin = events[i].data.u32;
+    bool rising = false;
+    while((_lineFunc[pin] != NULL) && readEvent(pin, &rising)) {
+      if((_lineMode[pin] == CHANGE) || ((_lineMode[pin] == RISING) && rising) || ((_lineMode[pin] == FALLING) && !rising)) {
+        _lineFunc[pin]();
+        numCalled++;
+      }
+    }
+  }
+
+  return(numCalled);
+}
+
+void LinuxHal::pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode) {
+  if((pin >= RADIOLIB_LINUX_HAL_MAX_PINS) || (_gpioFd < 0)) {
+    return;
+  }
+
+  // line can only be requested once, release it first
+  releaseLine(pin);
+
+  if(mode == OUTPUT) {
+    struct gpiohandle_request req;
+    memset(&req, 0, sizeof(req));
+    req.lineoffsets[0] = pin;
+    req.flags = GPIOHANDLE_REQUEST_OUTPUT;
+    req.lines = 1;
+    strncpy(req.consumer_label, "RadioLib", sizeof(req.consumer_label) - 1);
+    if(ioctlTimed(_gpioFd, GPIO_GET_LINEHANDLE_IOCTL, &req) < 0) {
+      RADIOLIB_DEBUG_PRINTLN(F("Failed to request GPIO line!"));
+      return;
+    }
+    _lineFd[pin] = req.fd;
+    _lineOutput[pin] = true;
+
+  } else {
+    // inputs are requested with edge events, so that they can be waited for
+    struct gpioevent_request req;
+    memset(&req, 0, sizeof(req));
+    req.lineoffset = pin;
+    req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    req.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;
+    strncpy(req.consumer_label, "RadioLib", sizeof(req.consumer_label) - 1);
+    if(ioctlTimed(_gpioFd, GPIO_GET_LINEEVENT_IOCTL, &req) < 0) {
+      RADIOLIB_DEBUG_PRINTLN(F("Failed to request GPIO line!"));
+      return;
+    }
+    _lineFd[pin] = req.fd;
+    _lineOutput[pin] = false;
+
+    // read events without blocking, waiting is done in poll()
+    _sys->fcntl(req.fd, F_SETFL, _sys->fcntl(req.fd, F_GETFL, 0) | O_NONBLOCK);
+  }
+}
+
+void LinuxHal::digitalWrite(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  // unused pins (e.g. chip select driven by spidev) are silently ignored
+  if((pin >= RADIOLIB_LINUX_HAL_MAX_PINS) || (_gpioFd < 0) || (_lineFd[pin] < 0) || !_lineOutput[pin]) {
+    return;
+  }
+
+  struct gpiohandle_data data;
+  memset(&data, 0, sizeof(data));
+  data.values[0] = (value == HIGH);
+  ioctlTimed(_lineFd[pin], GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data);
+}
+
+RADIOLIB_PIN_STATUS LinuxHal::digitalRead(RADIOLIB_PIN_TYPE pin) {
+  if((pin >= RADIOLIB_LINUX_HAL_MAX_PINS) || (_gpioFd < 0) || (_lineFd[pin] < 0)) {
+    return(LOW);
+  }
+
+  struct gpiohandle_data data;
+  memset(&data, 0, sizeof(data));
+  if(ioctlTimed(_lineFd[pin], GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+    return(LOW);
+  }
+  return(data.values[0] ? HIGH : LOW);
+}
+
+void LinuxHal::attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode) {
+  if((pin >= RADIOLIB_LINUX_HAL_MAX_PINS) || (_gpioFd < 0)) {
+    return;
+  }
+
+  // make sure the line is requested with edge events
+  if((_lineFd[pin] < 0) || _lineOutput[pin]) {
+    LinuxHal::pinMode(pin, INPUT);
+  }
+
+  // drop events that happened before the callback was attached
+  bool rising;
+  while(readEvent(pin, &rising));
+
+  // register the line in epoll, unless it already is
+  if((_lineFunc[pin] == NULL) && (_lineFd[pin] >= 0)) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = pin;
+    _sys->epollCtl(_epollFd, EPOLL_CTL_ADD, _lineFd[pin], &event);
+  }
+
+  _lineMode[pin] = mode;
+  _lineFunc[pin] = func;
+}
+
+void LinuxHal::detachInterrupt(RADIOLIB_PIN_TYPE pin) {
+  if(pin >= RADIOLIB_LINUX_HAL_MAX_PINS) {
+    return;
+  }
+
+  if((_lineFunc[pin] != NULL) && (_lineFd[pin] >= 0) && (_epollFd >= 0)) {
+    _sys->epollCtl(_epollFd, EPOLL_CTL_DEL, _lineFd[pin], NULL);
+  }
+  _lineFunc[pin] = NULL;
+}
+
+bool LinuxHal::waitForInterrupt(uint32_t timeout) {
+  return(handleInterrupts(timeout) > 0);
+}
+
+bool LinuxHal::waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout) {
+  // lines without edge events can only be polled
+  if((pin >= RADIOLIB_LINUX_HAL_MAX_PINS) || (_gpioFd < 0) || (_lineFd[pin] < 0) || _lineOutput[pin]) {
+    uint32_t start = LinuxHal::millis();
+    while(LinuxHal::digitalRead(pin) != value) {
+      if(LinuxHal::millis() - start >= timeout) {
+        return(false);
+      }
+    }
+    return(true);
+  }
+
+  // block until the line changes, then check its value again
+  uint32_t start = LinuxHal::millis();
+  while(LinuxHal::digitalRead(pin) != value) {
+    uint32_t elapsed = LinuxHal::millis() - start;
+    if(elapsed >= timeout) {
+      return(false);
+    }
+
+    struct pollfd fd;
+    fd.fd = _lineFd[pin];
+    fd.events = POLLIN;
+    fd.revents = 0;
+    if(_sys->poll(&fd, 1, timeout - elapsed) > 0) {
+      bool rising;
+      while(readEvent(pin, &rising));
+    }
+  }
+  return(true);
+}
+
+bool LinuxHal::waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout) {
+  // both lines have to provide edge events, otherwise they are polled
+  RADIOLIB_PIN_TYPE pins[2] = { pinA, pinB };
+  bool events = (_gpioFd >= 0);
+  for(uint8_t i = 0; i < 2; i++) {
+    events = events && (pins[i] < RADIOLIB_LINUX_HAL_MAX_PINS) && (_lineFd[pins[i]] >= 0) && !_lineOutput[pins[i]];
+  }
+
+  uint32_t start = LinuxHal::millis();
+  while((LinuxHal::digitalRead(pinA) != valueA) && (LinuxHal::digitalRead(pinB) != valueB)) {
+    uint32_t elapsed = LinuxHal::millis() - start;
+    if(elapsed >= timeout) {
+      return(false);
+    }
+    if(!events) {
+      continue;
+    }
+
+    // block until either line changes, then check both values again
+    struct pollfd fds[2];
+    for(uint8_t i = 0; i < 2; i++) {
+      fds[i].fd = _lineFd[pins[i]];
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+    }
+    if(_sys->poll(fds, 2, timeout - elapsed) > 0) {
+      bool rising;
+      for(uint8_t i = 0; i < 2; i++) {
+        while((fds[i].revents & POLLIN) && readEvent(pins[i], &rising));
+      }
+    }
+  }
+  return(true);
+}
+
+void LinuxHal::spiTransfer(SPIClass* spi, uint8_t* buff, size_t len) {
+  (void)spi;
+
+  // the whole frame is sent as a single message, spidev copies transmit data before it overwrites the buffer with received data
+  struct spi_ioc_transfer tr;
+  memset(&tr, 0, sizeof(tr));
+  tr.tx_buf = (unsigned long)buff;
+  tr.rx_buf = (unsigned long)buff;
+  tr.len = len;
+  tr.speed_hz = _spiSpeed;
+  tr.bits_per_word = 8;
+  if(ioctlTimed(_spiFd, SPI_IOC_MESSAGE(1), &tr) < 0) {
+    RADIOLIB_DEBUG_PRINTLN(F("SPI transfer failed!"));
+  }
+}
+
+void LinuxHal::spiTransferFrame(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill) {
+  (void)spi;
+
+  // header and data are transfers of the same message, spidev keeps chip select active between them
+  struct spi_ioc_transfer tr[1 + RADIOLIB_LINUX_HAL_FILL_TRANSFERS];
+  memset(tr, 0, sizeof(tr));
+  tr[0].tx_buf = (unsigned long)head;
+  tr[0].rx_buf = (unsigned long)head;
+  tr[0].len = headLen;
+  size_t num = 1;
+
+  // without transmit buffer, spidev sends zeros, other fill bytes are sent from the receive buffer
+  // or, when the incoming data are discarded, by repeating one block of fill bytes on stack
+  uint8_t fillBuff[RADIOLIB_SPI_BUFFER_SIZE];
+  if((dataOut == NULL) && (fill != 0x00) && (dataIn == NULL)) {
+    memset(fillBuff, fill, sizeof(fillBuff));
+    while((len > 0) && (num < 1 + RADIOLIB_LINUX_HAL_FILL_TRANSFERS)) {
+      tr[num].tx_buf = (unsigned long)fillBuff;
+      tr[num].len = (len < sizeof(fillBuff)) ? len : sizeof(fillBuff);
+      len -= tr[num].len;
+      num++;
+    }
+    if(len > 0) {
+      RADIOLIB_DEBUG_PRINTLN(F("SPI fill too long!"));
+    }
+
+  } else if(len > 0) {
+    const uint8_t* tx = dataOut;
+    if((tx == NULL) && (fill != 0x00)) {
+      memset(dataIn, fill, len);
+      tx = dataIn;
+    }
+    tr[1].tx_buf = (unsigned long)tx;
+    tr[1].rx_buf = (unsigned long)dataIn;
+    tr[1].len = len;
+    num++;
+  }
+
+  for(size_t i = 0; i < num; i++) {
+    tr[i].speed_hz = _spiSpeed;
+    tr[i].bits_per_word = 8;
+  }
+  if(ioctlTimed(_spiFd, SPI_IOC_MESSAGE(num), tr) < 0) {
+    RADIOLIB_DEBUG_PRINTLN(F("SPI transfer failed!"));
+  }
+}
+
+uint8_t LinuxHal::spiTransferFrameChecked(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len)) {
+  (void)spi;
+
+  // the whole frame is still a single message, incoming data are received into blocks on stack, one transfer per block
+  struct spi_ioc_transfer tr[1 + RADIOLIB_LINUX_HAL_FILL_TRANSFERS];
+  uint8_t in[RADIOLIB_LINUX_HAL_FILL_TRANSFERS][RADIOLIB_SPI_BUFFER_SIZE];
+  memset(tr, 0, sizeof(tr));
+  tr[0].tx_buf = (unsigned long)head;
+  tr[0].rx_buf = (unsigned long)head;
+  tr[0].len = headLen;
+  size_t num = 1;
+  size_t pos = 0;
+  while((pos < len) && (num < 1 + RADIOLIB_LINUX_HAL_FILL_TRANSFERS)) {
+    tr[num].tx_buf = (unsigned long)(dataOut + pos);
+    tr[num].rx_buf = (unsigned long)in[num - 1];
+    tr[num].len = (len - pos < RADIOLIB_SPI_BUFFER_SIZE) ? len - pos : RADIOLIB_SPI_BUFFER_SIZE;
+    pos += tr[num].len;
+    num++;
+  }
+  if(pos < len) {
+    RADIOLIB_DEBUG_PRINTLN(F("SPI frame too long!"));
+  }
+
+  for(size_t i = 0; i < num; i++) {
+    tr[i].speed_hz = _spiSpeed;
+    tr[i].bits_per_word = 8;
+  }
+  if(ioctlTimed(_spiFd, SPI_IOC_MESSAGE(num), tr) < 0) {
+    RADIOLIB_DEBUG_PRINTLN(F("SPI transfer failed!"));
+    return(0);
+  }
+
+  uint8_t status = 0;
+  for(size_t i = 1; (i < num) && (status == 0); i++) {
+    status = check(in[i - 1], tr[i].len);
+  }
+  return(status);
+}
+
+uint32_t LinuxHal::millis() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint32_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000));
+}
+
+uint32_t LinuxHal::micros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000));
+}
+
+void LinuxHal::delay(uint32_t ms) {
+  LinuxHal::delayMicroseconds(ms * 1000);
+}
+
+void LinuxHal::delayMicroseconds(uint32_t us) {
+  struct timespec ts;
+  ts.tv_sec = us / 1000000;
+  ts.tv_nsec = (us % 1000000) * 1000;
+  while((nanosleep(&ts, &ts) < 0) && (errno == EINTR));
+}
+
+int LinuxHal::ioctlTimed(int fd, unsigned long request, void* arg) {
+  uint32_t start = LinuxHal::micros();
+  int ret = _sys->ioctl(fd, request, arg);
+  _ioctlTime += LinuxHal::micros() - start;
+  _ioctlCount++;
+  return(ret);
+}
+
+void LinuxHal::releaseLine(RADIOLIB_PIN_TYPE pin) {
+  if(_lineFd[pin] >= 0) {
+    _sys->close(_lineFd[pin]);
+    _lineFd[pin] = -1;
+  }
+  _lineFunc[pin] = NULL;
+}
+
+bool LinuxHal::readEvent(RADIOLIB_PIN_TYPE pin, bool* rising) {
+  if((_gpioFd < 0) || (_lineFd[pin] < 0) || _lineOutput[pin]) {
+    return(false);
+  }
+
+  struct gpioevent_data event;
+  if(_sys->read(_lineFd[pin], &event, sizeof(event)) != sizeof(event)) {
+    return(false);
+  }
+
+  *rising = (event.id == GPIOEVENT_EVENT_RISING_EDGE);
+  return(true);
+}
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef _RADIOLIB_LINUX_HAL_H
+#define _RADIOLIB_LINUX_HAL_H
+
+#if defined(__linux__)
+
+#include "TypeDef.h"
+
+#include <SPI.h>
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/types.h>
+
+// maximum number of GPIO lines (offsets on the GPIO chip) that can be used
+#define RADIOLIB_LINUX_HAL_MAX_PINS                   64
+
+// maximum number of RADIOLIB_SPI_BUFFER_SIZE blocks of fill bytes sent in one SPI frame when the incoming data are discarded,
+// and of incoming data received in one SPI frame when they are only checked, the default covers the longest frame sent by Module (255 data bytes)
+#define RADIOLIB_LINUX_HAL_FILL_TRANSFERS             8
+
+/*!
+  \struct LinuxHalSyscalls_t
+
+  \brief System calls LinuxHal uses to access SPI and GPIO devices. Can be replaced by LinuxHal::setSyscalls,
+  e.g. to run LinuxHal against fake devices on a host without spidev and GPIO character device.
+*/
+struct LinuxHalSyscalls_t {
+  /*!
+    \brief Opens device, see open(2).
+  */
+  int (*open)(const char* path, int flags);
+
+  /*!
+    \brief Closes file descriptor, see close(2).
+  */
+  int (*close)(int fd);
+
+  /*!
+    \brief Device control, see ioctl(2).
+  */
+  int (*ioctl)(int fd, unsigned long request, void* arg);
+
+  /*!
+    \brief Reads from file descriptor, used for GPIO line events, see read(2).
+  */
+  ssize_t (*read)(int fd, void* buff, size_t len);
+
+  /*!
+    \brief Gets or sets file descriptor flags, see fcntl(2).
+  */
+  int (*fcntl)(int fd, int cmd, int arg);
+
+  /*!
+    \brief Waits for event on file descriptors, see poll(2).
+  */
+  int (*poll)(struct pollfd* fds, nfds_t numFds, int timeout);
+
+  /*!
+    \brief Creates epoll instance, see epoll_create1(2).
+  */
+  int (*epollCreate)(int flags);
+
+  /*!
+    \brief Adds or removes file descriptor from epoll instance, see epoll_ctl(2).
+  */
+  int (*epollCtl)(int epfd, int op, int fd, struct epoll_event* event);
+
+  /*!
+    \brief Waits for events on epoll instance, see epoll_wait(2).
+  */
+  int (*epollWait)(int epfd, struct epoll_event* events, int maxEvents, int timeout);
+};
+
+/*!
+  \class LinuxHal
+
+  \brief Hardware abstraction layer for Linux userspace. SPI is accessed through spidev, with every SPI frame sent as a single SPI_IOC_MESSAGE ioctl.
+  GPIO is accessed through GPIO character device, pin numbers are line offsets on the GPIO chip. Input pins are requested with edge events,
+  so that waiting for a pin (e.g. SX126x BUSY) blocks in poll() instead of repeatedly reading the pin value.
+
+  To use it, build with RADIOLIB_HAL set to LinuxHal and RADIOLIB_HAL_HEADER set to "LinuxHal.h", and call LinuxHal::begin before initializing the module.
+  Chip select is driven by spidev, so the module can be constructed with RADIOLIB_NC as chip select pin.
+  Since interrupt service routines cannot run in userspace, attached callbacks are only called from LinuxHal::handleInterrupts.
+  Lines with attached callbacks are registered in a single epoll instance, so waiting for interrupts does not depend on the number of lines in use.
+*/
+class LinuxHal {
+  public:
+    /*!
+      \brief Opens and configures SPI and GPIO devices.
+
+      \param spiDevice Path to spidev device. Defaults to "/dev/spidev0.0".
+
+      \param gpioChip Path to GPIO character device. Defaults to "/dev/gpiochip0".
+
+      \param spiSpeed SPI clock frequency in Hz. Defaults to 2 MHz.
+
+      \param spiMode SPI mode. Defaults to mode 0.
+
+      \returns \ref status_codes
+    */
+    static int16_t begin(const char* spiDevice = "/dev/spidev0.0", const char* gpioChip = "/dev/gpiochip0", uint32_t spiSpeed = 2000000, uint8_t spiMode = 0);
+
+    /*!
+      \brief Releases all GPIO lines and closes SPI and GPIO devices.
+    */
+    static void end();
+
+    /*!
+      \brief Waits for pin change events on pins with attached callbacks and calls the callbacks. Has to be called periodically from the application.
+
+      \param timeout Maximum time to wait for an event in milliseconds, 0 to only process events that are already pending.
+
+      \returns Number of callbacks that were called.
+    */
+    static uint8_t handleInterrupts(uint32_t timeout = 0);
+
+    /*!
+      \brief Replaces system calls used to access devices. Has to be called before begin.
+
+      \param syscalls System calls to use, NULL to restore the default ones. Must remain valid while LinuxHal is in use.
+    */
+    static void setSyscalls(const LinuxHalSyscalls_t* syscalls);
+
+    /*!
+      \brief Gets the number of ioctl calls made since begin or the last call to resetStatistics.
+
+      \returns Number of ioctl calls.
+    */
+    static uint32_t getIoctlCount() { return(_ioctlCount); }
+
+    /*!
+      \brief Gets the total time spent in ioctl calls since begin or the last call to resetStatistics.
+
+      \returns Time spent in ioctl calls in microseconds.
+    */
+    static uint32_t getIoctlTime() { return(_ioctlTime); }
+
+    /*!
+      \brief Resets ioctl statistics.
+    */
+    static void resetStatistics() { _ioctlCount = 0; _ioctlTime = 0; }
+
+    // GPIO methods, see ArduinoHal for description
+
+    static void pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode);
+    static void digitalWrite(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    static RADIOLIB_PIN_STATUS digitalRead(RADIOLIB_PIN_TYPE pin);
+    static void attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode);
+    static void detachInterrupt(RADIOLIB_PIN_TYPE pin);
+    static bool waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout);
+    static bool waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout);
+    static bool waitForInterrupt(uint32_t timeout);
+    static inline void tone(RADIOLIB_PIN_TYPE pin, uint16_t value) { (void)pin; (void)value; }
+    static inline void noTone(RADIOLIB_PIN_TYPE pin) { (void)pin; }
+
+    // SPI methods, SPI interface passed by Module is not used - spidev device is set in begin
+
+    static inline void spiBegin(SPIClass* spi) { (void)spi; }
+    static inline void spiEnd(SPIClass* spi) { (void)spi; }
+    static inline void spiBeginTransaction(SPIClass* spi, SPISettings settings) { (void)spi; (void)settings; }
+    static void spiTransfer(SPIClass* spi, uint8_t* buff, size_t len);
+    static void spiTransferFrame(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill);
+    static uint8_t spiTransferFrameChecked(SPIClass* spi, uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len));
+    static inline void spiEndTransaction(SPIClass* spi) { (void)spi; }
+
+    // timing methods, see ArduinoHal for description
+
+    static uint32_t millis();
+    static uint32_t micros();
+    static void delay(uint32_t ms);
+    static void delayMicroseconds(uint32_t us);
+
+    // interrupt methods, see ArduinoHal for description - callbacks only run from handleInterrupts, so there is nothing to disable
+
+    static inline void disableInterrupts() {}
+    static inline void enableInterrupts() {}
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    static int _spiFd;
+    static int _gpioFd;
+    static int _epollFd;
+    static uint32_t _spiSpeed;
+
+    static int _lineFd[RADIOLIB_LINUX_HAL_MAX_PINS];
+    static bool _lineOutput[RADIOLIB_LINUX_HAL_MAX_PINS];
+    static void (*_lineFunc[RADIOLIB_LINUX_HAL_MAX_PINS])(void);
+    static RADIOLIB_INTERRUPT_STATUS _lineMode[RADIOLIB_LINUX_HAL_MAX_PINS];
+
+    static uint32_t _ioctlCount;
+    static uint32_t _ioctlTime;
+
+    static const LinuxHalSyscalls_t* _sys;
+
+    static int ioctlTimed(int fd, unsigned long request, void* arg);
+    static void releaseLine(RADIOLIB_PIN_TYPE pin);
+    static bool readEvent(RADIOLIB_PIN_TYPE pin, bool* rising);
+};
+
+#endif
+
+#endif
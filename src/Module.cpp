@@ -1,4 +1,5 @@
 #include "Module.h"
+#include "ATEngine.h"
 
 Module::Module(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rst) {
   _cs = cs;
@@ -78,6 +79,13 @@ Module::Module(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rs
 #endif
 }
 
+Module::~Module() {
+  #ifndef RADIOLIB_STATIC_ONLY
+    delete[] _regCache;
+    delete[] _regCacheValid;
+  #endif
+}
+
 void Module::init(uint8_t interface) {
   // select interface
   switch(interface) {
@@ -85,7 +93,7 @@ void Module::init(uint8_t interface) {
       Module::pinMode(_cs, OUTPUT);
       Module::digitalWrite(_cs, HIGH);
       if(_initInterface) {
-        _spi->begin();
+        RADIOLIB_HAL::spiBegin(_spi);
       }
       break;
     case RADIOLIB_USE_UART:
@@ -105,7 +113,7 @@ void Module::init(uint8_t interface) {
 void Module::term() {
   // stop hardware interfaces
   if(_spi != nullptr) {
-    _spi->end();
+    RADIOLIB_HAL::spiEnd(_spi);
   }
 
   if(ModuleSerial != nullptr) {
@@ -137,27 +145,11 @@ bool Module::ATsendData(uint8_t* data, uint32_t len) {
 }
 
 bool Module::ATgetResponse() {
-  char data[128];
-  char* dataPtr = data;
-  uint32_t start = millis();
-  while(millis() - start < _ATtimeout) {
-    while(ModuleSerial->available() > 0) {
-      char c = ModuleSerial->read();
-      RADIOLIB_VERBOSE_PRINT(c);
-      *dataPtr++ = c;
-    }
-
-    if(strstr(data, "OK") == 0) {
-      RADIOLIB_VERBOSE_PRINTLN();
-      return(true);
-    } else if(strstr(data, "ERROR") == 0) {
-      RADIOLIB_VERBOSE_PRINTLN();
-      return(false);
-    }
-
-  }
-  RADIOLIB_VERBOSE_PRINTLN();
-  return(false);
+  // blocking wrapper around AT engine, response is matched line by line as it arrives
+  // the engine stops reading at the terminator, so anything that follows (e.g. +IPD payload) is left for the caller
+  ATEngine engine(this);
+  engine.expect(_ATtimeout);
+  return(engine.waitForResponse() == ERR_NONE);
 }
 
 int16_t Module::SPIgetRegValue(uint8_t reg, uint8_t msb, uint8_t lsb) {
@@ -175,24 +167,76 @@ int16_t Module::SPIsetRegValue(uint8_t reg, uint8_t value, uint8_t msb, uint8_t
     return(ERR_INVALID_BIT_RANGE);
   }
 
-  uint8_t currentValue = SPIreadRegister(reg);
   uint8_t mask = ~((0b11111111 << (msb + 1)) | (0b11111111 >> (8 - lsb)));
+
+  // queue the write if there is an open batch
+  if((_regBatchDepth > 0) && !regIsVolatile(reg)) {
+    // merge with previously queued write to the same register
+    for(uint8_t i = 0; i < _regBatchLen; i++) {
+      if(_regBatch[i].reg == reg) {
+        _regBatch[i].value = (_regBatch[i].value & ~mask) | (value & mask);
+        _regBatch[i].mask |= mask;
+        return(ERR_NONE);
+      }
+    }
+
+    // flush the batch when full
+    if(_regBatchLen == RADIOLIB_REG_BATCH_SIZE) {
+      int16_t state = regBatchFlush(checkInterval);
+      RADIOLIB_ASSERT(state);
+    }
+
+    _regBatch[_regBatchLen].reg = reg;
+    _regBatch[_regBatchLen].value = value & mask;
+    _regBatch[_regBatchLen].mask = mask;
+    _regBatchLen++;
+    return(ERR_NONE);
+  }
+
+  // get the current value, from register cache if possible
+  uint8_t currentValue;
+  bool cached = regCacheRead(reg, &currentValue);
+  if(!cached) {
+    currentValue = SPIreadRegister(reg);
+  }
+
   uint8_t newValue = (currentValue & ~mask) | (value & mask);
+
+  // cached register already holds the new value, no need to write it
+  if(cached && (newValue == currentValue)) {
+    return(ERR_NONE);
+  }
+
   SPIwriteRegister(reg, newValue);
 
+  // check whether this write should be verified at all
+  if((_verifyPolicy == RADIOLIB_VERIFY_NEVER) || ((_verifyPolicy == RADIOLIB_VERIFY_SLOW_ONLY) && !regIsSlow(reg))) {
+    return(ERR_NONE);
+  }
+
   // check register value each millisecond until check interval is reached
   // some registers need a bit of time to process the change (e.g. SX127X_REG_OP_MODE)
-  unsigned long start = micros();
+  // verify-once policy reads the register exactly once
+  uint32_t interval = (_verifyPolicy == RADIOLIB_VERIFY_ONCE) ? 0 : (uint32_t)checkInterval * 1000;
+  uint32_t start = RADIOLIB_HAL::micros();
   uint8_t readValue = 0;
-  while(micros() - start < (checkInterval * 1000)) {
+  bool match = false;
+  do {
     readValue = SPIreadRegister(reg);
-    if(readValue == newValue) {
-      // check passed, we can stop the loop
-      return(ERR_NONE);
-    }
+    // check passed, we can stop the loop
+    match = (readValue == newValue);
+  } while(!match && (RADIOLIB_HAL::micros() - start < interval));
+
+  #ifdef RADIOLIB_STATS
+    _stats[_statsApi].verifyTime += RADIOLIB_HAL::micros() - start;
+  #endif
+
+  if(match) {
+    return(ERR_NONE);
   }
 
-  // check failed, print debug info
+  // check failed, count it and print debug info
+  _verifyFailures++;
   RADIOLIB_DEBUG_PRINTLN();
   RADIOLIB_DEBUG_PRINT(F("address:\t0x"));
   RADIOLIB_DEBUG_PRINTLN(reg, HEX);
@@ -217,31 +261,81 @@ int16_t Module::SPIsetRegValue(uint8_t reg, uint8_t value, uint8_t msb, uint8_t
 
 void Module::SPIreadRegisterBurst(uint8_t reg, uint8_t numBytes, uint8_t* inBytes) {
   SPItransfer(SPIreadCommand, reg, NULL, inBytes, numBytes);
+
+  // burst access to volatile register (e.g. FIFO) does not auto-increment the address
+  if(_regCacheEnabled && !regIsVolatile(reg)) {
+    for(uint8_t i = 0; i < numBytes; i++) {
+      regCacheWrite(reg + i, inBytes[i]);
+    }
+  }
 }
 
 uint8_t Module::SPIreadRegister(uint8_t reg) {
   uint8_t resp = 0;
   SPItransfer(SPIreadCommand, reg, NULL, &resp, 1);
+  regCacheWrite(reg, resp);
+
+  // reflect writes that are still queued in open batch
+  for(uint8_t i = 0; i < _regBatchLen; i++) {
+    if(_regBatch[i].reg == reg) {
+      resp = (resp & ~_regBatch[i].mask) | _regBatch[i].value;
+      break;
+    }
+  }
   return(resp);
 }
 
 void Module::SPIwriteRegisterBurst(uint8_t reg, uint8_t* data, uint8_t numBytes) {
   SPItransfer(SPIwriteCommand, reg, data, NULL, numBytes);
+
+  // burst access to volatile register (e.g. FIFO) does not auto-increment the address
+  if(_regCacheEnabled && !regIsVolatile(reg)) {
+    for(uint8_t i = 0; i < numBytes; i++) {
+      regCacheWrite(reg + i, data[i]);
+    }
+  }
 }
 
 void Module::SPIwriteRegister(uint8_t reg, uint8_t data) {
   SPItransfer(SPIwriteCommand, reg, &data, NULL, 1);
+  regCacheWrite(reg, data);
 }
 
 void Module::SPItransfer(uint8_t cmd, uint8_t reg, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes) {
+  // register address with access command, followed by data bytes
+  // the address byte is overwritten by the byte received in its place, so a copy is kept for the trace
+  uint8_t addr = reg | cmd;
+  uint8_t head = addr;
+
+  #ifdef RADIOLIB_SPI_TRACE
+    uint32_t traceTime = RADIOLIB_HAL::micros();
+  #endif
+
   // start SPI transaction
-  _spi->beginTransaction(_spiSettings);
+  SPIprepareTransaction();
+  SPIbeginTransaction();
 
   // pull CS low
-  Module::digitalWrite(_cs, LOW);
+  RADIOLIB_HAL::digitalWrite(_cs, LOW);
 
-  // send SPI register address with access command
-  _spi->transfer(reg | cmd);
+  // send the frame, short frames are sent at once
+  if(cmd == SPIwriteCommand) {
+    SPItransferFrame(&head, 1, dataOut, NULL, numBytes);
+  } else {
+    SPItransferFrame(&head, 1, NULL, dataIn, numBytes);
+  }
+
+  // release CS
+  RADIOLIB_HAL::digitalWrite(_cs, HIGH);
+
+  // end SPI transaction
+  SPIendTransaction();
+
+  #ifdef RADIOLIB_SPI_TRACE
+    SPItraceRecord(&addr, 1, cmd == SPIwriteCommand, cmd == SPIwriteCommand ? dataOut : dataIn, numBytes, head, traceTime);
+  #endif
+
+  // print debug output after the transaction, so that it does not affect SPI timing
   #ifdef RADIOLIB_VERBOSE
     if(cmd == SPIwriteCommand) {
       RADIOLIB_VERBOSE_PRINT('W');
@@ -251,62 +345,486 @@ void Module::SPItransfer(uint8_t cmd, uint8_t reg, uint8_t* dataOut, uint8_t* da
     RADIOLIB_VERBOSE_PRINT('\t')
     RADIOLIB_VERBOSE_PRINT(reg, HEX);
     RADIOLIB_VERBOSE_PRINT('\t');
-  #endif
-
-  // send data or get response
-  if(cmd == SPIwriteCommand) {
     for(size_t n = 0; n < numBytes; n++) {
-      _spi->transfer(dataOut[n]);
-      RADIOLIB_VERBOSE_PRINT(dataOut[n], HEX);
+      if(cmd == SPIwriteCommand) {
+        RADIOLIB_VERBOSE_PRINT(dataOut[n], HEX);
+      } else {
+        RADIOLIB_VERBOSE_PRINT(dataIn[n], HEX);
+      }
       RADIOLIB_VERBOSE_PRINT('\t');
     }
-  } else if (cmd == SPIreadCommand) {
-    for(size_t n = 0; n < numBytes; n++) {
-      dataIn[n] = _spi->transfer(0x00);
-      RADIOLIB_VERBOSE_PRINT(dataIn[n], HEX);
-      RADIOLIB_VERBOSE_PRINT('\t');
+    RADIOLIB_VERBOSE_PRINTLN();
+  #endif
+}
+
+void Module::SPItransferBuffer(uint8_t* buff, size_t len) {
+  RADIOLIB_HAL::spiTransfer(_spi, buff, len);
+
+  #ifdef RADIOLIB_STATS
+    _stats[_statsApi].spiTransactions++;
+    _stats[_statsApi].spiBytes += len;
+  #endif
+}
+
+void Module::SPItransferFrame(uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill) {
+  RADIOLIB_HAL::spiTransferFrame(_spi, head, headLen, dataOut, dataIn, len, fill);
+
+  #ifdef RADIOLIB_STATS
+    _stats[_statsApi].spiTransactions++;
+    _stats[_statsApi].spiBytes += headLen + len;
+  #endif
+}
+
+uint8_t Module::SPItransferFrameChecked(uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len)) {
+  uint8_t status = RADIOLIB_HAL::spiTransferFrameChecked(_spi, head, headLen, dataOut, len, check);
+
+  #ifdef RADIOLIB_STATS
+    _stats[_statsApi].spiTransactions++;
+    _stats[_statsApi].spiBytes += headLen + len;
+  #endif
+  return(status);
+}
+
+void Module::SPIprepareTransaction() {
+  if(_arbiter != NULL) {
+    _arbiter->prepareTransaction(this);
+  }
+}
+
+void Module::SPIbeginTransaction() {
+  if(_arbiter != NULL) {
+    _arbiter->beginTransaction(this);
+    return;
+  }
+  RADIOLIB_HAL::spiBeginTransaction(_spi, _spiSettings);
+}
+
+void Module::SPIendTransaction() {
+  if(_arbiter != NULL) {
+    _arbiter->endTransaction(this);
+    return;
+  }
+  RADIOLIB_HAL::spiEndTransaction(_spi);
+}
+
+#ifdef RADIOLIB_SPI_TRACE
+void Module::SPItraceRecord(const uint8_t* cmd, uint8_t cmdLen, bool write, const uint8_t* data, uint8_t dataLen, uint8_t status, uint32_t timestamp) {
+  // check there is enough space for the whole record, one byte is always left empty to tell full buffer from empty one
+  size_t head = _traceHead;
+  size_t used = (head + RADIOLIB_SPI_TRACE_SIZE - _traceTail) % RADIOLIB_SPI_TRACE_SIZE;
+  size_t recLen = 9 + cmdLen + dataLen;
+  if(recLen > RADIOLIB_SPI_TRACE_SIZE - 1 - used) {
+    _traceDropped++;
+    return;
+  }
+
+  // build the record header
+  uint8_t header[7] = { 0xA5, (uint8_t)(write ? 0x01 : 0x00),
+                        (uint8_t)timestamp, (uint8_t)(timestamp >> 8), (uint8_t)(timestamp >> 16), (uint8_t)(timestamp >> 24),
+                        cmdLen };
+
+  // copy everything to the ring buffer
+  for(uint8_t i = 0; i < sizeof(header); i++) {
+    _trace[head] = header[i];
+    head = (head + 1) % RADIOLIB_SPI_TRACE_SIZE;
+  }
+  for(uint8_t i = 0; i < cmdLen; i++) {
+    _trace[head] = cmd[i];
+    head = (head + 1) % RADIOLIB_SPI_TRACE_SIZE;
+  }
+  _trace[head] = status;
+  head = (head + 1) % RADIOLIB_SPI_TRACE_SIZE;
+  _trace[head] = dataLen;
+  head = (head + 1) % RADIOLIB_SPI_TRACE_SIZE;
+  for(uint8_t i = 0; i < dataLen; i++) {
+    _trace[head] = data[i];
+    head = (head + 1) % RADIOLIB_SPI_TRACE_SIZE;
+  }
+
+  // publish the record only once it is complete
+  _traceHead = head;
+}
+
+size_t Module::SPItraceRead(uint8_t* buff, size_t len) {
+  size_t tail = _traceTail;
+  size_t head = _traceHead;
+  size_t n = 0;
+  while((tail != head) && (n < len)) {
+    buff[n++] = _trace[tail];
+    tail = (tail + 1) % RADIOLIB_SPI_TRACE_SIZE;
+  }
+  _traceTail = tail;
+  return(n);
+}
+#endif
+
+void Module::SPIbeginBatch() {
+  _regBatchDepth++;
+}
+
+int16_t Module::SPIcommitBatch(uint8_t checkInterval) {
+  if(_regBatchDepth == 0) {
+    return(ERR_NONE);
+  }
+
+  // only the outermost batch actually writes anything
+  _regBatchDepth--;
+  if(_regBatchDepth > 0) {
+    return(ERR_NONE);
+  }
+
+  return(regBatchFlush(checkInterval));
+}
+
+int16_t Module::regBatchFlush(uint8_t checkInterval) {
+  // sort queued writes by register address
+  for(uint8_t i = 1; i < _regBatchLen; i++) {
+    RegBatchEntry_t entry = _regBatch[i];
+    uint8_t j = i;
+    while((j > 0) && (_regBatch[j - 1].reg > entry.reg)) {
+      _regBatch[j] = _regBatch[j - 1];
+      j--;
     }
+    _regBatch[j] = entry;
   }
-  RADIOLIB_VERBOSE_PRINTLN();
 
-  // release CS
-  Module::digitalWrite(_cs, HIGH);
+  // write runs of consecutive registers
+  uint8_t buff[RADIOLIB_REG_BATCH_SIZE];
+  uint8_t runStart = 0;
+  while(runStart < _regBatchLen) {
+    uint8_t runLen = regBatchRunLength(runStart);
+    RegBatchEntry_t* run = &_regBatch[runStart];
+
+    // partially written registers have to be merged with their current value
+    bool readNeeded = false;
+    for(uint8_t i = 0; i < runLen; i++) {
+      if(run[i].mask != 0xFF) {
+        uint8_t currentValue;
+        if(regCacheRead(run[i].reg, &currentValue)) {
+          run[i].value |= currentValue & ~run[i].mask;
+          run[i].mask = 0xFF;
+        } else {
+          readNeeded = true;
+        }
+      }
+    }
+    if(readNeeded) {
+      SPItransfer(SPIreadCommand, run[0].reg | SPIburstCommand, NULL, buff, runLen);
+      for(uint8_t i = 0; i < runLen; i++) {
+        run[i].value |= buff[i] & ~run[i].mask;
+      }
+    }
 
-  // end SPI transaction
-  _spi->endTransaction();
+    // write the whole run at once
+    for(uint8_t i = 0; i < runLen; i++) {
+      buff[i] = run[i].value;
+      regCacheWrite(run[i].reg, run[i].value);
+    }
+    SPItransfer(SPIwriteCommand, run[0].reg | SPIburstCommand, buff, NULL, runLen);
+
+    runStart += runLen;
+  }
+
+  // verify all runs in a single pass
+  int16_t state = ERR_NONE;
+  uint32_t start = RADIOLIB_HAL::micros();
+  runStart = 0;
+  while((_verifyPolicy != RADIOLIB_VERIFY_NEVER) && (runStart < _regBatchLen)) {
+    uint8_t runLen = regBatchRunLength(runStart);
+    RegBatchEntry_t* run = &_regBatch[runStart];
+
+    // with slow-only policy, skip runs that do not contain any slow register
+    bool verify = (_verifyPolicy != RADIOLIB_VERIFY_SLOW_ONLY);
+    for(uint8_t i = 0; i < runLen; i++) {
+      verify |= regIsSlow(run[i].reg);
+    }
+    if(!verify) {
+      runStart += runLen;
+      continue;
+    }
+
+    // some registers need a bit of time to process the change, keep checking until check interval is reached
+    bool match = false;
+    do {
+      SPItransfer(SPIreadCommand, run[0].reg | SPIburstCommand, NULL, buff, runLen);
+      match = true;
+      for(uint8_t i = 0; i < runLen; i++) {
+        if(buff[i] != run[i].value) {
+          match = false;
+          break;
+        }
+      }
+    } while(!match && (_verifyPolicy != RADIOLIB_VERIFY_ONCE) && (RADIOLIB_HAL::micros() - start < (checkInterval * 1000UL)));
+
+    if(!match) {
+      // check failed, count it and print debug info
+      _verifyFailures++;
+      RADIOLIB_DEBUG_PRINT(F("batch write failed, address:\t0x"));
+      RADIOLIB_DEBUG_PRINTLN(run[0].reg, HEX);
+      for(uint8_t i = 0; i < runLen; i++) {
+        regCacheWrite(run[i].reg, buff[i]);
+      }
+      state = ERR_SPI_WRITE_FAILED;
+    }
+
+    runStart += runLen;
+  }
+
+  #ifdef RADIOLIB_STATS
+    _stats[_statsApi].verifyTime += RADIOLIB_HAL::micros() - start;
+  #endif
+
+  _regBatchLen = 0;
+  return(state);
+}
+
+uint8_t Module::regBatchRunLength(uint8_t start) {
+  // find the end of run of consecutive registers in sorted batch
+  uint8_t len = 1;
+  while(SPIburstSupported && (start + len < _regBatchLen) &&
+        (_regBatch[start + len].reg == _regBatch[start].reg + len)) {
+    len++;
+  }
+  return(len);
+}
+
+int16_t Module::setRegisterCache(bool enable) {
+  if(enable == _regCacheEnabled) {
+    return(ERR_NONE);
+  }
+
+  #ifndef RADIOLIB_STATIC_ONLY
+    if(enable) {
+      // allocate cache and its validity bitmap
+      _regCache = new uint8_t[RADIOLIB_REG_CACHE_SIZE];
+      _regCacheValid = new uint8_t[RADIOLIB_REG_CACHE_SIZE / 8];
+      if(!_regCache || !_regCacheValid) {
+        delete[] _regCache;
+        delete[] _regCacheValid;
+        _regCache = NULL;
+        _regCacheValid = NULL;
+        return(ERR_MEMORY_ALLOCATION_FAILED);
+      }
+    } else {
+      delete[] _regCache;
+      delete[] _regCacheValid;
+      _regCache = NULL;
+      _regCacheValid = NULL;
+    }
+  #endif
+
+  // start with empty cache and fresh statistics
+  _regCacheEnabled = enable;
+  _regCacheHits = 0;
+  _regCacheMisses = 0;
+  clearRegisterCache();
+  return(ERR_NONE);
+}
+
+void Module::clearRegisterCache() {
+  if(!_regCacheEnabled) {
+    return;
+  }
+
+  memset(_regCacheValid, 0x00, RADIOLIB_REG_CACHE_SIZE / 8);
+}
+
+bool Module::regCacheRead(uint8_t reg, uint8_t* value) {
+  if(!_regCacheEnabled || (reg >= RADIOLIB_REG_CACHE_SIZE) || regIsVolatile(reg)) {
+    return(false);
+  }
+
+  if(!(_regCacheValid[reg / 8] & (1 << (reg % 8)))) {
+    _regCacheMisses++;
+    return(false);
+  }
+
+  _regCacheHits++;
+  *value = _regCache[reg];
+  return(true);
+}
+
+void Module::regCacheWrite(uint8_t reg, uint8_t value) {
+  if(!_regCacheEnabled || (reg >= RADIOLIB_REG_CACHE_SIZE) || regIsVolatile(reg)) {
+    return;
+  }
+
+  _regCache[reg] = value;
+  _regCacheValid[reg / 8] |= (1 << (reg % 8));
+}
+
+bool Module::regIsVolatile(uint8_t reg) {
+  return(regInList(SPIvolatileRegs, SPIvolatileRegsLen, reg));
+}
+
+bool Module::regIsSlow(uint8_t reg) {
+  return(regInList(SPIslowRegs, SPIslowRegsLen, reg));
+}
+
+bool Module::regInList(const uint8_t* list, uint8_t len, uint8_t reg) {
+  for(uint8_t i = 0; i < len; i++) {
+    if(pgm_read_byte(&list[i]) == reg) {
+      return(true);
+    }
+  }
+  return(false);
+}
+
+int16_t Module::setVerifyPolicy(uint8_t policy) {
+  if(policy > RADIOLIB_VERIFY_NEVER) {
+    return(ERR_INVALID_VERIFY_POLICY);
+  }
+
+  _verifyPolicy = policy;
+  return(ERR_NONE);
 }
 
 void Module::pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode) {
   if(pin != RADIOLIB_NC) {
-    ::pinMode(pin, mode);
+    RADIOLIB_HAL::pinMode(pin, mode);
   }
 }
 
 void Module::digitalWrite(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
   if(pin != RADIOLIB_NC) {
-    ::digitalWrite(pin, value);
+    RADIOLIB_HAL::digitalWrite(pin, value);
   }
 }
 
 RADIOLIB_PIN_STATUS Module::digitalRead(RADIOLIB_PIN_TYPE pin) {
   if(pin != RADIOLIB_NC) {
-    return(::digitalRead(pin));
+    return(RADIOLIB_HAL::digitalRead(pin));
   }
   return(LOW);
 }
 
+bool Module::waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout) {
+  if(pin != RADIOLIB_NC) {
+    return(RADIOLIB_HAL::waitForPin(pin, value, timeout));
+  }
+  return(true);
+}
+
+bool Module::waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout) {
+  // unused pin never reaches its value, so only the other one is waited for
+  if(pinA == RADIOLIB_NC) {
+    return(waitForPin(pinB, valueB, timeout));
+  } else if(pinB == RADIOLIB_NC) {
+    return(waitForPin(pinA, valueA, timeout));
+  }
+  return(RADIOLIB_HAL::waitForPins(pinA, valueA, pinB, valueB, timeout));
+}
+
+bool Module::waitForInterrupt(uint32_t timeout) {
+  return(RADIOLIB_HAL::waitForInterrupt(timeout));
+}
+
 void Module::tone(RADIOLIB_PIN_TYPE pin, uint16_t value) {
-  #ifndef RADIOLIB_TONE_UNSUPPORTED
   if(pin != RADIOLIB_NC) {
-    ::tone(pin, value);
+    RADIOLIB_HAL::tone(pin, value);
   }
-  #endif
 }
 
 void Module::noTone(RADIOLIB_PIN_TYPE pin) {
-  #ifndef RADIOLIB_TONE_UNSUPPORTED
   if(pin != RADIOLIB_NC) {
-    ::noTone(pin);
+    RADIOLIB_HAL::noTone(pin);
   }
+}
+
+void Module::attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode) {
+  if(pin == RADIOLIB_NC) {
+    return;
+  }
+
+  #ifdef RADIOLIB_STATS
+    // route the interrupt through a trampoline that timestamps it, if there is a free slot
+    static void (* const trampolines[RADIOLIB_STATS_IRQ_SLOTS])(void) = { statsIrq<0>, statsIrq<1>, statsIrq<2>, statsIrq<3> };
+    for(uint8_t i = 0; i < RADIOLIB_STATS_IRQ_SLOTS; i++) {
+      if((_statsIrqPin[i] == pin) || (_statsIrqPin[i] == RADIOLIB_NC)) {
+        _statsIrqPin[i] = pin;
+        _statsIrqFunc[i] = func;
+        _statsIrqPending[i] = false;
+        RADIOLIB_HAL::attachInterrupt(pin, trampolines[i], mode);
+        return;
+      }
+    }
   #endif
+
+  RADIOLIB_HAL::attachInterrupt(pin, func, mode);
 }
+
+void Module::detachInterrupt(RADIOLIB_PIN_TYPE pin) {
+  if(pin == RADIOLIB_NC) {
+    return;
+  }
+
+  RADIOLIB_HAL::detachInterrupt(pin);
+
+  #ifdef RADIOLIB_STATS
+    for(uint8_t i = 0; i < RADIOLIB_STATS_IRQ_SLOTS; i++) {
+      if(_statsIrqPin[i] == pin) {
+        _statsIrqPin[i] = RADIOLIB_NC;
+        _statsIrqFunc[i] = NULL;
+      }
+    }
+  #endif
+}
+
+#ifdef RADIOLIB_STATS
+RADIOLIB_PIN_TYPE Module::_statsIrqPin[RADIOLIB_STATS_IRQ_SLOTS] = { RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC };
+void (*Module::_statsIrqFunc[RADIOLIB_STATS_IRQ_SLOTS])(void) = { NULL, NULL, NULL, NULL };
+volatile uint32_t Module::_statsIrqTime[RADIOLIB_STATS_IRQ_SLOTS];
+volatile bool Module::_statsIrqPending[RADIOLIB_STATS_IRQ_SLOTS];
+
+template<uint8_t N> void Module::statsIrq() {
+  _statsIrqTime[N] = RADIOLIB_HAL::micros();
+  _statsIrqPending[N] = true;
+  if(_statsIrqFunc[N] != NULL) {
+    _statsIrqFunc[N]();
+  }
+}
+
+ModuleStats_t Module::getStats(uint8_t api) const {
+  if(api >= RADIOLIB_STATS_NUM_APIS) {
+    ModuleStats_t empty = {};
+    return(empty);
+  }
+  return(_stats[api]);
+}
+
+void Module::resetStats() {
+  memset(_stats, 0x00, sizeof(_stats));
+}
+
+bool Module::statsBegin(uint8_t api) {
+  // nested API calls (e.g. transmit calling startTransmit) are attributed to the outermost one
+  if((_statsApi != RADIOLIB_STATS_API_CONFIG) || (api >= RADIOLIB_STATS_NUM_APIS)) {
+    return(false);
+  }
+  _statsApi = api;
+  _stats[api].calls++;
+
+  // measure latency of the interrupt that caused this call
+  if(api == RADIOLIB_STATS_API_READ_DATA) {
+    uint32_t now = RADIOLIB_HAL::micros();
+    for(uint8_t i = 0; i < RADIOLIB_STATS_IRQ_SLOTS; i++) {
+      if(_statsIrqPending[i] && ((_statsIrqPin[i] == _irq) || (_statsIrqPin[i] == _rx))) {
+        _statsIrqPending[i] = false;
+        uint32_t latency = now - _statsIrqTime[i];
+        _stats[api].irqCount++;
+        _stats[api].irqLatencyTotal += latency;
+        if(latency > _stats[api].irqLatencyMax) {
+          _stats[api].irqLatencyMax = latency;
+        }
+      }
+    }
+  }
+
+  return(true);
+}
+
+void Module::statsEnd(uint32_t start) {
+  _stats[_statsApi].time += RADIOLIB_HAL::micros() - start;
+  _statsApi = RADIOLIB_STATS_API_CONFIG;
+}
+#endif
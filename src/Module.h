@@ -15,6 +15,103 @@
 #include <SoftwareSerial.h>
 #endif
 
+// hardware abstraction layer
+#ifndef RADIOLIB_HAL
+#include "ArduinoHal.h"
+#define RADIOLIB_HAL ArduinoHal
+#else
+#include RADIOLIB_HAL_HEADER
+#endif
+
+#include "SPIArbiter.h"
+
+// register cache covers register addresses 0x00 - 0x7F
+#define RADIOLIB_REG_CACHE_SIZE                       128
+
+// maximum number of register writes that can be queued in a single batch
+#define RADIOLIB_REG_BATCH_SIZE                       16
+
+// register write verification policies
+#define RADIOLIB_VERIFY_ALWAYS                        0x00        // re-read register until it holds the new value or check interval elapses
+#define RADIOLIB_VERIFY_ONCE                          0x01        // re-read register only once, right after the write
+#define RADIOLIB_VERIFY_SLOW_ONLY                     0x02        // verify only registers listed in SPIslowRegs, other writes are not verified
+#define RADIOLIB_VERIFY_NEVER                         0x03        // never verify register writes
+
+// verification policy every module starts with, can be overridden before including RadioLib
+#ifndef RADIOLIB_VERIFY_POLICY_DEFAULT
+#define RADIOLIB_VERIFY_POLICY_DEFAULT                RADIOLIB_VERIFY_ALWAYS
+#endif
+
+// timeout in milliseconds of a single Module::waitForPin(s) call when waiting without time limit, e.g. for a pin that signals the timeout itself
+#define RADIOLIB_WAIT_SLICE                           1000
+
+// API methods that instrumentation counters are attributed to
+#define RADIOLIB_STATS_API_CONFIG                     0           // anything called outside of the methods below, e.g. setters
+#define RADIOLIB_STATS_API_BEGIN                      1
+#define RADIOLIB_STATS_API_TRANSMIT                   2
+#define RADIOLIB_STATS_API_RECEIVE                    3
+#define RADIOLIB_STATS_API_START_TRANSMIT             4
+#define RADIOLIB_STATS_API_START_RECEIVE              5
+#define RADIOLIB_STATS_API_READ_DATA                  6
+#define RADIOLIB_STATS_API_STANDBY                    7
+#define RADIOLIB_STATS_API_SCAN_CHANNEL               8
+#define RADIOLIB_STATS_NUM_APIS                       9
+
+// number of interrupt pins that can be timestamped for interrupt latency measurement
+#define RADIOLIB_STATS_IRQ_SLOTS                      4
+
+/*!
+  \struct ModuleStats_t
+
+  \brief Instrumentation counters of a single API method, see RADIOLIB_STATS.
+*/
+struct ModuleStats_t {
+
+  /*!
+    \brief Number of calls.
+  */
+  uint32_t calls;
+
+  /*!
+    \brief Total time spent in the method in us.
+  */
+  uint32_t time;
+
+  /*!
+    \brief Number of SPI transactions.
+  */
+  uint32_t spiTransactions;
+
+  /*!
+    \brief Number of bytes transferred over SPI, including command and address bytes.
+  */
+  uint32_t spiBytes;
+
+  /*!
+    \brief Total time spent waiting for BUSY pin in us (SX126x and SX128x only).
+  */
+  uint32_t busyWaitTime;
+
+  /*!
+    \brief Total time spent verifying register writes in us.
+  */
+  uint32_t verifyTime;
+
+  /*!
+    \brief Number of interrupts that were followed by a call to this method.
+  */
+  uint32_t irqCount;
+
+  /*!
+    \brief Total time between interrupt and the start of this method in us.
+  */
+  uint32_t irqLatencyTotal;
+
+  /*!
+    \brief Longest time between interrupt and the start of this method in us.
+  */
+  uint32_t irqLatencyMax;
+};
 
 /*!
   \class Module
@@ -123,6 +220,15 @@ class Module {
     Module(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE rx, RADIOLIB_PIN_TYPE tx, SPIClass& spi = SPI, SPISettings spiSettings = SPISettings(2000000, MSBFIRST, SPI_MODE0), HardwareSerial* serial = nullptr);
 #endif
 
+    /*!
+      \brief Default destructor, frees register cache.
+    */
+    ~Module();
+
+    // drivers keep pointers to their module and the module owns its register cache, so it cannot be copied
+    Module(const Module&) = delete;
+    Module& operator=(const Module&) = delete;
+
 
     // public member variables
 
@@ -155,6 +261,37 @@ class Module {
     */
     uint8_t SPIwriteCommand = 0b10000000;
 
+    /*!
+      \brief Array of register addresses that must never be served from register cache (e.g. IRQ flags, FIFO or RSSI). Stored in program memory and set by the module driver.
+    */
+    const uint8_t* SPIvolatileRegs = NULL;
+
+    /*!
+      \brief Number of register addresses in SPIvolatileRegs array.
+    */
+    uint8_t SPIvolatileRegsLen = 0;
+
+    /*!
+      \brief Whether the module supports access to consecutive registers within a single SPI transaction. Defaults to true.
+    */
+    bool SPIburstSupported = true;
+
+    /*!
+      \brief Bits that need to be set in register address to access consecutive registers within a single SPI transaction. Defaults to 0x00.
+    */
+    uint8_t SPIburstCommand = 0b00000000;
+
+    /*!
+      \brief Array of register addresses that need some time to process the change after being written (e.g. operation mode). Stored in program memory and set by the module driver.
+      Only these registers are verified when verification policy is set to RADIOLIB_VERIFY_SLOW_ONLY.
+    */
+    const uint8_t* SPIslowRegs = NULL;
+
+    /*!
+      \brief Number of register addresses in SPIslowRegs array.
+    */
+    uint8_t SPIslowRegsLen = 0;
+
     // basic methods
 
     /*!
@@ -177,9 +314,9 @@ class Module {
     void ATemptyBuffer();
 
     /*!
-      \brief Get response after sending AT command.
+      \brief Get response after sending AT command. Blocks until a terminator line (e.g. "OK" or "ERROR") is received or until timeout, see ATEngine for non-blocking alternative.
 
-      \returns True if AT response contains the string "OK", false otherwise.
+      \returns True if AT response was terminated by "OK", false otherwise.
     */
     bool ATgetResponse();
 
@@ -188,7 +325,7 @@ class Module {
 
       \param cmd AT command to be sent. Line feed characters are added automatically.
 
-      \returns True if AT response contains the string "OK", false otherwise.
+      \returns True if AT response was terminated by "OK", false otherwise.
     */
     bool ATsendCommand(const char* cmd);
 
@@ -199,7 +336,7 @@ class Module {
 
       \param len Number of bytes to send.
 
-      \returns True if AT response contains the string "OK", false otherwise.
+      \returns True if AT response was terminated by "OK", false otherwise.
     */
     bool ATsendData(uint8_t* data, uint32_t len);
 
@@ -288,7 +425,239 @@ class Module {
 
       \param numBytes Number of bytes to transfer.
     */
-    virtual void SPItransfer(uint8_t cmd, uint8_t reg, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes);
+    void SPItransfer(uint8_t cmd, uint8_t reg, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes);
+
+    /*!
+      \brief SPI block transfer method. Hands the whole buffer to the SPI interface in a single call, instead of transferring it byte-by-byte.
+      Bytes clocked in from the module overwrite the buffer contents. Must be called within an active SPI transaction, with chip select already pulled low.
+
+      \param buff Pointer to buffer that holds the outgoing frame (command and data bytes). Will be overwritten by the incoming frame.
+
+      \param len Number of bytes to transfer.
+    */
+    void SPItransferBuffer(uint8_t* buff, size_t len);
+
+    /*!
+      \brief SPI frame transfer method. Transfers header (command and/or address bytes) followed by data as a single frame, see spiTransferFrame in ArduinoHal.
+      Unlike SPItransferBuffer, the frame does not have to be assembled in one buffer, so stack usage does not depend on data length.
+      Must be called within an active SPI transaction, with chip select already pulled low.
+
+      \param head Header bytes, at most RADIOLIB_SPI_HEADER_SIZE. Will be overwritten by the bytes received in their place (e.g. status).
+
+      \param headLen Number of header bytes.
+
+      \param dataOut Data to send after the header, or NULL to send fill bytes.
+
+      \param dataIn Buffer to save the incoming data to, or NULL to discard them.
+
+      \param len Number of data bytes.
+
+      \param fill Byte to send when dataOut is NULL.
+    */
+    void SPItransferFrame(uint8_t* head, size_t headLen, const uint8_t* dataOut, uint8_t* dataIn, size_t len, uint8_t fill = 0x00);
+
+    /*!
+      \brief SPI frame transfer method for frames whose incoming data only have to be checked, e.g. status clocked out during long writes.
+      Incoming data are passed to the check function in blocks of up to RADIOLIB_SPI_BUFFER_SIZE bytes, so they do not have to be stored.
+      Must be called within an active SPI transaction, with chip select already pulled low.
+
+      \param head Header bytes, at most RADIOLIB_SPI_HEADER_SIZE. Will be overwritten by the bytes received in their place (e.g. status).
+
+      \param headLen Number of header bytes.
+
+      \param dataOut Data to send after the header.
+
+      \param len Number of data bytes.
+
+      \param check Function called with each block of incoming data, returns non-zero on error. It is not called again after it reported an error.
+
+      \returns First non-zero value returned by check, 0 if all blocks passed.
+    */
+    uint8_t SPItransferFrameChecked(uint8_t* head, size_t headLen, const uint8_t* dataOut, size_t len, uint8_t (*check)(const uint8_t* in, size_t len));
+
+    /*!
+      \brief Prepares SPI transaction. When the module was added to SPIArbiter, pending jobs of other modules are run.
+      Must be called before chip select is pulled low, drivers that control chip select themselves call it before SPIbeginTransaction.
+    */
+    void SPIprepareTransaction();
+
+    /*!
+      \brief Starts SPI transaction using the interface and settings configured in the constructor.
+      When the module was added to SPIArbiter, the transaction is started through it.
+    */
+    void SPIbeginTransaction();
+
+    /*!
+      \brief Ends SPI transaction.
+    */
+    void SPIendTransaction();
+
+    /*!
+      \brief Gets the bus arbiter the module was added to.
+
+      \returns Pointer to the arbiter, or NULL if the module accesses the bus directly.
+    */
+    SPIArbiter* getSPIArbiter() const { return(_arbiter); }
+
+    // register cache methods
+
+    /*!
+      \brief Enables or disables register cache. When enabled, SPIsetRegValue will take the current register value from the cache instead of reading it over SPI,
+      and will skip the write altogether if the register already holds the new value. Registers listed in SPIvolatileRegs always bypass the cache.
+      Disabled by default.
+
+      \param enable Set to true to enable register cache, false to disable it.
+
+      \returns \ref status_codes
+    */
+    int16_t setRegisterCache(bool enable);
+
+    /*!
+      \brief Invalidates all register cache entries. Called by module drivers whenever register contents change outside of SPI writes (e.g. after reset).
+    */
+    void clearRegisterCache();
+
+    /*!
+      \brief Gets the number of SPIsetRegValue calls that were served from register cache since it was enabled.
+
+      \returns Number of register cache hits.
+    */
+    uint32_t getRegisterCacheHits() const { return(_regCacheHits); }
+
+    /*!
+      \brief Gets the number of SPIsetRegValue calls that had to read the register over SPI since register cache was enabled.
+
+      \returns Number of register cache misses.
+    */
+    uint32_t getRegisterCacheMisses() const { return(_regCacheMisses); }
+
+    // register batch methods
+
+    /*!
+      \brief Starts a batch of register writes. Until SPIcommitBatch is called, SPIsetRegValue will only queue the write, which will be performed during commit.
+      Registers listed in SPIvolatileRegs are always written immediately. Batches can be nested, writes are performed when the outermost batch is committed.
+    */
+    void SPIbeginBatch();
+
+    /*!
+      \brief Commits a batch of register writes. Queued writes to the same register are merged, the rest is sorted by address and runs of consecutive registers
+      are written in a single SPI transaction. All writes are verified in a single pass at the end.
+
+      \param checkInterval Number of milliseconds between register writing and verification reading.
+
+      \returns \ref status_codes
+    */
+    int16_t SPIcommitBatch(uint8_t checkInterval = 2);
+
+    // register write verification methods
+
+    /*!
+      \brief Sets how SPIsetRegValue and SPIcommitBatch verify register writes. Verification is useful during bring-up,
+      but adds at least one SPI transaction to every register write. Defaults to RADIOLIB_VERIFY_POLICY_DEFAULT.
+
+      \param policy Verification policy, one of RADIOLIB_VERIFY_ALWAYS, RADIOLIB_VERIFY_ONCE, RADIOLIB_VERIFY_SLOW_ONLY or RADIOLIB_VERIFY_NEVER.
+
+      \returns \ref status_codes
+    */
+    int16_t setVerifyPolicy(uint8_t policy);
+
+    /*!
+      \brief Gets the number of register writes that failed verification since the last call to resetVerifyFailures.
+
+      \returns Number of failed register write verifications.
+    */
+    uint32_t getVerifyFailures() const { return(_verifyFailures); }
+
+    /*!
+      \brief Resets failed register write verification counter.
+    */
+    void resetVerifyFailures() { _verifyFailures = 0; }
+
+    #ifdef RADIOLIB_SPI_TRACE
+    // SPI trace methods
+
+    /*!
+      \brief Records a single SPI transaction into trace ring buffer. Called by Module and by module drivers with their own SPI framing.
+      If there is not enough space for the whole record, it is dropped.
+      Record format: sync byte (0xA5), flags (bit 0 set for write), timestamp in microseconds (4 bytes, little endian),
+      number of command bytes, command bytes, status, number of data bytes, data bytes.
+
+      \param cmd Command (or register address) bytes.
+
+      \param cmdLen Number of command bytes.
+
+      \param write Whether the transaction was a write.
+
+      \param data Data bytes that were sent (write) or received (read).
+
+      \param dataLen Number of data bytes.
+
+      \param status Transaction status reported by the module, 0 if the module does not report status.
+
+      \param timestamp Time the transaction was started at in microseconds, taken before chip select was pulled low
+      (after waiting for BUSY on modules that have it), so that the trace can be replayed with the original timing.
+    */
+    void SPItraceRecord(const uint8_t* cmd, uint8_t cmdLen, bool write, const uint8_t* data, uint8_t dataLen, uint8_t status, uint32_t timestamp);
+
+    /*!
+      \brief Reads raw bytes from trace ring buffer, e.g. to dump them to serial port or SD card. Safe to call while transactions are recorded.
+
+      \param buff Buffer to copy the trace bytes to.
+
+      \param len Maximum number of bytes to read.
+
+      \returns Number of bytes that were read.
+    */
+    size_t SPItraceRead(uint8_t* buff, size_t len);
+
+    /*!
+      \brief Gets the number of records that were dropped because the trace ring buffer was full.
+
+      \returns Number of dropped records.
+    */
+    uint32_t getSPItraceDropped() const { return(_traceDropped); }
+    #endif
+
+    #ifdef RADIOLIB_STATS
+    // instrumentation methods
+
+    /*!
+      \brief Gets a snapshot of instrumentation counters.
+
+      \param api API method to get the counters for, one of RADIOLIB_STATS_API_* macros.
+
+      \returns Counters attributed to the API method.
+    */
+    ModuleStats_t getStats(uint8_t api) const;
+
+    /*!
+      \brief Resets all instrumentation counters.
+    */
+    void resetStats();
+
+    /*!
+      \brief Marks start of public API method, called through RADIOLIB_STATS_SCOPE. Only the outermost method is counted.
+
+      \param api API method, one of RADIOLIB_STATS_API_* macros.
+
+      \returns True if this is the outermost API method, false otherwise.
+    */
+    bool statsBegin(uint8_t api);
+
+    /*!
+      \brief Marks end of public API method, called through RADIOLIB_STATS_SCOPE.
+
+      \param start Timestamp of the start of the method in us.
+    */
+    void statsEnd(uint32_t start);
+
+    /*!
+      \brief Adds time spent waiting for BUSY pin to the current API method.
+
+      \param time Time spent waiting in us.
+    */
+    void statsAddBusyWait(uint32_t time) { _stats[_statsApi].busyWaitTime += time; }
+    #endif
 
     // pin number access methods
 
@@ -375,6 +744,48 @@ class Module {
     */
     static RADIOLIB_PIN_STATUS digitalRead(RADIOLIB_PIN_TYPE pin);
 
+    /*!
+      \brief Waits until pin reaches the requested value, checks RADIOLIB_NC as alias for unused pin.
+      Depending on hardware abstraction layer, this may either poll the pin or block on pin change event.
+
+      \param pin Pin to wait for.
+
+      \param value Value to wait for.
+
+      \param timeout Timeout in milliseconds.
+
+      \returns True if the pin reached the requested value (or is unused), false on timeout.
+    */
+    static bool waitForPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value, uint32_t timeout);
+
+    /*!
+      \brief Waits until either of two pins reaches its requested value. Unused pin (RADIOLIB_NC) is ignored,
+      so that e.g. optional timeout pin of the module does not end the wait. If both pins are unused, returns immediately.
+
+      \param pinA First pin to wait for.
+
+      \param valueA Value to wait for on the first pin.
+
+      \param pinB Second pin to wait for.
+
+      \param valueB Value to wait for on the second pin.
+
+      \param timeout Timeout in milliseconds.
+
+      \returns True if at least one of the pins reached its requested value (or both are unused), false on timeout.
+    */
+    static bool waitForPins(RADIOLIB_PIN_TYPE pinA, RADIOLIB_PIN_STATUS valueA, RADIOLIB_PIN_TYPE pinB, RADIOLIB_PIN_STATUS valueB, uint32_t timeout);
+
+    /*!
+      \brief Waits until an attached interrupt service routine has been called. Depending on hardware abstraction layer,
+      this may block on pin change events (LinuxHal, EmulatorHal), or return immediately when interrupts run asynchronously (Arduino).
+
+      \param timeout Timeout in milliseconds.
+
+      \returns True if an interrupt service routine was called.
+    */
+    static bool waitForInterrupt(uint32_t timeout);
+
     /*!
       \brief Arduino core tone override that checks RADIOLIB_NC as alias for unused pin and RADIOLIB_TONE_UNSUPPORTED to make sure the platform does support tone.
 
@@ -391,6 +802,62 @@ class Module {
     */
     static void noTone(RADIOLIB_PIN_TYPE pin);
 
+    /*!
+      \brief Arduino core attachInterrupt override that checks RADIOLIB_NC as alias for unused pin.
+
+      \param pin Pin to attach the interrupt to.
+
+      \param func Interrupt service routine.
+
+      \param mode Pin change that triggers the interrupt.
+    */
+    static void attachInterrupt(RADIOLIB_PIN_TYPE pin, void (*func)(void), RADIOLIB_INTERRUPT_STATUS mode);
+
+    /*!
+      \brief Arduino core detachInterrupt override that checks RADIOLIB_NC as alias for unused pin.
+
+      \param pin Pin to detach the interrupt from.
+    */
+    static void detachInterrupt(RADIOLIB_PIN_TYPE pin);
+
+    /*!
+      \brief Arduino core millis override, forwarded to hardware abstraction layer.
+
+      \returns Milliseconds since start.
+    */
+    static uint32_t millis() { return(RADIOLIB_HAL::millis()); }
+
+    /*!
+      \brief Arduino core micros override, forwarded to hardware abstraction layer.
+
+      \returns Microseconds since start.
+    */
+    static uint32_t micros() { return(RADIOLIB_HAL::micros()); }
+
+    /*!
+      \brief Arduino core delay override, forwarded to hardware abstraction layer.
+
+      \param ms Number of milliseconds to wait.
+    */
+    static void delay(uint32_t ms) { RADIOLIB_HAL::delay(ms); }
+
+    /*!
+      \brief Arduino core delayMicroseconds override, forwarded to hardware abstraction layer.
+
+      \param us Number of microseconds to wait.
+    */
+    static void delayMicroseconds(uint32_t us) { RADIOLIB_HAL::delayMicroseconds(us); }
+
+    /*!
+      \brief Arduino core noInterrupts override, forwarded to hardware abstraction layer.
+    */
+    static void disableInterrupts() { RADIOLIB_HAL::disableInterrupts(); }
+
+    /*!
+      \brief Arduino core interrupts override, forwarded to hardware abstraction layer.
+    */
+    static void enableInterrupts() { RADIOLIB_HAL::enableInterrupts(); }
+
 #ifndef RADIOLIB_GODMODE
   private:
 #endif
@@ -404,7 +871,93 @@ class Module {
     SPIClass* _spi;
     SPISettings _spiSettings;
 
+    friend class SPIArbiter;
+    SPIArbiter* _arbiter = NULL;
+
     uint32_t _ATtimeout = 15000;
+
+    bool _regCacheEnabled = false;
+    #ifdef RADIOLIB_STATIC_ONLY
+      uint8_t _regCache[RADIOLIB_REG_CACHE_SIZE];
+      uint8_t _regCacheValid[RADIOLIB_REG_CACHE_SIZE / 8];
+    #else
+      uint8_t* _regCache = NULL;
+      uint8_t* _regCacheValid = NULL;
+    #endif
+    uint32_t _regCacheHits = 0;
+    uint32_t _regCacheMisses = 0;
+
+    struct RegBatchEntry_t {
+      uint8_t reg;
+      uint8_t value;
+      uint8_t mask;
+    };
+    uint8_t _verifyPolicy = RADIOLIB_VERIFY_POLICY_DEFAULT;
+    uint32_t _verifyFailures = 0;
+
+    RegBatchEntry_t _regBatch[RADIOLIB_REG_BATCH_SIZE];
+    uint8_t _regBatchLen = 0;
+    uint8_t _regBatchDepth = 0;
+
+    int16_t regBatchFlush(uint8_t checkInterval);
+    uint8_t regBatchRunLength(uint8_t start);
+
+    #ifdef RADIOLIB_STATS
+      ModuleStats_t _stats[RADIOLIB_STATS_NUM_APIS] = {};
+      uint8_t _statsApi = RADIOLIB_STATS_API_CONFIG;
+
+      // interrupt timestamps are shared by all modules, each slot has its own interrupt trampoline
+      static RADIOLIB_PIN_TYPE _statsIrqPin[RADIOLIB_STATS_IRQ_SLOTS];
+      static void (*_statsIrqFunc[RADIOLIB_STATS_IRQ_SLOTS])(void);
+      static volatile uint32_t _statsIrqTime[RADIOLIB_STATS_IRQ_SLOTS];
+      static volatile bool _statsIrqPending[RADIOLIB_STATS_IRQ_SLOTS];
+      template<uint8_t N> static void statsIrq();
+    #endif
+
+    #ifdef RADIOLIB_SPI_TRACE
+      // single producer, single consumer ring buffer - head is only written by SPItraceRecord, tail only by SPItraceRead
+      uint8_t _trace[RADIOLIB_SPI_TRACE_SIZE];
+      volatile size_t _traceHead = 0;
+      volatile size_t _traceTail = 0;
+      uint32_t _traceDropped = 0;
+    #endif
+
+    bool regCacheRead(uint8_t reg, uint8_t* value);
+    void regCacheWrite(uint8_t reg, uint8_t value);
+    bool regIsVolatile(uint8_t reg);
+    bool regIsSlow(uint8_t reg);
+    bool regInList(const uint8_t* list, uint8_t len, uint8_t reg);
+};
+
+#ifdef RADIOLIB_STATS
+/*!
+  \class ModuleStatsScope
+
+  \brief Attributes instrumentation counters to a public API method for as long as it is in scope. Use through RADIOLIB_STATS_SCOPE macro.
+*/
+class ModuleStatsScope {
+  public:
+    ModuleStatsScope(Module* mod, uint8_t api) {
+      _mod = mod;
+      _start = RADIOLIB_HAL::micros();
+      _outer = _mod->statsBegin(api);
+    }
+
+    ~ModuleStatsScope() {
+      if(_outer) {
+        _mod->statsEnd(_start);
+      }
+    }
+
+  private:
+    Module* _mod;
+    uint32_t _start;
+    bool _outer;
 };
 
+#define RADIOLIB_STATS_SCOPE(MOD, API) ModuleStatsScope _statsScope(MOD, API)
+#else
+#define RADIOLIB_STATS_SCOPE(MOD, API)
+#endif
+
 #endif
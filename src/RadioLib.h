@@ -42,6 +42,9 @@
 
 #include "TypeDef.h"
 #include "Module.h"
+#include "ATEngine.h"
+#include "SPIArbiter.h"
+#include "BufferPool.h"
 
 // warnings are printed in this file since BuildOpt.h is compiled in multiple places
 
@@ -61,11 +64,14 @@
 #endif
 
 #include "modules/CC1101/CC1101.h"
+#include "modules/CC1101/CC1101Emulator.h"
 #include "modules/ESP8266/ESP8266.h"
 #include "modules/HC05/HC05.h"
 #include "modules/JDY08/JDY08.h"
 #include "modules/nRF24/nRF24.h"
+#include "modules/nRF24/nRF24Emulator.h"
 #include "modules/RF69/RF69.h"
+#include "modules/RF69/RF69Emulator.h"
 #include "modules/RFM2x/RFM22.h"
 #include "modules/RFM2x/RFM23.h"
 #include "modules/RFM9x/RFM95.h"
@@ -74,23 +80,30 @@
 #include "modules/Si443x/Si4430.h"
 #include "modules/Si443x/Si4431.h"
 #include "modules/Si443x/Si4432.h"
+#include "modules/Si443x/Si443xEmulator.h"
 #include "modules/SX1231/SX1231.h"
 #include "modules/SX126x/SX1261.h"
 #include "modules/SX126x/SX1262.h"
 #include "modules/SX126x/SX1268.h"
+#include "modules/SX126x/SX126xEmulator.h"
 #include "modules/SX127x/SX1272.h"
 #include "modules/SX127x/SX1273.h"
 #include "modules/SX127x/SX1276.h"
 #include "modules/SX127x/SX1277.h"
 #include "modules/SX127x/SX1278.h"
 #include "modules/SX127x/SX1279.h"
+#include "modules/SX127x/SX127xEmulator.h"
 #include "modules/SX128x/SX1280.h"
 #include "modules/SX128x/SX1281.h"
 #include "modules/SX128x/SX1282.h"
+#include "modules/SX128x/SX128xEmulator.h"
 #include "modules/XBee/XBee.h"
 
 // physical layer protocols
 #include "protocols/PhysicalLayer/PhysicalLayer.h"
+#include "protocols/PhysicalLayer/RadioExecutor.h"
+#include "protocols/PhysicalLayer/RadioManager.h"
+#include "protocols/PhysicalLayer/PacketRing.h"
 #include "protocols/AFSK/AFSK.h"
 #include "protocols/AX25/AX25.h"
 #include "protocols/Hellschreiber/Hellschreiber.h"
@@ -0,0 +1,204 @@
+#include "SPIArbiter.h"
+#include "Module.h"
+
+SPIArbiter::SPIArbiter() {
+  for(uint8_t i = 0; i < RADIOLIB_SPI_ARBITER_QUEUE_SIZE; i++) {
+    _jobs[i].ready = false;
+  }
+}
+
+SPIArbiter::~SPIArbiter() {
+  releaseBus();
+  for(uint8_t i = 0; i < _numDevices; i++) {
+    _devices[i].mod->_arbiter = NULL;
+  }
+}
+
+int16_t SPIArbiter::addDevice(Module* mod, uint8_t priority) {
+  if(findDevice(mod) != NULL) {
+    return(ERR_NONE);
+  }
+  if(_numDevices == RADIOLIB_SPI_ARBITER_MAX_DEVICES) {
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
+
+  Device_t* dev = &_devices[_numDevices++];
+  dev->mod = mod;
+  dev->priority = priority;
+  memset(&dev->stats, 0, sizeof(SPIArbiterStats_t));
+  mod->_arbiter = this;
+  return(ERR_NONE);
+}
+
+void SPIArbiter::removeDevice(Module* mod) {
+  Device_t* dev = findDevice(mod);
+  if(dev == NULL) {
+    return;
+  }
+
+  if(_open == mod) {
+    releaseBus();
+  }
+  if(_last == mod) {
+    _last = NULL;
+  }
+  mod->_arbiter = NULL;
+
+  // keep the device table contiguous
+  *dev = _devices[--_numDevices];
+}
+
+int16_t SPIArbiter::post(Module* mod, void (*func)(void*), void* ctx, uint8_t priority) {
+  uint32_t timestamp = Module::micros();
+
+  // claim the slot with interrupts disabled, so that it cannot be claimed by another interrupt service routine at the same time
+  Module::disableInterrupts();
+  for(uint8_t i = 0; i < RADIOLIB_SPI_ARBITER_QUEUE_SIZE; i++) {
+    Job_t* job = &_jobs[i];
+    if(job->ready) {
+      continue;
+    }
+
+    job->mod = mod;
+    job->func = func;
+    job->ctx = ctx;
+    job->priority = priority;
+    job->timestamp = timestamp;
+    job->ready = true;
+    Module::enableInterrupts();
+    return(ERR_NONE);
+  }
+
+  _jobOverflows = _jobOverflows + 1;
+  Module::enableInterrupts();
+  return(ERR_QUEUE_FULL);
+}
+
+size_t SPIArbiter::service() {
+  // no driver method is running, so every module is at the end of its transaction sequence
+  if((_owner != NULL) || _inJob) {
+    return(0);
+  }
+  return(runJobs(NULL, -1));
+}
+
+void SPIArbiter::setKeepOpen(bool keepOpen) {
+  _keepOpen = keepOpen;
+  if(!_keepOpen && (_owner == NULL)) {
+    releaseBus();
+  }
+}
+
+void SPIArbiter::releaseBus() {
+  if(_open != NULL) {
+    RADIOLIB_HAL::spiEndTransaction(_open->_spi);
+    _open = NULL;
+  }
+}
+
+SPIArbiterStats_t SPIArbiter::getStats(Module* mod) {
+  SPIArbiterStats_t stats;
+  memset(&stats, 0, sizeof(SPIArbiterStats_t));
+  Device_t* dev = findDevice(mod);
+  if(dev != NULL) {
+    stats = dev->stats;
+  }
+  return(stats);
+}
+
+void SPIArbiter::resetStats() {
+  for(uint8_t i = 0; i < _numDevices; i++) {
+    memset(&_devices[i].stats, 0, sizeof(SPIArbiterStats_t));
+  }
+}
+
+uint32_t SPIArbiter::getJobOverflows() {
+  return(_jobOverflows);
+}
+
+void SPIArbiter::prepareTransaction(Module* mod) {
+  Device_t* dev = findDevice(mod);
+
+  // run jobs of other modules that are more urgent than the next transaction, chip select of this module is still high
+  if(!_inJob && (runJobs(mod, dev->priority) > 0)) {
+    dev->stats.preempted++;
+  }
+}
+
+void SPIArbiter::beginTransaction(Module* mod) {
+  Device_t* dev = findDevice(mod);
+
+  // transaction left open by the same module is reused
+  if(_open != mod) {
+    releaseBus();
+    RADIOLIB_HAL::spiBeginTransaction(mod->_spi, mod->_spiSettings);
+    _open = mod;
+  }
+  if(_last != mod) {
+    _last = mod;
+    dev->stats.settingsChanges++;
+  }
+
+  _owner = mod;
+  _start = Module::micros();
+}
+
+void SPIArbiter::endTransaction(Module* mod) {
+  Device_t* dev = findDevice(mod);
+  dev->stats.transactions++;
+  dev->stats.busTime += Module::micros() - _start;
+  _owner = NULL;
+
+  // unless enabled by setKeepOpen, the transaction is closed, so that the bus can be used by other devices
+  if(!_keepOpen) {
+    releaseBus();
+  }
+}
+
+SPIArbiter::Device_t* SPIArbiter::findDevice(Module* mod) {
+  for(uint8_t i = 0; i < _numDevices; i++) {
+    if(_devices[i].mod == mod) {
+      return(&_devices[i]);
+    }
+  }
+  return(NULL);
+}
+
+size_t SPIArbiter::runJobs(Module* current, int16_t priority) {
+  size_t num = 0;
+  _inJob = true;
+  while(true) {
+    // pick the most urgent job, oldest first within the same priority
+    Job_t* next = NULL;
+    for(uint8_t i = 0; i < RADIOLIB_SPI_ARBITER_QUEUE_SIZE; i++) {
+      Job_t* job = &_jobs[i];
+      if(!job->ready || (job->mod == current) || ((int16_t)job->priority <= priority)) {
+        continue;
+      }
+      if((next == NULL) || (job->priority > next->priority) || ((job->priority == next->priority) && ((int32_t)(job->timestamp - next->timestamp) < 0))) {
+        next = job;
+      }
+    }
+    if(next == NULL) {
+      break;
+    }
+
+    // copy the job and release the slot before running it, so that the job can post another one
+    Job_t job = *next;
+    next->ready = false;
+
+    Device_t* dev = findDevice(job.mod);
+    if(dev != NULL) {
+      uint32_t latency = Module::micros() - job.timestamp;
+      dev->stats.jobs++;
+      dev->stats.jobLatencyTotal += latency;
+      if(latency > dev->stats.jobLatencyMax) {
+        dev->stats.jobLatencyMax = latency;
+      }
+    }
+    job.func(job.ctx);
+    num++;
+  }
+  _inJob = false;
+  return(num);
+}
@@ -0,0 +1,222 @@
+#ifndef _RADIOLIB_SPI_ARBITER_H
+#define _RADIOLIB_SPI_ARBITER_H
+
+#include "TypeDef.h"
+
+class Module;
+
+// maximum number of modules sharing one bus
+#define RADIOLIB_SPI_ARBITER_MAX_DEVICES              8
+
+// number of jobs that can be waiting to be run
+#define RADIOLIB_SPI_ARBITER_QUEUE_SIZE               8
+
+// transaction priorities
+#define RADIOLIB_SPI_PRIORITY_LOW                     0
+#define RADIOLIB_SPI_PRIORITY_NORMAL                  1
+#define RADIOLIB_SPI_PRIORITY_HIGH                    2
+
+/*!
+  \struct SPIArbiterStats_t
+
+  \brief Bus usage counters of a single module, see SPIArbiter::getStats.
+*/
+struct SPIArbiterStats_t {
+
+  /*!
+    \brief Number of SPI transactions.
+  */
+  uint32_t transactions;
+
+  /*!
+    \brief Total time the module held the bus in us.
+  */
+  uint32_t busTime;
+
+  /*!
+    \brief Number of times the bus changed hands to this module, because the previous transaction was for a different module.
+  */
+  uint32_t settingsChanges;
+
+  /*!
+    \brief Number of times transaction of this module was delayed to run higher priority jobs of other modules.
+  */
+  uint32_t preempted;
+
+  /*!
+    \brief Number of jobs run for this module.
+  */
+  uint32_t jobs;
+
+  /*!
+    \brief Total time between posting a job and running it in us.
+  */
+  uint32_t jobLatencyTotal;
+
+  /*!
+    \brief Longest time between posting a job and running it in us.
+  */
+  uint32_t jobLatencyMax;
+};
+
+/*!
+  \class SPIArbiter
+
+  \brief Arbitrates single SPI bus shared by several modules. Modules added to the arbiter route all their SPI transactions through it.
+
+  SPI transaction is closed after it ends, unless enabled by SPIArbiter::setKeepOpen. In that case, consecutive transactions for the same module
+  do not reprogram the SPI interface, and the transaction is only closed and reopened with new settings when another module takes the bus,
+  or by SPIArbiter::releaseBus (which has to be called before the bus is used by anything else than the modules added to the arbiter).
+
+  Latency-critical operations (e.g. reading IRQ status or draining FIFO after interrupt) can be posted as jobs, also from interrupt service routine.
+  Jobs are run before the next transaction of a module with lower priority (so a long configuration sequence of one module
+  is paused between its transactions), or from SPIArbiter::service when the bus is idle. Transactions themselves are never interrupted.
+  Jobs are never run in the middle of transaction sequence of their own module. Jobs are dispatched by SPIArbiter::prepareTransaction,
+  which drivers call through Module::SPIprepareTransaction before chip select of the module is pulled low, so that no other chip is selected
+  while a job is running.
+*/
+class SPIArbiter {
+  public:
+    /*!
+      \brief Default constructor.
+    */
+    SPIArbiter();
+
+    /*!
+      \brief Destructor. Closes the open transaction and removes all modules.
+    */
+    ~SPIArbiter();
+
+    /*!
+      \brief Adds module to the arbiter. All modules have to use the same SPI bus.
+
+      \param mod Module to add.
+
+      \param priority Priority of regular transactions of the module, one of RADIOLIB_SPI_PRIORITY_* macros. Only jobs with higher priority can delay them.
+
+      \returns \ref status_codes
+    */
+    int16_t addDevice(Module* mod, uint8_t priority = RADIOLIB_SPI_PRIORITY_LOW);
+
+    /*!
+      \brief Removes module from the arbiter, it will access the bus directly again.
+
+      \param mod Module to remove.
+    */
+    void removeDevice(Module* mod);
+
+    /*!
+      \brief Posts job to be run as soon as possible. Can be called from interrupt service routine, interrupts are briefly disabled while the job slot is claimed.
+
+      \param mod Module the job accesses. Must be added to the arbiter.
+
+      \param func Job function, called with user context.
+
+      \param ctx User context passed to job function.
+
+      \param priority Job priority, one of RADIOLIB_SPI_PRIORITY_* macros.
+
+      \returns \ref status_codes
+    */
+    int16_t post(Module* mod, void (*func)(void*), void* ctx = NULL, uint8_t priority = RADIOLIB_SPI_PRIORITY_HIGH);
+
+    /*!
+      \brief Runs all pending jobs. Must be called from the main loop, never from interrupt context.
+
+      \returns Number of jobs that were run.
+    */
+    size_t service();
+
+    /*!
+      \brief Sets whether SPI transaction is left open after it ends, so that consecutive transactions for the same module do not reprogram the SPI interface.
+      Only enable when the bus is not used by anything else than the modules added to the arbiter, or call releaseBus before it is. Disabled by default.
+
+      \param keepOpen Whether to keep the transaction open.
+    */
+    void setKeepOpen(bool keepOpen);
+
+    /*!
+      \brief Closes the open SPI transaction, so that the bus can be used by other devices.
+    */
+    void releaseBus();
+
+    /*!
+      \brief Gets bus usage counters of a module.
+
+      \param mod Module to get the counters for.
+
+      \returns Bus usage counters.
+    */
+    SPIArbiterStats_t getStats(Module* mod);
+
+    /*!
+      \brief Resets bus usage counters of all modules.
+    */
+    void resetStats();
+
+    /*!
+      \brief Gets the number of jobs dropped because the job queue was full.
+
+      \returns Number of dropped jobs.
+    */
+    uint32_t getJobOverflows();
+
+    /*!
+      \brief Runs jobs of other modules that are more urgent than the next transaction of a module, called by Module::SPIprepareTransaction.
+      Must be called before chip select of the module is pulled low.
+
+      \param mod Module that is about to start a transaction.
+    */
+    void prepareTransaction(Module* mod);
+
+    /*!
+      \brief Starts SPI transaction of a module, called by Module::SPIbeginTransaction.
+
+      \param mod Module that starts the transaction.
+    */
+    void beginTransaction(Module* mod);
+
+    /*!
+      \brief Ends SPI transaction of a module, called by Module::SPIendTransaction.
+
+      \param mod Module that ends the transaction.
+    */
+    void endTransaction(Module* mod);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    struct Device_t {
+      Module* mod;
+      uint8_t priority;
+      SPIArbiterStats_t stats;
+    };
+
+    // jobs are posted from interrupt service routines, a slot is only handed over once it is complete
+    struct Job_t {
+      Module* mod;
+      void (*func)(void*);
+      void* ctx;
+      uint8_t priority;
+      uint32_t timestamp;
+      volatile bool ready;
+    };
+
+    Device_t _devices[RADIOLIB_SPI_ARBITER_MAX_DEVICES];
+    uint8_t _numDevices = 0;
+
+    Module* _open = NULL;
+    Module* _last = NULL;
+    bool _keepOpen = false;
+    Module* _owner = NULL;
+    uint32_t _start = 0;
+    bool _inJob = false;
+
+    Job_t _jobs[RADIOLIB_SPI_ARBITER_QUEUE_SIZE];
+    volatile uint32_t _jobOverflows = 0;
+
+    Device_t* findDevice(Module* mod);
+    size_t runJobs(Module* current, int16_t priority);
+};
+
+#endif
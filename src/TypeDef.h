@@ -223,6 +223,36 @@
 */
 #define ERR_INVALID_ENCODING                          -23
 
+/*!
+  \brief The supplied register write verification policy is invalid.
+*/
+#define ERR_INVALID_VERIFY_POLICY                     -24
+
+/*!
+  \brief Failed to open or configure hardware interface (e.g. SPI or GPIO device).
+*/
+#define ERR_INTERFACE_INIT_FAILED                     -25
+
+/*!
+  \brief All interrupt slots of the event queue are already in use, see RADIOLIB_EVENT_SLOTS.
+*/
+#define ERR_EVENT_SLOTS_FULL                          -26
+
+/*!
+  \brief Asynchronous operation was started, but it has not finished yet. Returned by PhysicalLayer::poll.
+*/
+#define OPERATION_PENDING                             -27
+
+/*!
+  \brief Queue is full, e.g. RadioManager transmit queue.
+*/
+#define ERR_QUEUE_FULL                                -28
+
+/*!
+  \brief Packet has more segments than can be retained for transmission, see RADIOLIB_TX_SEGMENTS_MAX.
+*/
+#define ERR_TOO_MANY_SEGMENTS                         -29
+
 // RF69-specific status codes
 
 /*!
@@ -317,6 +347,11 @@
 */
 #define ERR_MQTT_NO_NEW_PACKET_AVAILABLE              -210
 
+/*!
+  \brief AT command was sent, but the response was not received yet. Returned by ATEngine::poll.
+*/
+#define AT_RESPONSE_PENDING                           -211
+
 /*!
   \brief Successfully subscribed to MQTT topic with QoS 0.
 */
@@ -405,6 +440,11 @@
 */
 #define ERR_INVALID_NUM_BROAD_ADDRS                   -601
 
+/*!
+  \brief Supplied packet length can not be configured (fixed packet length above 255 bytes must not be a multiple of 256).
+*/
+#define ERR_INVALID_PACKET_LENGTH                     -602
+
 // SX126x-specific status codes
 
 /*!
@@ -4,17 +4,29 @@ CC1101::CC1101(Module* module) : PhysicalLayer(CC1101_FREQUENCY_STEP_SIZE, CC110
   _mod = module;
   _packetLengthQueried = false;
   _packetLengthConfig = CC1101_LENGTH_CONFIG_VARIABLE;
+  _payloadLength = CC1101_MAX_PACKET_LENGTH;
   _modulation = CC1101_MOD_FORMAT_2_FSK;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+  _fifoInfinite = false;
+  _fifoCrcOk = false;
 
   _syncWordLength = 2;
 }
 
 int16_t CC1101::begin(float freq, float br, float freqDev, float rxBw, int8_t power, uint8_t preambleLength) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->SPIreadCommand = CC1101_CMD_READ;
   _mod->SPIwriteCommand = CC1101_CMD_WRITE;
+  _mod->SPIburstCommand = CC1101_CMD_BURST;
+  _mod->SPIvolatileRegs = CC1101VolatileRegs;
+  _mod->SPIvolatileRegsLen = sizeof(CC1101VolatileRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
+  Module::pinMode(_mod->getGpio(), INPUT);
 
   // try to find the CC1101 chip
   uint8_t i = 0;
@@ -35,7 +47,7 @@ int16_t CC1101::begin(float freq, float br, float freqDev, float rxBw, int8_t po
         RADIOLIB_DEBUG_PRINT(F(", expected 0x0014"));
         RADIOLIB_DEBUG_PRINTLN();
       #endif
-      delay(1000);
+      Module::delay(1000);
       i++;
     }
   }
@@ -96,49 +108,54 @@ int16_t CC1101::begin(float freq, float br, float freqDev, float rxBw, int8_t po
 }
 
 int16_t CC1101::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(transmit(&seg, 1, addr));
+}
+
+int16_t CC1101::transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+
   // start transmission
-  int16_t state = startTransmit(data, len, addr);
+  int16_t state = startTransmit(segs, numSegs, addr);
   RADIOLIB_ASSERT(state);
 
-  // wait for transmission start
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-  }
-
-  // wait for transmission end
-  while(digitalRead(_mod->getIrq())) {
-    yield();
-  }
+  // wait for transmission start and end, refill FIFO of packets longer than it
+  waitForGdo0(HIGH);
+  waitForGdo0(LOW);
 
   // set mode to standby
   standby();
 
   // flush Tx FIFO
   SPIsendCommand(CC1101_CMD_FLUSH_TX);
+  _fifoTx.clear();
 
   return(state);
 }
 
 int16_t CC1101::receive(uint8_t* data, size_t len) {
-  // start reception
-  int16_t state = startReceive();
-  RADIOLIB_ASSERT(state);
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
 
-  // wait for sync word
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
+  // start reception, packets that may not fit into FIFO are drained while they are being received
+  int16_t state;
+  if(_payloadLength > CC1101_MAX_PACKET_LENGTH) {
+    state = startReceiveStream(data, len);
+  } else {
+    state = startReceive();
   }
+  RADIOLIB_ASSERT(state);
 
-  // wait for packet end
-  while(digitalRead(_mod->getIrq())) {
-    yield();
-  }
+  // wait for sync word and packet end, drain FIFO of packets longer than it
+  waitForGdo0(HIGH);
+  waitForGdo0(LOW);
 
   // read packet data
   return(readData(data, len));
 }
 
 int16_t CC1101::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   SPIsendCommand(CC1101_CMD_IDLE);
   return(ERR_NONE);
 }
@@ -180,31 +197,87 @@ int16_t CC1101::packetMode() {
 }
 
 void CC1101::setGdo0Action(void (*func)(void), RADIOLIB_INTERRUPT_STATUS dir) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, dir);
+  Module::attachInterrupt(_mod->getIrq(), func, dir);
 }
 
 void CC1101::clearGdo0Action() {
-  detachInterrupt(digitalPinToInterrupt(_mod->getIrq()));
+  Module::detachInterrupt(_mod->getIrq());
 }
 
 void CC1101::setGdo2Action(void (*func)(void), RADIOLIB_INTERRUPT_STATUS dir) {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
   Module::pinMode(_mod->getGpio(), INPUT);
-  attachInterrupt(digitalPinToInterrupt(_mod->getGpio()), func, dir);
+  Module::attachInterrupt(_mod->getGpio(), func, dir);
 }
 
 void CC1101::clearGdo2Action() {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
-  detachInterrupt(digitalPinToInterrupt(_mod->getGpio()));
+  Module::detachInterrupt(_mod->getGpio());
+}
+
+bool CC1101::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source != 0) || (_mod->getIrq() == RADIOLIB_NC)) {
+    return(false);
+  }
+
+  if(func == NULL) {
+    clearGdo0Action();
+  } else {
+    setGdo0Action(func, FALLING);
+  }
+  return(true);
+}
+
+uint16_t CC1101::getEvents() {
+  // CC1101 has no IRQ flags, GDO0 deasserts at the end of packet in both directions - received bytes tell them apart
+  uint16_t events = RADIOLIB_EVENT_NONE;
+
+  // keep packets longer than FIFO moving when the operation is polled, streamed packet is drained as soon as it ends
+  serviceFifo();
+  if(_fifoRxData != NULL) {
+    if(!_fifoRxActive) {
+      events |= RADIOLIB_EVENT_RX_DONE;
+      if(_crcOn && !_fifoCrcOk) {
+        events |= RADIOLIB_EVENT_CRC_ERROR;
+      }
+    }
+    return(events);
+  }
+
+  // radio returns to idle once the packet is done, until then there is nothing to report (Rx FIFO fills up while the packet is being received)
+  uint8_t marcState = SPIgetRegValue(CC1101_REG_MARCSTATE, 4, 0);
+  if((marcState != CC1101_MARC_STATE_IDLE) && (marcState != CC1101_MARC_STATE_RXFIFO_OVERFLOW) && (marcState != CC1101_MARC_STATE_TXFIFO_UNDERFLOW)) {
+    return(events);
+  }
+
+  if(SPIgetRegValue(CC1101_REG_RXBYTES, 6, 0) > 0) {
+    events |= RADIOLIB_EVENT_RX_DONE;
+    if(_crcOn && !(SPIgetRegValue(CC1101_REG_PKTSTATUS, 7, 7))) {
+      events |= RADIOLIB_EVENT_CRC_ERROR;
+    }
+  } else {
+    events |= RADIOLIB_EVENT_TX_DONE;
+  }
+  return(events);
 }
 
 int16_t CC1101::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
-  // check packet length
-  if(len > CC1101_MAX_PACKET_LENGTH) {
+  TxSegment_t seg = { data, len };
+  return(startTransmit(&seg, 1, addr));
+}
+
+int16_t CC1101::startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
+  // check packet length, fixed length packet must not be longer than the configured length
+  uint8_t addrLen = getAddressLength();
+  bool variable = (_packetLengthConfig == CC1101_LENGTH_CONFIG_VARIABLE);
+  if((variable && (len + addrLen > CC1101_MAX_PACKET_LENGTH_VARIABLE)) || (!variable && (len + addrLen > _payloadLength))) {
     return(ERR_PACKET_TOO_LONG);
   }
 
@@ -214,23 +287,37 @@ int16_t CC1101::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   // flush Tx FIFO
   SPIsendCommand(CC1101_CMD_FLUSH_TX);
 
-  // set GDO0 mapping
+  // drop any packet that was being streamed, segment descriptors are copied because packet longer than FIFO is written after this method returns
+  if(_fifoTx.set(segs, numSegs) != ERR_NONE) {
+    return(ERR_TOO_MANY_SEGMENTS);
+  }
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+
+  // set GDO0 mapping, GDO2 is active while Tx FIFO is filled above the threshold
   int16_t state = SPIsetRegValue(CC1101_REG_IOCFG0, CC1101_GDOX_SYNC_WORD_SENT_OR_RECEIVED);
+  state |= SPIsetRegValue(CC1101_REG_IOCFG2, CC1101_GDOX_TX_FIFO_ABOVE_THR);
+  RADIOLIB_ASSERT(state);
+
+  // fixed length packet longer than 255 bytes starts in infinite packet length mode
+  _fifoInfinite = !variable && (_payloadLength > CC1101_MAX_PACKET_LENGTH_VARIABLE);
+  state = SPIsetRegValue(CC1101_REG_PKTCTRL0, _fifoInfinite ? CC1101_LENGTH_CONFIG_INFINITE : _packetLengthConfig, 1, 0);
   RADIOLIB_ASSERT(state);
 
-  // optionally write packet length
-  if (_packetLengthConfig == CC1101_LENGTH_CONFIG_VARIABLE) {
-    SPIwriteRegister(CC1101_REG_FIFO, len);
+  // optionally write packet length, address byte is part of the payload
+  if(variable) {
+    SPIwriteRegister(CC1101_REG_FIFO, len + addrLen);
   }
 
   // check address filtering
-  uint8_t filter = SPIgetRegValue(CC1101_REG_PKTCTRL1, 1, 0);
-  if(filter != CC1101_ADR_CHK_NONE) {
+  if(addrLen > 0) {
     SPIwriteRegister(CC1101_REG_FIFO, addr);
   }
 
-  // write packet to FIFO
-  SPIwriteRegisterBurst(CC1101_REG_FIFO, data, len);
+  // write as much of the packet as fits into FIFO, the rest is written by serviceFifo
+  _fifoLen = len;
+  _fifoPos = 0;
+  writeFifo(CC1101_FIFO_SIZE - addrLen - (variable ? 1 : 0));
 
   // set mode to transmit
   SPIsendCommand(CC1101_CMD_TX);
@@ -238,15 +325,38 @@ int16_t CC1101::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   return(state);
 }
 
+int16_t CC1101::finishTransmit() {
+  // set mode to standby
+  standby();
+
+  // flush Tx FIFO
+  SPIsendCommand(CC1101_CMD_FLUSH_TX);
+  _fifoTx.clear();
+  return(ERR_NONE);
+}
+
 int16_t CC1101::startReceive() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
   // set mode to standby
   standby();
 
   // flush Rx FIFO
   SPIsendCommand(CC1101_CMD_FLUSH_RX);
 
-  // set GDO0 mapping
+  // drop any packet that was being streamed
+  _fifoTx.clear();
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+
+  // set GDO0 mapping, GDO2 is active while Rx FIFO is filled at or above the threshold
   int state = SPIsetRegValue(CC1101_REG_IOCFG0, CC1101_GDOX_SYNC_WORD_SENT_OR_RECEIVED);
+  state |= SPIsetRegValue(CC1101_REG_IOCFG2, CC1101_GDOX_RX_FIFO_FULL);
+  RADIOLIB_ASSERT(state);
+
+  // fixed length packet longer than 255 bytes starts in infinite packet length mode
+  _fifoInfinite = (_packetLengthConfig == CC1101_LENGTH_CONFIG_FIXED) && (_payloadLength > CC1101_MAX_PACKET_LENGTH_VARIABLE);
+  state = SPIsetRegValue(CC1101_REG_PKTCTRL0, _fifoInfinite ? CC1101_LENGTH_CONFIG_INFINITE : _packetLengthConfig, 1, 0);
   RADIOLIB_ASSERT(state);
 
   // set mode to receive
@@ -255,16 +365,115 @@ int16_t CC1101::startReceive() {
   return(state);
 }
 
+int16_t CC1101::startReceiveStream(uint8_t* data, size_t len) {
+  int16_t state = startReceive();
+  RADIOLIB_ASSERT(state);
+
+  // length of variable length packet is only known once its first byte is drained
+  uint8_t addrLen = getAddressLength();
+  _fifoHeaderLen = addrLen;
+  _fifoLen = 0;
+  if(_packetLengthConfig == CC1101_LENGTH_CONFIG_VARIABLE) {
+    _fifoHeaderLen++;
+  } else if(_payloadLength > addrLen) {
+    _fifoLen = _payloadLength - addrLen;
+  }
+  _fifoRxData = data;
+  _fifoRxSize = len;
+  _fifoPos = 0;
+  _fifoCrcOk = false;
+  _fifoRxActive = true;
+  return(state);
+}
+
+bool CC1101::serviceFifo() {
+  if(_fifoTx.isActive()) {
+    // nothing more can be sent after Tx FIFO underflowed
+    uint8_t txBytes = getFifoBytes(CC1101_REG_TXBYTES);
+    if(txBytes & CC1101_TXFIFO_UNDERFLOW) {
+      _fifoTx.clear();
+      return(true);
+    }
+
+    // refill only after FIFO dropped below the threshold (33 bytes), so that at least half of it is written at once
+    if(txBytes > CC1101_FIFO_SIZE / 2) {
+      return(false);
+    }
+    writeFifo(CC1101_FIFO_SIZE - txBytes);
+
+    // at most the whole FIFO is still waiting to be sent
+    checkInfinite(_fifoLen - _fifoPos + CC1101_FIFO_SIZE);
+    if(_fifoTx.isActive()) {
+      return(false);
+    }
+
+  } else if(_fifoRxActive) {
+    // radio returns to idle at the end of packet, the rest of it is then drained together with the status bytes
+    uint8_t marcState = SPIgetRegValue(CC1101_REG_MARCSTATE, 4, 0);
+    uint8_t rxBytes = getFifoBytes(CC1101_REG_RXBYTES) & CC1101_NUM_RXBYTES;
+    if(((marcState == CC1101_MARC_STATE_IDLE) || (marcState == CC1101_MARC_STATE_RXFIFO_OVERFLOW)) && (rxBytes > 0)) {
+      drainFifo(true);
+      _fifoRxActive = false;
+    } else {
+      if(rxBytes >= CC1101_FIFO_SIZE / 2) {
+        drainFifo(false);
+      }
+      return(false);
+    }
+  }
+
+  return(true);
+}
+
+void CC1101::setFifoAction(void (*func)(void)) {
+  setGdo2Action(func, CHANGE);
+}
+
 int16_t CC1101::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
   // get packet length
   size_t length = len;
+
+  // streamed packet is already in the stream buffer, except for its end
+  if(_fifoRxData != NULL) {
+    standby();
+    if(_fifoRxActive) {
+      drainFifo(true);
+      _fifoRxActive = false;
+    }
+    if((len == 0) || (len > _fifoLen)) {
+      length = _fifoLen;
+    }
+    if(length > _fifoRxSize) {
+      length = _fifoRxSize;
+    }
+    if(data != _fifoRxData) {
+      memcpy(data, _fifoRxData, length);
+    }
+
+    // the rest of packet longer than the stream buffer was dropped while draining
+    int16_t state = ERR_NONE;
+    if(_crcOn && !_fifoCrcOk) {
+      state = ERR_CRC_MISMATCH;
+    } else if(_fifoLen > _fifoRxSize) {
+      state = ERR_PACKET_TOO_LONG;
+    }
+    _packetLength = _fifoLen;
+    _fifoRxData = NULL;
+    _packetLengthQueried = false;
+    SPIsendCommand(CC1101_CMD_FLUSH_RX);
+    return(state);
+  }
+
+  // length byte of variable length packet is at the start of FIFO, so it has to be read even when the length is known
+  size_t packetLength = getPacketLength();
   if(len == CC1101_MAX_PACKET_LENGTH) {
-    length = getPacketLength();
+    length = packetLength;
   }
 
   // check address filtering
-  uint8_t filter = SPIgetRegValue(CC1101_REG_PKTCTRL1, 1, 0);
-  if(filter != CC1101_ADR_CHK_NONE) {
+  if(getAddressLength() > 0) {
     SPIreadRegister(CC1101_REG_FIFO);
   }
 
@@ -309,9 +518,11 @@ int16_t CC1101::setFrequency(float freq) {
   //set carrier frequency
   uint32_t base = 1;
   uint32_t FRF = (freq * (base << 16)) / 26.0;
+  _mod->SPIbeginBatch();
   int16_t state = SPIsetRegValue(CC1101_REG_FREQ2, (FRF & 0xFF0000) >> 16, 7, 0);
   state |= SPIsetRegValue(CC1101_REG_FREQ1, (FRF & 0x00FF00) >> 8, 7, 0);
   state |= SPIsetRegValue(CC1101_REG_FREQ0, FRF & 0x0000FF, 7, 0);
+  state |= _mod->SPIcommitBatch();
 
   if(state == ERR_NONE) {
     _freq = freq;
@@ -592,12 +803,17 @@ uint8_t CC1101::getLQI() {
 }
 
 size_t CC1101::getPacketLength(bool update) {
-  if(!_packetLengthQueried && update) {
+  if(_fifoRxData != NULL) {
+    _packetLength = _fifoLen;
+  } else if(!_packetLengthQueried && update) {
+    // address byte is part of the payload
+    uint8_t addrLen = getAddressLength();
     if (_packetLengthConfig == CC1101_LENGTH_CONFIG_VARIABLE) {
       _packetLength = _mod->SPIreadRegister(CC1101_REG_FIFO);
     } else {
-      _packetLength = _mod->SPIreadRegister(CC1101_REG_PKTLEN);
+      _packetLength = _payloadLength;
     }
+    _packetLength = (_packetLength > addrLen) ? _packetLength - addrLen : 0;
 
     _packetLengthQueried = true;
   }
@@ -605,7 +821,7 @@ size_t CC1101::getPacketLength(bool update) {
   return(_packetLength);
 }
 
-int16_t CC1101::fixedPacketLengthMode(uint8_t len) {
+int16_t CC1101::fixedPacketLengthMode(uint16_t len) {
   return(setPacketMode(CC1101_LENGTH_CONFIG_FIXED, len));
 }
 
@@ -715,12 +931,16 @@ int16_t CC1101::config() {
   SPIsendCommand(CC1101_CMD_RESET);
 
   // Wait a ridiculous amount of time to be sure radio is ready.
-  delay(150);
+  Module::delay(150);
 
   // enable automatic frequency synthesizer calibration
   int16_t state = SPIsetRegValue(CC1101_REG_MCSM0, CC1101_FS_AUTOCAL_IDLE_TO_RXTX, 5, 4);
   RADIOLIB_ASSERT(state);
 
+  // set FIFO thresholds to half of FIFO (32 bytes in Rx FIFO, 33 bytes in Tx FIFO)
+  state = SPIsetRegValue(CC1101_REG_FIFOTHR, CC1101_FIFO_THR, 3, 0);
+  RADIOLIB_ASSERT(state);
+
   // set packet mode
   state = packetMode();
 
@@ -766,10 +986,10 @@ void CC1101::getExpMant(float target, uint16_t mantOffset, uint8_t divExp, uint8
 	}
 }
 
-int16_t CC1101::setPacketMode(uint8_t mode, uint8_t len) {
-  // check length
-  if (len > CC1101_MAX_PACKET_LENGTH) {
-    return(ERR_PACKET_TOO_LONG);
+int16_t CC1101::setPacketMode(uint8_t mode, uint16_t len) {
+  // packets longer than FIFO are streamed through it, PKTLEN only holds fixed length above 255 bytes modulo 256, which must not be 0
+  if((len > CC1101_MAX_PACKET_LENGTH_VARIABLE) && ((len & 0xFF) == 0)) {
+    return(ERR_INVALID_PACKET_LENGTH);
   }
 
   // set PKTCTRL0.LENGTH_CONFIG
@@ -777,15 +997,123 @@ int16_t CC1101::setPacketMode(uint8_t mode, uint8_t len) {
   RADIOLIB_ASSERT(state);
 
   // set length to register
-  state = _mod->SPIsetRegValue(CC1101_REG_PKTLEN, len);
+  state = _mod->SPIsetRegValue(CC1101_REG_PKTLEN, len & 0xFF);
   RADIOLIB_ASSERT(state);
 
-  // update the cached value
+  // update the cached values
   _packetLength = len;
   _packetLengthConfig = mode;
+  _payloadLength = len;
   return(state);
 }
 
+uint8_t CC1101::getFifoBytes(uint8_t reg) {
+  // byte counters may be read wrong while they change, so they are read until two consecutive values match
+  uint8_t prev = SPIreadRegister(reg);
+  uint8_t val = SPIreadRegister(reg);
+  while(val != prev) {
+    prev = val;
+    val = SPIreadRegister(reg);
+  }
+  return(val);
+}
+
+void CC1101::waitForGdo0(RADIOLIB_PIN_STATUS value) {
+  while(Module::digitalRead(_mod->getIrq()) != value) {
+    if(!_fifoTx.isActive() && !_fifoRxActive) {
+      Module::waitForPin(_mod->getIrq(), value, RADIOLIB_WAIT_SLICE);
+    } else if(_mod->getGpio() != RADIOLIB_NC) {
+      // GDO2 signals that streamed packet needs FIFO service: Tx FIFO dropped below the threshold, or Rx FIFO reached it
+      Module::waitForPins(_mod->getIrq(), value, _mod->getGpio(), _fifoTx.isActive() ? LOW : HIGH, RADIOLIB_WAIT_SLICE);
+    }
+    serviceFifo();
+  }
+}
+
+void CC1101::writeFifo(size_t count) {
+  size_t len = 0;
+  uint8_t* data = _fifoTx.next(count, &len);
+  while(data != NULL) {
+    SPIwriteRegisterBurst(CC1101_REG_FIFO, data, len);
+    count -= len;
+    _fifoPos += len;
+    data = _fifoTx.next(count, &len);
+  }
+}
+
+void CC1101::drainFifo(bool all) {
+  // the last byte must stay in Rx FIFO until the whole packet was received
+  uint8_t count = getFifoBytes(CC1101_REG_RXBYTES) & CC1101_NUM_RXBYTES;
+  if(!all && (count > 0)) {
+    count--;
+  }
+
+  // length and address bytes are at the start of the packet
+  if(_fifoHeaderLen > 0) {
+    if(count < _fifoHeaderLen) {
+      return;
+    }
+    uint8_t header[2];
+    SPIreadRegisterBurst(CC1101_REG_FIFO, _fifoHeaderLen, header);
+    if(_packetLengthConfig == CC1101_LENGTH_CONFIG_VARIABLE) {
+      // address byte is part of the payload
+      uint8_t addrLen = _fifoHeaderLen - 1;
+      _fifoLen = (header[0] > addrLen) ? header[0] - addrLen : 0;
+    }
+    count -= _fifoHeaderLen;
+    _fifoHeaderLen = 0;
+  }
+
+  size_t num = _fifoLen - _fifoPos;
+  if(num > count) {
+    num = count;
+  }
+
+  // bytes that do not fit into the buffer are dumped
+  size_t len = 0;
+  if(_fifoPos < _fifoRxSize) {
+    len = _fifoRxSize - _fifoPos;
+    if(len > num) {
+      len = num;
+    }
+    SPIreadRegisterBurst(CC1101_REG_FIFO, len, &_fifoRxData[_fifoPos]);
+  }
+  for(size_t i = len; i < num; i++) {
+    SPIreadRegister(CC1101_REG_FIFO);
+  }
+  _fifoPos += num;
+  count -= num;
+
+  if(!all) {
+    // the rest of the packet is at most what was not read yet, minus what is still in FIFO
+    checkInfinite(_fifoLen - _fifoPos - count);
+    return;
+  }
+
+  // RSSI and LQI/CRC status bytes follow the packet
+  if((_fifoPos == _fifoLen) && (count >= 2)) {
+    _rawRSSI = SPIreadRegister(CC1101_REG_FIFO);
+    uint8_t val = SPIreadRegister(CC1101_REG_FIFO);
+    _rawLQI = val & 0x7F;
+    _fifoCrcOk = val & CC1101_CRC_OK;
+  }
+}
+
+void CC1101::checkInfinite(size_t remaining) {
+  // packet ends once the byte counter reaches PKTLEN in fixed packet length mode, that must be its last pass
+  if(_fifoInfinite && (remaining <= CC1101_MAX_PACKET_LENGTH_VARIABLE)) {
+    SPIsetRegValue(CC1101_REG_PKTCTRL0, CC1101_LENGTH_CONFIG_FIXED, 1, 0);
+    _fifoInfinite = false;
+  }
+}
+
+uint8_t CC1101::getAddressLength() {
+  if(SPIgetRegValue(CC1101_REG_PKTCTRL1, 1, 0) != CC1101_ADR_CHK_NONE) {
+    return(1);
+  }
+  return(0);
+}
+
 int16_t CC1101::SPIgetRegValue(uint8_t reg, uint8_t msb, uint8_t lsb) {
   // status registers require special command
   if(reg > CC1101_REG_TEST0) {
@@ -831,9 +1159,21 @@ void CC1101::SPIwriteRegisterBurst(uint8_t reg, uint8_t* data, size_t len) {
 }
 
 void CC1101::SPIsendCommand(uint8_t cmd) {
+  #ifdef RADIOLIB_SPI_TRACE
+    uint32_t traceTime = Module::micros();
+  #endif
+
+  _mod->SPIprepareTransaction();
   Module::digitalWrite(_mod->getCs(), LOW);
-  SPI.beginTransaction(SPISettings(2000000, MSBFIRST, SPI_MODE0));
-  SPI.transfer(cmd);
-  SPI.endTransaction();
+  _mod->SPIbeginTransaction();
+
+  // chip status byte is clocked in while the command strobe is sent
+  uint8_t status = cmd;
+  _mod->SPItransferBuffer(&status, 1);
+  _mod->SPIendTransaction();
   Module::digitalWrite(_mod->getCs(), HIGH);
+
+  #ifdef RADIOLIB_SPI_TRACE
+    _mod->SPItraceRecord(&cmd, 1, true, NULL, 0, status, traceTime);
+  #endif
 }
@@ -9,6 +9,9 @@
 // CC1101 physical layer properties
 #define CC1101_FREQUENCY_STEP_SIZE                    396.7285156
 #define CC1101_MAX_PACKET_LENGTH                      63
+#define CC1101_MAX_PACKET_LENGTH_VARIABLE             255
+#define CC1101_MAX_PACKET_LENGTH_FIXED                65535
+#define CC1101_FIFO_SIZE                              64
 #define CC1101_CRYSTAL_FREQ                           26.0
 #define CC1101_DIV_EXPONENT                           16
 
@@ -168,7 +171,7 @@
 #define CC1101_RX_ATTEN_6_DB                          0b00010000  //  5     4                     6 dB
 #define CC1101_RX_ATTEN_12_DB                         0b00100000  //  5     4                     12 dB
 #define CC1101_RX_ATTEN_18_DB                         0b00110000  //  5     4                     18 dB
-#define CC1101_FIFO_THR                               0b00000111  //  5     4     Rx FIFO threshold [bytes] = CC1101_FIFO_THR * 4; Tx FIFO threshold [bytes] = 65 - (CC1101_FIFO_THR * 4)
+#define CC1101_FIFO_THR                               0b00000111  //  3     0     Rx FIFO threshold [bytes] = (CC1101_FIFO_THR + 1) * 4; Tx FIFO threshold [bytes] = 61 - (CC1101_FIFO_THR * 4)
 
 // CC1101_REG_SYNC1
 #define CC1101_SYNC_WORD_MSB                          0xD3        //  7     0     sync word MSB
@@ -496,6 +499,27 @@
 #define CC1101_GDO2_ACTIVE                            0b00000100  //  2     2     GDO2 is active/asserted
 #define CC1101_GDO0_ACTIVE                            0b00000001  //  0     0     GDO0 is active/asserted
 
+// CC1101_REG_TXBYTES
+#define CC1101_TXFIFO_UNDERFLOW                       0b10000000  //  7     7     Tx FIFO underflowed
+#define CC1101_NUM_TXBYTES                            0b01111111  //  6     0     number of bytes in Tx FIFO
+
+// CC1101_REG_RXBYTES
+#define CC1101_RXFIFO_OVERFLOW                        0b10000000  //  7     7     Rx FIFO overflowed
+#define CC1101_NUM_RXBYTES                            0b01111111  //  6     0     number of bytes in Rx FIFO
+
+// CC1101 registers that are never served from register cache - status registers, PA table and FIFO
+static const uint8_t CC1101VolatileRegs[] PROGMEM = {
+  CC1101_REG_PATABLE, CC1101_REG_FIFO,
+  CC1101_REG_PARTNUM | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_VERSION | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_FREQEST | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_LQI | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_RSSI | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_MARCSTATE | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_WORTIME1 | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_WORTIME0 | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_PKTSTATUS | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_VCO_VC_DAC | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_TXBYTES | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_RXBYTES | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_RCCTRL1_STATUS | CC1101_CMD_ACCESS_STATUS_REG, CC1101_REG_RCCTRL0_STATUS | CC1101_CMD_ACCESS_STATUS_REG,
+  CC1101_REG_PATABLE | CC1101_CMD_BURST, CC1101_REG_FIFO | CC1101_CMD_BURST
+};
+
 /*!
   \class CC1101
 
@@ -551,6 +575,19 @@ class CC1101: public PhysicalLayer {
     */
     int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Blocking scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Address to send the data to. Will only be added if address filtering was enabled.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
     /*!
       \brief Blocking binary receive method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -621,9 +658,28 @@ class CC1101: public PhysicalLayer {
     */
     void clearGdo2Action();
 
+    /*!
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is GDO0, activated at the end of packet.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
     /*!
       \brief Interrupt-driven binary transmit method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
+      Packets longer than FIFO are streamed through it, see CC1101::serviceFifo. The data must then stay valid until the transmission is finished.
 
       \param data Binary data to be sent.
 
@@ -635,6 +691,27 @@ class CC1101: public PhysicalLayer {
     */
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Interrupt-driven scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+      Packets longer than FIFO are streamed through it, see CC1101::serviceFifo. Segment descriptors are copied (see TxSegmentStream), the data they point to must then stay valid until the transmission is finished.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments, at most RADIOLIB_TX_SEGMENTS_MAX.
+
+      \param addr Address to send the data to. Will only be added if address filtering was enabled.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - sets module to standby and flushes Tx FIFO.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
     /*!
       \brief Interrupt-driven receive method. GDO0 will be activated when full packet is received.
 
@@ -642,8 +719,40 @@ class CC1101: public PhysicalLayer {
     */
     int16_t startReceive();
 
+    /*!
+      \brief Interrupt-driven receive method for packets longer than FIFO. Received bytes are drained from FIFO into the buffer
+      by CC1101::serviceFifo while the packet is being received. GDO0 will be deactivated at the end of the packet, readData then reads the rest of it.
+
+      \param data Buffer to save the received packet to, must stay valid until the packet is read. Bytes that do not fit into it are dropped,
+      readData then returns ERR_PACKET_TOO_LONG.
+
+      \param len Size of the buffer.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceiveStream(uint8_t* data, size_t len);
+
+    /*!
+      \brief Moves the next chunk of packet longer than FIFO between FIFO and user buffer: refills Tx FIFO during transmission started by startTransmit,
+      or drains Rx FIFO during reception started by startReceiveStream. Fixed length packets longer than 255 bytes are sent in infinite packet length mode,
+      this method switches back to fixed packet length mode once less than 256 bytes of the packet remain.
+      Must be called whenever FIFO crosses the threshold, either from interrupt service routine set by setFifoAction or by polling it often enough, but not from both.
+      Blocking transmit and receive methods call it on their own.
+
+      \returns True when there is nothing left to move (the whole packet was written to or read from FIFO), false otherwise.
+    */
+    bool serviceFifo();
+
+    /*!
+      \brief Sets interrupt service routine to call when FIFO crosses the threshold (GDO2 on both edges). The function should call CC1101::serviceFifo.
+
+      \param func ISR to call.
+    */
+    void setFifoAction(void (*func)(void));
+
     /*!
       \brief Reads data received after calling startReceive method.
+      When the packet was received by startReceiveStream, the rest of it is drained into the stream buffer first and then copied to data, if it is a different buffer.
 
       \param data Pointer to array to save the received binary data.
 
@@ -790,18 +899,19 @@ class CC1101: public PhysicalLayer {
     size_t getPacketLength(bool update = true);
 
      /*!
-      \brief Set modem in fixed packet length mode.
+      \brief Set modem in fixed packet length mode. Packets longer than FIFO (up to 65535 bytes) are streamed through it, see CC1101::serviceFifo.
+      Transmitted packets must not be longer than the set length.
 
-      \param len Packet length.
+      \param len Packet length, including address byte when address filtering is enabled. Lengths above 255 bytes must not be multiples of 256.
 
       \returns \ref status_codes
     */
-    int16_t fixedPacketLengthMode(uint8_t len = CC1101_MAX_PACKET_LENGTH);
+    int16_t fixedPacketLengthMode(uint16_t len = CC1101_MAX_PACKET_LENGTH);
 
      /*!
-      \brief Set modem in variable packet length mode.
+      \brief Set modem in variable packet length mode. Packets longer than FIFO (up to 255 bytes) are streamed through it, see CC1101::serviceFifo.
 
-      \param len Maximum packet length.
+      \param len Maximum packet length, including address byte when address filtering is enabled.
 
       \returns \ref status_codes
     */
@@ -877,6 +987,18 @@ class CC1101: public PhysicalLayer {
     size_t _packetLength;
     bool _packetLengthQueried;
     uint8_t _packetLengthConfig;
+    uint16_t _payloadLength;
+
+    // packets longer than FIFO are streamed through it by serviceFifo
+    TxSegmentStream _fifoTx;
+    uint8_t* _fifoRxData;
+    size_t _fifoRxSize;
+    size_t _fifoLen;
+    size_t _fifoPos;
+    uint8_t _fifoHeaderLen;
+    bool _fifoRxActive;
+    bool _fifoInfinite;
+    bool _fifoCrcOk;
 
     bool _promiscuous;
     bool _crcOn = true;
@@ -887,7 +1009,13 @@ class CC1101: public PhysicalLayer {
     int16_t config();
     int16_t directMode();
     void getExpMant(float target, uint16_t mantOffset, uint8_t divExp, uint8_t expMax, uint8_t& exp, uint8_t& mant);
-    int16_t setPacketMode(uint8_t mode, uint8_t len);
+    int16_t setPacketMode(uint8_t mode, uint16_t len);
+    uint8_t getFifoBytes(uint8_t reg);
+    void waitForGdo0(RADIOLIB_PIN_STATUS value);
+    void writeFifo(size_t count);
+    void drainFifo(bool all);
+    void checkInfinite(size_t remaining);
+    uint8_t getAddressLength();
 
     // SPI read overrides to set bit for burst write and status registers access
     int16_t SPIgetRegValue(uint8_t reg, uint8_t msb = 7, uint8_t lsb = 0);
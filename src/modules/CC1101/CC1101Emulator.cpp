@@ -0,0 +1,708 @@
+#include "CC1101Emulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+CC1101Emulator::CC1101Emulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE gdo0, RADIOLIB_PIN_TYPE gdo2) : EmulatedChip(cs) {
+  _gdo0 = gdo0;
+  _gdo2 = gdo2;
+  _state = CC1101_MARC_STATE_IDLE;
+  _sync = false;
+  _txActive = false;
+  _rssi = CC1101_EMULATOR_RSSI_DEFAULT;
+  reset();
+}
+
+void CC1101Emulator::reset() {
+  abortTx();
+  memset(_regs, 0x00, sizeof(_regs));
+  memset(_patable, 0x00, sizeof(_patable));
+
+  _regs[CC1101_REG_IOCFG2] = CC1101_GDOX_CHIP_RDYN;
+  _regs[CC1101_REG_IOCFG1] = CC1101_GDOX_HIGH_Z;
+  _regs[CC1101_REG_IOCFG0] = CC1101_GDOX_CLOCK_XOSC_192;
+  _regs[CC1101_REG_FIFOTHR] = 0x07;
+  _regs[CC1101_REG_SYNC1] = 0xD3;
+  _regs[CC1101_REG_SYNC0] = 0x91;
+  _regs[CC1101_REG_PKTLEN] = 0xFF;
+  _regs[CC1101_REG_PKTCTRL1] = CC1101_APPEND_STATUS_ON;
+  _regs[CC1101_REG_PKTCTRL0] = 0x40 | CC1101_CRC_ON | CC1101_LENGTH_CONFIG_VARIABLE;
+  _regs[CC1101_REG_FSCTRL1] = 0x0F;
+  _regs[CC1101_REG_FREQ2] = 0x1E;
+  _regs[CC1101_REG_FREQ1] = 0xC4;
+  _regs[CC1101_REG_FREQ0] = 0xEC;
+  _regs[CC1101_REG_MDMCFG4] = 0x8C;
+  _regs[CC1101_REG_MDMCFG3] = 0x22;
+  _regs[CC1101_REG_MDMCFG2] = CC1101_SYNC_MODE_16_16;
+  _regs[CC1101_REG_MDMCFG1] = 0x22;
+  _regs[CC1101_REG_MDMCFG0] = 0xF8;
+  _regs[CC1101_REG_DEVIATN] = 0x47;
+  _regs[CC1101_REG_MCSM2] = 0x07;
+  _regs[CC1101_REG_MCSM1] = 0x30;
+  _regs[CC1101_REG_MCSM0] = 0x04;
+  _regs[CC1101_REG_FOCCFG] = 0x36;
+  _regs[CC1101_REG_BSCFG] = 0x6C;
+  _regs[CC1101_REG_AGCCTRL2] = 0x03;
+  _regs[CC1101_REG_AGCCTRL1] = 0x40;
+  _regs[CC1101_REG_AGCCTRL0] = 0x91;
+  _regs[CC1101_REG_WOREVT1] = 0x87;
+  _regs[CC1101_REG_WOREVT0] = 0x6B;
+  _regs[CC1101_REG_WORCTRL] = 0xF8;
+  _regs[CC1101_REG_FREND1] = 0x56;
+  _regs[CC1101_REG_FREND0] = 0x10;
+  _regs[CC1101_REG_FSCAL3] = 0xA9;
+  _regs[CC1101_REG_FSCAL2] = 0x0A;
+  _regs[CC1101_REG_FSCAL1] = 0x20;
+  _regs[CC1101_REG_FSCAL0] = 0x0D;
+  _regs[CC1101_REG_RCCTRL1] = 0x41;
+  _regs[CC1101_REG_FSTEST] = 0x59;
+  _regs[CC1101_REG_PTEST] = 0x7F;
+  _regs[CC1101_REG_AGCTEST] = 0x3F;
+  _regs[CC1101_REG_TEST2] = 0x88;
+  _regs[CC1101_REG_TEST1] = 0x31;
+  _regs[CC1101_REG_TEST0] = 0x0B;
+  _patable[0] = 0xC6;
+
+  _state = CC1101_MARC_STATE_IDLE;
+  _txHead = 0;
+  _txCount = 0;
+  _rxHead = 0;
+  _rxCount = 0;
+  _eventTime = UINT64_MAX;
+  _airSrc = NULL;
+  _airRx = false;
+  _sync = false;
+  _txActive = false;
+  _txCrc = false;
+  _txSent = 0;
+  _txFirst = 0;
+  _rxReceived = 0;
+  _rxFirst = 0;
+  _rxComplete = false;
+  _rxEnd = false;
+  _rxCrcOk = false;
+  _crcOk = false;
+  _txPackets = 0;
+  _rxPackets = 0;
+  _txUnderflows = 0;
+  _rxOverflows = 0;
+}
+
+bool CC1101Emulator::injectPacket(const uint8_t* data, size_t len, bool crcError) {
+  if((_state != CC1101_MARC_STATE_RX) || _airRx) {
+    return(false);
+  }
+
+  // add length byte in variable length mode
+  _airRx = true;
+  _sync = true;
+  _rxReceived = 0;
+  _rxComplete = false;
+  if((_regs[CC1101_REG_PKTCTRL0] & 0x03) == CC1101_LENGTH_CONFIG_VARIABLE) {
+    rxByte((uint8_t)len);
+  }
+  for(size_t i = 0; i < len; i++) {
+    rxByte(data[i]);
+  }
+  if(_airRx) {
+    if(_rxComplete) {
+      rxDone(!crcError);
+    } else {
+      abortRx();
+    }
+  }
+  return(true);
+}
+
+void CC1101Emulator::setSignal(int16_t rssi) {
+  _rssi = rssi;
+}
+
+uint64_t CC1101Emulator::getTimeOnAir(size_t len) {
+  // preamble, sync word, length byte, payload and CRC (infinite length packet has none)
+  size_t bytes = getHeaderLength() + len;
+  uint8_t lengthConfig = _regs[CC1101_REG_PKTCTRL0] & 0x03;
+  if(lengthConfig == CC1101_LENGTH_CONFIG_VARIABLE) {
+    bytes++;
+  }
+  if((_regs[CC1101_REG_PKTCTRL0] & CC1101_CRC_ON) && (lengthConfig != CC1101_LENGTH_CONFIG_INFINITE)) {
+    bytes += 2;
+  }
+  return((uint64_t)bytes * getByteTime());
+}
+
+uint8_t CC1101Emulator::getRegister(uint8_t addr) {
+  addr &= 0x3F;
+  if(addr == CC1101_REG_FIFO) {
+    return((_rxCount > 0) ? _rxFifo[_rxHead] : 0x00);
+  } else if(addr == CC1101_REG_PATABLE) {
+    return(_patable[0]);
+  } else if(addr > CC1101_REG_TEST0) {
+    return(readRegister(addr | CC1101_CMD_ACCESS_STATUS_REG));
+  }
+  return(_regs[addr]);
+}
+
+void CC1101Emulator::spiTransfer(uint8_t* buff, size_t len) {
+  if(len < 1) {
+    return;
+  }
+
+  // chip select wakes the chip up from sleep
+  if(_state == CC1101_MARC_STATE_SLEEP) {
+    enterState(CC1101_MARC_STATE_IDLE);
+  }
+
+  // header byte has read and burst flags, status byte is clocked out while it is sent
+  uint8_t header = buff[0];
+  bool read = header & CC1101_CMD_READ;
+  bool burst = header & CC1101_CMD_BURST;
+  uint8_t addr = header & 0x3F;
+  buff[0] = getStatus(read);
+
+  // single access to 0x30 - 0x3D is a command strobe
+  if((addr > CC1101_REG_TEST0) && (addr < CC1101_REG_PATABLE) && !burst) {
+    strobe(addr);
+    for(size_t i = 1; i < len; i++) {
+      buff[i] = getStatus(read);
+    }
+    return;
+  }
+
+  // PA table index is reset when chip select goes high
+  uint8_t paIndex = 0;
+  for(size_t i = 1; i < len; i++) {
+    // single access only transfers one byte, the rest are treated as header bytes
+    if(!burst && (i > 1)) {
+      buff[i] = getStatus(read);
+      continue;
+    }
+
+    if(addr == CC1101_REG_FIFO) {
+      if(read) {
+        buff[i] = rxFifoRead();
+      } else {
+        writeRegister(addr, buff[i]);
+      }
+    } else if(addr == CC1101_REG_PATABLE) {
+      if(read) {
+        buff[i] = _patable[paIndex];
+      } else {
+        _patable[paIndex] = buff[i];
+      }
+      paIndex = (paIndex + 1) % sizeof(_patable);
+    } else if(addr > CC1101_REG_TEST0) {
+      // burst access to 0x30 - 0x3D reads status registers
+      buff[i] = readRegister(addr | CC1101_CMD_ACCESS_STATUS_REG);
+    } else {
+      if(read) {
+        buff[i] = readRegister(addr);
+      } else {
+        writeRegister(addr, buff[i]);
+      }
+      addr = (addr + 1) & 0x3F;
+    }
+  }
+}
+
+bool CC1101Emulator::readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+  if((pin == RADIOLIB_NC) || ((pin != _gdo0) && (pin != _gdo2))) {
+    return(false);
+  }
+
+  uint8_t cfg = _regs[(pin == _gdo0) ? CC1101_REG_IOCFG0 : CC1101_REG_IOCFG2];
+  bool active = getGdo(cfg & 0x3F);
+  if(cfg & CC1101_GDO0_INV) {
+    active = !active;
+  }
+  *value = active ? HIGH : LOW;
+  return(true);
+}
+
+void CC1101Emulator::update(uint64_t now) {
+  // events are bytes leaving Tx FIFO
+  while(_eventTime <= now) {
+    txByte();
+  }
+}
+
+void CC1101Emulator::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  // chip that is transmitting cannot hear anything
+  if((_state == CC1101_MARC_STATE_TX) || (_airSrc != NULL) || !EmulatorHal::airMatch(air, getAir())) {
+    return;
+  }
+
+  // packet can only be received if the chip was already listening when it started
+  _airSrc = src;
+  _airRx = (_state == CC1101_MARC_STATE_RX);
+  if(_airRx) {
+    _sync = true;
+    _rxReceived = 0;
+    _rxComplete = false;
+  }
+}
+
+void CC1101Emulator::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  if((src != _airSrc) || !_airRx || (_state != CC1101_MARC_STATE_RX)) {
+    return;
+  }
+
+  for(size_t i = 0; (i < len) && _airRx; i++) {
+    rxByte(data[i]);
+  }
+}
+
+void CC1101Emulator::airEnd(EmulatedChip* src, bool crcOk) {
+  if(src != _airSrc) {
+    return;
+  }
+  _airSrc = NULL;
+
+  if(_airRx && (_state == CC1101_MARC_STATE_RX)) {
+    if(_rxComplete) {
+      rxDone(crcOk);
+    } else {
+      // packet that did not reach its end (e.g. in infinite length mode) is lost, receiver keeps searching for sync word
+      abortRx();
+    }
+  }
+}
+
+uint8_t CC1101Emulator::getStatus(bool read) {
+  // state field of the chip status byte
+  uint8_t state = 0;
+  switch(_state) {
+    case CC1101_MARC_STATE_RX:
+      state = 1;
+      break;
+    case CC1101_MARC_STATE_TX:
+      state = 2;
+      break;
+    case CC1101_MARC_STATE_FSTXON:
+      state = 3;
+      break;
+    case CC1101_MARC_STATE_RXFIFO_OVERFLOW:
+      state = 6;
+      break;
+    case CC1101_MARC_STATE_TXFIFO_UNDERFLOW:
+      state = 7;
+      break;
+  }
+
+  // available bytes in Rx FIFO when reading, free bytes in Tx FIFO when writing
+  uint8_t bytes = read ? _rxCount : (CC1101_FIFO_SIZE - _txCount);
+  if(bytes > 0x0F) {
+    bytes = 0x0F;
+  }
+  return((state << 4) | bytes);
+}
+
+bool CC1101Emulator::getGdo(uint8_t cfg) {
+  uint8_t thr = _regs[CC1101_REG_FIFOTHR] & 0x0F;
+  switch(cfg) {
+    case CC1101_GDOX_RX_FIFO_FULL:
+      return(_rxCount >= 4*(thr + 1));
+    case CC1101_GDOX_RX_FIFO_FULL_OR_PKT_END:
+      return((_rxCount >= 4*(thr + 1)) || (_rxEnd && (_rxCount > 0)));
+    case CC1101_GDOX_TX_FIFO_ABOVE_THR:
+      return(_txCount >= 61 - 4*thr);
+    case CC1101_GDOX_TX_FIFO_FULL:
+      return(_txCount == CC1101_FIFO_SIZE);
+    case CC1101_GDOX_RX_FIFO_OVERFLOW:
+      return(_state == CC1101_MARC_STATE_RXFIFO_OVERFLOW);
+    case CC1101_GDOX_TX_FIFO_UNDERFLOW:
+      return(_state == CC1101_MARC_STATE_TXFIFO_UNDERFLOW);
+    case CC1101_GDOX_SYNC_WORD_SENT_OR_RECEIVED:
+      return(_sync);
+    case CC1101_GDOX_PKT_RECEIVED_CRC_OK:
+      return(_rxCrcOk);
+    case CC1101_GDOX_CRC_OK:
+      return(_crcOk);
+    case CC1101_GDOX_PLL_LOCKED:
+      return((_state == CC1101_MARC_STATE_RX) || (_state == CC1101_MARC_STATE_TX) || (_state == CC1101_MARC_STATE_FSTXON));
+  }
+
+  // CHIP_RDYn is active low, everything else is not emulated
+  return(false);
+}
+
+uint8_t CC1101Emulator::readRegister(uint8_t addr) {
+  switch(addr) {
+    case CC1101_REG_FIFO:
+      return(rxFifoRead());
+
+    case CC1101_REG_PARTNUM | CC1101_CMD_ACCESS_STATUS_REG:
+      return(0x00);
+
+    case CC1101_REG_VERSION | CC1101_CMD_ACCESS_STATUS_REG:
+      return(CC1101_EMULATOR_CHIP_VERSION);
+
+    case CC1101_REG_LQI | CC1101_CMD_ACCESS_STATUS_REG:
+      return((_crcOk ? CC1101_CRC_OK : 0) | CC1101_EMULATOR_LQI_DEFAULT);
+
+    case CC1101_REG_RSSI | CC1101_CMD_ACCESS_STATUS_REG:
+      // RSSI is in 0.5 dB steps with 74 dB offset
+      return((uint8_t)(2 * (_rssi + 74)));
+
+    case CC1101_REG_MARCSTATE | CC1101_CMD_ACCESS_STATUS_REG:
+      return(_state);
+
+    case CC1101_REG_PKTSTATUS | CC1101_CMD_ACCESS_STATUS_REG: {
+      uint8_t status = _crcOk ? CC1101_CRC_OK : CC1101_CRC_ERROR;
+      if(_sync) {
+        status |= CC1101_CS | CC1101_PQT_REACHED | CC1101_SFD;
+      } else {
+        status |= CC1101_CCA;
+      }
+      if(getGdo(_regs[CC1101_REG_IOCFG2] & 0x3F) != (bool)(_regs[CC1101_REG_IOCFG2] & CC1101_GDO2_INV)) {
+        status |= CC1101_GDO2_ACTIVE;
+      }
+      if(getGdo(_regs[CC1101_REG_IOCFG0] & 0x3F) != (bool)(_regs[CC1101_REG_IOCFG0] & CC1101_GDO0_INV)) {
+        status |= CC1101_GDO0_ACTIVE;
+      }
+      return(status);
+    }
+
+    case CC1101_REG_TXBYTES | CC1101_CMD_ACCESS_STATUS_REG:
+      return(((_state == CC1101_MARC_STATE_TXFIFO_UNDERFLOW) ? CC1101_TXFIFO_UNDERFLOW : 0) | _txCount);
+
+    case CC1101_REG_RXBYTES | CC1101_CMD_ACCESS_STATUS_REG:
+      return(((_state == CC1101_MARC_STATE_RXFIFO_OVERFLOW) ? CC1101_RXFIFO_OVERFLOW : 0) | _rxCount);
+  }
+
+  if(addr <= CC1101_REG_TEST0) {
+    return(_regs[addr]);
+  }
+  return(0x00);
+}
+
+void CC1101Emulator::writeRegister(uint8_t addr, uint8_t value) {
+  if(addr == CC1101_REG_FIFO) {
+    // real chip would underflow once the FIFO is overwritten, extra bytes are dropped instead
+    if(_txCount == CC1101_FIFO_SIZE) {
+      return;
+    }
+    _txFifo[(_txHead + _txCount) % CC1101_FIFO_SIZE] = value;
+    _txCount++;
+    return;
+  }
+
+  if(addr <= CC1101_REG_TEST0) {
+    _regs[addr] = value;
+  }
+}
+
+void CC1101Emulator::strobe(uint8_t cmd) {
+  switch(cmd) {
+    case CC1101_CMD_RESET:
+      reset();
+      break;
+
+    case CC1101_CMD_FSTXON:
+      if(_state == CC1101_MARC_STATE_IDLE) {
+        enterState(CC1101_MARC_STATE_FSTXON);
+      }
+      break;
+
+    case CC1101_CMD_XOFF:
+    case CC1101_CMD_POWER_DOWN:
+      // only possible from idle, FIFOs are not retained
+      if(_state == CC1101_MARC_STATE_IDLE) {
+        enterState(CC1101_MARC_STATE_SLEEP);
+      }
+      break;
+
+    case CC1101_CMD_RX:
+      if((_state == CC1101_MARC_STATE_IDLE) || (_state == CC1101_MARC_STATE_FSTXON) || (_state == CC1101_MARC_STATE_TX)) {
+        enterState(CC1101_MARC_STATE_RX);
+      }
+      break;
+
+    case CC1101_CMD_TX:
+      if((_state == CC1101_MARC_STATE_IDLE) || (_state == CC1101_MARC_STATE_FSTXON) || (_state == CC1101_MARC_STATE_RX)) {
+        enterState(CC1101_MARC_STATE_TX);
+      }
+      break;
+
+    case CC1101_CMD_IDLE:
+      enterState(CC1101_MARC_STATE_IDLE);
+      break;
+
+    case CC1101_CMD_FLUSH_RX:
+      // only allowed in idle and after overflow
+      if((_state == CC1101_MARC_STATE_IDLE) || (_state == CC1101_MARC_STATE_RXFIFO_OVERFLOW)) {
+        _rxHead = 0;
+        _rxCount = 0;
+        _rxEnd = false;
+        _rxCrcOk = false;
+        if(_state == CC1101_MARC_STATE_RXFIFO_OVERFLOW) {
+          enterState(CC1101_MARC_STATE_IDLE);
+        }
+      }
+      break;
+
+    case CC1101_CMD_FLUSH_TX:
+      // only allowed in idle and after underflow
+      if((_state == CC1101_MARC_STATE_IDLE) || (_state == CC1101_MARC_STATE_TXFIFO_UNDERFLOW)) {
+        _txHead = 0;
+        _txCount = 0;
+        if(_state == CC1101_MARC_STATE_TXFIFO_UNDERFLOW) {
+          enterState(CC1101_MARC_STATE_IDLE);
+        }
+      }
+      break;
+  }
+}
+
+void CC1101Emulator::enterState(uint8_t state) {
+  uint8_t prev = _state;
+  _state = state;
+
+  // leaving TX aborts transmission, leaving RX stops reception
+  if(prev == CC1101_MARC_STATE_TX) {
+    abortTx();
+  } else if((prev == CC1101_MARC_STATE_RX) && _airRx) {
+    abortRx();
+  }
+
+  switch(state) {
+    case CC1101_MARC_STATE_SLEEP:
+      _txHead = 0;
+      _txCount = 0;
+      _rxHead = 0;
+      _rxCount = 0;
+      break;
+
+    case CC1101_MARC_STATE_TX:
+      txStart();
+      break;
+
+    case CC1101_MARC_STATE_RX:
+      _rxEnd = false;
+      break;
+  }
+}
+
+void CC1101Emulator::abortTx() {
+  _eventTime = UINT64_MAX;
+  if(!_txActive) {
+    return;
+  }
+
+  // receivers only get incomplete packet
+  _txActive = false;
+  _sync = false;
+  _txCrc = false;
+  EmulatorHal::airEnd(this, false);
+}
+
+void CC1101Emulator::abortRx() {
+  _airRx = false;
+  _sync = false;
+  _rxReceived = 0;
+  _rxComplete = false;
+}
+
+EmulatorAir_t CC1101Emulator::getAir() {
+  EmulatorAir_t air;
+  uint32_t frf = ((uint32_t)_regs[CC1101_REG_FREQ2] << 16) | ((uint32_t)_regs[CC1101_REG_FREQ1] << 8) | _regs[CC1101_REG_FREQ0];
+  air.freq = (uint32_t)(((uint64_t)frf * (uint64_t)(CC1101_CRYSTAL_FREQ * 1000000.0)) >> 16);
+  air.modem = RADIOLIB_EMULATOR_MODEM_FSK;
+  air.sf = 0;
+  air.rate = 8000000000ULL / getByteTime();
+  return(air);
+}
+
+uint64_t CC1101Emulator::getByteTime() {
+  // data rate is (256 + DRATE_M) * 2^DRATE_E / 2^28 * f(XOSC)
+  uint64_t m = 256 + _regs[CC1101_REG_MDMCFG3];
+  uint8_t e = _regs[CC1101_REG_MDMCFG4] & 0x0F;
+  uint64_t div = (m * (uint64_t)(CC1101_CRYSTAL_FREQ * 1000000.0)) << e;
+  return((8000000000ULL << 28) / div);
+}
+
+size_t CC1101Emulator::getHeaderLength() {
+  // preamble and sync word
+  const uint8_t preamble[] = { 2, 3, 4, 6, 8, 12, 16, 24 };
+  size_t bytes = preamble[(_regs[CC1101_REG_MDMCFG1] >> 4) & 0x07];
+  switch(_regs[CC1101_REG_MDMCFG2] & 0x07) {
+    case CC1101_SYNC_MODE_NONE:
+    case CC1101_SYNC_MODE_NONE_THR:
+      break;
+    case CC1101_SYNC_MODE_30_32:
+    case CC1101_SYNC_MODE_30_32_THR:
+      bytes += 4;
+      break;
+    default:
+      bytes += 2;
+  }
+  return(bytes);
+}
+
+bool CC1101Emulator::frameEnd(size_t count, uint8_t first) {
+  // packet length mode is checked after every byte, so it can be changed while the packet is on the air
+  switch(_regs[CC1101_REG_PKTCTRL0] & 0x03) {
+    case CC1101_LENGTH_CONFIG_FIXED:
+      // byte counter is compared with PKTLEN modulo 256
+      return((count & 0xFF) == _regs[CC1101_REG_PKTLEN]);
+    case CC1101_LENGTH_CONFIG_VARIABLE:
+      return(count == (size_t)first + 1);
+  }
+  return(false);
+}
+
+uint8_t CC1101Emulator::rxFifoRead() {
+  if(_rxCount == 0) {
+    return(0x00);
+  }
+
+  uint8_t b = _rxFifo[_rxHead];
+  _rxHead = (_rxHead + 1) % CC1101_FIFO_SIZE;
+  _rxCount--;
+
+  // CRC OK signal is deasserted once the first byte is read
+  _rxCrcOk = false;
+  if(_rxCount == 0) {
+    _rxEnd = false;
+  }
+  return(b);
+}
+
+bool CC1101Emulator::rxFifoWrite(uint8_t b) {
+  if(_rxCount == CC1101_FIFO_SIZE) {
+    // reception stops until the FIFO is flushed
+    _rxOverflows++;
+    abortRx();
+    _state = CC1101_MARC_STATE_RXFIFO_OVERFLOW;
+    return(false);
+  }
+  _rxFifo[(_rxHead + _rxCount) % CC1101_FIFO_SIZE] = b;
+  _rxCount++;
+  return(true);
+}
+
+void CC1101Emulator::txStart() {
+  // first byte leaves the FIFO after preamble and sync word
+  _txActive = true;
+  _sync = true;
+  _txCrc = false;
+  _txSent = 0;
+  _eventTime = EmulatorHal::getTimeNs() + (getHeaderLength() + 1) * getByteTime();
+  EmulatorHal::airStart(this, getAir());
+}
+
+void CC1101Emulator::txByte() {
+  uint64_t eventTime = _eventTime;
+  _eventTime = UINT64_MAX;
+  if(_state != CC1101_MARC_STATE_TX) {
+    return;
+  }
+
+  // CRC was sent, packet is done
+  if(_txCrc) {
+    _txActive = false;
+    _sync = false;
+    _txCrc = false;
+    _txPackets++;
+    EmulatorHal::airEnd(this, true);
+
+    // next state is configured in MCSM1
+    const uint8_t next[] = { CC1101_MARC_STATE_IDLE, CC1101_MARC_STATE_FSTXON, CC1101_MARC_STATE_TX, CC1101_MARC_STATE_RX };
+    _state = CC1101_MARC_STATE_IDLE;
+    enterState(next[_regs[CC1101_REG_MCSM1] & 0x03]);
+    return;
+  }
+
+  // transmitter ran out of data, it stays in underflow state until Tx FIFO is flushed
+  if(_txCount == 0) {
+    _txUnderflows++;
+    abortTx();
+    _state = CC1101_MARC_STATE_TXFIFO_UNDERFLOW;
+    return;
+  }
+
+  uint8_t b = _txFifo[_txHead];
+  _txHead = (_txHead + 1) % CC1101_FIFO_SIZE;
+  _txCount--;
+  if(_txSent == 0) {
+    _txFirst = b;
+  }
+  _txSent++;
+  EmulatorHal::airData(this, &b, 1);
+
+  if(frameEnd(_txSent, _txFirst)) {
+    _txCrc = true;
+    _eventTime = eventTime + ((_regs[CC1101_REG_PKTCTRL0] & CC1101_CRC_ON) ? 2 : 0) * getByteTime();
+  } else {
+    _eventTime = eventTime + getByteTime();
+  }
+}
+
+void CC1101Emulator::rxByte(uint8_t b) {
+  // bytes after the end of packet are CRC, which is not passed over the emulated air
+  if(_rxComplete) {
+    return;
+  }
+
+  _rxReceived++;
+  if(_rxReceived == 1) {
+    _rxFirst = b;
+
+    // packet longer than PKTLEN is discarded in variable length mode
+    if(((_regs[CC1101_REG_PKTCTRL0] & 0x03) == CC1101_LENGTH_CONFIG_VARIABLE) && (b > _regs[CC1101_REG_PKTLEN])) {
+      abortRx();
+      return;
+    }
+  }
+
+  // address byte follows the length byte in variable length mode
+  uint8_t addrPos = ((_regs[CC1101_REG_PKTCTRL0] & 0x03) == CC1101_LENGTH_CONFIG_VARIABLE) ? 2 : 1;
+  uint8_t adrChk = _regs[CC1101_REG_PKTCTRL1] & 0x03;
+  if((_rxReceived == addrPos) && (adrChk != CC1101_ADR_CHK_NONE)) {
+    bool match = (b == _regs[CC1101_REG_ADDR]) ||
+                 ((adrChk >= CC1101_ADR_CHK_SINGLE_BROADCAST) && (b == 0x00)) ||
+                 ((adrChk == CC1101_ADR_CHK_DOUBLE_BROADCAST) && (b == 0xFF));
+    if(!match) {
+      // bytes of the discarded packet are removed from the FIFO
+      _rxCount -= (addrPos - 1);
+      abortRx();
+      return;
+    }
+  }
+
+  if(rxFifoWrite(b)) {
+    _rxComplete = frameEnd(_rxReceived, _rxFirst);
+  }
+}
+
+void CC1101Emulator::rxDone(bool crcOk) {
+  _airRx = false;
+  _sync = false;
+  _rxComplete = false;
+
+  // append RSSI and LQI with CRC status
+  bool crcOn = _regs[CC1101_REG_PKTCTRL0] & CC1101_CRC_ON;
+  _crcOk = crcOk || !crcOn;
+  if(_regs[CC1101_REG_PKTCTRL1] & CC1101_APPEND_STATUS_ON) {
+    if(!rxFifoWrite(readRegister(CC1101_REG_RSSI | CC1101_CMD_ACCESS_STATUS_REG)) ||
+       !rxFifoWrite(readRegister(CC1101_REG_LQI | CC1101_CMD_ACCESS_STATUS_REG))) {
+      return;
+    }
+  }
+
+  // packets with wrong CRC can be flushed automatically
+  if(crcOn && !crcOk && (_regs[CC1101_REG_PKTCTRL1] & CC1101_CRC_AUTOFLUSH_ON)) {
+    _rxHead = 0;
+    _rxCount = 0;
+  } else {
+    _rxEnd = true;
+    _rxCrcOk = _crcOk;
+    _rxPackets++;
+  }
+
+  // next state is configured in MCSM1
+  const uint8_t next[] = { CC1101_MARC_STATE_IDLE, CC1101_MARC_STATE_FSTXON, CC1101_MARC_STATE_TX, CC1101_MARC_STATE_RX };
+  _state = CC1101_MARC_STATE_IDLE;
+  enterState(next[(_regs[CC1101_REG_MCSM1] >> 2) & 0x03]);
+}
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef _RADIOLIB_CC1101_EMULATOR_H
+#define _RADIOLIB_CC1101_EMULATOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include "../../EmulatorHal.h"
+#include "CC1101.h"
+
+// value of version register
+#define CC1101_EMULATOR_CHIP_VERSION                  0x14
+
+// emulated signal strength of received packets
+#define CC1101_EMULATOR_RSSI_DEFAULT                  -60
+
+// emulated link quality of received packets
+#define CC1101_EMULATOR_LQI_DEFAULT                   0x10
+
+/*!
+  \class CC1101Emulator
+
+  \brief Register-level emulator of %CC1101 chip, to be attached to EmulatorHal. Packet mode is emulated, including command strobes and MARCSTATE
+  transitions, chip status byte, separate 64-byte Tx and Rx FIFOs with GDO0/GDO2 mapping and time-on-air: packet bytes are taken from Tx FIFO
+  at the configured data rate, so the FIFO can be refilled during transmission, and the transmitter goes to TXFIFO_UNDERFLOW state when it runs out of data.
+
+  Fixed, variable and infinite packet length modes are supported, including switching between them while the packet is on the air.
+  Packet byte counter is compared with PKTLEN modulo 256 in fixed packet length mode, same as on the real chip.
+
+  Packets transmitted by one emulator are received by all other attached emulators that are in receive mode with matching configuration.
+  Single-chip tests can use injectPacket instead.
+
+  Limitations: register values are not range-checked, analog functions (RSSI measurement, carrier sense, frequency estimate) return fixed values,
+  calibration and settling take no time, asynchronous/synchronous serial modes, Manchester encoding, wake-on-radio and clear channel assessment are not emulated.
+  GDO1 is not emulated either, since it is shared with SPI MISO pin.
+*/
+class CC1101Emulator: public EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param gdo0 GDO0 pin.
+
+      \param gdo2 GDO2 pin. Defaults to RADIOLIB_NC.
+    */
+    CC1101Emulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE gdo0, RADIOLIB_PIN_TYPE gdo2 = RADIOLIB_NC);
+
+    /*!
+      \brief Resets all registers to their default values and aborts any ongoing operation, same as SRES command strobe.
+    */
+    void reset();
+
+    /*!
+      \brief Emulates reception of a packet. Only accepted when the chip is in receive mode.
+
+      \param data Packet payload, including address byte. In variable length mode, length byte is added automatically.
+
+      \param len Payload length in bytes.
+
+      \param crcError Whether the packet should fail CRC check.
+
+      \returns True if the packet was accepted, false otherwise.
+    */
+    bool injectPacket(const uint8_t* data, size_t len, bool crcError = false);
+
+    /*!
+      \brief Sets signal strength reported for received packets.
+
+      \param rssi RSSI in dBm.
+    */
+    void setSignal(int16_t rssi);
+
+    /*!
+      \brief Calculates time-on-air of a packet with the current configuration.
+
+      \param len Payload length in bytes, including address byte.
+
+      \returns Time-on-air in ns.
+    */
+    uint64_t getTimeOnAir(size_t len);
+
+    /*!
+      \brief Reads register value without any side effects (e.g. FIFO is not advanced).
+
+      \param addr Register address. Addresses above CC1101_REG_TEST0 read status registers.
+
+      \returns Register value.
+    */
+    uint8_t getRegister(uint8_t addr);
+
+    /*!
+      \brief Gets the number of transmitted packets since reset.
+
+      \returns Number of transmitted packets.
+    */
+    uint32_t getTxPackets() const { return(_txPackets); }
+
+    /*!
+      \brief Gets the number of received packets since reset.
+
+      \returns Number of received packets.
+    */
+    uint32_t getRxPackets() const { return(_rxPackets); }
+
+    /*!
+      \brief Gets the number of transmissions that ran out of data in Tx FIFO.
+
+      \returns Number of Tx FIFO underflows.
+    */
+    uint32_t getTxUnderflows() const { return(_txUnderflows); }
+
+    /*!
+      \brief Gets the number of receptions that were aborted because Rx FIFO was full.
+
+      \returns Number of Rx FIFO overflows.
+    */
+    uint32_t getRxOverflows() const { return(_rxOverflows); }
+
+    // EmulatedChip methods
+
+    void spiTransfer(uint8_t* buff, size_t len);
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value);
+    void update(uint64_t now);
+    uint64_t nextEvent() { return(_eventTime); }
+    void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    void airEnd(EmulatedChip* src, bool crcOk);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    RADIOLIB_PIN_TYPE _gdo0, _gdo2;
+
+    uint8_t _regs[CC1101_REG_TEST0 + 1];
+    uint8_t _patable[8];
+
+    // main radio control state machine
+    uint8_t _state;
+
+    // Tx and Rx FIFOs are separate 64 byte queues
+    uint8_t _txFifo[CC1101_FIFO_SIZE];
+    uint8_t _txHead, _txCount;
+    uint8_t _rxFifo[CC1101_FIFO_SIZE];
+    uint8_t _rxHead, _rxCount;
+
+    // pending event (byte leaving Tx FIFO)
+    uint64_t _eventTime;
+
+    // packet currently on the air
+    EmulatedChip* _airSrc;
+    bool _airRx;
+
+    // sync word was sent or received and the packet did not end yet
+    bool _sync;
+
+    // transmission state
+    bool _txActive, _txCrc;
+    size_t _txSent;
+    uint8_t _txFirst;
+
+    // reception state
+    size_t _rxReceived;
+    uint8_t _rxFirst;
+    bool _rxComplete, _rxEnd, _rxCrcOk, _crcOk;
+
+    int16_t _rssi;
+
+    uint32_t _txPackets, _rxPackets, _txUnderflows, _rxOverflows;
+
+    uint8_t getStatus(bool read);
+    bool getGdo(uint8_t cfg);
+    uint8_t readRegister(uint8_t addr);
+    void writeRegister(uint8_t addr, uint8_t value);
+    void strobe(uint8_t cmd);
+    void enterState(uint8_t state);
+    void abortTx();
+    void abortRx();
+    EmulatorAir_t getAir();
+    uint64_t getByteTime();
+    size_t getHeaderLength();
+    bool frameEnd(size_t count, uint8_t first);
+
+    uint8_t rxFifoRead();
+    bool rxFifoWrite(uint8_t b);
+    void txStart();
+    void txByte();
+    void rxByte(uint8_t b);
+    void rxDone(bool crcOk);
+};
+
+#endif
+
+#endif
@@ -29,13 +29,13 @@ int16_t ESP8266::reset() {
   }
 
   // wait for the module to start
-  delay(2000);
+  Module::delay(2000);
 
   // test AT setup
-  uint32_t start = millis();
-  while (millis() - start < 3000) {
+  uint32_t start = Module::millis();
+  while (Module::millis() - start < 3000) {
     if(!_mod->ATsendCommand("AT")) {
-      delay(100);
+      Module::delay(100);
     } else {
       return(ERR_NONE);
     }
@@ -56,7 +56,10 @@ int16_t ESP8266::join(const char* ssid, const char* password) {
     char cmd[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
     uint8_t cmdLen = strlen(atStr) + strlen(ssid) + strlen(password) + 4;
-    char* cmd = new char[cmdLen + 1];
+    char* cmd = (char*)BufferPool::alloc(cmdLen + 1);
+    if(cmd == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(cmd, atStr);
   strcat(cmd, ssid);
@@ -67,7 +70,7 @@ int16_t ESP8266::join(const char* ssid, const char* password) {
   // send command
   bool res = _mod->ATsendCommand(cmd);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] cmd;
+    BufferPool::free(cmd);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -96,7 +99,10 @@ int16_t ESP8266::openTransportConnection(const char* host, const char* protocol,
   #ifdef RADIOLIB_STATIC_ONLY
     char cmd[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    char* cmd = new char[cmdLen + 1];
+    char* cmd = (char*)BufferPool::alloc(cmdLen + 1);
+    if(cmd == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(cmd, atStr);
   strcat(cmd, protocol);
@@ -112,7 +118,7 @@ int16_t ESP8266::openTransportConnection(const char* host, const char* protocol,
   // send command
   bool res = _mod->ATsendCommand(cmd);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] cmd;
+    BufferPool::free(cmd);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -137,7 +143,10 @@ int16_t ESP8266::send(const char* data) {
   #ifdef RADIOLIB_STATIC_ONLY
     char cmd[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    char* cmd = new char[strlen(atStr) + strlen(lenStr) + 1];
+    char* cmd = (char*)BufferPool::alloc(strlen(atStr) + strlen(lenStr) + 1);
+    if(cmd == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(cmd, atStr);
   strcat(cmd, lenStr);
@@ -145,7 +154,7 @@ int16_t ESP8266::send(const char* data) {
   // send command
   bool res = _mod->ATsendCommand(cmd);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] cmd;
+    BufferPool::free(cmd);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -167,7 +176,10 @@ int16_t ESP8266::send(uint8_t* data, uint32_t len) {
   #ifdef RADIOLIB_STATIC_ONLY
     char cmd[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    char* cmd = new char[strlen(atStr) + strlen(lenStr) + 1];
+    char* cmd = (char*)BufferPool::alloc(strlen(atStr) + strlen(lenStr) + 1);
+    if(cmd == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(cmd, atStr);
   strcat(cmd, lenStr);
@@ -175,7 +187,7 @@ int16_t ESP8266::send(uint8_t* data, uint32_t len) {
   // send command
   bool res = _mod->ATsendCommand(cmd);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] cmd;
+    BufferPool::free(cmd);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -191,10 +203,10 @@ int16_t ESP8266::send(uint8_t* data, uint32_t len) {
 
 size_t ESP8266::receive(uint8_t* data, size_t len, uint32_t timeout) {
   size_t i = 0;
-  uint32_t start = millis();
+  uint32_t start = Module::millis();
 
   // wait until the required number of bytes is received or until timeout
-  while((millis() - start < timeout) && (i < len)) {
+  while((Module::millis() - start < timeout) && (i < len)) {
     yield();
     while(_mod->ModuleSerial->available() > 0) {
       uint8_t b = _mod->ModuleSerial->read();
@@ -208,10 +220,10 @@ size_t ESP8266::receive(uint8_t* data, size_t len, uint32_t timeout) {
 
 size_t ESP8266::getNumBytes(uint32_t timeout, size_t minBytes) {
   // wait for available data
-  uint32_t start = millis();
+  uint32_t start = Module::millis();
   while(_mod->ModuleSerial->available() < (int16_t)minBytes) {
     yield();
-    if(millis() - start >= timeout) {
+    if(Module::millis() - start >= timeout) {
       return(0);
     }
   }
@@ -219,7 +231,7 @@ size_t ESP8266::getNumBytes(uint32_t timeout, size_t minBytes) {
   // read response
   char rawStr[20];
   uint8_t i = 0;
-  start = millis();
+  start = Module::millis();
   while(_mod->ModuleSerial->available() > 0) {
     yield();
     char c = _mod->ModuleSerial->read();
@@ -228,7 +240,7 @@ size_t ESP8266::getNumBytes(uint32_t timeout, size_t minBytes) {
       rawStr[i++] = 0;
       break;
     }
-    if(millis() - start >= timeout) {
+    if(Module::millis() - start >= timeout) {
       rawStr[i++] = 0;
       break;
     }
@@ -2,6 +2,7 @@
 #define _RADIOLIB_ESP8266_H
 
 #include "../../Module.h"
+#include "../../BufferPool.h"
 
 #include "../../protocols/TransportLayer/TransportLayer.h"
 
@@ -6,6 +6,16 @@ RF69::RF69(Module* module) : PhysicalLayer(RF69_FREQUENCY_STEP_SIZE, RF69_MAX_PA
 
   _packetLengthQueried = false;
   _packetLengthConfig = RF69_PACKET_FORMAT_VARIABLE;
+  _payloadLength = RF69_MAX_PACKET_LENGTH;
+
+  _fifoTxEnd = false;
+  _fifoRxData = NULL;
+  _fifoRxSize = 0;
+  _fifoLen = 0;
+  _fifoPos = 0;
+  _fifoHeaderLen = 0;
+  _fifoRxActive = false;
+  _fifoEvents = RADIOLIB_EVENT_NONE;
 
   _promiscuous = false;
 
@@ -13,9 +23,17 @@ RF69::RF69(Module* module) : PhysicalLayer(RF69_FREQUENCY_STEP_SIZE, RF69_MAX_PA
 }
 
 int16_t RF69::begin(float freq, float br, float freqDev, float rxBw, int8_t power) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
+  _mod->SPIvolatileRegs = RF69VolatileRegs;
+  _mod->SPIvolatileRegsLen = sizeof(RF69VolatileRegs);
+  _mod->SPIslowRegs = RF69SlowRegs;
+  _mod->SPIslowRegsLen = sizeof(RF69SlowRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
+  Module::pinMode(_mod->getGpio(), INPUT);
 
   // try to find the RF69 chip
   uint8_t i = 0;
@@ -40,7 +58,7 @@ int16_t RF69::begin(float freq, float br, float freqDev, float rxBw, int8_t powe
         RADIOLIB_DEBUG_PRINT(F(", expected 0x0024"));
         RADIOLIB_DEBUG_PRINTLN();
       #endif
-      delay(1000);
+      Module::delay(1000);
       i++;
     }
   }
@@ -101,29 +119,44 @@ int16_t RF69::begin(float freq, float br, float freqDev, float rxBw, int8_t powe
 void RF69::reset() {
   Module::pinMode(_mod->getRst(), OUTPUT);
   Module::digitalWrite(_mod->getRst(), HIGH);
-  delay(1);
+  Module::delay(1);
   Module::digitalWrite(_mod->getRst(), LOW);
-  delay(10);
+  Module::delay(10);
 }
 
 int16_t RF69::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(transmit(&seg, 1, addr));
+}
+
+int16_t RF69::transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // calculate timeout (5ms + 500 % of expected time-on-air)
   uint32_t timeout = 5000000 + (uint32_t)((((float)(len * 8)) / (_br * 1000.0)) * 5000000.0);
 
   // start transmission
-  int16_t state = startTransmit(data, len, addr);
+  int16_t state = startTransmit(segs, numSegs, addr);
   RADIOLIB_ASSERT(state);
 
-  // wait for transmission end or timeout
-  uint32_t start = micros();
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-
-    if(micros() - start > timeout) {
-      standby();
-      clearIRQFlags();
-      return(ERR_TX_TIMEOUT);
+  // wait for transmission end or timeout, unlimited length packet is refilled and ended by serviceFifo
+  // whenever DIO1 drops (FIFO level below the threshold, then FIFO empty after the last byte was written)
+  uint32_t timeoutMs = timeout / 1000 + 1;
+  bool sent = true;
+  if(isUnlimited()) {
+    uint32_t start = Module::millis();
+    while(sent && !serviceFifo()) {
+      uint32_t elapsed = Module::millis() - start;
+      sent = (elapsed < timeoutMs) && Module::waitForPin(_mod->getGpio(), LOW, timeoutMs - elapsed);
     }
+  } else {
+    sent = Module::waitForPin(_mod->getIrq(), HIGH, timeoutMs);
+  }
+  if(!sent) {
+    standby();
+    clearIRQFlags();
+    return(ERR_TX_TIMEOUT);
   }
 
   // set mode to standby
@@ -136,23 +169,41 @@ int16_t RF69::transmit(uint8_t* data, size_t len, uint8_t addr) {
 }
 
 int16_t RF69::receive(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
+
   // calculate timeout (500 ms + 400 full 64-byte packets at current bit rate)
   uint32_t timeout = 500000 + (1.0/(_br*1000.0))*(RF69_MAX_PACKET_LENGTH*400.0);
 
-  // start reception
-  int16_t state = startReceive();
+  // start reception, unlimited length packet is drained from FIFO while it is being received
+  bool unlimited = isUnlimited();
+  int16_t state = ERR_NONE;
+  if(unlimited) {
+    // add 500 % of time-on-air of the whole buffer
+    timeout += (uint32_t)((((float)(len * 8)) / (_br * 1000.0)) * 5000000.0);
+    state = startReceiveStream(data, len);
+  } else {
+    state = startReceive();
+  }
   RADIOLIB_ASSERT(state);
 
-  // wait for packet reception or timeout
-  uint32_t start = micros();
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-
-    if(micros() - start > timeout) {
-      standby();
-      clearIRQFlags();
-      return(ERR_RX_TIMEOUT);
+  // wait for packet reception or timeout, unlimited length packet is drained by serviceFifo whenever FIFO level exceeds the threshold (DIO1 high)
+  uint32_t timeoutMs = timeout / 1000 + 1;
+  bool received = true;
+  if(unlimited) {
+    uint32_t start = Module::millis();
+    while(received && !serviceFifo()) {
+      uint32_t elapsed = Module::millis() - start;
+      received = (elapsed < timeoutMs) && Module::waitForPin(_mod->getGpio(), HIGH, timeoutMs - elapsed);
     }
+  } else {
+    received = Module::waitForPin(_mod->getIrq(), HIGH, timeoutMs);
+  }
+  if(!received) {
+    standby();
+    clearIRQFlags();
+    _fifoRxData = NULL;
+    _fifoRxActive = false;
+    return(ERR_RX_TIMEOUT);
   }
 
   // read packet data
@@ -165,6 +216,8 @@ int16_t RF69::sleep() {
 }
 
 int16_t RF69::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   // set module to standby
   return(setMode(RF69_STANDBY));
 }
@@ -226,6 +279,15 @@ int16_t RF69::disableAES() {
 }
 
 int16_t RF69::startReceive() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
+  // drop any packet that was being streamed
+  _fifoTx.clear();
+  _fifoTxEnd = false;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+  _fifoEvents = RADIOLIB_EVENT_NONE;
+
   // set mode to standby
   int16_t state = setMode(RF69_STANDBY);
 
@@ -249,62 +311,184 @@ int16_t RF69::startReceive() {
   return(state);
 }
 
+int16_t RF69::startReceiveStream(uint8_t* data, size_t len) {
+  // packets in other modes always fit into FIFO
+  if(!isUnlimited()) {
+    return(ERR_WRONG_MODEM);
+  }
+
+  // FIFO level is first set once the header with packet length was received
+  uint8_t headerLen = getAddressLength() + 2;
+  _mod->SPIwriteRegister(RF69_REG_FIFO_THRESH, RF69_TX_START_CONDITION_FIFO_NOT_EMPTY | (headerLen - 1));
+
+  int16_t state = startReceive();
+  RADIOLIB_ASSERT(state);
+
+  _fifoRxData = data;
+  _fifoRxSize = len;
+  _fifoLen = 0;
+  _fifoPos = 0;
+  _fifoHeaderLen = headerLen;
+  _fifoRxActive = true;
+  return(state);
+}
+
+bool RF69::serviceFifo() {
+  if(_fifoTx.isActive()) {
+    // refill only after FIFO level dropped to the threshold, so that the whole chunk fits
+    if(_mod->SPIreadRegister(RF69_REG_IRQ_FLAGS_2) & RF69_IRQ_FIFO_LEVEL) {
+      return(false);
+    }
+    writeFifo(RF69_FIFO_CHUNK_SIZE);
+    if(_fifoTx.isActive()) {
+      return(false);
+    }
+  }
+
+  if(_fifoTxEnd) {
+    // the chip does not signal the end of unlimited length packet, it was sent once FIFO is empty
+    if(_mod->SPIreadRegister(RF69_REG_IRQ_FLAGS_2) & RF69_IRQ_FIFO_NOT_EMPTY) {
+      return(false);
+    }
+    setMode(RF69_STANDBY);
+    _fifoTxEnd = false;
+    _fifoEvents = RADIOLIB_EVENT_TX_DONE;
+  }
+
+  // FIFO level is only set once the next chunk (or the rest of the packet) is in FIFO, the threshold may change after each one
+  while(_fifoRxActive && (_mod->SPIreadRegister(RF69_REG_IRQ_FLAGS_2) & RF69_IRQ_FIFO_LEVEL)) {
+    drainFifo();
+  }
+  return(!_fifoRxActive);
+}
+
+void RF69::setFifoAction(void (*func)(void)) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
+    return;
+  }
+  Module::pinMode(_mod->getGpio(), INPUT);
+  Module::attachInterrupt(_mod->getGpio(), func, CHANGE);
+}
+
 void RF69::setDio0Action(void (*func)(void)) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, RISING);
+  Module::attachInterrupt(_mod->getIrq(), func, RISING);
 }
 
 void RF69::clearDio0Action() {
-  detachInterrupt(digitalPinToInterrupt(_mod->getIrq()));
+  Module::detachInterrupt(_mod->getIrq());
 }
 
 void RF69::setDio1Action(void (*func)(void)) {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
   Module::pinMode(_mod->getGpio(), INPUT);
-  attachInterrupt(digitalPinToInterrupt(_mod->getGpio()), func, RISING);
+  Module::attachInterrupt(_mod->getGpio(), func, RISING);
 }
 
 void RF69::clearDio1Action() {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
-  detachInterrupt(digitalPinToInterrupt(_mod->getGpio()));
+  Module::detachInterrupt(_mod->getGpio());
+}
+
+bool RF69::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source == 0) && (_mod->getIrq() != RADIOLIB_NC)) {
+    if(func == NULL) {
+      clearDio0Action();
+    } else {
+      setDio0Action(func);
+    }
+    return(true);
+  } else if((source == 1) && (_mod->getGpio() != RADIOLIB_NC)) {
+    if(func == NULL) {
+      clearDio1Action();
+    } else {
+      setDio1Action(func);
+    }
+    return(true);
+  }
+  return(false);
+}
+
+uint16_t RF69::getEvents() {
+  // keep unlimited length packets moving when the operation is polled, only serviceFifo knows when they end
+  serviceFifo();
+  uint16_t events = _fifoEvents;
+
+  // payload ready is only set for packets that passed CRC check
+  uint8_t flags1 = _mod->SPIreadRegister(RF69_REG_IRQ_FLAGS_1);
+  uint8_t flags2 = _mod->SPIreadRegister(RF69_REG_IRQ_FLAGS_2);
+  if(flags2 & RF69_IRQ_PACKET_SENT) {
+    events |= RADIOLIB_EVENT_TX_DONE;
+  }
+  if(flags2 & RF69_IRQ_PAYLOAD_READY) {
+    events |= RADIOLIB_EVENT_RX_DONE;
+  }
+  if(flags1 & RF69_SYNC_ADDRESS_MATCH) {
+    events |= RADIOLIB_EVENT_SYNC_WORD;
+  }
+  if(flags1 & RF69_IRQ_TIMEOUT) {
+    events |= RADIOLIB_EVENT_TIMEOUT;
+  }
+  return(events);
 }
 
 int16_t RF69::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(startTransmit(&seg, 1, addr));
+}
+
+int16_t RF69::startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // check packet length
-  if(len > RF69_MAX_PACKET_LENGTH) {
+  bool unlimited = isUnlimited();
+  if(len > (unlimited ? RF69_MAX_PACKET_LENGTH_UNLIMITED : RF69_MAX_PACKET_LENGTH)) {
     return(ERR_PACKET_TOO_LONG);
   }
 
+  // drop any packet that was being streamed, segment descriptors are copied because unlimited length packet is written after this method returns
+  if(_fifoTx.set(segs, numSegs) != ERR_NONE) {
+    return(ERR_TOO_MANY_SEGMENTS);
+  }
+  _fifoTxEnd = false;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+  _fifoEvents = RADIOLIB_EVENT_NONE;
+
   // set mode to standby
   int16_t state = setMode(RF69_STANDBY);
   RADIOLIB_ASSERT(state);
 
-  // set DIO pin mapping
-  state = _mod->SPIsetRegValue(RF69_REG_DIO_MAPPING_1, RF69_DIO0_PACK_PACKET_SENT, 7, 6);
+  // set DIO pin mapping, FIFO level signals that unlimited length packet needs more data
+  state = _mod->SPIsetRegValue(RF69_REG_DIO_MAPPING_1, RF69_DIO0_PACK_PACKET_SENT | RF69_DIO1_PACK_FIFO_LEVEL, 7, 4);
   RADIOLIB_ASSERT(state);
 
   // clear interrupt flags
   clearIRQFlags();
 
-  // set packet length
-  _mod->SPIwriteRegister(RF69_REG_FIFO, len);
-
   // optionally write packet length
-  if (_packetLengthConfig == RF69_PACKET_FORMAT_VARIABLE) {
+  if(_packetLengthConfig == RF69_PACKET_FORMAT_VARIABLE) {
     _mod->SPIwriteRegister(RF69_REG_FIFO, len);
   }
 
   // check address filtering
-  uint8_t filter = _mod->SPIgetRegValue(RF69_REG_PACKET_CONFIG_1, 2, 1);
-  if((filter == RF69_ADDRESS_FILTERING_NODE) || (filter == RF69_ADDRESS_FILTERING_NODE_BROADCAST)) {
+  if(getAddressLength() > 0) {
     _mod->SPIwriteRegister(RF69_REG_FIFO, addr);
   }
 
-  // write packet to FIFO
-  _mod->SPIwriteRegisterBurst(RF69_REG_FIFO, data, len);
+  // unlimited length packet starts with its length, FIFO threshold may have been changed by the last reception
+  if(unlimited) {
+    uint8_t header[] = { (uint8_t)(len >> 8), (uint8_t)(len & 0xFF) };
+    _mod->SPIwriteRegisterBurst(RF69_REG_FIFO, header, 2);
+    _mod->SPIwriteRegister(RF69_REG_FIFO_THRESH, RF69_TX_START_CONDITION_FIFO_NOT_EMPTY | RF69_FIFO_THRESHOLD);
+  }
+
+  // write as much of the packet as fits into FIFO, the rest is written by serviceFifo
+  writeFifo(unlimited ? RF69_MAX_PACKET_LENGTH - 2 : RF69_MAX_PACKET_LENGTH);
 
   // enable +20 dBm operation
   if(_power > 17) {
@@ -320,10 +504,44 @@ int16_t RF69::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   return(state);
 }
 
+int16_t RF69::finishTransmit() {
+  // set mode to standby
+  int16_t state = standby();
+
+  // clear interrupt flags
+  clearIRQFlags();
+  return(state);
+}
+
 int16_t RF69::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
+
+  // streamed packet is already in the stream buffer
+  if(_fifoRxData != NULL) {
+    // packet that was not received completely is dropped
+    bool complete = !_fifoRxActive;
+    size_t length = len;
+    if((len == 0) || (len > _fifoLen)) {
+      length = _fifoLen;
+    }
+    if(length > _fifoRxSize) {
+      length = _fifoRxSize;
+    }
+    if(complete && (data != _fifoRxData)) {
+      memcpy(data, _fifoRxData, length);
+    }
+    _packetLength = _fifoLen;
+    _fifoRxData = NULL;
+    _fifoRxActive = false;
+    _fifoEvents = RADIOLIB_EVENT_NONE;
+    clearIRQFlags();
+    return(complete ? ERR_NONE : ERR_RX_TIMEOUT);
+  }
+
   // get packet length
   size_t length = len;
   if(len == RF69_MAX_PACKET_LENGTH) {
@@ -331,8 +549,7 @@ int16_t RF69::readData(uint8_t* data, size_t len) {
   }
 
   // check address filtering
-  uint8_t filter = _mod->SPIgetRegValue(RF69_REG_PACKET_CONFIG_1, 2, 1);
-  if((filter == RF69_ADDRESS_FILTERING_NODE) || (filter == RF69_ADDRESS_FILTERING_NODE_BROADCAST)) {
+  if(getAddressLength() > 0) {
     _mod->SPIreadRegister(RF69_REG_FIFO);
   }
 
@@ -361,9 +578,11 @@ int16_t RF69::setFrequency(float freq) {
 
   //set carrier frequency
   uint32_t FRF = (freq * (uint32_t(1) << RF69_DIV_EXPONENT)) / RF69_CRYSTAL_FREQ;
+  _mod->SPIbeginBatch();
   int16_t state = _mod->SPIsetRegValue(RF69_REG_FRF_MSB, (FRF & 0xFF0000) >> 16, 7, 0);
   state |= _mod->SPIsetRegValue(RF69_REG_FRF_MID, (FRF & 0x00FF00) >> 8, 7, 0);
   state |= _mod->SPIsetRegValue(RF69_REG_FRF_LSB, FRF & 0x0000FF, 7, 0);
+  state |= _mod->SPIcommitBatch();
 
   return(state);
 }
@@ -381,8 +600,10 @@ int16_t RF69::setBitRate(float br) {
 
   // set bit rate
   uint16_t bitRate = 32000 / br;
+  _mod->SPIbeginBatch();
   int16_t state = _mod->SPIsetRegValue(RF69_REG_BITRATE_MSB, (bitRate & 0xFF00) >> 8, 7, 0);
   state |= _mod->SPIsetRegValue(RF69_REG_BITRATE_LSB, bitRate & 0x00FF, 7, 0);
+  state |= _mod->SPIcommitBatch();
   if(state == ERR_NONE) {
     RF69::_br = br;
   }
@@ -608,7 +829,7 @@ int16_t RF69::getTemperature() {
   // wait until measurement is finished
   while(_mod->SPIgetRegValue(RF69_REG_TEMP_1, 2, 2) == RF69_TEMP_MEAS_RUNNING) {
     // check every 10 us
-    delay(10);
+    Module::delay(10);
   }
   int8_t rawTemp = _mod->SPIgetRegValue(RF69_REG_TEMP_2);
 
@@ -616,6 +837,13 @@ int16_t RF69::getTemperature() {
 }
 
 size_t RF69::getPacketLength(bool update) {
+  // length of unlimited length packet is in its header
+  if(_fifoRxData != NULL) {
+    return(_fifoLen);
+  } else if(isUnlimited()) {
+    return(_packetLength);
+  }
+
   if(!_packetLengthQueried && update) {
     if (_packetLengthConfig == RF69_PACKET_FORMAT_VARIABLE) {
       _packetLength = _mod->SPIreadRegister(RF69_REG_FIFO);
@@ -636,6 +864,11 @@ int16_t RF69::variablePacketLengthMode(uint8_t maxLen) {
   return(setPacketMode(RF69_PACKET_FORMAT_VARIABLE, maxLen));
 }
 
+int16_t RF69::unlimitedPacketLengthMode() {
+  // fixed packet length of 0 means unlimited length
+  return(setPacketMode(RF69_PACKET_FORMAT_FIXED, 0));
+}
+
 int16_t RF69::enableSyncWordFiltering(uint8_t maxErrBits) {
   // enable sync word recognition
   return(_mod->SPIsetRegValue(RF69_REG_SYNC_CONFIG, RF69_SYNC_ON | RF69_FIFO_FILL_CONDITION_SYNC | (_syncWordLength - 1) << 3 | maxErrBits, 7, 0));
@@ -800,8 +1033,9 @@ int16_t RF69::setPacketMode(uint8_t mode, uint8_t len) {
   state = _mod->SPIsetRegValue(RF69_REG_PAYLOAD_LENGTH, len);
   RADIOLIB_ASSERT(state);
 
-  // update the cached value
+  // update the cached values
   _packetLengthConfig = mode;
+  _payloadLength = len;
   return(state);
 }
 
@@ -813,3 +1047,81 @@ void RF69::clearIRQFlags() {
   _mod->SPIwriteRegister(RF69_REG_IRQ_FLAGS_1, 0b11111111);
   _mod->SPIwriteRegister(RF69_REG_IRQ_FLAGS_2, 0b11111111);
 }
+
+bool RF69::isUnlimited() {
+  return((_packetLengthConfig == RF69_PACKET_FORMAT_FIXED) && (_payloadLength == 0));
+}
+
+void RF69::writeFifo(size_t count) {
+  size_t len = 0;
+  uint8_t* data = _fifoTx.next(count, &len);
+  while(data != NULL) {
+    _mod->SPIwriteRegisterBurst(RF69_REG_FIFO, data, len);
+    count -= len;
+    data = _fifoTx.next(count, &len);
+  }
+
+  if(_fifoTx.isActive()) {
+    return;
+  }
+
+  // unlimited length packet is followed by one padding byte, so its last byte was sent once FIFO is empty
+  if(isUnlimited()) {
+    _mod->SPIwriteRegister(RF69_REG_FIFO, 0x00);
+    _mod->SPIsetRegValue(RF69_REG_DIO_MAPPING_1, RF69_DIO1_PACK_FIFO_NOT_EMPTY, 5, 4);
+    _fifoTxEnd = true;
+  }
+}
+
+void RF69::drainFifo() {
+  if(_fifoHeaderLen > 0) {
+    // address byte is dropped, packet length is in the last two bytes of the header
+    uint8_t header[3];
+    _mod->SPIreadRegisterBurst(RF69_REG_FIFO, _fifoHeaderLen, header);
+    _fifoLen = ((size_t)header[_fifoHeaderLen - 2] << 8) | header[_fifoHeaderLen - 1];
+    _fifoHeaderLen = 0;
+
+  } else {
+    size_t count = _fifoLen - _fifoPos;
+    if(count > RF69_FIFO_CHUNK_SIZE) {
+      count = RF69_FIFO_CHUNK_SIZE;
+    }
+
+    // bytes that do not fit into the buffer are dumped
+    size_t len = 0;
+    if(_fifoPos < _fifoRxSize) {
+      len = _fifoRxSize - _fifoPos;
+      if(len > count) {
+        len = count;
+      }
+      _mod->SPIreadRegisterBurst(RF69_REG_FIFO, len, &_fifoRxData[_fifoPos]);
+    }
+    for(size_t i = len; i < count; i++) {
+      _mod->SPIreadRegister(RF69_REG_FIFO);
+    }
+    _fifoPos += count;
+  }
+
+  // the chip would keep receiving after the end of the packet
+  size_t remaining = _fifoLen - _fifoPos;
+  if(remaining == 0) {
+    setMode(RF69_STANDBY);
+    _fifoRxActive = false;
+    _fifoEvents = RADIOLIB_EVENT_RX_DONE;
+    return;
+  }
+
+  // FIFO level is set once the next chunk, or the rest of the packet is in FIFO
+  if(remaining > RF69_FIFO_CHUNK_SIZE) {
+    remaining = RF69_FIFO_CHUNK_SIZE;
+  }
+  _mod->SPIwriteRegister(RF69_REG_FIFO_THRESH, RF69_TX_START_CONDITION_FIFO_NOT_EMPTY | (remaining - 1));
+}
+
+uint8_t RF69::getAddressLength() {
+  uint8_t filter = _mod->SPIgetRegValue(RF69_REG_PACKET_CONFIG_1, 2, 1);
+  if((filter == RF69_ADDRESS_FILTERING_NODE) || (filter == RF69_ADDRESS_FILTERING_NODE_BROADCAST)) {
+    return(1);
+  }
+  return(0);
+}
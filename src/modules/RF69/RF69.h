@@ -9,6 +9,8 @@
 // RF69 physical layer properties
 #define RF69_FREQUENCY_STEP_SIZE                      61.03515625
 #define RF69_MAX_PACKET_LENGTH                        64
+#define RF69_MAX_PACKET_LENGTH_UNLIMITED              65535
+#define RF69_FIFO_CHUNK_SIZE                          32
 #define RF69_CRYSTAL_FREQ                             32.0
 #define RF69_DIV_EXPONENT                             19
 
@@ -393,7 +395,7 @@
 // RF69_REG_FIFO_THRESH
 #define RF69_TX_START_CONDITION_FIFO_LEVEL            0b00000000  //  7     7     packet transmission start condition: FifoLevel
 #define RF69_TX_START_CONDITION_FIFO_NOT_EMPTY        0b10000000  //  7     7                                          FifoNotEmpty (default)
-#define RF69_FIFO_THRESHOLD                           0b00001111  //  6     0     default threshold to trigger FifoLevel interrupt
+#define RF69_FIFO_THRESHOLD                           0b00011111  //  6     0     default threshold to trigger FifoLevel interrupt (one byte less than RF69_FIFO_CHUNK_SIZE)
 
 // RF69_REG_PACKET_CONFIG_2
 #define RF69_INTER_PACKET_RX_DELAY                    0b00000000  //  7     4     delay between FIFO empty and start of new RSSI phase
@@ -421,6 +423,19 @@
 #define RF69_PA2_NORMAL                               0x70        //  7     0     PA_BOOST: none
 #define RF69_PA2_20_DBM                               0x7C        //  7     0               +20 dBm
 
+// RF69 registers that are never served from register cache
+static const uint8_t RF69VolatileRegs[] PROGMEM = {
+  RF69_REG_FIFO, RF69_REG_OP_MODE, RF69_REG_OSC_1, RF69_REG_AFC_FEI,
+  RF69_REG_AFC_MSB, RF69_REG_AFC_LSB, RF69_REG_FEI_MSB, RF69_REG_FEI_LSB,
+  RF69_REG_RSSI_CONFIG, RF69_REG_RSSI_VALUE, RF69_REG_IRQ_FLAGS_1, RF69_REG_IRQ_FLAGS_2,
+  RF69_REG_PACKET_CONFIG_2, RF69_REG_TEMP_1, RF69_REG_TEMP_2
+};
+
+// RF69 registers that need some time to process the change after being written
+static const uint8_t RF69SlowRegs[] PROGMEM = {
+  RF69_REG_OP_MODE
+};
+
 /*!
   \class RF69
 
@@ -479,6 +494,19 @@ class RF69: public PhysicalLayer {
     */
     int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Blocking scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Address to send the data to. Will only be added if address filtering was enabled.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
     /*!
       \brief Blocking binary receive method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -575,9 +603,28 @@ class RF69: public PhysicalLayer {
     */
     void clearDio1Action();
 
+    /*!
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is DIO0, source 1 is DIO1.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
     /*!
       \brief Interrupt-driven binary transmit method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
+      In unlimited packet length mode, data must stay valid until the transmission is finished, the rest of the packet is written by RF69::serviceFifo.
 
       \param data Binary data to be sent.
 
@@ -589,6 +636,27 @@ class RF69: public PhysicalLayer {
     */
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Interrupt-driven scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+      Segment descriptors are copied (see TxSegmentStream), in unlimited packet length mode the data they point to must stay valid until the transmission is finished.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments, at most RADIOLIB_TX_SEGMENTS_MAX.
+
+      \param addr Address to send the data to. Will only be added if address filtering was enabled.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - sets module to standby and clears IRQ flags.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
     /*!
       \brief Interrupt-driven receive method. GDO0 will be activated when full packet is received.
 
@@ -596,8 +664,38 @@ class RF69: public PhysicalLayer {
     */
     int16_t startReceive();
 
+    /*!
+      \brief Interrupt-driven receive method for packets in unlimited packet length mode. Received bytes are drained from FIFO into the buffer
+      by RF69::serviceFifo while the packet is being received. The chip does not signal the end of the packet, reception stops once
+      all bytes announced in the length header were received and serviceFifo returns true.
+
+      \param data Buffer to save the received packet to, must stay valid until the packet is read. Bytes that do not fit into it are dropped.
+
+      \param len Size of the buffer.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceiveStream(uint8_t* data, size_t len);
+
+    /*!
+      \brief Moves the next chunk of unlimited length packet between FIFO and user buffer: refills FIFO during transmission started by startTransmit,
+      or drains it during reception started by startReceiveStream. Must be called whenever FIFO level crosses the threshold, either from interrupt service routine
+      set by setFifoAction or by polling it often enough, but not from both. Blocking transmit and receive methods call it on their own.
+
+      \returns True when there is nothing left to do (the whole packet was sent or received and the module is in standby), false otherwise.
+    */
+    bool serviceFifo();
+
+    /*!
+      \brief Sets interrupt service routine to call when FIFO level crosses the threshold (DIO1 on both edges). The function should call RF69::serviceFifo.
+
+      \param func ISR to call.
+    */
+    void setFifoAction(void (*func)(void));
+
     /*!
       \brief Reads data received after calling startReceive method.
+      When the packet was received by startReceiveStream, it is already in the stream buffer and is only copied to data, if it is a different buffer.
 
       \param data Pointer to array to save the received binary data.
 
@@ -735,6 +833,15 @@ class RF69: public PhysicalLayer {
     */
     int16_t variablePacketLengthMode(uint8_t maxLen = RF69_MAX_PACKET_LENGTH);
 
+    /*!
+      \brief Set modem in unlimited packet length mode. Packets of up to RF69_MAX_PACKET_LENGTH_UNLIMITED bytes are streamed through FIFO by RF69::serviceFifo,
+      packet length is sent in 2-byte header (after the address byte, if address filtering is enabled). The chip does not check CRC of unlimited length packets,
+      and AES encryption can not be used.
+
+      \returns \ref status_codes
+    */
+    int16_t unlimitedPacketLengthMode();
+
      /*!
       \brief Enable sync word filtering and generation.
 
@@ -808,6 +915,18 @@ class RF69: public PhysicalLayer {
     size_t _packetLength;
     bool _packetLengthQueried;
     uint8_t _packetLengthConfig;
+    uint8_t _payloadLength; // fixed packet length or maximum packet length in variable mode, 0 in unlimited mode
+
+    // unlimited length packets are streamed through FIFO by serviceFifo
+    TxSegmentStream _fifoTx;
+    bool _fifoTxEnd;
+    uint8_t* _fifoRxData;
+    size_t _fifoRxSize;
+    size_t _fifoLen;
+    size_t _fifoPos;
+    uint8_t _fifoHeaderLen;
+    bool _fifoRxActive;
+    uint16_t _fifoEvents;
 
     bool _promiscuous;
 
@@ -822,6 +941,10 @@ class RF69: public PhysicalLayer {
 #endif
     int16_t setMode(uint8_t mode);
     void clearIRQFlags();
+    bool isUnlimited();
+    void writeFifo(size_t count);
+    void drainFifo();
+    uint8_t getAddressLength();
 };
 
 #endif
@@ -0,0 +1,574 @@
+#include "RF69Emulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+RF69Emulator::RF69Emulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE dio0, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE dio1, uint8_t version) : EmulatedChip(cs) {
+  _dio0 = dio0;
+  _dio1 = dio1;
+  _rst = rst;
+  _version = version;
+  _inReset = false;
+  _txActive = false;
+  _rssi = RF69_EMULATOR_RSSI_DEFAULT;
+  reset();
+}
+
+void RF69Emulator::reset() {
+  abortTx();
+  memset(_regs, 0x00, sizeof(_regs));
+  memset(_fifo, 0x00, sizeof(_fifo));
+
+  _regs[RF69_REG_OP_MODE] = RF69_STANDBY;
+  _regs[RF69_REG_BITRATE_MSB] = RF69_BITRATE_MSB;
+  _regs[RF69_REG_BITRATE_LSB] = RF69_BITRATE_LSB;
+  _regs[RF69_REG_FDEV_LSB] = RF69_FDEV_LSB;
+  _regs[RF69_REG_FRF_MSB] = RF69_FRF_MSB;
+  _regs[RF69_REG_FRF_MID] = RF69_FRF_MID;
+  _regs[RF69_REG_OSC_1] = 0x41;
+  _regs[RF69_REG_LISTEN_1] = 0x92;
+  _regs[RF69_REG_LISTEN_2] = 0xF5;
+  _regs[RF69_REG_LISTEN_3] = 0x20;
+  _regs[RF69_REG_VERSION] = _version;
+  _regs[RF69_REG_PA_LEVEL] = 0x9F;
+  _regs[RF69_REG_PA_RAMP] = 0x09;
+  _regs[RF69_REG_OCP] = 0x1A;
+  _regs[RF69_REG_LNA] = 0x08;
+  _regs[RF69_REG_RX_BW] = 0x86;
+  _regs[RF69_REG_AFC_BW] = 0x8A;
+  _regs[RF69_REG_OOK_PEAK] = 0x40;
+  _regs[RF69_REG_OOK_AVG] = 0x80;
+  _regs[RF69_REG_OOK_FIX] = 0x06;
+  _regs[RF69_REG_AFC_FEI] = 0x10;
+  _regs[RF69_REG_RSSI_CONFIG] = 0x02;
+  _regs[RF69_REG_DIO_MAPPING_2] = 0x05;
+  _regs[RF69_REG_RSSI_THRESH] = 0xFF;
+  _regs[RF69_REG_PREAMBLE_LSB] = RF69_PREAMBLE_LSB;
+  _regs[RF69_REG_SYNC_CONFIG] = 0x98;
+  for(uint8_t i = RF69_REG_SYNC_VALUE_1; i <= RF69_REG_SYNC_VALUE_8; i++) {
+    _regs[i] = 0x01;
+  }
+  _regs[RF69_REG_PACKET_CONFIG_1] = 0x10;
+  _regs[RF69_REG_PAYLOAD_LENGTH] = 0x40;
+  _regs[RF69_REG_FIFO_THRESH] = 0x0F;
+  _regs[RF69_REG_PACKET_CONFIG_2] = 0x02;
+  _regs[RF69_REG_TEST_PA1] = RF69_PA1_NORMAL;
+  _regs[RF69_REG_TEST_PA2] = RF69_PA2_NORMAL;
+
+  _fifoHead = 0;
+  _fifoCount = 0;
+  _flags1 = 0;
+  _flags2 = 0;
+  _eventTime = UINT64_MAX;
+  _airSrc = NULL;
+  _airRx = false;
+  _txActive = false;
+  _txStall = false;
+  _txCrc = false;
+  _txFrameLen = 0;
+  _txSent = 0;
+  _rxFrameLen = 0;
+  _rxCount = 0;
+  _txPackets = 0;
+  _rxPackets = 0;
+  _txUnderruns = 0;
+  _rxOverruns = 0;
+}
+
+bool RF69Emulator::injectPacket(const uint8_t* data, size_t len, bool crcError) {
+  if(_inReset || (getMode() != RF69_RX)) {
+    return(false);
+  }
+
+  // add length byte in variable length mode
+  _rxCount = 0;
+  _rxFrameLen = 0;
+  if(_regs[RF69_REG_PACKET_CONFIG_1] & RF69_PACKET_FORMAT_VARIABLE) {
+    rxByte((uint8_t)len);
+  }
+  for(size_t i = 0; i < len; i++) {
+    rxByte(data[i]);
+  }
+  rxDone(!crcError);
+  return(true);
+}
+
+void RF69Emulator::setSignal(int16_t rssi) {
+  _rssi = rssi;
+}
+
+uint64_t RF69Emulator::getTimeOnAir(size_t len) {
+  // preamble, sync word, length byte, payload and CRC (unlimited length packet has none)
+  size_t bytes = ((uint16_t)_regs[RF69_REG_PREAMBLE_MSB] << 8) | _regs[RF69_REG_PREAMBLE_LSB];
+  if(_regs[RF69_REG_SYNC_CONFIG] & RF69_SYNC_ON) {
+    bytes += ((_regs[RF69_REG_SYNC_CONFIG] >> 3) & 0x07) + 1;
+  }
+  if(_regs[RF69_REG_PACKET_CONFIG_1] & RF69_PACKET_FORMAT_VARIABLE) {
+    bytes++;
+  }
+  if((_regs[RF69_REG_PACKET_CONFIG_1] & RF69_CRC_ON) && !isUnlimited()) {
+    bytes += 2;
+  }
+  return((uint64_t)(bytes + len) * getByteTime());
+}
+
+uint8_t RF69Emulator::getRegister(uint8_t addr) {
+  addr &= 0x7F;
+  if((addr == RF69_REG_IRQ_FLAGS_1) || (addr == RF69_REG_IRQ_FLAGS_2)) {
+    return(readRegister(addr));
+  }
+  return(_regs[addr]);
+}
+
+void RF69Emulator::spiTransfer(uint8_t* buff, size_t len) {
+  if(_inReset || (len < 1)) {
+    return;
+  }
+
+  // first byte is address with write flag, burst access auto-increments address except for FIFO
+  bool write = buff[0] & 0x80;
+  uint8_t addr = buff[0] & 0x7F;
+  buff[0] = 0x00;
+  for(size_t i = 1; i < len; i++) {
+    if(write) {
+      writeRegister(addr, buff[i]);
+    } else {
+      buff[i] = readRegister(addr);
+    }
+    if(addr != RF69_REG_FIFO) {
+      addr = (addr + 1) & 0x7F;
+    }
+  }
+}
+
+bool RF69Emulator::readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+  if((pin == RADIOLIB_NC) || ((pin != _dio0) && (pin != _dio1))) {
+    return(false);
+  }
+
+  bool active = false;
+  uint8_t mode = getMode();
+  uint8_t flags1 = readRegister(RF69_REG_IRQ_FLAGS_1);
+  uint8_t flags2 = getIrqFlags2();
+  uint8_t map = _regs[RF69_REG_DIO_MAPPING_1];
+  if(_inReset) {
+    active = false;
+
+  } else if(pin == _dio0) {
+    // DIO0 mapping depends on the mode
+    uint8_t dio0 = (map >> 6) & 0x03;
+    if(mode == RF69_TX) {
+      const uint8_t txFlags[] = { RF69_IRQ_PACKET_SENT, 0, 0, 0 };
+      active = (dio0 == 0x01) || (flags2 & txFlags[dio0]) || ((dio0 == 0x03) && (flags1 & RF69_IRQ_PLL_LOCK));
+    } else if(mode == RF69_RX) {
+      const uint8_t rxFlags2[] = { RF69_IRQ_CRC_OK, RF69_IRQ_PAYLOAD_READY, 0, 0 };
+      const uint8_t rxFlags1[] = { 0, 0, RF69_SYNC_ADDRESS_MATCH, RF69_IRQ_RSSI };
+      active = (flags2 & rxFlags2[dio0]) || (flags1 & rxFlags1[dio0]);
+    }
+
+  } else {
+    switch((map >> 4) & 0x03) {
+      case 0x00:
+        active = flags2 & RF69_IRQ_FIFO_LEVEL;
+        break;
+      case 0x01:
+        active = flags2 & RF69_IRQ_FIFO_FULL;
+        break;
+      case 0x02:
+        active = flags2 & RF69_IRQ_FIFO_NOT_EMPTY;
+        break;
+      case 0x03:
+        // timeout in RX, PLL lock otherwise
+        active = (flags1 & ((mode == RF69_RX) ? RF69_IRQ_TIMEOUT : RF69_IRQ_PLL_LOCK));
+        break;
+    }
+  }
+
+  *value = active ? HIGH : LOW;
+  return(true);
+}
+
+void RF69Emulator::writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  if((pin == RADIOLIB_NC) || (pin != _rst)) {
+    return;
+  }
+
+  // reset is active high, chip is held in reset while the pin is high
+  if(value == HIGH) {
+    reset();
+    _inReset = true;
+  } else {
+    _inReset = false;
+  }
+}
+
+void RF69Emulator::update(uint64_t now) {
+  // events are bytes leaving the FIFO
+  while(_eventTime <= now) {
+    txByte();
+  }
+}
+
+void RF69Emulator::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  // chip that is transmitting cannot hear anything
+  if(_inReset || _txActive || (_airSrc != NULL) || !EmulatorHal::airMatch(air, getAir())) {
+    return;
+  }
+
+  // packet can only be received if the chip was already listening when it started
+  _airSrc = src;
+  _airRx = (getMode() == RF69_RX);
+  if(_airRx) {
+    _rxCount = 0;
+    _rxFrameLen = 0;
+    _flags1 |= RF69_IRQ_RSSI | RF69_SYNC_ADDRESS_MATCH;
+  }
+}
+
+void RF69Emulator::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  if((src != _airSrc) || !_airRx || (getMode() != RF69_RX)) {
+    return;
+  }
+
+  for(size_t i = 0; i < len; i++) {
+    rxByte(data[i]);
+  }
+}
+
+void RF69Emulator::airEnd(EmulatedChip* src, bool crcOk) {
+  if(src != _airSrc) {
+    return;
+  }
+  _airSrc = NULL;
+
+  if(_airRx && (getMode() == RF69_RX)) {
+    rxDone(crcOk);
+  }
+}
+
+bool RF69Emulator::isUnlimited() {
+  return(!(_regs[RF69_REG_PACKET_CONFIG_1] & RF69_PACKET_FORMAT_VARIABLE) && (_regs[RF69_REG_PAYLOAD_LENGTH] == 0));
+}
+
+uint8_t RF69Emulator::readRegister(uint8_t addr) {
+  switch(addr) {
+    case RF69_REG_FIFO:
+      return(fifoRead());
+
+    case RF69_REG_IRQ_FLAGS_1: {
+      uint8_t mode = getMode();
+      uint8_t flags = _flags1 | RF69_IRQ_MODE_READY;
+      if(mode == RF69_RX) {
+        flags |= RF69_IRQ_RX_READY;
+      } else if(mode == RF69_TX) {
+        flags |= RF69_IRQ_TX_READY;
+      }
+      if((mode == RF69_FS) || (mode == RF69_TX) || (mode == RF69_RX)) {
+        flags |= RF69_IRQ_PLL_LOCK;
+      }
+      return(flags);
+    }
+
+    case RF69_REG_IRQ_FLAGS_2:
+      return(getIrqFlags2());
+  }
+
+  return(_regs[addr]);
+}
+
+void RF69Emulator::writeRegister(uint8_t addr, uint8_t value) {
+  switch(addr) {
+    case RF69_REG_FIFO:
+      fifoWrite(value);
+      return;
+
+    case RF69_REG_OP_MODE: {
+      uint8_t prev = getMode();
+      _regs[addr] = (value & 0xE0) | prev;
+      if((value & 0x1C) != prev) {
+        enterMode(value & 0x1C);
+      }
+      return;
+    }
+
+    case RF69_REG_IRQ_FLAGS_1:
+      _flags1 &= ~(value & (RF69_IRQ_RSSI | RF69_IRQ_TIMEOUT | RF69_SYNC_ADDRESS_MATCH));
+      return;
+
+    case RF69_REG_IRQ_FLAGS_2:
+      // clearing FIFO overrun flag also clears the FIFO
+      if(value & RF69_IRQ_FIFO_OVERRUN) {
+        _flags2 &= ~RF69_IRQ_FIFO_OVERRUN;
+        fifoClear();
+      }
+      return;
+
+    case RF69_REG_PACKET_CONFIG_2:
+      // receiver restart is a trigger, not stored
+      if((value & RF69_RESTART_RX) && (getMode() == RF69_RX)) {
+        fifoClear();
+        _airRx = false;
+        _rxCount = 0;
+        _flags1 &= ~(RF69_IRQ_RSSI | RF69_SYNC_ADDRESS_MATCH);
+      }
+      _regs[addr] = value & ~RF69_RESTART_RX;
+      return;
+
+    case RF69_REG_TEMP_1:
+      // temperature measurement finishes instantly
+      _regs[addr] = value & ~(RF69_TEMP_MEAS_START | RF69_TEMP_MEAS_RUNNING);
+      return;
+
+    case RF69_REG_VERSION:
+    case RF69_REG_RSSI_VALUE:
+    case RF69_REG_TEMP_2:
+      // read-only
+      return;
+  }
+
+  _regs[addr] = value;
+}
+
+void RF69Emulator::enterMode(uint8_t mode) {
+  uint8_t prev = getMode();
+  _regs[RF69_REG_OP_MODE] = (_regs[RF69_REG_OP_MODE] & 0xE3) | mode;
+
+  // leaving TX aborts transmission
+  if((prev == RF69_TX) && (mode != RF69_TX)) {
+    abortTx();
+    _flags2 &= ~RF69_IRQ_PACKET_SENT;
+  }
+
+  // leaving RX stops reception
+  if((prev == RF69_RX) && (mode != RF69_RX)) {
+    _airRx = false;
+    _flags1 &= ~(RF69_IRQ_RSSI | RF69_IRQ_TIMEOUT | RF69_SYNC_ADDRESS_MATCH);
+  }
+
+  switch(mode) {
+    case RF69_SLEEP:
+      // FIFO is not retained in sleep mode
+      fifoClear();
+      memset(_fifo, 0x00, sizeof(_fifo));
+      break;
+
+    case RF69_TX:
+      txStart();
+      break;
+
+    case RF69_RX:
+      fifoClear();
+      _rxCount = 0;
+      _rxFrameLen = 0;
+      _regs[RF69_REG_RSSI_VALUE] = (uint8_t)(-2 * _rssi);
+      break;
+  }
+}
+
+void RF69Emulator::abortTx() {
+  _eventTime = UINT64_MAX;
+  if(!_txActive) {
+    return;
+  }
+
+  // receivers only get incomplete packet
+  _txActive = false;
+  _txStall = false;
+  _txCrc = false;
+  EmulatorHal::airEnd(this, false);
+}
+
+EmulatorAir_t RF69Emulator::getAir() {
+  EmulatorAir_t air;
+  uint32_t frf = ((uint32_t)_regs[RF69_REG_FRF_MSB] << 16) | ((uint32_t)_regs[RF69_REG_FRF_MID] << 8) | _regs[RF69_REG_FRF_LSB];
+  air.freq = (uint32_t)(((uint64_t)frf * (uint64_t)(RF69_CRYSTAL_FREQ * 1000000.0)) >> RF69_DIV_EXPONENT);
+  air.modem = RADIOLIB_EMULATOR_MODEM_FSK;
+  air.sf = 0;
+  air.rate = 8000000000ULL / getByteTime();
+  return(air);
+}
+
+uint64_t RF69Emulator::getByteTime() {
+  // bit rate is 32 MHz / BitRate, so one byte takes BitRate * 250 ns
+  uint16_t bitRate = ((uint16_t)_regs[RF69_REG_BITRATE_MSB] << 8) | _regs[RF69_REG_BITRATE_LSB];
+  return((uint64_t)max(bitRate, (uint16_t)1) * 250ULL);
+}
+
+uint8_t RF69Emulator::getIrqFlags2() {
+  uint8_t flags = _flags2;
+  if(_fifoCount > 0) {
+    flags |= RF69_IRQ_FIFO_NOT_EMPTY;
+  }
+  if(_fifoCount == RF69_EMULATOR_FIFO_SIZE) {
+    flags |= RF69_IRQ_FIFO_FULL;
+  }
+  if(_fifoCount > (_regs[RF69_REG_FIFO_THRESH] & 0x7F)) {
+    flags |= RF69_IRQ_FIFO_LEVEL;
+  }
+  return(flags);
+}
+
+uint8_t RF69Emulator::fifoRead() {
+  if((getMode() == RF69_SLEEP) || (_fifoCount == 0)) {
+    return(0x00);
+  }
+
+  uint8_t b = _fifo[_fifoHead];
+  _fifoHead = (_fifoHead + 1) % RF69_EMULATOR_FIFO_SIZE;
+  _fifoCount--;
+
+  // PayloadReady is cleared once the FIFO is empty
+  if(_fifoCount == 0) {
+    _flags2 &= ~(RF69_IRQ_PAYLOAD_READY | RF69_IRQ_CRC_OK);
+  }
+  return(b);
+}
+
+void RF69Emulator::fifoWrite(uint8_t b) {
+  if(getMode() == RF69_SLEEP) {
+    return;
+  }
+
+  if(_fifoCount == RF69_EMULATOR_FIFO_SIZE) {
+    _flags2 |= RF69_IRQ_FIFO_OVERRUN;
+    return;
+  }
+  _fifo[(_fifoHead + _fifoCount) % RF69_EMULATOR_FIFO_SIZE] = b;
+  _fifoCount++;
+
+  // resume or start transmission
+  if(getMode() == RF69_TX) {
+    if(_txStall) {
+      // unlimited length packet only ran out of data if there is more of it
+      if(isUnlimited()) {
+        _txUnderruns++;
+      }
+      _txStall = false;
+      _eventTime = EmulatorHal::getTimeNs() + getByteTime();
+    } else if(!_txActive) {
+      txStart();
+    }
+  }
+}
+
+void RF69Emulator::fifoClear() {
+  _fifoHead = 0;
+  _fifoCount = 0;
+  _flags2 &= ~(RF69_IRQ_PAYLOAD_READY | RF69_IRQ_CRC_OK);
+}
+
+void RF69Emulator::txStart() {
+  // check transmission start condition
+  uint8_t thresh = _regs[RF69_REG_FIFO_THRESH];
+  bool start = (thresh & RF69_TX_START_CONDITION_FIFO_NOT_EMPTY) ? (_fifoCount > 0) : (_fifoCount > (thresh & 0x7F));
+  if(!start) {
+    return;
+  }
+
+  // first byte leaves the FIFO after preamble and sync word
+  size_t overhead = ((uint16_t)_regs[RF69_REG_PREAMBLE_MSB] << 8) | _regs[RF69_REG_PREAMBLE_LSB];
+  if(_regs[RF69_REG_SYNC_CONFIG] & RF69_SYNC_ON) {
+    overhead += ((_regs[RF69_REG_SYNC_CONFIG] >> 3) & 0x07) + 1;
+  }
+  _txActive = true;
+  _txStall = false;
+  _txCrc = false;
+  _txSent = 0;
+  _txFrameLen = 0;
+  _eventTime = EmulatorHal::getTimeNs() + (overhead + 1) * getByteTime();
+  EmulatorHal::airStart(this, getAir());
+}
+
+void RF69Emulator::txByte() {
+  uint64_t eventTime = _eventTime;
+  _eventTime = UINT64_MAX;
+  if(!_txActive) {
+    return;
+  }
+
+  // CRC was sent, packet is done
+  if(_txCrc) {
+    _txActive = false;
+    _txCrc = false;
+    _txPackets++;
+    _flags2 |= RF69_IRQ_PACKET_SENT;
+    EmulatorHal::airEnd(this, true);
+
+    // next packet can start right away if there is more data
+    if(_fifoCount > 0) {
+      txStart();
+    }
+    return;
+  }
+
+  // real chip would send garbage here, wait for data instead
+  if(_fifoCount == 0) {
+    if(!isUnlimited()) {
+      _txUnderruns++;
+    }
+    _txStall = true;
+    return;
+  }
+
+  uint8_t b = fifoRead();
+  if(_txSent == 0) {
+    _txFrameLen = frameLen(b);
+  }
+  _txSent++;
+  EmulatorHal::airData(this, &b, 1);
+
+  if(_txSent >= _txFrameLen) {
+    _txCrc = true;
+    _eventTime = eventTime + ((_regs[RF69_REG_PACKET_CONFIG_1] & RF69_CRC_ON) ? 2 : 0) * getByteTime();
+  } else {
+    _eventTime = eventTime + getByteTime();
+  }
+}
+
+void RF69Emulator::rxByte(uint8_t b) {
+  if(_rxCount == 0) {
+    _rxFrameLen = frameLen(b);
+  }
+  _rxCount++;
+
+  if(_fifoCount == RF69_EMULATOR_FIFO_SIZE) {
+    _flags2 |= RF69_IRQ_FIFO_OVERRUN;
+    _rxOverruns++;
+    return;
+  }
+  _fifo[(_fifoHead + _fifoCount) % RF69_EMULATOR_FIFO_SIZE] = b;
+  _fifoCount++;
+}
+
+void RF69Emulator::rxDone(bool crcOk) {
+  // unlimited length packet never ends, the receiver just stops getting data
+  _flags1 &= ~(RF69_IRQ_RSSI | RF69_SYNC_ADDRESS_MATCH);
+  if(isUnlimited() || (_rxCount == 0) || (_rxCount < _rxFrameLen)) {
+    return;
+  }
+  _rxCount = 0;
+
+  // with CRC autoclear, packets with wrong CRC are dropped
+  bool crcOn = _regs[RF69_REG_PACKET_CONFIG_1] & RF69_CRC_ON;
+  if(crcOn && !crcOk && !(_regs[RF69_REG_PACKET_CONFIG_1] & RF69_CRC_AUTOCLEAR_OFF)) {
+    fifoClear();
+    return;
+  }
+
+  _flags2 |= RF69_IRQ_PAYLOAD_READY;
+  if(crcOk || !crcOn) {
+    _flags2 |= RF69_IRQ_CRC_OK;
+  }
+  _rxPackets++;
+}
+
+size_t RF69Emulator::frameLen(uint8_t first) {
+  // variable length frame starts with length byte
+  if(_regs[RF69_REG_PACKET_CONFIG_1] & RF69_PACKET_FORMAT_VARIABLE) {
+    return((size_t)first + 1);
+  } else if(isUnlimited()) {
+    return(SIZE_MAX);
+  }
+  return(_regs[RF69_REG_PAYLOAD_LENGTH]);
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef _RADIOLIB_RF69_EMULATOR_H
+#define _RADIOLIB_RF69_EMULATOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include "../../EmulatorHal.h"
+#include "RF69.h"
+
+// value of version register
+#define RF69_EMULATOR_CHIP_VERSION                    0x24
+
+// FIFO size
+#define RF69_EMULATOR_FIFO_SIZE                       66
+
+// emulated signal strength of received packets
+#define RF69_EMULATOR_RSSI_DEFAULT                    -60
+
+/*!
+  \class RF69Emulator
+
+  \brief Register-level emulator of %RF69 and SX1231 chips, to be attached to EmulatorHal. Packet mode is emulated, including OP_MODE transitions,
+  66-byte FIFO with level flags, IRQ flags with DIO0/DIO1 mapping and time-on-air: packet bytes are taken from the FIFO at the configured bit rate,
+  so the FIFO can be refilled during transmission, and PacketSent is only raised once the packet would have been transmitted by a real chip.
+
+  Fixed, variable and unlimited packet length formats are supported. In unlimited length format, transmission goes on for as long as there is data
+  in the FIFO, and received bytes keep coming into the FIFO until the transmitter leaves TX mode.
+
+  Packets transmitted by one emulator are received by all other attached emulators that are in receive mode with matching configuration.
+  Single-chip tests can use injectPacket instead.
+
+  Limitations: register values are not range-checked, analog functions (RSSI measurement, temperature) return fixed values,
+  direct mode, address filtering, AES, AutoModes and Listen mode are not emulated. Real chip would keep receiving noise after the end
+  of unlimited length packet, the emulator does not.
+*/
+class RF69Emulator: public EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param dio0 DIO0 pin.
+
+      \param rst Reset pin.
+
+      \param dio1 DIO1 pin. Defaults to RADIOLIB_NC.
+
+      \param version Value of version register, RF69_EMULATOR_CHIP_VERSION for %RF69 or one of SX1231 revisions. Defaults to RF69_EMULATOR_CHIP_VERSION.
+    */
+    RF69Emulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE dio0, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE dio1 = RADIOLIB_NC, uint8_t version = RF69_EMULATOR_CHIP_VERSION);
+
+    /*!
+      \brief Resets all registers to their default values and aborts any ongoing operation, same as pulsing the reset pin high.
+    */
+    void reset();
+
+    /*!
+      \brief Emulates reception of a packet. Only accepted when the chip is in receive mode.
+
+      \param data Packet payload. In variable length mode, length byte is added automatically.
+
+      \param len Payload length in bytes.
+
+      \param crcError Whether the packet should fail CRC check.
+
+      \returns True if the packet was accepted, false otherwise.
+    */
+    bool injectPacket(const uint8_t* data, size_t len, bool crcError = false);
+
+    /*!
+      \brief Sets signal strength reported for received packets.
+
+      \param rssi RSSI in dBm.
+    */
+    void setSignal(int16_t rssi);
+
+    /*!
+      \brief Calculates time-on-air of a packet with the current configuration.
+
+      \param len Payload length in bytes.
+
+      \returns Time-on-air in ns.
+    */
+    uint64_t getTimeOnAir(size_t len);
+
+    /*!
+      \brief Reads register value without any side effects (e.g. FIFO is not advanced).
+
+      \param addr Register address.
+
+      \returns Register value.
+    */
+    uint8_t getRegister(uint8_t addr);
+
+    /*!
+      \brief Gets the number of transmitted packets since reset.
+
+      \returns Number of transmitted packets.
+    */
+    uint32_t getTxPackets() const { return(_txPackets); }
+
+    /*!
+      \brief Gets the number of received packets since reset.
+
+      \returns Number of received packets.
+    */
+    uint32_t getRxPackets() const { return(_rxPackets); }
+
+    /*!
+      \brief Gets the number of transmissions that ran out of data in FIFO. Real chip would transmit corrupted packet, the emulator waits for more data.
+      In unlimited length format, empty FIFO is only counted when more data is written to it before the chip leaves TX mode.
+
+      \returns Number of TX FIFO underruns.
+    */
+    uint32_t getTxUnderruns() const { return(_txUnderruns); }
+
+    /*!
+      \brief Gets the number of bytes dropped because FIFO was full during reception.
+
+      \returns Number of RX FIFO overruns.
+    */
+    uint32_t getRxOverruns() const { return(_rxOverruns); }
+
+    // EmulatedChip methods
+
+    void spiTransfer(uint8_t* buff, size_t len);
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value);
+    void writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    void update(uint64_t now);
+    uint64_t nextEvent() { return(_eventTime); }
+    void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    void airEnd(EmulatedChip* src, bool crcOk);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    RADIOLIB_PIN_TYPE _dio0, _dio1, _rst;
+    uint8_t _version;
+    bool _inReset;
+
+    uint8_t _regs[0x80];
+
+    // FIFO is a 66 byte queue
+    uint8_t _fifo[RF69_EMULATOR_FIFO_SIZE];
+    uint8_t _fifoHead, _fifoCount;
+
+    // IRQ flags that are not derived from FIFO state
+    uint8_t _flags1, _flags2;
+
+    // pending event (byte leaving the FIFO)
+    uint64_t _eventTime;
+
+    // packet currently on the air
+    EmulatedChip* _airSrc;
+    bool _airRx;
+
+    // transmission state
+    bool _txActive, _txStall, _txCrc;
+    size_t _txFrameLen, _txSent;
+
+    // reception state
+    size_t _rxFrameLen, _rxCount;
+
+    int16_t _rssi;
+
+    uint32_t _txPackets, _rxPackets, _txUnderruns, _rxOverruns;
+
+    uint8_t getMode() { return(_regs[RF69_REG_OP_MODE] & 0x1C); }
+    bool isUnlimited();
+    uint8_t readRegister(uint8_t addr);
+    void writeRegister(uint8_t addr, uint8_t value);
+    void enterMode(uint8_t mode);
+    void abortTx();
+    EmulatorAir_t getAir();
+    uint64_t getByteTime();
+    uint8_t getIrqFlags2();
+
+    uint8_t fifoRead();
+    void fifoWrite(uint8_t b);
+    void fifoClear();
+    void txStart();
+    void txByte();
+    void rxByte(uint8_t b);
+    void rxDone(bool crcOk);
+    size_t frameLen(uint8_t first);
+};
+
+#endif
+
+#endif
@@ -5,6 +5,8 @@ RFM96::RFM96(Module* mod) : SX1278(mod) {
 }
 
 int16_t RFM96::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power, uint8_t currentLimit, uint16_t preambleLength, uint8_t gain) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // execute common part
   int16_t state = SX127x::begin(RFM9X_CHIP_VERSION, syncWord, currentLimit, preambleLength);
   RADIOLIB_ASSERT(state);
@@ -5,7 +5,14 @@ SX1231::SX1231(Module* mod) : RF69(mod) {
 }
 
 int16_t SX1231::begin(float freq, float br, float rxBw, float freqDev, int8_t power) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
+  _mod->SPIvolatileRegs = RF69VolatileRegs;
+  _mod->SPIvolatileRegsLen = sizeof(RF69VolatileRegs);
+  _mod->SPIslowRegs = RF69SlowRegs;
+  _mod->SPIslowRegsLen = sizeof(RF69SlowRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
   Module::pinMode(_mod->getRst(), OUTPUT);
@@ -30,7 +37,7 @@ int16_t SX1231::begin(float freq, float br, float rxBw, float freqDev, int8_t po
         RADIOLIB_DEBUG_PRINT(F(", expected 0x0021 / 0x0022 / 0x0023"));
         RADIOLIB_DEBUG_PRINTLN();
       #endif
-      delay(1000);
+      Module::delay(1000);
       i++;
     }
   }
@@ -5,6 +5,8 @@ SX126x::SX126x(Module* mod) : PhysicalLayer(SX126X_FREQUENCY_STEP_SIZE, SX126X_M
 }
 
 int16_t SX126x::begin(float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, float currentLimit, uint16_t preambleLength, float tcxoVoltage, bool useRegulatorLDO) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
@@ -75,6 +77,8 @@ int16_t SX126x::begin(float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, float
 }
 
 int16_t SX126x::beginFSK(float br, float freqDev, float rxBw, float currentLimit, uint16_t preambleLength, float dataShaping, float tcxoVoltage, bool useRegulatorLDO) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
@@ -154,7 +158,7 @@ int16_t SX126x::reset(bool verify) {
   // run the reset sequence
   Module::pinMode(_mod->getRst(), OUTPUT);
   Module::digitalWrite(_mod->getRst(), LOW);
-  delay(1);
+  Module::delay(1);
   Module::digitalWrite(_mod->getRst(), HIGH);
 
   // return immediately when verification is disabled
@@ -163,7 +167,7 @@ int16_t SX126x::reset(bool verify) {
   }
 
   // set mode to standby - SX126x often refuses first few commands after reset
-  uint32_t start = millis();
+  uint32_t start = Module::millis();
   while(true) {
     // try to set mode to standby
     int16_t state = standby();
@@ -173,17 +177,25 @@ int16_t SX126x::reset(bool verify) {
     }
 
     // standby command failed, check timeout and try again
-    if(millis() - start >= 3000) {
+    if(Module::millis() - start >= 3000) {
       // timed out, possibly incorrect wiring
       return(state);
     }
 
     // wait a bit to not spam the module
-    delay(10);
+    Module::delay(10);
   }
 }
 
 int16_t SX126x::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(transmit(&seg, 1, addr));
+}
+
+int16_t SX126x::transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -214,20 +226,17 @@ int16_t SX126x::transmit(uint8_t* data, size_t len, uint8_t addr) {
   RADIOLIB_DEBUG_PRINTLN(F(" us"));
 
   // start transmission
-  state = startTransmit(data, len, addr);
+  state = startTransmit(segs, numSegs, addr);
   RADIOLIB_ASSERT(state);
 
   // wait for packet transmission or timeout
-  uint32_t start = micros();
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-    if(micros() - start > timeout) {
-      clearIrqStatus();
-      standby();
-      return(ERR_TX_TIMEOUT);
-    }
+  uint32_t start = Module::micros();
+  if(!Module::waitForPin(_mod->getIrq(), HIGH, timeout / 1000 + 1)) {
+    clearIrqStatus();
+    standby();
+    return(ERR_TX_TIMEOUT);
   }
-  uint32_t elapsed = micros() - start;
+  uint32_t elapsed = Module::micros() - start;
 
   // update data rate
   _dataRate = (len*8.0)/((float)elapsed/1000000.0);
@@ -243,6 +252,8 @@ int16_t SX126x::transmit(uint8_t* data, size_t len, uint8_t addr) {
 }
 
 int16_t SX126x::receive(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -278,15 +289,11 @@ int16_t SX126x::receive(uint8_t* data, size_t len) {
   RADIOLIB_ASSERT(state);
 
   // wait for packet reception or timeout
-  uint32_t start = micros();
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-    if(micros() - start > timeout) {
-      fixImplicitTimeout();
-      clearIrqStatus();
-      standby();
-      return(ERR_RX_TIMEOUT);
-    }
+  if(!Module::waitForPin(_mod->getIrq(), HIGH, timeout / 1000 + 1)) {
+    fixImplicitTimeout();
+    clearIrqStatus();
+    standby();
+    return(ERR_RX_TIMEOUT);
   }
 
   // fix timeout in implicit LoRa mode
@@ -318,31 +325,14 @@ int16_t SX126x::receiveDirect() {
 }
 
 int16_t SX126x::scanChannel() {
-  // check active modem
-  if(getPacketType() != SX126X_PACKET_TYPE_LORA) {
-    return(ERR_WRONG_MODEM);
-  }
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_SCAN_CHANNEL);
 
-  // set mode to standby
-  int16_t state = standby();
-  RADIOLIB_ASSERT(state);
-
-  // set DIO pin mapping
-  state = setDioIrqParams(SX126X_IRQ_CAD_DETECTED | SX126X_IRQ_CAD_DONE, SX126X_IRQ_CAD_DETECTED | SX126X_IRQ_CAD_DONE);
-  RADIOLIB_ASSERT(state);
-
-  // clear interrupt flags
-  state = clearIrqStatus();
-  RADIOLIB_ASSERT(state);
-
-  // set mode to CAD
-  state = setCad();
+  // start channel activity detection
+  int16_t state = startChannelScan();
   RADIOLIB_ASSERT(state);
 
   // wait for channel activity detected or timeout
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-  }
+  while(!Module::waitForPin(_mod->getIrq(), HIGH, RADIOLIB_WAIT_SLICE));
 
   // check CAD result
   uint16_t cadResult = getIrqStatus();
@@ -359,6 +349,28 @@ int16_t SX126x::scanChannel() {
   return(ERR_UNKNOWN);
 }
 
+int16_t SX126x::startChannelScan() {
+  // check active modem
+  if(getPacketType() != SX126X_PACKET_TYPE_LORA) {
+    return(ERR_WRONG_MODEM);
+  }
+
+  // set mode to standby
+  int16_t state = standby();
+  RADIOLIB_ASSERT(state);
+
+  // set DIO pin mapping
+  state = setDioIrqParams(SX126X_IRQ_CAD_DETECTED | SX126X_IRQ_CAD_DONE, SX126X_IRQ_CAD_DETECTED | SX126X_IRQ_CAD_DONE);
+  RADIOLIB_ASSERT(state);
+
+  // clear interrupt flags
+  state = clearIrqStatus();
+  RADIOLIB_ASSERT(state);
+
+  // set mode to CAD
+  return(setCad());
+}
+
 int16_t SX126x::sleep(bool retainConfig) {
   uint8_t sleepMode = SX126X_SLEEP_START_WARM | SX126X_SLEEP_RTC_OFF;
   if(!retainConfig) {
@@ -367,29 +379,84 @@ int16_t SX126x::sleep(bool retainConfig) {
   int16_t state = SPIwriteCommand(SX126X_CMD_SET_SLEEP, &sleepMode, 1, false);
 
   // wait for SX126x to safely enter sleep mode
-  delay(1);
+  Module::delay(1);
 
   return(state);
 }
 
 int16_t SX126x::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   return(SX126x::standby(SX126X_STANDBY_RC));
 }
 
 int16_t SX126x::standby(uint8_t mode) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   uint8_t data[] = {mode};
   return(SPIwriteCommand(SX126X_CMD_SET_STANDBY, data, 1));
 }
 
 void SX126x::setDio1Action(void (*func)(void)) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, RISING);
+  Module::attachInterrupt(_mod->getIrq(), func, RISING);
 }
 
 void SX126x::clearDio1Action() {
-  detachInterrupt(digitalPinToInterrupt(_mod->getIrq()));
+  Module::detachInterrupt(_mod->getIrq());
+}
+
+bool SX126x::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source != 0) || (_mod->getIrq() == RADIOLIB_NC)) {
+    return(false);
+  }
+
+  if(func == NULL) {
+    clearDio1Action();
+  } else {
+    setDio1Action(func);
+  }
+  return(true);
+}
+
+uint16_t SX126x::getEvents() {
+  uint16_t irq = getIrqStatus();
+  uint16_t events = RADIOLIB_EVENT_NONE;
+  if(irq & SX126X_IRQ_TX_DONE) {
+    events |= RADIOLIB_EVENT_TX_DONE;
+  }
+  if(irq & SX126X_IRQ_RX_DONE) {
+    events |= RADIOLIB_EVENT_RX_DONE;
+  }
+  if(irq & (SX126X_IRQ_CRC_ERR | SX126X_IRQ_HEADER_ERR)) {
+    events |= RADIOLIB_EVENT_CRC_ERROR;
+  }
+  if(irq & SX126X_IRQ_CAD_DONE) {
+    events |= RADIOLIB_EVENT_CAD_DONE;
+  }
+  if(irq & SX126X_IRQ_CAD_DETECTED) {
+    events |= RADIOLIB_EVENT_CAD_DETECTED;
+  }
+  if(irq & SX126X_IRQ_PREAMBLE_DETECTED) {
+    events |= RADIOLIB_EVENT_PREAMBLE_DETECTED;
+  }
+  if(irq & SX126X_IRQ_SYNC_WORD_VALID) {
+    events |= RADIOLIB_EVENT_SYNC_WORD;
+  }
+  if(irq & SX126X_IRQ_TIMEOUT) {
+    events |= RADIOLIB_EVENT_TIMEOUT;
+  }
+  return(events);
 }
 
 int16_t SX126x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(startTransmit(&seg, 1, addr));
+}
+
+int16_t SX126x::startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // suppress unused variable warning
   (void)addr;
 
@@ -423,9 +490,13 @@ int16_t SX126x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   state = setBufferBaseAddress();
   RADIOLIB_ASSERT(state);
 
-  // write packet to buffer
-  state = writeBuffer(data, len);
-  RADIOLIB_ASSERT(state);
+  // write packet to buffer, each segment right after the previous one
+  uint8_t offset = 0;
+  for(size_t i = 0; i < numSegs; i++) {
+    state = writeBuffer(segs[i].data, segs[i].len, offset);
+    RADIOLIB_ASSERT(state);
+    offset += segs[i].len;
+  }
 
   // clear interrupt flags
   state = clearIrqStatus();
@@ -440,14 +511,27 @@ int16_t SX126x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   RADIOLIB_ASSERT(state);
 
   // wait for BUSY to go low (= PA ramp up done)
-  while(digitalRead(_mod->getGpio())) {
-    yield();
-  }
+  while(!Module::waitForPin(_mod->getGpio(), LOW, RADIOLIB_WAIT_SLICE));
 
   return(state);
 }
 
+int16_t SX126x::finishTransmit() {
+  // clear interrupt flags
+  int16_t state = clearIrqStatus();
+  RADIOLIB_ASSERT(state);
+
+  // set mode to standby to disable transmitter
+  return(standby());
+}
+
+int16_t SX126x::startReceive() {
+  return(startReceive(SX126X_RX_TIMEOUT_INF));
+}
+
 int16_t SX126x::startReceive(uint32_t timeout) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
   int16_t state = startReceiveCommon();
   RADIOLIB_ASSERT(state);
 
@@ -547,6 +631,8 @@ int16_t SX126x::startReceiveCommon() {
 }
 
 int16_t SX126x::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -1497,10 +1583,8 @@ int16_t SX126x::config(uint8_t modem) {
   RADIOLIB_ASSERT(state);
 
   // wait for calibration completion
-  delay(5);
-  while(digitalRead(_mod->getGpio())) {
-    yield();
-  }
+  Module::delay(5);
+  while(!Module::waitForPin(_mod->getGpio(), LOW, RADIOLIB_WAIT_SLICE));
 
   return(ERR_NONE);
 }
@@ -1522,101 +1606,85 @@ int16_t SX126x::SPIreadCommand(uint8_t cmd, uint8_t* data, uint8_t numBytes, boo
 }
 
 int16_t SX126x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes, bool waitForBusy, uint32_t timeout) {
-  // get pointer to used SPI interface and the settings
-  SPIClass* spi = _mod->getSpi();
-  SPISettings spiSettings = _mod->getSpiSettings();
+  // command byte(s), followed by data bytes
+  // read-type commands have one additional status-only byte before the data, write-type commands send the first data byte with the header,
+  // so that the status clocked out with it ends up in the header
+  uint8_t head[RADIOLIB_SPI_HEADER_SIZE];
+  uint8_t headLen = cmdLen;
+  memcpy(head, cmd, cmdLen);
+  if(!write) {
+    head[headLen++] = SX126X_CMD_NOP;
+  } else if(numBytes > 0) {
+    head[headLen++] = dataOut[0];
+  }
 
-  #ifdef RADIOLIB_VERBOSE
-    uint8_t debugBuff[256];
-  #endif
+  // jobs of other modules on a shared bus have to run before NSS is pulled low
+  _mod->SPIprepareTransaction();
 
   // pull NSS low
   uint8_t cs = _mod->getCs();
   if(cs != RADIOLIB_NC)
-    digitalWrite(cs, LOW);
+    Module::digitalWrite(cs, LOW);
 
   // ensure BUSY is low (state machine ready)
-  uint32_t start = millis();
-  while(digitalRead(_mod->getGpio())) {
-    yield();
-    if(millis() - start >= timeout) {
-      if(cs != RADIOLIB_NC)
-        digitalWrite(cs, HIGH);
-      return(ERR_SPI_CMD_TIMEOUT);
-    }
+  #ifdef RADIOLIB_STATS
+    uint32_t busyStart = Module::micros();
+  #endif
+  bool ready = Module::waitForPin(_mod->getGpio(), LOW, timeout);
+  #ifdef RADIOLIB_STATS
+    _mod->statsAddBusyWait(Module::micros() - busyStart);
+  #endif
+  if(!ready) {
+    if(cs != RADIOLIB_NC)
+      Module::digitalWrite(cs, HIGH);
+    return(ERR_SPI_CMD_TIMEOUT);
   }
 
-  // start transfer
-  spi->beginTransaction(spiSettings);
-
-  // send command byte(s)
-  for(uint8_t n = 0; n < cmdLen; n++) {
-    spi->transfer(cmd[n]);
-  }
+  #ifdef RADIOLIB_SPI_TRACE
+    uint32_t traceTime = Module::micros();
+  #endif
 
-  // variable to save error during SPI transfer
-  uint8_t status = 0;
+  // start transfer
+  _mod->SPIbeginTransaction();
 
-  // send/receive all bytes
+  // send the frame, for write-type commands status clocked out with the rest of the data is checked block by block as it arrives
+  uint8_t dataStatus = 0;
   if(write) {
-    for(uint8_t n = 0; n < numBytes; n++) {
-      // send byte
-      uint8_t in = spi->transfer(dataOut[n]);
-      #ifdef RADIOLIB_VERBOSE
-        debugBuff[n] = in;
-      #endif
-
-      // check status
-      if(((in & 0b00001110) == SX126X_STATUS_CMD_TIMEOUT) ||
-         ((in & 0b00001110) == SX126X_STATUS_CMD_INVALID) ||
-         ((in & 0b00001110) == SX126X_STATUS_CMD_FAILED)) {
-        status = in & 0b00001110;
-        break;
-      } else if(in == 0x00 || in == 0xFF) {
-        status = SX126X_STATUS_SPI_FAILED;
-        break;
-      }
-    }
-
+    dataStatus = _mod->SPItransferFrameChecked(head, headLen, (numBytes > 1) ? dataOut + 1 : NULL, (numBytes > 1) ? numBytes - 1 : 0, SX126x::SPIcheckStatus);
   } else {
-    // skip the first byte for read-type commands (status-only)
-    uint8_t in = spi->transfer(SX126X_CMD_NOP);
-    #ifdef RADIOLIB_VERBOSE
-      debugBuff[0] = in;
-    #endif
-
-    // check status
-    if(((in & 0b00001110) == SX126X_STATUS_CMD_TIMEOUT) ||
-       ((in & 0b00001110) == SX126X_STATUS_CMD_INVALID) ||
-       ((in & 0b00001110) == SX126X_STATUS_CMD_FAILED)) {
-      status = in & 0b00001110;
-    } else if(in == 0x00 || in == 0xFF) {
-      status = SX126X_STATUS_SPI_FAILED;
-    } else {
-      for(uint8_t n = 0; n < numBytes; n++) {
-        dataIn[n] = spi->transfer(SX126X_CMD_NOP);
-      }
-    }
+    _mod->SPItransferFrame(head, headLen, NULL, dataIn, numBytes, SX126X_CMD_NOP);
   }
 
   // stop transfer
-  spi->endTransaction();
+  _mod->SPIendTransaction();
   if(cs != RADIOLIB_NC)
-    digitalWrite(cs, HIGH);
+    Module::digitalWrite(cs, HIGH);
+
+  // check status - the chip clocks out status with every byte after the command, for read-type commands the data follow the first one
+  uint8_t status = SPIcheckStatus(head + cmdLen, headLen - cmdLen);
+  if(status == 0) {
+    status = dataStatus;
+  }
 
   // wait for BUSY to go high and then low
   if(waitForBusy) {
-    delayMicroseconds(1);
-    start = millis();
-    while(digitalRead(_mod->getGpio())) {
-      yield();
-      if(millis() - start >= timeout) {
-        status = SX126X_STATUS_CMD_TIMEOUT;
-        break;
-      }
+    Module::delayMicroseconds(1);
+    #ifdef RADIOLIB_STATS
+      busyStart = Module::micros();
+    #endif
+    ready = Module::waitForPin(_mod->getGpio(), LOW, timeout);
+    #ifdef RADIOLIB_STATS
+      _mod->statsAddBusyWait(Module::micros() - busyStart);
+    #endif
+    if(!ready) {
+      status = SX126X_STATUS_CMD_TIMEOUT;
     }
   }
 
+  #ifdef RADIOLIB_SPI_TRACE
+    _mod->SPItraceRecord(cmd, cmdLen, write, write ? dataOut : dataIn, numBytes, status, traceTime);
+  #endif
+
   // print debug output
   #ifdef RADIOLIB_VERBOSE
     // print command byte(s)
@@ -1634,19 +1702,16 @@ int16_t SX126x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* d
       for(uint8_t n = 0; n < numBytes; n++) {
         RADIOLIB_VERBOSE_PRINT(dataOut[n], HEX);
         RADIOLIB_VERBOSE_PRINT('\t');
-        RADIOLIB_VERBOSE_PRINT(debugBuff[n], HEX);
-        RADIOLIB_VERBOSE_PRINT('\t');
       }
       RADIOLIB_VERBOSE_PRINTLN();
     } else {
       RADIOLIB_VERBOSE_PRINT("R\t");
-      // skip the first byte for read-type commands (status-only)
+      // the first byte is status-only, the rest is data
       RADIOLIB_VERBOSE_PRINT(SX126X_CMD_NOP, HEX);
       RADIOLIB_VERBOSE_PRINT('\t');
-      RADIOLIB_VERBOSE_PRINT(debugBuff[0], HEX);
-      RADIOLIB_VERBOSE_PRINT('\t')
-
-      for(uint8_t n = 0; n < numBytes; n++) {
+      RADIOLIB_VERBOSE_PRINT(head[cmdLen], HEX);
+      RADIOLIB_VERBOSE_PRINT('\t');
+      for(size_t n = 0; n < numBytes; n++) {
         RADIOLIB_VERBOSE_PRINT(SX126X_CMD_NOP, HEX);
         RADIOLIB_VERBOSE_PRINT('\t');
         RADIOLIB_VERBOSE_PRINT(dataIn[n], HEX);
@@ -1660,7 +1725,7 @@ int16_t SX126x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* d
     // not sure why, but it seems that long enough SPI transaction
     // (e.g. setPacketParams for GFSK) will fail without it
     #if defined(ARDUINO_ARCH_STM32)
-      delay(1);
+      Module::delay(1);
     #endif
   #endif
 
@@ -1678,3 +1743,16 @@ int16_t SX126x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* d
       return(ERR_NONE);
   }
 }
+
+uint8_t SX126x::SPIcheckStatus(const uint8_t* in, size_t len) {
+  for(size_t n = 0; n < len; n++) {
+    if(((in[n] & 0b00001110) == SX126X_STATUS_CMD_TIMEOUT) ||
+       ((in[n] & 0b00001110) == SX126X_STATUS_CMD_INVALID) ||
+       ((in[n] & 0b00001110) == SX126X_STATUS_CMD_FAILED)) {
+      return(in[n] & 0b00001110);
+    } else if(in[n] == 0x00 || in[n] == 0xFF) {
+      return(SX126X_STATUS_SPI_FAILED);
+    }
+  }
+  return(0);
+}
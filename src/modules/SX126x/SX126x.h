@@ -423,6 +423,19 @@ class SX126x: public PhysicalLayer {
     */
     int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Blocking scatter-gather transmit method. Segments are written to the data buffer at consecutive offsets.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Address to send the data to. Will only be added if address filtering was enabled.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
     /*!
       \brief Blocking binary receive method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -459,6 +472,13 @@ class SX126x: public PhysicalLayer {
     */
     int16_t scanChannel();
 
+    /*!
+      \brief Interrupt-driven channel activity detection method. DIO1 will be activated when the scan is finished.
+
+      \returns \ref status_codes
+    */
+    int16_t startChannelScan();
+
     /*!
       \brief Sets the module to sleep mode.
 
@@ -498,6 +518,24 @@ class SX126x: public PhysicalLayer {
     */
     void clearDio1Action();
 
+    /*!
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is DIO1.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
     /*!
       \brief Interrupt-driven binary transmit method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -512,14 +550,41 @@ class SX126x: public PhysicalLayer {
     */
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Interrupt-driven scatter-gather transmit method. Segments are written to the data buffer at consecutive offsets.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Address to send the data to. Will only be added if address filtering was enabled.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - clears IRQ status and sets module to standby.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
+    /*!
+      \brief Interrupt-driven receive method in Rx continuous mode. DIO1 will be activated when full packet is received.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceive();
+
     /*!
       \brief Interrupt-driven receive method. DIO1 will be activated when full packet is received.
 
-      \param timeout Raw timeout value, expressed as multiples of 15.625 us. Defaults to SX126X_RX_TIMEOUT_INF for infinite timeout (Rx continuous mode), set to SX126X_RX_TIMEOUT_NONE for no timeout (Rx single mode).
+      \param timeout Raw timeout value, expressed as multiples of 15.625 us. Set to SX126X_RX_TIMEOUT_INF for infinite timeout (Rx continuous mode), set to SX126X_RX_TIMEOUT_NONE for no timeout (Rx single mode).
 
       \returns \ref status_codes
     */
-    int16_t startReceive(uint32_t timeout = SX126X_RX_TIMEOUT_INF);
+    int16_t startReceive(uint32_t timeout);
 
     /*!
       \brief Interrupt-driven receive method where the device mostly sleeps and periodically wakes to listen.
@@ -894,11 +959,11 @@ class SX126x: public PhysicalLayer {
     int16_t fixImplicitTimeout();
     int16_t fixInvertedIQ(uint8_t iqConfig);
 
+    Module* _mod;
+
 #ifndef RADIOLIB_GODMODE
   private:
 #endif
-    Module* _mod;
-
     uint8_t _bw, _sf, _cr, _ldro, _crcType, _headerType;
     uint16_t _preambleLength;
     float _bwKhz;
@@ -922,6 +987,7 @@ class SX126x: public PhysicalLayer {
     int16_t SPIreadCommand(uint8_t cmd, uint8_t* data, uint8_t numBytes, bool waitForBusy = true);
     int16_t SPIreadCommand(uint8_t* cmd, uint8_t cmdLen, uint8_t* data, uint8_t numBytes, bool waitForBusy = true);
     int16_t SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes, bool waitForBusy, uint32_t timeout = 5000);
+    static uint8_t SPIcheckStatus(const uint8_t* in, size_t len);
 };
 
 #endif
@@ -0,0 +1,376 @@
+#include "SX126xEmulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+// LoRa bandwidth values in Hz, indexed by register value
+static const uint32_t SX126xEmulatorBw[] = { 7800, 15600, 31250, 62500, 125000, 250000, 500000, 0, 10400, 20800, 41700 };
+
+SX126xEmulator::SX126xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE busy, RADIOLIB_PIN_TYPE dio1, RADIOLIB_PIN_TYPE rst) : CommandChipEmulator(cs, busy, dio1, rst) {
+  for(uint16_t i = 0; i < 256; i++) {
+    setBusyTime(i, SX126X_EMULATOR_BUSY_DEFAULT);
+  }
+  setBusyTime(SX126X_CMD_SET_FS, SX126X_EMULATOR_BUSY_SET_FS);
+  setBusyTime(SX126X_CMD_SET_TX, SX126X_EMULATOR_BUSY_SET_TX);
+  setBusyTime(SX126X_CMD_SET_RX, SX126X_EMULATOR_BUSY_SET_RX);
+  setBusyTime(SX126X_CMD_SET_RX_DUTY_CYCLE, SX126X_EMULATOR_BUSY_SET_RX);
+  setBusyTime(SX126X_CMD_SET_CAD, SX126X_EMULATOR_BUSY_SET_CAD);
+  setBusyTime(SX126X_CMD_CALIBRATE, SX126X_EMULATOR_BUSY_CALIBRATE);
+  setBusyTime(SX126X_CMD_CALIBRATE_IMAGE, SX126X_EMULATOR_BUSY_CALIBRATE_IMAGE);
+  setStartupTime(SX126X_EMULATOR_STARTUP_TIME);
+  reset();
+}
+
+uint8_t SX126xEmulator::getRegister(uint16_t addr) {
+  return(_regs[addr % SX126X_EMULATOR_REG_SPACE]);
+}
+
+uint64_t SX126xEmulator::getTimeOnAir(size_t len) {
+  uint16_t preamble = ((uint16_t)_pktParams[0] << 8) | _pktParams[1];
+  if(_packetType == SX126X_PACKET_TYPE_LORA) {
+    return(getLoRaTimeOnAir(_modParams[0], getBandwidth(), _modParams[2], preamble, len,
+                            _pktParams[4] == SX126X_LORA_CRC_ON, _pktParams[2] == SX126X_LORA_HEADER_IMPLICIT,
+                            _modParams[3] == SX126X_LORA_LOW_DATA_RATE_OPTIMIZE_ON));
+  }
+
+  // preamble and sync word lengths are in bits
+  uint32_t bits = preamble + _pktParams[3] + 8*len;
+  if(_pktParams[4] != SX126X_GFSK_ADDRESS_FILT_OFF) {
+    bits += 8;
+  }
+  if(_pktParams[5] == SX126X_GFSK_PACKET_VARIABLE) {
+    bits += 8;
+  }
+  if((_pktParams[7] == SX126X_GFSK_CRC_1_BYTE) || (_pktParams[7] == SX126X_GFSK_CRC_1_BYTE_INV)) {
+    bits += 8;
+  } else if((_pktParams[7] == SX126X_GFSK_CRC_2_BYTE) || (_pktParams[7] == SX126X_GFSK_CRC_2_BYTE_INV)) {
+    bits += 16;
+  }
+  return(((uint64_t)bits * 1000000000ULL) / getBitRate());
+}
+
+void SX126xEmulator::command(const uint8_t* in, uint8_t* out, size_t len) {
+  // all bytes clocked out by the chip carry status, data bytes are overwritten below
+  memset(out, getStatus(), len);
+  _cmdStatus = 0;
+
+  // parameters start after opcode, response data of read commands after one more status byte
+  const uint8_t* param = &in[1];
+  size_t paramLen = len - 1;
+  uint8_t* resp = &out[2];
+  size_t respLen = (len > 2) ? len - 2 : 0;
+
+  switch(in[0]) {
+    case SX126X_CMD_SET_SLEEP:
+      enterSleep(!(param[0] & SX126X_SLEEP_START_WARM));
+      break;
+
+    case SX126X_CMD_SET_STANDBY:
+      enterStandby();
+      _xosc = (param[0] == SX126X_STANDBY_XOSC);
+      break;
+
+    case SX126X_CMD_SET_FS:
+      enterStandby(RADIOLIB_EMULATOR_STATE_FS);
+      break;
+
+    case SX126X_CMD_SET_TX:
+      startTx((_packetType == SX126X_PACKET_TYPE_LORA) ? _pktParams[3] : _pktParams[6], getTimeout(param));
+      break;
+
+    case SX126X_CMD_SET_RX: {
+      uint32_t raw = ((uint32_t)param[0] << 16) | ((uint32_t)param[1] << 8) | param[2];
+      startRx(getTimeout(param), raw == SX126X_RX_TIMEOUT_INF);
+    } break;
+
+    case SX126X_CMD_SET_RX_DUTY_CYCLE:
+      startRx(0, true);
+      break;
+
+    case SX126X_CMD_SET_CAD:
+      startCad((1UL << _cadParams[0]) * getSymbolTime());
+      break;
+
+    case SX126X_CMD_SET_TX_CONTINUOUS_WAVE:
+    case SX126X_CMD_SET_TX_INFINITE_PREAMBLE:
+      enterStandby(RADIOLIB_EMULATOR_STATE_TX);
+      break;
+
+    case SX126X_CMD_WRITE_REGISTER: {
+      uint16_t addr = ((uint16_t)param[0] << 8) | param[1];
+      for(size_t i = 2; i < paramLen; i++) {
+        _regs[(addr + i - 2) % SX126X_EMULATOR_REG_SPACE] = param[i];
+      }
+    } break;
+
+    case SX126X_CMD_READ_REGISTER: {
+      uint16_t addr = ((uint16_t)param[0] << 8) | param[1];
+      for(size_t i = 4; i < len; i++) {
+        out[i] = _regs[(addr + i - 4) % SX126X_EMULATOR_REG_SPACE];
+      }
+    } break;
+
+    case SX126X_CMD_WRITE_BUFFER:
+      for(size_t i = 1; i < paramLen; i++) {
+        _buff[(uint8_t)(param[0] + i - 1)] = param[i];
+      }
+      break;
+
+    case SX126X_CMD_READ_BUFFER:
+      for(size_t i = 3; i < len; i++) {
+        out[i] = _buff[(uint8_t)(param[0] + i - 3)];
+      }
+      break;
+
+    case SX126X_CMD_SET_DIO_IRQ_PARAMS:
+      _irqMask = ((uint16_t)param[0] << 8) | param[1];
+      _dio1Mask = ((uint16_t)param[2] << 8) | param[3];
+      break;
+
+    case SX126X_CMD_GET_IRQ_STATUS:
+      if(respLen >= 2) {
+        resp[0] = (uint8_t)(_irq >> 8);
+        resp[1] = (uint8_t)(_irq & 0xFF);
+      }
+      break;
+
+    case SX126X_CMD_CLEAR_IRQ_STATUS:
+      _irq &= ~(((uint16_t)param[0] << 8) | param[1]);
+      break;
+
+    case SX126X_CMD_SET_RF_FREQUENCY:
+      _frf = ((uint32_t)param[0] << 24) | ((uint32_t)param[1] << 16) | ((uint32_t)param[2] << 8) | param[3];
+      break;
+
+    case SX126X_CMD_SET_PACKET_TYPE:
+      _packetType = param[0];
+      break;
+
+    case SX126X_CMD_GET_PACKET_TYPE:
+      if(respLen >= 1) {
+        resp[0] = _packetType;
+      }
+      break;
+
+    case SX126X_CMD_SET_MODULATION_PARAMS:
+      memcpy(_modParams, param, min(paramLen, sizeof(_modParams)));
+      break;
+
+    case SX126X_CMD_SET_PACKET_PARAMS:
+      memcpy(_pktParams, param, min(paramLen, sizeof(_pktParams)));
+      break;
+
+    case SX126X_CMD_SET_CAD_PARAMS:
+      memcpy(_cadParams, param, min(paramLen, sizeof(_cadParams)));
+      break;
+
+    case SX126X_CMD_SET_BUFFER_BASE_ADDRESS:
+      _txBase = param[0];
+      _rxBase = param[1];
+      break;
+
+    case SX126X_CMD_GET_RSSI_INST:
+      if(respLen >= 1) {
+        resp[0] = (uint8_t)(-2 * ((_airSrc != NULL) ? _rssi : -120));
+      }
+      break;
+
+    case SX126X_CMD_GET_RX_BUFFER_STATUS:
+      if(respLen >= 2) {
+        resp[0] = _rxLen;
+        resp[1] = _rxStart;
+      }
+      break;
+
+    case SX126X_CMD_GET_PACKET_STATUS:
+      if(respLen >= 3) {
+        if(_packetType == SX126X_PACKET_TYPE_LORA) {
+          resp[0] = (uint8_t)(-2 * _rssi);
+          resp[1] = (uint8_t)(4 * _snr);
+          resp[2] = (uint8_t)(-2 * _rssi);
+        } else {
+          resp[0] = 0x00;
+          resp[1] = (uint8_t)(-2 * _rssi);
+          resp[2] = (uint8_t)(-2 * _rssi);
+        }
+      }
+      break;
+
+    case SX126X_CMD_GET_DEVICE_ERRORS:
+      memset(resp, 0x00, respLen);
+      break;
+
+    case SX126X_CMD_GET_STATS:
+      memset(resp, 0x00, respLen);
+      if(respLen >= 2) {
+        resp[0] = (uint8_t)(_rxPackets >> 8);
+        resp[1] = (uint8_t)(_rxPackets & 0xFF);
+      }
+      break;
+
+    case SX126X_CMD_NOP:
+    case SX126X_CMD_GET_STATUS:
+    case SX126X_CMD_STOP_TIMER_ON_PREAMBLE:
+    case SX126X_CMD_SET_REGULATOR_MODE:
+    case SX126X_CMD_CALIBRATE:
+    case SX126X_CMD_CALIBRATE_IMAGE:
+    case SX126X_CMD_SET_PA_CONFIG:
+    case SX126X_CMD_SET_RX_TX_FALLBACK_MODE:
+    case SX126X_CMD_SET_DIO2_AS_RF_SWITCH_CTRL:
+    case SX126X_CMD_SET_DIO3_AS_TCXO_CTRL:
+    case SX126X_CMD_SET_TX_PARAMS:
+    case SX126X_CMD_SET_LORA_SYMB_NUM_TIMEOUT:
+    case SX126X_CMD_CLEAR_DEVICE_ERRORS:
+      // accepted, but have no effect on emulation
+      break;
+
+    default:
+      _cmdStatus = SX126X_STATUS_CMD_INVALID;
+      memset(out, getStatus(), len);
+      _cmdStatus = 0;
+      break;
+  }
+}
+
+void SX126xEmulator::resetConfig() {
+  memset(_regs, 0x00, sizeof(_regs));
+  _regs[SX126X_REG_WHITENING_INITIAL_MSB] = 0x01;
+  _regs[SX126X_REG_CRC_INITIAL_MSB] = 0x1D;
+  _regs[SX126X_REG_CRC_INITIAL_LSB] = 0x0F;
+  _regs[SX126X_REG_CRC_POLYNOMIAL_MSB] = 0x10;
+  _regs[SX126X_REG_CRC_POLYNOMIAL_LSB] = 0x21;
+  _regs[SX126X_REG_LORA_SYNC_WORD_MSB] = 0x14;
+  _regs[SX126X_REG_LORA_SYNC_WORD_LSB] = 0x24;
+  _regs[SX126X_REG_IQ_CONFIG] = 0x0D;
+  _regs[SX126X_REG_RX_GAIN] = 0x94;
+  _regs[SX126X_REG_TX_CLAMP_CONFIG] = 0xC8;
+  _regs[SX126X_REG_OCP_CONFIGURATION] = 0x18;
+
+  // power-on defaults: GFSK at 4.8 kbps, 915 MHz
+  _packetType = SX126X_PACKET_TYPE_GFSK;
+  _frf = 0x39300000;
+  memset(_modParams, 0x00, sizeof(_modParams));
+  _modParams[0] = 0x03;
+  _modParams[1] = 0x41;
+  _modParams[2] = 0x55;
+  memset(_pktParams, 0x00, sizeof(_pktParams));
+  _pktParams[1] = 0x10;
+  _pktParams[7] = SX126X_GFSK_CRC_OFF;
+  memset(_cadParams, 0x00, sizeof(_cadParams));
+  _cmdStatus = 0;
+  _xosc = false;
+}
+
+EmulatorAir_t SX126xEmulator::getAir() {
+  EmulatorAir_t air;
+  air.freq = (uint32_t)(((uint64_t)_frf * (uint64_t)(SX126X_CRYSTAL_FREQ * 1000000.0)) >> SX126X_DIV_EXPONENT);
+  if(_packetType == SX126X_PACKET_TYPE_LORA) {
+    air.modem = RADIOLIB_EMULATOR_MODEM_LORA;
+    air.rate = getBandwidth();
+    air.sf = _modParams[0];
+  } else {
+    air.modem = RADIOLIB_EMULATOR_MODEM_FSK;
+    air.rate = getBitRate();
+    air.sf = 0;
+  }
+  return(air);
+}
+
+bool SX126xEmulator::isVariableLength() {
+  return((_packetType == SX126X_PACKET_TYPE_GFSK) && (_pktParams[5] == SX126X_GFSK_PACKET_VARIABLE));
+}
+
+void SX126xEmulator::event(uint8_t event) {
+  bool lora = (_packetType == SX126X_PACKET_TYPE_LORA);
+  switch(event) {
+    case RADIOLIB_EMULATOR_EVENT_TX_DONE:
+      setIrq(SX126X_IRQ_TX_DONE);
+      _cmdStatus = SX126X_STATUS_TX_DONE;
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_TIMEOUT:
+      setIrq(SX126X_IRQ_TIMEOUT);
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_CAD_DONE:
+      setIrq(SX126X_IRQ_CAD_DONE);
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_CAD_DETECTED:
+      setIrq(SX126X_IRQ_CAD_DONE | SX126X_IRQ_CAD_DETECTED);
+      if(_cadParams[3] == SX126X_CAD_GOTO_RX) {
+        startRx(getTimeout(&_cadParams[4]), false);
+      }
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_RX_START:
+      if(!lora) {
+        setIrq(SX126X_IRQ_PREAMBLE_DETECTED | SX126X_IRQ_SYNC_WORD_VALID);
+      } else if(_pktParams[2] == SX126X_LORA_HEADER_EXPLICIT) {
+        setIrq(SX126X_IRQ_PREAMBLE_DETECTED | SX126X_IRQ_HEADER_VALID);
+      } else {
+        setIrq(SX126X_IRQ_PREAMBLE_DETECTED);
+      }
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_RX_DONE:
+      setIrq(SX126X_IRQ_RX_DONE);
+      _cmdStatus = SX126X_STATUS_DATA_AVAILABLE;
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_RX_CRC_ERROR:
+      setIrq(SX126X_IRQ_RX_DONE | SX126X_IRQ_CRC_ERR);
+      _cmdStatus = SX126X_STATUS_DATA_AVAILABLE;
+      break;
+  }
+}
+
+uint8_t SX126xEmulator::getStatus() {
+  uint8_t mode = _xosc ? SX126X_STATUS_MODE_STDBY_XOSC : SX126X_STATUS_MODE_STDBY_RC;
+  switch(_state) {
+    case RADIOLIB_EMULATOR_STATE_FS:
+      mode = SX126X_STATUS_MODE_FS;
+      break;
+    case RADIOLIB_EMULATOR_STATE_TX:
+      mode = SX126X_STATUS_MODE_TX;
+      break;
+    case RADIOLIB_EMULATOR_STATE_RX:
+    case RADIOLIB_EMULATOR_STATE_CAD:
+      mode = SX126X_STATUS_MODE_RX;
+      break;
+  }
+  return(mode | _cmdStatus);
+}
+
+uint32_t SX126xEmulator::getBandwidth() {
+  uint8_t bw = _modParams[1];
+  if((bw >= sizeof(SX126xEmulatorBw)/sizeof(SX126xEmulatorBw[0])) || (SX126xEmulatorBw[bw] == 0)) {
+    return(SX126xEmulatorBw[SX126X_LORA_BW_125_0]);
+  }
+  return(SX126xEmulatorBw[bw]);
+}
+
+uint32_t SX126xEmulator::getBitRate() {
+  uint32_t br = ((uint32_t)_modParams[0] << 16) | ((uint32_t)_modParams[1] << 8) | _modParams[2];
+  if(br == 0) {
+    return(1);
+  }
+  return((uint32_t)((SX126X_CRYSTAL_FREQ * 1000000.0 * 32.0) / br));
+}
+
+uint64_t SX126xEmulator::getSymbolTime() {
+  if(_packetType != SX126X_PACKET_TYPE_LORA) {
+    return((8ULL * 1000000000ULL) / getBitRate());
+  }
+  return(((uint64_t)1000000000 << _modParams[0]) / getBandwidth());
+}
+
+uint64_t SX126xEmulator::getTimeout(const uint8_t* param) {
+  // 24-bit timeout in units of 15.625 us, 0 means no timeout
+  uint32_t raw = ((uint32_t)param[0] << 16) | ((uint32_t)param[1] << 8) | param[2];
+  if(raw == SX126X_RX_TIMEOUT_INF) {
+    return(0);
+  }
+  return((uint64_t)raw * 15625ULL);
+}
+
+#endif
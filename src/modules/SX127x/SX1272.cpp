@@ -5,6 +5,8 @@ SX1272::SX1272(Module* mod) : SX127x(mod) {
 }
 
 int16_t SX1272::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power, uint8_t currentLimit, uint16_t preambleLength, uint8_t gain) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // execute common part
   int16_t state = SX127x::begin(SX1272_CHIP_VERSION, syncWord, currentLimit, preambleLength);
   RADIOLIB_ASSERT(state);
@@ -40,6 +42,8 @@ int16_t SX1272::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t sync
 }
 
 int16_t SX1272::beginFSK(float freq, float br, float rxBw, float freqDev, int8_t power, uint8_t currentLimit, uint16_t preambleLength, bool enableOOK) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // execute common part
   int16_t state = SX127x::beginFSK(SX1272_CHIP_VERSION, br, rxBw, freqDev, currentLimit, preambleLength, enableOOK);
   RADIOLIB_ASSERT(state);
@@ -60,9 +64,9 @@ int16_t SX1272::beginFSK(float freq, float br, float rxBw, float freqDev, int8_t
 void SX1272::reset() {
   Module::pinMode(_mod->getRst(), OUTPUT);
   Module::digitalWrite(_mod->getRst(), HIGH);
-  delay(1);
+  Module::delay(1);
   Module::digitalWrite(_mod->getRst(), LOW);
-  delay(5);
+  Module::delay(5);
 }
 
 int16_t SX1272::setFrequency(float freq) {
@@ -95,7 +99,8 @@ int16_t SX1272::setBandwidth(float bw) {
     return(ERR_INVALID_BANDWIDTH);
   }
 
-  // set bandwidth and if successful, save the new setting
+  // set bandwidth and low data rate optimization in a single register batch, and if successful, save the new setting
+  _mod->SPIbeginBatch();
   int16_t state = SX1272::setBandwidthRaw(newBandwidth);
   if(state == ERR_NONE) {
     SX127x::_bw = bw;
@@ -111,6 +116,7 @@ int16_t SX1272::setBandwidth(float bw) {
       state = _mod->SPIsetRegValue(SX127X_REG_MODEM_CONFIG_1, SX1272_LOW_DATA_RATE_OPT_OFF, 0, 0);
     }
   }
+  state |= _mod->SPIcommitBatch();
   return(state);
 }
 
@@ -149,7 +155,8 @@ int16_t SX1272::setSpreadingFactor(uint8_t sf) {
       return(ERR_INVALID_SPREADING_FACTOR);
   }
 
-  // set spreading factor and if successful, save the new setting
+  // set spreading factor and low data rate optimization in a single register batch, and if successful, save the new setting
+  _mod->SPIbeginBatch();
   int16_t state = SX1272::setSpreadingFactorRaw(newSpreadingFactor);
   if(state == ERR_NONE) {
     SX127x::_sf = sf;
@@ -165,6 +172,7 @@ int16_t SX1272::setSpreadingFactor(uint8_t sf) {
       state = _mod->SPIsetRegValue(SX127X_REG_MODEM_CONFIG_1, SX1272_LOW_DATA_RATE_OPT_OFF, 0, 0);
     }
   }
+  state |= _mod->SPIcommitBatch();
   return(state);
 }
 
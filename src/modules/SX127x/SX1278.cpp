@@ -5,6 +5,8 @@ SX1278::SX1278(Module* mod) : SX127x(mod) {
 }
 
 int16_t SX1278::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power, uint8_t currentLimit, uint16_t preambleLength, uint8_t gain) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // execute common part
   int16_t state = SX127x::begin(SX1278_CHIP_VERSION, syncWord, currentLimit, preambleLength);
   RADIOLIB_ASSERT(state);
@@ -35,6 +37,8 @@ int16_t SX1278::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t sync
 }
 
 int16_t SX1278::beginFSK(float freq, float br, float freqDev, float rxBw, int8_t power, uint8_t currentLimit, uint16_t preambleLength, bool enableOOK) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // execute common part
   int16_t state = SX127x::beginFSK(SX1278_CHIP_VERSION, br, freqDev, rxBw, currentLimit, preambleLength, enableOOK);
   RADIOLIB_ASSERT(state);
@@ -55,9 +59,9 @@ int16_t SX1278::beginFSK(float freq, float br, float freqDev, float rxBw, int8_t
 void SX1278::reset() {
   Module::pinMode(_mod->getRst(), OUTPUT);
   Module::digitalWrite(_mod->getRst(), LOW);
-  delay(1);
+  Module::delay(1);
   Module::digitalWrite(_mod->getRst(), HIGH);
-  delay(5);
+  Module::delay(5);
 }
 
 int16_t SX1278::setFrequency(float freq) {
@@ -167,7 +171,8 @@ int16_t SX1278::setBandwidth(float bw) {
     return(ERR_INVALID_BANDWIDTH);
   }
 
-  // set bandwidth and if successful, save the new setting
+  // set bandwidth and low data rate optimization in a single register batch, and if successful, save the new setting
+  _mod->SPIbeginBatch();
   int16_t state = SX1278::setBandwidthRaw(newBandwidth);
   if(state == ERR_NONE) {
     SX127x::_bw = bw;
@@ -183,6 +188,7 @@ int16_t SX1278::setBandwidth(float bw) {
       state = _mod->SPIsetRegValue(SX1278_REG_MODEM_CONFIG_3, SX1278_LOW_DATA_RATE_OPT_OFF, 3, 3);
     }
   }
+  state |= _mod->SPIcommitBatch();
   return(state);
 }
 
@@ -221,7 +227,8 @@ int16_t SX1278::setSpreadingFactor(uint8_t sf) {
       return(ERR_INVALID_SPREADING_FACTOR);
   }
 
-  // set spreading factor and if successful, save the new setting
+  // set spreading factor and low data rate optimization in a single register batch, and if successful, save the new setting
+  _mod->SPIbeginBatch();
   int16_t state = SX1278::setSpreadingFactorRaw(newSpreadingFactor);
   if(state == ERR_NONE) {
     SX127x::_sf = sf;
@@ -237,6 +244,7 @@ int16_t SX1278::setSpreadingFactor(uint8_t sf) {
       state = _mod->SPIsetRegValue(SX1278_REG_MODEM_CONFIG_3, SX1278_LOW_DATA_RATE_OPT_OFF, 3, 3);
     }
   }
+  state |= _mod->SPIcommitBatch();
   return(state);
 }
 
@@ -3,10 +3,20 @@
 SX127x::SX127x(Module* mod) : PhysicalLayer(SX127X_FREQUENCY_STEP_SIZE, SX127X_MAX_PACKET_LENGTH) {
   _mod = mod;
   _packetLengthQueried = false;
+  _payloadLength = SX127X_MAX_PACKET_LENGTH_FSK;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
 }
 
 int16_t SX127x::begin(uint8_t chipVersion, uint8_t syncWord, uint8_t currentLimit, uint16_t preambleLength) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
+  _mod->SPIvolatileRegs = SX127xVolatileRegsLoRa;
+  _mod->SPIvolatileRegsLen = sizeof(SX127xVolatileRegsLoRa);
+  _mod->SPIslowRegs = SX127xSlowRegs;
+  _mod->SPIslowRegsLen = sizeof(SX127xSlowRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT_PULLUP);
   Module::pinMode(_mod->getGpio(), INPUT);
@@ -50,7 +60,14 @@ int16_t SX127x::begin(uint8_t chipVersion, uint8_t syncWord, uint8_t currentLimi
 }
 
 int16_t SX127x::beginFSK(uint8_t chipVersion, float br, float freqDev, float rxBw, uint8_t currentLimit, uint16_t preambleLength, bool enableOOK) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
+  _mod->SPIvolatileRegs = SX127xVolatileRegsFSK;
+  _mod->SPIvolatileRegsLen = sizeof(SX127xVolatileRegsFSK);
+  _mod->SPIslowRegs = SX127xSlowRegs;
+  _mod->SPIslowRegsLen = sizeof(SX127xSlowRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
 
@@ -119,6 +136,14 @@ int16_t SX127x::beginFSK(uint8_t chipVersion, float br, float freqDev, float rxB
 }
 
 int16_t SX127x::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(transmit(&seg, 1, addr));
+}
+
+int16_t SX127x::transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // set mode to standby
   int16_t state = setMode(SX127X_STANDBY);
 
@@ -138,17 +163,14 @@ int16_t SX127x::transmit(uint8_t* data, size_t len, uint8_t addr) {
     uint32_t timeout = ceil(symbolLength * (n_pre + n_pay + 4.25) * 1500.0);
 
     // start transmission
-    state = startTransmit(data, len, addr);
+    state = startTransmit(segs, numSegs, addr);
     RADIOLIB_ASSERT(state);
 
     // wait for packet transmission or timeout
-    start = micros();
-    while(!digitalRead(_mod->getIrq())) {
-      yield();
-      if(micros() - start > timeout) {
-        clearIRQFlags();
-        return(ERR_TX_TIMEOUT);
-      }
+    start = Module::micros();
+    if(!Module::waitForPin(_mod->getIrq(), HIGH, timeout / 1000 + 1)) {
+      clearIRQFlags();
+      return(ERR_TX_TIMEOUT);
     }
 
   } else if(modem == SX127X_FSK_OOK) {
@@ -156,25 +178,30 @@ int16_t SX127x::transmit(uint8_t* data, size_t len, uint8_t addr) {
     uint32_t timeout = 5000000 + (uint32_t)((((float)(len * 8)) / (_br * 1000.0)) * 5000000.0);
 
     // start transmission
-    state = startTransmit(data, len, addr);
+    state = startTransmit(segs, numSegs, addr);
     RADIOLIB_ASSERT(state);
 
-    // wait for transmission end or timeout
-    start = micros();
-    while(!digitalRead(_mod->getIrq())) {
-      yield();
-      if(micros() - start > timeout) {
-        clearIRQFlags();
-        standby();
-        return(ERR_TX_TIMEOUT);
-      }
+    // wait for transmission end or timeout, FIFO of packets longer than it is refilled whenever its level drops to the threshold (DIO1 low)
+    start = Module::micros();
+    uint32_t timeoutMs = timeout / 1000 + 1;
+    uint32_t startMs = Module::millis();
+    bool sent = true;
+    while(sent && !serviceFifo()) {
+      uint32_t elapsed = Module::millis() - startMs;
+      sent = (elapsed < timeoutMs) && Module::waitForPin(_mod->getGpio(), LOW, timeoutMs - elapsed);
+    }
+    uint32_t elapsed = Module::millis() - startMs;
+    if(!sent || (elapsed >= timeoutMs) || !Module::waitForPin(_mod->getIrq(), HIGH, timeoutMs - elapsed)) {
+      clearIRQFlags();
+      standby();
+      return(ERR_TX_TIMEOUT);
     }
   } else {
     return(ERR_UNKNOWN);
   }
 
   // update data rate
-  uint32_t elapsed = micros() - start;
+  uint32_t elapsed = Module::micros() - start;
   _dataRate = (len*8.0)/((float)elapsed/1000000.0);
 
   // clear interrupt flags
@@ -185,6 +212,8 @@ int16_t SX127x::transmit(uint8_t* data, size_t len, uint8_t addr) {
 }
 
 int16_t SX127x::receive(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
+
   // set mode to standby
   int16_t state = setMode(SX127X_STANDBY);
 
@@ -194,31 +223,41 @@ int16_t SX127x::receive(uint8_t* data, size_t len) {
     state = startReceive(len, SX127X_RXSINGLE);
     RADIOLIB_ASSERT(state);
 
-    // wait for packet reception or timeout (100 LoRa symbols)
-    while(!digitalRead(_mod->getIrq())) {
-      yield();
-      if(digitalRead(_mod->getGpio())) {
-        clearIRQFlags();
-        return(ERR_RX_TIMEOUT);
-      }
+    // wait for packet reception (DIO0) or timeout after 100 LoRa symbols (DIO1)
+    while(!Module::waitForPins(_mod->getIrq(), HIGH, _mod->getGpio(), HIGH, RADIOLIB_WAIT_SLICE));
+    if(!Module::digitalRead(_mod->getIrq())) {
+      clearIRQFlags();
+      return(ERR_RX_TIMEOUT);
     }
 
   } else if(modem == SX127X_FSK_OOK) {
     // calculate timeout (500 % of expected time-one-air)
     uint32_t timeout = (uint32_t)((((float)(len * 8)) / (_br * 1000.0)) * 5000000.0);
 
-    // set mode to receive
-    state = startReceive(len, SX127X_RX);
+    // set mode to receive, packets that may not fit into FIFO are drained while they are being received
+    if(_payloadLength > SX127X_MAX_PACKET_LENGTH_FSK) {
+      state = startReceiveStream(data, len);
+    } else {
+      state = startReceive(len, SX127X_RX);
+    }
     RADIOLIB_ASSERT(state);
 
-    // wait for packet reception or timeout
-    uint32_t start = micros();
-    while(!digitalRead(_mod->getIrq())) {
-      yield();
-      if(micros() - start > timeout) {
-        clearIRQFlags();
-        return(ERR_RX_TIMEOUT);
+    // wait for packet reception or timeout, packet that may not fit into FIFO is drained whenever its level exceeds the threshold (DIO1 high)
+    // without DIO1, FIFO level is polled
+    uint32_t timeoutMs = timeout / 1000 + 1;
+    uint32_t start = Module::millis();
+    bool received = true;
+    if(_fifoRxActive) {
+      while(received && !serviceFifo()) {
+        uint32_t elapsed = Module::millis() - start;
+        received = (elapsed < timeoutMs) && ((_mod->getGpio() == RADIOLIB_NC) || Module::waitForPins(_mod->getGpio(), HIGH, _mod->getIrq(), HIGH, timeoutMs - elapsed));
       }
+    } else {
+      received = Module::waitForPin(_mod->getIrq(), HIGH, timeoutMs);
+    }
+    if(!received) {
+      clearIRQFlags();
+      return(ERR_RX_TIMEOUT);
     }
   }
 
@@ -229,6 +268,26 @@ int16_t SX127x::receive(uint8_t* data, size_t len) {
 }
 
 int16_t SX127x::scanChannel() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_SCAN_CHANNEL);
+
+  // start channel activity detection
+  int16_t state = startChannelScan();
+  RADIOLIB_ASSERT(state);
+
+  // wait for channel activity detection done (DIO0) or channel activity detected (DIO1)
+  while(!Module::waitForPins(_mod->getIrq(), HIGH, _mod->getGpio(), HIGH, RADIOLIB_WAIT_SLICE));
+  if(!Module::digitalRead(_mod->getIrq())) {
+    clearIRQFlags();
+    return(PREAMBLE_DETECTED);
+  }
+
+  // clear interrupt flags
+  clearIRQFlags();
+
+  return(CHANNEL_FREE);
+}
+
+int16_t SX127x::startChannelScan() {
   // check active modem
   if(getActiveModem() != SX127X_LORA) {
     return(ERR_WRONG_MODEM);
@@ -246,22 +305,7 @@ int16_t SX127x::scanChannel() {
   clearIRQFlags();
 
   // set mode to CAD
-  state = setMode(SX127X_CAD);
-  RADIOLIB_ASSERT(state);
-
-  // wait for channel activity detected or timeout
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-    if(digitalRead(_mod->getGpio())) {
-      clearIRQFlags();
-      return(PREAMBLE_DETECTED);
-    }
-  }
-
-  // clear interrupt flags
-  clearIRQFlags();
-
-  return(CHANNEL_FREE);
+  return(setMode(SX127X_CAD));
 }
 
 int16_t SX127x::sleep() {
@@ -270,6 +314,8 @@ int16_t SX127x::sleep() {
 }
 
 int16_t SX127x::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   // set mode to standby
   return(setMode(SX127X_STANDBY));
 }
@@ -333,10 +379,21 @@ int16_t SX127x::packetMode() {
   return(_mod->SPIsetRegValue(SX127X_REG_PACKET_CONFIG_2, SX127X_DATA_MODE_PACKET, 6, 6));
 }
 
+int16_t SX127x::startReceive() {
+  return(startReceive(0, SX127X_RXCONTINUOUS));
+}
+
 int16_t SX127x::startReceive(uint8_t len, uint8_t mode) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
   // set mode to standby
   int16_t state = setMode(SX127X_STANDBY);
 
+  // drop any packet that was being streamed
+  _fifoTx.clear();
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+
   int16_t modem = getActiveModem();
   if(modem == SX127X_LORA) {
     // set DIO pin mapping
@@ -357,7 +414,7 @@ int16_t SX127x::startReceive(uint8_t len, uint8_t mode) {
 
   } else if(modem == SX127X_FSK_OOK) {
     // set DIO pin mapping
-    state |= _mod->SPIsetRegValue(SX127X_REG_DIO_MAPPING_1, SX127X_DIO0_PACK_PAYLOAD_READY, 7, 6);
+    state |= _mod->SPIsetRegValue(SX127X_REG_DIO_MAPPING_1, SX127X_DIO0_PACK_PAYLOAD_READY | SX127X_DIO1_PACK_FIFO_LEVEL, 7, 4);
 
     // clear interrupt flags
     clearIRQFlags();
@@ -372,8 +429,68 @@ int16_t SX127x::startReceive(uint8_t len, uint8_t mode) {
   return(setMode(mode));
 }
 
+int16_t SX127x::startReceiveStream(uint8_t* data, size_t len) {
+  // check active modem
+  if(getActiveModem() != SX127X_FSK_OOK) {
+    return(ERR_WRONG_MODEM);
+  }
+
+  int16_t state = startReceive();
+  RADIOLIB_ASSERT(state);
+
+  // length of variable length packet is only known once its first byte is drained
+  uint8_t addrLen = getAddressLength();
+  _fifoHeaderLen = addrLen;
+  _fifoLen = 0;
+  if(_packetLengthConfig == SX127X_PACKET_VARIABLE) {
+    _fifoHeaderLen++;
+  } else if(_payloadLength > addrLen) {
+    _fifoLen = _payloadLength - addrLen;
+  }
+  _fifoRxData = data;
+  _fifoRxSize = len;
+  _fifoPos = 0;
+  _fifoRxActive = true;
+  return(state);
+}
+
+bool SX127x::serviceFifo() {
+  if(_fifoTx.isActive()) {
+    // refill only after FIFO level dropped to the threshold, so that the whole chunk fits
+    if(_mod->SPIreadRegister(SX127X_REG_IRQ_FLAGS_2) & SX127X_FLAG_FIFO_LEVEL) {
+      return(false);
+    }
+    writeFifo(SX127X_FIFO_CHUNK_SIZE);
+    if(_fifoTx.isActive()) {
+      return(false);
+    }
+
+  } else if(_fifoRxActive) {
+    // the end of the packet is drained after it passed CRC check
+    uint8_t flags = _mod->SPIreadRegister(SX127X_REG_IRQ_FLAGS_2);
+    if(flags & SX127X_FLAG_PAYLOAD_READY) {
+      drainFifo(true);
+      _fifoRxActive = false;
+    } else {
+      if(flags & SX127X_FLAG_FIFO_LEVEL) {
+        drainFifo(false);
+      }
+      return(false);
+    }
+  }
+
+  return(true);
+}
+
+void SX127x::setFifoAction(void (*func)(void)) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
+    return;
+  }
+  Module::attachInterrupt(_mod->getGpio(), func, CHANGE);
+}
+
 void SX127x::setDio0Action(void (*func)(void)) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, RISING);
+  Module::attachInterrupt(_mod->getIrq(), func, RISING);
 }
 
 // Only needed on ESP32 targets. FIXME - move someplace better
@@ -383,27 +500,108 @@ void SX127x::setDio0Action(void (*func)(void)) {
 
 void IRAM_ATTR SX127x::clearDio0Action()
 {
-    detachInterrupt(digitalPinToInterrupt(_mod->getIrq()));
+    Module::detachInterrupt(_mod->getIrq());
 }
 
 void SX127x::setDio1Action(void (*func)(void)) {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
-  attachInterrupt(digitalPinToInterrupt(_mod->getGpio()), func, RISING);
+  Module::attachInterrupt(_mod->getGpio(), func, RISING);
 }
 
 void SX127x::clearDio1Action() {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
-  detachInterrupt(digitalPinToInterrupt(_mod->getGpio()));
+  Module::detachInterrupt(_mod->getGpio());
+}
+
+bool SX127x::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source == 0) && (_mod->getIrq() != RADIOLIB_NC)) {
+    if(func == NULL) {
+      clearDio0Action();
+    } else {
+      setDio0Action(func);
+    }
+    return(true);
+  } else if((source == 1) && (_mod->getGpio() != RADIOLIB_NC)) {
+    if(func == NULL) {
+      clearDio1Action();
+    } else {
+      setDio1Action(func);
+    }
+    return(true);
+  }
+  return(false);
+}
+
+uint16_t SX127x::getEvents() {
+  uint16_t events = RADIOLIB_EVENT_NONE;
+  if(getActiveModem() == SX127X_LORA) {
+    uint8_t flags = _mod->SPIreadRegister(SX127X_REG_IRQ_FLAGS);
+    if(flags & SX127X_CLEAR_IRQ_FLAG_TX_DONE) {
+      events |= RADIOLIB_EVENT_TX_DONE;
+    }
+    if(flags & SX127X_CLEAR_IRQ_FLAG_RX_DONE) {
+      events |= RADIOLIB_EVENT_RX_DONE;
+    }
+    if(flags & SX127X_CLEAR_IRQ_FLAG_PAYLOAD_CRC_ERROR) {
+      events |= RADIOLIB_EVENT_CRC_ERROR;
+    }
+    if(flags & SX127X_CLEAR_IRQ_FLAG_CAD_DONE) {
+      events |= RADIOLIB_EVENT_CAD_DONE;
+    }
+    if(flags & SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED) {
+      events |= RADIOLIB_EVENT_CAD_DETECTED;
+    }
+    if(flags & SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT) {
+      events |= RADIOLIB_EVENT_TIMEOUT;
+    }
+
+  } else {
+    // keep packets longer than FIFO moving when the operation is polled
+    serviceFifo();
+
+    // payload ready is only set for packets that passed CRC check
+    uint8_t flags1 = _mod->SPIreadRegister(SX127X_REG_IRQ_FLAGS_1);
+    uint8_t flags2 = _mod->SPIreadRegister(SX127X_REG_IRQ_FLAGS_2);
+    if(flags2 & SX127X_FLAG_PACKET_SENT) {
+      events |= RADIOLIB_EVENT_TX_DONE;
+    }
+    if(flags2 & SX127X_FLAG_PAYLOAD_READY) {
+      events |= RADIOLIB_EVENT_RX_DONE;
+    }
+    if(flags1 & SX127X_FLAG_PREAMBLE_DETECT) {
+      events |= RADIOLIB_EVENT_PREAMBLE_DETECTED;
+    }
+    if(flags1 & SX127X_FLAG_SYNC_ADDRESS_MATCH) {
+      events |= RADIOLIB_EVENT_SYNC_WORD;
+    }
+    if(flags1 & SX127X_FLAG_TIMEOUT) {
+      events |= RADIOLIB_EVENT_TIMEOUT;
+    }
+  }
+  return(events);
 }
 
 int16_t SX127x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(startTransmit(&seg, 1, addr));
+}
+
+int16_t SX127x::startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // set mode to standby
   int16_t state = setMode(SX127X_STANDBY);
 
+  // drop any packet that was being streamed
+  _fifoTx.clear();
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+
   int16_t modem = getActiveModem();
   if(modem == SX127X_LORA) {
     // check packet length
@@ -425,7 +623,9 @@ int16_t SX127x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
     state |= _mod->SPIsetRegValue(SX127X_REG_FIFO_ADDR_PTR, SX127X_FIFO_TX_BASE_ADDR_MAX);
 
     // write packet to FIFO
-    _mod->SPIwriteRegisterBurst(SX127X_REG_FIFO, data, len);
+    for(size_t i = 0; i < numSegs; i++) {
+      _mod->SPIwriteRegisterBurst(SX127X_REG_FIFO, segs[i].data, segs[i].len);
+    }
 
     // start transmission
     state |= setMode(SX127X_TX);
@@ -434,28 +634,36 @@ int16_t SX127x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
     return(ERR_NONE);
 
   } else if(modem == SX127X_FSK_OOK) {
-    // check packet length
-    if(len >= SX127X_MAX_PACKET_LENGTH_FSK) {
+    // check packet length, fixed length packet must not be longer than the configured length
+    uint8_t addrLen = getAddressLength();
+    bool variable = (_packetLengthConfig == SX127X_PACKET_VARIABLE);
+    if((variable && (len > SX127X_MAX_PACKET_LENGTH)) || (!variable && (len + addrLen > _payloadLength))) {
       return(ERR_PACKET_TOO_LONG);
     }
 
+    // segment descriptors are copied, packet longer than FIFO is written after this method returns
+    if(_fifoTx.set(segs, numSegs) != ERR_NONE) {
+      return(ERR_TOO_MANY_SEGMENTS);
+    }
+
     // set DIO mapping
-    _mod->SPIsetRegValue(SX127X_REG_DIO_MAPPING_1, SX127X_DIO0_PACK_PACKET_SENT, 7, 6);
+    _mod->SPIsetRegValue(SX127X_REG_DIO_MAPPING_1, SX127X_DIO0_PACK_PACKET_SENT | SX127X_DIO1_PACK_FIFO_LEVEL, 7, 4);
 
     // clear interrupt flags
     clearIRQFlags();
 
     // set packet length
-    _mod->SPIwriteRegister(SX127X_REG_FIFO, len);
+    if(variable) {
+      _mod->SPIwriteRegister(SX127X_REG_FIFO, len);
+    }
 
     // check address filtering
-    uint8_t filter = _mod->SPIgetRegValue(SX127X_REG_PACKET_CONFIG_1, 2, 1);
-    if((filter == SX127X_ADDRESS_FILTERING_NODE) || (filter == SX127X_ADDRESS_FILTERING_NODE_BROADCAST)) {
+    if(addrLen > 0) {
       _mod->SPIwriteRegister(SX127X_REG_FIFO, addr);
     }
 
-    // write packet to FIFO
-    _mod->SPIwriteRegisterBurst(SX127X_REG_FIFO, data, len);
+    // write as much of the packet as fits into FIFO, the rest is written by serviceFifo
+    writeFifo(SX127X_MAX_PACKET_LENGTH_FSK - addrLen - (variable ? 1 : 0));
 
     // start transmission
     state |= setMode(SX127X_TX);
@@ -467,17 +675,55 @@ int16_t SX127x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   return(ERR_UNKNOWN);
 }
 
+int16_t SX127x::finishTransmit() {
+  // clear interrupt flags
+  clearIRQFlags();
+
+  // set mode to standby to disable transmitter
+  return(standby());
+}
+
 int16_t SX127x::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
   int16_t modem = getActiveModem();
   size_t length = len;
 
   // put module to standby
   standby();
 
+  // streamed packet is already in the stream buffer, except for its end
+  if(_fifoRxData != NULL) {
+    if(_fifoRxActive) {
+      drainFifo(true);
+      _fifoRxActive = false;
+    }
+    if((len == 0) || (len > _fifoLen)) {
+      length = _fifoLen;
+    }
+    if(length > _fifoRxSize) {
+      length = _fifoRxSize;
+    }
+    if(data != _fifoRxData) {
+      memcpy(data, _fifoRxData, length);
+    }
+
+    // the rest of packet longer than the stream buffer was dropped while draining
+    int16_t state = (_fifoLen > _fifoRxSize) ? ERR_PACKET_TOO_LONG : ERR_NONE;
+    _packetLength = _fifoLen;
+    _fifoRxData = NULL;
+    _packetLengthQueried = false;
+    clearIRQFlags();
+    return(state);
+  }
+
+  // read packet length only once, it is also needed to dump bytes that weren't requested
+  size_t packetLength = getPacketLength();
+
   if(modem == SX127X_LORA) {
-    // len set to maximum indicates unknown packet length, read the number of actually received bytes
+    // len set to maximum indicates unknown packet length, use the number of actually received bytes
     if(len == SX127X_MAX_PACKET_LENGTH) {
-      length = getPacketLength();
+      length = packetLength;
     }
 
     // check integrity CRC
@@ -489,8 +735,10 @@ int16_t SX127x::readData(uint8_t* data, size_t len) {
     }
 
   } else if(modem == SX127X_FSK_OOK) {
-    // read packet length (always required in FSK)
-    length = getPacketLength();
+    // packet length is always known in FSK, so len set to 0 or maximum reads the whole packet, but never more than was requested
+    if((len == 0) || (len == SX127X_MAX_PACKET_LENGTH) || (packetLength < length)) {
+      length = packetLength;
+    }
 
     // check address filtering
     uint8_t filter = _mod->SPIgetRegValue(SX127X_REG_PACKET_CONFIG_1, 2, 1);
@@ -503,7 +751,6 @@ int16_t SX127x::readData(uint8_t* data, size_t len) {
   _mod->SPIreadRegisterBurst(SX127X_REG_FIFO, length, data);
 
   // dump bytes that weren't requested
-  size_t packetLength = getPacketLength();
   if(packetLength > length) {
     clearFIFO(packetLength - length);
   }
@@ -835,9 +1082,11 @@ int16_t SX127x::setFrequencyRaw(float newFreq) {
   uint32_t FRF = (newFreq * (uint32_t(1) << SX127X_DIV_EXPONENT)) / SX127X_CRYSTAL_FREQ;
 
   // write registers
+  _mod->SPIbeginBatch();
   state |= _mod->SPIsetRegValue(SX127X_REG_FRF_MSB, (FRF & 0xFF0000) >> 16);
   state |= _mod->SPIsetRegValue(SX127X_REG_FRF_MID, (FRF & 0x00FF00) >> 8);
   state |= _mod->SPIsetRegValue(SX127X_REG_FRF_LSB, FRF & 0x0000FF);
+  state |= _mod->SPIcommitBatch();
   return(state);
 }
 
@@ -856,8 +1105,14 @@ size_t SX127x::getPacketLength(bool update) {
 
   } else if(modem == SX127X_FSK_OOK) {
     // get packet length
-    if(!_packetLengthQueried && update) {
-      _packetLength = _mod->SPIreadRegister(SX127X_REG_FIFO);
+    if(_fifoRxData != NULL) {
+      _packetLength = _fifoLen;
+    } else if(!_packetLengthQueried && update) {
+      if(_packetLengthConfig == SX127X_PACKET_VARIABLE) {
+        _packetLength = _mod->SPIreadRegister(SX127X_REG_FIFO);
+      } else {
+        _packetLength = _payloadLength - getAddressLength();
+      }
       _packetLengthQueried = true;
     }
   }
@@ -865,7 +1120,7 @@ size_t SX127x::getPacketLength(bool update) {
   return(_packetLength);
 }
 
-int16_t SX127x::fixedPacketLengthMode(uint8_t len) {
+int16_t SX127x::fixedPacketLengthMode(uint16_t len) {
   return(SX127x::setPacketMode(SX127X_PACKET_FIXED, len));
 }
 
@@ -963,9 +1218,9 @@ int16_t SX127x::configFSK() {
   return(state);
 }
 
-int16_t SX127x::setPacketMode(uint8_t mode, uint8_t len) {
-  // check packet length
-  if (len > SX127X_MAX_PACKET_LENGTH_FSK) {
+int16_t SX127x::setPacketMode(uint8_t mode, uint16_t len) {
+  // check packet length, packets longer than FIFO are streamed through it
+  if(((mode == SX127X_PACKET_FIXED) && (len > SX127X_MAX_PACKET_LENGTH_FSK_FIXED)) || ((mode == SX127X_PACKET_VARIABLE) && (len > SX127X_MAX_PACKET_LENGTH))) {
     return(ERR_PACKET_TOO_LONG);
   }
 
@@ -979,11 +1234,14 @@ int16_t SX127x::setPacketMode(uint8_t mode, uint8_t len) {
   RADIOLIB_ASSERT(state);
 
   // set length to register
-  state = _mod->SPIsetRegValue(SX127X_REG_PAYLOAD_LENGTH_FSK, len);
+  state = _mod->SPIsetRegValue(SX127X_REG_PACKET_CONFIG_2, len >> 8, 2, 0);
+  state |= _mod->SPIsetRegValue(SX127X_REG_PAYLOAD_LENGTH_FSK, len & 0xFF);
   RADIOLIB_ASSERT(state);
 
-  // update cached value
+  // update cached values, fixed length packets can be longer than the maximum length in variable length mode
   _packetLengthConfig = mode;
+  _payloadLength = len;
+  setMaxPacketLength(((mode == SX127X_PACKET_FIXED) && (len > SX127X_MAX_PACKET_LENGTH)) ? len : SX127X_MAX_PACKET_LENGTH);
   return(state);
 }
 
@@ -1010,7 +1268,7 @@ bool SX127x::findChip(uint8_t ver) {
         RADIOLIB_DEBUG_PRINT(F(", expected 0x00"));
         RADIOLIB_DEBUG_PRINTLN(ver, HEX);
       #endif
-      delay(10);
+      Module::delay(10);
       i++;
     }
   }
@@ -1033,6 +1291,17 @@ int16_t SX127x::setActiveModem(uint8_t modem) {
   // set modem
   state |= _mod->SPIsetRegValue(SX127X_REG_OP_MODE, modem, 7, 7, 5);
 
+  // register map differs between modems, so the register cache has to start over
+  if(modem == SX127X_LORA) {
+    _mod->SPIvolatileRegs = SX127xVolatileRegsLoRa;
+    _mod->SPIvolatileRegsLen = sizeof(SX127xVolatileRegsLoRa);
+    setMaxPacketLength(SX127X_MAX_PACKET_LENGTH);
+  } else {
+    _mod->SPIvolatileRegs = SX127xVolatileRegsFSK;
+    _mod->SPIvolatileRegsLen = sizeof(SX127xVolatileRegsFSK);
+  }
+  _mod->clearRegisterCache();
+
   // set mode to STANDBY
   state |= setMode(SX127X_STANDBY);
   return(state);
@@ -1055,6 +1324,56 @@ void SX127x::clearFIFO(size_t count) {
   }
 }
 
+void SX127x::writeFifo(size_t count) {
+  size_t len = 0;
+  uint8_t* data = _fifoTx.next(count, &len);
+  while(data != NULL) {
+    _mod->SPIwriteRegisterBurst(SX127X_REG_FIFO, data, len);
+    count -= len;
+    data = _fifoTx.next(count, &len);
+  }
+}
+
+void SX127x::drainFifo(bool all) {
+  size_t count = SX127X_FIFO_CHUNK_SIZE;
+
+  // length and address bytes are at the start of the first chunk
+  if(_fifoHeaderLen > 0) {
+    if(_packetLengthConfig == SX127X_PACKET_VARIABLE) {
+      _fifoLen = _mod->SPIreadRegister(SX127X_REG_FIFO);
+      _fifoHeaderLen--;
+      count--;
+    }
+    clearFIFO(_fifoHeaderLen);
+    count -= _fifoHeaderLen;
+    _fifoHeaderLen = 0;
+  }
+
+  if(all || (count > _fifoLen - _fifoPos)) {
+    count = _fifoLen - _fifoPos;
+  }
+
+  // bytes that do not fit into the buffer are dumped
+  size_t len = 0;
+  if(_fifoPos < _fifoRxSize) {
+    len = _fifoRxSize - _fifoPos;
+    if(len > count) {
+      len = count;
+    }
+    _mod->SPIreadRegisterBurst(SX127X_REG_FIFO, len, &_fifoRxData[_fifoPos]);
+  }
+  clearFIFO(count - len);
+  _fifoPos += count;
+}
+
+uint8_t SX127x::getAddressLength() {
+  uint8_t filter = _mod->SPIgetRegValue(SX127X_REG_PACKET_CONFIG_1, 2, 1);
+  if((filter == SX127X_ADDRESS_FILTERING_NODE) || (filter == SX127X_ADDRESS_FILTERING_NODE_BROADCAST)) {
+    return(1);
+  }
+  return(0);
+}
+
 #ifdef RADIOLIB_DEBUG
 void SX127x::regDump() {
   RADIOLIB_DEBUG_PRINTLN();
@@ -1075,7 +1394,7 @@ void SX127x::regDump() {
     }
     RADIOLIB_DEBUG_PRINTLN(val, HEX);
 
-    delay(50);
+    Module::delay(50);
   }
 }
 #endif
@@ -10,6 +10,8 @@
 #define SX127X_FREQUENCY_STEP_SIZE                    61.03515625
 #define SX127X_MAX_PACKET_LENGTH                      255
 #define SX127X_MAX_PACKET_LENGTH_FSK                  64
+#define SX127X_MAX_PACKET_LENGTH_FSK_FIXED            2047
+#define SX127X_FIFO_CHUNK_SIZE                        32
 #define SX127X_CRYSTAL_FREQ                           32.0
 #define SX127X_DIV_EXPONENT                           19
 
@@ -397,7 +399,7 @@
 // SX127X_REG_FIFO_THRESH
 #define SX127X_TX_START_FIFO_LEVEL                    0b00000000  //  7     7     start packet transmission when: number of bytes in FIFO exceeds FIFO_THRESHOLD
 #define SX127X_TX_START_FIFO_NOT_EMPTY                0b10000000  //  7     7                                     at least one byte in FIFO (default)
-#define SX127X_FIFO_THRESH                            0x0F        //  5     0     FIFO level threshold
+#define SX127X_FIFO_THRESH                            0x1F        //  5     0     FIFO level threshold
 
 // SX127X_REG_SEQ_CONFIG_1
 #define SX127X_SEQUENCER_START                        0b10000000  //  7     7     manually start sequencer
@@ -524,6 +526,28 @@
 #define SX127X_PLL_BANDWIDTH_225_KHZ                  0b10000000  //  7     6                    225 kHz
 #define SX127X_PLL_BANDWIDTH_300_KHZ                  0b11000000  //  7     6                    300 kHz (default)
 
+// SX127x registers that are never served from register cache, LoRa modem
+static const uint8_t SX127xVolatileRegsLoRa[] PROGMEM = {
+  SX127X_REG_FIFO, SX127X_REG_OP_MODE, SX127X_REG_FIFO_ADDR_PTR, SX127X_REG_FIFO_RX_CURRENT_ADDR,
+  SX127X_REG_IRQ_FLAGS, SX127X_REG_RX_NB_BYTES, SX127X_REG_RX_HEADER_CNT_VALUE_MSB, SX127X_REG_RX_HEADER_CNT_VALUE_LSB,
+  SX127X_REG_RX_PACKET_CNT_VALUE_MSB, SX127X_REG_RX_PACKET_CNT_VALUE_LSB, SX127X_REG_MODEM_STAT, SX127X_REG_PKT_SNR_VALUE,
+  SX127X_REG_PKT_RSSI_VALUE, SX127X_REG_RSSI_VALUE, SX127X_REG_HOP_CHANNEL, SX127X_REG_FIFO_RX_BYTE_ADDR,
+  SX127X_REG_FEI_MSB, SX127X_REG_FEI_MID, SX127X_REG_FEI_LSB, SX127X_REG_RSSI_WIDEBAND
+};
+
+// SX127x registers that are never served from register cache, FSK/OOK modem
+static const uint8_t SX127xVolatileRegsFSK[] PROGMEM = {
+  SX127X_REG_FIFO, SX127X_REG_OP_MODE, SX127X_REG_RX_CONFIG, SX127X_REG_RSSI_VALUE_FSK,
+  SX127X_REG_AFC_FEI, SX127X_REG_AFC_MSB, SX127X_REG_AFC_LSB, SX127X_REG_FEI_MSB_FSK,
+  SX127X_REG_FEI_LSB_FSK, SX127X_REG_SEQ_CONFIG_1, SX127X_REG_IMAGE_CAL, SX127X_REG_TEMP,
+  SX127X_REG_IRQ_FLAGS_1, SX127X_REG_IRQ_FLAGS_2
+};
+
+// SX127x registers that need some time to process the change after being written, both modems
+static const uint8_t SX127xSlowRegs[] PROGMEM = {
+  SX127X_REG_OP_MODE
+};
+
 /*!
   \class SX127x
 
@@ -591,7 +615,7 @@ class SX127x: public PhysicalLayer {
     int16_t beginFSK(uint8_t chipVersion, float br, float freqDev, float rxBw, uint8_t currentLimit, uint16_t preambleLength, bool enableOOK);
 
     /*!
-      \brief Binary transmit method. Will transmit arbitrary binary data up to 255 bytes long using %LoRa or up to 63 bytes using FSK modem.
+      \brief Binary transmit method. Will transmit arbitrary binary data up to 255 bytes long using %LoRa or up to 255 bytes using FSK modem (2047 bytes in fixed packet length mode).
       For overloads to transmit Arduino String or C-string, see PhysicalLayer::transmit.
 
       \param data Binary data that will be transmitted.
@@ -605,7 +629,20 @@ class SX127x: public PhysicalLayer {
     int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
     /*!
-      \brief Binary receive method. Will attempt to receive arbitrary binary data up to 255 bytes long using %LoRa or up to 63 bytes using FSK modem.
+      \brief Scatter-gather transmit method. Segments are burst-written to FIFO one after another, without copying them into a single buffer.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Binary receive method. Will attempt to receive arbitrary binary data up to 255 bytes long using %LoRa or up to 255 bytes using FSK modem (2047 bytes in fixed packet length mode).
       For overloads to receive Arduino String, see PhysicalLayer::receive.
 
       \param data Pointer to array to save the received binary data.
@@ -623,6 +660,13 @@ class SX127x: public PhysicalLayer {
     */
     int16_t scanChannel();
 
+    /*!
+      \brief Interrupt-driven channel activity detection method. DIO0 will be activated when the scan is finished.
+
+      \returns \ref status_codes
+    */
+    int16_t startChannelScan();
+
     /*!
       \brief Sets the %LoRa module to sleep to save power. %Module will not be able to transmit or receive any data while in sleep mode.
       %Module will wake up automatically when methods like transmit or receive are called.
@@ -690,7 +734,26 @@ class SX127x: public PhysicalLayer {
     void clearDio1Action();
 
     /*!
-      \brief Interrupt-driven binary transmit method. Will start transmitting arbitrary binary data up to 255 bytes long using %LoRa or up to 63 bytes using FSK modem.
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is DIO0, source 1 is DIO1.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
+    /*!
+      \brief Interrupt-driven binary transmit method. Will start transmitting arbitrary binary data up to 255 bytes long using %LoRa or up to 255 bytes using FSK modem (2047 bytes in fixed packet length mode).
+      FSK packets longer than FIFO are streamed through it, see SX127x::serviceFifo. The data must then stay valid until the transmission is finished.
 
       \param data Binary data that will be transmitted.
 
@@ -702,6 +765,34 @@ class SX127x: public PhysicalLayer {
     */
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Interrupt-driven scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+      In FSK mode, segment descriptors are copied (see TxSegmentStream), so only the data they point to has to stay valid until the transmission is finished.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments, at most RADIOLIB_TX_SEGMENTS_MAX in FSK mode.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - clears IRQ flags and sets module to standby.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
+    /*!
+      \brief Interrupt-driven receive method in RxContinuous mode. DIO0 will be activated when full valid packet is received.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceive();
+
     /*!
       \brief Interrupt-driven receive method. DIO0 will be activated when full valid packet is received.
 
@@ -711,10 +802,41 @@ class SX127x: public PhysicalLayer {
 
       \returns \ref status_codes
     */
-    int16_t startReceive(uint8_t len = 0, uint8_t mode = SX127X_RXCONTINUOUS);
+    int16_t startReceive(uint8_t len, uint8_t mode = SX127X_RXCONTINUOUS);
+
+    /*!
+      \brief Interrupt-driven receive method for FSK packets longer than FIFO, in RxContinuous mode. Received bytes are drained from FIFO into the buffer
+      by SX127x::serviceFifo while the packet is being received. DIO0 will be activated when full valid packet is received, readData then reads the rest of it.
+      Only available in FSK mode.
+
+      \param data Buffer to save the received packet to, must stay valid until the packet is read. Bytes that do not fit into it are dropped,
+      readData then returns ERR_PACKET_TOO_LONG.
+
+      \param len Size of the buffer.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceiveStream(uint8_t* data, size_t len);
+
+    /*!
+      \brief Moves the next chunk of FSK packet longer than FIFO between FIFO and user buffer: refills FIFO during transmission started by startTransmit,
+      or drains it during reception started by startReceiveStream. Must be called whenever FIFO level crosses the threshold, either from interrupt service routine
+      set by setFifoAction or by polling it often enough, but not from both. Blocking transmit and receive methods call it on their own.
+
+      \returns True when there is nothing left to move (the whole packet was written to or read from FIFO), false otherwise.
+    */
+    bool serviceFifo();
+
+    /*!
+      \brief Set interrupt service routine function to call when FIFO level crosses the threshold in FSK mode (DIO1 on both edges). The function should call SX127x::serviceFifo.
+
+      \param func Pointer to interrupt service routine.
+    */
+    void setFifoAction(void (*func)(void));
 
     /*!
       \brief Reads data that was received after calling startReceive method. This method reads len characters.
+      When the packet was received by startReceiveStream, the rest of it is drained into the stream buffer first and then copied to data, if it is a different buffer.
 
       \param data Pointer to array to save the received binary data.
 
@@ -859,16 +981,18 @@ class SX127x: public PhysicalLayer {
     size_t getPacketLength(bool update = true);
 
     /*!
-     \brief Set modem in fixed packet length mode. Available in FSK mode only.
+     \brief Set modem in fixed packet length mode. Available in FSK mode only. Packets longer than FIFO (up to 2047 bytes) are streamed through it,
+     see SX127x::serviceFifo. Transmitted packets must not be longer than the set length. String receive method reads packets of up to the set length.
 
-     \param len Packet length.
+     \param len Packet length, including address byte when address filtering is enabled.
 
      \returns \ref status_codes
    */
-   int16_t fixedPacketLengthMode(uint8_t len = SX127X_MAX_PACKET_LENGTH_FSK);
+   int16_t fixedPacketLengthMode(uint16_t len = SX127X_MAX_PACKET_LENGTH_FSK);
 
     /*!
-     \brief Set modem in variable packet length mode. Available in FSK mode only.
+     \brief Set modem in variable packet length mode. Available in FSK mode only. Packets longer than FIFO (up to 255 bytes) are streamed through it,
+     see SX127x::serviceFifo.
 
      \param len Maximum packet length.
 
@@ -926,7 +1050,7 @@ class SX127x: public PhysicalLayer {
     int16_t configFSK();
     int16_t getActiveModem();
     int16_t directMode();
-    int16_t setPacketMode(uint8_t mode, uint8_t len);
+    int16_t setPacketMode(uint8_t mode, uint16_t len);
 
 #ifndef RADIOLIB_GODMODE
   private:
@@ -935,12 +1059,25 @@ class SX127x: public PhysicalLayer {
     size_t _packetLength;
     bool _packetLengthQueried; // FSK packet length is the first byte in FIFO, length can only be queried once
     uint8_t _packetLengthConfig;
+    uint16_t _payloadLength; // fixed packet length or maximum packet length in variable mode
+
+    // FSK packets longer than FIFO are streamed through it by serviceFifo
+    TxSegmentStream _fifoTx;
+    uint8_t* _fifoRxData;
+    size_t _fifoRxSize;
+    size_t _fifoLen;
+    size_t _fifoPos;
+    uint8_t _fifoHeaderLen;
+    bool _fifoRxActive;
 
     bool findChip(uint8_t ver);
     int16_t setMode(uint8_t mode);
     int16_t setActiveModem(uint8_t modem);
     void clearIRQFlags();
     void clearFIFO(size_t count); // used mostly to clear remaining bytes in FIFO after a packet read
+    void writeFifo(size_t count);
+    void drainFifo(bool all);
+    uint8_t getAddressLength();
 };
 
 #endif
@@ -0,0 +1,833 @@
+#include "SX127xEmulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include <math.h>
+
+// bandwidth values in Hz, indexed by register value
+static const uint32_t SX1278EmulatorBw[] = { 7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000 };
+static const uint32_t SX1272EmulatorBw[] = { 125000, 250000, 500000 };
+
+SX127xEmulator::SX127xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE dio0, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE dio1, uint8_t version) : EmulatedChip(cs) {
+  _dio0 = dio0;
+  _dio1 = dio1;
+  _rst = rst;
+  _version = version;
+  _inReset = false;
+  _txActive = false;
+  _rssi = SX127X_EMULATOR_RSSI_DEFAULT;
+  _snr = SX127X_EMULATOR_SNR_DEFAULT;
+  reset();
+}
+
+void SX127xEmulator::reset() {
+  abortTx();
+  memset(_regs, 0x00, sizeof(_regs));
+  memset(_regsLoRa, 0x00, sizeof(_regsLoRa));
+  memset(_fifo, 0x00, sizeof(_fifo));
+
+  // registers common to both pages
+  _regs[SX127X_REG_OP_MODE] = (_version == SX1272_CHIP_VERSION) ? 0x01 : 0x09;
+  _regs[SX127X_REG_FRF_MSB] = (_version == SX1272_CHIP_VERSION) ? 0xE4 : 0x6C;
+  _regs[SX127X_REG_FRF_MID] = (_version == SX1272_CHIP_VERSION) ? 0xC0 : 0x80;
+  _regs[SX127X_REG_PA_CONFIG] = 0x4F;
+  _regs[SX127X_REG_PA_RAMP] = 0x09;
+  _regs[SX127X_REG_OCP] = 0x2B;
+  _regs[SX127X_REG_LNA] = 0x20;
+  _regs[SX127X_REG_VERSION] = _version;
+
+  // FSK/OOK page
+  _regs[SX127X_REG_BITRATE_MSB] = 0x1A;
+  _regs[SX127X_REG_BITRATE_LSB] = 0x0B;
+  _regs[SX127X_REG_FDEV_LSB] = 0x52;
+  _regs[SX127X_REG_RX_CONFIG] = 0x0E;
+  _regs[SX127X_REG_RSSI_CONFIG] = 0x02;
+  _regs[SX127X_REG_RSSI_COLLISION] = 0x0A;
+  _regs[SX127X_REG_RSSI_THRESH] = 0xFF;
+  _regs[SX127X_REG_RX_BW] = 0x15;
+  _regs[SX127X_REG_AFC_BW] = 0x0B;
+  _regs[SX127X_REG_PREAMBLE_DETECT] = 0xAA;
+  _regs[SX127X_REG_OSC] = 0x07;
+  _regs[SX127X_REG_PREAMBLE_LSB_FSK] = 0x03;
+  _regs[SX127X_REG_SYNC_CONFIG] = 0x93;
+  for(uint8_t i = SX127X_REG_SYNC_VALUE_1; i <= SX127X_REG_SYNC_VALUE_8; i++) {
+    _regs[i] = 0x01;
+  }
+  _regs[SX127X_REG_PACKET_CONFIG_1] = 0x90;
+  _regs[SX127X_REG_PACKET_CONFIG_2] = 0x40;
+  _regs[SX127X_REG_PAYLOAD_LENGTH_FSK] = 0x40;
+  _regs[SX127X_REG_FIFO_THRESH] = 0x8F;
+  _regs[SX127X_REG_IMAGE_CAL] = 0x82;
+  _regs[SX127X_REG_LOW_BAT] = 0x02;
+
+  // LoRa page
+  _regsLoRa[SX127X_REG_FIFO_TX_BASE_ADDR] = 0x80;
+  _regsLoRa[SX127X_REG_MODEM_CONFIG_1] = (_version == SX1272_CHIP_VERSION) ? 0x08 : 0x72;
+  _regsLoRa[SX127X_REG_MODEM_CONFIG_2] = 0x70;
+  _regsLoRa[SX127X_REG_SYMB_TIMEOUT_LSB] = 0x64;
+  _regsLoRa[SX127X_REG_PREAMBLE_LSB] = 0x08;
+  _regsLoRa[SX127X_REG_PAYLOAD_LENGTH] = 0x01;
+  _regsLoRa[SX127X_REG_MAX_PAYLOAD_LENGTH] = 0xFF;
+  _regsLoRa[SX127X_REG_DETECT_OPTIMIZE] = 0xC3;
+  _regsLoRa[SX127X_REG_INVERT_IQ] = 0x27;
+  _regsLoRa[SX127X_REG_DETECTION_THRESHOLD] = 0x0A;
+  _regsLoRa[SX127X_REG_SYNC_WORD] = 0x12;
+
+  _fifoHead = 0;
+  _fifoCount = 0;
+  _rxAddr = 0;
+  _flags1 = 0;
+  _flags2 = 0;
+  _eventTime = UINT64_MAX;
+  _airLen = 0;
+  _airSrc = NULL;
+  _airRx = false;
+  _cadDetected = false;
+  _txActive = false;
+  _txStall = false;
+  _txCrc = false;
+  _txFrameLen = 0;
+  _txSent = 0;
+  _rxFrameLen = 0;
+  _rxCount = 0;
+  _txPackets = 0;
+  _rxPackets = 0;
+  _txUnderruns = 0;
+  _rxOverruns = 0;
+}
+
+bool SX127xEmulator::injectPacket(const uint8_t* data, size_t len, bool crcError) {
+  if(_inReset || !((getMode() == SX127X_RXCONTINUOUS) || (isLoRa() && (getMode() == SX127X_RXSINGLE)))) {
+    return(false);
+  }
+
+  if(isLoRa()) {
+    if(len > SX127X_EMULATOR_FIFO_SIZE_LORA) {
+      return(false);
+    }
+    memcpy(_airBuff, data, len);
+    _airLen = len;
+    loraRxDone(!crcError);
+    return(true);
+  }
+
+  // add length byte in variable length mode
+  _rxCount = 0;
+  _rxFrameLen = 0;
+  if(_regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_PACKET_VARIABLE) {
+    fskRxByte((uint8_t)len);
+  }
+  for(size_t i = 0; i < len; i++) {
+    fskRxByte(data[i]);
+  }
+  fskRxDone(!crcError);
+  return(true);
+}
+
+void SX127xEmulator::setSignal(int16_t rssi, int8_t snr) {
+  _rssi = rssi;
+  _snr = snr;
+}
+
+uint64_t SX127xEmulator::getTimeOnAir(size_t len) {
+  if(isLoRa()) {
+    uint8_t sf, cr;
+    uint32_t bw;
+    bool ih, crc, ldro;
+    getLoRaConfig(&sf, &bw, &cr, &ih, &crc, &ldro);
+
+    // see SX1276 datasheet, section 4.1.1.7
+    double nPre = (double)(((uint16_t)_regsLoRa[SX127X_REG_PREAMBLE_MSB] << 8) | _regsLoRa[SX127X_REG_PREAMBLE_LSB]);
+    double num = 8.0*(double)len - 4.0*(double)sf + 28.0 + 16.0*(double)crc - 20.0*(double)ih;
+    double den = 4.0*((double)sf - 2.0*(double)ldro);
+    double nPay = 8.0 + max(ceil(num / den) * (double)(cr + 4), 0.0);
+    return((uint64_t)((nPre + 4.25 + nPay) * (double)getSymbolTime()));
+  }
+
+  // preamble, sync word, length byte, payload and CRC
+  size_t bytes = ((uint16_t)_regs[SX127X_REG_PREAMBLE_MSB_FSK] << 8) | _regs[SX127X_REG_PREAMBLE_LSB_FSK];
+  if(_regs[SX127X_REG_SYNC_CONFIG] & SX127X_SYNC_ON) {
+    bytes += (_regs[SX127X_REG_SYNC_CONFIG] & 0x07) + 1;
+  }
+  if(_regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_PACKET_VARIABLE) {
+    bytes++;
+  }
+  if(_regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_CRC_ON) {
+    bytes += 2;
+  }
+  return((uint64_t)(bytes + len) * getByteTime());
+}
+
+uint8_t SX127xEmulator::getRegister(uint8_t addr) {
+  addr &= 0x7F;
+  if(!isLoRa() && (addr == SX127X_REG_IRQ_FLAGS_2)) {
+    return(getIrqFlags2());
+  } else if(!isLoRa() && (addr == SX127X_REG_IRQ_FLAGS_1)) {
+    return(readRegister(addr));
+  }
+  return(reg(addr));
+}
+
+void SX127xEmulator::spiTransfer(uint8_t* buff, size_t len) {
+  if(_inReset || (len < 1)) {
+    return;
+  }
+
+  // first byte is address with write flag, burst access auto-increments address except for FIFO
+  bool write = buff[0] & 0x80;
+  uint8_t addr = buff[0] & 0x7F;
+  buff[0] = 0x00;
+  for(size_t i = 1; i < len; i++) {
+    if(write) {
+      writeRegister(addr, buff[i]);
+    } else {
+      buff[i] = readRegister(addr);
+    }
+    if(addr != SX127X_REG_FIFO) {
+      addr = (addr + 1) & 0x7F;
+    }
+  }
+}
+
+bool SX127xEmulator::readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+  if((pin == RADIOLIB_NC) || ((pin != _dio0) && (pin != _dio1))) {
+    return(false);
+  }
+
+  bool active = false;
+  if(_inReset) {
+    active = false;
+
+  } else if(isLoRa()) {
+    uint8_t flags = _regsLoRa[SX127X_REG_IRQ_FLAGS];
+    uint8_t map = _regs[SX127X_REG_DIO_MAPPING_1];
+    if(pin == _dio0) {
+      switch(map & 0xC0) {
+        case SX127X_DIO0_RX_DONE:
+          active = flags & SX127X_CLEAR_IRQ_FLAG_RX_DONE;
+          break;
+        case SX127X_DIO0_TX_DONE:
+          active = flags & SX127X_CLEAR_IRQ_FLAG_TX_DONE;
+          break;
+        case SX127X_DIO0_CAD_DONE:
+          active = flags & SX127X_CLEAR_IRQ_FLAG_CAD_DONE;
+          break;
+      }
+    } else {
+      switch(map & 0x30) {
+        case SX127X_DIO1_RX_TIMEOUT:
+          active = flags & SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT;
+          break;
+        case SX127X_DIO1_FHSS_CHANGE_CHANNEL:
+          active = flags & SX127X_CLEAR_IRQ_FLAG_FHSS_CHANGE_CHANNEL;
+          break;
+        case SX127X_DIO1_CAD_DETECTED:
+          active = flags & SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED;
+          break;
+      }
+    }
+
+  } else {
+    uint8_t flags = getIrqFlags2();
+    uint8_t map = _regs[SX127X_REG_DIO_MAPPING_1];
+    if(pin == _dio0) {
+      // in packet mode, mapping 00 is PacketSent in TX and PayloadReady otherwise
+      switch(map & 0xC0) {
+        case SX127X_DIO0_PACK_PACKET_SENT:
+          active = flags & ((getMode() == SX127X_TX) ? SX127X_FLAG_PACKET_SENT : SX127X_FLAG_PAYLOAD_READY);
+          break;
+        case SX127X_DIO0_PACK_CRC_OK:
+          active = flags & SX127X_FLAG_CRC_OK;
+          break;
+      }
+    } else {
+      switch(map & 0x30) {
+        case SX127X_DIO1_PACK_FIFO_LEVEL:
+          active = flags & SX127X_FLAG_FIFO_LEVEL;
+          break;
+        case SX127X_DIO1_PACK_FIFO_EMPTY:
+          active = flags & SX127X_FLAG_FIFO_EMPTY;
+          break;
+        case SX127X_DIO1_PACK_FIFO_FULL:
+          active = flags & SX127X_FLAG_FIFO_FULL;
+          break;
+      }
+    }
+  }
+
+  *value = active ? HIGH : LOW;
+  return(true);
+}
+
+void SX127xEmulator::writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  if((pin == RADIOLIB_NC) || (pin != _rst)) {
+    return;
+  }
+
+  // chip is held in reset while the pin is low
+  if(value == LOW) {
+    reset();
+    _inReset = true;
+  } else {
+    _inReset = false;
+  }
+}
+
+void SX127xEmulator::update(uint64_t now) {
+  while(_eventTime <= now) {
+    uint64_t eventTime = _eventTime;
+    _eventTime = UINT64_MAX;
+
+    if(!isLoRa()) {
+      // FSK events are bytes leaving the FIFO
+      _eventTime = eventTime;
+      fskTxByte();
+      continue;
+    }
+
+    uint8_t mode = getMode();
+    if(mode == SX127X_TX) {
+      // transmission done, chip goes back to standby
+      _txActive = false;
+      _txPackets++;
+      setLoRaFlags(SX127X_CLEAR_IRQ_FLAG_TX_DONE);
+      _regs[SX127X_REG_OP_MODE] = (_regs[SX127X_REG_OP_MODE] & 0xF8) | SX127X_STANDBY;
+      EmulatorHal::airData(this, _airBuff, _airLen);
+      EmulatorHal::airEnd(this, true);
+
+    } else if(mode == SX127X_RXSINGLE) {
+      // symbol timeout, unless a packet is being received
+      if(_airSrc == NULL) {
+        setLoRaFlags(SX127X_CLEAR_IRQ_FLAG_RX_TIMEOUT);
+        _regs[SX127X_REG_OP_MODE] = (_regs[SX127X_REG_OP_MODE] & 0xF8) | SX127X_STANDBY;
+      }
+
+    } else if(mode == SX127X_CAD) {
+      setLoRaFlags(SX127X_CLEAR_IRQ_FLAG_CAD_DONE | (_cadDetected ? SX127X_CLEAR_IRQ_FLAG_CAD_DETECTED : 0));
+      _regs[SX127X_REG_OP_MODE] = (_regs[SX127X_REG_OP_MODE] & 0xF8) | SX127X_STANDBY;
+    }
+  }
+}
+
+void SX127xEmulator::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  // chip that is transmitting cannot hear anything, and its packet buffer is in use
+  if(_inReset || _txActive || (_airSrc != NULL) || !EmulatorHal::airMatch(air, getAir())) {
+    return;
+  }
+
+  // packet can only be received if the chip was already listening when it started
+  _airSrc = src;
+  _airLen = 0;
+  _airRx = (getMode() == SX127X_RXCONTINUOUS) || (isLoRa() && ((getMode() == SX127X_RXSINGLE) || (getMode() == SX127X_CAD)));
+  if(isLoRa() && (getMode() == SX127X_CAD)) {
+    _cadDetected = true;
+  }
+  if(!isLoRa() && _airRx) {
+    _rxCount = 0;
+    _rxFrameLen = 0;
+    _flags1 |= SX127X_FLAG_PREAMBLE_DETECT | SX127X_FLAG_SYNC_ADDRESS_MATCH;
+  }
+}
+
+void SX127xEmulator::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  if((src != _airSrc) || !_airRx) {
+    return;
+  }
+
+  if(isLoRa()) {
+    // LoRa packets arrive all at once at the end of transmission
+    len = min(len, (size_t)SX127X_EMULATOR_FIFO_SIZE_LORA - _airLen);
+    memcpy(&_airBuff[_airLen], data, len);
+    _airLen += len;
+  } else if(getMode() == SX127X_RXCONTINUOUS) {
+    for(size_t i = 0; i < len; i++) {
+      fskRxByte(data[i]);
+    }
+  }
+}
+
+void SX127xEmulator::airEnd(EmulatedChip* src, bool crcOk) {
+  if(src != _airSrc) {
+    return;
+  }
+  _airSrc = NULL;
+
+  if(_airRx) {
+    uint8_t mode = getMode();
+    if(isLoRa() && ((mode == SX127X_RXCONTINUOUS) || (mode == SX127X_RXSINGLE))) {
+      loraRxDone(crcOk);
+    } else if(!isLoRa() && (mode == SX127X_RXCONTINUOUS)) {
+      fskRxDone(crcOk);
+    }
+  }
+
+  // RX single timeout was postponed while receiving, restart it
+  if(isLoRa() && (getMode() == SX127X_RXSINGLE) && (_eventTime == UINT64_MAX)) {
+    _eventTime = EmulatorHal::getTimeNs();
+  }
+}
+
+uint8_t& SX127xEmulator::reg(uint8_t addr) {
+  // in LoRa mode, addresses 0x0D - 0x3F map to LoRa page unless AccessSharedReg is set
+  if(isLoRa() && (addr >= 0x0D) && (addr <= 0x3F) && !(_regs[SX127X_REG_OP_MODE] & 0x40)) {
+    return(_regsLoRa[addr]);
+  }
+  return(_regs[addr]);
+}
+
+uint8_t SX127xEmulator::readRegister(uint8_t addr) {
+  if(addr == SX127X_REG_FIFO) {
+    return(fifoRead());
+  }
+
+  if(!isLoRa()) {
+    if(addr == SX127X_REG_IRQ_FLAGS_1) {
+      uint8_t mode = getMode();
+      uint8_t flags = _flags1 | SX127X_FLAG_MODE_READY;
+      if(mode == SX127X_RX) {
+        flags |= SX127X_FLAG_RX_READY;
+      } else if(mode == SX127X_TX) {
+        flags |= SX127X_FLAG_TX_READY;
+      }
+      if((mode >= SX127X_FSTX) && (mode <= SX127X_RX)) {
+        flags |= SX127X_FLAG_PLL_LOCK;
+      }
+      return(flags);
+    } else if(addr == SX127X_REG_IRQ_FLAGS_2) {
+      return(getIrqFlags2());
+    }
+  }
+
+  return(reg(addr));
+}
+
+void SX127xEmulator::writeRegister(uint8_t addr, uint8_t value) {
+  switch(addr) {
+    case SX127X_REG_FIFO:
+      fifoWrite(value);
+      return;
+    case SX127X_REG_OP_MODE:
+      setOpMode(value);
+      return;
+    case SX127X_REG_VERSION:
+      return;
+  }
+
+  if(isLoRa() && (&reg(addr) == &_regsLoRa[addr])) {
+    switch(addr) {
+      case SX127X_REG_IRQ_FLAGS:
+        // flags are cleared by writing 1
+        _regsLoRa[addr] &= ~value;
+        return;
+      case SX127X_REG_FIFO_RX_CURRENT_ADDR:
+      case SX127X_REG_RX_NB_BYTES:
+      case SX127X_REG_RX_HEADER_CNT_VALUE_MSB:
+      case SX127X_REG_RX_HEADER_CNT_VALUE_LSB:
+      case SX127X_REG_RX_PACKET_CNT_VALUE_MSB:
+      case SX127X_REG_RX_PACKET_CNT_VALUE_LSB:
+      case SX127X_REG_MODEM_STAT:
+      case SX127X_REG_PKT_SNR_VALUE:
+      case SX127X_REG_PKT_RSSI_VALUE:
+      case SX127X_REG_RSSI_VALUE:
+      case SX127X_REG_FIFO_RX_BYTE_ADDR:
+        // read-only
+        return;
+    }
+
+  } else {
+    switch(addr) {
+      case SX127X_REG_IRQ_FLAGS_1:
+        // only RSSI, PreambleDetect and SyncAddressMatch can be cleared
+        _flags1 &= ~(value & (SX127X_FLAG_RSSI | SX127X_FLAG_PREAMBLE_DETECT | SX127X_FLAG_SYNC_ADDRESS_MATCH));
+        return;
+      case SX127X_REG_IRQ_FLAGS_2:
+        // clearing FIFO overrun flag also clears the FIFO
+        if(value & SX127X_FLAG_FIFO_OVERRUN) {
+          _flags2 &= ~SX127X_FLAG_FIFO_OVERRUN;
+          fifoClear();
+        }
+        _flags2 &= ~(value & SX127X_FLAG_LOW_BAT);
+        return;
+      case SX127X_REG_RSSI_VALUE_FSK:
+        return;
+    }
+  }
+
+  reg(addr) = value;
+}
+
+void SX127xEmulator::setOpMode(uint8_t value) {
+  uint8_t prev = _regs[SX127X_REG_OP_MODE];
+
+  // LongRangeMode bit can only be changed in sleep mode
+  if(((value ^ prev) & SX127X_LORA) && ((prev & 0x07) != SX127X_SLEEP)) {
+    value = (value & ~SX127X_LORA) | (prev & SX127X_LORA);
+  }
+  _regs[SX127X_REG_OP_MODE] = value;
+
+  if((value ^ prev) & SX127X_LORA) {
+    // switching modem resets modem state
+    fifoClear();
+    _flags1 = 0;
+    _flags2 = 0;
+    _regsLoRa[SX127X_REG_IRQ_FLAGS] = 0;
+  } else if((value & 0x07) == (prev & 0x07)) {
+    return;
+  }
+
+  // restore previous mode, so that enterMode can tell what is being left
+  _regs[SX127X_REG_OP_MODE] = (value & 0xF8) | (prev & 0x07);
+  enterMode(value & 0x07);
+}
+
+void SX127xEmulator::enterMode(uint8_t mode) {
+  uint64_t now = EmulatorHal::getTimeNs();
+  uint8_t prev = getMode();
+  _regs[SX127X_REG_OP_MODE] = (_regs[SX127X_REG_OP_MODE] & 0xF8) | mode;
+
+  // leaving TX aborts transmission
+  if((prev == SX127X_TX) && (mode != SX127X_TX)) {
+    abortTx();
+    _flags2 &= ~SX127X_FLAG_PACKET_SENT;
+  }
+  _eventTime = UINT64_MAX;
+
+  if(mode == SX127X_SLEEP) {
+    // FIFO is not retained in sleep mode
+    fifoClear();
+    memset(_fifo, 0x00, sizeof(_fifo));
+    return;
+  }
+
+  if(isLoRa()) {
+    switch(mode) {
+      case SX127X_TX:
+        // packet that was being received is lost, packet is read from FIFO at TX base address
+        _airSrc = NULL;
+        _airLen = _regsLoRa[SX127X_REG_PAYLOAD_LENGTH];
+        for(size_t i = 0; i < _airLen; i++) {
+          _airBuff[i] = _fifo[(uint8_t)(_regsLoRa[SX127X_REG_FIFO_TX_BASE_ADDR] + i)];
+        }
+        _eventTime = now + getTimeOnAir(_airLen);
+        _txActive = true;
+        EmulatorHal::airStart(this, getAir());
+        break;
+
+      case SX127X_RXCONTINUOUS:
+      case SX127X_RXSINGLE:
+        _rxAddr = _regsLoRa[SX127X_REG_FIFO_RX_BASE_ADDR];
+        if(mode == SX127X_RXSINGLE) {
+          uint16_t symbols = ((uint16_t)(_regsLoRa[SX127X_REG_MODEM_CONFIG_2] & 0x03) << 8) | _regsLoRa[SX127X_REG_SYMB_TIMEOUT_LSB];
+          _eventTime = now + symbols * getSymbolTime();
+        }
+        break;
+
+      case SX127X_CAD:
+        // CAD takes approximately two symbols
+        _cadDetected = (_airSrc != NULL);
+        _eventTime = now + 2 * getSymbolTime();
+        break;
+    }
+    return;
+  }
+
+  switch(mode) {
+    case SX127X_TX:
+      fskTxStart();
+      break;
+
+    case SX127X_RX:
+      fifoClear();
+      _rxCount = 0;
+      _rxFrameLen = 0;
+      _regs[SX127X_REG_RSSI_VALUE_FSK] = (uint8_t)(-2 * _rssi);
+      break;
+  }
+}
+
+void SX127xEmulator::abortTx() {
+  if(!_txActive) {
+    return;
+  }
+
+  // receivers only get incomplete packet
+  _txActive = false;
+  _txStall = false;
+  EmulatorHal::airEnd(this, false);
+}
+
+EmulatorAir_t SX127xEmulator::getAir() {
+  EmulatorAir_t air;
+  uint32_t frf = ((uint32_t)_regs[SX127X_REG_FRF_MSB] << 16) | ((uint32_t)_regs[SX127X_REG_FRF_MID] << 8) | _regs[SX127X_REG_FRF_LSB];
+  air.freq = (uint32_t)(((uint64_t)frf * (uint64_t)(SX127X_CRYSTAL_FREQ * 1000000.0)) >> SX127X_DIV_EXPONENT);
+  if(isLoRa()) {
+    uint8_t cr;
+    bool ih, crc, ldro;
+    air.modem = RADIOLIB_EMULATOR_MODEM_LORA;
+    getLoRaConfig(&air.sf, &air.rate, &cr, &ih, &crc, &ldro);
+  } else {
+    air.modem = RADIOLIB_EMULATOR_MODEM_FSK;
+    air.sf = 0;
+    air.rate = 8000000000ULL / getByteTime();
+  }
+  return(air);
+}
+
+void SX127xEmulator::getLoRaConfig(uint8_t* sf, uint32_t* bw, uint8_t* cr, bool* ih, bool* crc, bool* ldro) {
+  uint8_t cfg1 = _regsLoRa[SX127X_REG_MODEM_CONFIG_1];
+  uint8_t cfg2 = _regsLoRa[SX127X_REG_MODEM_CONFIG_2];
+  uint8_t cfg3 = _regsLoRa[SX1278_REG_MODEM_CONFIG_3];
+
+  *sf = constrain(cfg2 >> 4, 6, 12);
+  if(_version == SX1272_CHIP_VERSION) {
+    *bw = SX1272EmulatorBw[min(cfg1 >> 6, 2)];
+    *cr = (cfg1 >> 3) & 0x07;
+    *ih = cfg1 & SX1272_HEADER_IMPL_MODE;
+    *crc = cfg1 & SX1272_RX_CRC_MODE_ON;
+    *ldro = cfg1 & SX1272_LOW_DATA_RATE_OPT_ON;
+  } else {
+    *bw = SX1278EmulatorBw[min(cfg1 >> 4, 9)];
+    *cr = (cfg1 >> 1) & 0x07;
+    *ih = cfg1 & SX1278_HEADER_IMPL_MODE;
+    *crc = cfg2 & SX1278_RX_CRC_MODE_ON;
+    *ldro = cfg3 & SX1278_LOW_DATA_RATE_OPT_ON;
+  }
+}
+
+uint64_t SX127xEmulator::getSymbolTime() {
+  uint8_t sf, cr;
+  uint32_t bw;
+  bool ih, crc, ldro;
+  getLoRaConfig(&sf, &bw, &cr, &ih, &crc, &ldro);
+  return(((uint64_t)1000000000ULL << sf) / bw);
+}
+
+uint64_t SX127xEmulator::getByteTime() {
+  // bit rate is 32 MHz / BitRate, so one byte takes BitRate * 250 ns
+  uint16_t bitRate = ((uint16_t)_regs[SX127X_REG_BITRATE_MSB] << 8) | _regs[SX127X_REG_BITRATE_LSB];
+  return((uint64_t)max(bitRate, (uint16_t)1) * 250ULL);
+}
+
+uint8_t SX127xEmulator::getIrqFlags2() {
+  uint8_t flags = _flags2;
+  if(_fifoCount == 0) {
+    flags |= SX127X_FLAG_FIFO_EMPTY;
+  }
+  if(_fifoCount == SX127X_EMULATOR_FIFO_SIZE_FSK) {
+    flags |= SX127X_FLAG_FIFO_FULL;
+  }
+  if(_fifoCount > (_regs[SX127X_REG_FIFO_THRESH] & 0x3F)) {
+    flags |= SX127X_FLAG_FIFO_LEVEL;
+  }
+  return(flags);
+}
+
+void SX127xEmulator::setLoRaFlags(uint8_t flags) {
+  // masked interrupts are not raised at all
+  _regsLoRa[SX127X_REG_IRQ_FLAGS] |= flags & ~_regsLoRa[SX127X_REG_IRQ_FLAGS_MASK];
+}
+
+void SX127xEmulator::loraRxDone(bool crcOk) {
+  // received packet is stored at current RX address
+  _regsLoRa[SX127X_REG_FIFO_RX_CURRENT_ADDR] = _rxAddr;
+  for(size_t i = 0; i < _airLen; i++) {
+    _fifo[_rxAddr++] = _airBuff[i];
+  }
+  _regsLoRa[SX127X_REG_FIFO_RX_BYTE_ADDR] = _rxAddr - 1;
+  _regsLoRa[SX127X_REG_RX_NB_BYTES] = (uint8_t)_airLen;
+
+  // packet counter
+  uint16_t cnt = (((uint16_t)_regsLoRa[SX127X_REG_RX_PACKET_CNT_VALUE_MSB] << 8) | _regsLoRa[SX127X_REG_RX_PACKET_CNT_VALUE_LSB]) + 1;
+  _regsLoRa[SX127X_REG_RX_PACKET_CNT_VALUE_MSB] = cnt >> 8;
+  _regsLoRa[SX127X_REG_RX_PACKET_CNT_VALUE_LSB] = cnt & 0xFF;
+  _regsLoRa[SX127X_REG_RX_HEADER_CNT_VALUE_MSB] = cnt >> 8;
+  _regsLoRa[SX127X_REG_RX_HEADER_CNT_VALUE_LSB] = cnt & 0xFF;
+
+  // signal quality, RSSI offset depends on chip and frequency band
+  int16_t offset = 157;
+  if(_version == SX1272_CHIP_VERSION) {
+    offset = 139;
+  } else if(getAir().freq < 868000000UL) {
+    offset = 164;
+  }
+  _regsLoRa[SX127X_REG_PKT_SNR_VALUE] = (uint8_t)(_snr * 4);
+  _regsLoRa[SX127X_REG_PKT_RSSI_VALUE] = (uint8_t)constrain(_rssi + offset - min(_snr, (int8_t)0), 0, 255);
+
+  setLoRaFlags(SX127X_CLEAR_IRQ_FLAG_RX_DONE | SX127X_CLEAR_IRQ_FLAG_VALID_HEADER | (crcOk ? 0 : SX127X_CLEAR_IRQ_FLAG_PAYLOAD_CRC_ERROR));
+  _rxPackets++;
+
+  // single reception ends in standby
+  if(getMode() == SX127X_RXSINGLE) {
+    _regs[SX127X_REG_OP_MODE] = (_regs[SX127X_REG_OP_MODE] & 0xF8) | SX127X_STANDBY;
+    _eventTime = UINT64_MAX;
+  }
+}
+
+uint8_t SX127xEmulator::fifoRead() {
+  if(getMode() == SX127X_SLEEP) {
+    return(0x00);
+  }
+
+  // LoRa FIFO is accessed at FIFO_ADDR_PTR, which auto-increments
+  if(isLoRa()) {
+    return(_fifo[_regsLoRa[SX127X_REG_FIFO_ADDR_PTR]++]);
+  }
+
+  if(_fifoCount == 0) {
+    return(0x00);
+  }
+  uint8_t b = _fifo[_fifoHead];
+  _fifoHead = (_fifoHead + 1) % SX127X_EMULATOR_FIFO_SIZE_FSK;
+  _fifoCount--;
+
+  // PayloadReady is cleared once the FIFO is empty
+  if(_fifoCount == 0) {
+    _flags2 &= ~(SX127X_FLAG_PAYLOAD_READY | SX127X_FLAG_CRC_OK);
+  }
+  return(b);
+}
+
+void SX127xEmulator::fifoWrite(uint8_t b) {
+  if(getMode() == SX127X_SLEEP) {
+    return;
+  }
+
+  if(isLoRa()) {
+    _fifo[_regsLoRa[SX127X_REG_FIFO_ADDR_PTR]++] = b;
+    return;
+  }
+
+  if(_fifoCount == SX127X_EMULATOR_FIFO_SIZE_FSK) {
+    _flags2 |= SX127X_FLAG_FIFO_OVERRUN;
+    return;
+  }
+  _fifo[(_fifoHead + _fifoCount) % SX127X_EMULATOR_FIFO_SIZE_FSK] = b;
+  _fifoCount++;
+
+  // resume or start transmission
+  if(getMode() == SX127X_TX) {
+    if(_txStall) {
+      _txStall = false;
+      _eventTime = EmulatorHal::getTimeNs() + getByteTime();
+    } else if(!_txActive) {
+      fskTxStart();
+    }
+  }
+}
+
+void SX127xEmulator::fifoClear() {
+  _fifoHead = 0;
+  _fifoCount = 0;
+  _flags2 &= ~(SX127X_FLAG_PAYLOAD_READY | SX127X_FLAG_CRC_OK);
+}
+
+void SX127xEmulator::fskTxStart() {
+  // check transmission start condition
+  bool start = (_regs[SX127X_REG_FIFO_THRESH] & SX127X_TX_START_FIFO_NOT_EMPTY) ? (_fifoCount > 0) : (_fifoCount > (_regs[SX127X_REG_FIFO_THRESH] & 0x3F));
+  if(!start) {
+    return;
+  }
+
+  // first byte leaves the FIFO after preamble and sync word
+  size_t overhead = ((uint16_t)_regs[SX127X_REG_PREAMBLE_MSB_FSK] << 8) | _regs[SX127X_REG_PREAMBLE_LSB_FSK];
+  if(_regs[SX127X_REG_SYNC_CONFIG] & SX127X_SYNC_ON) {
+    overhead += (_regs[SX127X_REG_SYNC_CONFIG] & 0x07) + 1;
+  }
+  _txActive = true;
+  _txStall = false;
+  _txCrc = false;
+  _txSent = 0;
+  _txFrameLen = 0;
+  _eventTime = EmulatorHal::getTimeNs() + (overhead + 1) * getByteTime();
+  EmulatorHal::airStart(this, getAir());
+}
+
+void SX127xEmulator::fskTxByte() {
+  uint64_t eventTime = _eventTime;
+  _eventTime = UINT64_MAX;
+  if(!_txActive) {
+    return;
+  }
+
+  // CRC was sent, packet is done
+  if(_txCrc) {
+    _txActive = false;
+    _txCrc = false;
+    _txPackets++;
+    _flags2 |= SX127X_FLAG_PACKET_SENT;
+    EmulatorHal::airEnd(this, true);
+
+    // next packet can start right away if there is more data
+    if(_fifoCount > 0) {
+      fskTxStart();
+    }
+    return;
+  }
+
+  // real chip would send garbage here, wait for data instead
+  if(_fifoCount == 0) {
+    _txUnderruns++;
+    _txStall = true;
+    return;
+  }
+
+  uint8_t b = fifoRead();
+  if(_txSent == 0) {
+    _txFrameLen = fskFrameLen(b);
+  }
+  _txSent++;
+  EmulatorHal::airData(this, &b, 1);
+
+  if(_txSent >= _txFrameLen) {
+    _txCrc = true;
+    _eventTime = eventTime + ((_regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_CRC_ON) ? 2 : 0) * getByteTime();
+  } else {
+    _eventTime = eventTime + getByteTime();
+  }
+}
+
+void SX127xEmulator::fskRxByte(uint8_t b) {
+  if(_rxCount == 0) {
+    _rxFrameLen = fskFrameLen(b);
+  }
+  _rxCount++;
+
+  if(_fifoCount == SX127X_EMULATOR_FIFO_SIZE_FSK) {
+    _flags2 |= SX127X_FLAG_FIFO_OVERRUN;
+    _rxOverruns++;
+    return;
+  }
+  _fifo[(_fifoHead + _fifoCount) % SX127X_EMULATOR_FIFO_SIZE_FSK] = b;
+  _fifoCount++;
+}
+
+void SX127xEmulator::fskRxDone(bool crcOk) {
+  _flags1 &= ~(SX127X_FLAG_PREAMBLE_DETECT | SX127X_FLAG_SYNC_ADDRESS_MATCH);
+  if((_rxCount == 0) || (_rxCount < _rxFrameLen)) {
+    return;
+  }
+  _rxCount = 0;
+
+  // with CRC autoclear, packets with wrong CRC are dropped
+  bool crcOn = _regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_CRC_ON;
+  if(crcOn && !crcOk && !(_regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_CRC_AUTOCLEAR_OFF)) {
+    fifoClear();
+    return;
+  }
+
+  _flags2 |= SX127X_FLAG_PAYLOAD_READY;
+  if(crcOk || !crcOn) {
+    _flags2 |= SX127X_FLAG_CRC_OK;
+  }
+  _rxPackets++;
+}
+
+size_t SX127xEmulator::fskFrameLen(uint8_t first) {
+  // variable length frame starts with length byte, which includes address byte
+  if(_regs[SX127X_REG_PACKET_CONFIG_1] & SX127X_PACKET_VARIABLE) {
+    return((size_t)first + 1);
+  }
+  return(((size_t)(_regs[SX127X_REG_PACKET_CONFIG_2] & 0x07) << 8) | _regs[SX127X_REG_PAYLOAD_LENGTH_FSK]);
+}
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef _RADIOLIB_SX127X_EMULATOR_H
+#define _RADIOLIB_SX127X_EMULATOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include "../../EmulatorHal.h"
+#include "SX127x.h"
+#include "SX1272.h"
+#include "SX1278.h"
+
+// FIFO sizes
+#define SX127X_EMULATOR_FIFO_SIZE_LORA                256
+#define SX127X_EMULATOR_FIFO_SIZE_FSK                 64
+
+// emulated signal parameters of received packets
+#define SX127X_EMULATOR_RSSI_DEFAULT                  -60
+#define SX127X_EMULATOR_SNR_DEFAULT                   10
+
+/*!
+  \class SX127xEmulator
+
+  \brief Register-level emulator of SX127x series chips, to be attached to EmulatorHal. Both register pages (LoRa and FSK/OOK) are emulated,
+  including OP_MODE transitions, LoRa FIFO pointers, FSK FIFO with level flags, IRQ flags with DIO0/DIO1 mapping and time-on-air:
+  TX_DONE (LoRa) or PacketSent (FSK) is only raised once the packet would have been transmitted by a real chip.
+  In FSK mode, packet bytes are taken from the FIFO at the configured bit rate, so the FIFO can be refilled during transmission.
+
+  Packets transmitted by one emulator are received by all other attached emulators that are in receive mode with matching configuration.
+  Single-chip tests can use injectPacket instead.
+
+  Limitations: register values are not range-checked, analog functions (RSSI measurement, frequency error, temperature) return fixed values,
+  FHSS, direct mode, address filtering and FSK sequencer are not emulated.
+*/
+class SX127xEmulator: public EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param dio0 DIO0 pin.
+
+      \param rst Reset pin.
+
+      \param dio1 DIO1 pin. Defaults to RADIOLIB_NC.
+
+      \param version Value of version register, SX1278_CHIP_VERSION for SX1276/77/78/79 or SX1272_CHIP_VERSION for SX1272/73. Defaults to SX1278_CHIP_VERSION.
+    */
+    SX127xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE dio0, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE dio1 = RADIOLIB_NC, uint8_t version = SX1278_CHIP_VERSION);
+
+    /*!
+      \brief Resets all registers to their default values and aborts any ongoing operation, same as pulling the reset pin low.
+    */
+    void reset();
+
+    /*!
+      \brief Emulates reception of a packet. Only accepted when the chip is in receive mode.
+
+      \param data Packet payload. In FSK variable length mode, length byte is added automatically.
+
+      \param len Payload length in bytes.
+
+      \param crcError Whether the packet should fail CRC check.
+
+      \returns True if the packet was accepted, false otherwise.
+    */
+    bool injectPacket(const uint8_t* data, size_t len, bool crcError = false);
+
+    /*!
+      \brief Sets signal parameters reported for received packets.
+
+      \param rssi RSSI in dBm.
+
+      \param snr SNR in dB (LoRa only).
+    */
+    void setSignal(int16_t rssi, int8_t snr);
+
+    /*!
+      \brief Calculates time-on-air of a packet with the current configuration.
+
+      \param len Payload length in bytes.
+
+      \returns Time-on-air in ns.
+    */
+    uint64_t getTimeOnAir(size_t len);
+
+    /*!
+      \brief Reads register value without any side effects (e.g. FIFO is not advanced).
+
+      \param addr Register address. In LoRa mode, addresses 0x0D - 0x3F are in LoRa register page.
+
+      \returns Register value.
+    */
+    uint8_t getRegister(uint8_t addr);
+
+    /*!
+      \brief Gets the number of transmitted packets since reset.
+
+      \returns Number of transmitted packets.
+    */
+    uint32_t getTxPackets() const { return(_txPackets); }
+
+    /*!
+      \brief Gets the number of received packets since reset.
+
+      \returns Number of received packets.
+    */
+    uint32_t getRxPackets() const { return(_rxPackets); }
+
+    /*!
+      \brief Gets the number of FSK transmissions that ran out of data in FIFO. Real chip would transmit corrupted packet, the emulator waits for more data.
+
+      \returns Number of TX FIFO underruns.
+    */
+    uint32_t getTxUnderruns() const { return(_txUnderruns); }
+
+    /*!
+      \brief Gets the number of bytes dropped because FSK FIFO was full during reception.
+
+      \returns Number of RX FIFO overruns.
+    */
+    uint32_t getRxOverruns() const { return(_rxOverruns); }
+
+    // EmulatedChip methods
+
+    void spiTransfer(uint8_t* buff, size_t len);
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value);
+    void writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    void update(uint64_t now);
+    uint64_t nextEvent() { return(_eventTime); }
+    void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    void airEnd(EmulatedChip* src, bool crcOk);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    RADIOLIB_PIN_TYPE _dio0, _dio1, _rst;
+    uint8_t _version;
+    bool _inReset;
+
+    // FSK/OOK register page (and registers common to both pages), LoRa register page
+    uint8_t _regs[0x80];
+    uint8_t _regsLoRa[0x80];
+
+    // LoRa FIFO is a 256 byte RAM, FSK FIFO is a 64 byte queue
+    uint8_t _fifo[SX127X_EMULATOR_FIFO_SIZE_LORA];
+    uint8_t _fifoHead, _fifoCount;
+    uint8_t _rxAddr;
+
+    // FSK IRQ flags that are not derived from FIFO state
+    uint8_t _flags1, _flags2;
+
+    // pending event (LoRa TX done, RX timeout, CAD done, FSK byte)
+    uint64_t _eventTime;
+
+    // LoRa transmission and reception buffer
+    uint8_t _airBuff[SX127X_EMULATOR_FIFO_SIZE_LORA];
+    size_t _airLen;
+
+    // packet currently on the air
+    EmulatedChip* _airSrc;
+    bool _airRx;
+    bool _cadDetected;
+
+    // FSK transmission state
+    bool _txActive, _txStall, _txCrc;
+    size_t _txFrameLen, _txSent;
+
+    // FSK reception state
+    size_t _rxFrameLen, _rxCount;
+
+    int16_t _rssi;
+    int8_t _snr;
+
+    uint32_t _txPackets, _rxPackets, _txUnderruns, _rxOverruns;
+
+    bool isLoRa() { return(_regs[SX127X_REG_OP_MODE] & SX127X_LORA); }
+    uint8_t getMode() { return(_regs[SX127X_REG_OP_MODE] & 0x07); }
+    uint8_t& reg(uint8_t addr);
+    uint8_t readRegister(uint8_t addr);
+    void writeRegister(uint8_t addr, uint8_t value);
+    void setOpMode(uint8_t value);
+    void enterMode(uint8_t mode);
+    void abortTx();
+    EmulatorAir_t getAir();
+    void getLoRaConfig(uint8_t* sf, uint32_t* bw, uint8_t* cr, bool* ih, bool* crc, bool* ldro);
+    uint64_t getSymbolTime();
+    uint64_t getByteTime();
+    uint8_t getIrqFlags2();
+
+    void setLoRaFlags(uint8_t flags);
+    void loraRxDone(bool crcOk);
+
+    uint8_t fifoRead();
+    void fifoWrite(uint8_t b);
+    void fifoClear();
+    void fskTxStart();
+    void fskTxByte();
+    void fskRxByte(uint8_t b);
+    void fskRxDone(bool crcOk);
+    size_t fskFrameLen(uint8_t first);
+};
+
+#endif
+
+#endif
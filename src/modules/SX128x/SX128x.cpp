@@ -5,6 +5,8 @@ SX128x::SX128x(Module* mod) : PhysicalLayer(SX128X_FREQUENCY_STEP_SIZE, SX128X_M
 }
 
 int16_t SX128x::begin(float freq, float bw, uint8_t sf, uint8_t cr, int8_t power, uint16_t preambleLength) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
@@ -56,6 +58,8 @@ int16_t SX128x::begin(float freq, float bw, uint8_t sf, uint8_t cr, int8_t power
 }
 
 int16_t SX128x::beginGFSK(float freq, uint16_t br, float freqDev, int8_t power, uint16_t preambleLength, float dataShaping) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
@@ -115,6 +119,8 @@ int16_t SX128x::beginGFSK(float freq, uint16_t br, float freqDev, int8_t power,
 }
 
 int16_t SX128x::beginBLE(float freq, uint16_t br, float freqDev, int8_t power, float dataShaping) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
@@ -163,6 +169,8 @@ int16_t SX128x::beginBLE(float freq, uint16_t br, float freqDev, int8_t power, f
 }
 
 int16_t SX128x::beginFLRC(float freq, uint16_t br, uint8_t cr, int8_t power, uint16_t preambleLength, float dataShaping) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
@@ -224,7 +232,7 @@ int16_t SX128x::reset(bool verify) {
   // run the reset sequence - same as SX126x, as SX128x docs don't seem to mention this
   Module::pinMode(_mod->getRst(), OUTPUT);
   Module::digitalWrite(_mod->getRst(), LOW);
-  delay(1);
+  Module::delay(1);
   Module::digitalWrite(_mod->getRst(), HIGH);
 
   // return immediately when verification is disabled
@@ -233,7 +241,7 @@ int16_t SX128x::reset(bool verify) {
   }
 
   // set mode to standby
-  uint32_t start = millis();
+  uint32_t start = Module::millis();
   while(true) {
     // try to set mode to standby
     int16_t state = standby();
@@ -243,17 +251,19 @@ int16_t SX128x::reset(bool verify) {
     }
 
     // standby command failed, check timeout and try again
-    if(millis() - start >= 3000) {
+    if(Module::millis() - start >= 3000) {
       // timed out, possibly incorrect wiring
       return(state);
     }
 
     // wait a bit to not spam the module
-    delay(10);
+    Module::delay(10);
   }
 }
 
 int16_t SX128x::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+
   // check packet length
   if(len > SX128X_MAX_PACKET_LENGTH) {
     return(ERR_PACKET_TOO_LONG);
@@ -281,14 +291,10 @@ int16_t SX128x::transmit(uint8_t* data, size_t len, uint8_t addr) {
   RADIOLIB_ASSERT(state);
 
   // wait for packet transmission or timeout
-  uint32_t start = micros();
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-    if(micros() - start > timeout) {
-      clearIrqStatus();
-      standby();
-      return(ERR_TX_TIMEOUT);
-    }
+  if(!Module::waitForPin(_mod->getIrq(), HIGH, timeout / 1000 + 1)) {
+    clearIrqStatus();
+    standby();
+    return(ERR_TX_TIMEOUT);
   }
 
   // clear interrupt flags
@@ -302,6 +308,8 @@ int16_t SX128x::transmit(uint8_t* data, size_t len, uint8_t addr) {
 }
 
 int16_t SX128x::receive(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
+
   // check active modem
   uint8_t modem = getPacketType();
   if(modem == SX128X_PACKET_TYPE_RANGING) {
@@ -325,14 +333,10 @@ int16_t SX128x::receive(uint8_t* data, size_t len) {
   RADIOLIB_ASSERT(state);
 
   // wait for packet reception or timeout
-  uint32_t start = micros();
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-    if(micros() - start > timeout) {
-      clearIrqStatus();
-      standby();
-      return(ERR_RX_TIMEOUT);
-    }
+  if(!Module::waitForPin(_mod->getIrq(), HIGH, timeout / 1000 + 1)) {
+    clearIrqStatus();
+    standby();
+    return(ERR_RX_TIMEOUT);
   }
 
   // read the received data
@@ -357,31 +361,14 @@ int16_t SX128x::receiveDirect() {
 }
 
 int16_t SX128x::scanChannel() {
-  // check active modem
-  if(getPacketType() != SX128X_PACKET_TYPE_LORA) {
-    return(ERR_WRONG_MODEM);
-  }
-
-  // set mode to standby
-  int16_t state = standby();
-  RADIOLIB_ASSERT(state);
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_SCAN_CHANNEL);
 
-  // set DIO pin mapping
-  state = setDioIrqParams(SX128X_IRQ_CAD_DETECTED | SX128X_IRQ_CAD_DONE, SX128X_IRQ_CAD_DETECTED | SX128X_IRQ_CAD_DONE);
-  RADIOLIB_ASSERT(state);
-
-  // clear interrupt flags
-  state = clearIrqStatus();
-  RADIOLIB_ASSERT(state);
-
-  // set mode to CAD
-  state = setCad();
+  // start channel activity detection
+  int16_t state = startChannelScan();
   RADIOLIB_ASSERT(state);
 
   // wait for channel activity detected or timeout
-  while(!digitalRead(_mod->getIrq())) {
-    yield();
-  }
+  while(!Module::waitForPin(_mod->getIrq(), HIGH, RADIOLIB_WAIT_SLICE));
 
   // check CAD result
   uint16_t cadResult = getIrqStatus();
@@ -398,6 +385,28 @@ int16_t SX128x::scanChannel() {
   return(ERR_UNKNOWN);
 }
 
+int16_t SX128x::startChannelScan() {
+  // check active modem
+  if(getPacketType() != SX128X_PACKET_TYPE_LORA) {
+    return(ERR_WRONG_MODEM);
+  }
+
+  // set mode to standby
+  int16_t state = standby();
+  RADIOLIB_ASSERT(state);
+
+  // set DIO pin mapping
+  state = setDioIrqParams(SX128X_IRQ_CAD_DETECTED | SX128X_IRQ_CAD_DONE, SX128X_IRQ_CAD_DETECTED | SX128X_IRQ_CAD_DONE);
+  RADIOLIB_ASSERT(state);
+
+  // clear interrupt flags
+  state = clearIrqStatus();
+  RADIOLIB_ASSERT(state);
+
+  // set mode to CAD
+  return(setCad());
+}
+
 int16_t SX128x::sleep(bool retainConfig) {
   uint8_t sleepConfig = SX128X_SLEEP_DATA_BUFFER_RETAIN | SX128X_SLEEP_DATA_RAM_RETAIN;
   if(!retainConfig) {
@@ -406,29 +415,78 @@ int16_t SX128x::sleep(bool retainConfig) {
   int16_t state = SPIwriteCommand(SX128X_CMD_SET_SLEEP, &sleepConfig, 1, false);
 
   // wait for SX128x to safely enter sleep mode
-  delay(1);
+  Module::delay(1);
 
   return(state);
 }
 
 int16_t SX128x::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   return(SX128x::standby(SX128X_STANDBY_RC));
 }
 
 int16_t SX128x::standby(uint8_t mode) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   uint8_t data[] = { mode };
   return(SPIwriteCommand(SX128X_CMD_SET_STANDBY, data, 1));
 }
 
 void SX128x::setDio1Action(void (*func)(void)) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, RISING);
+  Module::attachInterrupt(_mod->getIrq(), func, RISING);
 }
 
 void SX128x::clearDio1Action() {
-  detachInterrupt(digitalPinToInterrupt(_mod->getIrq()));
+  Module::detachInterrupt(_mod->getIrq());
+}
+
+bool SX128x::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source != 0) || (_mod->getIrq() == RADIOLIB_NC)) {
+    return(false);
+  }
+
+  if(func == NULL) {
+    clearDio1Action();
+  } else {
+    setDio1Action(func);
+  }
+  return(true);
+}
+
+uint16_t SX128x::getEvents() {
+  uint16_t irq = getIrqStatus();
+  uint16_t events = RADIOLIB_EVENT_NONE;
+  if(irq & SX128X_IRQ_TX_DONE) {
+    events |= RADIOLIB_EVENT_TX_DONE;
+  }
+  if(irq & SX128X_IRQ_RX_DONE) {
+    events |= RADIOLIB_EVENT_RX_DONE;
+  }
+  if(irq & (SX128X_IRQ_CRC_ERROR | SX128X_IRQ_HEADER_ERROR)) {
+    events |= RADIOLIB_EVENT_CRC_ERROR;
+  }
+  if(irq & SX128X_IRQ_CAD_DONE) {
+    events |= RADIOLIB_EVENT_CAD_DONE;
+  }
+  if(irq & SX128X_IRQ_CAD_DETECTED) {
+    events |= RADIOLIB_EVENT_CAD_DETECTED;
+  }
+  if(irq & SX128X_IRQ_PREAMBLE_DETECTED) {
+    events |= RADIOLIB_EVENT_PREAMBLE_DETECTED;
+  }
+  if(irq & SX128X_IRQ_SYNC_WORD_VALID) {
+    events |= RADIOLIB_EVENT_SYNC_WORD;
+  }
+  if(irq & SX128X_IRQ_RX_TX_TIMEOUT) {
+    events |= RADIOLIB_EVENT_TIMEOUT;
+  }
+  return(events);
 }
 
 int16_t SX128x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+
   // suppress unused variable warning
   (void)addr;
 
@@ -482,14 +540,27 @@ int16_t SX128x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   RADIOLIB_ASSERT(state);
 
   // wait for BUSY to go low (= PA ramp up done)
-  while(digitalRead(_mod->getGpio())) {
-    yield();
-  }
+  while(!Module::waitForPin(_mod->getGpio(), LOW, RADIOLIB_WAIT_SLICE));
 
   return(state);
 }
 
+int16_t SX128x::finishTransmit() {
+  // clear interrupt flags
+  int16_t state = clearIrqStatus();
+  RADIOLIB_ASSERT(state);
+
+  // set mode to standby to disable transmitter
+  return(standby());
+}
+
+int16_t SX128x::startReceive() {
+  return(startReceive(SX128X_RX_TIMEOUT_INF));
+}
+
 int16_t SX128x::startReceive(uint16_t timeout) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
   // check active modem
   if(getPacketType() == SX128X_PACKET_TYPE_RANGING) {
     return(ERR_WRONG_MODEM);
@@ -520,6 +591,8 @@ int16_t SX128x::startReceive(uint16_t timeout) {
 }
 
 int16_t SX128x::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
   // check active modem
   if(getPacketType() == SX128X_PACKET_TYPE_RANGING) {
     return(ERR_WRONG_MODEM);
@@ -1254,97 +1327,81 @@ int16_t SX128x::SPIreadCommand(uint8_t cmd, uint8_t* data, uint8_t numBytes, boo
 }
 
 int16_t SX128x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes, bool waitForBusy, uint32_t timeout) {
-  // get pointer to used SPI interface and the settings
-  SPIClass* spi = _mod->getSpi();
-  SPISettings spiSettings = _mod->getSpiSettings();
-
-  #ifdef RADIOLIB_VERBOSE
-    uint8_t debugBuff[256];
-  #endif
+  // command byte(s), followed by data bytes
+  // read-type commands have one additional status-only byte before the data, write-type commands send the first data byte with the header,
+  // so that the status clocked out with it ends up in the header
+  uint8_t head[RADIOLIB_SPI_HEADER_SIZE];
+  uint8_t headLen = cmdLen;
+  memcpy(head, cmd, cmdLen);
+  if(!write) {
+    head[headLen++] = SX128X_CMD_NOP;
+  } else if(numBytes > 0) {
+    head[headLen++] = dataOut[0];
+  }
 
   // ensure BUSY is low (state machine ready)
-  uint32_t start = millis();
-  while(digitalRead(_mod->getGpio())) {
-    yield();
-    if(millis() - start >= timeout) {
-      digitalWrite(_mod->getCs(), HIGH);
-      return(ERR_SPI_CMD_TIMEOUT);
-    }
+  #ifdef RADIOLIB_STATS
+    uint32_t busyStart = Module::micros();
+  #endif
+  bool ready = Module::waitForPin(_mod->getGpio(), LOW, timeout);
+  #ifdef RADIOLIB_STATS
+    _mod->statsAddBusyWait(Module::micros() - busyStart);
+  #endif
+  if(!ready) {
+    Module::digitalWrite(_mod->getCs(), HIGH);
+    return(ERR_SPI_CMD_TIMEOUT);
   }
 
-  // pull NSS low
-  digitalWrite(_mod->getCs(), LOW);
+  // jobs of other modules on a shared bus have to run before NSS is pulled low
+  _mod->SPIprepareTransaction();
 
-  // start transfer
-  spi->beginTransaction(spiSettings);
+  // pull NSS low
+  Module::digitalWrite(_mod->getCs(), LOW);
 
-  // send command byte(s)
-  for(uint8_t n = 0; n < cmdLen; n++) {
-    spi->transfer(cmd[n]);
-  }
+  #ifdef RADIOLIB_SPI_TRACE
+    uint32_t traceTime = Module::micros();
+  #endif
 
-  // variable to save error during SPI transfer
-  uint8_t status = 0;
+  // start transfer
+  _mod->SPIbeginTransaction();
 
-  // send/receive all bytes
+  // send the frame, for write-type commands status clocked out with the rest of the data is checked block by block as it arrives
+  uint8_t dataStatus = 0;
   if(write) {
-    for(uint8_t n = 0; n < numBytes; n++) {
-      // send byte
-      uint8_t in = spi->transfer(dataOut[n]);
-      #ifdef RADIOLIB_VERBOSE
-        debugBuff[n] = in;
-      #endif
-
-      // check status
-      if(((in & 0b00011100) == SX128X_STATUS_CMD_TIMEOUT) ||
-         ((in & 0b00011100) == SX128X_STATUS_CMD_ERROR) ||
-         ((in & 0b00011100) == SX128X_STATUS_CMD_FAILED)) {
-        status = in & 0b00011100;
-        break;
-      } else if(in == 0x00 || in == 0xFF) {
-        status = SX128X_STATUS_SPI_FAILED;
-        break;
-      }
-    }
-
+    dataStatus = _mod->SPItransferFrameChecked(head, headLen, (numBytes > 1) ? dataOut + 1 : NULL, (numBytes > 1) ? numBytes - 1 : 0, SX128x::SPIcheckStatus);
   } else {
-    // skip the first byte for read-type commands (status-only)
-    uint8_t in = spi->transfer(SX128X_CMD_NOP);
-    #ifdef RADIOLIB_VERBOSE
-      debugBuff[0] = in;
-    #endif
-
-    // check status
-    if(((in & 0b00011100) == SX128X_STATUS_CMD_TIMEOUT) ||
-       ((in & 0b00011100) == SX128X_STATUS_CMD_ERROR) ||
-       ((in & 0b00011100) == SX128X_STATUS_CMD_FAILED)) {
-      status = in & 0b00011100;
-    } else if(in == 0x00 || in == 0xFF) {
-      status = SX128X_STATUS_SPI_FAILED;
-    } else {
-      for(uint8_t n = 0; n < numBytes; n++) {
-        dataIn[n] = spi->transfer(SX128X_CMD_NOP);
-      }
-    }
+    _mod->SPItransferFrame(head, headLen, NULL, dataIn, numBytes, SX128X_CMD_NOP);
   }
 
   // stop transfer
-  spi->endTransaction();
-  digitalWrite(_mod->getCs(), HIGH);
+  _mod->SPIendTransaction();
+  Module::digitalWrite(_mod->getCs(), HIGH);
+
+  // check status - the chip clocks out status with every byte after the command, for read-type commands the data follow the first one
+  uint8_t status = SPIcheckStatus(head + cmdLen, headLen - cmdLen);
+  if(status == 0) {
+    status = dataStatus;
+  }
 
   // wait for BUSY to go high and then low
   if(waitForBusy) {
-    delayMicroseconds(1);
-    start = millis();
-    while(digitalRead(_mod->getGpio())) {
-      yield();
-      if(millis() - start >= timeout) {
-        status = SX128X_STATUS_CMD_TIMEOUT;
-        break;
-      }
+    Module::delayMicroseconds(1);
+    #ifdef RADIOLIB_STATS
+      busyStart = Module::micros();
+    #endif
+    ready = Module::waitForPin(_mod->getGpio(), LOW, timeout);
+    #ifdef RADIOLIB_STATS
+      _mod->statsAddBusyWait(Module::micros() - busyStart);
+    #endif
+    if(!ready) {
+      status = SX128X_STATUS_CMD_TIMEOUT;
     }
   }
 
+  #ifdef RADIOLIB_SPI_TRACE
+    _mod->SPItraceRecord(cmd, cmdLen, write, write ? dataOut : dataIn, numBytes, status, traceTime);
+  #endif
+
   // print debug output
   #ifdef RADIOLIB_VERBOSE
     // print command byte(s)
@@ -1362,19 +1419,16 @@ int16_t SX128x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* d
       for(uint8_t n = 0; n < numBytes; n++) {
         RADIOLIB_VERBOSE_PRINT(dataOut[n], HEX);
         RADIOLIB_VERBOSE_PRINT('\t');
-        RADIOLIB_VERBOSE_PRINT(debugBuff[n], HEX);
-        RADIOLIB_VERBOSE_PRINT('\t');
       }
       RADIOLIB_VERBOSE_PRINTLN();
     } else {
       RADIOLIB_VERBOSE_PRINT("R\t");
-      // skip the first byte for read-type commands (status-only)
+      // the first byte is status-only, the rest is data
       RADIOLIB_VERBOSE_PRINT(SX128X_CMD_NOP, HEX);
       RADIOLIB_VERBOSE_PRINT('\t');
-      RADIOLIB_VERBOSE_PRINT(debugBuff[0], HEX);
-      RADIOLIB_VERBOSE_PRINT('\t')
-
-      for(uint8_t n = 0; n < numBytes; n++) {
+      RADIOLIB_VERBOSE_PRINT(head[cmdLen], HEX);
+      RADIOLIB_VERBOSE_PRINT('\t');
+      for(size_t n = 0; n < numBytes; n++) {
         RADIOLIB_VERBOSE_PRINT(SX128X_CMD_NOP, HEX);
         RADIOLIB_VERBOSE_PRINT('\t');
         RADIOLIB_VERBOSE_PRINT(dataIn[n], HEX);
@@ -1388,7 +1442,7 @@ int16_t SX128x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* d
     // not sure why, but it seems that long enough SPI transaction
     // (e.g. setPacketParams for GFSK) will fail without it
     #if defined(ARDUINO_ARCH_STM32)
-      delay(1);
+      Module::delay(1);
     #endif
   #endif
 
@@ -1406,3 +1460,16 @@ int16_t SX128x::SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* d
       return(ERR_NONE);
   }
 }
+
+uint8_t SX128x::SPIcheckStatus(const uint8_t* in, size_t len) {
+  for(size_t n = 0; n < len; n++) {
+    if(((in[n] & 0b00011100) == SX128X_STATUS_CMD_TIMEOUT) ||
+       ((in[n] & 0b00011100) == SX128X_STATUS_CMD_ERROR) ||
+       ((in[n] & 0b00011100) == SX128X_STATUS_CMD_FAILED)) {
+      return(in[n] & 0b00011100);
+    } else if(in[n] == 0x00 || in[n] == 0xFF) {
+      return(SX128X_STATUS_SPI_FAILED);
+    }
+  }
+  return(0);
+}
@@ -484,6 +484,13 @@ class SX128x: public PhysicalLayer {
     */
     int16_t scanChannel();
 
+    /*!
+      \brief Interrupt-driven channel activity detection method. DIO1 will be activated when the scan is finished.
+
+      \returns \ref status_codes
+    */
+    int16_t startChannelScan();
+
     /*!
       \brief Sets the module to sleep mode.
 
@@ -523,6 +530,24 @@ class SX128x: public PhysicalLayer {
     */
     void clearDio1Action();
 
+    /*!
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is DIO1.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
     /*!
       \brief Interrupt-driven binary transmit method.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -537,14 +562,28 @@ class SX128x: public PhysicalLayer {
     */
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - clears IRQ status and sets module to standby.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
+    /*!
+      \brief Interrupt-driven receive method in Rx continuous mode. DIO1 will be activated when full packet is received.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceive();
+
     /*!
       \brief Interrupt-driven receive method. DIO1 will be activated when full packet is received.
 
-      \param timeout Raw timeout value, expressed as multiples of 15.625 us. Defaults to SX128X_RX_TIMEOUT_INF for infinite timeout (Rx continuous mode), set to SX128X_RX_TIMEOUT_NONE for no timeout (Rx single mode).
+      \param timeout Raw timeout value, expressed as multiples of 15.625 us. Set to SX128X_RX_TIMEOUT_INF for infinite timeout (Rx continuous mode), set to SX128X_RX_TIMEOUT_NONE for no timeout (Rx single mode).
 
       \returns \ref status_codes
     */
-    int16_t startReceive(uint16_t timeout = SX128X_RX_TIMEOUT_INF);
+    int16_t startReceive(uint16_t timeout);
 
     /*!
       \brief Reads data received after calling startReceive method.
@@ -802,6 +841,7 @@ class SX128x: public PhysicalLayer {
     int16_t SPIreadCommand(uint8_t cmd, uint8_t* data, uint8_t numBytes, bool waitForBusy = true);
     int16_t SPIreadCommand(uint8_t* cmd, uint8_t cmdLen, uint8_t* data, uint8_t numBytes, bool waitForBusy = true);
     int16_t SPItransfer(uint8_t* cmd, uint8_t cmdLen, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes, bool waitForBusy, uint32_t timeout = 5000);
+    static uint8_t SPIcheckStatus(const uint8_t* in, size_t len);
 };
 
 #endif
@@ -0,0 +1,407 @@
+#include "SX128xEmulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+SX128xEmulator::SX128xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE busy, RADIOLIB_PIN_TYPE dio1, RADIOLIB_PIN_TYPE rst) : CommandChipEmulator(cs, busy, dio1, rst) {
+  for(uint16_t i = 0; i < 256; i++) {
+    setBusyTime(i, SX128X_EMULATOR_BUSY_DEFAULT);
+  }
+  setBusyTime(SX128X_CMD_SET_FS, SX128X_EMULATOR_BUSY_SET_FS);
+  setBusyTime(SX128X_CMD_SET_TX, SX128X_EMULATOR_BUSY_SET_TX);
+  setBusyTime(SX128X_CMD_SET_RX, SX128X_EMULATOR_BUSY_SET_RX);
+  setBusyTime(SX128X_CMD_SET_RX_DUTY_CYCLE, SX128X_EMULATOR_BUSY_SET_RX);
+  setBusyTime(SX128X_CMD_SET_CAD, SX128X_EMULATOR_BUSY_SET_CAD);
+  setStartupTime(SX128X_EMULATOR_STARTUP_TIME);
+  reset();
+}
+
+uint8_t SX128xEmulator::getRegister(uint16_t addr) {
+  return(_regs[addr % SX128X_EMULATOR_REG_SPACE]);
+}
+
+uint64_t SX128xEmulator::getTimeOnAir(size_t len) {
+  if(isLoRa()) {
+    // preamble length is encoded as mantissa and exponent, long interleaving is approximated by the corresponding standard coding rate
+    uint8_t sf = _modParams[0] >> 4;
+    uint8_t cr = _modParams[2];
+    if(cr > SX128X_LORA_CR_4_8) {
+      cr = (cr == SX128X_LORA_CR_4_7_LI) ? SX128X_LORA_CR_4_8 : cr - SX128X_LORA_CR_4_8;
+    }
+    uint32_t preamble = (uint32_t)(_pktParams[0] & 0x0F) << ((_pktParams[0] & 0xF0) >> 4);
+    return(getLoRaTimeOnAir(sf, getBandwidth(), cr, preamble, len,
+                            _pktParams[3] == SX128X_LORA_CRC_ON, _pktParams[1] == SX128X_LORA_HEADER_IMPLICIT, sf >= 11));
+  }
+
+  uint32_t bits = 0;
+  if(_packetType == SX128X_PACKET_TYPE_BLE) {
+    // preamble, access address, PDU header, payload and CRC
+    bits = 8 + 32 + 16 + 8*len + 24;
+
+  } else if(_packetType == SX128X_PACKET_TYPE_FLRC) {
+    // header, payload, CRC and tail are encoded with the configured coding rate
+    uint32_t coded = 16 + 8*len + 8*(_pktParams[5] >> 4);
+    if(_modParams[1] == SX128X_FLRC_CR_1_2) {
+      coded *= 2;
+    } else if(_modParams[1] == SX128X_FLRC_CR_3_4) {
+      coded = (coded * 4 + 2) / 3;
+    }
+    bits = 4*((_pktParams[0] >> 4) + 1) + 21 + ((_pktParams[1] == SX128X_FLRC_SYNC_WORD_ON) ? 32 : 0) + coded + 6;
+
+  } else {
+    bits = 4*((_pktParams[0] >> 4) + 1) + 8*((_pktParams[1] >> 1) + 1) + 8*len + 8*(_pktParams[5] >> 4);
+    if(_pktParams[3] == SX128X_GFSK_FLRC_PACKET_VARIABLE) {
+      bits += 8;
+    }
+  }
+  return(((uint64_t)bits * 1000000000ULL) / getBitRate());
+}
+
+void SX128xEmulator::command(const uint8_t* in, uint8_t* out, size_t len) {
+  // all bytes clocked out by the chip carry status, data bytes are overwritten below
+  memset(out, getStatus(), len);
+  _cmdStatus = SX128X_STATUS_CMD_PROCESSED;
+
+  // parameters start after opcode, response data of read commands after one more status byte
+  const uint8_t* param = &in[1];
+  size_t paramLen = len - 1;
+  uint8_t* resp = &out[2];
+  size_t respLen = (len > 2) ? len - 2 : 0;
+
+  switch(in[0]) {
+    case SX128X_CMD_SET_SLEEP:
+      enterSleep(!(param[0] & SX128X_SLEEP_DATA_RAM_RETAIN));
+      break;
+
+    case SX128X_CMD_SET_STANDBY:
+      enterStandby();
+      _xosc = (param[0] == SX128X_STANDBY_XOSC);
+      break;
+
+    case SX128X_CMD_SET_FS:
+      enterStandby(RADIOLIB_EMULATOR_STATE_FS);
+      break;
+
+    case SX128X_CMD_SET_TX: {
+      // BLE payload length is in the second byte of PDU header
+      size_t txLen = _pktParams[4];
+      if(isLoRa()) {
+        txLen = _pktParams[2];
+      } else if(_packetType == SX128X_PACKET_TYPE_BLE) {
+        txLen = _buff[(uint8_t)(_txBase + 1)] + 2;
+      }
+      startTx(txLen, getTimeout(param));
+    } break;
+
+    case SX128X_CMD_SET_RX: {
+      uint16_t count = ((uint16_t)param[1] << 8) | param[2];
+      startRx(getTimeout(param), count == SX128X_RX_TIMEOUT_INF);
+    } break;
+
+    case SX128X_CMD_SET_RX_DUTY_CYCLE:
+      startRx(0, true);
+      break;
+
+    case SX128X_CMD_SET_CAD:
+      startCad((1UL << (_cadParams >> 5)) * getSymbolTime());
+      break;
+
+    case SX128X_CMD_SET_TX_CONTINUOUS_WAVE:
+    case SX128X_CMD_SET_TX_CONTINUOUS_PREAMBLE:
+      enterStandby(RADIOLIB_EMULATOR_STATE_TX);
+      break;
+
+    case SX128X_CMD_WRITE_REGISTER: {
+      uint16_t addr = ((uint16_t)param[0] << 8) | param[1];
+      for(size_t i = 2; i < paramLen; i++) {
+        _regs[(addr + i - 2) % SX128X_EMULATOR_REG_SPACE] = param[i];
+      }
+    } break;
+
+    case SX128X_CMD_READ_REGISTER: {
+      uint16_t addr = ((uint16_t)param[0] << 8) | param[1];
+      for(size_t i = 4; i < len; i++) {
+        out[i] = _regs[(addr + i - 4) % SX128X_EMULATOR_REG_SPACE];
+      }
+    } break;
+
+    case SX128X_CMD_WRITE_BUFFER:
+      for(size_t i = 1; i < paramLen; i++) {
+        _buff[(uint8_t)(param[0] + i - 1)] = param[i];
+      }
+      break;
+
+    case SX128X_CMD_READ_BUFFER:
+      for(size_t i = 3; i < len; i++) {
+        out[i] = _buff[(uint8_t)(param[0] + i - 3)];
+      }
+      break;
+
+    case SX128X_CMD_SET_DIO_IRQ_PARAMS:
+      _irqMask = ((uint16_t)param[0] << 8) | param[1];
+      _dio1Mask = ((uint16_t)param[2] << 8) | param[3];
+      break;
+
+    case SX128X_CMD_GET_IRQ_STATUS:
+      if(respLen >= 2) {
+        resp[0] = (uint8_t)(_irq >> 8);
+        resp[1] = (uint8_t)(_irq & 0xFF);
+      }
+      break;
+
+    case SX128X_CMD_CLEAR_IRQ_STATUS:
+      _irq &= ~(((uint16_t)param[0] << 8) | param[1]);
+      break;
+
+    case SX128X_CMD_SET_RF_FREQUENCY:
+      _frf = ((uint32_t)param[0] << 16) | ((uint32_t)param[1] << 8) | param[2];
+      break;
+
+    case SX128X_CMD_SET_PACKET_TYPE:
+      _packetType = param[0];
+      break;
+
+    case SX128X_CMD_GET_PACKET_TYPE:
+      if(respLen >= 1) {
+        resp[0] = _packetType;
+      }
+      break;
+
+    case SX128X_CMD_SET_MODULATION_PARAMS:
+      memcpy(_modParams, param, min(paramLen, sizeof(_modParams)));
+      break;
+
+    case SX128X_CMD_SET_PACKET_PARAMS:
+      memcpy(_pktParams, param, min(paramLen, sizeof(_pktParams)));
+      break;
+
+    case SX128X_CMD_SET_CAD_PARAMS:
+      _cadParams = param[0];
+      break;
+
+    case SX128X_CMD_SET_BUFFER_BASE_ADDRESS:
+      _txBase = param[0];
+      _rxBase = param[1];
+      break;
+
+    case SX128X_CMD_GET_RSSI_INST:
+      if(respLen >= 1) {
+        resp[0] = (uint8_t)(-2 * ((_airSrc != NULL) ? _rssi : -120));
+      }
+      break;
+
+    case SX128X_CMD_GET_RX_BUFFER_STATUS:
+      if(respLen >= 2) {
+        resp[0] = _rxLen;
+        resp[1] = _rxStart;
+      }
+      break;
+
+    case SX128X_CMD_GET_PACKET_STATUS:
+      if(respLen >= 5) {
+        memset(resp, 0x00, 5);
+        if(isLoRa()) {
+          resp[0] = (uint8_t)(-2 * _rssi);
+          resp[1] = (uint8_t)(4 * _snr);
+        } else {
+          resp[1] = (uint8_t)(-2 * _rssi);
+          resp[2] = SX128X_PACKET_STATUS_PACKET_RECEIVED | (_crcError ? SX128X_PACKET_STATUS_CRC_ERROR : 0);
+          resp[4] = SX128X_PACKET_STATUS_SYNC_DET_1;
+        }
+      }
+      break;
+
+    case SX128X_CMD_NOP:
+    case SX128X_CMD_GET_STATUS:
+    case SX128X_CMD_SET_TX_PARAMS:
+    case SX128X_CMD_SET_REGULATOR_MODE:
+    case SX128X_CMD_SET_SAVE_CONTEXT:
+    case SX128X_CMD_SET_AUTO_TX:
+    case SX128X_CMD_SET_AUTO_FS:
+    case SX128X_CMD_SET_PERF_COUNTER_MODE:
+    case SX128X_CMD_SET_LONG_PREAMBLE:
+    case SX128X_CMD_SET_UART_SPEED:
+    case SX128X_CMD_SET_RANGING_ROLE:
+    case SX128X_CMD_SET_ADVANCED_RANGING:
+      // accepted, but have no effect on emulation
+      break;
+
+    default:
+      _cmdStatus = SX128X_STATUS_CMD_ERROR;
+      memset(out, getStatus(), len);
+      _cmdStatus = SX128X_STATUS_CMD_PROCESSED;
+      break;
+  }
+}
+
+void SX128xEmulator::resetConfig() {
+  memset(_regs, 0x00, sizeof(_regs));
+
+  // power-on defaults: GFSK at 2 Mbps, 2.4 GHz
+  _packetType = SX128X_PACKET_TYPE_GFSK;
+  _frf = 0xB89D89;
+  _modParams[0] = SX128X_BLE_GFSK_BR_2_000_BW_2_4;
+  _modParams[1] = SX128X_BLE_GFSK_MOD_IND_1_00;
+  _modParams[2] = SX128X_BLE_GFSK_BT_0_5;
+  memset(_pktParams, 0x00, sizeof(_pktParams));
+  _cadParams = SX128X_CAD_ON_8_SYMB;
+  _cmdStatus = SX128X_STATUS_CMD_PROCESSED;
+  _xosc = false;
+  _crcError = false;
+}
+
+EmulatorAir_t SX128xEmulator::getAir() {
+  EmulatorAir_t air;
+  air.freq = (uint32_t)(((uint64_t)_frf * (uint64_t)(SX128X_CRYSTAL_FREQ * 1000000.0)) >> SX128X_DIV_EXPONENT);
+  air.sf = 0;
+  if(isLoRa()) {
+    air.modem = RADIOLIB_EMULATOR_MODEM_LORA;
+    air.rate = getBandwidth();
+    air.sf = _modParams[0] >> 4;
+  } else if(_packetType == SX128X_PACKET_TYPE_FLRC) {
+    air.modem = RADIOLIB_EMULATOR_MODEM_FLRC;
+    air.rate = getBitRate();
+  } else {
+    air.modem = RADIOLIB_EMULATOR_MODEM_GFSK_24;
+    air.rate = getBitRate();
+  }
+  return(air);
+}
+
+bool SX128xEmulator::isVariableLength() {
+  return(((_packetType == SX128X_PACKET_TYPE_GFSK) || (_packetType == SX128X_PACKET_TYPE_FLRC)) && (_pktParams[3] == SX128X_GFSK_FLRC_PACKET_VARIABLE));
+}
+
+void SX128xEmulator::event(uint8_t event) {
+  switch(event) {
+    case RADIOLIB_EMULATOR_EVENT_TX_DONE:
+      setIrq(SX128X_IRQ_TX_DONE);
+      _cmdStatus = SX128X_STATUS_TX_DONE;
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_TIMEOUT:
+      setIrq(SX128X_IRQ_RX_TX_TIMEOUT);
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_CAD_DONE:
+      setIrq(SX128X_IRQ_CAD_DONE);
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_CAD_DETECTED:
+      setIrq(SX128X_IRQ_CAD_DONE | SX128X_IRQ_CAD_DETECTED);
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_RX_START:
+      if(!isLoRa()) {
+        setIrq(SX128X_IRQ_PREAMBLE_DETECTED | SX128X_IRQ_SYNC_WORD_VALID);
+      } else if(_pktParams[1] == SX128X_LORA_HEADER_EXPLICIT) {
+        setIrq(SX128X_IRQ_PREAMBLE_DETECTED | SX128X_IRQ_HEADER_VALID);
+      } else {
+        setIrq(SX128X_IRQ_PREAMBLE_DETECTED);
+      }
+      break;
+
+    case RADIOLIB_EMULATOR_EVENT_RX_DONE:
+    case RADIOLIB_EMULATOR_EVENT_RX_CRC_ERROR:
+      _crcError = (event == RADIOLIB_EMULATOR_EVENT_RX_CRC_ERROR);
+      setIrq(SX128X_IRQ_RX_DONE | (_crcError ? SX128X_IRQ_CRC_ERROR : 0));
+      _cmdStatus = SX128X_STATUS_DATA_AVAILABLE;
+      break;
+  }
+}
+
+bool SX128xEmulator::isLoRa() {
+  return((_packetType == SX128X_PACKET_TYPE_LORA) || (_packetType == SX128X_PACKET_TYPE_RANGING));
+}
+
+uint8_t SX128xEmulator::getStatus() {
+  uint8_t mode = _xosc ? SX128X_STATUS_MODE_STDBY_XOSC : SX128X_STATUS_MODE_STDBY_RC;
+  switch(_state) {
+    case RADIOLIB_EMULATOR_STATE_FS:
+      mode = SX128X_STATUS_MODE_FS;
+      break;
+    case RADIOLIB_EMULATOR_STATE_TX:
+      mode = SX128X_STATUS_MODE_TX;
+      break;
+    case RADIOLIB_EMULATOR_STATE_RX:
+    case RADIOLIB_EMULATOR_STATE_CAD:
+      mode = SX128X_STATUS_MODE_RX;
+      break;
+  }
+  return(mode | _cmdStatus);
+}
+
+uint32_t SX128xEmulator::getBandwidth() {
+  switch(_modParams[1]) {
+    case SX128X_LORA_BW_1625_00:
+      return(1625000);
+    case SX128X_LORA_BW_812_50:
+      return(812500);
+    case SX128X_LORA_BW_406_25:
+      return(406250);
+    default:
+      return(203125);
+  }
+}
+
+uint32_t SX128xEmulator::getBitRate() {
+  // FLRC and GFSK/BLE share some of the register values
+  if(_packetType == SX128X_PACKET_TYPE_FLRC) {
+    switch(_modParams[0]) {
+      case SX128X_FLRC_BR_1_300_BW_1_2:
+        return(1300000);
+      case SX128X_FLRC_BR_1_000_BW_1_2:
+        return(1040000);
+      case SX128X_FLRC_BR_0_650_BW_0_6:
+        return(650000);
+      case SX128X_FLRC_BR_0_520_BW_0_6:
+        return(520000);
+      case SX128X_FLRC_BR_0_325_BW_0_3:
+        return(325000);
+      default:
+        return(260000);
+    }
+  }
+
+  switch(_modParams[0]) {
+    case SX128X_BLE_GFSK_BR_2_000_BW_2_4:
+      return(2000000);
+    case SX128X_BLE_GFSK_BR_1_600_BW_2_4:
+      return(1600000);
+    case SX128X_BLE_GFSK_BR_1_000_BW_2_4:
+    case SX128X_BLE_GFSK_BR_1_000_BW_1_2:
+      return(1000000);
+    case SX128X_BLE_GFSK_BR_0_800_BW_2_4:
+    case SX128X_BLE_GFSK_BR_0_800_BW_1_2:
+      return(800000);
+    case SX128X_BLE_GFSK_BR_0_500_BW_1_2:
+    case SX128X_BLE_GFSK_BR_0_500_BW_0_6:
+      return(500000);
+    case SX128X_BLE_GFSK_BR_0_400_BW_1_2:
+    case SX128X_BLE_GFSK_BR_0_400_BW_0_6:
+      return(400000);
+    case SX128X_BLE_GFSK_BR_0_250_BW_0_6:
+    case SX128X_BLE_GFSK_BR_0_250_BW_0_3:
+      return(250000);
+    default:
+      return(125000);
+  }
+}
+
+uint64_t SX128xEmulator::getSymbolTime() {
+  if(!isLoRa()) {
+    return((8ULL * 1000000000ULL) / getBitRate());
+  }
+  return(((uint64_t)1000000000 << (_modParams[0] >> 4)) / getBandwidth());
+}
+
+uint64_t SX128xEmulator::getTimeout(const uint8_t* param) {
+  // 16-bit timeout in units of configurable period base, 0 means no timeout
+  static const uint64_t periodBase[] = { 15625, 62500, 1000000, 4000000 };
+  uint16_t count = ((uint16_t)param[1] << 8) | param[2];
+  if(count == SX128X_RX_TIMEOUT_INF) {
+    return(0);
+  }
+  return((uint64_t)count * periodBase[param[0] & 0x03]);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef _RADIOLIB_SX128X_EMULATOR_H
+#define _RADIOLIB_SX128X_EMULATOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include "../../EmulatorHal.h"
+#include "SX128x.h"
+
+// size of emulated register address space
+#define SX128X_EMULATOR_REG_SPACE                     0x1000
+
+// default BUSY times in ns, approximated from datasheet switching times - override with setBusyTime to match measured hardware
+#define SX128X_EMULATOR_BUSY_DEFAULT                  1000
+#define SX128X_EMULATOR_BUSY_SET_FS                   55000
+#define SX128X_EMULATOR_BUSY_SET_TX                   80000
+#define SX128X_EMULATOR_BUSY_SET_RX                   70000
+#define SX128X_EMULATOR_BUSY_SET_CAD                  70000
+#define SX128X_EMULATOR_STARTUP_TIME                  1500000
+
+/*!
+  \class SX128xEmulator
+
+  \brief Command-level emulator of SX128x series chips, to be attached to EmulatorHal. Implements the command set used by SX128x driver:
+  packet type, modulation and packet parameters, data buffer access, IRQ configuration and status, TX/RX with timeouts and CAD,
+  for LoRa, GFSK, FLRC and BLE packet types. BUSY is held high after each command for configurable time (see setBusyTime),
+  and IRQs are raised in virtual time, so the time spent by the driver waiting for BUSY can be measured for typical flows.
+
+  Limitations: ranging is emulated as LoRa, sync word and address filtering, whitening, RX duty cycle (emulated as continuous RX),
+  long interleaving time-on-air (approximated by standard coding rate) and analog measurements are not emulated.
+*/
+class SX128xEmulator: public CommandChipEmulator {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param busy BUSY pin.
+
+      \param dio1 DIO1 pin.
+
+      \param rst Reset pin.
+    */
+    SX128xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE busy, RADIOLIB_PIN_TYPE dio1, RADIOLIB_PIN_TYPE rst);
+
+    /*!
+      \brief Reads register value.
+
+      \param addr Register address.
+
+      \returns Register value.
+    */
+    uint8_t getRegister(uint16_t addr);
+
+    uint64_t getTimeOnAir(size_t len);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    uint8_t _regs[SX128X_EMULATOR_REG_SPACE];
+    uint8_t _packetType;
+    uint32_t _frf;
+    uint8_t _modParams[3];
+    uint8_t _pktParams[7];
+    uint8_t _cadParams;
+    uint8_t _cmdStatus;
+    bool _xosc;
+    bool _crcError;
+
+    void command(const uint8_t* in, uint8_t* out, size_t len);
+    void resetConfig();
+    EmulatorAir_t getAir();
+    bool isVariableLength();
+    void event(uint8_t event);
+
+    bool isLoRa();
+    uint8_t getStatus();
+    uint32_t getBandwidth();
+    uint32_t getBitRate();
+    uint64_t getSymbolTime();
+    uint64_t getTimeout(const uint8_t* param);
+};
+
+#endif
+
+#endif
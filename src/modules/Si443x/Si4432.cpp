@@ -5,6 +5,8 @@ Si4432::Si4432(Module* mod) : Si443x(mod) {
 }
 
 int16_t Si4432::begin(float freq, float br, float freqDev, float rxBw, int8_t power) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // execute common part
   int16_t state = Si443x::begin(br, freqDev, rxBw);
   RADIOLIB_ASSERT(state);
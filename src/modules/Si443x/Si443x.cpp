@@ -4,10 +4,23 @@ Si443x::Si443x(Module* mod) : PhysicalLayer(SI443X_FREQUENCY_STEP_SIZE, SI443X_M
   _mod = mod;
 
   _packetLengthQueried = false;
+  _unlimited = false;
+  _fifoTxActive = false;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+  _fifoCrcOk = false;
+  _irqFlags = 0;
 }
 
 int16_t Si443x::begin(float br, float freqDev, float rxBw) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
+  _mod->SPIvolatileRegs = Si443xVolatileRegs;
+  _mod->SPIvolatileRegsLen = sizeof(Si443xVolatileRegs);
+  _mod->SPIslowRegs = Si443xSlowRegs;
+  _mod->SPIslowRegsLen = sizeof(Si443xSlowRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
   Module::pinMode(_mod->getIrq(), INPUT);
   Module::pinMode(_mod->getRst(), OUTPUT);
@@ -58,26 +71,37 @@ int16_t Si443x::begin(float br, float freqDev, float rxBw) {
 void Si443x::reset() {
   Module::pinMode(_mod->getRst(), OUTPUT);
   Module::digitalWrite(_mod->getRst(), HIGH);
-  delay(1);
+  Module::delay(1);
   Module::digitalWrite(_mod->getRst(), LOW);
-  delay(100);
+  Module::delay(100);
 }
 
 int16_t Si443x::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(transmit(&seg, 1, addr));
+}
+
+int16_t Si443x::transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // calculate timeout (5ms + 500 % of expected time-on-air)
   uint32_t timeout = 5000000 + (uint32_t)((((float)(len * 8)) / (_br * 1000.0)) * 5000000.0);
 
   // start transmission
-  int16_t state = startTransmit(data, len, addr);
+  int16_t state = startTransmit(segs, numSegs, addr);
   RADIOLIB_ASSERT(state);
 
-  // wait for transmission end or timeout
-  uint32_t start = micros();
-  while(digitalRead(_mod->getIrq())) {
-    yield();
-    if(micros() - start > timeout) {
+  // wait for transmission end or timeout, packets longer than FIFO are refilled by serviceFifo whenever nIRQ is asserted
+  uint32_t timeoutMs = timeout / 1000 + 1;
+  uint32_t start = Module::millis();
+  while(!serviceFifo()) {
+    uint32_t elapsed = Module::millis() - start;
+    if((elapsed >= timeoutMs) || !Module::waitForPin(_mod->getIrq(), LOW, timeoutMs - elapsed)) {
       standby();
       clearIRQFlags();
+      _fifoTx.clear();
+      _fifoTxActive = false;
       return(ERR_TX_TIMEOUT);
     }
   }
@@ -92,19 +116,29 @@ int16_t Si443x::transmit(uint8_t* data, size_t len, uint8_t addr) {
 }
 
 int16_t Si443x::receive(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
+
   // calculate timeout (500 ms + 400 full 64-byte packets at current bit rate)
   uint32_t timeout = 500000 + (1.0/(_br*1000.0))*(SI443X_MAX_PACKET_LENGTH*400.0);
+  if(_unlimited) {
+    // add 500 % of time-on-air of the whole buffer
+    timeout += (uint32_t)((((float)(len * 8)) / (_br * 1000.0)) * 5000000.0);
+  }
 
-  // start reception
-  int16_t state = startReceive();
+  // start reception, packets longer than FIFO are drained while they are being received
+  int16_t state = startReceiveStream(data, len);
   RADIOLIB_ASSERT(state);
 
-  // wait for packet reception or timeout
-  uint32_t start = micros();
-  while(digitalRead(_mod->getIrq())) {
-    if(micros() - start > timeout) {
+  // wait for packet reception or timeout, packets longer than FIFO are drained by serviceFifo whenever nIRQ is asserted
+  uint32_t timeoutMs = timeout / 1000 + 1;
+  uint32_t start = Module::millis();
+  while(!serviceFifo()) {
+    uint32_t elapsed = Module::millis() - start;
+    if((elapsed >= timeoutMs) || !Module::waitForPin(_mod->getIrq(), LOW, timeoutMs - elapsed)) {
       standby();
       clearIRQFlags();
+      _fifoRxData = NULL;
+      _fifoRxActive = false;
       return(ERR_RX_TIMEOUT);
     }
   }
@@ -127,6 +161,8 @@ int16_t Si443x::sleep() {
 }
 
 int16_t Si443x::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   return(_mod->SPIsetRegValue(SI443X_REG_OP_FUNC_CONTROL_1, SI443X_XTAL_ON, 7, 0, 10));
 }
 
@@ -184,16 +220,62 @@ int16_t Si443x::packetMode() {
 }
 
 void Si443x::setIrqAction(void (*func)(void)) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, FALLING);
+  Module::attachInterrupt(_mod->getIrq(), func, FALLING);
 }
 
 void Si443x::clearIrqAction() {
-  detachInterrupt(digitalPinToInterrupt(_mod->getIrq()));
+  Module::detachInterrupt(_mod->getIrq());
+}
+
+bool Si443x::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source != 0) || (_mod->getIrq() == RADIOLIB_NC)) {
+    return(false);
+  }
+
+  if(func == NULL) {
+    clearIrqAction();
+  } else {
+    setIrqAction(func);
+  }
+  return(true);
+}
+
+uint16_t Si443x::getEvents() {
+  // reading interrupt status also clears it and releases nIRQ, serviceFifo keeps the flags until they are reported here
+  serviceFifo();
+  uint16_t events = RADIOLIB_EVENT_NONE;
+  uint8_t status1 = _irqFlags;
+  uint8_t status2 = _mod->SPIreadRegister(SI443X_REG_INTERRUPT_STATUS_2);
+  _irqFlags = 0;
+  if(status1 & SI443X_PACKET_SENT_INTERRUPT) {
+    events |= RADIOLIB_EVENT_TX_DONE;
+  }
+  if(status1 & SI443X_VALID_PACKET_RECEIVED_INTERRUPT) {
+    events |= RADIOLIB_EVENT_RX_DONE;
+  }
+  if(status1 & SI443X_CRC_ERROR_INTERRUPT) {
+    events |= RADIOLIB_EVENT_CRC_ERROR;
+  }
+  if(status2 & SI443X_VALID_PREAMBLE_DETECTED_INTERRUPT) {
+    events |= RADIOLIB_EVENT_PREAMBLE_DETECTED;
+  }
+  if(status2 & SI443X_SYNC_WORD_DETECTED_INTERRUPT) {
+    events |= RADIOLIB_EVENT_SYNC_WORD;
+  }
+  return(events);
 }
 
 int16_t Si443x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  TxSegment_t seg = { data, len };
+  return(startTransmit(&seg, 1, addr));
+}
+
+int16_t Si443x::startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+  size_t len = getSegmentsLength(segs, numSegs);
+
   // check packet length
-  if(len > SI443X_MAX_PACKET_LENGTH) {
+  if(len > (_unlimited ? SI443X_MAX_PACKET_LENGTH_UNLIMITED : SI443X_MAX_PACKET_LENGTH_VARIABLE)) {
     return(ERR_PACKET_TOO_LONG);
   }
 
@@ -201,26 +283,44 @@ int16_t Si443x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
 
+  // drop any packet that was being streamed, segment descriptors are copied because packet longer than FIFO is written after this method returns
+  _fifoTxActive = false;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+  if(_fifoTx.set(segs, numSegs) != ERR_NONE) {
+    return(ERR_TOO_MANY_SEGMENTS);
+  }
+
   // clear Tx FIFO
   _mod->SPIsetRegValue(SI443X_REG_OP_FUNC_CONTROL_2, SI443X_TX_FIFO_RESET, 0, 0);
   _mod->SPIsetRegValue(SI443X_REG_OP_FUNC_CONTROL_2, SI443X_TX_FIFO_CLEAR, 0, 0);
 
-  // set interrupt mapping
-  state = _mod->SPIsetRegValue(SI443X_REG_INTERRUPT_ENABLE_1, SI443X_PACKET_SENT_ENABLED);
+  // set interrupt mapping, Tx FIFO almost empty signals that packet longer than FIFO needs more data
+  state = _mod->SPIsetRegValue(SI443X_REG_INTERRUPT_ENABLE_1, SI443X_PACKET_SENT_ENABLED | SI443X_TX_FIFO_ALMOST_EMPTY_ENABLED);
   RADIOLIB_ASSERT(state);
 
   // clear interrupt flags
   clearIRQFlags();
-
-  // set packet length
-  // TODO variable packet length
-  _mod->SPIwriteRegister(SI443X_REG_TRANSMIT_PACKET_LENGTH, len);
+  _irqFlags = 0;
 
   // TODO use header as address field?
   (void)addr;
 
-  // write packet to FIFO
-  _mod->SPIwriteRegisterBurst(SI443X_REG_FIFO_ACCESS, data, len);
+  // set packet length, unlimited length packet starts with its length instead and is padded to the whole number of Rx FIFO thresholds
+  _fifoPos = 0;
+  _fifoLen = len;
+  if(_unlimited) {
+    uint8_t header[] = { (uint8_t)(len >> 8), (uint8_t)(len & 0xFF) };
+    _mod->SPIwriteRegisterBurst(SI443X_REG_FIFO_ACCESS, header, 2);
+    _fifoPos = 2;
+    _fifoLen = ((len + 2 + SI443X_FIFO_THRESHOLD - 1) / SI443X_FIFO_THRESHOLD) * SI443X_FIFO_THRESHOLD;
+  } else {
+    _mod->SPIwriteRegister(SI443X_REG_TRANSMIT_PACKET_LENGTH, len);
+  }
+
+  // write as much of the packet as fits into FIFO, the rest is written by serviceFifo
+  writeFifo(SI443X_FIFO_SIZE - _fifoPos);
+  _fifoTxActive = true;
 
   // set mode to transmit
   _mod->SPIwriteRegister(SI443X_REG_OP_FUNC_CONTROL_1, SI443X_TX_ON);
@@ -228,23 +328,44 @@ int16_t Si443x::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   return(state);
 }
 
+int16_t Si443x::finishTransmit() {
+  // set mode to standby
+  int16_t state = standby();
+
+  // clear interrupt flags
+  clearIRQFlags();
+  _fifoTx.clear();
+  _fifoTxActive = false;
+  return(state);
+}
+
 int16_t Si443x::startReceive() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
 
+  // drop any packet that was being streamed
+  _fifoTx.clear();
+  _fifoTxActive = false;
+  _fifoRxData = NULL;
+  _fifoRxActive = false;
+  _packetLengthQueried = false;
+
   // clear Rx FIFO
   _mod->SPIsetRegValue(SI443X_REG_OP_FUNC_CONTROL_2, SI443X_RX_FIFO_RESET, 1, 1);
   _mod->SPIsetRegValue(SI443X_REG_OP_FUNC_CONTROL_2, SI443X_RX_FIFO_CLEAR, 1, 1);
 
   // set interrupt mapping
-  state = _mod->SPIsetRegValue(SI443X_REG_INTERRUPT_ENABLE_1, SI443X_VALID_PACKET_RECEIVED_ENABLED, SI443X_CRC_ERROR_ENABLED);
+  state = _mod->SPIsetRegValue(SI443X_REG_INTERRUPT_ENABLE_1, SI443X_VALID_PACKET_RECEIVED_ENABLED | SI443X_CRC_ERROR_ENABLED);
   RADIOLIB_ASSERT(state);
   state = _mod->SPIsetRegValue(SI443X_REG_INTERRUPT_ENABLE_2, 0x00);
   RADIOLIB_ASSERT(state);
 
   // clear interrupt flags
   clearIRQFlags();
+  _irqFlags = 0;
 
   // set mode to receive
   _mod->SPIwriteRegister(SI443X_REG_OP_FUNC_CONTROL_1, SI443X_RX_ON);
@@ -252,7 +373,120 @@ int16_t Si443x::startReceive() {
   return(state);
 }
 
+int16_t Si443x::startReceiveStream(uint8_t* data, size_t len) {
+  int16_t state = startReceive();
+  RADIOLIB_ASSERT(state);
+
+  // Rx FIFO almost full signals that the next chunk can be drained, preamble and sync word take longer than enabling it
+  state = _mod->SPIsetRegValue(SI443X_REG_INTERRUPT_ENABLE_1, SI443X_RX_FIFO_ALMOST_FULL_ENABLED, 4, 4);
+  RADIOLIB_ASSERT(state);
+
+  // length of unlimited length packet is in its first two bytes, in variable length mode it is only known at the end of the packet
+  _fifoRxData = data;
+  _fifoRxSize = len;
+  _fifoLen = 0;
+  _fifoPos = 0;
+  _fifoHeaderLen = _unlimited ? 2 : 0;
+  _fifoCrcOk = false;
+  _fifoRxActive = true;
+  return(state);
+}
+
+bool Si443x::serviceFifo() {
+  // reading interrupt status clears it, so the flags are kept for getEvents
+  uint8_t flags = 0;
+  if(!Module::digitalRead(_mod->getIrq())) {
+    flags = _mod->SPIreadRegister(SI443X_REG_INTERRUPT_STATUS_1);
+    _irqFlags |= flags;
+  }
+
+  if(_fifoTxActive) {
+    // unlimited length packet ends once Tx FIFO is empty, nothing more can be sent after that
+    if(flags & SI443X_PACKET_SENT_INTERRUPT) {
+      _fifoTx.clear();
+      _fifoTxActive = false;
+
+    } else if((_fifoPos < _fifoLen) && (flags & SI443X_TX_FIFO_ALMOST_EMPTY_INTERRUPT)) {
+      // at most the threshold is left in FIFO, one byte is kept free in case another one was sent in the meantime
+      writeFifo(SI443X_FIFO_SIZE - SI443X_FIFO_THRESHOLD - 1);
+    }
+
+  } else if(_fifoRxActive) {
+    // almost full means at least the threshold is in FIFO
+    if(flags & SI443X_RX_FIFO_ALMOST_FULL_INTERRUPT) {
+      drainFifo(SI443X_FIFO_THRESHOLD);
+    }
+
+    if(_unlimited) {
+      // the chip would keep receiving after the end of unlimited length packet, padding is drained together with its last chunk
+      if((_fifoHeaderLen == 0) && (_fifoPos >= _fifoLen)) {
+        standby();
+        _fifoCrcOk = true;
+        _fifoRxActive = false;
+        _irqFlags |= SI443X_VALID_PACKET_RECEIVED_INTERRUPT;
+      }
+
+    } else if(flags & (SI443X_VALID_PACKET_RECEIVED_INTERRUPT | SI443X_CRC_ERROR_INTERRUPT)) {
+      // the rest of the packet is below the threshold
+      _fifoLen = _mod->SPIreadRegister(SI443X_REG_RECEIVED_PACKET_LENGTH);
+      if(_fifoLen > _fifoPos) {
+        drainFifo(_fifoLen - _fifoPos);
+      }
+      _fifoCrcOk = !(flags & SI443X_CRC_ERROR_INTERRUPT);
+      _fifoRxActive = false;
+    }
+  }
+
+  return(!_fifoTxActive && !_fifoRxActive);
+}
+
+void Si443x::setFifoAction(void (*func)(void)) {
+  setIrqAction(func);
+}
+
 int16_t Si443x::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
+  // streamed packet is already in the stream buffer, its end may not have been serviced yet
+  if(_fifoRxData != NULL) {
+    if(_fifoRxActive) {
+      serviceFifo();
+    }
+
+    // packet that was not received completely is dropped
+    bool complete = !_fifoRxActive;
+    size_t length = len;
+    if((len == 0) || (len > _fifoLen)) {
+      length = _fifoLen;
+    }
+    if(length > _fifoRxSize) {
+      length = _fifoRxSize;
+    }
+    if(complete && (data != _fifoRxData)) {
+      memcpy(data, _fifoRxData, length);
+    }
+    _packetLength = _fifoLen;
+    _packetLengthQueried = true;
+    _fifoRxData = NULL;
+    _fifoRxActive = false;
+
+    // set mode to standby
+    int16_t state = standby();
+    RADIOLIB_ASSERT(state);
+
+    // clear interrupt flags
+    clearIRQFlags();
+    if(!complete) {
+      return(ERR_RX_TIMEOUT);
+    }
+    if(!_fifoCrcOk) {
+      return(ERR_CRC_MISMATCH);
+    }
+
+    // the rest of packet longer than the stream buffer was dropped while draining
+    return((_fifoLen > _fifoRxSize) ? ERR_PACKET_TOO_LONG : ERR_NONE);
+  }
+
   // clear interrupt flags
   clearIRQFlags();
 
@@ -461,7 +695,13 @@ int16_t Si443x::setSyncWord(uint8_t* syncWord, size_t len) {
 }
 
 size_t Si443x::getPacketLength(bool update) {
-  // TODO variable length mode
+  // length of streamed packet is only known to the driver
+  if(_fifoRxData != NULL) {
+    return(_fifoLen);
+  } else if(_unlimited) {
+    return(_packetLength);
+  }
+
   if(!_packetLengthQueried && update) {
     _packetLength = _mod->SPIreadRegister(SI443X_REG_RECEIVED_PACKET_LENGTH);
     _packetLengthQueried = true;
@@ -504,6 +744,30 @@ int16_t Si443x::setDataShaping(float sh) {
   }
 }
 
+int16_t Si443x::variablePacketLengthMode() {
+  // enable packet handler in both directions
+  int16_t state = _mod->SPIsetRegValue(SI443X_REG_DATA_ACCESS_CONTROL, SI443X_PACKET_RX_HANDLING_ON, 7, 7);
+  state |= _mod->SPIsetRegValue(SI443X_REG_DATA_ACCESS_CONTROL, SI443X_PACKET_TX_HANDLING_ON, 3, 3);
+  RADIOLIB_ASSERT(state);
+
+  // length is sent in the packet
+  state = _mod->SPIsetRegValue(SI443X_REG_HEADER_CONTROL_2, SI443X_FIXED_PACKET_LENGTH_OFF, 3, 3);
+  RADIOLIB_ASSERT(state);
+
+  _unlimited = false;
+  return(state);
+}
+
+int16_t Si443x::unlimitedPacketLengthMode() {
+  // disable packet handler, length header and padding are handled by serviceFifo
+  int16_t state = _mod->SPIsetRegValue(SI443X_REG_DATA_ACCESS_CONTROL, SI443X_PACKET_RX_HANDLING_OFF, 7, 7);
+  state |= _mod->SPIsetRegValue(SI443X_REG_DATA_ACCESS_CONTROL, SI443X_PACKET_TX_HANDLING_OFF, 3, 3);
+  RADIOLIB_ASSERT(state);
+
+  _unlimited = true;
+  return(state);
+}
+
 int16_t Si443x::setFrequencyRaw(float newFreq) {
   // set mode to standby
   int16_t state = standby();
@@ -551,7 +815,7 @@ bool Si443x::findChip() {
         RADIOLIB_DEBUG_PRINT(F(", expected 0x00"));
         RADIOLIB_DEBUG_PRINTLN(SI443X_DEVICE_VERSION, HEX);
       #endif
-      delay(1000);
+      Module::delay(1000);
       i++;
     }
   }
@@ -581,6 +845,11 @@ int16_t Si443x::config() {
   state = _mod->SPIsetRegValue(SI443X_REG_HEADER_CONTROL_1, SI443X_BROADCAST_ADDR_CHECK_NONE | SI443X_RECEIVED_HEADER_CHECK_NONE);
   RADIOLIB_ASSERT(state);
 
+  // set FIFO thresholds to half of FIFO, so that packets longer than it are streamed in chunks of about the same size as the remaining margin
+  state = _mod->SPIsetRegValue(SI443X_REG_TX_FIFO_CONTROL_2, SI443X_FIFO_THRESHOLD, 5, 0);
+  state |= _mod->SPIsetRegValue(SI443X_REG_RX_FIFO_CONTROL, SI443X_FIFO_THRESHOLD, 5, 0);
+  RADIOLIB_ASSERT(state);
+
   return(state);
 }
 
@@ -667,3 +936,66 @@ int16_t Si443x::directMode() {
   state = _mod->SPIsetRegValue(SI443X_REG_MODULATION_MODE_CONTROL_2, SI443X_MODULATION_NONE, 1, 0);
   return(state);
 }
+
+void Si443x::writeFifo(size_t count) {
+  size_t len = 0;
+  uint8_t* data = _fifoTx.next(count, &len);
+  while(data != NULL) {
+    _mod->SPIwriteRegisterBurst(SI443X_REG_FIFO_ACCESS, data, len);
+    count -= len;
+    _fifoPos += len;
+    data = _fifoTx.next(count, &len);
+  }
+
+  // unlimited length packet is padded, so the receiver can always drain whole chunks
+  size_t pad = _fifoLen - _fifoPos;
+  if(pad > count) {
+    pad = count;
+  }
+  if(pad > 0) {
+    uint8_t zeros[SI443X_FIFO_THRESHOLD];
+    memset(zeros, 0x00, pad);
+    _mod->SPIwriteRegisterBurst(SI443X_REG_FIFO_ACCESS, zeros, pad);
+    _fifoPos += pad;
+  }
+  if(_fifoPos < _fifoLen) {
+    return;
+  }
+
+  // everything is in FIFO, only packet sent is left
+  _mod->SPIwriteRegister(SI443X_REG_INTERRUPT_ENABLE_1, SI443X_PACKET_SENT_ENABLED);
+}
+
+void Si443x::drainFifo(size_t count) {
+  // unlimited length packet starts with its length
+  if(_fifoHeaderLen > 0) {
+    uint8_t header[2];
+    _mod->SPIreadRegisterBurst(SI443X_REG_FIFO_ACCESS, _fifoHeaderLen, header);
+    _fifoLen = ((size_t)header[0] << 8) | header[1];
+    count -= _fifoHeaderLen;
+    _fifoHeaderLen = 0;
+  }
+
+  // bytes that do not fit into the buffer are dumped, so is the padding of unlimited length packet
+  size_t size = _fifoRxSize;
+  if(_unlimited && (_fifoLen < size)) {
+    size = _fifoLen;
+  }
+  size_t len = 0;
+  if(_fifoPos < size) {
+    len = size - _fifoPos;
+    if(len > count) {
+      len = count;
+    }
+    _mod->SPIreadRegisterBurst(SI443X_REG_FIFO_ACCESS, len, &_fifoRxData[_fifoPos]);
+  }
+  uint8_t dump[SI443X_FIFO_THRESHOLD];
+  for(size_t i = len; i < count; i += sizeof(dump)) {
+    size_t num = count - i;
+    if(num > sizeof(dump)) {
+      num = sizeof(dump);
+    }
+    _mod->SPIreadRegisterBurst(SI443X_REG_FIFO_ACCESS, num, dump);
+  }
+  _fifoPos += count;
+}
@@ -9,6 +9,10 @@
 // Si443x physical layer properties
 #define SI443X_FREQUENCY_STEP_SIZE                    156.25
 #define SI443X_MAX_PACKET_LENGTH                      64
+#define SI443X_MAX_PACKET_LENGTH_VARIABLE             255
+#define SI443X_MAX_PACKET_LENGTH_UNLIMITED            65535
+#define SI443X_FIFO_SIZE                              64
+#define SI443X_FIFO_THRESHOLD                         32
 
 // Si443x series common registers
 #define SI443X_REG_DEVICE_TYPE                        0x00
@@ -537,11 +541,25 @@
 #define SI443X_TX_FIFO_ALMOST_FULL_THRESHOLD          0x37        //  5     0    Tx FIFO almost full threshold
 
 // SI443X_REG_TX_FIFO_CONTROL_2
-#define SI443X_TX_FIFO_ALMOST_EMPTY_THRESHOLD         0x04        //  5     0    Tx FIFO almost full threshold
+#define SI443X_TX_FIFO_ALMOST_EMPTY_THRESHOLD         0x04        //  5     0    Tx FIFO almost empty threshold
 
 // SI443X_REG_RX_FIFO_CONTROL
 #define SI443X_RX_FIFO_ALMOST_FULL_THRESHOLD          0x37        //  5     0    Rx FIFO almost full threshold
 
+// Si443x registers that are never served from register cache
+static const uint8_t Si443xVolatileRegs[] PROGMEM = {
+  SI443X_REG_DEVICE_STATUS, SI443X_REG_INTERRUPT_STATUS_1, SI443X_REG_INTERRUPT_STATUS_2, SI443X_REG_OP_FUNC_CONTROL_1,
+  SI443X_REG_OP_FUNC_CONTROL_2, SI443X_REG_ADC_CONFIG, SI443X_REG_ADC_VALUE, SI443X_REG_WAKEUP_TIMER_VALUE_1,
+  SI443X_REG_WAKEUP_TIMER_VALUE_2, SI443X_REG_BATT_VOLTAGE_LEVEL, SI443X_REG_RSSI, SI443X_REG_AFC_CORRECTION,
+  SI443X_REG_EZMAC_STATUS, SI443X_REG_RECEIVED_HEADER_3, SI443X_REG_RECEIVED_HEADER_2, SI443X_REG_RECEIVED_HEADER_1,
+  SI443X_REG_RECEIVED_HEADER_0, SI443X_REG_RECEIVED_PACKET_LENGTH, SI443X_REG_FIFO_ACCESS
+};
+
+// Si443x registers that need some time to process the change after being written
+static const uint8_t Si443xSlowRegs[] PROGMEM = {
+  SI443X_REG_OP_FUNC_CONTROL_1
+};
+
 /*!
   \class Si443x
 
@@ -586,7 +604,7 @@ class Si443x: public PhysicalLayer {
     void reset();
 
     /*!
-      \brief Binary transmit method. Will transmit arbitrary binary data up to 64 bytes long.
+      \brief Binary transmit method. Will transmit arbitrary binary data up to 255 bytes long (65535 bytes in unlimited packet length mode).
       For overloads to transmit Arduino String or C-string, see PhysicalLayer::transmit.
 
       \param data Binary data that will be transmitted.
@@ -600,7 +618,21 @@ class Si443x: public PhysicalLayer {
     int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
     /*!
-      \brief Binary receive method. Will attempt to receive arbitrary binary data up to 64 bytes long.
+      \brief Blocking scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Node address to transmit the packet to.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Binary receive method. Will attempt to receive arbitrary binary data up to 255 bytes long (65535 bytes in unlimited packet length mode).
+      Packets longer than FIFO are drained from it while they are being received.
       For overloads to receive Arduino String, see PhysicalLayer::receive.
 
       \param data Pointer to array to save the received binary data.
@@ -664,7 +696,26 @@ class Si443x: public PhysicalLayer {
     void clearIrqAction();
 
     /*!
-      \brief Interrupt-driven binary transmit method. Will start transmitting arbitrary binary data up to 64 bytes long.
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is nIRQ.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
+    /*!
+      \brief Interrupt-driven binary transmit method. Will start transmitting arbitrary binary data up to 255 bytes long (65535 bytes in unlimited packet length mode).
+      Packets longer than FIFO are streamed through it, see Si443x::serviceFifo. The data must then stay valid until the transmission is finished.
 
       \param data Binary data that will be transmitted.
 
@@ -677,14 +728,69 @@ class Si443x: public PhysicalLayer {
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0);
 
     /*!
-      \brief Interrupt-driven receive method. IRQ will be activated when full valid packet is received.
+      \brief Interrupt-driven scatter-gather transmit method. Segments are burst-written to FIFO one after another.
+      Packets longer than FIFO are streamed through it, see Si443x::serviceFifo. Segment descriptors are copied (see TxSegmentStream), the data they point to must then stay valid until the transmission is finished.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments, at most RADIOLIB_TX_SEGMENTS_MAX.
+
+      \param addr Node address to transmit the packet to.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - sets module to standby and clears IRQ flags.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
+    /*!
+      \brief Interrupt-driven receive method. IRQ will be activated when full valid packet is received. Only packets that fit into FIFO
+      can be received this way, use startReceiveStream for longer ones.
 
       \returns \ref status_codes
     */
     int16_t startReceive();
 
+    /*!
+      \brief Interrupt-driven receive method for packets longer than FIFO. Received bytes are drained from FIFO into the buffer
+      by Si443x::serviceFifo while the packet is being received. In unlimited packet length mode, the chip does not know where the packet ends,
+      reception stops once all bytes announced in the length header were received.
+
+      \param data Buffer to save the received packet to, must stay valid until the packet is read. Bytes that do not fit into it are dropped,
+      readData then returns ERR_PACKET_TOO_LONG.
+
+      \param len Size of the buffer.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceiveStream(uint8_t* data, size_t len);
+
+    /*!
+      \brief Services FIFO of packets longer than it: refills Tx FIFO once it drops to the almost empty threshold during transmission started by startTransmit,
+      or drains Rx FIFO once it reaches the almost full threshold during reception started by startReceiveStream. Interrupt status is cleared by reading it,
+      so the flags are kept for getEvents. Must be called on every falling edge of nIRQ, either from interrupt service routine set by setFifoAction
+      or by polling it often enough, but not from both. Blocking transmit and receive methods call it on their own.
+
+      \returns True when there is nothing left to do (the whole packet was sent or received), false otherwise.
+    */
+    bool serviceFifo();
+
+    /*!
+      \brief Sets interrupt service routine to call when nIRQ activates during transmission or reception of packets longer than FIFO.
+      The function should call Si443x::serviceFifo. Same as setIrqAction, since the chip only has a single interrupt output.
+
+      \param func ISR to call.
+    */
+    void setFifoAction(void (*func)(void));
+
     /*!
       \brief Reads data that was received after calling startReceive method. This method reads len characters.
+      When the packet was received by startReceiveStream, it is already in the stream buffer and is only copied to data, if it is a different buffer.
 
       \param data Pointer to array to save the received binary data.
 
@@ -760,6 +866,23 @@ class Si443x: public PhysicalLayer {
     */
     int16_t setDataShaping(float sh);
 
+    /*!
+      \brief Set modem in variable packet length mode (default). Packet length is sent by the packet handler, packets of up to SI443X_MAX_PACKET_LENGTH_VARIABLE bytes
+      are supported, packets longer than FIFO are streamed through it by Si443x::serviceFifo.
+
+      \returns \ref status_codes
+    */
+    int16_t variablePacketLengthMode();
+
+    /*!
+      \brief Set modem in unlimited packet length mode, for continuous streams. Packet handler is disabled, only preamble and sync word are sent by the chip,
+      the rest is streamed through FIFO by Si443x::serviceFifo. Packet length is sent in 2-byte header and the packet is padded to the whole number of FIFO thresholds.
+      Packets of up to SI443X_MAX_PACKET_LENGTH_UNLIMITED bytes are supported. The chip does not check CRC of unlimited length packets.
+
+      \returns \ref status_codes
+    */
+    int16_t unlimitedPacketLengthMode();
+
 #ifndef RADIOLIB_GODMODE
   protected:
 #endif
@@ -770,6 +893,21 @@ class Si443x: public PhysicalLayer {
 
     size_t _packetLength;
     bool _packetLengthQueried;
+    bool _unlimited;
+
+    // packets longer than FIFO are streamed through it by serviceFifo
+    TxSegmentStream _fifoTx;
+    bool _fifoTxActive;
+    uint8_t* _fifoRxData;
+    size_t _fifoRxSize;
+    size_t _fifoLen;
+    size_t _fifoPos;
+    uint8_t _fifoHeaderLen;
+    bool _fifoRxActive;
+    bool _fifoCrcOk;
+
+    // interrupt flags read by serviceFifo, until they are reported by getEvents
+    uint8_t _irqFlags;
 
     int16_t setFrequencyRaw(float newFreq);
 
@@ -781,6 +919,8 @@ class Si443x: public PhysicalLayer {
     int16_t config();
     int16_t updateClockRecovery();
     int16_t directMode();
+    void writeFifo(size_t count);
+    void drainFifo(size_t count);
 };
 
 #endif
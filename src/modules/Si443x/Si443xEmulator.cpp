@@ -0,0 +1,550 @@
+#include "Si443xEmulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+Si443xEmulator::Si443xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE sdn) : EmulatedChip(cs) {
+  _irq = irq;
+  _sdn = sdn;
+  _shutdown = false;
+  _txActive = false;
+  _rssi = SI443X_EMULATOR_RSSI_DEFAULT;
+  reset();
+}
+
+void Si443xEmulator::reset() {
+  abortTx();
+  memset(_regs, 0x00, sizeof(_regs));
+
+  _regs[SI443X_REG_DEVICE_TYPE] = SI443X_DEVICE_TYPE;
+  _regs[SI443X_REG_DEVICE_VERSION] = SI443X_DEVICE_VERSION;
+  _regs[SI443X_REG_INTERRUPT_ENABLE_2] = SI443X_CHIP_READY_ENABLED | SI443X_POWER_ON_RESET_ENABLED;
+  _regs[SI443X_REG_OP_FUNC_CONTROL_1] = SI443X_XTAL_ON;
+  _regs[SI443X_REG_DATA_ACCESS_CONTROL] = SI443X_PACKET_RX_HANDLING_ON | SI443X_PACKET_TX_HANDLING_ON | SI443X_CRC_ON | SI443X_CRC_IBM_CRC16;
+  _regs[SI443X_REG_HEADER_CONTROL_1] = SI443X_RECEIVED_HEADER_CHECK_BYTE2 | SI443X_RECEIVED_HEADER_CHECK_BYTE3;
+  _regs[SI443X_REG_HEADER_CONTROL_2] = SI443X_HEADER_LENGTH_HEADER_32 | SI443X_SYNC_LENGTH_SYNC_32;
+  _regs[SI443X_REG_PREAMBLE_LENGTH] = SI443X_PREAMBLE_LENGTH_LSB;
+  _regs[SI443X_REG_PREAMBLE_DET_CONTROL] = SI443X_PREAMBLE_DET_THRESHOLD | SI443X_RSSI_OFFSET;
+  _regs[SI443X_REG_SYNC_WORD_3] = SI443X_SYNC_WORD_3;
+  _regs[SI443X_REG_SYNC_WORD_2] = SI443X_SYNC_WORD_2;
+  _regs[SI443X_REG_TX_DATA_RATE_1] = SI443X_DATA_RATE_MSB;
+  _regs[SI443X_REG_TX_DATA_RATE_0] = SI443X_DATA_RATE_LSB;
+  _regs[SI443X_REG_MODULATION_MODE_CONTROL_1] = SI443X_MANCHESTER_PREAMBLE_POL_HIGH | SI443X_MANCHESTER_INVERTED_ON;
+  _regs[SI443X_REG_FREQUENCY_DEVIATION] = SI443X_FREQUENCY_DEVIATION_LSB;
+  _regs[SI443X_REG_FREQUENCY_BAND_SELECT] = SI443X_SIDE_BAND_SELECT_HIGH | SI443X_BAND_SELECT_HIGH | SI443X_FREQUENCY_BAND_SELECT;
+  _regs[SI443X_REG_NOM_CARRIER_FREQUENCY_1] = SI443X_NOM_CARRIER_FREQUENCY_MSB;
+  _regs[SI443X_REG_NOM_CARRIER_FREQUENCY_0] = SI443X_NOM_CARRIER_FREQUENCY_LSB;
+  _regs[SI443X_REG_TX_FIFO_CONTROL_1] = SI443X_TX_FIFO_ALMOST_FULL_THRESHOLD;
+  _regs[SI443X_REG_TX_FIFO_CONTROL_2] = SI443X_TX_FIFO_ALMOST_EMPTY_THRESHOLD;
+  _regs[SI443X_REG_RX_FIFO_CONTROL] = SI443X_RX_FIFO_ALMOST_FULL_THRESHOLD;
+
+  // power-on reset and chip ready are signalled right away
+  _status1 = 0;
+  _status2 = SI443X_CHIP_READY_INTERRUPT | SI443X_POWER_ON_RESET_INTERRUPT;
+  _txHead = 0;
+  _txCount = 0;
+  _rxHead = 0;
+  _rxCount = 0;
+  _eventTime = UINT64_MAX;
+  _airSrc = NULL;
+  _airRx = false;
+  _txActive = false;
+  _txCrc = false;
+  _txSent = 0;
+  _txLen = 0;
+  _rxReceived = 0;
+  _rxLen = 0;
+  _rxComplete = false;
+  _txPackets = 0;
+  _rxPackets = 0;
+  _txUnderflows = 0;
+  _rxOverflows = 0;
+}
+
+bool Si443xEmulator::injectPacket(const uint8_t* data, size_t len, bool crcError) {
+  if((getMode() != SI443X_RX_ON) || _airRx) {
+    return(false);
+  }
+
+  // add length byte in variable length mode
+  _airRx = true;
+  _rxReceived = 0;
+  _rxLen = _regs[SI443X_REG_TRANSMIT_PACKET_LENGTH];
+  _rxComplete = false;
+  _status2 |= SI443X_VALID_PREAMBLE_DETECTED_INTERRUPT | SI443X_SYNC_WORD_DETECTED_INTERRUPT;
+  bool handler = isPacketHandlerOn(false);
+  if(handler && isVariable()) {
+    rxByte((uint8_t)len);
+  }
+  for(size_t i = 0; i < len; i++) {
+    rxByte(data[i]);
+  }
+  if(_airRx) {
+    if(handler && _rxComplete) {
+      rxDone(!crcError);
+    } else {
+      abortRx();
+    }
+  }
+  return(true);
+}
+
+void Si443xEmulator::setSignal(int16_t rssi) {
+  _rssi = rssi;
+}
+
+uint64_t Si443xEmulator::getTimeOnAir(size_t len) {
+  // preamble, sync word, header, length byte, payload and CRC (packet handler disabled sends none of the last three)
+  size_t bytes = getHeaderLength() + len;
+  if(isPacketHandlerOn(true) && (_regs[SI443X_REG_DATA_ACCESS_CONTROL] & SI443X_CRC_ON)) {
+    bytes += 2;
+  }
+  return((uint64_t)bytes * getByteTime());
+}
+
+uint8_t Si443xEmulator::getRegister(uint8_t addr) {
+  addr &= 0x7F;
+  switch(addr) {
+    case SI443X_REG_INTERRUPT_STATUS_1:
+      return(_status1);
+    case SI443X_REG_INTERRUPT_STATUS_2:
+      return(_status2);
+    case SI443X_REG_FIFO_ACCESS:
+      return((_rxCount > 0) ? _rxFifo[_rxHead] : 0x00);
+  }
+  return(readRegister(addr));
+}
+
+void Si443xEmulator::spiTransfer(uint8_t* buff, size_t len) {
+  if(len < 1) {
+    return;
+  }
+
+  // SPI is not available in shutdown
+  if(_shutdown) {
+    memset(buff, 0x00, len);
+    return;
+  }
+
+  // address is incremented in burst mode, except for FIFO
+  bool write = buff[0] & 0x80;
+  uint8_t addr = buff[0] & 0x7F;
+  buff[0] = 0x00;
+  for(size_t i = 1; i < len; i++) {
+    if(write) {
+      writeRegister(addr, buff[i]);
+    } else if(addr == SI443X_REG_INTERRUPT_STATUS_1) {
+      buff[i] = _status1;
+      _status1 = 0;
+    } else if(addr == SI443X_REG_INTERRUPT_STATUS_2) {
+      buff[i] = _status2;
+      _status2 = 0;
+    } else if(addr == SI443X_REG_FIFO_ACCESS) {
+      buff[i] = rxFifoRead();
+    } else {
+      buff[i] = readRegister(addr);
+    }
+
+    if(addr != SI443X_REG_FIFO_ACCESS) {
+      addr = (addr + 1) & 0x7F;
+    }
+  }
+}
+
+bool Si443xEmulator::readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+  if((pin == RADIOLIB_NC) || (pin != _irq)) {
+    return(false);
+  }
+
+  // nIRQ is active low while any enabled interrupt is pending
+  bool active = !_shutdown && ((_status1 & _regs[SI443X_REG_INTERRUPT_ENABLE_1]) || (_status2 & _regs[SI443X_REG_INTERRUPT_ENABLE_2]));
+  *value = active ? LOW : HIGH;
+  return(true);
+}
+
+void Si443xEmulator::writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  if((pin == RADIOLIB_NC) || (pin != _sdn)) {
+    return;
+  }
+
+  // SDN is active high, all registers are lost in shutdown
+  if(value == HIGH) {
+    reset();
+    _shutdown = true;
+  } else if(_shutdown) {
+    _shutdown = false;
+    reset();
+  }
+}
+
+void Si443xEmulator::update(uint64_t now) {
+  // events are bytes leaving Tx FIFO
+  while(_eventTime <= now) {
+    txByte();
+  }
+}
+
+void Si443xEmulator::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  // chip that is transmitting cannot hear anything
+  if(_txActive || (_airSrc != NULL) || !EmulatorHal::airMatch(air, getAir())) {
+    return;
+  }
+
+  // packet can only be received if the chip was already listening when it started
+  _airSrc = src;
+  _airRx = (getMode() == SI443X_RX_ON);
+  if(_airRx) {
+    _rxReceived = 0;
+    _rxLen = _regs[SI443X_REG_TRANSMIT_PACKET_LENGTH];
+    _rxComplete = false;
+    _status2 |= SI443X_VALID_PREAMBLE_DETECTED_INTERRUPT | SI443X_SYNC_WORD_DETECTED_INTERRUPT;
+  }
+}
+
+void Si443xEmulator::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  if((src != _airSrc) || !_airRx || (getMode() != SI443X_RX_ON)) {
+    return;
+  }
+
+  for(size_t i = 0; (i < len) && _airRx; i++) {
+    rxByte(data[i]);
+  }
+}
+
+void Si443xEmulator::airEnd(EmulatedChip* src, bool crcOk) {
+  if(src != _airSrc) {
+    return;
+  }
+  _airSrc = NULL;
+
+  if(_airRx && (getMode() == SI443X_RX_ON)) {
+    if(isPacketHandlerOn(false) && _rxComplete) {
+      rxDone(crcOk);
+    } else {
+      // without packet handler, the chip does not know where the packet ends and keeps searching for sync word
+      abortRx();
+    }
+  }
+}
+
+bool Si443xEmulator::isPacketHandlerOn(bool tx) {
+  return(_regs[SI443X_REG_DATA_ACCESS_CONTROL] & (tx ? SI443X_PACKET_TX_HANDLING_ON : SI443X_PACKET_RX_HANDLING_ON));
+}
+
+bool Si443xEmulator::isVariable() {
+  return(!(_regs[SI443X_REG_HEADER_CONTROL_2] & SI443X_FIXED_PACKET_LENGTH_ON));
+}
+
+uint8_t Si443xEmulator::readRegister(uint8_t addr) {
+  switch(addr) {
+    case SI443X_REG_DEVICE_STATUS: {
+      // chip power state is 1 in Rx and 2 in Tx
+      uint8_t status = (_rxCount == 0) ? SI443X_RX_FIFO_EMPTY : 0x00;
+      if(_txActive) {
+        status |= 0x02;
+      } else if(getMode() == SI443X_RX_ON) {
+        status |= 0x01;
+      }
+      return(status);
+    }
+
+    case SI443X_REG_EZMAC_STATUS: {
+      uint8_t status = 0x00;
+      if(_txActive) {
+        status |= SI443X_PACKET_TRANSMITTING;
+      } else if(_airRx) {
+        status |= SI443X_PACKET_RECEIVING;
+      } else if(getMode() == SI443X_RX_ON) {
+        status |= SI443X_PACKET_SEARCHING;
+      }
+      return(status);
+    }
+
+    case SI443X_REG_RSSI:
+      // RSSI is in 0.5 dB steps with 120 dB offset
+      return((uint8_t)(2 * (_rssi + 120)));
+  }
+
+  return(_regs[addr & 0x7F]);
+}
+
+void Si443xEmulator::writeRegister(uint8_t addr, uint8_t value) {
+  switch(addr) {
+    case SI443X_REG_DEVICE_TYPE:
+    case SI443X_REG_DEVICE_VERSION:
+    case SI443X_REG_DEVICE_STATUS:
+    case SI443X_REG_INTERRUPT_STATUS_1:
+    case SI443X_REG_INTERRUPT_STATUS_2:
+    case SI443X_REG_RSSI:
+    case SI443X_REG_EZMAC_STATUS:
+    case SI443X_REG_RECEIVED_PACKET_LENGTH:
+      // read-only
+      return;
+
+    case SI443X_REG_OP_FUNC_CONTROL_1:
+      if(value & SI443X_SOFTWARE_RESET) {
+        reset();
+        return;
+      }
+      _regs[addr] = value;
+      enterMode(getMode());
+      return;
+
+    case SI443X_REG_OP_FUNC_CONTROL_2:
+      _regs[addr] = value;
+      if(value & SI443X_RX_FIFO_RESET) {
+        _rxHead = 0;
+        _rxCount = 0;
+      }
+      if(value & SI443X_TX_FIFO_RESET) {
+        _txHead = 0;
+        _txCount = 0;
+      }
+      return;
+
+    case SI443X_REG_FIFO_ACCESS:
+      // real chip would overflow once the FIFO is overwritten, extra bytes are dropped instead
+      if(_txCount == SI443X_FIFO_SIZE) {
+        _status1 |= SI443X_FIFO_LEVEL_ERROR_INTERRUPT;
+        return;
+      }
+      _txFifo[(_txHead + _txCount) % SI443X_FIFO_SIZE] = value;
+      _txCount++;
+      if(_txCount == (_regs[SI443X_REG_TX_FIFO_CONTROL_1] & 0x3F) + 1) {
+        _status1 |= SI443X_TX_FIFO_ALMOST_FULL_INTERRUPT;
+      }
+      return;
+  }
+
+  _regs[addr] = value;
+}
+
+void Si443xEmulator::enterMode(uint8_t mode) {
+  // Tx takes precedence when both are enabled
+  if(mode & SI443X_TX_ON) {
+    if(!_txActive) {
+      txStart();
+    }
+    return;
+  }
+
+  // leaving Tx aborts transmission, leaving Rx stops reception
+  abortTx();
+  if(!(mode & SI443X_RX_ON) && _airRx) {
+    abortRx();
+  }
+}
+
+void Si443xEmulator::abortTx() {
+  _eventTime = UINT64_MAX;
+  if(!_txActive) {
+    return;
+  }
+
+  // receivers only get incomplete packet
+  _txActive = false;
+  _txCrc = false;
+  EmulatorHal::airEnd(this, false);
+}
+
+void Si443xEmulator::abortRx() {
+  _airRx = false;
+  _rxReceived = 0;
+  _rxComplete = false;
+}
+
+EmulatorAir_t Si443xEmulator::getAir() {
+  // Fc = 10 MHz * (hbsel + 1) * (fb + 24 + fc / 64000)
+  uint64_t hbsel = (_regs[SI443X_REG_FREQUENCY_BAND_SELECT] & SI443X_BAND_SELECT_HIGH) ? 2 : 1;
+  uint64_t fb = _regs[SI443X_REG_FREQUENCY_BAND_SELECT] & 0x1F;
+  uint64_t fc = ((uint16_t)_regs[SI443X_REG_NOM_CARRIER_FREQUENCY_1] << 8) | _regs[SI443X_REG_NOM_CARRIER_FREQUENCY_0];
+  EmulatorAir_t air;
+  air.freq = (uint32_t)(hbsel * (10000000ULL * (fb + 24) + (10000000ULL * fc) / 64000));
+  air.modem = RADIOLIB_EMULATOR_MODEM_FSK;
+  air.sf = 0;
+  air.rate = 8000000000ULL / getByteTime();
+  return(air);
+}
+
+uint64_t Si443xEmulator::getByteTime() {
+  // data rate is 10^6 * TXDR / 2^16 in high data rate mode, 10^6 * TXDR / 2^21 in low data rate mode
+  uint64_t txdr = ((uint16_t)_regs[SI443X_REG_TX_DATA_RATE_1] << 8) | _regs[SI443X_REG_TX_DATA_RATE_0];
+  if(txdr == 0) {
+    txdr = 1;
+  }
+  uint8_t exp = (_regs[SI443X_REG_MODULATION_MODE_CONTROL_1] & SI443X_LOW_DATA_RATE_MODE) ? 21 : 16;
+  uint64_t byteTime = (8000ULL << exp) / txdr;
+
+  // Manchester encoding doubles the number of symbols
+  if(_regs[SI443X_REG_MODULATION_MODE_CONTROL_1] & SI443X_MANCHESTER_ON) {
+    byteTime *= 2;
+  }
+  return(byteTime);
+}
+
+size_t Si443xEmulator::getHeaderLength() {
+  // preamble length is in nibbles
+  size_t nibbles = ((size_t)(_regs[SI443X_REG_HEADER_CONTROL_2] & 0x01) << 8) | _regs[SI443X_REG_PREAMBLE_LENGTH];
+  size_t bytes = nibbles / 2;
+  bytes += ((_regs[SI443X_REG_HEADER_CONTROL_2] >> 1) & 0x03) + 1;
+
+  // header bytes and length byte are only sent by packet handler, header contents are not emulated
+  if(isPacketHandlerOn(true)) {
+    bytes += (_regs[SI443X_REG_HEADER_CONTROL_2] >> 4) & 0x07;
+    if(isVariable()) {
+      bytes++;
+    }
+  }
+  return(bytes);
+}
+
+uint8_t Si443xEmulator::rxFifoRead() {
+  if(_rxCount == 0) {
+    _status1 |= SI443X_FIFO_LEVEL_ERROR_INTERRUPT;
+    return(0x00);
+  }
+
+  uint8_t b = _rxFifo[_rxHead];
+  _rxHead = (_rxHead + 1) % SI443X_FIFO_SIZE;
+  _rxCount--;
+  return(b);
+}
+
+bool Si443xEmulator::rxFifoWrite(uint8_t b) {
+  if(_rxCount == SI443X_FIFO_SIZE) {
+    // the rest of the packet is lost
+    _rxOverflows++;
+    _status1 |= SI443X_FIFO_LEVEL_ERROR_INTERRUPT;
+    abortRx();
+    return(false);
+  }
+  _rxFifo[(_rxHead + _rxCount) % SI443X_FIFO_SIZE] = b;
+  _rxCount++;
+
+  // almost full is signalled once the level reaches the threshold
+  if(_rxCount == (_regs[SI443X_REG_RX_FIFO_CONTROL] & 0x3F)) {
+    _status1 |= SI443X_RX_FIFO_ALMOST_FULL_INTERRUPT;
+  }
+  return(true);
+}
+
+void Si443xEmulator::txStart() {
+  // first byte leaves the FIFO after preamble, sync word, header and length byte
+  _txActive = true;
+  _txSent = 0;
+  _txLen = _regs[SI443X_REG_TRANSMIT_PACKET_LENGTH];
+  _txCrc = isPacketHandlerOn(true) && (_txLen == 0);
+  _eventTime = EmulatorHal::getTimeNs() + (getHeaderLength() + 1) * getByteTime();
+  EmulatorHal::airStart(this, getAir());
+}
+
+void Si443xEmulator::txByte() {
+  uint64_t eventTime = _eventTime;
+  _eventTime = UINT64_MAX;
+  if(!_txActive) {
+    return;
+  }
+
+  // length byte goes out right before the payload
+  bool handler = isPacketHandlerOn(true);
+  if(handler && isVariable() && (_txSent == 0)) {
+    uint8_t len = (uint8_t)_txLen;
+    EmulatorHal::airData(this, &len, 1);
+  }
+
+  // CRC was sent, packet is done
+  if(_txCrc) {
+    txDone();
+    return;
+  }
+
+  if(_txCount == 0) {
+    if(handler) {
+      // transmitter ran out of data before the end of the packet
+      _txUnderflows++;
+      _status1 |= SI443X_FIFO_LEVEL_ERROR_INTERRUPT;
+      abortTx();
+      _regs[SI443X_REG_OP_FUNC_CONTROL_1] &= ~SI443X_TX_ON;
+    } else {
+      // without packet handler, the packet ends once there is nothing left in FIFO
+      txDone();
+    }
+    return;
+  }
+
+  uint8_t b = _txFifo[_txHead];
+  _txHead = (_txHead + 1) % SI443X_FIFO_SIZE;
+  _txCount--;
+  _txSent++;
+  EmulatorHal::airData(this, &b, 1);
+
+  // almost empty is signalled once the level drops to the threshold
+  if(_txCount == (_regs[SI443X_REG_TX_FIFO_CONTROL_2] & 0x3F)) {
+    _status1 |= SI443X_TX_FIFO_ALMOST_EMPTY_INTERRUPT;
+  }
+
+  if(handler && (_txSent == _txLen)) {
+    _txCrc = true;
+    _eventTime = eventTime + ((_regs[SI443X_REG_DATA_ACCESS_CONTROL] & SI443X_CRC_ON) ? 2 : 0) * getByteTime();
+  } else {
+    _eventTime = eventTime + getByteTime();
+  }
+}
+
+void Si443xEmulator::txDone() {
+  _txActive = false;
+  _txCrc = false;
+  _txPackets++;
+  EmulatorHal::airEnd(this, true);
+
+  // chip returns to ready mode
+  _status1 |= SI443X_PACKET_SENT_INTERRUPT;
+  _regs[SI443X_REG_OP_FUNC_CONTROL_1] &= ~SI443X_TX_ON;
+  enterMode(getMode());
+}
+
+void Si443xEmulator::rxByte(uint8_t b) {
+  // bytes after the end of packet are CRC, which is not passed over the emulated air
+  if(_rxComplete) {
+    return;
+  }
+
+  // without packet handler, everything after sync word goes to FIFO
+  if(!isPacketHandlerOn(false)) {
+    rxFifoWrite(b);
+    return;
+  }
+
+  // length byte is not stored in FIFO
+  bool variable = isVariable();
+  if(variable && (_rxReceived == 0)) {
+    _rxReceived++;
+    _rxLen = b;
+    _regs[SI443X_REG_RECEIVED_PACKET_LENGTH] = b;
+    _rxComplete = (_rxLen == 0);
+    return;
+  }
+  if(!variable) {
+    _regs[SI443X_REG_RECEIVED_PACKET_LENGTH] = _rxLen;
+  }
+
+  if(rxFifoWrite(b)) {
+    _rxReceived++;
+    _rxComplete = (_rxReceived - (variable ? 1 : 0) == _rxLen);
+  }
+}
+
+void Si443xEmulator::rxDone(bool crcOk) {
+  abortRx();
+
+  // chip returns to ready mode, packet with wrong CRC stays in FIFO
+  bool crcOn = _regs[SI443X_REG_DATA_ACCESS_CONTROL] & SI443X_CRC_ON;
+  if(crcOk || !crcOn) {
+    _status1 |= SI443X_VALID_PACKET_RECEIVED_INTERRUPT;
+    _rxPackets++;
+  } else {
+    _status1 |= SI443X_CRC_ERROR_INTERRUPT;
+  }
+  _regs[SI443X_REG_OP_FUNC_CONTROL_1] &= ~SI443X_RX_ON;
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef _RADIOLIB_SI443X_EMULATOR_H
+#define _RADIOLIB_SI443X_EMULATOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include "../../EmulatorHal.h"
+#include "Si443x.h"
+
+// emulated signal strength of received packets
+#define SI443X_EMULATOR_RSSI_DEFAULT                  -60
+
+/*!
+  \class Si443xEmulator
+
+  \brief Register-level emulator of %Si4430, %Si4431 and %Si4432 chips, to be attached to EmulatorHal. FIFO mode is emulated, including manual Tx/Rx control,
+  interrupt status registers that are cleared by reading them with nIRQ output, separate 64-byte Tx and Rx FIFOs with almost empty/almost full thresholds
+  and time-on-air: packet bytes are taken from Tx FIFO at the configured data rate, so the FIFO can be refilled during transmission.
+
+  With packet handler enabled, variable and fixed packet length is supported, the length byte and CRC are added by the chip. Transmitter that runs out of data
+  aborts the packet and raises FIFO level error. With packet handler disabled, only preamble and sync word are added, transmission goes on for as long as there is data
+  in Tx FIFO, and received bytes keep coming into Rx FIFO until the transmitter leaves Tx mode.
+
+  Packets transmitted by one emulator are received by all other attached emulators that are in receive mode with matching configuration.
+  Single-chip tests can use injectPacket instead.
+
+  Limitations: register values are not range-checked, analog functions (RSSI measurement, ADC, temperature, battery) return fixed values,
+  crystal and PLL settling take no time, direct mode, headers and header checks, Rx multipacket, automatic transmission, wake-up timer, low duty cycle mode
+  and antenna diversity are not emulated. Frequency offset and AFC are ignored when matching transmitter and receiver.
+*/
+class Si443xEmulator: public EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param irq nIRQ pin.
+
+      \param sdn SDN (shutdown) pin. Defaults to RADIOLIB_NC.
+    */
+    Si443xEmulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE sdn = RADIOLIB_NC);
+
+    /*!
+      \brief Resets all registers to their default values and aborts any ongoing operation, same as software reset or leaving shutdown.
+    */
+    void reset();
+
+    /*!
+      \brief Emulates reception of a packet. Only accepted when the chip is in receive mode.
+
+      \param data Packet payload. With packet handler enabled in variable length mode, length byte is added automatically.
+
+      \param len Payload length in bytes.
+
+      \param crcError Whether the packet should fail CRC check.
+
+      \returns True if the packet was accepted, false otherwise.
+    */
+    bool injectPacket(const uint8_t* data, size_t len, bool crcError = false);
+
+    /*!
+      \brief Sets signal strength reported for received packets.
+
+      \param rssi RSSI in dBm.
+    */
+    void setSignal(int16_t rssi);
+
+    /*!
+      \brief Calculates time-on-air of a packet with the current configuration.
+
+      \param len Payload length in bytes.
+
+      \returns Time-on-air in ns.
+    */
+    uint64_t getTimeOnAir(size_t len);
+
+    /*!
+      \brief Reads register value without any side effects (e.g. FIFO is not advanced and interrupt status is not cleared).
+
+      \param addr Register address.
+
+      \returns Register value.
+    */
+    uint8_t getRegister(uint8_t addr);
+
+    /*!
+      \brief Gets the number of transmitted packets since reset.
+
+      \returns Number of transmitted packets.
+    */
+    uint32_t getTxPackets() const { return(_txPackets); }
+
+    /*!
+      \brief Gets the number of received packets since reset (with packet handler enabled).
+
+      \returns Number of received packets.
+    */
+    uint32_t getRxPackets() const { return(_rxPackets); }
+
+    /*!
+      \brief Gets the number of transmissions that ran out of data in Tx FIFO (with packet handler enabled).
+
+      \returns Number of Tx FIFO underflows.
+    */
+    uint32_t getTxUnderflows() const { return(_txUnderflows); }
+
+    /*!
+      \brief Gets the number of receptions that were aborted because Rx FIFO was full.
+
+      \returns Number of Rx FIFO overflows.
+    */
+    uint32_t getRxOverflows() const { return(_rxOverflows); }
+
+    // EmulatedChip methods
+
+    void spiTransfer(uint8_t* buff, size_t len);
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value);
+    void writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    void update(uint64_t now);
+    uint64_t nextEvent() { return(_eventTime); }
+    void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    void airEnd(EmulatedChip* src, bool crcOk);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    RADIOLIB_PIN_TYPE _irq, _sdn;
+    bool _shutdown;
+
+    uint8_t _regs[0x80];
+
+    // interrupt status, cleared by reading
+    uint8_t _status1, _status2;
+
+    // Tx and Rx FIFOs are separate 64 byte queues
+    uint8_t _txFifo[SI443X_FIFO_SIZE];
+    uint8_t _txHead, _txCount;
+    uint8_t _rxFifo[SI443X_FIFO_SIZE];
+    uint8_t _rxHead, _rxCount;
+
+    // pending event (byte leaving Tx FIFO)
+    uint64_t _eventTime;
+
+    // packet currently on the air
+    EmulatedChip* _airSrc;
+    bool _airRx;
+
+    // transmission state
+    bool _txActive, _txCrc;
+    size_t _txSent, _txLen;
+
+    // reception state
+    size_t _rxReceived, _rxLen;
+    bool _rxComplete;
+
+    int16_t _rssi;
+
+    uint32_t _txPackets, _rxPackets, _txUnderflows, _rxOverflows;
+
+    uint8_t getMode() { return(_regs[SI443X_REG_OP_FUNC_CONTROL_1] & (SI443X_TX_ON | SI443X_RX_ON)); }
+    bool isPacketHandlerOn(bool tx);
+    bool isVariable();
+    uint8_t readRegister(uint8_t addr);
+    void writeRegister(uint8_t addr, uint8_t value);
+    void enterMode(uint8_t mode);
+    void abortTx();
+    void abortRx();
+    EmulatorAir_t getAir();
+    uint64_t getByteTime();
+    size_t getHeaderLength();
+
+    uint8_t rxFifoRead();
+    bool rxFifoWrite(uint8_t b);
+    void txStart();
+    void txByte();
+    void txDone();
+    void rxByte(uint8_t b);
+    void rxDone(bool crcOk);
+};
+
+#endif
+
+#endif
@@ -35,7 +35,7 @@ int16_t XBee::begin(long speed) {
       RADIOLIB_DEBUG_PRINTLN(state);
       RADIOLIB_DEBUG_PRINTLN(F("Resetting ..."));
       reset();
-      delay(1000);
+      Module::delay(1000);
       _mod->ATemptyBuffer();
       i++;
     }
@@ -52,10 +52,10 @@ int16_t XBee::begin(long speed) {
 }
 
 void XBee::reset() {
-  pinMode(_mod->getRst(), OUTPUT);
-  digitalWrite(_mod->getRst(), LOW);
-  delay(1);
-  digitalWrite(_mod->getRst(), HIGH);
+  Module::pinMode(_mod->getRst(), OUTPUT);
+  Module::digitalWrite(_mod->getRst(), LOW);
+  Module::delay(1);
+  Module::digitalWrite(_mod->getRst(), HIGH);
 }
 
 int16_t XBee::transmit(uint8_t* dest, const char* payload, uint8_t radius) {
@@ -70,7 +70,10 @@ int16_t XBee::transmit(uint8_t* dest, uint8_t* destNetwork, const char* payload,
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t cmd[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* cmd = new uint8_t[dataLen];
+    uint8_t* cmd = (uint8_t*)BufferPool::alloc(dataLen);
+    if(cmd == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   memcpy(cmd, dest, 8);
   memcpy(cmd + 8, destNetwork, 2);
@@ -82,7 +85,7 @@ int16_t XBee::transmit(uint8_t* dest, uint8_t* destNetwork, const char* payload,
   uint8_t frameID = _frameID++;
   sendApiFrame(XBEE_API_FRAME_ZIGBEE_TRANSMIT_REQUEST, frameID, cmd, dataLen);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] cmd;
+    BufferPool::free(cmd);
   #endif
 
   // get response code
@@ -121,7 +124,10 @@ size_t XBee::available() {
   #ifdef RADIOLIB_STATIC_ONLY
     char frame[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* frame = new uint8_t[_frameLength];
+    uint8_t* frame = (uint8_t*)BufferPool::alloc(_frameLength);
+    if(frame == NULL) {
+      return(0);
+    }
   #endif
   for(size_t i = 0; i < _frameLength; i++) {
     frame[i] = _mod->ModuleSerial->read();
@@ -130,15 +136,21 @@ size_t XBee::available() {
   // save packet source and data
   size_t payloadLength = _frameLength - 12;
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] _packetData;
-    _packetData = new char[payloadLength];
+    BufferPool::free(_packetData);
+    _packetData = (char*)BufferPool::alloc(payloadLength);
+    if(_packetData == NULL) {
+      BufferPool::free(frame);
+      _frameLength = 0;
+      _frameHeaderProcessed = false;
+      return(0);
+    }
   #endif
   memcpy(_packetData, frame + 12, payloadLength - 1);
   _packetData[payloadLength - 1] = '\0';
   memcpy(_packetSource, frame + 1, 8);
 
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] frame;
+    BufferPool::free(frame);
   #endif
   _frameLength = 0;
   _frameHeaderProcessed = false;
@@ -156,6 +168,12 @@ String XBee::getPacketSource() {
 }
 
 String XBee::getPacketData() {
+  #ifndef RADIOLIB_STATIC_ONLY
+    // no packet was received yet
+    if(_packetData == NULL) {
+      return(String(""));
+    }
+  #endif
   String str(_packetData);
   return(str);
 }
@@ -216,11 +234,11 @@ int16_t XBeeSerial::begin(long speed) {
 }
 
 void XBeeSerial::reset() {
-  pinMode(_mod->getRst(), OUTPUT);
-  digitalWrite(_mod->getRst(), LOW);
-  delay(1);
-  digitalWrite(_mod->getRst(), HIGH);
-  pinMode(_mod->getRst(), INPUT);
+  Module::pinMode(_mod->getRst(), OUTPUT);
+  Module::digitalWrite(_mod->getRst(), LOW);
+  Module::delay(1);
+  Module::digitalWrite(_mod->getRst(), HIGH);
+  Module::pinMode(_mod->getRst(), INPUT);
 }
 
 int16_t XBeeSerial::setDestinationAddress(const char* destinationAddressHigh, const char* destinationAddressLow) {
@@ -235,13 +253,16 @@ int16_t XBeeSerial::setDestinationAddress(const char* destinationAddressHigh, co
   #ifdef RADIOLIB_STATIC_ONLY
     char addressHigh[13];
   #else
-    char* addressHigh = new char[strlen(destinationAddressHigh) + 4];
+    char* addressHigh = (char*)BufferPool::alloc(strlen(destinationAddressHigh) + 4);
+    if(addressHigh == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(addressHigh, "ATDH");
   strcat(addressHigh, destinationAddressHigh);
   bool res = _mod->ATsendCommand(addressHigh);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] addressHigh;
+    BufferPool::free(addressHigh);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -252,13 +273,16 @@ int16_t XBeeSerial::setDestinationAddress(const char* destinationAddressHigh, co
   #ifdef RADIOLIB_STATIC_ONLY
     char addressLow[13];
   #else
-    char* addressLow = new char[strlen(destinationAddressLow) + 4];
+    char* addressLow = (char*)BufferPool::alloc(strlen(destinationAddressLow) + 4);
+    if(addressLow == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(addressLow, "ATDL");
   strcat(addressLow, destinationAddressLow);
   res = _mod->ATsendCommand(addressLow);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] addressLow;
+    BufferPool::free(addressLow);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -285,13 +309,16 @@ int16_t XBeeSerial::setPanId(const char* panId) {
   #ifdef RADIOLIB_STATIC_ONLY
     char cmd[21];
   #else
-    char* cmd = new char[strlen(panId) + 4];
+    char* cmd = (char*)BufferPool::alloc(strlen(panId) + 4);
+    if(cmd == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   strcpy(cmd, "ATID");
   strcat(cmd, panId);
   bool res = _mod->ATsendCommand(cmd);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] cmd;
+    BufferPool::free(cmd);
   #endif
   if(!res) {
     return(ERR_AT_FAILED);
@@ -308,13 +335,13 @@ int16_t XBeeSerial::setPanId(const char* panId) {
 
 bool XBeeSerial::enterCmdMode() {
   for(uint8_t i = 0; i < 10; i++) {
-    delay(1000);
+    Module::delay(1000);
 
     _mod->ModuleSerial->write('+');
     _mod->ModuleSerial->write('+');
     _mod->ModuleSerial->write('+');
 
-    delay(1000);
+    Module::delay(1000);
 
     if(_mod->ATgetResponse()) {
       return(true);
@@ -362,7 +389,10 @@ void XBee::sendApiFrame(uint8_t type, uint8_t id, uint8_t* data, uint16_t length
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t frame[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* frame = new uint8_t[frameLength];
+    uint8_t* frame = (uint8_t*)BufferPool::alloc(frameLength);
+    if(frame == NULL) {
+      return;
+    }
   #endif
 
   frame[0] = 0x7E;                          // start delimiter
@@ -386,7 +416,7 @@ void XBee::sendApiFrame(uint8_t type, uint8_t id, uint8_t* data, uint16_t length
 
   // deallocate memory
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] frame;
+    BufferPool::free(frame);
   #endif
 }
 
@@ -403,10 +433,10 @@ int16_t XBee::readApiFrame(uint8_t frameID, uint8_t codePos, uint16_t timeout) {
   numBytes++;
 
   // wait until all response bytes are available (5s timeout)
-  uint32_t start = millis();
+  uint32_t start = Module::millis();
   while(_mod->ModuleSerial->available() < (int16_t)numBytes) {
     yield();
-    if(millis() - start >= timeout/2) {
+    if(Module::millis() - start >= timeout/2) {
       return(ERR_FRAME_MALFORMED);
     }
   }
@@ -417,7 +447,10 @@ int16_t XBee::readApiFrame(uint8_t frameID, uint8_t codePos, uint16_t timeout) {
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t resp[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* resp = new uint8_t[numBytes];
+    uint8_t* resp = (uint8_t*)BufferPool::alloc(numBytes);
+    if(resp == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
   for(uint16_t i = 0; i < numBytes; i++) {
     resp[i] = _mod->ModuleSerial->read();
@@ -433,6 +466,9 @@ int16_t XBee::readApiFrame(uint8_t frameID, uint8_t codePos, uint16_t timeout) {
   RADIOLIB_DEBUG_PRINTLN();
   if(checksum != 0xFF) {
     RADIOLIB_DEBUG_PRINTLN(checksum, HEX);
+    #ifndef RADIOLIB_STATIC_ONLY
+      BufferPool::free(resp);
+    #endif
     return(ERR_FRAME_INCORRECT_CHECKSUM);
   }
 
@@ -442,23 +478,26 @@ int16_t XBee::readApiFrame(uint8_t frameID, uint8_t codePos, uint16_t timeout) {
     RADIOLIB_DEBUG_PRINTLN(resp[1]);
     RADIOLIB_DEBUG_PRINT(F("expected frame ID: "));
     RADIOLIB_DEBUG_PRINTLN(frameID);
+    #ifndef RADIOLIB_STATIC_ONLY
+      BufferPool::free(resp);
+    #endif
     return(ERR_FRAME_UNEXPECTED_ID);
   }
 
   // codePos does not include start delimiter and frame ID
   uint8_t code = resp[codePos];
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] resp;
+    BufferPool::free(resp);
   #endif
   return(code);
 }
 
 uint16_t XBee::getNumBytes(uint32_t timeout, size_t minBytes) {
   // wait for available data
-  uint32_t start = millis();
+  uint32_t start = Module::millis();
   while((size_t)_mod->ModuleSerial->available() < minBytes) {
     yield();
-    if(millis() - start >= timeout) {
+    if(Module::millis() - start >= timeout) {
       return(0);
     }
   }
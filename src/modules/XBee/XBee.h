@@ -3,6 +3,7 @@
 
 #include "../../ISerial.h"
 #include "../../TypeDef.h"
+#include "../../BufferPool.h"
 
 // API reserved characters
 #define XBEE_API_START                                0x7E
@@ -183,7 +184,7 @@ class XBee {
     #ifdef RADIOLIB_STATIC_ONLY
       char _packetData[RADIOLIB_STATIC_ARRAY_SIZE];
     #else
-      char* _packetData = new char[0];
+      char* _packetData = NULL;
     #endif
     uint8_t _packetSource[8];
 
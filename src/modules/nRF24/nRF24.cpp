@@ -2,12 +2,32 @@
 
 nRF24::nRF24(Module* mod) : PhysicalLayer(NRF24_FREQUENCY_STEP_SIZE, NRF24_MAX_PACKET_LENGTH) {
   _mod = mod;
+  _burstData = NULL;
+  _burstLen = 0;
+  _burstPacketLen = NRF24_MAX_PACKET_LENGTH;
+  _burstAck = true;
+  _burstActive = false;
+  _burstNum = 0;
+  _burstWritten = 0;
+  _burstDone = 0;
+  _burstFailed = 0;
+  _burstAction = NULL;
+  for(uint8_t i = 0; i < NRF24_NUM_PIPES; i++) {
+    _pipeQueues[i] = NULL;
+  }
+  _pipeDropped = 0;
 }
 
 int16_t nRF24::begin(int16_t freq, int16_t dataRate, int8_t power, uint8_t addrWidth) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_BEGIN);
+
   // set module properties
   _mod->SPIreadCommand = NRF24_CMD_READ;
   _mod->SPIwriteCommand = NRF24_CMD_WRITE;
+  _mod->SPIburstSupported = false;
+  _mod->SPIvolatileRegs = nRF24VolatileRegs;
+  _mod->SPIvolatileRegsLen = sizeof(nRF24VolatileRegs);
+  _mod->clearRegisterCache();
   _mod->init(RADIOLIB_USE_SPI);
 
   // set pin mode on RST (connected to nRF24 CE pin)
@@ -15,7 +35,7 @@ int16_t nRF24::begin(int16_t freq, int16_t dataRate, int8_t power, uint8_t addrW
   Module::digitalWrite(_mod->getRst(), LOW);
 
   // wait for minimum power-on reset duration
-  delay(100);
+  Module::delay(100);
 
   // check SPI connection
   int16_t val = _mod->SPIgetRegValue(NRF24_REG_SETUP_AW);
@@ -55,38 +75,39 @@ int16_t nRF24::sleep() {
 }
 
 int16_t nRF24::standby() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_STANDBY);
+
   // make sure carrier output is disabled
   _mod->SPIsetRegValue(NRF24_REG_RF_SETUP, NRF24_CONT_WAVE_OFF, 7, 7);
   _mod->SPIsetRegValue(NRF24_REG_RF_SETUP, NRF24_PLL_LOCK_OFF, 4, 4);
-  digitalWrite(_mod->getRst(), LOW);
+  Module::digitalWrite(_mod->getRst(), LOW);
 
   // use standby-1 mode
   return(_mod->SPIsetRegValue(NRF24_REG_CONFIG, NRF24_POWER_UP, 1, 1));
 }
 
 int16_t nRF24::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+
   // start transmission
   int16_t state = startTransmit(data, len, addr);
   RADIOLIB_ASSERT(state);
 
-  // wait until transmission is finished
-  uint32_t start = micros();
-  while(digitalRead(_mod->getIrq())) {
-    yield();
+  // reflect maximum number of retransmits on IRQ as well, so that both outcomes end the wait
+  _mod->SPIsetRegValue(NRF24_REG_CONFIG, NRF24_MASK_MAX_RT_IRQ_ON, 4, 4);
 
-    // check maximum number of retransmits
-    if(getStatus(NRF24_MAX_RT)) {
-      standby();
-      clearIRQ();
-      return(ERR_ACK_NOT_RECEIVED);
-    }
+  // wait until transmission is finished, timeout: 15 retries * 4ms (max Tx time as per datasheet)
+  if(!Module::waitForPin(_mod->getIrq(), LOW, 60)) {
+    standby();
+    clearIRQ();
+    return(ERR_TX_TIMEOUT);
+  }
 
-    // check timeout: 15 retries * 4ms (max Tx time as per datasheet)
-    if(micros() - start >= 60000) {
-      standby();
-      clearIRQ();
-      return(ERR_TX_TIMEOUT);
-    }
+  // check maximum number of retransmits
+  if(getStatus(NRF24_MAX_RT)) {
+    standby();
+    clearIRQ();
+    return(ERR_ACK_NOT_RECEIVED);
   }
 
   // clear interrupts
@@ -96,21 +117,17 @@ int16_t nRF24::transmit(uint8_t* data, size_t len, uint8_t addr) {
 }
 
 int16_t nRF24::receive(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_RECEIVE);
+
   // start reception
   int16_t state = startReceive();
   RADIOLIB_ASSERT(state);
 
-  // wait for Rx_DataReady or timeout
-  uint32_t start = micros();
-  while(digitalRead(_mod->getIrq())) {
-    yield();
-    
-    // check timeout: 15 retries * 4ms (max Tx time as per datasheet)
-    if(micros() - start >= 60000) {
-      standby();
-      clearIRQ();
-      return(ERR_RX_TIMEOUT);
-    }
+  // wait for Rx_DataReady or timeout: 15 retries * 4ms (max Tx time as per datasheet)
+  if(!Module::waitForPin(_mod->getIrq(), LOW, 60)) {
+    standby();
+    clearIRQ();
+    return(ERR_RX_TIMEOUT);
   }
 
   // read the received data
@@ -128,7 +145,7 @@ int16_t nRF24::transmitDirect(uint32_t frf) {
   int16_t state = _mod->SPIsetRegValue(NRF24_REG_CONFIG, NRF24_PTX, 0, 0);
   state |= _mod->SPIsetRegValue(NRF24_REG_RF_SETUP, NRF24_CONT_WAVE_ON, 7, 7);
   state |= _mod->SPIsetRegValue(NRF24_REG_RF_SETUP, NRF24_PLL_LOCK_ON, 4, 4);
-  digitalWrite(_mod->getRst(), HIGH);
+  Module::digitalWrite(_mod->getRst(), HIGH);
   return(state);
 }
 
@@ -139,10 +156,46 @@ int16_t nRF24::receiveDirect() {
 }
 
 void nRF24::setIrqAction(void (*func)(void)) {
-  attachInterrupt(digitalPinToInterrupt(_mod->getIrq()), func, FALLING);
+  Module::attachInterrupt(_mod->getIrq(), func, FALLING);
+}
+
+bool nRF24::setEventIsr(uint8_t source, void (*func)(void)) {
+  if((source != 0) || (_mod->getIrq() == RADIOLIB_NC)) {
+    return(false);
+  }
+
+  if(func == NULL) {
+    Module::detachInterrupt(_mod->getIrq());
+  } else {
+    setIrqAction(func);
+  }
+  return(true);
+}
+
+uint16_t nRF24::getEvents() {
+  // burst is serviced here, so that it can also be driven from the event queue
+  if(_burstActive) {
+    return(serviceFifo() ? RADIOLIB_EVENT_TX_DONE : RADIOLIB_EVENT_NONE);
+  }
+
+  // maximum number of retransmits means no ACK was received
+  uint16_t events = RADIOLIB_EVENT_NONE;
+  int16_t status = getStatus(NRF24_TX_DS | NRF24_RX_DR | NRF24_MAX_RT);
+  if(status & NRF24_TX_DS) {
+    events |= RADIOLIB_EVENT_TX_DONE;
+  }
+  if(status & NRF24_RX_DR) {
+    events |= RADIOLIB_EVENT_RX_DONE;
+  }
+  if(status & NRF24_MAX_RT) {
+    events |= RADIOLIB_EVENT_TIMEOUT;
+  }
+  return(events);
 }
 
 int16_t nRF24::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+
   // suppress unused variable warning
   (void)addr;
 
@@ -175,14 +228,33 @@ int16_t nRF24::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
   SPIwriteTxPayload(data, len);
 
   // CE high to start transmitting
-  digitalWrite(_mod->getRst(), HIGH);
-  delay(1);
-  digitalWrite(_mod->getRst(), LOW);
+  Module::digitalWrite(_mod->getRst(), HIGH);
+  Module::delay(1);
+  Module::digitalWrite(_mod->getRst(), LOW);
 
   return(state);
 }
 
+int16_t nRF24::finishTransmit() {
+  // check maximum number of retransmits before the flag is cleared
+  bool ack = !getStatus(NRF24_MAX_RT);
+
+  // set mode to standby, this also stops burst transmission
+  _burstActive = false;
+  standby();
+
+  // clear interrupts
+  clearIRQ();
+
+  if(!ack) {
+    return(ERR_ACK_NOT_RECEIVED);
+  }
+  return(ERR_NONE);
+}
+
 int16_t nRF24::startReceive() {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_RECEIVE);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -200,15 +272,17 @@ int16_t nRF24::startReceive() {
   SPItransfer(NRF24_CMD_FLUSH_RX);
 
   // CE high to start receiving
-  digitalWrite(_mod->getRst(), HIGH);
+  Module::digitalWrite(_mod->getRst(), HIGH);
 
   // wait to enter Rx state
-  delay(1);
+  Module::delay(1);
 
   return(state);
 }
 
 int16_t nRF24::readData(uint8_t* data, size_t len) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_READ_DATA);
+
   // set mode to standby
   int16_t state = standby();
   RADIOLIB_ASSERT(state);
@@ -228,6 +302,214 @@ int16_t nRF24::readData(uint8_t* data, size_t len) {
   return(ERR_NONE);
 }
 
+int16_t nRF24::transmitBurst(uint8_t* data, size_t len, uint8_t packetLen, bool ack) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_TRANSMIT);
+
+  // start transmission
+  int16_t state = startTransmitBurst(data, len, packetLen, ack);
+  RADIOLIB_ASSERT(state);
+
+  // wait until all packets are finished, Tx FIFO is serviced whenever IRQ is asserted
+  // timeout: 15 retries * 4ms (max Tx time as per datasheet) for each packet
+  uint32_t timeout = 60 * _burstNum + 10;
+  uint32_t start = Module::millis();
+  while(!serviceFifo()) {
+    uint32_t elapsed = Module::millis() - start;
+    if((elapsed >= timeout) || !Module::waitForPin(_mod->getIrq(), LOW, timeout - elapsed)) {
+      finishTransmit();
+      return(ERR_TX_TIMEOUT);
+    }
+  }
+
+  // clear interrupts
+  clearIRQ();
+
+  if(_burstFailed > 0) {
+    return(ERR_ACK_NOT_RECEIVED);
+  }
+  return(ERR_NONE);
+}
+
+int16_t nRF24::startTransmitBurst(uint8_t* data, size_t len, uint8_t packetLen, bool ack) {
+  RADIOLIB_STATS_SCOPE(_mod, RADIOLIB_STATS_API_START_TRANSMIT);
+
+  // check packet length
+  if((packetLen == 0) || (packetLen > NRF24_MAX_PACKET_LENGTH)) {
+    return(ERR_PACKET_TOO_LONG);
+  }
+
+  // set mode to standby
+  int16_t state = standby();
+  RADIOLIB_ASSERT(state);
+
+  // enable primary Tx mode
+  state = _mod->SPIsetRegValue(NRF24_REG_CONFIG, NRF24_PTX, 0, 0);
+
+  // clear interrupts
+  clearIRQ();
+
+  // enable Tx_DataSent and maximum retransmits interrupts
+  state |= _mod->SPIsetRegValue(NRF24_REG_CONFIG, NRF24_MASK_TX_DS_IRQ_ON | NRF24_MASK_MAX_RT_IRQ_ON, 5, 4);
+  RADIOLIB_ASSERT(state);
+
+  // flush Tx FIFO
+  SPItransfer(NRF24_CMD_FLUSH_TX);
+
+  // fill Tx FIFO with the first packets
+  _burstData = data;
+  _burstLen = len;
+  _burstPacketLen = packetLen;
+  _burstAck = ack;
+  _burstNum = (len + packetLen - 1) / packetLen;
+  _burstWritten = 0;
+  _burstDone = 0;
+  _burstFailed = 0;
+  _burstActive = true;
+  while((_burstWritten < _burstNum) && (_burstWritten < NRF24_FIFO_DEPTH)) {
+    writeBurstPacket(_burstWritten++);
+  }
+
+  // CE is kept high for the whole burst, so the packets are sent back-to-back
+  Module::digitalWrite(_mod->getRst(), HIGH);
+
+  return(state);
+}
+
+bool nRF24::serviceFifo() {
+  if(!_burstActive) {
+    return(true);
+  }
+
+  // flags set while the previous ones are handled do not generate another IRQ edge, so keep going until there are none left
+  uint8_t status = SPItransfer(NRF24_CMD_NOP);
+  while(status & (NRF24_TX_DS | NRF24_MAX_RT)) {
+    _mod->SPIwriteRegister(NRF24_REG_STATUS, NRF24_TX_DS);
+
+    bool maxRt = status & NRF24_MAX_RT;
+    if(maxRt) {
+      // transmitter is halted with the failed packet at the head of Tx FIFO,
+      // fill the rest of it with dummy payloads to find out how many packets are still there
+      uint8_t dummy = 0;
+      uint8_t free = 0;
+      while(!(SPItransfer(NRF24_CMD_NOP) & NRF24_TX_FIFO_FULL)) {
+        SPIwriteTxPayload(&dummy, 1);
+        free++;
+      }
+      size_t failed = _burstWritten - (NRF24_FIFO_DEPTH - free);
+      reportBurst(failed);
+      _burstFailed++;
+      if(_burstAction != NULL) {
+        _burstAction(failed, ERR_ACK_NOT_RECEIVED);
+      }
+      _burstDone = failed + 1;
+
+      // drop the failed packet, the ones after it are written again
+      SPItransfer(NRF24_CMD_FLUSH_TX);
+      _burstWritten = _burstDone;
+    }
+
+    // refill Tx FIFO
+    status = SPItransfer(NRF24_CMD_NOP);
+    while(!(status & NRF24_TX_FIFO_FULL) && (_burstWritten < _burstNum)) {
+      writeBurstPacket(_burstWritten++);
+      status = SPItransfer(NRF24_CMD_NOP);
+    }
+
+    // CE pulse restarts the transmitter after maximum number of retransmits
+    if(maxRt) {
+      _mod->SPIwriteRegister(NRF24_REG_STATUS, NRF24_MAX_RT);
+      Module::digitalWrite(_mod->getRst(), LOW);
+      Module::digitalWrite(_mod->getRst(), HIGH);
+    }
+
+    // the chip does not report how many packets are in Tx FIFO, only whether it is full or empty, otherwise there are at most 2
+    size_t pending = NRF24_FIFO_DEPTH;
+    if(!(status & NRF24_TX_FIFO_FULL)) {
+      pending = (_mod->SPIgetRegValue(NRF24_REG_FIFO_STATUS) & NRF24_TX_FIFO_EMPTY_FLAG) ? 0 : NRF24_FIFO_DEPTH - 1;
+    }
+    if(_burstWritten > pending) {
+      reportBurst(_burstWritten - pending);
+    }
+
+    status = SPItransfer(NRF24_CMD_NOP);
+  }
+
+  if(_burstDone < _burstNum) {
+    return(false);
+  }
+
+  // all packets were finished
+  _burstActive = false;
+  Module::digitalWrite(_mod->getRst(), LOW);
+  return(true);
+}
+
+void nRF24::setFifoAction(void (*func)(void)) {
+  setIrqAction(func);
+}
+
+void nRF24::setBurstResultAction(void (*func)(size_t packet, int16_t status)) {
+  _burstAction = func;
+}
+
+int16_t nRF24::setPipeQueue(uint8_t pipeNum, PacketRing* queue) {
+  if(pipeNum >= NRF24_NUM_PIPES) {
+    return(ERR_INVALID_PIPE_NUMBER);
+  }
+
+  _pipeQueues[pipeNum] = queue;
+  return(ERR_NONE);
+}
+
+size_t nRF24::readPipes() {
+  size_t count = 0;
+
+  // RX_DR is cleared before the FIFO is drained, packet that arrives afterwards sets it again, so keep going until it stays clear
+  uint8_t status = SPItransfer(NRF24_CMD_NOP);
+  while((status & NRF24_RX_DR) || (((status & NRF24_RX_FIFO_EMPTY) >> 1) < NRF24_NUM_PIPES)) {
+    _mod->SPIwriteRegister(NRF24_REG_STATUS, NRF24_RX_DR);
+
+    // RX_P_NO in status byte belongs to the packet at the head of Rx FIFO
+    uint8_t pipe = getPacketPipe();
+    while(pipe != NRF24_PIPE_NONE) {
+      readPipePacket(pipe);
+      count++;
+      pipe = getPacketPipe();
+    }
+
+    status = SPItransfer(NRF24_CMD_NOP);
+  }
+
+  return(count);
+}
+
+uint8_t nRF24::getPacketPipe() {
+  // value 6 is not used by the chip
+  uint8_t pipe = (SPItransfer(NRF24_CMD_NOP) & NRF24_RX_FIFO_EMPTY) >> 1;
+  if(pipe >= NRF24_NUM_PIPES) {
+    return(NRF24_PIPE_NONE);
+  }
+  return(pipe);
+}
+
+int16_t nRF24::setAckPayload(uint8_t pipeNum, uint8_t* data, size_t len) {
+  if(pipeNum >= NRF24_NUM_PIPES) {
+    return(ERR_INVALID_PIPE_NUMBER);
+  }
+
+  if(len > NRF24_MAX_PACKET_LENGTH) {
+    return(ERR_PACKET_TOO_LONG);
+  }
+
+  // payloads for all pipes share Tx FIFO
+  if(SPItransfer(NRF24_CMD_NOP) & NRF24_TX_FIFO_FULL) {
+    return(ERR_QUEUE_FULL);
+  }
+
+  SPItransfer(NRF24_CMD_WRITE_ACK_PAYLOAD | pipeNum, true, data, NULL, len);
+  return(ERR_NONE);
+}
+
 int16_t nRF24::setFrequency(int16_t freq) {
   RADIOLIB_CHECK_RANGE(freq, 2400, 2525, ERR_INVALID_FREQUENCY);
 
@@ -508,8 +790,8 @@ int16_t nRF24::config() {
   // set 15 retries and delay 1500 (5*250) us
   _mod->SPIsetRegValue(NRF24_REG_SETUP_RETR, (5 << 4) | 5);
 
-  // set features: dynamic payload on, payload with ACK packets off, dynamic ACK off
-  state = _mod->SPIsetRegValue(NRF24_REG_FEATURE, NRF24_DPL_ON | NRF24_ACK_PAY_OFF | NRF24_DYN_ACK_OFF, 2, 0);
+  // set features: dynamic payload on, payload with ACK packets on (only sent when loaded by setAckPayload), dynamic ACK on (allows W_TX_PAYLOAD_NOACK)
+  state = _mod->SPIsetRegValue(NRF24_REG_FEATURE, NRF24_DPL_ON | NRF24_ACK_PAY_ON | NRF24_DYN_ACK_ON, 2, 0);
   RADIOLIB_ASSERT(state);
 
   // enable dynamic payloads
@@ -528,11 +810,64 @@ int16_t nRF24::config() {
 
   // power up
   _mod->SPIsetRegValue(NRF24_REG_CONFIG, NRF24_POWER_UP, 1, 1);
-  delay(5);
+  Module::delay(5);
 
   return(state);
 }
 
+void nRF24::writeBurstPacket(size_t index) {
+  // the last packet may be shorter
+  size_t offset = index * _burstPacketLen;
+  size_t len = _burstLen - offset;
+  if(len > _burstPacketLen) {
+    len = _burstPacketLen;
+  }
+  SPItransfer(_burstAck ? NRF24_CMD_WRITE_TX_PAYLOAD : NRF24_CMD_WRITE_TX_PAYLOAD_NOACK, true, _burstData + offset, NULL, len);
+}
+
+void nRF24::reportBurst(size_t done) {
+  for(; _burstDone < done; _burstDone++) {
+    if(_burstAction != NULL) {
+      _burstAction(_burstDone, ERR_NONE);
+    }
+  }
+}
+
+void nRF24::readPipePacket(uint8_t pipeNum) {
+  // payload width above 32 bytes means the packet is corrupted, datasheet says to flush Rx FIFO
+  uint8_t buff[NRF24_MAX_PACKET_LENGTH];
+  size_t len = getPacketLength();
+  if(len > NRF24_MAX_PACKET_LENGTH) {
+    SPItransfer(NRF24_CMD_FLUSH_RX);
+    _pipeDropped++;
+    return;
+  }
+
+  // packet has to be read even when it is discarded, otherwise it would stay at the head of Rx FIFO
+  PacketSlot_t* slot = (_pipeQueues[pipeNum] != NULL) ? _pipeQueues[pipeNum]->acquire() : NULL;
+  if(slot == NULL) {
+    SPIreadRxPayload(buff, len);
+    _pipeDropped++;
+    return;
+  }
+
+  // read straight into the slot, unless the packet has to be truncated
+  slot->status = ERR_NONE;
+  if(len <= slot->size) {
+    SPIreadRxPayload(slot->data, len);
+  } else {
+    SPIreadRxPayload(buff, len);
+    len = slot->size;
+    memcpy(slot->data, buff, len);
+    slot->status = ERR_PACKET_TOO_LONG;
+  }
+  slot->len = len;
+  slot->rssi = 0;
+  slot->snr = 0;
+  slot->timestamp = Module::micros();
+  _pipeQueues[pipeNum]->commit();
+}
+
 void nRF24::SPIreadRxPayload(uint8_t* data, uint8_t numBytes) {
   SPItransfer(NRF24_CMD_READ_RX_PAYLOAD, false, NULL, data, numBytes);
 }
@@ -541,30 +876,34 @@ void nRF24::SPIwriteTxPayload(uint8_t* data, uint8_t numBytes) {
   SPItransfer(NRF24_CMD_WRITE_TX_PAYLOAD, true, data, NULL, numBytes);
 }
 
-void nRF24::SPItransfer(uint8_t cmd, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes) {
-  // get pointer to used SPI interface and the settings
-  SPIClass* spi = _mod->getSpi();
-  SPISettings spiSettings = _mod->getSpiSettings();
+uint8_t nRF24::SPItransfer(uint8_t cmd, bool write, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes) {
+  // command byte, followed by data bytes
+  uint8_t status = cmd;
 
-  // start transfer
-  digitalWrite(_mod->getCs(), LOW);
-  spi->beginTransaction(spiSettings);
+  #ifdef RADIOLIB_SPI_TRACE
+    uint32_t traceTime = Module::micros();
+  #endif
 
-  // send command
-  spi->transfer(cmd);
+  // start transfer
+  _mod->SPIprepareTransaction();
+  Module::digitalWrite(_mod->getCs(), LOW);
+  _mod->SPIbeginTransaction();
 
-  // send data
+  // send the frame, short frames are sent at once
   if(write) {
-    for(uint8_t i = 0; i < numBytes; i++) {
-      spi->transfer(dataOut[i]);
-    }
+    _mod->SPItransferFrame(&status, 1, dataOut, NULL, numBytes);
   } else {
-    for(uint8_t i = 0; i < numBytes; i++) {
-      dataIn[i] = spi->transfer(0x00);
-    }
+    _mod->SPItransferFrame(&status, 1, NULL, dataIn, numBytes);
   }
 
   // stop transfer
-  spi->endTransaction();
-  digitalWrite(_mod->getCs(), HIGH);
+  _mod->SPIendTransaction();
+  Module::digitalWrite(_mod->getCs(), HIGH);
+
+  #ifdef RADIOLIB_SPI_TRACE
+    _mod->SPItraceRecord(&cmd, 1, write, write ? dataOut : dataIn, numBytes, status, traceTime);
+  #endif
+
+  // status register is clocked out while the command is sent
+  return(status);
 }
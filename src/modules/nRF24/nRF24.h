@@ -5,10 +5,14 @@
 #include "../../TypeDef.h"
 
 #include "../../protocols/PhysicalLayer/PhysicalLayer.h"
+#include "../../protocols/PhysicalLayer/PacketRing.h"
 
 // nRF24 physical layer properties
 #define NRF24_FREQUENCY_STEP_SIZE                     1000000.0
 #define NRF24_MAX_PACKET_LENGTH                       32
+#define NRF24_FIFO_DEPTH                              3
+#define NRF24_NUM_PIPES                               6
+#define NRF24_PIPE_NONE                               7
 
 // nRF24 SPI commands
 #define NRF24_CMD_READ                                0b00000000
@@ -171,6 +175,12 @@
 #define NRF24_DYN_ACK_OFF                             0b00000000  //  0     0     payloads without ACK: disabled (default)
 #define NRF24_DYN_ACK_ON                              0b00000001  //  0     0                           enabled
 
+// nRF24 registers that are never served from register cache - status registers and multi-byte address registers
+static const uint8_t nRF24VolatileRegs[] PROGMEM = {
+  NRF24_REG_STATUS, NRF24_REG_OBSERVE_TX, NRF24_REG_RPD, NRF24_REG_RX_ADDR_P0,
+  NRF24_REG_RX_ADDR_P1, NRF24_REG_TX_ADDR, NRF24_REG_FIFO_STATUS
+};
+
 /*!
   \class nRF24
 
@@ -273,6 +283,24 @@ class nRF24: public PhysicalLayer {
     */
     void setIrqAction(void (*func)(void));
 
+    /*!
+      \brief Attaches or detaches event queue interrupt service routine, see PhysicalLayer::setEventAction. Source 0 is IRQ.
+
+      \param source Index of interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the requested pin is connected, false otherwise.
+    */
+    bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ flags and decodes them into events, see PhysicalLayer::setEventAction.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    uint16_t getEvents();
+
     /*!
       \brief Interrupt-driven binary transmit method. IRQ will be activated when full packet is transmitted.
       Overloads for string-based transmissions are implemented in PhysicalLayer.
@@ -287,6 +315,13 @@ class nRF24: public PhysicalLayer {
     */
     int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr);
 
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - sets module to standby and clears IRQ flags. Returns ERR_ACK_NOT_RECEIVED when maximum number of retransmits was reached.
+
+      \returns \ref status_codes
+    */
+    int16_t finishTransmit();
+
     /*!
       \brief Interrupt-driven receive method. IRQ will be activated when full packet is received.
 
@@ -305,6 +340,127 @@ class nRF24: public PhysicalLayer {
     */
     int16_t readData(uint8_t* data, size_t len);
 
+    // burst methods
+
+    /*!
+      \brief Blocking burst transmit method. Data are split into packets that are sent back-to-back, see startTransmitBurst.
+
+      \param data Binary data to be sent.
+
+      \param len Number of bytes to send.
+
+      \param packetLen Payload length of a single packet, the last packet may be shorter. Defaults to 32 bytes.
+
+      \param ack Whether packets should be acknowledged. When set to false, packets are sent by W_TX_PAYLOAD_NOACK and never retransmitted.
+
+      \returns \ref status_codes, ERR_ACK_NOT_RECEIVED when at least one packet reached maximum number of retransmits.
+    */
+    int16_t transmitBurst(uint8_t* data, size_t len, uint8_t packetLen = NRF24_MAX_PACKET_LENGTH, bool ack = true);
+
+    /*!
+      \brief Interrupt-driven burst transmit method. Data are split into packets, up to 3 of them are loaded into Tx FIFO and CE is kept high,
+      so that the next packet is sent as soon as the previous one was acknowledged. Tx FIFO is refilled by nRF24::serviceFifo.
+      Packet that reaches maximum number of retransmits is dropped and the burst continues with the next one.
+      Results of individual packets are reported by the function set in setBurstResultAction. The data must stay valid until the burst is finished.
+
+      \param data Binary data to be sent.
+
+      \param len Number of bytes to send.
+
+      \param packetLen Payload length of a single packet, the last packet may be shorter. Defaults to 32 bytes.
+
+      \param ack Whether packets should be acknowledged. When set to false, packets are sent by W_TX_PAYLOAD_NOACK and never retransmitted.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmitBurst(uint8_t* data, size_t len, uint8_t packetLen = NRF24_MAX_PACKET_LENGTH, bool ack = true);
+
+    /*!
+      \brief Services burst transmission started by startTransmitBurst: clears TX_DS and MAX_RT, reports results of finished packets and refills Tx FIFO.
+      Must be called on every IRQ activation, either from interrupt service routine set by setFifoAction or by polling it, but not from both.
+      Blocking burst transmit method calls it on its own.
+
+      \returns True when all packets of the burst were finished (or no burst is running), false otherwise.
+    */
+    bool serviceFifo();
+
+    /*!
+      \brief Sets interrupt service routine to call when IRQ activates during burst transmission. The function should call nRF24::serviceFifo.
+
+      \param func ISR to call.
+    */
+    void setFifoAction(void (*func)(void));
+
+    /*!
+      \brief Sets function to be called by nRF24::serviceFifo once a packet of the burst was finished. Packets are reported in order,
+      but the report may be delayed until Tx FIFO is full or empty, since the chip does not tell how many packets are left in it.
+
+      \param func Function to call with index of the packet within the burst and ERR_NONE or ERR_ACK_NOT_RECEIVED, or NULL to disable reporting.
+    */
+    void setBurstResultAction(void (*func)(size_t packet, int16_t status));
+
+    /*!
+      \brief Gets the number of packets of the last burst that reached maximum number of retransmits.
+
+      \returns Number of packets that were not acknowledged.
+    */
+    size_t getBurstFailed() const { return(_burstFailed); }
+
+    // multi-pipe methods
+
+    /*!
+      \brief Sets queue for packets received on a pipe, see nRF24::readPipes. Packets received on pipes without a queue are discarded.
+
+      \param pipeNum Number of pipe to set the queue for. Allowed values range from 0 to 5.
+
+      \param queue Packet ring the received packets will be appended to, or NULL to remove the queue.
+
+      \returns \ref status_codes
+    */
+    int16_t setPipeQueue(uint8_t pipeNum, PacketRing* queue);
+
+    /*!
+      \brief Reads all packets from Rx FIFO (up to 3) into the queues of the pipes they were received on, see setPipeQueue.
+      Unlike readData, the module is not switched to standby, so reception started by startReceive continues while the FIFO is drained.
+      Packets that arrive in the meantime are read too, so that IRQ is released before returning and no IRQ edge is missed.
+      Packets that do not fit into their queue are discarded rather than left in Rx FIFO, where they would block the other pipes.
+      Packets longer than the queue slots are truncated and published with PacketSlot_t::status set to ERR_PACKET_TOO_LONG.
+      Should be called from the main loop after IRQ was activated, as PacketRing is not interrupt-safe.
+
+      \returns Number of packets read from Rx FIFO, including the discarded ones.
+    */
+    size_t readPipes();
+
+    /*!
+      \brief Gets the number of the pipe the oldest packet in Rx FIFO was received on, i.e. the packet that will be read by the next call to readData.
+
+      \returns Pipe number, or NRF24_PIPE_NONE when Rx FIFO is empty.
+    */
+    uint8_t getPacketPipe();
+
+    /*!
+      \brief Loads payload that will be sent with the acknowledgement of the next packet received on a pipe, so that data can be sent back without a separate transmission.
+      Payloads share Tx FIFO, so at most 3 of them can be loaded at the same time. The payload is removed from Tx FIFO (and TX_DS is set)
+      once the next new packet arrives on the same pipe, until then it is sent with every acknowledgement on that pipe, including those of retransmitted packets.
+      Can be called while receiving, transmission flushes Tx FIFO. Transmitter receives the payload on pipe 0, see getPacketPipe and readPipes.
+
+      \param pipeNum Number of pipe to load the payload for. Allowed values range from 0 to 5.
+
+      \param data Payload to send.
+
+      \param len Payload length in bytes, up to 32 bytes.
+
+      \returns \ref status_codes, ERR_QUEUE_FULL when Tx FIFO is full.
+    */
+    int16_t setAckPayload(uint8_t pipeNum, uint8_t* data, size_t len);
+
+    /*!
+      \brief Gets the number of packets discarded by readPipes, either because there was no queue for their pipe or because the queue was full.
+
+      \returns Number of discarded packets.
+    */
+    uint32_t getPipeDropped() const { return(_pipeDropped); }
+
     // configuration methods
 
     /*!
@@ -472,12 +628,27 @@ class nRF24: public PhysicalLayer {
 
     uint8_t _addrWidth;
 
+    // burst transmission, packets are written to Tx FIFO as it gets free
+    uint8_t* _burstData;
+    size_t _burstLen;
+    uint8_t _burstPacketLen;
+    bool _burstAck, _burstActive;
+    size_t _burstNum, _burstWritten, _burstDone, _burstFailed;
+    void (*_burstAction)(size_t, int16_t);
+
+    // queues of received packets for each pipe
+    PacketRing* _pipeQueues[NRF24_NUM_PIPES];
+    uint32_t _pipeDropped;
+
     int16_t config();
     void clearIRQ();
+    void writeBurstPacket(size_t index);
+    void reportBurst(size_t done);
+    void readPipePacket(uint8_t pipeNum);
 
     void SPIreadRxPayload(uint8_t* data, uint8_t numBytes);
     void SPIwriteTxPayload(uint8_t* data, uint8_t numBytes);
-    void SPItransfer(uint8_t cmd, bool write = false, uint8_t* dataOut = NULL, uint8_t* dataIn = NULL, uint8_t numBytes = 0);
+    uint8_t SPItransfer(uint8_t cmd, bool write = false, uint8_t* dataOut = NULL, uint8_t* dataIn = NULL, uint8_t numBytes = 0);
 };
 
 #endif
@@ -0,0 +1,629 @@
+#include "nRF24Emulator.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+nRF24Emulator::nRF24Emulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE ce) : EmulatedChip(cs) {
+  _irq = irq;
+  _ce = ce;
+  _ceHigh = false;
+  _state = NRF24_EMULATOR_STATE_IDLE;
+  _airSrc = NULL;
+  _rssi = NRF24_EMULATOR_RSSI_DEFAULT;
+  _loss = 0;
+  _lossSeed = 1;
+  _capture = NULL;
+  _captureSize = 0;
+  _captured = 0;
+  reset();
+}
+
+void nRF24Emulator::reset() {
+  // receivers only get incomplete packet
+  if((_state == NRF24_EMULATOR_STATE_TX) || (_state == NRF24_EMULATOR_STATE_ACK_TX)) {
+    EmulatorHal::airEnd(this, false);
+  }
+
+  memset(_regs, 0x00, sizeof(_regs));
+  _regs[NRF24_REG_CONFIG] = NRF24_CRC_ON;
+  _regs[NRF24_REG_EN_AA] = NRF24_AA_ALL_ON;
+  _regs[NRF24_REG_EN_RXADDR] = NRF24_P0_ON | NRF24_P1_ON;
+  _regs[NRF24_REG_SETUP_AW] = NRF24_ADDRESS_5_BYTES;
+  _regs[NRF24_REG_SETUP_RETR] = NRF24_ARC;
+  _regs[NRF24_REG_RF_CH] = NRF24_RF_CH;
+  _regs[NRF24_REG_RF_SETUP] = NRF24_DR_2_MBPS | NRF24_RF_PWR_0_DBM;
+  _regs[NRF24_REG_RX_ADDR_P2] = 0xC3;
+  _regs[NRF24_REG_RX_ADDR_P3] = 0xC4;
+  _regs[NRF24_REG_RX_ADDR_P4] = 0xC5;
+  _regs[NRF24_REG_RX_ADDR_P5] = 0xC6;
+  memset(_rxAddrP0, 0xE7, sizeof(_rxAddrP0));
+  memset(_rxAddrP1, 0xC2, sizeof(_rxAddrP1));
+  memset(_txAddr, 0xE7, sizeof(_txAddr));
+
+  _status = 0;
+  _txCount = 0;
+  _rxCount = 0;
+  _state = NRF24_EMULATOR_STATE_IDLE;
+  _eventTime = UINT64_MAX;
+  _listenTime = 0;
+  _txPid = 0;
+  _arc = 0;
+  _arcCnt = 0;
+  _plos = 0;
+  _txRetry = false;
+  _halted = false;
+  memset(_lastPid, 0xFF, sizeof(_lastPid));
+  memset(_lastSum, 0x00, sizeof(_lastSum));
+  memset(_ackSent, 0x00, sizeof(_ackSent));
+  _ackPipe = 0;
+  _ackPid = 0;
+  _rpd = false;
+  _airLen = 0;
+  _airSrc = NULL;
+  _airRx = false;
+  _txPackets = 0;
+  _rxPackets = 0;
+  _retransmits = 0;
+  _lostPackets = 0;
+  _rxOverflows = 0;
+}
+
+void nRF24Emulator::setSignal(int16_t rssi) {
+  _rssi = rssi;
+}
+
+void nRF24Emulator::setLoss(uint8_t percent) {
+  _loss = percent;
+  _lossSeed = 1;
+}
+
+void nRF24Emulator::setCapture(uint8_t* buff, size_t size) {
+  _capture = buff;
+  _captureSize = size;
+  _captured = 0;
+}
+
+uint64_t nRF24Emulator::getTimeOnAir(size_t len) {
+  // preamble, address, 9-bit packet control field, payload and CRC (forced on by automatic acknowledgement)
+  size_t bits = 8 + 8*getAddressWidth() + 9 + 8*len;
+  if((_regs[NRF24_REG_CONFIG] & NRF24_CRC_ON) || (_regs[NRF24_REG_EN_AA] & NRF24_AA_ALL_ON)) {
+    bits += (_regs[NRF24_REG_CONFIG] & NRF24_CRC_16) ? 16 : 8;
+  }
+  return((uint64_t)bits * getBitTime());
+}
+
+void nRF24Emulator::spiTransfer(uint8_t* buff, size_t len) {
+  if(len < 1) {
+    return;
+  }
+
+  // status register is clocked out while the command is sent
+  uint8_t cmd = buff[0];
+  buff[0] = getStatus();
+  uint8_t* data = buff + 1;
+  size_t dataLen = len - 1;
+  if(dataLen > NRF24_MAX_PACKET_LENGTH) {
+    dataLen = NRF24_MAX_PACKET_LENGTH;
+  }
+
+  if((cmd & 0xE0) == NRF24_CMD_READ) {
+    uint8_t addr = cmd & 0x1F;
+    uint8_t tmp[5];
+    uint8_t* multi = (addr == NRF24_REG_TX_ADDR) ? _txAddr : ((addr == NRF24_REG_RX_ADDR_P0) || (addr == NRF24_REG_RX_ADDR_P1)) ? getAddress(addr - NRF24_REG_RX_ADDR_P0, tmp) : NULL;
+    for(size_t i = 0; i < len - 1; i++) {
+      if(multi != NULL) {
+        data[i] = (i < 5) ? multi[i] : 0x00;
+      } else {
+        data[i] = (i == 0) ? readRegister(addr) : 0x00;
+      }
+    }
+    return;
+  }
+
+  if((cmd & 0xE0) == NRF24_CMD_WRITE) {
+    writeRegister(cmd & 0x1F, data, len - 1);
+    return;
+  }
+
+  if((cmd & 0xF8) == NRF24_CMD_WRITE_ACK_PAYLOAD) {
+    // only accepted with ACK payloads enabled
+    if(_regs[NRF24_REG_FEATURE] & NRF24_ACK_PAY_ON) {
+      txPush(data, dataLen, cmd & 0x07);
+    }
+    return;
+  }
+
+  switch(cmd) {
+    case NRF24_CMD_READ_RX_PAYLOAD:
+      memset(data, 0x00, len - 1);
+      if(_rxCount > 0) {
+        memcpy(data, _rxFifo[0], (dataLen < _rxLen[0]) ? dataLen : _rxLen[0]);
+        _rxCount--;
+        for(uint8_t i = 0; i < _rxCount; i++) {
+          memcpy(_rxFifo[i], _rxFifo[i + 1], NRF24_MAX_PACKET_LENGTH);
+          _rxLen[i] = _rxLen[i + 1];
+          _rxPipe[i] = _rxPipe[i + 1];
+        }
+      }
+      break;
+
+    case NRF24_CMD_READ_RX_PAYLOAD_WIDTH:
+      if(len > 1) {
+        data[0] = (_rxCount > 0) ? _rxLen[0] : 0x00;
+      }
+      break;
+
+    case NRF24_CMD_WRITE_TX_PAYLOAD:
+      txPush(data, dataLen, 0);
+      break;
+
+    case NRF24_CMD_WRITE_TX_PAYLOAD_NOACK:
+      // only accepted with dynamic ACK enabled
+      if(_regs[NRF24_REG_FEATURE] & NRF24_DYN_ACK_ON) {
+        txPush(data, dataLen, NRF24_EMULATOR_TAG_NOACK);
+      }
+      break;
+
+    case NRF24_CMD_FLUSH_TX:
+      _txCount = 0;
+      memset(_ackSent, 0x00, sizeof(_ackSent));
+      break;
+
+    case NRF24_CMD_FLUSH_RX:
+      _rxCount = 0;
+      break;
+  }
+}
+
+bool nRF24Emulator::readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value) {
+  if((pin == RADIOLIB_NC) || (pin != _irq)) {
+    return(false);
+  }
+
+  // IRQ is active low while any interrupt that is not masked in CONFIG is pending (mask bits are at the same positions as the flags)
+  bool active = _status & ~_regs[NRF24_REG_CONFIG] & (NRF24_RX_DR | NRF24_TX_DS | NRF24_MAX_RT);
+  *value = active ? LOW : HIGH;
+  return(true);
+}
+
+void nRF24Emulator::writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value) {
+  if((pin == RADIOLIB_NC) || (pin != _ce)) {
+    return;
+  }
+
+  // rising edge of CE restarts transmitter halted on maximum number of retransmits
+  bool high = (value == HIGH);
+  if(high && !_ceHigh) {
+    _halted = false;
+  }
+  _ceHigh = high;
+  updateMode();
+}
+
+void nRF24Emulator::update(uint64_t now) {
+  while(_eventTime <= now) {
+    _eventTime = UINT64_MAX;
+    switch(_state) {
+      case NRF24_EMULATOR_STATE_TX_SETTLE:
+        txStart();
+        break;
+
+      case NRF24_EMULATOR_STATE_TX:
+        txEnd();
+        break;
+
+      case NRF24_EMULATOR_STATE_ACK_WAIT:
+        // acknowledgement that is still on the air is too late
+        _airRx = false;
+        if(_arc < (_regs[NRF24_REG_SETUP_RETR] & 0x0F)) {
+          // auto retransmit delay already includes settling time
+          _arc++;
+          _retransmits++;
+          _txRetry = true;
+          txStart();
+        } else {
+          // packet stays in Tx FIFO, transmitter is halted until MAX_RT is cleared and CE pulsed
+          _arcCnt = _arc;
+          if(_plos < 0x0F) {
+            _plos++;
+          }
+          _lostPackets++;
+          _status |= NRF24_MAX_RT;
+          _halted = true;
+          _state = NRF24_EMULATOR_STATE_IDLE;
+        }
+        break;
+
+      case NRF24_EMULATOR_STATE_ACK_SETTLE:
+        ackStart();
+        break;
+
+      case NRF24_EMULATOR_STATE_ACK_TX:
+        EmulatorHal::airEnd(this, true);
+        _state = NRF24_EMULATOR_STATE_IDLE;
+        updateMode();
+        break;
+    }
+  }
+}
+
+void nRF24Emulator::airStart(EmulatedChip* src, const EmulatorAir_t& air) {
+  if((_airSrc != NULL) || !EmulatorHal::airMatch(air, getAir())) {
+    return;
+  }
+
+  // packet can only be received if the chip was already listening when it started
+  _airSrc = src;
+  _airLen = 0;
+  _airRx = ((_state == NRF24_EMULATOR_STATE_RX) || (_state == NRF24_EMULATOR_STATE_ACK_WAIT)) && (EmulatorHal::getTimeNs() >= _listenTime);
+  if(_airRx) {
+    _rpd = (_rssi >= -64);
+  }
+}
+
+void nRF24Emulator::airData(EmulatedChip* src, const uint8_t* data, size_t len) {
+  if((src != _airSrc) || !_airRx) {
+    return;
+  }
+
+  if(_airLen + len > sizeof(_airBuff)) {
+    len = sizeof(_airBuff) - _airLen;
+  }
+  memcpy(_airBuff + _airLen, data, len);
+  _airLen += len;
+}
+
+void nRF24Emulator::airEnd(EmulatedChip* src, bool crcOk) {
+  if(src != _airSrc) {
+    return;
+  }
+  _airSrc = NULL;
+  if(!_airRx) {
+    return;
+  }
+  _airRx = false;
+  if(!crcOk || isLost()) {
+    return;
+  }
+
+  // address width must be the same on both sides, otherwise the packet would not be detected at all
+  uint8_t width = getAddressWidth();
+  if(_airLen < (size_t)width + 2) {
+    return;
+  }
+  uint8_t len = _airBuff[width];
+  uint8_t pid = _airBuff[width + 1] >> 1;
+  bool noAck = _airBuff[width + 1] & 0x01;
+  if(_airLen != (size_t)width + 2 + len) {
+    return;
+  }
+  const uint8_t* payload = _airBuff + width + 2;
+
+  // acknowledgement is received on pipe 0
+  uint8_t addr[5];
+  if(_state == NRF24_EMULATOR_STATE_ACK_WAIT) {
+    if(memcmp(_airBuff, getAddress(0, addr), width) == 0) {
+      txDone(payload, len);
+    }
+    return;
+  }
+
+  if(_state != NRF24_EMULATOR_STATE_RX) {
+    return;
+  }
+  for(uint8_t pipe = 0; pipe < 6; pipe++) {
+    if((_regs[NRF24_REG_EN_RXADDR] & (1 << pipe)) && (memcmp(_airBuff, getAddress(pipe, addr), width) == 0)) {
+      rxFrame(pipe, pid, noAck, payload, len);
+      return;
+    }
+  }
+}
+
+uint8_t nRF24Emulator::getStatus() {
+  // pipe number of the packet at the head of Rx FIFO, 7 when empty
+  uint8_t pipe = (_rxCount > 0) ? _rxPipe[0] : 0x07;
+  return(_status | (pipe << 1) | ((_txCount == NRF24_FIFO_DEPTH) ? NRF24_TX_FIFO_FULL : 0x00));
+}
+
+uint8_t nRF24Emulator::readRegister(uint8_t addr) {
+  switch(addr) {
+    case NRF24_REG_STATUS:
+      return(getStatus());
+
+    case NRF24_REG_OBSERVE_TX:
+      return((_plos << 4) | _arcCnt);
+
+    case NRF24_REG_RPD:
+      return(_rpd ? NRF24_RP_ABOVE_64_DBM : NRF24_RP_BELOW_64_DBM);
+
+    case NRF24_REG_FIFO_STATUS: {
+      uint8_t status = 0x00;
+      if(_txCount == NRF24_FIFO_DEPTH) {
+        status |= NRF24_TX_FIFO_FULL_FLAG;
+      } else if(_txCount == 0) {
+        status |= NRF24_TX_FIFO_EMPTY_FLAG;
+      }
+      if(_rxCount == NRF24_FIFO_DEPTH) {
+        status |= NRF24_RX_FIFO_FULL_FLAG;
+      } else if(_rxCount == 0) {
+        status |= NRF24_RX_FIFO_EMPTY_FLAG;
+      }
+      return(status);
+    }
+  }
+
+  return(_regs[addr & 0x1F]);
+}
+
+void nRF24Emulator::writeRegister(uint8_t addr, const uint8_t* data, size_t len) {
+  if(len < 1) {
+    return;
+  }
+
+  switch(addr) {
+    case NRF24_REG_RX_ADDR_P0:
+    case NRF24_REG_RX_ADDR_P1:
+    case NRF24_REG_TX_ADDR: {
+      uint8_t* reg = (addr == NRF24_REG_RX_ADDR_P0) ? _rxAddrP0 : ((addr == NRF24_REG_RX_ADDR_P1) ? _rxAddrP1 : _txAddr);
+      memcpy(reg, data, (len < 5) ? len : 5);
+      return;
+    }
+
+    case NRF24_REG_STATUS:
+      // interrupt flags are cleared by writing 1
+      _status &= ~(data[0] & (NRF24_RX_DR | NRF24_TX_DS | NRF24_MAX_RT));
+      return;
+
+    case NRF24_REG_OBSERVE_TX:
+    case NRF24_REG_RPD:
+    case NRF24_REG_FIFO_STATUS:
+      // read-only
+      return;
+
+    case NRF24_REG_RF_CH:
+      // lost packet counter is reset by writing RF_CH
+      _plos = 0;
+      break;
+  }
+
+  _regs[addr & 0x1F] = data[0];
+  if(addr == NRF24_REG_CONFIG) {
+    updateMode();
+  }
+}
+
+uint8_t* nRF24Emulator::getAddress(uint8_t pipe, uint8_t* buff) {
+  // pipes 2 - 5 only have their own LSB, the rest is shared with pipe 1
+  if(pipe == 0) {
+    return(_rxAddrP0);
+  } else if(pipe == 1) {
+    return(_rxAddrP1);
+  }
+  memcpy(buff, _rxAddrP1, 5);
+  buff[0] = _regs[NRF24_REG_RX_ADDR_P0 + pipe];
+  return(buff);
+}
+
+uint8_t nRF24Emulator::getAddressWidth() {
+  return((_regs[NRF24_REG_SETUP_AW] & 0x03) + 2);
+}
+
+EmulatorAir_t nRF24Emulator::getAir() {
+  EmulatorAir_t air;
+  air.freq = (2400UL + (_regs[NRF24_REG_RF_CH] & 0x7F)) * 1000000UL;
+  air.modem = RADIOLIB_EMULATOR_MODEM_SHOCKBURST;
+  air.sf = 0;
+  air.rate = 1000000000ULL / getBitTime();
+  return(air);
+}
+
+uint64_t nRF24Emulator::getBitTime() {
+  // RF_DR_LOW takes precedence over RF_DR_HIGH
+  if(_regs[NRF24_REG_RF_SETUP] & NRF24_DR_250_KBPS) {
+    return(4000);
+  } else if(_regs[NRF24_REG_RF_SETUP] & NRF24_DR_2_MBPS) {
+    return(500);
+  }
+  return(1000);
+}
+
+bool nRF24Emulator::isLost() {
+  if(_loss == 0) {
+    return(false);
+  }
+  _lossSeed = _lossSeed * 1103515245UL + 12345UL;
+  return(((_lossSeed >> 16) % 100) < _loss);
+}
+
+void nRF24Emulator::updateMode() {
+  // power down aborts everything
+  if(!(_regs[NRF24_REG_CONFIG] & NRF24_POWER_UP)) {
+    if((_state == NRF24_EMULATOR_STATE_TX) || (_state == NRF24_EMULATOR_STATE_ACK_TX)) {
+      EmulatorHal::airEnd(this, false);
+    }
+    _state = NRF24_EMULATOR_STATE_IDLE;
+    _eventTime = UINT64_MAX;
+    _airRx = false;
+    return;
+  }
+
+  // receiver stops as soon as CE goes low, transmitter always finishes the current packet
+  bool prx = _regs[NRF24_REG_CONFIG] & NRF24_PRX;
+  if((_state == NRF24_EMULATOR_STATE_RX) && (!prx || !_ceHigh)) {
+    _state = NRF24_EMULATOR_STATE_IDLE;
+    _airRx = false;
+  }
+  if((_state != NRF24_EMULATOR_STATE_IDLE) || !_ceHigh) {
+    return;
+  }
+
+  if(prx) {
+    _state = NRF24_EMULATOR_STATE_RX;
+    _listenTime = EmulatorHal::getTimeNs() + NRF24_EMULATOR_SETTLE_TIME;
+  } else if((_txCount > 0) && !_halted && !(_status & NRF24_MAX_RT)) {
+    _state = NRF24_EMULATOR_STATE_TX_SETTLE;
+    _eventTime = EmulatorHal::getTimeNs() + NRF24_EMULATOR_SETTLE_TIME;
+  }
+}
+
+void nRF24Emulator::txPush(const uint8_t* data, size_t len, uint8_t tag) {
+  // real chip would overwrite the last entry, extra payloads are dropped instead
+  if(_txCount == NRF24_FIFO_DEPTH) {
+    return;
+  }
+  memcpy(_txFifo[_txCount], data, len);
+  _txLen[_txCount] = len;
+  _txTag[_txCount] = tag;
+  _txCount++;
+
+  // payload written in standby-II mode is sent right away
+  updateMode();
+}
+
+void nRF24Emulator::txRemove(uint8_t index) {
+  _txCount--;
+  for(uint8_t i = index; i < _txCount; i++) {
+    memcpy(_txFifo[i], _txFifo[i + 1], NRF24_MAX_PACKET_LENGTH);
+    _txLen[i] = _txLen[i + 1];
+    _txTag[i] = _txTag[i + 1];
+  }
+}
+
+void nRF24Emulator::rxPush(uint8_t pipe, const uint8_t* data, size_t len) {
+  memset(_rxFifo[_rxCount], 0x00, NRF24_MAX_PACKET_LENGTH);
+  memcpy(_rxFifo[_rxCount], data, len);
+  _rxLen[_rxCount] = len;
+  _rxPipe[_rxCount] = pipe;
+  _rxCount++;
+  _status |= NRF24_RX_DR;
+}
+
+void nRF24Emulator::sendFrame(const uint8_t* addr, uint8_t pid, bool noAck, const uint8_t* data, size_t len) {
+  uint8_t width = getAddressWidth();
+  uint8_t frame[sizeof(_airBuff)];
+  memcpy(frame, addr, width);
+  frame[width] = len;
+  frame[width + 1] = (pid << 1) | (noAck ? 0x01 : 0x00);
+  memcpy(frame + width + 2, data, len);
+
+  EmulatorHal::airStart(this, getAir());
+  EmulatorHal::airData(this, frame, width + 2 + len);
+  _eventTime = EmulatorHal::getTimeNs() + getTimeOnAir(len);
+}
+
+void nRF24Emulator::txStart() {
+  // packet ID is only incremented for new packets
+  if(!_txRetry) {
+    _txPid = (_txPid + 1) & 0x03;
+    _arc = 0;
+  }
+  _state = NRF24_EMULATOR_STATE_TX;
+  sendFrame(_txAddr, _txPid, _txTag[0] & NRF24_EMULATOR_TAG_NOACK, _txFifo[0], _txLen[0]);
+}
+
+void nRF24Emulator::txEnd() {
+  EmulatorHal::airEnd(this, true);
+
+  // acknowledgement is expected with auto-ACK enabled on pipe 0, unless the packet was sent without it
+  if((_txTag[0] & NRF24_EMULATOR_TAG_NOACK) || !(_regs[NRF24_REG_EN_AA] & NRF24_AA_P0_ON)) {
+    txDone(NULL, 0);
+    return;
+  }
+
+  // auto retransmit delay is measured from the end of packet
+  uint64_t now = EmulatorHal::getTimeNs();
+  _state = NRF24_EMULATOR_STATE_ACK_WAIT;
+  _listenTime = now + NRF24_EMULATOR_SETTLE_TIME;
+  _eventTime = now + 250000ULL * ((_regs[NRF24_REG_SETUP_RETR] >> 4) + 1);
+}
+
+void nRF24Emulator::txDone(const uint8_t* data, size_t len) {
+  _eventTime = UINT64_MAX;
+  _txRetry = false;
+  _arcCnt = _arc;
+  _txPackets++;
+  txRemove(0);
+  _status |= NRF24_TX_DS;
+
+  // payload received with acknowledgement goes to Rx FIFO as pipe 0
+  if((len > 0) && (_rxCount < NRF24_FIFO_DEPTH)) {
+    rxPush(0, data, len);
+  }
+
+  // next packet is sent if CE is still high
+  _state = NRF24_EMULATOR_STATE_IDLE;
+  updateMode();
+}
+
+void nRF24Emulator::ackStart() {
+  // first ACK payload queued for the pipe is sent with acknowledgement (only with dynamic payload length)
+  const uint8_t* data = NULL;
+  size_t len = 0;
+  if((_regs[NRF24_REG_FEATURE] & NRF24_ACK_PAY_ON) && (_regs[NRF24_REG_FEATURE] & NRF24_DPL_ON)) {
+    for(uint8_t i = 0; i < _txCount; i++) {
+      if(_txTag[i] == _ackPipe) {
+        data = _txFifo[i];
+        len = _txLen[i];
+        _ackSent[_ackPipe] = true;
+        break;
+      }
+    }
+  }
+
+  uint8_t addr[5];
+  _state = NRF24_EMULATOR_STATE_ACK_TX;
+  sendFrame(getAddress(_ackPipe, addr), _ackPid, false, data, len);
+}
+
+void nRF24Emulator::rxFrame(uint8_t pipe, uint8_t pid, bool noAck, const uint8_t* data, size_t len) {
+  // packet with the same ID and CRC as the previous one is a retransmission, it is acknowledged again but not stored
+  uint16_t sum = len;
+  for(size_t i = 0; i < len; i++) {
+    sum = (sum << 1 | sum >> 15) ^ data[i];
+  }
+  if((pid != _lastPid[pipe]) || (sum != _lastSum[pipe])) {
+    if((_capture == NULL) && (_rxCount == NRF24_FIFO_DEPTH)) {
+      // packet is dropped and not acknowledged, so the transmitter will retry
+      _rxOverflows++;
+      return;
+    }
+
+    // new packet also means the previous ACK payload was received
+    if(_ackSent[pipe]) {
+      for(uint8_t i = 0; i < _txCount; i++) {
+        if(_txTag[i] == pipe) {
+          txRemove(i);
+          break;
+        }
+      }
+      _ackSent[pipe] = false;
+      _status |= NRF24_TX_DS;
+    }
+    _lastPid[pipe] = pid;
+    _lastSum[pipe] = sum;
+    _rxPackets++;
+
+    // static payload length is taken from RX_PW_Px
+    bool dynamic = (_regs[NRF24_REG_FEATURE] & NRF24_DPL_ON) && (_regs[NRF24_REG_DYNPD] & (1 << pipe));
+    if(!dynamic) {
+      uint8_t width = _regs[NRF24_REG_RX_PW_P0 + pipe] & 0x3F;
+      len = (width < len) ? width : len;
+    }
+    if(_capture != NULL) {
+      if(_captured + len <= _captureSize) {
+        memcpy(_capture + _captured, data, len);
+        _captured += len;
+      }
+    } else {
+      rxPush(pipe, data, len);
+    }
+  }
+
+  if(!noAck && (_regs[NRF24_REG_EN_AA] & (1 << pipe))) {
+    _ackPipe = pipe;
+    _ackPid = pid;
+    _state = NRF24_EMULATOR_STATE_ACK_SETTLE;
+    _eventTime = EmulatorHal::getTimeNs() + NRF24_EMULATOR_SETTLE_TIME;
+  }
+}
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef _RADIOLIB_NRF24_EMULATOR_H
+#define _RADIOLIB_NRF24_EMULATOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_EMULATOR)
+
+#include "../../EmulatorHal.h"
+#include "nRF24.h"
+
+// emulated signal strength of received packets
+#define NRF24_EMULATOR_RSSI_DEFAULT                   -50
+
+// time needed to switch to Tx or Rx mode (Tstby2a) in ns
+#define NRF24_EMULATOR_SETTLE_TIME                    130000
+
+// internal states of the emulated Enhanced ShockBurst engine
+#define NRF24_EMULATOR_STATE_IDLE                     0x00
+#define NRF24_EMULATOR_STATE_RX                       0x01
+#define NRF24_EMULATOR_STATE_TX_SETTLE                0x02
+#define NRF24_EMULATOR_STATE_TX                       0x03
+#define NRF24_EMULATOR_STATE_ACK_WAIT                 0x04
+#define NRF24_EMULATOR_STATE_ACK_SETTLE               0x05
+#define NRF24_EMULATOR_STATE_ACK_TX                   0x06
+
+// Tx FIFO entry written by W_TX_PAYLOAD_NOACK
+#define NRF24_EMULATOR_TAG_NOACK                      0x80
+
+/*!
+  \class nRF24Emulator
+
+  \brief Register-level emulator of %nRF24L01+ chip, to be attached to EmulatorHal. Enhanced ShockBurst is emulated, including the SPI command set
+  with status byte, 3-deep Tx and Rx FIFOs, CE pin, IRQ pin with interrupt masking, automatic acknowledgement and retransmission with packet ID,
+  duplicate packet filtering, payloads without acknowledgement and ACK payloads, six receive pipes and time-on-air: every packet takes
+  130 us to settle, then the preamble, address, packet control field, payload and CRC are sent at the configured data rate.
+
+  Transmitter keeps sending packets from Tx FIFO for as long as CE is high, a CE pulse sends a single packet. When the maximum number of retransmits
+  is reached, the packet stays in Tx FIFO and transmission is halted until MAX_RT is cleared and CE is pulsed again.
+
+  Packets transmitted by one emulator are received by all other attached emulators that are in receive mode with matching configuration.
+  Received packets can be captured into a buffer instead of Rx FIFO, so that transmitter tests do not depend on the speed of the receiver.
+
+  Limitations: register values are not range-checked, analog functions (received power detector, continuous carrier) return fixed values,
+  power up takes no time, REUSE_TX_PL command and static payload length on the transmitter side are not emulated.
+*/
+class nRF24Emulator: public EmulatedChip {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param cs Chip select pin.
+
+      \param irq IRQ pin.
+
+      \param ce CE pin.
+    */
+    nRF24Emulator(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE ce);
+
+    /*!
+      \brief Resets all registers to their default values, flushes both FIFOs and aborts any ongoing operation, same as power cycle.
+    */
+    void reset();
+
+    /*!
+      \brief Sets signal strength reported for received packets.
+
+      \param rssi RSSI in dBm, only used for received power detector.
+    */
+    void setSignal(int16_t rssi);
+
+    /*!
+      \brief Sets the ratio of packets (including acknowledgements) that this chip fails to receive. Lost packets are chosen by a pseudo-random generator with fixed seed,
+      so results are repeatable.
+
+      \param percent Packet loss in %.
+    */
+    void setLoss(uint8_t percent);
+
+    /*!
+      \brief Captures payloads of the received packets into a buffer instead of Rx FIFO. Packets are still filtered and acknowledged
+      the same way as without capture, but Rx FIFO never gets full and RX_DR is not set.
+
+      \param buff Buffer to append the payloads to, or NULL to disable capture.
+
+      \param size Size of the buffer in bytes. Payloads that do not fit are dropped.
+    */
+    void setCapture(uint8_t* buff, size_t size);
+
+    /*!
+      \brief Gets the number of bytes captured since the last call to setCapture.
+
+      \returns Number of captured bytes.
+    */
+    size_t getCaptured() const { return(_captured); }
+
+    /*!
+      \brief Calculates time-on-air of a packet with the current configuration, without the settling time.
+
+      \param len Payload length in bytes.
+
+      \returns Time-on-air in ns.
+    */
+    uint64_t getTimeOnAir(size_t len);
+
+    /*!
+      \brief Gets the number of packets that were transmitted and acknowledged (or sent without acknowledgement) since reset.
+
+      \returns Number of transmitted packets.
+    */
+    uint32_t getTxPackets() const { return(_txPackets); }
+
+    /*!
+      \brief Gets the number of new packets received since reset (retransmitted duplicates are not counted).
+
+      \returns Number of received packets.
+    */
+    uint32_t getRxPackets() const { return(_rxPackets); }
+
+    /*!
+      \brief Gets the number of retransmissions since reset.
+
+      \returns Number of retransmissions.
+    */
+    uint32_t getRetransmits() const { return(_retransmits); }
+
+    /*!
+      \brief Gets the number of packets that reached maximum number of retransmits since reset.
+
+      \returns Number of lost packets.
+    */
+    uint32_t getLostPackets() const { return(_lostPackets); }
+
+    /*!
+      \brief Gets the number of received packets that were dropped (and not acknowledged) because Rx FIFO was full.
+
+      \returns Number of Rx FIFO overflows.
+    */
+    uint32_t getRxOverflows() const { return(_rxOverflows); }
+
+    // EmulatedChip methods
+
+    void spiTransfer(uint8_t* buff, size_t len);
+    bool readPin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS* value);
+    void writePin(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_STATUS value);
+    void update(uint64_t now);
+    uint64_t nextEvent() { return(_eventTime); }
+    void airStart(EmulatedChip* src, const EmulatorAir_t& air);
+    void airData(EmulatedChip* src, const uint8_t* data, size_t len);
+    void airEnd(EmulatedChip* src, bool crcOk);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    RADIOLIB_PIN_TYPE _irq, _ce;
+    bool _ceHigh;
+
+    // single-byte registers and the three 5-byte address registers
+    uint8_t _regs[0x20];
+    uint8_t _rxAddrP0[5], _rxAddrP1[5], _txAddr[5];
+
+    // interrupt flags in STATUS register
+    uint8_t _status;
+
+    // Tx FIFO entries are tagged with pipe number (ACK payloads) or no ACK flag
+    uint8_t _txFifo[NRF24_FIFO_DEPTH][NRF24_MAX_PACKET_LENGTH];
+    uint8_t _txLen[NRF24_FIFO_DEPTH], _txTag[NRF24_FIFO_DEPTH];
+    uint8_t _txCount;
+    uint8_t _rxFifo[NRF24_FIFO_DEPTH][NRF24_MAX_PACKET_LENGTH];
+    uint8_t _rxLen[NRF24_FIFO_DEPTH], _rxPipe[NRF24_FIFO_DEPTH];
+    uint8_t _rxCount;
+
+    // current state and the next scheduled event
+    uint8_t _state;
+    uint64_t _eventTime, _listenTime;
+
+    // transmitter state
+    uint8_t _txPid, _arc, _arcCnt, _plos;
+    bool _txRetry, _halted;
+
+    // receiver state, last packet ID and checksum for duplicate detection and whether ACK payload was sent on each pipe
+    uint8_t _lastPid[6];
+    uint16_t _lastSum[6];
+    bool _ackSent[6];
+    uint8_t _ackPipe, _ackPid;
+    bool _rpd;
+
+    // packet on the air, address, length, packet ID with no ACK flag and payload
+    uint8_t _airBuff[5 + 2 + NRF24_MAX_PACKET_LENGTH];
+    size_t _airLen;
+    EmulatedChip* _airSrc;
+    bool _airRx;
+
+    int16_t _rssi;
+    uint8_t _loss;
+    uint32_t _lossSeed;
+    uint8_t* _capture;
+    size_t _captureSize, _captured;
+
+    uint32_t _txPackets, _rxPackets, _retransmits, _lostPackets, _rxOverflows;
+
+    uint8_t getStatus();
+    uint8_t readRegister(uint8_t addr);
+    void writeRegister(uint8_t addr, const uint8_t* data, size_t len);
+    uint8_t* getAddress(uint8_t pipe, uint8_t* buff);
+    uint8_t getAddressWidth();
+    EmulatorAir_t getAir();
+    uint64_t getBitTime();
+    bool isLost();
+
+    void updateMode();
+    void txPush(const uint8_t* data, size_t len, uint8_t tag);
+    void txRemove(uint8_t index);
+    void rxPush(uint8_t pipe, const uint8_t* data, size_t len);
+    void sendFrame(const uint8_t* addr, uint8_t pid, bool noAck, const uint8_t* data, size_t len);
+    void txStart();
+    void txEnd();
+    void txDone(const uint8_t* data, size_t len);
+    void ackStart();
+    void rxFrame(uint8_t pipe, uint8_t pid, bool noAck, const uint8_t* data, size_t len);
+};
+
+#endif
+
+#endif
@@ -38,11 +38,17 @@ AX25Frame::AX25Frame(const char* destCallsign, uint8_t destSSID, const char* src
   // PID field
   this->protocolID = protocolID;
 
-  // info field
+  // info field, sendFrame will fail when it could not be allocated
   this->infoLen = infoLen;
+  #ifndef RADIOLIB_STATIC_ONLY
+    this->info = NULL;
+  #endif
   if(infoLen > 0) {
     #ifndef RADIOLIB_STATIC_ONLY
-      this->info = new uint8_t[infoLen];
+      this->info = (uint8_t*)BufferPool::alloc(infoLen);
+      if(this->info == NULL) {
+        return;
+      }
     #endif
     memcpy(this->info, info, infoLen);
   }
@@ -51,24 +57,20 @@ AX25Frame::AX25Frame(const char* destCallsign, uint8_t destSSID, const char* src
 AX25Frame::~AX25Frame() {
   #ifndef RADIOLIB_STATIC_ONLY
     // deallocate info field
-    if(infoLen > 0) {
-      delete[] this->info;
-    }
+    BufferPool::free(this->info);
 
-    // deallocate repeaters
+    // deallocate repeaters, all callsigns share the block of the first one
     if(this->numRepeaters > 0) {
-      for(uint8_t i = 0; i < this->numRepeaters; i++) {
-        delete[] this->repeaterCallsigns[i];
-      }
-      delete[] this->repeaterCallsigns;
-      delete[] this->repeaterSSIDs;
+      BufferPool::free(this->repeaterCallsigns[0]);
+      BufferPool::free(this->repeaterCallsigns);
+      BufferPool::free(this->repeaterSSIDs);
     }
   #endif
 }
 
 int16_t AX25Frame::setRepeaters(char** repeaterCallsigns, uint8_t* repeaterSSIDs, uint8_t numRepeaters) {
   // check number of repeaters
-  if((numRepeaters < 1) || (numRepeaters > 8)) {
+  if((numRepeaters < 1) || (numRepeaters > AX25_MAX_REPEATERS)) {
     return(ERR_INVALID_NUM_REPEATERS);
   }
 
@@ -85,17 +87,35 @@ int16_t AX25Frame::setRepeaters(char** repeaterCallsigns, uint8_t* repeaterSSIDs
 
   // create buffers
   #ifndef RADIOLIB_STATIC_ONLY
-    this->repeaterCallsigns = new char*[numRepeaters];
+    // release repeaters that were set previously
+    if(this->numRepeaters > 0) {
+      BufferPool::free(this->repeaterCallsigns[0]);
+      BufferPool::free(this->repeaterCallsigns);
+      BufferPool::free(this->repeaterSSIDs);
+      this->numRepeaters = 0;
+    }
+
+    // all callsigns share one block
+    this->repeaterCallsigns = (char**)BufferPool::alloc(numRepeaters*sizeof(char*));
+    char* callsigns = (char*)BufferPool::alloc(numRepeaters*(AX25_MAX_CALLSIGN_LEN + 1));
+    this->repeaterSSIDs = (uint8_t*)BufferPool::alloc(numRepeaters);
+    if((this->repeaterCallsigns == NULL) || (callsigns == NULL) || (this->repeaterSSIDs == NULL)) {
+      BufferPool::free(this->repeaterCallsigns);
+      BufferPool::free(callsigns);
+      BufferPool::free(this->repeaterSSIDs);
+      this->repeaterCallsigns = NULL;
+      this->repeaterSSIDs = NULL;
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
     for(uint8_t i = 0; i < numRepeaters; i++) {
-      this->repeaterCallsigns[i] = new char[strlen(repeaterCallsigns[i])];
+      this->repeaterCallsigns[i] = callsigns + i*(AX25_MAX_CALLSIGN_LEN + 1);
     }
-    this->repeaterSSIDs = new uint8_t[numRepeaters];
   #endif
 
   // copy data
   this->numRepeaters = numRepeaters;
   for(uint8_t i = 0; i < numRepeaters; i++) {
-    memcpy(this->repeaterCallsigns[i], repeaterCallsigns[i], strlen(repeaterCallsigns[i]));
+    strcpy(this->repeaterCallsigns[i], repeaterCallsigns[i]);
   }
   memcpy(this->repeaterSSIDs, repeaterSSIDs, numRepeaters);
 
@@ -164,8 +184,13 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
     return(ERR_INVALID_CALLSIGN);
   }
 
-  // check repeater configuration
   #ifndef RADIOLIB_STATIC_ONLY
+    // check info field was allocated
+    if((frame->infoLen > 0) && (frame->info == NULL)) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
+
+    // check repeater configuration
     if(!(((frame->repeaterCallsigns == NULL) && (frame->repeaterSSIDs == NULL) && (frame->numRepeaters == 0)) ||
          ((frame->repeaterCallsigns != NULL) && (frame->repeaterSSIDs != NULL) && (frame->numRepeaters != 0)))) {
       return(ERR_INVALID_NUM_REPEATERS);
@@ -177,48 +202,47 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
     }
   #endif
 
-  // calculate frame length without FCS (destination address, source address, repeater addresses, control, PID, info)
-  size_t frameBuffLen = ((2 + frame->numRepeaters)*(AX25_MAX_CALLSIGN_LEN + 1)) + 1 + 1 + frame->infoLen;
-  // create frame buffer without preamble, start or stop flags
-  #ifndef RADIOLIB_STATIC_ONLY
-    uint8_t* frameBuff = new uint8_t[frameBuffLen + 2];
-  #else
-    uint8_t frameBuff[RADIOLIB_STATIC_ARRAY_SIZE];
-  #endif
-  uint8_t* frameBuffPtr = frameBuff;
+  // check number of repeaters, address field has to fit into header buffer
+  if(frame->numRepeaters > AX25_MAX_REPEATERS) {
+    return(ERR_INVALID_NUM_REPEATERS);
+  }
+
+  // build header (address, control and PID fields) on stack, info field is used in place
+  uint8_t header[(2 + AX25_MAX_REPEATERS)*(AX25_MAX_CALLSIGN_LEN + 1) + 1 + 1];
+  uint8_t* headerPtr = header;
 
   // set destination callsign - all address field bytes are shifted by one bit to make room for HDLC address extension bit
-  memset(frameBuffPtr, ' ' << 1, AX25_MAX_CALLSIGN_LEN);
+  memset(headerPtr, ' ' << 1, AX25_MAX_CALLSIGN_LEN);
   for(uint8_t i = 0; i < strlen(frame->destCallsign); i++) {
-    *(frameBuffPtr + i) = frame->destCallsign[i] << 1;
+    *(headerPtr + i) = frame->destCallsign[i] << 1;
   }
-  frameBuffPtr += AX25_MAX_CALLSIGN_LEN;
+  headerPtr += AX25_MAX_CALLSIGN_LEN;
 
   // set destination SSID
-  *(frameBuffPtr++) = AX25_SSID_COMMAND_DEST | AX25_SSID_RESERVED_BITS | (frame->destSSID & 0x0F) << 1 | AX25_SSID_HDLC_EXTENSION_CONTINUE;
+  *(headerPtr++) = AX25_SSID_COMMAND_DEST | AX25_SSID_RESERVED_BITS | (frame->destSSID & 0x0F) << 1 | AX25_SSID_HDLC_EXTENSION_CONTINUE;
 
   // set source callsign - all address field bytes are shifted by one bit to make room for HDLC address extension bit
-  memset(frameBuffPtr, ' ' << 1, AX25_MAX_CALLSIGN_LEN);
+  memset(headerPtr, ' ' << 1, AX25_MAX_CALLSIGN_LEN);
   for(uint8_t i = 0; i < strlen(frame->srcCallsign); i++) {
-    *(frameBuffPtr + i) = frame->srcCallsign[i] << 1;
+    *(headerPtr + i) = frame->srcCallsign[i] << 1;
   }
-  frameBuffPtr += AX25_MAX_CALLSIGN_LEN;
+  headerPtr += AX25_MAX_CALLSIGN_LEN;
 
   // set source SSID
-  *(frameBuffPtr++) = AX25_SSID_COMMAND_SOURCE | AX25_SSID_RESERVED_BITS | (frame->srcSSID & 0x0F) << 1 | AX25_SSID_HDLC_EXTENSION_END;
+  *(headerPtr++) = AX25_SSID_COMMAND_SOURCE | AX25_SSID_RESERVED_BITS | (frame->srcSSID & 0x0F) << 1 | AX25_SSID_HDLC_EXTENSION_END;
 
   // set repeater callsigns
   for(uint16_t i = 0; i < frame->numRepeaters; i++) {
-    memset(frameBuffPtr, ' ' << 1, AX25_MAX_CALLSIGN_LEN);
+    memset(headerPtr, ' ' << 1, AX25_MAX_CALLSIGN_LEN);
     for(uint8_t j = 0; j < strlen(frame->repeaterCallsigns[i]); j++) {
-      *(frameBuffPtr + j) = frame->repeaterCallsigns[i][j] << 1;
+      *(headerPtr + j) = frame->repeaterCallsigns[i][j] << 1;
     }
-    frameBuffPtr += AX25_MAX_CALLSIGN_LEN;
-    *(frameBuffPtr++) = AX25_SSID_HAS_NOT_BEEN_REPEATED | AX25_SSID_RESERVED_BITS | (frame->repeaterSSIDs[i] & 0x0F) << 1 | AX25_SSID_HDLC_EXTENSION_CONTINUE;
+    headerPtr += AX25_MAX_CALLSIGN_LEN;
+    *(headerPtr++) = AX25_SSID_HAS_NOT_BEEN_REPEATED | AX25_SSID_RESERVED_BITS | (frame->repeaterSSIDs[i] & 0x0F) << 1 | AX25_SSID_HDLC_EXTENSION_CONTINUE;
   }
 
   // set HDLC extension end bit
-  *frameBuffPtr |= AX25_SSID_HDLC_EXTENSION_END;
+  *headerPtr |= AX25_SSID_HDLC_EXTENSION_END;
 
   // set sequence numbers of the frames that have it
   uint8_t controlField = frame->control;
@@ -232,75 +256,71 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
   }
 
   // set control field
-  *(frameBuffPtr++) = controlField;
+  *(headerPtr++) = controlField;
 
   // set PID field of the frames that have it
   if(frame->protocolID != 0x00) {
-    *(frameBuffPtr++) = frame->protocolID;
+    *(headerPtr++) = frame->protocolID;
   }
 
-  // set info field of the frames that have it
-  if(frame->infoLen > 0) {
-    memcpy(frameBuffPtr, frame->info, frame->infoLen);
-    frameBuffPtr += frame->infoLen;
-  }
-
-  // flip bit order
-  for(size_t i = 0; i < frameBuffLen; i++) {
-    frameBuff[i] = flipBits(frameBuff[i]);
-  }
-
-  // calculate FCS
-  uint16_t fcs = getFrameCheckSequence(frameBuff, frameBuffLen);
-  *(frameBuffPtr++) = (uint8_t)((fcs >> 8) & 0xFF);
-  *(frameBuffPtr++) = (uint8_t)(fcs & 0xFF);
+  // calculate FCS, it is sent MSB first while the rest of the frame is sent LSB first
+  uint8_t fcsBuff[2];
+  TxSegment_t segs[] = { { header, (size_t)(headerPtr - header) }, { frame->info, frame->infoLen }, { fcsBuff, 0 } };
+  uint16_t fcs = getFrameCheckSequence(segs, 2);
+  fcsBuff[0] = flipBits((fcs >> 8) & 0xFF);
+  fcsBuff[1] = flipBits(fcs & 0xFF);
+  segs[2].len = 2;
 
   // prepare buffer for the final frame (stuffed, with added preamble + flags and NRZI-encoded)
+  // worst-case scenario: sequence of 1s, will have 120% of the original length, stuffed frame also includes both flags
+  size_t stuffedFrameBuffSize = _preambleLen + 1 + (6*PhysicalLayer::getSegmentsLength(segs, 3))/5 + 3;
   #ifndef RADIOLIB_STATIC_ONLY
-    // worst-case scenario: sequence of 1s, will have 120% of the original length, stuffed frame also includes both flags
-    uint8_t* stuffedFrameBuff = new uint8_t[_preambleLen + 1 + (6*frameBuffLen)/5 + 2];
+    uint8_t* stuffedFrameBuff = (uint8_t*)BufferPool::alloc(stuffedFrameBuffSize);
+    if(stuffedFrameBuff == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #else
+    if(stuffedFrameBuffSize > RADIOLIB_STATIC_ARRAY_SIZE) {
+      return(ERR_PACKET_TOO_LONG);
+    }
     uint8_t stuffedFrameBuff[RADIOLIB_STATIC_ARRAY_SIZE];
   #endif
 
   // stuff bits (skip preamble and both flags)
   uint16_t stuffedFrameBuffLenBits = 8*(_preambleLen + 1);
   uint8_t count = 0;
-  for(uint16_t i = 0; i < frameBuffLen + 2; i++) {
-    for(int8_t shift = 7; shift >= 0; shift--) {
-      uint16_t stuffedFrameBuffPos = stuffedFrameBuffLenBits + 7 - 2*(stuffedFrameBuffLenBits%8);
-      if((frameBuff[i] >> shift) & 0x01) {
-        // copy 1 and increment counter
-        SET_BIT_IN_ARRAY(stuffedFrameBuff, stuffedFrameBuffPos);
-        stuffedFrameBuffLenBits++;
-        count++;
-
-        // check 5 consecutive 1s
-        if(count == 5) {
-          // get the new position in stuffed frame
-          stuffedFrameBuffPos = stuffedFrameBuffLenBits + 7 - 2*(stuffedFrameBuffLenBits%8);
-
-          // insert 0 and reset counter
+  for(uint8_t n = 0; n < 3; n++) {
+    for(size_t i = 0; i < segs[n].len; i++) {
+      for(uint8_t shift = 0; shift < 8; shift++) {
+        uint16_t stuffedFrameBuffPos = stuffedFrameBuffLenBits + 7 - 2*(stuffedFrameBuffLenBits%8);
+        if((segs[n].data[i] >> shift) & 0x01) {
+          // copy 1 and increment counter
+          SET_BIT_IN_ARRAY(stuffedFrameBuff, stuffedFrameBuffPos);
+          stuffedFrameBuffLenBits++;
+          count++;
+
+          // check 5 consecutive 1s
+          if(count == 5) {
+            // get the new position in stuffed frame
+            stuffedFrameBuffPos = stuffedFrameBuffLenBits + 7 - 2*(stuffedFrameBuffLenBits%8);
+
+            // insert 0 and reset counter
+            CLEAR_BIT_IN_ARRAY(stuffedFrameBuff, stuffedFrameBuffPos);
+            stuffedFrameBuffLenBits++;
+            count = 0;
+          }
+
+        } else {
+          // copy 0 and reset counter
           CLEAR_BIT_IN_ARRAY(stuffedFrameBuff, stuffedFrameBuffPos);
           stuffedFrameBuffLenBits++;
           count = 0;
         }
 
-      } else {
-        // copy 0 and reset counter
-        CLEAR_BIT_IN_ARRAY(stuffedFrameBuff, stuffedFrameBuffPos);
-        stuffedFrameBuffLenBits++;
-        count = 0;
       }
-
     }
   }
 
-  // deallocate memory
-  #ifndef RADIOLIB_STATIC_ONLY
-    delete[] frameBuff;
-  #endif
-
   // set preamble bytes and start flag field
   for(uint16_t i = 0; i < _preambleLen + 1; i++) {
     stuffedFrameBuff[i] = AX25_FLAG;
@@ -353,13 +373,13 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
 
       // check each bit
       for(uint16_t mask = 0x80; mask >= 0x01; mask >>= 1) {
-        uint32_t start = micros();
+        uint32_t start = Module::micros();
         if(stuffedFrameBuff[i] & mask) {
           _audio->tone(AX25_AFSK_MARK, false);
         } else {
           _audio->tone(AX25_AFSK_SPACE, false);
         }
-        while(micros() - start < 833) {
+        while(Module::micros() - start < 833) {
           yield();
         }
       }
@@ -371,7 +391,7 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
 
   // deallocate memory
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] stuffedFrameBuff;
+    BufferPool::free(stuffedFrameBuff);
   #endif
 
   return(state);
@@ -383,17 +403,20 @@ int16_t AX25Client::sendFrame(AX25Frame* frame) {
   Licensed under Creative Commons Attribution-ShareAlike 4.0 International
   https://creativecommons.org/licenses/by-sa/4.0/
 */
-uint16_t AX25Client::getFrameCheckSequence(uint8_t* buff, size_t len) {
+uint16_t AX25Client::getFrameCheckSequence(const TxSegment_t* segs, size_t numSegs) {
   uint8_t outBit = 0;
   uint16_t mask = 0x0000;
   uint16_t shiftReg = CRC_CCITT_INIT;
 
-  for(size_t i = 0; i < len; i++) {
-    for(uint8_t b = 0x80; b > 0x00; b /= 2) {
-      outBit = (shiftReg & 0x01) ? 0x01 : 0x00;
-      shiftReg >>= 1;
-      mask = XOR((buff[i] & b), outBit) ? CRC_CCITT_POLY_REVERSED : 0x0000;
-      shiftReg ^= mask;
+  // bytes are processed LSB first, in the order they are transmitted
+  for(size_t n = 0; n < numSegs; n++) {
+    for(size_t i = 0; i < segs[n].len; i++) {
+      for(uint8_t shift = 0; shift < 8; shift++) {
+        outBit = (shiftReg & 0x01) ? 0x01 : 0x00;
+        shiftReg >>= 1;
+        mask = XOR((segs[n].data[i] >> shift) & 0x01, outBit) ? CRC_CCITT_POLY_REVERSED : 0x0000;
+        shiftReg ^= mask;
+      }
     }
   }
 
@@ -2,6 +2,7 @@
 #define _RADIOLIB_AX25_H
 
 #include "../../TypeDef.h"
+#include "../../BufferPool.h"
 #include "../PhysicalLayer/PhysicalLayer.h"
 #include "../AFSK/AFSK.h"
 
@@ -20,6 +21,9 @@
 // maximum callsign length in bytes
 #define AX25_MAX_CALLSIGN_LEN                         6
 
+// maximum number of repeaters
+#define AX25_MAX_REPEATERS                            8
+
 // flag field                                                         MSB   LSB   DESCRIPTION
 #define AX25_FLAG                                     0b01111110  //  7     0     AX.25 frame start/end flag
 
@@ -158,12 +162,12 @@ class AX25Frame {
       /*!
         \brief Array of repeater callsigns.
       */
-      char repeaterCallsigns[8][AX25_MAX_CALLSIGN_LEN + 1];
+      char repeaterCallsigns[AX25_MAX_REPEATERS][AX25_MAX_CALLSIGN_LEN + 1];
 
       /*!
         \brief Array of repeater SSIDs.
       */
-      uint8_t repeaterSSIDs[8];
+      uint8_t repeaterSSIDs[AX25_MAX_REPEATERS];
     #endif
 
     /*!
@@ -322,7 +326,7 @@ class AX25Client {
     uint8_t _srcSSID;
     uint16_t _preambleLen;
 
-    uint16_t getFrameCheckSequence(uint8_t* buff, size_t len);
+    uint16_t getFrameCheckSequence(const TxSegment_t* segs, size_t numSegs);
     uint8_t flipBits(uint8_t b);
     uint16_t flipBits16(uint16_t i);
 };
@@ -10,139 +10,77 @@ int16_t HTTPClient::get(String& url, String& response) {
 }
 
 int16_t HTTPClient::get(const char* url, String& response) {
-  // get the host address and endpoint
-  const char* httpPrefix = strstr(url, "http://");
-  char* endpoint;
-  char* host;
-  if(httpPrefix != NULL) {
-    // find the host string
-    const char* hostStart = strchr(url, '/');
-    hostStart = strchr(hostStart + 1, '/');
-    const char* hostEnd = strchr(hostStart + 1, '/');
-    host = new char[hostEnd - hostStart];
-    strncpy(host, hostStart + 1, hostEnd - hostStart - 1);
-    host[hostEnd - hostStart - 1] = '\0';
-
-    // find the endpoint string
-    endpoint = new char[url + strlen(url) - hostEnd + 1];
-    strcpy(endpoint, hostEnd);
-  } else {
-    // find the host string
-    const char* hostEnd = strchr(url, '/');
-    host = new char[hostEnd - url + 1];
-    strncpy(host, url, hostEnd - url);
-    host[hostEnd - url] = '\0';
-
-    // find the endpoint string
-    endpoint = new char[url + strlen(url) - hostEnd + 1];
-    strcpy(endpoint, hostEnd);
+  // get the host address and endpoint (the rest of the URL, so it does not have to be copied)
+  const char* hostStart = url;
+  if(strstr(url, "http://") != NULL) {
+    hostStart = strchr(url, '/');
+    hostStart = strchr(hostStart + 1, '/') + 1;
   }
+  const char* endpoint = strchr(hostStart, '/');
+  size_t hostLen = endpoint - hostStart;
+  char* host = (char*)BufferPool::alloc(hostLen + 1);
+  if(host == NULL) {
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
+  memcpy(host, hostStart, hostLen);
+  host[hostLen] = '\0';
 
   // build the GET request
-  char* request = new char[strlen(endpoint) + strlen(host) + 25 + 1];
+  char* request = (char*)BufferPool::alloc(strlen(endpoint) + hostLen + 25 + 1);
+  if(request == NULL) {
+    BufferPool::free(host);
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
   strcpy(request, "GET ");
   strcat(request, endpoint);
   strcat(request, " HTTP/1.1\r\nHost: ");
   strcat(request, host);
   strcat(request, "\r\n\r\n");
 
-  delete[] endpoint;
-
   // create TCP connection
   int16_t state = _tl->openTransportConnection(host, "TCP", _port);
-  delete[] host;
+  BufferPool::free(host);
   if(state != ERR_NONE) {
-    delete[] request;
+    BufferPool::free(request);
     return(state);
   }
 
   // send the GET request
   state = _tl->send(request);
-  delete[] request;
+  BufferPool::free(request);
   if(state != ERR_NONE) {
     return(state);
   }
 
   //delay(1000);
 
-  // get the response length
-  size_t numBytes = _tl->getNumBytes();
-  if(numBytes == 0) {
-    return(ERR_RESPONSE_MALFORMED_AT);
-  }
-
-  // read the response
-  char* raw = new char[numBytes + 1];
-  size_t rawLength = _tl->receive((uint8_t*)raw, numBytes);
-  if(rawLength == 0) {
-    delete[] raw;
-    return(ERR_RESPONSE_MALFORMED);
-  }
-
-  // close the tl connection
-  state = _tl->closeTransportConnection();
-  if(state != ERR_NONE) {
-    delete[] raw;
-    return(state);
-  }
-
-  // get the response body
-  char* responseStart = strstr(raw, "\r\n");
-  if(responseStart == NULL) {
-    delete[] raw;
-    return(ERR_RESPONSE_MALFORMED);
-  }
-  char* responseStr = new char[raw + rawLength - responseStart - 1 + 1];
-  strncpy(responseStr, responseStart + 2, raw + rawLength - responseStart - 1);
-  responseStr[raw + rawLength - responseStart - 2] = '\0';
-  response = String(responseStr);
-  delete[] responseStr;
-
-  // return the HTTP status code
-  char* statusStart = strchr(raw, ' ');
-  delete[] raw;
-  if(statusStart == NULL) {
-    return(ERR_RESPONSE_MALFORMED);
-  }
-  char statusStr[4];
-  strncpy(statusStr, statusStart + 1, 3);
-  statusStr[3] = 0x00;
-  return(atoi(statusStr));
+  return(readResponse(response));
 }
 
 int16_t HTTPClient::post(const char* url, const char* content, String& response, const char* contentType) {
-  // get the host address and endpoint
-  const char* httpPrefix = strstr(url, "http://");
-  char* endpoint;
-  char* host;
-  if(httpPrefix != NULL) {
-    // find the host string
-    const char* hostStart = strchr(url, '/');
-    hostStart = strchr(hostStart + 1, '/');
-    const char* hostEnd = strchr(hostStart + 1, '/');
-    host = new char[hostEnd - hostStart];
-    strncpy(host, hostStart + 1, hostEnd - hostStart - 1);
-    host[hostEnd - hostStart - 1] = '\0';
-
-    // find the endpoint string
-    endpoint = new char[url + strlen(url) - hostEnd + 1];
-    strcpy(endpoint, hostEnd);
-    } else {
-    // find the host string
-    const char* hostEnd = strchr(url, '/');
-    host = new char[hostEnd - url + 1];
-    strncpy(host, url, hostEnd - url);
-    host[hostEnd - url] = '\0';
-
-    // find the endpoint string
-    endpoint = new char[url + strlen(url) - hostEnd + 1];
-    strcpy(endpoint, hostEnd);
+  // get the host address and endpoint (the rest of the URL, so it does not have to be copied)
+  const char* hostStart = url;
+  if(strstr(url, "http://") != NULL) {
+    hostStart = strchr(url, '/');
+    hostStart = strchr(hostStart + 1, '/') + 1;
   }
+  const char* endpoint = strchr(hostStart, '/');
+  size_t hostLen = endpoint - hostStart;
+  char* host = (char*)BufferPool::alloc(hostLen + 1);
+  if(host == NULL) {
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
+  memcpy(host, hostStart, hostLen);
+  host[hostLen] = '\0';
 
   // build the POST request
   char contentLengthStr[12];
   sprintf(contentLengthStr, "%d", strlen(content));
-  char* request = new char[strlen(endpoint) + strlen(host) + strlen(contentType) + strlen(contentLengthStr) + strlen(content) + 64 + 1];
+  char* request = (char*)BufferPool::alloc(strlen(endpoint) + hostLen + strlen(contentType) + strlen(contentLengthStr) + strlen(content) + 64 + 1);
+  if(request == NULL) {
+    BufferPool::free(host);
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
   strcpy(request, "POST ");
   strcat(request, endpoint);
   strcat(request, " HTTP/1.1\r\nHost: ");
@@ -155,64 +93,62 @@ int16_t HTTPClient::post(const char* url, const char* content, String& response,
   strcat(request, content);
   strcat(request, "\r\n\r\n");
 
-  delete[] endpoint;
-
   // create TCP connection
   int16_t state = _tl->openTransportConnection(host, "TCP", _port);
-  delete[] host;
+  BufferPool::free(host);
   if(state != ERR_NONE) {
-    delete[] request;
+    BufferPool::free(request);
     return(state);
   }
 
   // send the POST request
   state = _tl->send(request);
-  delete[] request;
+  BufferPool::free(request);
   if(state != ERR_NONE) {
     return(state);
   }
 
+  return(readResponse(response));
+}
+
+int16_t HTTPClient::readResponse(String& response) {
   // get the response length
   size_t numBytes = _tl->getNumBytes();
   if(numBytes == 0) {
     return(ERR_RESPONSE_MALFORMED_AT);
   }
 
-  // read the response
-  char* raw = new char[numBytes];
+  // read the response, with space for null terminator
+  char* raw = (char*)BufferPool::alloc(numBytes + 1);
+  if(raw == NULL) {
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
   size_t rawLength = _tl->receive((uint8_t*)raw, numBytes);
   if(rawLength == 0) {
-    delete[] raw;
+    BufferPool::free(raw);
     return(ERR_RESPONSE_MALFORMED);
   }
+  raw[rawLength] = '\0';
 
   // close the tl connection
-  state = _tl->closeTransportConnection();
+  int16_t state = _tl->closeTransportConnection();
   if(state != ERR_NONE) {
-    delete[] raw;
+    BufferPool::free(raw);
     return(state);
   }
 
-  // get the response body
+  // get the response body and the HTTP status code
   char* responseStart = strstr(raw, "\r\n");
-  if(responseStart == NULL) {
-    delete[] raw;
-    return(ERR_RESPONSE_MALFORMED);
-  }
-  char* responseStr = new char[raw + rawLength - responseStart - 1];
-  strncpy(responseStr, responseStart + 2, raw + rawLength - responseStart - 1);
-  responseStr[raw + rawLength - responseStart - 2] = 0x00;
-  response = String(responseStr);
-  delete[] responseStr;
-
-  // return the HTTP status code
   char* statusStart = strchr(raw, ' ');
-  delete[] raw;
-  if(statusStart == NULL) {
+  if((responseStart == NULL) || (statusStart == NULL)) {
+    BufferPool::free(raw);
     return(ERR_RESPONSE_MALFORMED);
   }
+  response = String(responseStart + 2);
+
   char statusStr[4];
   strncpy(statusStr, statusStart + 1, 3);
   statusStr[3] = 0x00;
+  BufferPool::free(raw);
   return(atoi(statusStr));
 }
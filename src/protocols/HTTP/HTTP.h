@@ -2,6 +2,7 @@
 #define _RADIOLIB_HTTP_H
 
 #include "../../TypeDef.h"
+#include "../../BufferPool.h"
 #include "../TransportLayer/TransportLayer.h"
 
 
@@ -64,6 +65,8 @@ class HTTPClient {
     TransportLayer* _tl;
 
     uint16_t _port;
+
+    int16_t readResponse(String& response);
 };
 
 #endif
@@ -31,13 +31,13 @@ size_t HellClient::printGlyph(uint8_t* buff) {
   // print the character
   for(uint8_t mask = 0x40; mask >= 0x01; mask >>= 1) {
     for(int8_t i = HELL_FONT_HEIGHT - 1; i >= 0; i--) {
-        uint32_t start = micros();
+        uint32_t start = Module::micros();
         if(buff[i] & mask) {
           transmitDirect(_base, _baseHz);
         } else {
           standby();
         }
-        while(micros() - start < _pixelDuration);
+        while(Module::micros() - start < _pixelDuration);
     }
   }
 
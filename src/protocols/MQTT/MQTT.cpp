@@ -30,7 +30,10 @@ int16_t MQTTClient::connect(const char* host, const char* clientId, const char*
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t packet[256];
   #else
-    uint8_t* packet = new uint8_t[1 + encodedBytes + remainingLength];
+    uint8_t* packet = (uint8_t*)BufferPool::alloc(1 + encodedBytes + remainingLength);
+    if(packet == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
 
   // fixed header
@@ -102,7 +105,7 @@ int16_t MQTTClient::connect(const char* host, const char* clientId, const char*
   int16_t state = _tl->openTransportConnection(host, "TCP", _port, keepAlive);
   if(state != ERR_NONE) {
     #ifndef RADIOLIB_STATIC_ONLY
-      delete[] packet;
+      BufferPool::free(packet);
     #endif
     return(state);
   }
@@ -110,7 +113,7 @@ int16_t MQTTClient::connect(const char* host, const char* clientId, const char*
   // send MQTT packet
   state = _tl->send(packet, 1 + encodedBytes + remainingLength);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] packet;
+    BufferPool::free(packet);
   #endif
   if(state != ERR_NONE) {
     return(state);
@@ -123,23 +126,13 @@ int16_t MQTTClient::connect(const char* host, const char* clientId, const char*
   }
 
   // read the response
-  #ifdef RADIOLIB_STATIC_ONLY
-    uint8_t response[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* response = new uint8_t[numBytes];
-  #endif
+  uint8_t response[4];
   _tl->receive(response, numBytes);
   if((response[0] == MQTT_CONNACK << 4) && (response[1] == 2)) {
     uint8_t returnCode = response[3];
-    #ifndef RADIOLIB_STATIC_ONLY
-      delete[] response;
-    #endif
     return(returnCode);
   }
 
-  #ifndef RADIOLIB_STATIC_ONLY
-    delete[] response;
-  #endif
   return(ERR_RESPONSE_MALFORMED);
 }
 
@@ -177,7 +170,10 @@ int16_t MQTTClient::publish(const char* topic, const char* message) {
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t packet[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* packet = new uint8_t[1 + encodedBytes + remainingLength];
+    uint8_t* packet = (uint8_t*)BufferPool::alloc(1 + encodedBytes + remainingLength);
+    if(packet == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
 
   // fixed header
@@ -202,7 +198,7 @@ int16_t MQTTClient::publish(const char* topic, const char* message) {
   // send MQTT packet
   int16_t state = _tl->send(packet, 1 + encodedBytes + remainingLength);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] packet;
+    BufferPool::free(packet);
   #endif
   return(state);
 
@@ -220,7 +216,10 @@ int16_t MQTTClient::subscribe(const char* topicFilter) {
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t packet[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* packet = new uint8_t[1 + encodedBytes + remainingLength];
+    uint8_t* packet = (uint8_t*)BufferPool::alloc(1 + encodedBytes + remainingLength);
+    if(packet == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
 
   // fixed header
@@ -245,7 +244,7 @@ int16_t MQTTClient::subscribe(const char* topicFilter) {
   // send MQTT packet
   int16_t state = _tl->send(packet, 1 + encodedBytes + remainingLength);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] packet;
+    BufferPool::free(packet);
   #endif
   if(state != ERR_NONE) {
     return(state);
@@ -258,28 +257,18 @@ int16_t MQTTClient::subscribe(const char* topicFilter) {
   }
 
   // read the response
-  #ifdef RADIOLIB_STATIC_ONLY
-    uint8_t response[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* response = new uint8_t[numBytes];
-  #endif
+  uint8_t response[5];
   _tl->receive(response, numBytes);
   if((response[0] == MQTT_SUBACK << 4) && (response[1] == 3)) {
     // check packet ID
     uint16_t receivedId = response[3] | response[2] << 8;
     int16_t returnCode = response[4];
-    #ifndef RADIOLIB_STATIC_ONLY
-      delete[] response;
-    #endif
     if(receivedId != packetId) {
       return(ERR_MQTT_UNEXPECTED_PACKET_ID);
     }
     return(returnCode);
   }
 
-  #ifndef RADIOLIB_STATIC_ONLY
-    delete[] response;
-  #endif
   return(ERR_RESPONSE_MALFORMED);
 }
 
@@ -294,7 +283,10 @@ int16_t MQTTClient::unsubscribe(const char* topicFilter) {
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t packet[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    uint8_t* packet = new uint8_t[1 + encodedBytes + remainingLength];
+    uint8_t* packet = (uint8_t*)BufferPool::alloc(1 + encodedBytes + remainingLength);
+    if(packet == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
 
   // fixed header
@@ -318,7 +310,7 @@ int16_t MQTTClient::unsubscribe(const char* topicFilter) {
   // send MQTT packet
   int16_t state = _tl->send(packet, 1 + encodedBytes + remainingLength);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] packet;
+    BufferPool::free(packet);
   #endif
   if(state != ERR_NONE) {
     return(state);
@@ -331,27 +323,17 @@ int16_t MQTTClient::unsubscribe(const char* topicFilter) {
   }
 
   // read the response
-  #ifdef RADIOLIB_STATIC_ONLY
-    uint8_t response[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* response = new uint8_t[numBytes];
-  #endif
+  uint8_t response[4];
   _tl->receive(response, numBytes);
   if((response[0] == MQTT_UNSUBACK << 4) && (response[1] == 2)) {
     // check packet ID
     uint16_t receivedId = response[3] | response[2] << 8;
-    #ifndef RADIOLIB_STATIC_ONLY
-      delete[] response;
-    #endif
     if(receivedId != packetId) {
       return(ERR_MQTT_UNEXPECTED_PACKET_ID);
     }
     return(ERR_NONE);
   }
 
-  #ifndef RADIOLIB_STATIC_ONLY
-    delete[] response;
-  #endif
   return(ERR_RESPONSE_MALFORMED);
 }
 
@@ -376,22 +358,12 @@ int16_t MQTTClient::ping() {
   }
 
   // read the response
-  #ifdef RADIOLIB_STATIC_ONLY
-    uint8_t response[RADIOLIB_STATIC_ARRAY_SIZE];
-  #else
-    uint8_t* response = new uint8_t[numBytes];
-  #endif
+  uint8_t response[2];
   _tl->receive(response, numBytes);
   if((response[0] == MQTT_PINGRESP << 4) && (response[1] == 0)) {
-    #ifndef RADIOLIB_STATIC_ONLY
-      delete[] response;
-    #endif
     return(ERR_NONE);
   }
 
-  #ifndef RADIOLIB_STATIC_ONLY
-    delete[] response;
-  #endif
   return(ERR_RESPONSE_MALFORMED);
 }
 
@@ -408,36 +380,47 @@ int16_t MQTTClient::check(void (*func)(const char*, const char*)) {
     return(ERR_MQTT_NO_NEW_PACKET_AVAILABLE);
   }
 
-  // read the PUBLISH packet from server
-  uint8_t* dataIn = new uint8_t[numBytes];
+  // read the PUBLISH packet from server, with space to terminate the message
+  #ifdef RADIOLIB_STATIC_ONLY
+    uint8_t dataIn[RADIOLIB_STATIC_ARRAY_SIZE + 1];
+    if(numBytes > RADIOLIB_STATIC_ARRAY_SIZE) {
+      numBytes = RADIOLIB_STATIC_ARRAY_SIZE;
+    }
+  #else
+    uint8_t* dataIn = (uint8_t*)BufferPool::alloc(numBytes + 1);
+    if(dataIn == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
+  #endif
   _tl->receive(dataIn, numBytes);
+  state = ERR_MQTT_NO_NEW_PACKET_AVAILABLE;
   if(dataIn[0] == MQTT_PUBLISH << 4) {
     // TODO: properly decode remaining length
     uint8_t remainingLength = dataIn[1];
-
-    // get the topic
     size_t topicLength = dataIn[3] | dataIn[2] << 8;
-    char* topic = new char[topicLength + 1];
-    memcpy(topic, dataIn + 4, topicLength);
-    topic[topicLength] = 0x00;
-
-    // get the message
-    size_t messageLength = remainingLength - topicLength - 2;
-    char* message = new char[messageLength + 1];
-    memcpy(message, dataIn + 4 + topicLength, messageLength);
-    message[messageLength] = 0x00;
-
-    // execute the callback function provided by user
-    func(topic, message);
-
-    delete[] topic;
-    delete[] message;
-    delete[] dataIn;
-    return(ERR_NONE);
+    if((topicLength + 2 > remainingLength) || ((size_t)remainingLength + 2 > numBytes)) {
+      state = ERR_RESPONSE_MALFORMED;
+
+    } else {
+      // terminate topic and message in place: the topic is moved one byte back over the low byte of its length
+      char* topic = (char*)dataIn + 3;
+      memmove(topic, dataIn + 4, topicLength);
+      topic[topicLength] = 0x00;
+
+      size_t messageLength = remainingLength - topicLength - 2;
+      char* message = (char*)dataIn + 4 + topicLength;
+      message[messageLength] = 0x00;
+
+      // execute the callback function provided by user
+      func(topic, message);
+      state = ERR_NONE;
+    }
   }
-  delete[] dataIn;
 
-  return(ERR_MQTT_NO_NEW_PACKET_AVAILABLE);
+  #ifndef RADIOLIB_STATIC_ONLY
+    BufferPool::free(dataIn);
+  #endif
+  return(state);
 }
 
 size_t MQTTClient::encodeLength(uint32_t len, uint8_t* encoded) {
@@ -2,6 +2,7 @@
 #define _RADIOLIB_MQTT_H
 
 #include "../../TypeDef.h"
+#include "../../BufferPool.h"
 #include "../TransportLayer/TransportLayer.h"
 
 // MQTT packet types
@@ -57,7 +57,7 @@ size_t MorseClient::write(uint8_t b) {
   if(b == ' ') {
     RADIOLIB_DEBUG_PRINTLN(F("space"));
     standby();
-    delay(4 * _dotLength);
+    Module::delay(4 * _dotLength);
     return(1);
   }
 
@@ -76,16 +76,16 @@ size_t MorseClient::write(uint8_t b) {
     if (code & MORSE_DASH) {
       RADIOLIB_DEBUG_PRINT('-');
       transmitDirect(_base, _baseHz);
-      delay(3 * _dotLength);
+      Module::delay(3 * _dotLength);
     } else {
       RADIOLIB_DEBUG_PRINT('.');
       transmitDirect(_base, _baseHz);
-      delay(_dotLength);
+      Module::delay(_dotLength);
     }
 
     // symbol space
     standby();
-    delay(_dotLength);
+    Module::delay(_dotLength);
 
     // move onto the next bit
     code >>= 1;
@@ -93,7 +93,7 @@ size_t MorseClient::write(uint8_t b) {
 
   // letter space
   standby();
-  delay(2 * _dotLength);
+  Module::delay(2 * _dotLength);
   RADIOLIB_DEBUG_PRINTLN();
 
   return(1);
@@ -0,0 +1,65 @@
+#include "PacketRing.h"
+
+PacketRing::PacketRing(PacketSlot_t* slots, uint8_t* buffer, size_t numSlots, size_t slotSize) {
+  _slots = slots;
+  _numSlots = numSlots;
+  for(size_t i = 0; i < numSlots; i++) {
+    _slots[i].data = buffer + i*slotSize;
+    _slots[i].size = slotSize;
+    _slots[i].len = 0;
+    _slots[i].status = ERR_NONE;
+    _slots[i].rssi = 0;
+    _slots[i].snr = 0;
+    _slots[i].timestamp = 0;
+  }
+}
+
+PacketSlot_t* PacketRing::acquire() {
+  if(_count == _numSlots) {
+    _overflows++;
+    return(NULL);
+  }
+  return(&_slots[(_head + _count) % _numSlots]);
+}
+
+void PacketRing::commit() {
+  if(_count < _numSlots) {
+    _count++;
+  }
+}
+
+int16_t PacketRing::readData(PhysicalLayer* radio) {
+  PacketSlot_t* slot = acquire();
+  if(slot == NULL) {
+    return(ERR_QUEUE_FULL);
+  }
+
+  int16_t state = radio->readData(slot);
+  if((state == ERR_NONE) || (state == ERR_CRC_MISMATCH) || (state == ERR_PACKET_TOO_LONG)) {
+    commit();
+  }
+  return(state);
+}
+
+size_t PacketRing::available() {
+  return(_count);
+}
+
+PacketSlot_t* PacketRing::peek() {
+  if(_count == 0) {
+    return(NULL);
+  }
+  return(&_slots[_head]);
+}
+
+void PacketRing::release() {
+  if(_count == 0) {
+    return;
+  }
+  _head = (_head + 1) % _numSlots;
+  _count--;
+}
+
+uint32_t PacketRing::getOverflows() {
+  return(_overflows);
+}
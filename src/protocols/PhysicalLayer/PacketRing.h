@@ -0,0 +1,91 @@
+#ifndef _RADIOLIB_PACKET_RING_H
+#define _RADIOLIB_PACKET_RING_H
+
+#include "../../TypeDef.h"
+#include "PhysicalLayer.h"
+
+/*!
+  \class PacketRing
+
+  \brief Ring of pre-allocated packet slots. Received packets are read from module straight into the next free slot
+  and stay there until the caller releases them, so packets are never copied and no memory is allocated per packet.
+  Both slots and their buffers are owned by the caller, e.g. as global arrays.
+
+  A slot is filled in two steps: PacketRing::acquire hands out the next free slot (e.g. for PhysicalLayer::receiveAsync(PacketSlot_t*)),
+  PacketRing::commit publishes it once the packet was received. Packets are then consumed in order by PacketRing::peek and PacketRing::release.
+  The ring is not interrupt-safe, all methods must be called from the main loop.
+*/
+class PacketRing {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param slots Array of numSlots slots.
+
+      \param buffer Packet buffer of numSlots * slotSize bytes, split between the slots.
+
+      \param numSlots Number of slots.
+
+      \param slotSize Size of each slot in bytes. Longer packets are truncated and published with PacketSlot_t::status set to ERR_PACKET_TOO_LONG.
+    */
+    PacketRing(PacketSlot_t* slots, uint8_t* buffer, size_t numSlots, size_t slotSize);
+
+    /*!
+      \brief Gets the next free slot. The slot is only published by PacketRing::commit, so calling this method again returns the same slot.
+
+      \returns Free slot, or NULL when all slots are in use.
+    */
+    PacketSlot_t* acquire();
+
+    /*!
+      \brief Publishes the slot returned by PacketRing::acquire.
+    */
+    void commit();
+
+    /*!
+      \brief Reads received packet from module into the next free slot and publishes it.
+      Packets that failed CRC check or were truncated are published too, with PacketSlot_t::status set to ERR_CRC_MISMATCH or ERR_PACKET_TOO_LONG.
+
+      \param radio Module to read the packet from, after the packet was received (see PhysicalLayer::startReceive).
+
+      \returns \ref status_codes, ERR_QUEUE_FULL when all slots are in use (the packet is then left in the module).
+    */
+    int16_t readData(PhysicalLayer* radio);
+
+    /*!
+      \brief Gets the number of published packets.
+
+      \returns Number of packets.
+    */
+    size_t available();
+
+    /*!
+      \brief Gets the oldest published packet, without releasing its slot.
+
+      \returns Oldest packet, or NULL when there is none.
+    */
+    PacketSlot_t* peek();
+
+    /*!
+      \brief Releases slot of the oldest published packet, so that it can be reused.
+    */
+    void release();
+
+    /*!
+      \brief Gets the number of times a slot was requested while all slots were in use.
+
+      \returns Number of overflows.
+    */
+    uint32_t getOverflows();
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    PacketSlot_t* _slots;
+    size_t _numSlots;
+    size_t _head = 0;
+    size_t _count = 0;
+    uint32_t _overflows = 0;
+};
+
+#endif
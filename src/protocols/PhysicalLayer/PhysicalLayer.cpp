@@ -1,4 +1,5 @@
 #include "PhysicalLayer.h"
+#include "../../Module.h"
 
 PhysicalLayer::PhysicalLayer(float freqStep, size_t maxPacketLength) {
   _freqStep = freqStep;
@@ -21,7 +22,10 @@ int16_t PhysicalLayer::transmit(__FlashStringHelper* fstr, uint8_t addr) {
   #ifdef RADIOLIB_STATIC_ONLY
     char str[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    char* str = new char[len];
+    char* str = (char*)BufferPool::alloc(len);
+    if(str == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
   #endif
 
   // copy string from flash
@@ -33,7 +37,7 @@ int16_t PhysicalLayer::transmit(__FlashStringHelper* fstr, uint8_t addr) {
   // transmit string
   int16_t state = transmit(str, addr);
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] str;
+    BufferPool::free(str);
   #endif
   return(state);
 }
@@ -46,6 +50,10 @@ int16_t PhysicalLayer::transmit(const char* str, uint8_t addr) {
   return(transmit((uint8_t*)str, strlen(str), addr));
 }
 
+int16_t PhysicalLayer::transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  return(transmitCopy(segs, numSegs, addr, true));
+}
+
 int16_t PhysicalLayer::startTransmit(String& str, uint8_t addr) {
   return(startTransmit(str.c_str(), addr));
 }
@@ -54,30 +62,53 @@ int16_t PhysicalLayer::startTransmit(const char* str, uint8_t addr) {
   return(startTransmit((uint8_t*)str, strlen(str), addr));
 }
 
-int16_t PhysicalLayer::readData(String& str, size_t len) {
-  int16_t state = ERR_NONE;
+int16_t PhysicalLayer::startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr) {
+  return(transmitCopy(segs, numSegs, addr, false));
+}
 
-  // read the number of actually received bytes
-  size_t length = getPacketLength();
+int16_t PhysicalLayer::finishTransmit() {
+  return(standby());
+}
 
+int16_t PhysicalLayer::startReceive() {
+  return(ERR_WRONG_MODEM);
+}
+
+int16_t PhysicalLayer::startChannelScan() {
+  return(ERR_WRONG_MODEM);
+}
+
+int16_t PhysicalLayer::readData(String& str, size_t len) {
+  // packet length has to be read before the data
+  size_t length = getPacketLength();
   if((len < length) && (len != 0)) {
     // user requested less bytes than were received, this is allowed (but frowned upon)
     // requests for more data than were received will only return the number of actually received bytes (unlike PhysicalLayer::receive())
     length = len;
   }
 
-  // build a temporary buffer
+  // build a temporary buffer, with space for null terminator
+  bool tooLong = false;
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t data[RADIOLIB_STATIC_ARRAY_SIZE + 1];
+
+    // packets that do not fit are still read to clear the module, but not returned
+    if(length > RADIOLIB_STATIC_ARRAY_SIZE) {
+      length = RADIOLIB_STATIC_ARRAY_SIZE;
+      tooLong = true;
+    }
   #else
-    uint8_t* data = new uint8_t[length + 1];
-    if(!data) {
+    uint8_t* data = (uint8_t*)BufferPool::alloc(length + 1);
+    if(data == NULL) {
       return(ERR_MEMORY_ALLOCATION_FAILED);
     }
   #endif
 
   // read the received data
-  state = readData(data, length);
+  int16_t state = readData(data, length);
+  if((state == ERR_NONE) && tooLong) {
+    state = ERR_PACKET_TOO_LONG;
+  }
 
   if(state == ERR_NONE) {
     // add null terminator
@@ -89,44 +120,63 @@ int16_t PhysicalLayer::readData(String& str, size_t len) {
 
   // deallocate temporary buffer
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] data;
+    BufferPool::free(data);
   #endif
 
   return(state);
 }
 
-int16_t PhysicalLayer::receive(String& str, size_t len) {
-  int16_t state = ERR_NONE;
+int16_t PhysicalLayer::readData(PacketSlot_t* slot) {
+  // packet length has to be read before the data, longer packets are truncated to fit the slot
+  size_t packetLength = getPacketLength();
+  size_t length = packetLength;
+  if(length > slot->size) {
+    length = slot->size;
+  }
+
+  int16_t state = readData(slot->data, length);
+  if((state == ERR_NONE) && (packetLength > length)) {
+    state = ERR_PACKET_TOO_LONG;
+  }
+  fillSlot(slot, state, length, getRSSI(), getSNR(), Module::micros());
+  return(state);
+}
 
+int16_t PhysicalLayer::receive(String& str, size_t len) {
   // user can override the length of data to read
   size_t length = len;
-
   if(len == 0) {
     // unknown packet length, set to maximum
     length = _maxPacketLength;
   }
 
-  // build a temporary buffer
+  // build a temporary slot, with space for null terminator
+  bool capped = false;
   #ifdef RADIOLIB_STATIC_ONLY
     uint8_t data[RADIOLIB_STATIC_ARRAY_SIZE + 1];
+    if(length > RADIOLIB_STATIC_ARRAY_SIZE) {
+      length = RADIOLIB_STATIC_ARRAY_SIZE;
+      capped = true;
+    }
   #else
-    uint8_t* data = new uint8_t[length + 1];
-    if(!data) {
+    uint8_t* data = (uint8_t*)BufferPool::alloc(length + 1);
+    if(data == NULL) {
       return(ERR_MEMORY_ALLOCATION_FAILED);
     }
   #endif
+  PacketSlot_t slot = { data, length, 0, ERR_NONE, 0, 0, 0 };
 
   // attempt packet reception
-  state = receive(data, length);
+  int16_t state = receive(&slot);
 
-  if(state == ERR_NONE) {
-    // read the number of actually received bytes (for unknown packets)
-    if(len == 0) {
-      length = getPacketLength(false);
-    }
+  // packet longer than the slot is only an error when the slot was capped, not when the user requested less
+  if((state == ERR_PACKET_TOO_LONG) && !capped && (len != 0)) {
+    state = ERR_NONE;
+  }
 
+  if(state == ERR_NONE) {
     // add null terminator
-    data[length] = 0;
+    data[slot.len] = 0;
 
     // initialize Arduino String class
     str = String((char*)data);
@@ -134,12 +184,439 @@ int16_t PhysicalLayer::receive(String& str, size_t len) {
 
   // deallocate temporary buffer
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] data;
+    BufferPool::free(data);
   #endif
 
   return(state);
 }
 
+int16_t PhysicalLayer::receive(PacketSlot_t* slot) {
+  // slot as large as the longest packet indicates unknown packet length
+  size_t length = slot->size;
+  if(length > _maxPacketLength) {
+    length = _maxPacketLength;
+  }
+
+  // attempt packet reception
+  int16_t state = receive(slot->data, length);
+
+  // read the number of actually received bytes, longer packets were truncated
+  if((state == ERR_NONE) || (state == ERR_CRC_MISMATCH)) {
+    size_t packetLength = getPacketLength(false);
+    if(packetLength < length) {
+      length = packetLength;
+    } else if((state == ERR_NONE) && (packetLength > slot->size)) {
+      state = ERR_PACKET_TOO_LONG;
+    }
+  }
+
+  fillSlot(slot, state, length, getRSSI(), getSNR(), Module::micros());
+  return(state);
+}
+
 float PhysicalLayer::getFreqStep() {
   return(_freqStep);
 }
+
+void PhysicalLayer::setMaxPacketLength(size_t maxPacketLength) {
+  _maxPacketLength = maxPacketLength;
+}
+
+float PhysicalLayer::getRSSI() {
+  return(0);
+}
+
+float PhysicalLayer::getSNR() {
+  return(0);
+}
+
+// interrupt service routine of each slot is generated from RADIOLIB_EVENT_SLOTS
+template<uint8_t N> void (*PhysicalLayer::eventTrampoline(uint8_t slot))(void) {
+  return((slot == N - 1) ? eventIrq<N - 1> : eventTrampoline<N - 1>(slot));
+}
+
+template<> void (*PhysicalLayer::eventTrampoline<0>(uint8_t slot))(void) {
+  (void)slot;
+  return(NULL);
+}
+
+int16_t PhysicalLayer::setEventAction(void (*func)(const RadioEvent_t*, void*), void* ctx, uint8_t id) {
+  // release slots held by this module
+  clearEventAction();
+  _eventCb = func;
+  _eventCtx = ctx;
+  _eventId = id;
+
+  for(uint8_t source = 0; source < RADIOLIB_EVENT_MAX_SOURCES; source++) {
+    // skip pins that are not connected
+    if(!setEventIsr(source, NULL)) {
+      continue;
+    }
+
+    // find free slot
+    uint8_t slot = 0;
+    while((slot < RADIOLIB_EVENT_SLOTS) && (_eventSlotRadio[slot] != NULL)) {
+      slot++;
+    }
+    if(slot == RADIOLIB_EVENT_SLOTS) {
+      clearEventAction();
+      return(ERR_EVENT_SLOTS_FULL);
+    }
+
+    // drop records left in the slot by its previous owner
+    _eventTail[slot] = _eventHead[slot];
+    _eventSlotRadio[slot] = this;
+    _eventSlotSource[slot] = source;
+    setEventIsr(source, eventTrampoline<RADIOLIB_EVENT_SLOTS>(slot));
+  }
+
+  return(ERR_NONE);
+}
+
+void PhysicalLayer::clearEventAction() {
+  for(uint8_t slot = 0; slot < RADIOLIB_EVENT_SLOTS; slot++) {
+    if(_eventSlotRadio[slot] == this) {
+      setEventIsr(_eventSlotSource[slot], NULL);
+      _eventSlotRadio[slot] = NULL;
+    }
+  }
+  _eventCb = NULL;
+}
+
+size_t PhysicalLayer::dispatchEvents() {
+  size_t num = 0;
+  while(true) {
+    // find the oldest record of all slots, current time is read after the timestamps so that it is never older than any of them
+    uint32_t timestamps[RADIOLIB_EVENT_SLOTS];
+    bool pending[RADIOLIB_EVENT_SLOTS];
+    for(uint8_t slot = 0; slot < RADIOLIB_EVENT_SLOTS; slot++) {
+      pending[slot] = (_eventTail[slot] != _eventHead[slot]);
+      if(pending[slot]) {
+        timestamps[slot] = _eventQueue[slot][_eventTail[slot]];
+      }
+    }
+    uint32_t now = Module::micros();
+    uint8_t oldest = RADIOLIB_EVENT_SLOTS;
+    for(uint8_t slot = 0; slot < RADIOLIB_EVENT_SLOTS; slot++) {
+      if(pending[slot] && ((oldest == RADIOLIB_EVENT_SLOTS) || (now - timestamps[slot] > now - timestamps[oldest]))) {
+        oldest = slot;
+      }
+    }
+    if(oldest == RADIOLIB_EVENT_SLOTS) {
+      break;
+    }
+    _eventTail[oldest] = (_eventTail[oldest] + 1) % RADIOLIB_EVENT_QUEUE_SIZE;
+
+    // events may have been disabled since the interrupt
+    PhysicalLayer* radio = _eventSlotRadio[oldest];
+    if((radio == NULL) || (radio->_eventCb == NULL)) {
+      continue;
+    }
+
+    // reading IRQ status clears it on some modules, so all records of this radio queued so far are merged into one event
+    for(uint8_t slot = 0; slot < RADIOLIB_EVENT_SLOTS; slot++) {
+      if(_eventSlotRadio[slot] == radio) {
+        _eventTail[slot] = _eventHead[slot];
+      }
+    }
+
+    // records of interrupts whose status was already read with an earlier record carry no flags
+    RadioEvent_t event;
+    event.flags = radio->getEvents();
+    if(event.flags == RADIOLIB_EVENT_NONE) {
+      continue;
+    }
+    event.radio = radio;
+    event.id = radio->_eventId;
+    event.source = _eventSlotSource[oldest];
+    event.timestamp = timestamps[oldest];
+    radio->_eventCb(&event, radio->_eventCtx);
+    num++;
+  }
+  return(num);
+}
+
+uint32_t PhysicalLayer::getEventOverflows() {
+  uint32_t num = 0;
+  for(uint8_t slot = 0; slot < RADIOLIB_EVENT_SLOTS; slot++) {
+    num += _eventOverflows[slot];
+  }
+  return(num);
+}
+
+bool PhysicalLayer::setEventIsr(uint8_t source, void (*func)(void)) {
+  (void)source;
+  (void)func;
+  return(false);
+}
+
+uint16_t PhysicalLayer::getEvents() {
+  return(RADIOLIB_EVENT_NONE);
+}
+
+const RadioOperation_t* PhysicalLayer::transmitAsync(uint8_t* data, size_t len, uint32_t timeout, uint8_t addr) {
+  return(startOperation(RADIOLIB_OPERATION_TX, data, len, timeout, addr, NULL));
+}
+
+const RadioOperation_t* PhysicalLayer::transmitAsync(const TxSegment_t* segs, size_t numSegs, uint32_t timeout, uint8_t addr) {
+  return(startOperation(RADIOLIB_OPERATION_TX, NULL, getSegmentsLength(segs, numSegs), timeout, addr, NULL, segs, numSegs));
+}
+
+const RadioOperation_t* PhysicalLayer::receiveAsync(uint8_t* data, size_t len, uint32_t timeout) {
+  return(startOperation(RADIOLIB_OPERATION_RX, data, len, timeout, 0, NULL));
+}
+
+const RadioOperation_t* PhysicalLayer::receiveAsync(PacketSlot_t* slot, uint32_t timeout) {
+  return(startOperation(RADIOLIB_OPERATION_RX, slot->data, slot->size, timeout, 0, slot));
+}
+
+const RadioOperation_t* PhysicalLayer::scanChannelAsync(uint32_t timeout) {
+  return(startOperation(RADIOLIB_OPERATION_CAD, NULL, 0, timeout, 0, NULL));
+}
+
+int16_t PhysicalLayer::poll() {
+  if(_op.status != OPERATION_PENDING) {
+    return(_op.status);
+  }
+
+  uint16_t events = getEvents();
+  if(_op.type == RADIOLIB_OPERATION_TX) {
+    if(events & (RADIOLIB_EVENT_TX_DONE | RADIOLIB_EVENT_TIMEOUT)) {
+      // module-specific failures (e.g. missing ACK) are reported by finishTransmit
+      int16_t state = finishTransmit();
+      if((state == ERR_NONE) && !(events & RADIOLIB_EVENT_TX_DONE)) {
+        state = ERR_TX_TIMEOUT;
+      }
+      completeOperation(state);
+      return(_op.status);
+    }
+
+  } else if(_op.type == RADIOLIB_OPERATION_RX) {
+    if(events & (RADIOLIB_EVENT_RX_DONE | RADIOLIB_EVENT_CRC_ERROR)) {
+      // packet length has to be read before the data, longer packets are truncated to fit the buffer
+      size_t packetLength = getPacketLength();
+      size_t length = packetLength;
+      if(length > _op.len) {
+        length = _op.len;
+      }
+      int16_t state = readData(_op.data, length);
+      if((state == ERR_NONE) && !(events & RADIOLIB_EVENT_RX_DONE)) {
+        state = ERR_CRC_MISMATCH;
+      }
+
+      // truncated packet is reported for slots, same as by readData(PacketSlot_t*)
+      if((state == ERR_NONE) && (_opSlot != NULL) && (packetLength > length)) {
+        state = ERR_PACKET_TOO_LONG;
+      }
+      _op.len = length;
+      _op.rssi = getRSSI();
+      _op.snr = getSNR();
+      completeOperation(state);
+      return(_op.status);
+    }
+
+    if(events & RADIOLIB_EVENT_TIMEOUT) {
+      standby();
+      completeOperation(ERR_RX_TIMEOUT);
+      return(_op.status);
+    }
+
+  } else if(_op.type == RADIOLIB_OPERATION_CAD) {
+    if(events & (RADIOLIB_EVENT_CAD_DONE | RADIOLIB_EVENT_CAD_DETECTED)) {
+      standby();
+      completeOperation((events & RADIOLIB_EVENT_CAD_DETECTED) ? PREAMBLE_DETECTED : CHANNEL_FREE);
+      return(_op.status);
+    }
+  }
+
+  // check timeout, channel scan that did not finish in time is reported as receive timeout
+  if((_op.timeout != 0) && (Module::micros() - _op.start >= _op.timeout)) {
+    if(_op.type == RADIOLIB_OPERATION_TX) {
+      finishTransmit();
+      completeOperation(ERR_TX_TIMEOUT);
+    } else {
+      standby();
+      completeOperation(ERR_RX_TIMEOUT);
+    }
+  }
+
+  return(_op.status);
+}
+
+int16_t PhysicalLayer::waitForOperation() {
+  int16_t state = poll();
+  while(state == OPERATION_PENDING) {
+    yield();
+    state = poll();
+  }
+  return(state);
+}
+
+const RadioOperation_t* PhysicalLayer::getOperation() {
+  return(&_op);
+}
+
+void PhysicalLayer::setOperationAction(void (*func)(const RadioOperation_t*, void*), void* ctx) {
+  _opCb = func;
+  _opCtx = ctx;
+}
+
+size_t PhysicalLayer::getSegmentsLength(const TxSegment_t* segs, size_t numSegs) {
+  size_t len = 0;
+  for(size_t i = 0; i < numSegs; i++) {
+    len += segs[i].len;
+  }
+  return(len);
+}
+
+const RadioOperation_t* PhysicalLayer::startOperation(uint8_t type, uint8_t* data, size_t len, uint32_t timeout, uint8_t addr, PacketSlot_t* slot, const TxSegment_t* segs, size_t numSegs) {
+  _opSlot = slot;
+  _op.type = type;
+  _op.status = OPERATION_PENDING;
+  _op.timeout = timeout;
+  _op.data = data;
+  _op.len = len;
+  _op.rssi = 0;
+  _op.snr = 0;
+
+  int16_t state = ERR_NONE;
+  if((type == RADIOLIB_OPERATION_TX) && (segs != NULL)) {
+    state = startTransmit(segs, numSegs, addr);
+  } else if(type == RADIOLIB_OPERATION_TX) {
+    state = startTransmit(data, len, addr);
+  } else if(type == RADIOLIB_OPERATION_RX) {
+    state = startReceive();
+  } else {
+    state = startChannelScan();
+  }
+
+  _op.start = Module::micros();
+  _op.end = _op.start;
+  if(state != ERR_NONE) {
+    completeOperation(state);
+  }
+  return(&_op);
+}
+
+void PhysicalLayer::completeOperation(int16_t status) {
+  _op.end = Module::micros();
+  _op.status = status;
+  if(_opSlot != NULL) {
+    fillSlot(_opSlot, status, _op.len, _op.rssi, _op.snr, _op.end);
+  }
+  if(_opCb != NULL) {
+    _opCb(&_op, _opCtx);
+  }
+}
+
+int16_t PhysicalLayer::transmitCopy(const TxSegment_t* segs, size_t numSegs, uint8_t addr, bool blocking) {
+  // single segment can be passed on as it is
+  if(numSegs == 1) {
+    return(blocking ? transmit(segs[0].data, segs[0].len, addr) : startTransmit(segs[0].data, segs[0].len, addr));
+  }
+
+  // module can only write contiguous packet, gather the segments
+  size_t len = getSegmentsLength(segs, numSegs);
+  #ifdef RADIOLIB_STATIC_ONLY
+    if(len > RADIOLIB_STATIC_ARRAY_SIZE) {
+      return(ERR_PACKET_TOO_LONG);
+    }
+    uint8_t data[RADIOLIB_STATIC_ARRAY_SIZE];
+  #else
+    uint8_t* data = (uint8_t*)BufferPool::alloc(len);
+    if(data == NULL) {
+      return(ERR_MEMORY_ALLOCATION_FAILED);
+    }
+  #endif
+
+  size_t pos = 0;
+  for(size_t i = 0; i < numSegs; i++) {
+    memcpy(data + pos, segs[i].data, segs[i].len);
+    pos += segs[i].len;
+  }
+
+  int16_t state = blocking ? transmit(data, len, addr) : startTransmit(data, len, addr);
+  #ifndef RADIOLIB_STATIC_ONLY
+    BufferPool::free(data);
+  #endif
+  return(state);
+}
+
+void PhysicalLayer::fillSlot(PacketSlot_t* slot, int16_t status, size_t len, float rssi, float snr, uint32_t timestamp) {
+  // packets that failed CRC check or were truncated are kept, so that the caller can decide what to do with them
+  slot->len = ((status == ERR_NONE) || (status == ERR_CRC_MISMATCH) || (status == ERR_PACKET_TOO_LONG)) ? len : 0;
+  slot->status = status;
+  slot->rssi = rssi;
+  slot->snr = snr;
+  slot->timestamp = timestamp;
+}
+
+PhysicalLayer* PhysicalLayer::_eventSlotRadio[RADIOLIB_EVENT_SLOTS];
+uint8_t PhysicalLayer::_eventSlotSource[RADIOLIB_EVENT_SLOTS];
+volatile uint32_t PhysicalLayer::_eventQueue[RADIOLIB_EVENT_SLOTS][RADIOLIB_EVENT_QUEUE_SIZE];
+volatile uint8_t PhysicalLayer::_eventHead[RADIOLIB_EVENT_SLOTS];
+volatile uint8_t PhysicalLayer::_eventTail[RADIOLIB_EVENT_SLOTS];
+volatile uint32_t PhysicalLayer::_eventOverflows[RADIOLIB_EVENT_SLOTS];
+
+template<uint8_t N> void PhysicalLayer::eventIrq() {
+  // drop the record if the queue is full, the queue index is only published once the record is complete
+  uint8_t head = _eventHead[N];
+  uint8_t next = (head + 1) % RADIOLIB_EVENT_QUEUE_SIZE;
+  if(next == _eventTail[N]) {
+    _eventOverflows[N] = _eventOverflows[N] + 1;
+    return;
+  }
+
+  _eventQueue[N][head] = Module::micros();
+  _eventHead[N] = next;
+}
+
+TxSegmentStream::TxSegmentStream() {
+  clear();
+}
+
+int16_t TxSegmentStream::set(const TxSegment_t* segs, size_t numSegs) {
+  clear();
+  if(numSegs > RADIOLIB_TX_SEGMENTS_MAX) {
+    return(ERR_TOO_MANY_SEGMENTS);
+  }
+
+  memcpy(_segs, segs, numSegs * sizeof(TxSegment_t));
+  _numSegs = numSegs;
+  skipEmpty();
+  return(ERR_NONE);
+}
+
+uint8_t* TxSegmentStream::next(size_t maxLen, size_t* len) {
+  if((maxLen == 0) || (_index >= _numSegs)) {
+    *len = 0;
+    return(NULL);
+  }
+
+  uint8_t* data = &_segs[_index].data[_offset];
+  *len = _segs[_index].len - _offset;
+  if(*len > maxLen) {
+    *len = maxLen;
+  }
+  _offset += *len;
+  skipEmpty();
+  return(data);
+}
+
+bool TxSegmentStream::isActive() {
+  return(_index < _numSegs);
+}
+
+void TxSegmentStream::clear() {
+  _numSegs = 0;
+  _index = 0;
+  _offset = 0;
+}
+
+void TxSegmentStream::skipEmpty() {
+  // move to the next segment that has data left, so that isActive is false right after the last byte is returned
+  while((_index < _numSegs) && (_offset >= _segs[_index].len)) {
+    _index++;
+    _offset = 0;
+  }
+}
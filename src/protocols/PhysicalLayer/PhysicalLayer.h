@@ -2,6 +2,253 @@
 #define _RADIOLIB_PHYSICAL_LAYER_H
 
 #include "../../TypeDef.h"
+#include "../../BufferPool.h"
+
+// radio events, decoded from module IRQ status by dispatchEvents
+#define RADIOLIB_EVENT_NONE                           0x0000
+#define RADIOLIB_EVENT_TX_DONE                        0x0001
+#define RADIOLIB_EVENT_RX_DONE                        0x0002
+#define RADIOLIB_EVENT_CRC_ERROR                      0x0004
+#define RADIOLIB_EVENT_CAD_DONE                       0x0008
+#define RADIOLIB_EVENT_CAD_DETECTED                   0x0010
+#define RADIOLIB_EVENT_PREAMBLE_DETECTED              0x0020
+#define RADIOLIB_EVENT_SYNC_WORD                      0x0040
+#define RADIOLIB_EVENT_TIMEOUT                        0x0080
+
+// number of interrupt pins that can be routed to event queue, shared by all modules (each pin takes one slot)
+#ifndef RADIOLIB_EVENT_SLOTS
+  #define RADIOLIB_EVENT_SLOTS                        4
+#endif
+
+// maximum number of interrupt pins per module
+#define RADIOLIB_EVENT_MAX_SOURCES                    2
+
+// number of interrupt records per slot that can be waiting for dispatch
+#ifndef RADIOLIB_EVENT_QUEUE_SIZE
+  #define RADIOLIB_EVENT_QUEUE_SIZE                   8
+#endif
+
+// maximum number of packet segments that a module can retain while streaming them into its FIFO after startTransmit returns
+#ifndef RADIOLIB_TX_SEGMENTS_MAX
+  #define RADIOLIB_TX_SEGMENTS_MAX                    4
+#endif
+
+// asynchronous operation types
+#define RADIOLIB_OPERATION_NONE                       0
+#define RADIOLIB_OPERATION_TX                         1
+#define RADIOLIB_OPERATION_RX                         2
+#define RADIOLIB_OPERATION_CAD                        3
+
+class PhysicalLayer;
+
+/*!
+  \struct RadioEvent_t
+
+  \brief Radio event passed to event handler, see PhysicalLayer::setEventAction.
+*/
+struct RadioEvent_t {
+
+  /*!
+    \brief Module that generated the event.
+  */
+  PhysicalLayer* radio;
+
+  /*!
+    \brief User-defined module ID, as passed to PhysicalLayer::setEventAction.
+  */
+  uint8_t id;
+
+  /*!
+    \brief Index of interrupt pin that triggered the event, 0 for the main interrupt pin (e.g. DIO0, DIO1 on SX126x/SX128x, GDO0 or IRQ).
+  */
+  uint8_t source;
+
+  /*!
+    \brief Event flags, combination of RADIOLIB_EVENT_* macros. Decoded from IRQ status at dispatch time, so it may include events that happened after the interrupt.
+  */
+  uint16_t flags;
+
+  /*!
+    \brief Timestamp of the interrupt in us.
+  */
+  uint32_t timestamp;
+};
+
+/*!
+  \struct RadioOperation_t
+
+  \brief Handle of asynchronous operation, see PhysicalLayer::transmitAsync and PhysicalLayer::receiveAsync.
+  Each module runs one operation at a time, so the handle is reused (and overwritten) by the next operation.
+*/
+struct RadioOperation_t {
+
+  /*!
+    \brief Type of the operation, one of RADIOLIB_OPERATION_* macros.
+  */
+  uint8_t type;
+
+  /*!
+    \brief OPERATION_PENDING while the operation is in progress, final \ref status_codes once it has finished.
+  */
+  int16_t status;
+
+  /*!
+    \brief Timestamp of operation start in us.
+  */
+  uint32_t start;
+
+  /*!
+    \brief Timestamp of operation end in us, as seen by PhysicalLayer::poll. Accuracy therefore depends on how often poll is called.
+  */
+  uint32_t end;
+
+  /*!
+    \brief Operation timeout in us, 0 when disabled.
+  */
+  uint32_t timeout;
+
+  /*!
+    \brief Transmitted data, or buffer for received data.
+  */
+  uint8_t* data;
+
+  /*!
+    \brief Number of bytes to transmit. For reception, size of the buffer and number of received bytes once the operation has finished.
+  */
+  size_t len;
+
+  /*!
+    \brief RSSI of the received packet in dBm, 0 when not available.
+  */
+  float rssi;
+
+  /*!
+    \brief SNR of the received packet in dB, 0 when not available.
+  */
+  float snr;
+};
+
+/*!
+  \struct PacketSlot_t
+
+  \brief Caller-owned buffer for a single received packet, with the packet metadata next to the payload.
+  Received data are read from module straight into the slot, see PhysicalLayer::readData(PacketSlot_t*) and PacketRing.
+*/
+struct PacketSlot_t {
+
+  /*!
+    \brief Buffer for packet data, owned by the caller.
+  */
+  uint8_t* data;
+
+  /*!
+    \brief Size of the buffer in bytes. Longer packets are truncated to this size and reported with ERR_PACKET_TOO_LONG.
+  */
+  size_t size;
+
+  /*!
+    \brief Number of received bytes, 0 when no packet was received.
+  */
+  size_t len;
+
+  /*!
+    \brief \ref status_codes of the reception, ERR_CRC_MISMATCH for packets that failed CRC check, ERR_PACKET_TOO_LONG for truncated packets.
+  */
+  int16_t status;
+
+  /*!
+    \brief RSSI of the packet in dBm, 0 when not available.
+  */
+  float rssi;
+
+  /*!
+    \brief SNR of the packet in dB, 0 when not available.
+  */
+  float snr;
+
+  /*!
+    \brief Timestamp of packet reception in us.
+  */
+  uint32_t timestamp;
+};
+
+/*!
+  \struct TxSegment_t
+
+  \brief Part of a packet to transmit, see PhysicalLayer::transmit(const TxSegment_t*, size_t, uint8_t).
+  Segments of a packet are transmitted one after another, so e.g. protocol header built on stack and payload do not have to be copied into a single buffer.
+*/
+struct TxSegment_t {
+
+  /*!
+    \brief Segment data.
+  */
+  uint8_t* data;
+
+  /*!
+    \brief Segment length in bytes.
+  */
+  size_t len;
+};
+
+/*!
+  \class TxSegmentStream
+
+  \brief Packet segments that are written into module FIFO piece by piece, e.g. because the packet is longer than the FIFO.
+  Segment descriptors are copied, so the array passed to startTransmit does not have to outlive the call,
+  only the data the segments point to has to stay valid until the transmission is finished.
+*/
+class TxSegmentStream {
+  public:
+    /*!
+      \brief Default constructor.
+    */
+    TxSegmentStream();
+
+    /*!
+      \brief Copies segment descriptors and starts streaming from the first byte.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments, at most RADIOLIB_TX_SEGMENTS_MAX.
+
+      \returns \ref status_codes, ERR_TOO_MANY_SEGMENTS when numSegs is larger than RADIOLIB_TX_SEGMENTS_MAX (the stream is then empty).
+    */
+    int16_t set(const TxSegment_t* segs, size_t numSegs);
+
+    /*!
+      \brief Gets the next contiguous chunk of data and advances past it.
+
+      \param maxLen Maximum number of bytes to return.
+
+      \param len Pointer to save the number of returned bytes to.
+
+      \returns Pointer to the chunk, or NULL when there is nothing left or maxLen is 0.
+    */
+    uint8_t* next(size_t maxLen, size_t* len);
+
+    /*!
+      \brief Checks whether there is any data left to write.
+
+      \returns True when some data was not returned by TxSegmentStream::next yet.
+    */
+    bool isActive();
+
+    /*!
+      \brief Drops all data that was not written yet.
+    */
+    void clear();
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    TxSegment_t _segs[RADIOLIB_TX_SEGMENTS_MAX];
+    size_t _numSegs;
+    size_t _index;
+    size_t _offset;
+
+    void skipEmpty();
+};
 
 /*!
   \class PhysicalLayer
@@ -73,7 +320,23 @@ class PhysicalLayer {
     virtual int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0) = 0;
 
     /*!
-      \brief Arduino String receive method.
+      \brief Scatter-gather transmit method. Segments are transmitted as a single packet, in the order they are listed.
+      Modules that support it write the segments to FIFO one by one, others transmit a contiguous copy of the packet.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns \ref status_codes
+    */
+    virtual int16_t transmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Arduino String receive method. Packet is received into a temporary buffer from BufferPool, sized to len (or to the maximum packet length when len is 0).
+      When RADIOLIB_STATIC_ONLY is defined, a buffer on stack is used instead and at most RADIOLIB_STATIC_ARRAY_SIZE characters are received;
+      longer packets then return ERR_PACKET_TOO_LONG and str is left unchanged.
 
       \param str Address of Arduino String to save the received data.
 
@@ -101,6 +364,15 @@ class PhysicalLayer {
     */
     virtual int16_t receive(uint8_t* data, size_t len) = 0;
 
+    /*!
+      \brief Packet slot receive method. Data are received straight into the slot, together with length, RSSI and SNR of the packet.
+
+      \param slot Slot to save the received packet. Slots smaller than the maximum packet length receive exactly PacketSlot_t::size bytes.
+
+      \returns \ref status_codes, ERR_PACKET_TOO_LONG when the packet was longer than the slot.
+    */
+    int16_t receive(PacketSlot_t* slot);
+
     /*!
       \brief Interrupt-driven Arduino String transmit method. Unlike the standard transmit method, this one is non-blocking.
       Interrupt pin will be activated when transmission finishes.
@@ -139,7 +411,47 @@ class PhysicalLayer {
     virtual int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0) = 0;
 
     /*!
-      \brief Reads data that was received after calling startReceive method.
+      \brief Interrupt-driven scatter-gather transmit method. The segment array is only used during this call.
+      Modules that support it write the segments to FIFO one by one, others transmit a contiguous copy of the packet.
+      Modules that stream packets longer than FIFO copy the segment descriptors (see TxSegmentStream), the data they point to must then stay valid until the transmission is finished.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns \ref status_codes
+    */
+    virtual int16_t startTransmit(const TxSegment_t* segs, size_t numSegs, uint8_t addr = 0);
+
+    /*!
+      \brief Cleans up after transmission started by startTransmit has finished - clears IRQ flags and sets module to standby.
+      Default implementation only sets module to standby.
+
+      \returns \ref status_codes
+    */
+    virtual int16_t finishTransmit();
+
+    /*!
+      \brief Interrupt-driven receive method with default settings. Interrupt pin will be activated when a packet is received.
+      Default implementation returns ERR_WRONG_MODEM, for modules that do not implement it (receiveAsync then fails with the same code).
+
+      \returns \ref status_codes
+    */
+    virtual int16_t startReceive();
+
+    /*!
+      \brief Interrupt-driven channel activity detection method. Default implementation returns ERR_WRONG_MODEM, for modules without channel activity detection.
+
+      \returns \ref status_codes
+    */
+    virtual int16_t startChannelScan();
+
+    /*!
+      \brief Reads data that was received after calling startReceive method. Packet is read into a temporary buffer from BufferPool, sized to the received packet length.
+      When RADIOLIB_STATIC_ONLY is defined, a buffer on stack is used instead and at most RADIOLIB_STATIC_ARRAY_SIZE characters are read;
+      longer packets are then still read out of the module, but ERR_PACKET_TOO_LONG is returned and str is left unchanged.
 
       \param str Address of Arduino String to save the received data.
 
@@ -160,6 +472,15 @@ class PhysicalLayer {
     */
     virtual int16_t readData(uint8_t* data, size_t len) = 0;
 
+    /*!
+      \brief Reads data that was received after calling startReceive method straight into packet slot, together with length, RSSI and SNR of the packet.
+
+      \param slot Slot to save the received packet. Longer packets are truncated to PacketSlot_t::size.
+
+      \returns \ref status_codes, ERR_PACKET_TOO_LONG when the packet was truncated.
+    */
+    int16_t readData(PacketSlot_t* slot);
+
     /*!
       \brief Enables direct transmission mode on pins DIO1 (clock) and DIO2 (data). Must be implemented in module class.
       While in direct mode, the module will not be able to transmit or receive packets. Can only be activated in FSK mode.
@@ -224,11 +545,230 @@ class PhysicalLayer {
    */
    virtual size_t getPacketLength(bool update = true) = 0;
 
+    /*!
+      \brief Gets RSSI of the last received packet. Default implementation returns 0, for modules that do not provide it.
+
+      \returns RSSI of the last received packet in dBm.
+    */
+    virtual float getRSSI();
+
+    /*!
+      \brief Gets SNR of the last received packet. Default implementation returns 0, for modules that do not provide it.
+
+      \returns SNR of the last received packet in dB.
+    */
+    virtual float getSNR();
+
+    // event methods
+
+    /*!
+      \brief Routes module interrupt pins to the shared event queue. Interrupt service routine only stores a short record (module, pin and timestamp),
+      IRQ status is read and decoded later, when dispatchEvents is called from the main loop. Replaces any interrupt action previously set on the same pins.
+
+      \param func Event handler, called from dispatchEvents with the decoded event and user context.
+
+      \param ctx User context passed to event handler.
+
+      \param id User-defined module ID, passed to event handler in RadioEvent_t.
+
+      \returns \ref status_codes
+    */
+    int16_t setEventAction(void (*func)(const RadioEvent_t*, void*), void* ctx = NULL, uint8_t id = 0);
+
+    /*!
+      \brief Detaches module interrupt pins from the event queue.
+    */
+    void clearEventAction();
+
+    /*!
+      \brief Dispatches all queued interrupt records to event handlers in the order of their timestamps. Must be called from the main loop, never from interrupt context.
+      IRQ status is read once for all records of a module queued at that time, they are reported as a single event with the timestamp and source of the oldest one.
+      Handlers are not called for records that decode to no flags, e.g. of interrupts whose status was already read.
+
+      \returns Number of dispatched events.
+    */
+    static size_t dispatchEvents();
+
+    /*!
+      \brief Gets the number of interrupt records dropped because the event queue of their slot was full.
+
+      \returns Number of dropped records.
+    */
+    static uint32_t getEventOverflows();
+
+    /*!
+      \brief Attaches or detaches interrupt service routine on module interrupt pin. Must be implemented in module class to support events.
+
+      \param source Index of interrupt pin, 0 for the main interrupt pin.
+
+      \param func Interrupt service routine to attach, or NULL to detach.
+
+      \returns True if the module has the requested pin connected, false otherwise.
+    */
+    virtual bool setEventIsr(uint8_t source, void (*func)(void));
+
+    /*!
+      \brief Reads IRQ status of the module and decodes it into events. Must be implemented in module class to support events.
+
+      \returns Event flags, combination of RADIOLIB_EVENT_* macros.
+    */
+    virtual uint16_t getEvents();
+
+    // asynchronous operation methods
+
+    /*!
+      \brief Starts transmission and returns immediately. The operation is completed by calling poll.
+      Any operation still in progress is abandoned.
+
+      \param data Binary data that will be transmitted. Only used during this call, the data are written to module FIFO immediately.
+      Packets longer than FIFO of modules that stream them through it (SX127x in FSK mode) must stay valid until the operation is finished.
+
+      \param len Length of binary data to transmit (in bytes).
+
+      \param timeout Operation timeout in us, 0 to disable. Transmission is aborted with ERR_TX_TIMEOUT once this time has passed.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns Operation handle. Status of the handle is set to OPERATION_PENDING, or to error code if the transmission could not be started.
+    */
+    const RadioOperation_t* transmitAsync(uint8_t* data, size_t len, uint32_t timeout = 0, uint8_t addr = 0);
+
+    /*!
+      \brief Starts scatter-gather transmission and returns immediately. The operation is completed by calling poll.
+      Any operation still in progress is abandoned.
+
+      \param segs Packet segments. Only used during this call, the data are written to module FIFO immediately.
+      Packets longer than FIFO of modules that stream them through it (SX127x in FSK mode) must stay valid until the operation is finished.
+
+      \param numSegs Number of segments.
+
+      \param timeout Operation timeout in us, 0 to disable. Transmission is aborted with ERR_TX_TIMEOUT once this time has passed.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns Operation handle. Status of the handle is set to OPERATION_PENDING, or to error code if the transmission could not be started.
+    */
+    const RadioOperation_t* transmitAsync(const TxSegment_t* segs, size_t numSegs, uint32_t timeout = 0, uint8_t addr = 0);
+
+    /*!
+      \brief Starts reception with default settings and returns immediately. The operation is completed by calling poll.
+      Any operation still in progress is abandoned.
+
+      \param data Buffer for received data, must remain valid until the operation has finished.
+
+      \param len Size of the buffer. Longer packets are truncated.
+
+      \param timeout Operation timeout in us, 0 to disable. Reception is aborted with ERR_RX_TIMEOUT once this time has passed.
+
+      \returns Operation handle. Status of the handle is set to OPERATION_PENDING, or to error code if the reception could not be started.
+    */
+    const RadioOperation_t* receiveAsync(uint8_t* data, size_t len, uint32_t timeout = 0);
+
+    /*!
+      \brief Starts reception into packet slot and returns immediately. The operation is completed by calling poll,
+      which also fills the slot metadata (length, status, RSSI, SNR and timestamp). Any operation still in progress is abandoned.
+
+      \param slot Slot for the received packet, must remain valid until the operation has finished.
+
+      \param timeout Operation timeout in us, 0 to disable. Reception is aborted with ERR_RX_TIMEOUT once this time has passed.
+
+      \returns Operation handle. Status of the handle is set to OPERATION_PENDING, or to error code if the reception could not be started.
+    */
+    const RadioOperation_t* receiveAsync(PacketSlot_t* slot, uint32_t timeout = 0);
+
+    /*!
+      \brief Starts channel activity detection and returns immediately. The operation is completed by calling poll,
+      with status set to PREAMBLE_DETECTED or CHANNEL_FREE. Any operation still in progress is abandoned.
+
+      \param timeout Operation timeout in us, 0 to disable.
+
+      \returns Operation handle. Status of the handle is set to OPERATION_PENDING, or to error code if the scan could not be started.
+    */
+    const RadioOperation_t* scanChannelAsync(uint32_t timeout = 0);
+
+    /*!
+      \brief Advances the current operation. Reads IRQ status of the module (and received data once the packet is complete), never blocks.
+
+      \returns OPERATION_PENDING while the operation is in progress, final \ref status_codes of the last operation otherwise.
+    */
+    int16_t poll();
+
+    /*!
+      \brief Blocking wrapper, calls poll until the current operation has finished.
+
+      \returns \ref status_codes
+    */
+    int16_t waitForOperation();
+
+    /*!
+      \brief Gets handle of the current (or last) operation.
+
+      \returns Operation handle.
+    */
+    const RadioOperation_t* getOperation();
+
+    /*!
+      \brief Sets function that will be called from poll when an operation finishes.
+
+      \param func Callback function, called with the finished operation and user context.
+
+      \param ctx User context passed to callback function.
+    */
+    void setOperationAction(void (*func)(const RadioOperation_t*, void*), void* ctx = NULL);
+
+    /*!
+      \brief Gets total length of packet segments.
+
+      \param segs Packet segments.
+
+      \param numSegs Number of segments.
+
+      \returns Packet length in bytes.
+    */
+    static size_t getSegmentsLength(const TxSegment_t* segs, size_t numSegs);
+
+#ifndef RADIOLIB_GODMODE
+  protected:
+#endif
+    /*!
+      \brief Sets maximum packet length, for modules where it depends on configuration (e.g. fixed packet length).
+      Used by receive methods that do not know the packet length in advance.
+
+      \param maxPacketLength Maximum packet length in bytes.
+    */
+    void setMaxPacketLength(size_t maxPacketLength);
+
 #ifndef RADIOLIB_GODMODE
   private:
 #endif
     float _freqStep;
     size_t _maxPacketLength;
+
+    RadioOperation_t _op = { RADIOLIB_OPERATION_NONE, ERR_NONE, 0, 0, 0, NULL, 0, 0, 0 };
+    PacketSlot_t* _opSlot = NULL;
+    void (*_opCb)(const RadioOperation_t*, void*) = NULL;
+    void* _opCtx = NULL;
+
+    void (*_eventCb)(const RadioEvent_t*, void*) = NULL;
+    void* _eventCtx = NULL;
+    uint8_t _eventId = 0;
+
+    // every slot has its own queue of timestamps with single producer (its interrupt service routine)
+    // and single consumer (dispatchEvents), so no locking is needed even when interrupts preempt each other
+    static PhysicalLayer* _eventSlotRadio[RADIOLIB_EVENT_SLOTS];
+    static uint8_t _eventSlotSource[RADIOLIB_EVENT_SLOTS];
+    static volatile uint32_t _eventQueue[RADIOLIB_EVENT_SLOTS][RADIOLIB_EVENT_QUEUE_SIZE];
+    static volatile uint8_t _eventHead[RADIOLIB_EVENT_SLOTS];
+    static volatile uint8_t _eventTail[RADIOLIB_EVENT_SLOTS];
+    static volatile uint32_t _eventOverflows[RADIOLIB_EVENT_SLOTS];
+
+    template<uint8_t N> static void eventIrq();
+    template<uint8_t N> static void (*eventTrampoline(uint8_t slot))(void);
+
+    const RadioOperation_t* startOperation(uint8_t type, uint8_t* data, size_t len, uint32_t timeout, uint8_t addr, PacketSlot_t* slot, const TxSegment_t* segs = NULL, size_t numSegs = 0);
+    int16_t transmitCopy(const TxSegment_t* segs, size_t numSegs, uint8_t addr, bool blocking);
+    void completeOperation(int16_t status);
+    void fillSlot(PacketSlot_t* slot, int16_t status, size_t len, float rssi, float snr, uint32_t timestamp);
 };
 
 #endif
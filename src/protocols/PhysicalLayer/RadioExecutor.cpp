@@ -0,0 +1,295 @@
+#include "RadioExecutor.h"
+
+#if defined(RADIOLIB_COROUTINES)
+
+#include "../../Module.h"
+
+volatile bool RadioExecutor::_wake = false;
+
+RadioOperationAwaiter::RadioOperationAwaiter(PhysicalLayer* radio, uint8_t type, uint8_t* data, size_t len, uint32_t timeout, uint8_t addr) {
+  handle = nullptr;
+  next = NULL;
+  _radio = radio;
+  _type = type;
+  _data = data;
+  _len = len;
+  _timeout = timeout;
+  _addr = addr;
+  _result = { type, OPERATION_PENDING, 0, 0, timeout, data, len, 0, 0 };
+}
+
+void RadioOperationAwaiter::await_suspend(std::coroutine_handle<RadioTask::promise_type> handle) {
+  this->handle = handle;
+  handle.promise().executor->enqueue(this);
+}
+
+RadioSleepAwaiter::RadioSleepAwaiter(uint32_t time) {
+  handle = nullptr;
+  next = NULL;
+  _time = time;
+}
+
+bool RadioSleepAwaiter::await_ready() {
+  return((int32_t)(_time - Module::micros()) <= 0);
+}
+
+void RadioSleepAwaiter::await_suspend(std::coroutine_handle<RadioTask::promise_type> handle) {
+  this->handle = handle;
+  handle.promise().executor->enqueue(this);
+}
+
+RadioExecutor::RadioExecutor() {
+  for(uint8_t i = 0; i < RADIOLIB_EXECUTOR_MAX_RADIOS; i++) {
+    _radios[i] = { NULL, NULL, NULL, NULL };
+  }
+}
+
+RadioExecutor::~RadioExecutor() {
+  while(_tasks != NULL) {
+    RadioTask::promise_type* task = _tasks;
+    _tasks = task->nextTask;
+    std::coroutine_handle<RadioTask::promise_type>::from_promise(*task).destroy();
+  }
+
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    for(uint8_t source = 0; source < RADIOLIB_EVENT_MAX_SOURCES; source++) {
+      _radios[i].radio->setEventIsr(source, NULL);
+    }
+  }
+}
+
+void RadioExecutor::spawn(RadioTask task) {
+  RadioTask::promise_type* promise = &task._handle.promise();
+  promise->executor = this;
+  promise->waiter.handle = task._handle;
+  task._handle = nullptr;
+
+  // link into the list of tasks, so that unfinished ones can be destroyed
+  promise->prevTask = NULL;
+  promise->nextTask = _tasks;
+  if(_tasks != NULL) {
+    _tasks->prevTask = promise;
+  }
+  _tasks = promise;
+  _numTasks++;
+
+  ready(&promise->waiter);
+}
+
+size_t RadioExecutor::runOnce(uint32_t timeout) {
+  // interrupts that happen from now on are picked up by the next pass
+  _wake = false;
+  pollRadios();
+
+  // wake up sleepers whose time has come (the list is sorted)
+  uint32_t now = Module::micros();
+  while((_sleepers != NULL) && ((int32_t)(_sleepers->_time - now) <= 0)) {
+    RadioSleepAwaiter* sleeper = _sleepers;
+    _sleepers = (RadioSleepAwaiter*)sleeper->next;
+    ready(sleeper);
+  }
+
+  // resume only coroutines that are ready now, the ones made ready by them are resumed on the next pass
+  RadioWaiter_t* waiter = _readyHead;
+  _readyHead = NULL;
+  _readyTail = NULL;
+  size_t num = 0;
+  while(waiter != NULL) {
+    RadioWaiter_t* next = waiter->next;
+    std::coroutine_handle<> handle = waiter->handle;
+    handle.resume();
+    num++;
+
+    // all coroutines are top-level tasks, so finished one can be destroyed right away
+    if(handle.done()) {
+      RadioTask::promise_type* task = &std::coroutine_handle<RadioTask::promise_type>::from_address(handle.address()).promise();
+      if(task->prevTask != NULL) {
+        task->prevTask->nextTask = task->nextTask;
+      } else {
+        _tasks = task->nextTask;
+      }
+      if(task->nextTask != NULL) {
+        task->nextTask->prevTask = task->prevTask;
+      }
+      _numTasks--;
+      handle.destroy();
+    }
+    waiter = next;
+  }
+  _resumes += num;
+
+  // nothing was ready, block until interrupt or the nearest deadline
+  if((num == 0) && (_readyHead == NULL) && !_wake) {
+    Module::waitForInterrupt(getWaitTime(timeout));
+  }
+
+  return(num);
+}
+
+void RadioExecutor::run() {
+  while(_tasks != NULL) {
+    runOnce();
+  }
+}
+
+size_t RadioExecutor::getTaskCount() {
+  return(_numTasks);
+}
+
+uint32_t RadioExecutor::getResumeCount() {
+  return(_resumes);
+}
+
+RadioOperationAwaiter RadioExecutor::transmit(PhysicalLayer* radio, uint8_t* data, size_t len, uint32_t timeout, uint8_t addr) {
+  return(RadioOperationAwaiter(radio, RADIOLIB_OPERATION_TX, data, len, timeout, addr));
+}
+
+RadioOperationAwaiter RadioExecutor::receive(PhysicalLayer* radio, uint8_t* data, size_t len, uint32_t timeout) {
+  return(RadioOperationAwaiter(radio, RADIOLIB_OPERATION_RX, data, len, timeout, 0));
+}
+
+RadioOperationAwaiter RadioExecutor::scanChannel(PhysicalLayer* radio, uint32_t timeout) {
+  return(RadioOperationAwaiter(radio, RADIOLIB_OPERATION_CAD, NULL, 0, timeout, 0));
+}
+
+RadioSleepAwaiter RadioExecutor::sleepUntil(uint32_t time) {
+  return(RadioSleepAwaiter(time));
+}
+
+void RadioExecutor::wakeIsr() {
+  _wake = true;
+}
+
+void RadioExecutor::enqueue(RadioOperationAwaiter* awaiter) {
+  // find the radio, or register it on first use
+  RadioSlot_t* slot = NULL;
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    if(_radios[i].radio == awaiter->_radio) {
+      slot = &_radios[i];
+      break;
+    }
+  }
+
+  if(slot == NULL) {
+    if(_numRadios == RADIOLIB_EXECUTOR_MAX_RADIOS) {
+      awaiter->_result.status = ERR_MEMORY_ALLOCATION_FAILED;
+      ready(awaiter);
+      return;
+    }
+
+    slot = &_radios[_numRadios++];
+    slot->radio = awaiter->_radio;
+    for(uint8_t source = 0; source < RADIOLIB_EVENT_MAX_SOURCES; source++) {
+      slot->radio->setEventIsr(source, wakeIsr);
+    }
+  }
+
+  // operations on the same radio run one after another
+  awaiter->next = NULL;
+  if(slot->tail != NULL) {
+    slot->tail->next = awaiter;
+  } else {
+    slot->head = awaiter;
+  }
+  slot->tail = awaiter;
+
+  if(slot->active == NULL) {
+    startNext(slot);
+  }
+}
+
+void RadioExecutor::enqueue(RadioSleepAwaiter* awaiter) {
+  // keep sleepers sorted by wake up time
+  RadioSleepAwaiter** pos = &_sleepers;
+  while((*pos != NULL) && ((int32_t)((*pos)->_time - awaiter->_time) <= 0)) {
+    pos = (RadioSleepAwaiter**)&(*pos)->next;
+  }
+  awaiter->next = *pos;
+  *pos = awaiter;
+}
+
+void RadioExecutor::ready(RadioWaiter_t* waiter) {
+  waiter->next = NULL;
+  if(_readyTail != NULL) {
+    _readyTail->next = waiter;
+  } else {
+    _readyHead = waiter;
+  }
+  _readyTail = waiter;
+}
+
+void RadioExecutor::startNext(RadioSlot_t* slot) {
+  while(slot->head != NULL) {
+    RadioOperationAwaiter* awaiter = slot->head;
+    slot->head = (RadioOperationAwaiter*)awaiter->next;
+    if(slot->head == NULL) {
+      slot->tail = NULL;
+    }
+
+    const RadioOperation_t* op = NULL;
+    if(awaiter->_type == RADIOLIB_OPERATION_TX) {
+      op = slot->radio->transmitAsync(awaiter->_data, awaiter->_len, awaiter->_timeout, awaiter->_addr);
+    } else if(awaiter->_type == RADIOLIB_OPERATION_RX) {
+      op = slot->radio->receiveAsync(awaiter->_data, awaiter->_len, awaiter->_timeout);
+    } else {
+      op = slot->radio->scanChannelAsync(awaiter->_timeout);
+    }
+
+    // operation that failed to start is finished right away, try the next one
+    if(op->status == OPERATION_PENDING) {
+      slot->active = awaiter;
+      return;
+    }
+    awaiter->_result = *op;
+    ready(awaiter);
+  }
+  slot->active = NULL;
+}
+
+void RadioExecutor::pollRadios() {
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    RadioSlot_t* slot = &_radios[i];
+    if((slot->active == NULL) || (slot->radio->poll() == OPERATION_PENDING)) {
+      continue;
+    }
+
+    slot->active->_result = *slot->radio->getOperation();
+    ready(slot->active);
+    startNext(slot);
+  }
+}
+
+uint32_t RadioExecutor::getWaitTime(uint32_t timeout) {
+  // find the nearest deadline
+  uint32_t now = Module::micros();
+  bool found = false;
+  int32_t left = 0;
+  if(_sleepers != NULL) {
+    left = (int32_t)(_sleepers->_time - now);
+    found = true;
+  }
+
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    const RadioOperation_t* op = _radios[i].radio->getOperation();
+    if((_radios[i].active == NULL) || (op->timeout == 0)) {
+      continue;
+    }
+    int32_t opLeft = (int32_t)(op->start + op->timeout - now);
+    if(!found || (opLeft < left)) {
+      left = opLeft;
+      found = true;
+    }
+  }
+
+  if(!found) {
+    return(timeout);
+  } else if(left <= 0) {
+    return(0);
+  }
+
+  // round up to ms, so that the deadline has passed when the wait is over
+  uint32_t wait = ((uint32_t)left + 999) / 1000;
+  return((wait < timeout) ? wait : timeout);
+}
+
+#endif
@@ -0,0 +1,264 @@
+#ifndef _RADIOLIB_RADIO_EXECUTOR_H
+#define _RADIOLIB_RADIO_EXECUTOR_H
+
+#include "../../TypeDef.h"
+
+#if defined(RADIOLIB_COROUTINES)
+
+#if !defined(__cpp_impl_coroutine)
+  #error "RADIOLIB_COROUTINES requires compiler with C++20 coroutine support (e.g. -std=c++20)"
+#endif
+
+#include <coroutine>
+#include <exception>
+
+#include "PhysicalLayer.h"
+
+// maximum number of radios handled by single executor
+#define RADIOLIB_EXECUTOR_MAX_RADIOS                  8
+
+// maximum time in ms to block waiting for interrupt, so that a missed interrupt edge only delays the operation
+#define RADIOLIB_EXECUTOR_MAX_WAIT                    1000
+
+class RadioExecutor;
+
+/*!
+  \struct RadioWaiter_t
+
+  \brief Suspended coroutine, linked into executor queues. Base of all awaitables, not used directly.
+*/
+struct RadioWaiter_t {
+  std::coroutine_handle<> handle;
+  RadioWaiter_t* next;
+};
+
+/*!
+  \class RadioTask
+
+  \brief Return type of coroutines run by RadioExecutor. The coroutine does not start until it is passed to RadioExecutor::spawn,
+  which takes ownership of it. Tasks are top-level only, they cannot be awaited by other tasks.
+*/
+class RadioTask {
+  public:
+    struct promise_type {
+      RadioWaiter_t waiter = { nullptr, NULL };
+      RadioExecutor* executor = NULL;
+      promise_type* prevTask = NULL;
+      promise_type* nextTask = NULL;
+
+      RadioTask get_return_object() { return(RadioTask(std::coroutine_handle<promise_type>::from_promise(*this))); }
+      std::suspend_always initial_suspend() noexcept { return(std::suspend_always()); }
+      std::suspend_always final_suspend() noexcept { return(std::suspend_always()); }
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+    };
+
+    RadioTask(RadioTask&& task) : _handle(task._handle) { task._handle = nullptr; }
+    RadioTask(const RadioTask&) = delete;
+    RadioTask& operator=(const RadioTask&) = delete;
+    ~RadioTask() { if(_handle) { _handle.destroy(); } }
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    friend class RadioExecutor;
+    std::coroutine_handle<promise_type> _handle;
+
+    explicit RadioTask(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+};
+
+/*!
+  \class RadioOperationAwaiter
+
+  \brief Awaitable radio operation, created by RadioExecutor::transmit, RadioExecutor::receive and RadioExecutor::scanChannel.
+  co_await returns copy of the finished operation handle (status, timestamps and RX metadata).
+*/
+class RadioOperationAwaiter: public RadioWaiter_t {
+  public:
+    RadioOperationAwaiter(PhysicalLayer* radio, uint8_t type, uint8_t* data, size_t len, uint32_t timeout, uint8_t addr);
+
+    bool await_ready() { return(false); }
+    void await_suspend(std::coroutine_handle<RadioTask::promise_type> handle);
+    RadioOperation_t await_resume() { return(_result); }
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    friend class RadioExecutor;
+    PhysicalLayer* _radio;
+    uint8_t _type;
+    uint8_t* _data;
+    size_t _len;
+    uint32_t _timeout;
+    uint8_t _addr;
+    RadioOperation_t _result;
+};
+
+/*!
+  \class RadioSleepAwaiter
+
+  \brief Awaitable point in time, created by RadioExecutor::sleepUntil.
+*/
+class RadioSleepAwaiter: public RadioWaiter_t {
+  public:
+    explicit RadioSleepAwaiter(uint32_t time);
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<RadioTask::promise_type> handle);
+    void await_resume() {}
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    friend class RadioExecutor;
+    uint32_t _time;
+};
+
+/*!
+  \class RadioExecutor
+
+  \brief Single-threaded executor for coroutines that use radio modules. Coroutines suspend on co_await of radio operations or sleep,
+  the executor starts operations on each radio one at a time (in the order they were requested), blocks in the hardware abstraction layer
+  until an interrupt pin of one of the radios changes or the nearest deadline passes, then completes the operations with PhysicalLayer::poll
+  and resumes the coroutines that were waiting for them. Many sessions can therefore share a few radios and a single thread.
+
+  Interrupt pins of the radios are attached to the executor (see PhysicalLayer::setEventIsr), replacing any other interrupt actions.
+  The interrupt flag is shared, so only one executor should be used at a time. Coroutine frames are allocated by the compiler.
+*/
+class RadioExecutor {
+  public:
+    /*!
+      \brief Default constructor.
+    */
+    RadioExecutor();
+
+    /*!
+      \brief Destructor. Destroys all unfinished tasks and detaches radio interrupt pins.
+    */
+    ~RadioExecutor();
+
+    /*!
+      \brief Schedules task to run. The executor takes ownership of the task.
+
+      \param task Coroutine to run.
+    */
+    void spawn(RadioTask task);
+
+    /*!
+      \brief Runs one pass of the executor: advances radio operations, resumes coroutines that are ready,
+      and if there were none, waits for interrupt or the nearest deadline.
+
+      \param timeout Maximum time to wait in ms.
+
+      \returns Number of resumed coroutines.
+    */
+    size_t runOnce(uint32_t timeout = RADIOLIB_EXECUTOR_MAX_WAIT);
+
+    /*!
+      \brief Runs the executor until all tasks have finished.
+    */
+    void run();
+
+    /*!
+      \brief Gets the number of unfinished tasks.
+
+      \returns Number of tasks.
+    */
+    size_t getTaskCount();
+
+    /*!
+      \brief Gets the number of coroutine resumptions since the executor was created.
+
+      \returns Number of resumptions.
+    */
+    uint32_t getResumeCount();
+
+    /*!
+      \brief Creates awaitable transmission. Transmissions on the same radio are serialized with all other operations on that radio.
+
+      \param radio Radio to transmit with.
+
+      \param data Binary data that will be transmitted.
+
+      \param len Length of binary data to transmit (in bytes).
+
+      \param timeout Operation timeout in us, 0 to disable. Measured from the moment the transmission is actually started.
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns Awaitable operation.
+    */
+    static RadioOperationAwaiter transmit(PhysicalLayer* radio, uint8_t* data, size_t len, uint32_t timeout = 0, uint8_t addr = 0);
+
+    /*!
+      \brief Creates awaitable reception.
+
+      \param radio Radio to receive with.
+
+      \param data Buffer for received data.
+
+      \param len Size of the buffer. Longer packets are truncated.
+
+      \param timeout Operation timeout in us, 0 to disable. Measured from the moment the reception is actually started.
+
+      \returns Awaitable operation.
+    */
+    static RadioOperationAwaiter receive(PhysicalLayer* radio, uint8_t* data, size_t len, uint32_t timeout = 0);
+
+    /*!
+      \brief Creates awaitable channel activity detection. Status of the result is PREAMBLE_DETECTED or CHANNEL_FREE.
+
+      \param radio Radio to scan with.
+
+      \param timeout Operation timeout in us, 0 to disable.
+
+      \returns Awaitable operation.
+    */
+    static RadioOperationAwaiter scanChannel(PhysicalLayer* radio, uint32_t timeout = 0);
+
+    /*!
+      \brief Creates awaitable point in time.
+
+      \param time Time to resume at in us, as returned by Module::micros.
+
+      \returns Awaitable point in time.
+    */
+    static RadioSleepAwaiter sleepUntil(uint32_t time);
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    friend class RadioOperationAwaiter;
+    friend class RadioSleepAwaiter;
+
+    struct RadioSlot_t {
+      PhysicalLayer* radio;
+      RadioOperationAwaiter* active;
+      RadioOperationAwaiter* head;
+      RadioOperationAwaiter* tail;
+    };
+
+    RadioSlot_t _radios[RADIOLIB_EXECUTOR_MAX_RADIOS];
+    uint8_t _numRadios = 0;
+
+    RadioTask::promise_type* _tasks = NULL;
+    size_t _numTasks = 0;
+    RadioWaiter_t* _readyHead = NULL;
+    RadioWaiter_t* _readyTail = NULL;
+    RadioSleepAwaiter* _sleepers = NULL;
+    uint32_t _resumes = 0;
+
+    static volatile bool _wake;
+    static void wakeIsr();
+
+    void enqueue(RadioOperationAwaiter* awaiter);
+    void enqueue(RadioSleepAwaiter* awaiter);
+    void ready(RadioWaiter_t* waiter);
+    void startNext(RadioSlot_t* slot);
+    void pollRadios();
+    uint32_t getWaitTime(uint32_t timeout);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,307 @@
+#include "RadioManager.h"
+#include "../../Module.h"
+
+volatile bool RadioManager::_irqPending[RADIOLIB_MANAGER_MAX_RADIOS];
+volatile uint32_t RadioManager::_irqTime[RADIOLIB_MANAGER_MAX_RADIOS];
+volatile uint32_t RadioManager::_irqCount[RADIOLIB_MANAGER_MAX_RADIOS];
+volatile uint32_t RadioManager::_irqDropped[RADIOLIB_MANAGER_MAX_RADIOS];
+
+RadioManager::RadioManager() {
+
+}
+
+RadioManager::~RadioManager() {
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    for(uint8_t source = 0; source < RADIOLIB_EVENT_MAX_SOURCES; source++) {
+      _radios[i].radio->setEventIsr(source, NULL);
+    }
+  }
+}
+
+int16_t RadioManager::addRadio(PhysicalLayer* radio, uint8_t roles) {
+  static void (* const trampolines[RADIOLIB_MANAGER_MAX_RADIOS])(void) = { irq<0>, irq<1>, irq<2>, irq<3>, irq<4>, irq<5>, irq<6>, irq<7> };
+
+  if(_numRadios == RADIOLIB_MANAGER_MAX_RADIOS) {
+    return(ERR_MEMORY_ALLOCATION_FAILED);
+  }
+
+  RadioSlot_t* slot = &_radios[_numRadios];
+  slot->radio = radio;
+  slot->roles = roles;
+
+  // all interrupt pins of the radio share one timestamp, radios without any are polled periodically
+  slot->hasIrq = false;
+  for(uint8_t source = 0; source < RADIOLIB_EVENT_MAX_SOURCES; source++) {
+    if(radio->setEventIsr(source, trampolines[_numRadios])) {
+      slot->hasIrq = true;
+    }
+  }
+
+  _numRadios++;
+  return(ERR_NONE);
+}
+
+int16_t RadioManager::begin() {
+  _startTime = Module::micros();
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    memset(&_radios[i].stats, 0, sizeof(RadioManagerStats_t));
+    _irqCount[i] = 0;
+    _irqDropped[i] = 0;
+
+    // interrupts that happened before begin (e.g. left over from previous run) do not belong to any operation
+    _irqPending[i] = false;
+  }
+  _droppedPackets = 0;
+
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    startNext(i);
+  }
+  return(ERR_NONE);
+}
+
+void RadioManager::end() {
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    _radios[i].radio->standby();
+  }
+}
+
+size_t RadioManager::service(uint32_t timeout) {
+  // start from a different radio every time, so that the first one is not always serviced first
+  size_t num = 0;
+  for(uint8_t i = 0; i < _numRadios; i++) {
+    if(serviceRadio((_nextRadio + i) % _numRadios)) {
+      num++;
+    }
+  }
+
+  // free TX radios took what they could, the rest is sent by radios that have to leave reception for it
+  for(uint8_t i = 0; (i < _numRadios) && (_txLen > 0); i++) {
+    uint8_t index = (_nextRadio + i) % _numRadios;
+    const RadioOperation_t* op = _radios[index].radio->getOperation();
+    if((_radios[index].roles & RADIOLIB_MANAGER_ROLE_TX) && (op->type == RADIOLIB_OPERATION_RX) && (op->status == OPERATION_PENDING) && !_irqPending[index]) {
+      _radios[index].stats.rxTime += Module::micros() - op->start;
+      startNext(index);
+    }
+  }
+
+  if(_numRadios > 0) {
+    _nextRadio = (_nextRadio + 1) % _numRadios;
+  }
+
+  // nothing to do, wait for interrupt (but not longer than the poll interval, for radios without interrupt pin)
+  if((num == 0) && (timeout > 0)) {
+    for(uint8_t i = 0; i < _numRadios; i++) {
+      if(_irqPending[i]) {
+        return(num);
+      }
+    }
+    if(timeout > RADIOLIB_MANAGER_POLL_INTERVAL / 1000) {
+      timeout = RADIOLIB_MANAGER_POLL_INTERVAL / 1000;
+    }
+    Module::waitForInterrupt(timeout);
+  }
+
+  return(num);
+}
+
+int16_t RadioManager::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  if(len > RADIOLIB_MANAGER_MAX_PACKET_LENGTH) {
+    return(ERR_PACKET_TOO_LONG);
+  }
+  if(_txLen == RADIOLIB_MANAGER_TX_QUEUE_SIZE) {
+    return(ERR_QUEUE_FULL);
+  }
+
+  TxEntry_t* entry = &_txQueue[(_txHead + _txLen) % RADIOLIB_MANAGER_TX_QUEUE_SIZE];
+  memcpy(entry->data, data, len);
+  entry->len = len;
+  entry->addr = addr;
+  _txLen++;
+  return(ERR_NONE);
+}
+
+size_t RadioManager::available() {
+  return(_numPackets);
+}
+
+bool RadioManager::readPacket(RadioPacket_t* packet) {
+  if(_numPackets == 0) {
+    return(false);
+  }
+
+  RadioPacket_t* queued = &_packets[_packetHead];
+  memcpy(packet, queued, offsetof(RadioPacket_t, data));
+  memcpy(packet->data, queued->data, queued->len);
+  _packetHead = (_packetHead + 1) % RADIOLIB_MANAGER_PACKET_QUEUE_SIZE;
+  _numPackets--;
+  return(true);
+}
+
+void RadioManager::setPacketAction(void (*func)(const RadioPacket_t*, void*), void* ctx) {
+  _packetCb = func;
+  _packetCtx = ctx;
+}
+
+RadioManagerStats_t RadioManager::getStats(uint8_t radio) {
+  RadioManagerStats_t stats;
+  memset(&stats, 0, sizeof(RadioManagerStats_t));
+  if(radio >= _numRadios) {
+    return(stats);
+  }
+
+  // include reception that is still in progress
+  stats = _radios[radio].stats;
+  const RadioOperation_t* op = _radios[radio].radio->getOperation();
+  if((op->type == RADIOLIB_OPERATION_RX) && (op->status == OPERATION_PENDING)) {
+    stats.rxTime += Module::micros() - op->start;
+  }
+  stats.irqCount = _irqCount[radio];
+  stats.irqDropped = _irqDropped[radio];
+  return(stats);
+}
+
+float RadioManager::getRxDuty(uint8_t radio) {
+  uint32_t elapsed = Module::micros() - _startTime;
+  if(elapsed == 0) {
+    return(0);
+  }
+  return((float)getStats(radio).rxTime / (float)elapsed);
+}
+
+uint32_t RadioManager::getDroppedPackets() {
+  return(_droppedPackets);
+}
+
+template<uint8_t N> void RadioManager::irq() {
+  // keep the timestamp of the first interrupt, the ones that follow before it is serviced are only counted
+  _irqCount[N] = _irqCount[N] + 1;
+  if(_irqPending[N]) {
+    _irqDropped[N] = _irqDropped[N] + 1;
+    return;
+  }
+  _irqTime[N] = Module::micros();
+  _irqPending[N] = true;
+}
+
+bool RadioManager::serviceRadio(uint8_t index) {
+  RadioSlot_t* slot = &_radios[index];
+  const RadioOperation_t* op = slot->radio->getOperation();
+
+  // idle radio, e.g. TX radio waiting for packets
+  if(op->status != OPERATION_PENDING) {
+    startNext(index);
+    return(false);
+  }
+
+  // poll only after interrupt, or once in a while in case it was missed
+  uint32_t now = Module::micros();
+  bool irqValid = _irqPending[index];
+  if(slot->hasIrq && !irqValid && (now - slot->lastService < RADIOLIB_MANAGER_POLL_INTERVAL)) {
+    return(false);
+  }
+  slot->lastService = now;
+
+  uint32_t irqTime = _irqTime[index];
+  _irqPending[index] = false;
+  if(slot->radio->poll() == OPERATION_PENDING) {
+    return(false);
+  }
+
+  finishOperation(index, irqTime, irqValid);
+  startNext(index);
+  return(true);
+}
+
+void RadioManager::finishOperation(uint8_t index, uint32_t irqTime, bool irqValid) {
+  RadioSlot_t* slot = &_radios[index];
+  const RadioOperation_t* op = slot->radio->getOperation();
+
+  if(op->type == RADIOLIB_OPERATION_TX) {
+    if(op->status == ERR_NONE) {
+      slot->stats.txPackets++;
+    } else {
+      slot->stats.txErrors++;
+    }
+
+  } else if(op->type == RADIOLIB_OPERATION_RX) {
+    slot->stats.rxTime += op->end - op->start;
+    if(op->status != ERR_NONE) {
+      slot->stats.rxErrors++;
+    }
+    if((op->status != ERR_NONE) && (op->status != ERR_CRC_MISMATCH)) {
+      return;
+    }
+
+    slot->stats.rxPackets++;
+    if(irqValid) {
+      uint32_t latency = op->end - irqTime;
+      slot->stats.latencyTotal += latency;
+      if(latency > slot->stats.latencyMax) {
+        slot->stats.latencyMax = latency;
+      }
+    }
+
+    slot->packet.radio = index;
+    slot->packet.timestamp = irqValid ? irqTime : op->end;
+    slot->packet.status = op->status;
+    slot->packet.rssi = op->rssi;
+    slot->packet.snr = op->snr;
+    slot->packet.len = op->len;
+    publishPacket(&slot->packet);
+
+  } else if(op->type == RADIOLIB_OPERATION_CAD) {
+    slot->stats.cadScans++;
+    if(op->status == PREAMBLE_DETECTED) {
+      slot->stats.cadDetected++;
+    }
+  }
+}
+
+void RadioManager::publishPacket(RadioPacket_t* packet) {
+  if(_packetCb != NULL) {
+    _packetCb(packet, _packetCtx);
+    return;
+  }
+
+  if(_numPackets == RADIOLIB_MANAGER_PACKET_QUEUE_SIZE) {
+    _droppedPackets++;
+    return;
+  }
+
+  RadioPacket_t* queued = &_packets[(_packetHead + _numPackets) % RADIOLIB_MANAGER_PACKET_QUEUE_SIZE];
+  memcpy(queued, packet, offsetof(RadioPacket_t, data));
+  memcpy(queued->data, packet->data, packet->len);
+  _numPackets++;
+}
+
+void RadioManager::startNext(uint8_t index) {
+  RadioSlot_t* slot = &_radios[index];
+  const RadioOperation_t* op = NULL;
+
+  // interrupts of the previous operation are no longer interesting
+  _irqPending[index] = false;
+
+  if((slot->roles & RADIOLIB_MANAGER_ROLE_TX) && (_txLen > 0)) {
+    // copy the packet out of the queue, so that the queue entry can be reused while the packet is being transmitted,
+    // the entry is only released once the transmission started
+    TxEntry_t* entry = &_txQueue[_txHead];
+    memcpy(slot->packet.data, entry->data, entry->len);
+    op = slot->radio->transmitAsync(slot->packet.data, entry->len, 0, entry->addr);
+    if(op->status == OPERATION_PENDING) {
+      _txHead = (_txHead + 1) % RADIOLIB_MANAGER_TX_QUEUE_SIZE;
+      _txLen--;
+    }
+  } else if(slot->roles & RADIOLIB_MANAGER_ROLE_RX) {
+    op = slot->radio->receiveAsync(slot->packet.data, RADIOLIB_MANAGER_MAX_PACKET_LENGTH);
+  } else if(slot->roles & RADIOLIB_MANAGER_ROLE_CAD) {
+    op = slot->radio->scanChannelAsync();
+  } else {
+    return;
+  }
+
+  // operation that failed to start is counted right away, it will be retried on the next service (a packet stays queued until then)
+  slot->lastService = Module::micros();
+  if(op->status != OPERATION_PENDING) {
+    finishOperation(index, 0, false);
+  }
+}
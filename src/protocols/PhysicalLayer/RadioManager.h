@@ -0,0 +1,304 @@
+#ifndef _RADIOLIB_RADIO_MANAGER_H
+#define _RADIOLIB_RADIO_MANAGER_H
+
+#include "../../TypeDef.h"
+#include "PhysicalLayer.h"
+
+// maximum number of radios handled by the manager
+#define RADIOLIB_MANAGER_MAX_RADIOS                   8
+
+// maximum length of packets handled by the manager
+#define RADIOLIB_MANAGER_MAX_PACKET_LENGTH            255
+
+// number of received packets that can be waiting to be read
+#define RADIOLIB_MANAGER_PACKET_QUEUE_SIZE            8
+
+// number of packets that can be waiting for transmission
+#define RADIOLIB_MANAGER_TX_QUEUE_SIZE                4
+
+// radios that did not report an interrupt for this long are polled anyway (in us), so that a missed interrupt edge does not stall the radio
+#define RADIOLIB_MANAGER_POLL_INTERVAL                100000
+
+// radio roles, can be combined
+#define RADIOLIB_MANAGER_ROLE_RX                      0x01
+#define RADIOLIB_MANAGER_ROLE_TX                      0x02
+#define RADIOLIB_MANAGER_ROLE_CAD                     0x04
+
+/*!
+  \struct RadioPacket_t
+
+  \brief Packet received by one of the radios handled by RadioManager.
+*/
+struct RadioPacket_t {
+
+  /*!
+    \brief Index of the radio that received the packet, in the order the radios were added.
+  */
+  uint8_t radio;
+
+  /*!
+    \brief Timestamp of the interrupt that signalled the packet in us, or the time the packet was read when the radio has no interrupt pin.
+  */
+  uint32_t timestamp;
+
+  /*!
+    \brief ERR_NONE, or ERR_CRC_MISMATCH for packets that failed CRC check.
+  */
+  int16_t status;
+
+  /*!
+    \brief RSSI of the packet in dBm, 0 when not available.
+  */
+  float rssi;
+
+  /*!
+    \brief SNR of the packet in dB, 0 when not available.
+  */
+  float snr;
+
+  /*!
+    \brief Packet length in bytes.
+  */
+  size_t len;
+
+  /*!
+    \brief Packet data.
+  */
+  uint8_t data[RADIOLIB_MANAGER_MAX_PACKET_LENGTH];
+};
+
+/*!
+  \struct RadioManagerStats_t
+
+  \brief Counters of a single radio handled by RadioManager, see RadioManager::getStats.
+*/
+struct RadioManagerStats_t {
+
+  /*!
+    \brief Total time spent in reception in us.
+  */
+  uint32_t rxTime;
+
+  /*!
+    \brief Number of received packets, including the ones that failed CRC check.
+  */
+  uint32_t rxPackets;
+
+  /*!
+    \brief Number of received packets that failed CRC check or could not be read.
+  */
+  uint32_t rxErrors;
+
+  /*!
+    \brief Number of transmitted packets.
+  */
+  uint32_t txPackets;
+
+  /*!
+    \brief Number of transmissions that failed, including attempts that failed to start (the packet is then retried).
+  */
+  uint32_t txErrors;
+
+  /*!
+    \brief Number of finished channel scans.
+  */
+  uint32_t cadScans;
+
+  /*!
+    \brief Number of channel scans that detected activity.
+  */
+  uint32_t cadDetected;
+
+  /*!
+    \brief Number of interrupts.
+  */
+  uint32_t irqCount;
+
+  /*!
+    \brief Number of interrupts that arrived before the previous one was serviced, so that their timestamp was lost.
+  */
+  uint32_t irqDropped;
+
+  /*!
+    \brief Total time between interrupt and reading the received packet in us.
+  */
+  uint32_t latencyTotal;
+
+  /*!
+    \brief Longest time between interrupt and reading the received packet in us.
+  */
+  uint32_t latencyMax;
+};
+
+/*!
+  \class RadioManager
+
+  \brief Drives several radios from a single main loop. Each radio has a role: RX radios are kept in reception and re-armed after every packet,
+  TX radios transmit packets from a shared transmit queue and CAD radios scan the channel continuously. A radio with both RX and TX role
+  leaves reception when there is a packet to transmit and no other TX radio is free. Packets received by all radios are published as a single timestamped stream.
+
+  Radios are serviced in round-robin order by RadioManager::service, so a busy radio cannot starve the others. Radios are only polled
+  after their interrupt pin fired (or after RADIOLIB_MANAGER_POLL_INTERVAL), which keeps SPI traffic low with many radios.
+  Interrupt pins are attached to the manager (see PhysicalLayer::setEventIsr), replacing any other interrupt actions.
+  Interrupt state is shared, so only one manager should be used at a time.
+*/
+class RadioManager {
+  public:
+    /*!
+      \brief Default constructor.
+    */
+    RadioManager();
+
+    /*!
+      \brief Destructor. Detaches radio interrupt pins.
+    */
+    ~RadioManager();
+
+    /*!
+      \brief Adds radio to the manager. Radios are numbered in the order they were added, starting from 0.
+      The radio has to be initialized and configured (frequency, modem settings) beforehand.
+
+      \param radio Radio to add.
+
+      \param roles Radio roles, combination of RADIOLIB_MANAGER_ROLE_* macros.
+
+      \returns \ref status_codes
+    */
+    int16_t addRadio(PhysicalLayer* radio, uint8_t roles);
+
+    /*!
+      \brief Starts all radios in their roles and resets the counters.
+
+      \returns \ref status_codes
+    */
+    int16_t begin();
+
+    /*!
+      \brief Puts all radios to standby.
+    */
+    void end();
+
+    /*!
+      \brief Services radios: completes finished operations, publishes received packets, dispatches queued transmissions and re-arms the radios.
+      Must be called from the main loop, never from interrupt context.
+
+      \param timeout Maximum time to wait for interrupt in ms when there was nothing to do, 0 to return immediately.
+
+      \returns Number of finished operations.
+    */
+    size_t service(uint32_t timeout = 0);
+
+    /*!
+      \brief Queues packet for transmission by the first available TX radio. The data is copied, so the buffer can be reused right away.
+
+      \param data Binary data that will be transmitted.
+
+      \param len Length of binary data to transmit (in bytes).
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0);
+
+    /*!
+      \brief Gets the number of received packets waiting to be read.
+
+      \returns Number of packets.
+    */
+    size_t available();
+
+    /*!
+      \brief Reads the oldest received packet.
+
+      \param packet Packet to copy the data into.
+
+      \returns True when a packet was read, false when there was none.
+    */
+    bool readPacket(RadioPacket_t* packet);
+
+    /*!
+      \brief Sets function that will be called from RadioManager::service for every received packet. Packets are then passed to it instead of being queued.
+
+      \param func Callback function, called with the received packet and user context. NULL to queue packets again.
+
+      \param ctx User context passed to callback function.
+    */
+    void setPacketAction(void (*func)(const RadioPacket_t*, void*), void* ctx = NULL);
+
+    /*!
+      \brief Gets counters of a radio.
+
+      \param radio Index of the radio.
+
+      \returns Radio counters.
+    */
+    RadioManagerStats_t getStats(uint8_t radio);
+
+    /*!
+      \brief Gets the fraction of time the radio spent in reception since RadioManager::begin.
+
+      \param radio Index of the radio.
+
+      \returns Reception duty cycle, 0 to 1.
+    */
+    float getRxDuty(uint8_t radio);
+
+    /*!
+      \brief Gets the number of received packets dropped because the packet queue was full.
+
+      \returns Number of dropped packets.
+    */
+    uint32_t getDroppedPackets();
+
+#ifndef RADIOLIB_GODMODE
+  private:
+#endif
+    struct RadioSlot_t {
+      PhysicalLayer* radio;
+      uint8_t roles;
+      bool hasIrq;
+      uint32_t lastService;
+      RadioManagerStats_t stats;
+
+      // packet being received, or copy of the packet being transmitted
+      RadioPacket_t packet;
+    };
+
+    struct TxEntry_t {
+      size_t len;
+      uint8_t addr;
+      uint8_t data[RADIOLIB_MANAGER_MAX_PACKET_LENGTH];
+    };
+
+    RadioSlot_t _radios[RADIOLIB_MANAGER_MAX_RADIOS];
+    uint8_t _numRadios = 0;
+    uint8_t _nextRadio = 0;
+    uint32_t _startTime = 0;
+
+    RadioPacket_t _packets[RADIOLIB_MANAGER_PACKET_QUEUE_SIZE];
+    uint8_t _packetHead = 0;
+    size_t _numPackets = 0;
+    uint32_t _droppedPackets = 0;
+    void (*_packetCb)(const RadioPacket_t*, void*) = NULL;
+    void* _packetCtx = NULL;
+
+    TxEntry_t _txQueue[RADIOLIB_MANAGER_TX_QUEUE_SIZE];
+    uint8_t _txHead = 0;
+    size_t _txLen = 0;
+
+    // written by interrupt service routines, read and cleared by service
+    static volatile bool _irqPending[RADIOLIB_MANAGER_MAX_RADIOS];
+    static volatile uint32_t _irqTime[RADIOLIB_MANAGER_MAX_RADIOS];
+    static volatile uint32_t _irqCount[RADIOLIB_MANAGER_MAX_RADIOS];
+    static volatile uint32_t _irqDropped[RADIOLIB_MANAGER_MAX_RADIOS];
+
+    template<uint8_t N> static void irq();
+
+    bool serviceRadio(uint8_t index);
+    void finishOperation(uint8_t index, uint32_t irqTime, bool irqValid);
+    void publishPacket(RadioPacket_t* packet);
+    void startNext(uint8_t index);
+};
+
+#endif
@@ -2,19 +2,41 @@
 
 ITA2String::ITA2String(char c) {
   _len = 1;
+  #ifndef RADIOLIB_STATIC_ONLY
+    _str = (char*)BufferPool::alloc(_len + 1);
+    if(_str == NULL) {
+      _len = 0;
+      _ita2Len = 0;
+      return;
+    }
+  #endif
   _str[0] = c;
+  _str[1] = '\0';
   _ita2Len = 0;
 }
 
 ITA2String::ITA2String(const char* str) {
   _len = strlen(str);
-  strcpy(_str, str);
+  #ifdef RADIOLIB_STATIC_ONLY
+    if(_len >= RADIOLIB_STATIC_ARRAY_SIZE) {
+      _len = RADIOLIB_STATIC_ARRAY_SIZE - 1;
+    }
+  #else
+    _str = (char*)BufferPool::alloc(_len + 1);
+    if(_str == NULL) {
+      _len = 0;
+      _ita2Len = 0;
+      return;
+    }
+  #endif
+  memcpy(_str, str, _len);
+  _str[_len] = '\0';
   _ita2Len = 0;
 }
 
 ITA2String::~ITA2String() {
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] _str;
+    BufferPool::free(_str);
   #endif
 }
 
@@ -24,19 +46,19 @@ size_t ITA2String::length() {
 
   if(_ita2Len == 0) {
     // ITA2 length wasn't calculated yet, call byteArr() to calculate it
-    byteArr();
+    BufferPool::free(byteArr());
   }
 
   return(_ita2Len);
 }
 
 uint8_t* ITA2String::byteArr() {
-  // create temporary array 2x the string length (figures may be 3 bytes)
-  #ifdef RADIOLIB_STATIC_ONLY
-    uint8_t temp[RADIOLIB_STATIC_ARRAY_SIZE*2 + 1];
-  #else
-    uint8_t* temp = new uint8_t[_len*2 + 1];
-  #endif
+  // encode straight into the returned array, 2x the string length is always enough (figures may be 3 bytes, but they need a following letter or the message end)
+  uint8_t* arr = (uint8_t*)BufferPool::alloc(_len*2 + 1);
+  if(arr == NULL) {
+    _ita2Len = 0;
+    return(NULL);
+  }
 
   size_t arrayLen = 0;
   bool flagFigure = false;
@@ -49,11 +71,11 @@ uint8_t* ITA2String::byteArr() {
       // check if this is the first figure in sequence
       if(!flagFigure) {
         flagFigure = true;
-        temp[arrayLen++] = ITA2_FIGS;
+        arr[arrayLen++] = ITA2_FIGS;
       }
 
       // add the character code
-      temp[arrayLen++] = character & 0b11111;
+      arr[arrayLen++] = character & 0b11111;
 
       // check the following character (skip for message end)
       if(i < (_len - 1)) {
@@ -61,28 +83,22 @@ uint8_t* ITA2String::byteArr() {
         uint8_t nextShift = (nextCode >> 5) & 0b11111;
         if(nextShift == ITA2_LTRS) {
           // next character is a letter, terminate figure shift
-          temp[arrayLen++] = ITA2_LTRS;
+          arr[arrayLen++] = ITA2_LTRS;
           flagFigure = false;
         }
       } else {
         // reached the end of the message, terminate figure shift
-        temp[arrayLen++] = ITA2_LTRS;
+        arr[arrayLen++] = ITA2_LTRS;
         flagFigure = false;
       }
     } else {
-      temp[arrayLen++] = character & 0b11111;
+      arr[arrayLen++] = character & 0b11111;
     }
   }
 
   // save ITA2 string length
   _ita2Len = arrayLen;
 
-  uint8_t* arr = new uint8_t[arrayLen];
-  memcpy(arr, temp, arrayLen);
-  #ifndef RADIOLIB_STATIC_ONLY
-    delete[] temp;
-  #endif
-
   return(arr);
 }
 
@@ -221,7 +237,10 @@ size_t RTTYClient::print(__FlashStringHelper* fstr) {
   #ifdef RADIOLIB_STATIC_ONLY
     char str[RADIOLIB_STATIC_ARRAY_SIZE];
   #else
-    char* str = new char[len];
+    char* str = (char*)BufferPool::alloc(len);
+    if(str == NULL) {
+      return(0);
+    }
   #endif
 
   // copy string from flash
@@ -238,7 +257,7 @@ size_t RTTYClient::print(__FlashStringHelper* fstr) {
     n = RTTYClient::write((uint8_t*)str, len);
   }
   #ifndef RADIOLIB_STATIC_ONLY
-    delete[] str;
+    BufferPool::free(str);
   #endif
   return(n);
 }
@@ -246,7 +265,7 @@ size_t RTTYClient::print(__FlashStringHelper* fstr) {
 size_t RTTYClient::print(ITA2String& ita2) {
   uint8_t* arr = ita2.byteArr();
   size_t n = RTTYClient::write(arr, ita2.length());
-  delete[] arr;
+  BufferPool::free(arr);
   return(n);
 }
 
@@ -400,17 +419,17 @@ size_t RTTYClient::println(double d, int digits) {
 }
 
 void RTTYClient::mark() {
-  uint32_t start = micros();
+  uint32_t start = Module::micros();
   transmitDirect(_base + _shift, _baseHz + _shiftHz);
-  while(micros() - start < _bitDuration) {
+  while(Module::micros() - start < _bitDuration) {
     yield();
   }
 }
 
 void RTTYClient::space() {
-  uint32_t start = micros();
+  uint32_t start = Module::micros();
   transmitDirect(_base, _baseHz);
-  while(micros() - start < _bitDuration) {
+  while(Module::micros() - start < _bitDuration) {
     yield();
   }
 }
@@ -437,7 +456,7 @@ size_t RTTYClient::printNumber(unsigned long n, uint8_t base) {
     ITA2String ita2 = str;
     uint8_t* arr = ita2.byteArr();
     l = RTTYClient::write(arr, ita2.length());
-    delete[] arr;
+    BufferPool::free(arr);
   } else if((_encoding == ASCII) || (_encoding == ASCII_EXTENDED)) {
     l = RTTYClient::write(str);
   }
@@ -461,7 +480,7 @@ size_t RTTYClient::printFloat(double number, uint8_t digits)  {
       ITA2String ita2 = code;
       uint8_t* arr = ita2.byteArr();
       n = RTTYClient::write(arr, ita2.length());
-      delete[] arr;
+      BufferPool::free(arr);
       return(n);
     } else if((_encoding == ASCII) || (_encoding == ASCII_EXTENDED)) {
       return(RTTYClient::write(code));
@@ -474,7 +493,7 @@ size_t RTTYClient::printFloat(double number, uint8_t digits)  {
       ITA2String ita2 = "-";
       uint8_t* arr = ita2.byteArr();
       n += RTTYClient::write(arr, ita2.length());
-      delete[] arr;
+      BufferPool::free(arr);
     } else if((_encoding == ASCII) || (_encoding == ASCII_EXTENDED)) {
       n += RTTYClient::print('-');
     }
@@ -499,7 +518,7 @@ size_t RTTYClient::printFloat(double number, uint8_t digits)  {
       ITA2String ita2 = ".";
       uint8_t* arr = ita2.byteArr();
       n += RTTYClient::write(arr, ita2.length());
-      delete[] arr;
+      BufferPool::free(arr);
     } else if((_encoding == ASCII) || (_encoding == ASCII_EXTENDED)) {
       n += RTTYClient::print('.');
     }
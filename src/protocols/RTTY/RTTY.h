@@ -2,6 +2,7 @@
 #define _RADIOLIB_RTTY_H
 
 #include "../../TypeDef.h"
+#include "../../BufferPool.h"
 #include "../PhysicalLayer/PhysicalLayer.h"
 #include "../AFSK/AFSK.h"
 
@@ -53,8 +54,8 @@ class ITA2String {
     /*!
       \brief Gets the ITA2 representation of the ASCII string set in constructor.
 
-      \returns Pointer to dynamically allocated array, which contains ITA2-encoded bytes.
-      It is the caller's responsibility to deallocate this memory!
+      \returns Pointer to array allocated by BufferPool, which contains ITA2-encoded bytes, or NULL when it could not be allocated.
+      It is the caller's responsibility to deallocate this memory by BufferPool::free!
     */
     uint8_t* byteArr();
 
@@ -64,7 +65,7 @@ class ITA2String {
     #ifdef RADIOLIB_STATIC_ONLY
       char _str[RADIOLIB_STATIC_ARRAY_SIZE];
     #else
-      char* _str = new char[1];
+      char* _str = NULL;
     #endif
     size_t _len;
     size_t _ita2Len;
@@ -280,13 +280,13 @@ uint16_t SSTVClient::getPictureHeight() {
 }
 
 void SSTVClient::tone(float freq, uint32_t len) {
-  uint32_t start = micros();
+  uint32_t start = Module::micros();
   if(_audio != nullptr) {
     _audio->tone(freq, false);
   } else {
     _phy->transmitDirect(_base + (freq / _phy->getFreqStep()));
   }
-  while(micros() - start < len) {
+  while(Module::micros() - start < len) {
     yield();
   }
 }